@@ -3,6 +3,7 @@ const fs = require('fs');
 const path = require('path');
 const cors = require('cors');
 const csv = require('csv-parse/sync');
+const { aggregate } = require('./aggregation');
 
 const app = express();
 app.use(cors());
@@ -485,6 +486,33 @@ app.delete('/api/alerts/:datetime', (req, res) => {
     }
 });
 
+// Chart aggregation: buckets a telemetry series into per-interval
+// count/avg/min/max bands. The reduction runs in the native addon on a
+// worker thread (see aggregation/), so a months-wide series does not
+// freeze the event loop for other requests; without the compiled addon
+// a JS fallback keeps the endpoint working.
+app.post('/api/aggregate', async (req, res) => {
+    try {
+        const { timestamps, values, bucketMs } = req.body;
+        if (!Array.isArray(timestamps) || !Array.isArray(values) ||
+            timestamps.length !== values.length || !(bucketMs > 0)) {
+            return res.status(400).json({ message: 'Expected timestamps and values arrays of equal length and bucketMs > 0' });
+        }
+
+        const result = await aggregate(timestamps, values, bucketMs);
+        res.json({
+            bucketStart: Array.from(result.bucketStart),
+            count: Array.from(result.count),
+            avg: Array.from(result.avg),
+            min: Array.from(result.min),
+            max: Array.from(result.max)
+        });
+    } catch (error) {
+        console.error('Error aggregating series:', error);
+        res.status(500).json({ message: 'Failed to aggregate series' });
+    }
+});
+
 const PORT = 3000;
 app.listen(PORT, () => {
     console.log(`Server running on port ${PORT}`);
@@ -0,0 +1,225 @@
+// Native aggregation kernels for the dashboard charts.
+//
+// Aggregating a big date range in JavaScript runs per-element over the
+// event loop thread, so one wide chart query freezes every concurrent
+// request. This addon does the same reduction in C++: typed-array
+// input, one fused pass computing count/avg/min/max per time bucket,
+// executed as napi async work on the libuv thread pool so the event
+// loop only sees the submit and the resolved promise.
+//
+// aggregate(timestamps: Float64Array, values: Float64Array,
+//           bucketMs: number) -> Promise<{
+//     bucketStart: Float64Array,  // bucket-aligned epoch ms
+//     count: Int32Array,
+//     avg, min, max: Float64Array
+// }>
+//
+// Timestamps are expected in ascending order (the telemetry APIs
+// return them that way); a backwards jump simply starts a new bucket.
+// NaN values are skipped without ending a bucket.
+//
+// Plain node_api.h, no npm dependencies - same zero-dependency stance
+// as the rest of the native tooling in this repo.
+
+#include <node_api.h>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+#define NAPI_CHECK(expr)        \
+  do {                          \
+    if ((expr) != napi_ok) {    \
+      return nullptr;           \
+    }                           \
+  } while (0)
+
+struct AggJob {
+  napi_async_work work = nullptr;
+  napi_deferred deferred = nullptr;
+  // Keep the input arrays alive while the pool thread reads them
+  napi_ref timestampsRef = nullptr;
+  napi_ref valuesRef = nullptr;
+
+  const double *timestamps = nullptr;
+  const double *values = nullptr;
+  size_t length = 0;
+  double bucketMs = 0;
+
+  std::vector<double> bucketStart;
+  std::vector<int32_t> count;
+  std::vector<double> avg;
+  std::vector<double> min;
+  std::vector<double> max;
+};
+
+// Pool thread: the fused pass. No JS values may be touched here.
+void Execute(napi_env, void *data) {
+  AggJob *job = static_cast<AggJob *>(data);
+  double currentBucket = 0;
+  double sum = 0, lo = 0, hi = 0;
+  int32_t n = 0;
+  bool open = false;
+
+  const auto close = [&]() {
+    job->bucketStart.push_back(currentBucket);
+    job->count.push_back(n);
+    job->avg.push_back(n > 0 ? sum / n : 0.0);
+    job->min.push_back(lo);
+    job->max.push_back(hi);
+  };
+
+  for (size_t i = 0; i < job->length; i++) {
+    const double v = job->values[i];
+    if (std::isnan(v)) {
+      continue;
+    }
+    const double bucket =
+        std::floor(job->timestamps[i] / job->bucketMs) * job->bucketMs;
+    if (!open || bucket != currentBucket) {
+      if (open) {
+        close();
+      }
+      currentBucket = bucket;
+      sum = v;
+      lo = v;
+      hi = v;
+      n = 1;
+      open = true;
+      continue;
+    }
+    sum += v;
+    if (v < lo) lo = v;
+    if (v > hi) hi = v;
+    n++;
+  }
+  if (open) {
+    close();
+  }
+}
+
+napi_value MakeFloat64Array(napi_env env, const std::vector<double> &src) {
+  napi_value buffer, array;
+  void *data = nullptr;
+  if (napi_create_arraybuffer(env, src.size() * sizeof(double), &data,
+                              &buffer) != napi_ok) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < src.size(); i++) {
+    static_cast<double *>(data)[i] = src[i];
+  }
+  if (napi_create_typedarray(env, napi_float64_array, src.size(), buffer, 0,
+                             &array) != napi_ok) {
+    return nullptr;
+  }
+  return array;
+}
+
+napi_value MakeInt32Array(napi_env env, const std::vector<int32_t> &src) {
+  napi_value buffer, array;
+  void *data = nullptr;
+  if (napi_create_arraybuffer(env, src.size() * sizeof(int32_t), &data,
+                              &buffer) != napi_ok) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < src.size(); i++) {
+    static_cast<int32_t *>(data)[i] = src[i];
+  }
+  if (napi_create_typedarray(env, napi_int32_array, src.size(), buffer, 0,
+                             &array) != napi_ok) {
+    return nullptr;
+  }
+  return array;
+}
+
+// Event loop thread: package the vectors as typed arrays and resolve
+void Complete(napi_env env, napi_status status, void *data) {
+  AggJob *job = static_cast<AggJob *>(data);
+
+  if (status == napi_ok) {
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "bucketStart",
+                            MakeFloat64Array(env, job->bucketStart));
+    napi_set_named_property(env, result, "count",
+                            MakeInt32Array(env, job->count));
+    napi_set_named_property(env, result, "avg",
+                            MakeFloat64Array(env, job->avg));
+    napi_set_named_property(env, result, "min",
+                            MakeFloat64Array(env, job->min));
+    napi_set_named_property(env, result, "max",
+                            MakeFloat64Array(env, job->max));
+    napi_resolve_deferred(env, job->deferred, result);
+  } else {
+    napi_value message, error;
+    napi_create_string_utf8(env, "aggregation cancelled", NAPI_AUTO_LENGTH,
+                            &message);
+    napi_create_error(env, nullptr, message, &error);
+    napi_reject_deferred(env, job->deferred, error);
+  }
+
+  napi_delete_reference(env, job->timestampsRef);
+  napi_delete_reference(env, job->valuesRef);
+  napi_delete_async_work(env, job->work);
+  delete job;
+}
+
+bool GetFloat64Array(napi_env env, napi_value value, const double **out,
+                     size_t *length) {
+  napi_typedarray_type type;
+  void *data = nullptr;
+  if (napi_get_typedarray_info(env, value, &type, length, &data, nullptr,
+                               nullptr) != napi_ok ||
+      type != napi_float64_array) {
+    return false;
+  }
+  *out = static_cast<const double *>(data);
+  return true;
+}
+
+napi_value Aggregate(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value args[3];
+  NAPI_CHECK(napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+  AggJob *job = new AggJob();
+  size_t valueCount = 0;
+  double bucketMs = 0;
+  if (argc < 3 ||
+      !GetFloat64Array(env, args[0], &job->timestamps, &job->length) ||
+      !GetFloat64Array(env, args[1], &job->values, &valueCount) ||
+      valueCount != job->length ||
+      napi_get_value_double(env, args[2], &bucketMs) != napi_ok ||
+      !(bucketMs > 0)) {
+    delete job;
+    napi_throw_type_error(env, nullptr,
+                          "expected (Float64Array, Float64Array of equal "
+                          "length, bucketMs > 0)");
+    return nullptr;
+  }
+  job->bucketMs = bucketMs;
+
+  napi_value promise, resourceName;
+  napi_create_reference(env, args[0], 1, &job->timestampsRef);
+  napi_create_reference(env, args[1], 1, &job->valuesRef);
+  napi_create_promise(env, &job->deferred, &promise);
+  napi_create_string_utf8(env, "aggregation", NAPI_AUTO_LENGTH, &resourceName);
+  napi_create_async_work(env, nullptr, resourceName, Execute, Complete, job,
+                         &job->work);
+  napi_queue_async_work(env, job->work);
+  return promise;
+}
+
+napi_value Init(napi_env env, napi_value exports) {
+  napi_value fn;
+  NAPI_CHECK(napi_create_function(env, "aggregate", NAPI_AUTO_LENGTH,
+                                  Aggregate, nullptr, &fn));
+  NAPI_CHECK(napi_set_named_property(env, exports, "aggregate", fn));
+  return exports;
+}
+
+}  // namespace
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
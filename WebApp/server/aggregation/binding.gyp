@@ -0,0 +1,9 @@
+{
+  "targets": [
+    {
+      "target_name": "aggregation",
+      "sources": ["aggregation.cc"],
+      "cflags_cc": ["-O2", "-std=c++17"]
+    }
+  ]
+}
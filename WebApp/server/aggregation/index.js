@@ -0,0 +1,93 @@
+// Chart aggregation: native addon when built, JavaScript fallback
+// otherwise. Both implementations bucket a (timestamps, values) series
+// by bucketMs and return count/avg/min/max per bucket; the native path
+// (aggregation.cc) runs the fused pass on the libuv thread pool, so
+// wide date ranges stop blocking the event loop. Build the addon with
+// `npx node-gyp rebuild` in this directory.
+
+const path = require('path');
+
+let native = null;
+try {
+    native = require(path.join(__dirname, 'build', 'Release', 'aggregation.node'));
+} catch (err) {
+    // No compiled addon (fresh checkout, missing toolchain): the
+    // fallback below keeps the endpoint working, just slower
+}
+
+// Same semantics as the native kernel: ascending timestamps expected,
+// a backwards jump starts a new bucket, NaN values are skipped
+function aggregateJs(timestamps, values, bucketMs) {
+    const bucketStart = [];
+    const count = [];
+    const avg = [];
+    const min = [];
+    const max = [];
+    let current = 0;
+    let sum = 0;
+    let lo = 0;
+    let hi = 0;
+    let n = 0;
+    let open = false;
+    const close = () => {
+        bucketStart.push(current);
+        count.push(n);
+        avg.push(n > 0 ? sum / n : 0);
+        min.push(lo);
+        max.push(hi);
+    };
+    for (let i = 0; i < values.length; i++) {
+        const v = values[i];
+        if (Number.isNaN(v)) {
+            continue;
+        }
+        const bucket = Math.floor(timestamps[i] / bucketMs) * bucketMs;
+        if (!open || bucket !== current) {
+            if (open) {
+                close();
+            }
+            current = bucket;
+            sum = v;
+            lo = v;
+            hi = v;
+            n = 1;
+            open = true;
+            continue;
+        }
+        sum += v;
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+        n++;
+    }
+    if (open) {
+        close();
+    }
+    return {
+        bucketStart: Float64Array.from(bucketStart),
+        count: Int32Array.from(count),
+        avg: Float64Array.from(avg),
+        min: Float64Array.from(min),
+        max: Float64Array.from(max)
+    };
+}
+
+/**
+ * Aggregate a series into time buckets.
+ * @param {Float64Array|number[]} timestamps epoch ms, ascending
+ * @param {Float64Array|number[]} values same length as timestamps
+ * @param {number} bucketMs bucket width, e.g. 3600000 for per-hour
+ * @returns {Promise<{bucketStart, count, avg, min, max}>}
+ */
+function aggregate(timestamps, values, bucketMs) {
+    const ts = timestamps instanceof Float64Array ? timestamps : Float64Array.from(timestamps);
+    const vals = values instanceof Float64Array ? values : Float64Array.from(values);
+    if (ts.length !== vals.length || !(bucketMs > 0)) {
+        return Promise.reject(new TypeError('timestamps/values length mismatch or bad bucketMs'));
+    }
+    if (native) {
+        return native.aggregate(ts, vals, bucketMs);
+    }
+    return Promise.resolve(aggregateJs(ts, vals, bucketMs));
+}
+
+module.exports = { aggregate, native: native !== null };
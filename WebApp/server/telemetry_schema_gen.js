@@ -0,0 +1,14 @@
+// GENERATED by schema/gen_telemetry.py from schema/telemetry.json - do not edit.
+
+const FRAME_VERSION = 1;
+const FRAME_SIZE = 20;
+
+// Telemetry keys as published by the firmware, with units
+const TELEMETRY_FIELDS = [
+    { key: 'temperature', unit: 'C' },
+    { key: 'humidity', unit: '%' },
+    { key: 'light', unit: 'lux' },
+    { key: 'moisture', unit: '%' },
+];
+
+module.exports = { FRAME_VERSION, FRAME_SIZE, TELEMETRY_FIELDS };
@@ -0,0 +1,130 @@
+/**
+ * Streaming base64 encoder writing into any Print sink
+ *
+ * The stock base64::encode(buf, len) materializes the whole encoded
+ * result as an Arduino String, which for a VGA JPEG means an ~80KB
+ * allocation that routinely fails once the heap is fragmented. This
+ * encoder walks the input in small chunks and writes the encoded
+ * characters straight into a Print target (WiFiClient, HTTPClient
+ * stream, Serial, ...), so peak memory stays at a few KB regardless
+ * of the frame size.
+ */
+
+#ifndef Base64PrintEncoder_h
+#define Base64PrintEncoder_h
+
+#include <Arduino.h>
+
+class Base64PrintEncoder {
+public:
+    // Input chunk size per encoding pass, multiple of 3 so no group
+    // straddles a chunk boundary inside encodeChunk
+    static const size_t CHUNK_SIZE = 3072;
+
+    explicit Base64PrintEncoder(Print& output)
+        : out(output), carryLength(0), encodedLength(0) {}
+
+    /**
+     * Exact number of characters encoding inputLength bytes produces,
+     * for precomputing Content-Length headers
+     */
+    static size_t encodedSize(size_t inputLength) {
+        return 4 * ((inputLength + 2) / 3);
+    }
+
+    /**
+     * Encode the next run of input bytes, may be called repeatedly
+     */
+    void write(const uint8_t* data, size_t length) {
+        // Top up a partial group left over from the previous call
+        if (carryLength > 0) {
+            while (carryLength < 3 && length > 0) {
+                carry[carryLength++] = *data++;
+                length--;
+            }
+            if (carryLength < 3) {
+                return;  // Still not a full group, wait for more input
+            }
+            encodeChunk(carry, 3);
+            carryLength = 0;
+        }
+
+        // Encode all complete chunks directly from the caller's buffer
+        while (length >= 3) {
+            size_t chunk = (length / 3) * 3;
+            if (chunk > CHUNK_SIZE) {
+                chunk = CHUNK_SIZE;
+            }
+            encodeChunk(data, chunk);
+            data += chunk;
+            length -= chunk;
+        }
+
+        // Stash the incomplete trailing group
+        while (length > 0) {
+            carry[carryLength++] = *data++;
+            length--;
+        }
+    }
+
+    /**
+     * Flush the trailing group with padding, call exactly once when
+     * all input has been written
+     */
+    void finish() {
+        if (carryLength == 0) {
+            return;
+        }
+        char block[4];
+        uint32_t group = ((uint32_t)carry[0]) << 16;
+        if (carryLength > 1) {
+            group |= ((uint32_t)carry[1]) << 8;
+        }
+        block[0] = alphabet()[(group >> 18) & 0x3f];
+        block[1] = alphabet()[(group >> 12) & 0x3f];
+        block[2] = (carryLength > 1) ? alphabet()[(group >> 6) & 0x3f] : '=';
+        block[3] = '=';
+        out.write((const uint8_t*)block, sizeof(block));
+        encodedLength += sizeof(block);
+        carryLength = 0;
+    }
+
+    /**
+     * Characters written to the sink so far
+     */
+    size_t length() const {
+        return encodedLength;
+    }
+
+private:
+    static const char* alphabet() {
+        static const char table[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        return table;
+    }
+
+    // Encodes a run whose length is a multiple of 3
+    void encodeChunk(const uint8_t* data, size_t length) {
+        // 4 output characters per 3 input bytes, flushed per chunk
+        char encoded[(CHUNK_SIZE / 3) * 4];
+        size_t encodedIndex = 0;
+        for (size_t i = 0; i < length; i += 3) {
+            uint32_t group = ((uint32_t)data[i] << 16) |
+                             ((uint32_t)data[i + 1] << 8) |
+                             (uint32_t)data[i + 2];
+            encoded[encodedIndex++] = alphabet()[(group >> 18) & 0x3f];
+            encoded[encodedIndex++] = alphabet()[(group >> 12) & 0x3f];
+            encoded[encodedIndex++] = alphabet()[(group >> 6) & 0x3f];
+            encoded[encodedIndex++] = alphabet()[group & 0x3f];
+        }
+        out.write((const uint8_t*)encoded, encodedIndex);
+        encodedLength += encodedIndex;
+    }
+
+    Print& out;
+    uint8_t carry[3];
+    size_t carryLength;
+    size_t encodedLength;
+};
+
+#endif // Base64PrintEncoder_h
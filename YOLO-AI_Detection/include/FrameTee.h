@@ -0,0 +1,157 @@
+/**
+ * Refcounted fan-out of camera frame buffers to multiple consumers
+ *
+ * The upload pipeline owns each camera_fb_t exclusively: whoever holds
+ * the pointer must esp_camera_fb_return() it, so a second consumer (the
+ * MJPEG live view) would have to memcpy every ~50KB JPEG out of PSRAM.
+ * The tee wraps a frame in a small refcounted descriptor instead: each
+ * consumer retains the descriptor, reads the driver's buffer in place,
+ * and the frame goes back to the driver when the last reference drops.
+ * Live view and detection then share the exact same PSRAM bytes with no
+ * extra memory traffic.
+ *
+ * A single "latest" slot feeds the viewer: publishLatest() retains the
+ * newest frame there (replacing and releasing the previous one) and
+ * takeLatest() hands it to the stream task, which releases it after the
+ * socket write. The slot only holds references while a viewer is
+ * actually connected — with fb_count = 2 a parked reference pins one of
+ * the driver's two buffers, a price worth paying during a live view but
+ * not in steady state.
+ *
+ * Refcounts and the latest slot are guarded by a spinlock, so retain
+ * and release are safe from tasks on both cores; the driver return
+ * happens outside the lock.
+ */
+
+#ifndef FrameTee_h
+#define FrameTee_h
+
+#include <Arduino.h>
+#include "esp_camera.h"
+
+class FrameTee {
+public:
+    struct SharedFrame {
+        camera_fb_t* fb;
+        int refs;          // 0 = descriptor free
+        uint32_t seq;      // Publish order, lets the viewer skip stale frames
+    };
+
+    // fb_count buffers can be in flight plus the latest slot's retain;
+    // four descriptors cover that with headroom, they cost bytes each
+    static const int POOL_SIZE = 4;
+
+    FrameTee() : mux(portMUX_INITIALIZER_UNLOCKED), nextSeq(0),
+                 latest(NULL), viewerActive(false) {
+        memset(pool, 0, sizeof(pool));
+    }
+
+    /**
+     * Wrap a frame fresh from esp_camera_fb_get(); the caller holds the
+     * one reference. NULL when all descriptors are busy — the caller
+     * still owns the raw buffer and must return it to the driver.
+     */
+    SharedFrame* wrap(camera_fb_t* fb) {
+        SharedFrame* sf = NULL;
+        portENTER_CRITICAL(&mux);
+        for (int i = 0; i < POOL_SIZE; i++) {
+            if (pool[i].refs == 0) {
+                sf = &pool[i];
+                sf->fb = fb;
+                sf->refs = 1;
+                sf->seq = ++nextSeq;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&mux);
+        return sf;
+    }
+
+    void retain(SharedFrame* sf) {
+        portENTER_CRITICAL(&mux);
+        sf->refs++;
+        portEXIT_CRITICAL(&mux);
+    }
+
+    /**
+     * Drop one reference; the last one returns the buffer to the driver
+     */
+    void release(SharedFrame* sf) {
+        camera_fb_t* done = NULL;
+        portENTER_CRITICAL(&mux);
+        if (--sf->refs == 0) {
+            done = sf->fb;
+            sf->fb = NULL;
+        }
+        portEXIT_CRITICAL(&mux);
+        if (done != NULL) {
+            esp_camera_fb_return(done);
+        }
+    }
+
+    /**
+     * Offer a frame to the live view. Retains it into the latest slot
+     * (releasing whatever was there) while a viewer is connected, a
+     * no-op otherwise so no driver buffer is pinned with nobody watching.
+     */
+    void publishLatest(SharedFrame* sf) {
+        SharedFrame* replaced = NULL;
+        portENTER_CRITICAL(&mux);
+        if (viewerActive) {
+            sf->refs++;
+            replaced = latest;
+            latest = sf;
+        }
+        portEXIT_CRITICAL(&mux);
+        if (replaced != NULL) {
+            release(replaced);
+        }
+    }
+
+    /**
+     * Take the latest frame if it is newer than afterSeq; the caller
+     * owns the returned reference (the slot's reference transfers) and
+     * must release() it. NULL when nothing new has been published.
+     */
+    SharedFrame* takeLatest(uint32_t afterSeq) {
+        SharedFrame* sf = NULL;
+        portENTER_CRITICAL(&mux);
+        if (latest != NULL && latest->seq > afterSeq) {
+            sf = latest;
+            latest = NULL;
+        }
+        portEXIT_CRITICAL(&mux);
+        return sf;
+    }
+
+    /**
+     * Viewer connect/disconnect; disconnecting drains the latest slot
+     * so its pinned buffer goes straight back to the driver
+     */
+    void setViewerActive(bool active) {
+        SharedFrame* parked = NULL;
+        portENTER_CRITICAL(&mux);
+        viewerActive = active;
+        if (!active) {
+            parked = latest;
+            latest = NULL;
+        }
+        portEXIT_CRITICAL(&mux);
+        if (parked != NULL) {
+            release(parked);
+        }
+    }
+
+    bool hasViewer() const {
+        return viewerActive;
+    }
+
+private:
+    SharedFrame pool[POOL_SIZE];
+    portMUX_TYPE mux;
+    uint32_t nextSeq;
+    SharedFrame* latest;
+    volatile bool viewerActive;
+};
+
+#endif  // FrameTee_h
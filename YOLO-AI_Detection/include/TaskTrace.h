@@ -0,0 +1,225 @@
+/**
+ * Task-timeline tracing: who actually ran, when, on which core
+ *
+ * test_task_independence.py probes scheduling from the outside through
+ * HTTP statistics, so a priority inversion between TaskHybridAI, the
+ * MQTT loop and the capture task can only ever be inferred. This
+ * module records the timeline on-device: every observed context switch
+ * becomes a compact event (timestamp, core, task id) in a per-core
+ * lock-free ring, and drain() streams the pending events plus a lazy
+ * task-name table out through any Print (serial or a TCP client).
+ *
+ * Two event sources feed the same ring:
+ *
+ *  - Exact kernel events, when the FreeRTOS kernel is built with
+ *      #define traceTASK_SWITCHED_IN() \
+ *          taskTraceSwitchedIn(xTaskGetCurrentTaskHandle())
+ *    wired to recordSwitchIn(). The Arduino core ships the kernel
+ *    precompiled, so this path needs an ESP-IDF build.
+ *
+ *  - Tick-hook sampling, which begin() registers on both cores and
+ *    works on the stock Arduino core: each 1ms tick compares the
+ *    running task against the previous tick and records a switch event
+ *    on change. Switches shorter than a tick are invisible, but the
+ *    interleaving of the millisecond-scale tasks this project runs
+ *    (capture, upload, inference wait, spool writes) is captured
+ *    faithfully.
+ *
+ * Stream format (one record per line, parse with the timeline script
+ * or by eye):
+ *   TRC v1 hz=1000000          session header, timestamp unit
+ *   TRC task <id> <name>       emitted once when a task first appears
+ *   TRC e <cpu> <id> <dus>     switch-in, dus = us since previous
+ *                              event on that cpu
+ *   TRC drop <n>               ring overflowed, n events lost
+ *
+ * The hooks cost a handle compare per tick per core; all naming and
+ * formatting happens in drain(), never in ISR context.
+ */
+
+#ifndef TaskTrace_h
+#define TaskTrace_h
+
+#include <Arduino.h>
+#include <esp_freertos_hooks.h>
+
+class TaskTrace {
+public:
+    static const size_t RING_SIZE = 256;   // events per core, power of two
+    static const size_t MAX_TASKS = 16;
+
+    /**
+     * Register the tick hooks on both cores and start recording.
+     */
+    bool begin() {
+        if (running) {
+            return true;
+        }
+        instance = this;
+        lastSeen[0] = NULL;
+        lastSeen[1] = NULL;
+        if (esp_register_freertos_tick_hook_for_cpu(tickHook, 0) != ESP_OK ||
+            esp_register_freertos_tick_hook_for_cpu(tickHook, 1) != ESP_OK) {
+            esp_deregister_freertos_tick_hook(tickHook);
+            return false;
+        }
+        running = true;
+        return true;
+    }
+
+    void end() {
+        if (running) {
+            esp_deregister_freertos_tick_hook(tickHook);
+            running = false;
+        }
+    }
+
+    bool isRunning() const {
+        return running;
+    }
+
+    /**
+     * The tracer currently receiving events, if any.
+     */
+    static TaskTrace* active() {
+        return instance;
+    }
+
+    /**
+     * Record a switch-in for the given task handle. ISR-safe; this is
+     * also the entry point for an exact traceTASK_SWITCHED_IN() hook.
+     */
+    void recordSwitchIn(void* handle, uint32_t cpu) {
+        const uint8_t id = taskId(handle);
+        Ring& r = ring[cpu & 1];
+        const uint16_t head = r.head;
+        const uint16_t next = (head + 1) & (RING_SIZE - 1);
+        if (next == r.tail) {
+            r.dropped++;
+            return;
+        }
+        r.events[head].us = (uint32_t)esp_timer_get_time();
+        r.events[head].task = id;
+        r.events[head].cpu = (uint8_t)(cpu & 1);
+        r.head = next;
+    }
+
+    /**
+     * Stream everything recorded since the last call. Run this from a
+     * low-priority task; it is the only reader of the rings and the
+     * only place task names are touched.
+     */
+    void drain(Print& out) {
+        if (!headerSent) {
+            out.println("TRC v1 hz=1000000");
+            headerSent = true;
+        }
+        for (int cpu = 0; cpu < 2; cpu++) {
+            Ring& r = ring[cpu];
+            while (r.tail != r.head) {
+                const Event& e = r.events[r.tail];
+                announce(out, e.task);
+                out.printf("TRC e %u %u %lu\n", e.cpu, e.task,
+                           (unsigned long)(e.us - r.lastDrainedUs));
+                r.lastDrainedUs = e.us;
+                r.tail = (uint16_t)((r.tail + 1) & (RING_SIZE - 1));
+            }
+            if (r.dropped) {
+                out.printf("TRC drop %lu\n", (unsigned long)r.dropped);
+                r.dropped = 0;
+            }
+        }
+    }
+
+private:
+    struct Event {
+        uint32_t us;
+        uint8_t task;
+        uint8_t cpu;
+    };
+
+    // Single writer (that core's tick hook) and single reader (drain)
+    // per ring, so head/tail need no locking
+    struct Ring {
+        Event events[RING_SIZE];
+        volatile uint16_t head = 0;
+        volatile uint16_t tail = 0;
+        volatile uint32_t dropped = 0;
+        uint32_t lastDrainedUs = 0;
+    };
+
+    /**
+     * Map a task handle onto a small stable id; slots are claimed once
+     * per task under a spinlock (both cores can discover tasks) and
+     * never reused.
+     */
+    uint8_t taskId(void* handle) {
+        for (uint8_t i = 0; i < slotCount; i++) {
+            if (slots[i] == handle) {
+                return i;
+            }
+        }
+        portENTER_CRITICAL_ISR(&slotMux);
+        uint8_t id = slotCount;
+        // Re-check: the other core may have claimed it meanwhile
+        for (uint8_t i = 0; i < slotCount; i++) {
+            if (slots[i] == handle) {
+                id = i;
+            }
+        }
+        if (id == slotCount && slotCount < MAX_TASKS) {
+            slots[slotCount] = handle;
+            slotCount++;
+        }
+        portEXIT_CRITICAL_ISR(&slotMux);
+        return (id < MAX_TASKS) ? id : (MAX_TASKS - 1);
+    }
+
+    void announce(Print& out, uint8_t id) {
+        if (id >= MAX_TASKS || announced[id]) {
+            return;
+        }
+        announced[id] = true;
+        const char* name = pcTaskGetName((TaskHandle_t)slots[id]);
+        out.printf("TRC task %u %s\n", id, name ? name : "?");
+    }
+
+    static void tickHook() {
+        TaskTrace* t = instance;
+        if (t == NULL) {
+            return;
+        }
+        const uint32_t cpu = xPortGetCoreID();
+        void* current = (void*)xTaskGetCurrentTaskHandleForCPU(cpu);
+        if (current != t->lastSeen[cpu]) {
+            t->lastSeen[cpu] = current;
+            t->recordSwitchIn(current, cpu);
+        }
+    }
+
+    static TaskTrace* instance;
+
+    Ring ring[2];
+    void* lastSeen[2] = {NULL, NULL};
+    void* slots[MAX_TASKS] = {};
+    bool announced[MAX_TASKS] = {};
+    volatile uint8_t slotCount = 0;
+    portMUX_TYPE slotMux = portMUX_INITIALIZER_UNLOCKED;
+    bool running = false;
+    bool headerSent = false;
+};
+
+TaskTrace* TaskTrace::instance = NULL;
+
+/**
+ * Exact-event entry point for a kernel built with the trace macros
+ * (see the header comment); a no-op while no tracer is running.
+ */
+inline void taskTraceSwitchedIn(void* handle) {
+    TaskTrace* t = TaskTrace::active();
+    if (t != NULL && t->isRunning()) {
+        t->recordSwitchIn(handle, xPortGetCoreID());
+    }
+}
+
+#endif  // TaskTrace_h
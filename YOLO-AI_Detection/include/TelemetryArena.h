@@ -0,0 +1,130 @@
+/**
+ * Fixed-capacity allocation arena backing the telemetry JsonDocuments
+ *
+ * Every processing cycle used to build its JsonDocuments on the heap
+ * through the default ArduinoJson allocator, a steady drip of
+ * malloc/free that fragments the heap the camera and TLS buffers live
+ * in. The arena is carved out once at startup; documents constructed
+ * with it bump-allocate out of the block and the whole arena is reset
+ * at the top of each cycle, so steady-state telemetry does zero heap
+ * transactions. highWaterMark() reports the most bytes a cycle has
+ * ever needed, for sizing the arena from field data.
+ *
+ * All documents sharing one arena must be used from the same task, and
+ * none may outlive the reset() of the next cycle.
+ */
+
+#ifndef TelemetryArena_h
+#define TelemetryArena_h
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+class TelemetryArena : public ArduinoJson::Allocator {
+public:
+    explicit TelemetryArena(size_t capacityBytes)
+        : bufferSize(capacityBytes), used(0), peakUsed(0), overflows(0) {
+        // One allocation at startup, before the heap fragments
+        buffer = (uint8_t*)malloc(bufferSize);
+        if (buffer == NULL) {
+            bufferSize = 0;
+        }
+    }
+
+    ~TelemetryArena() {
+        free(buffer);
+    }
+
+    /**
+     * Drop everything allocated since the last reset, call at the top
+     * of each cycle after the previous cycle's documents are dead
+     */
+    void reset() {
+        used = 0;
+    }
+
+    /**
+     * Most bytes any cycle has needed so far, for sizing the arena
+     */
+    size_t highWaterMark() const {
+        return peakUsed;
+    }
+
+    size_t capacity() const {
+        return bufferSize;
+    }
+
+    /**
+     * Cycles that ran out of arena and had their document truncated,
+     * any value above zero means the arena is undersized
+     */
+    size_t overflowCount() const {
+        return overflows;
+    }
+
+    // ArduinoJson::Allocator interface. Each block is prefixed with its
+    // size so reallocate can copy the old contents
+    void* allocate(size_t size) override {
+        size_t total = align(sizeof(size_t) + size);
+        if (used + total > bufferSize) {
+            overflows++;
+            return NULL;  // the document reports an overflow
+        }
+        uint8_t* block = buffer + used;
+        used += total;
+        if (used > peakUsed) {
+            peakUsed = used;
+        }
+        *(size_t*)block = size;
+        return block + sizeof(size_t);
+    }
+
+    void deallocate(void* pointer) override {
+        // Individual blocks are never returned, reset() reclaims all
+        (void)pointer;
+    }
+
+    void* reallocate(void* pointer, size_t newSize) override {
+        if (pointer == NULL) {
+            return allocate(newSize);
+        }
+
+        uint8_t* block = (uint8_t*)pointer - sizeof(size_t);
+        size_t oldSize = *(size_t*)block;
+
+        // Growing the most recent block just moves the bump pointer
+        if (block + align(sizeof(size_t) + oldSize) == buffer + used) {
+            size_t total = align(sizeof(size_t) + newSize);
+            if ((size_t)(block - buffer) + total > bufferSize) {
+                overflows++;
+                return NULL;
+            }
+            used = (block - buffer) + total;
+            if (used > peakUsed) {
+                peakUsed = used;
+            }
+            *(size_t*)block = newSize;
+            return pointer;
+        }
+
+        void* grown = allocate(newSize);
+        if (grown != NULL) {
+            memcpy(grown, pointer, oldSize < newSize ? oldSize : newSize);
+        }
+        return grown;
+    }
+
+private:
+    // Keep blocks aligned for the pointers ArduinoJson stores in them
+    static size_t align(size_t size) {
+        return (size + 7) & ~(size_t)7;
+    }
+
+    uint8_t* buffer;
+    size_t bufferSize;
+    size_t used;
+    size_t peakUsed;
+    size_t overflows;
+};
+
+#endif  // TelemetryArena_h
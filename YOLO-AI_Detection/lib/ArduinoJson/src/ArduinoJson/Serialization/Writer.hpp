@@ -44,4 +44,5 @@ ARDUINOJSON_END_PRIVATE_NAMESPACE
 
 #if ARDUINOJSON_ENABLE_ARDUINO_PRINT
 #  include <ArduinoJson/Serialization/Writers/PrintWriter.hpp>
+#  include <ArduinoJson/Serialization/Writers/ClientWriter.hpp>
 #endif
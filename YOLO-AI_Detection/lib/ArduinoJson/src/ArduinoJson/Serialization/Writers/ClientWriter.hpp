@@ -0,0 +1,74 @@
+// ArduinoJson - https://arduinojson.org
+// Copyright © 2014-2023, Benoit BLANCHON
+// MIT License
+
+#pragma once
+
+#include <Arduino.h>
+#include <Client.h>
+
+#include <string.h>  // memcpy
+
+#ifndef ARDUINOJSON_CLIENT_WRITE_BUFFER_SIZE
+#  define ARDUINOJSON_CLIENT_WRITE_BUFFER_SIZE 256
+#endif
+
+ARDUINOJSON_BEGIN_PRIVATE_NAMESPACE
+
+// Network clients pay a per-call overhead for every write() (packetization,
+// in the worst case one TCP segment per call), so instead of forwarding each
+// byte individually like the regular Print writer does, this writer
+// accumulates the serializer output in a small buffer and hands it to the
+// client in bulk.
+// The serializer only writes through the innermost copy of the writer, so the
+// copies made on the way into CountingDecorator all carry an empty buffer and
+// flushing from the destructor emits each byte exactly once.
+template <typename TDestination>
+class Writer<
+    TDestination,
+    typename enable_if<is_base_of<::Client, TDestination>::value>::type> {
+ public:
+  explicit Writer(::Client& client) : client_(&client), size_(0) {}
+
+  Writer(const Writer& src) : client_(src.client_), size_(src.size_) {
+    memcpy(buffer_, src.buffer_, src.size_);
+  }
+
+  ~Writer() {
+    flush();
+  }
+
+  size_t write(uint8_t c) {
+    if (size_ == sizeof(buffer_))
+      flush();
+    buffer_[size_++] = c;
+    return 1;
+  }
+
+  size_t write(const uint8_t* s, size_t n) {
+    if (n >= sizeof(buffer_)) {
+      // fragment doesn't fit anyway, send it to the client directly
+      flush();
+      return client_->write(s, n);
+    }
+    if (size_ + n > sizeof(buffer_))
+      flush();
+    memcpy(buffer_ + size_, s, n);
+    size_ += n;
+    return n;
+  }
+
+  void flush() {
+    if (size_ == 0)
+      return;
+    client_->write(buffer_, size_);
+    size_ = 0;
+  }
+
+ private:
+  ::Client* client_;
+  uint8_t buffer_[ARDUINOJSON_CLIENT_WRITE_BUFFER_SIZE];
+  size_t size_;
+};
+
+ARDUINOJSON_END_PRIVATE_NAMESPACE
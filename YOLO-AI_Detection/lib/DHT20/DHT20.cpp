@@ -19,8 +19,8 @@ DHT20::DHT20(TwoWire *wire)
 {
   _wire        = wire;
   //  reset() ?
-  _temperature = 0;
-  _humidity    = 0;
+  _centiTemperature = 0;
+  _centiHumidity    = 0;
   _humOffset   = 0;
   _tempOffset  = 0;
   _status      = DHT20_OK;
@@ -157,20 +157,25 @@ int DHT20::readData()
 int DHT20::convert()
 {
   //  CONVERT AND STORE
+  //  pure integer fixed point (0.01 unit resolution), so the conversion
+  //  costs no FPU / soft-float work and is safe inside ISRs and timer
+  //  callbacks when driven through the asynchronous API.
   _status      = _bits[0];
   uint32_t raw = _bits[1];
   raw <<= 8;
   raw += _bits[2];
   raw <<= 4;
   raw += (_bits[3] >> 4);
-  _humidity = raw * 9.5367431640625e-5;   // ==> / 1048576.0 * 100%;
+  //  % * 100 = raw / 2^20 * 10000 = raw * 625 / 2^16  (max 2^20 * 625 < 2^31)
+  _centiHumidity = (int32_t)((raw * 625UL + 32768UL) >> 16);
 
   raw = (_bits[3] & 0x0F);
   raw <<= 8;
   raw += _bits[4];
   raw <<= 8;
   raw += _bits[5];
-  _temperature = raw * 1.9073486328125e-4 - 50;  //  ==> / 1048576.0 * 200 - 50;
+  //  °C * 100 = raw / 2^20 * 20000 - 5000 = raw * 1250 / 2^16 - 5000
+  _centiTemperature = (int32_t)((raw * 1250UL + 32768UL) >> 16) - 5000;
 
   //  TEST CHECKSUM
   uint8_t _crc = _crc8(_bits, 6);
@@ -189,13 +194,25 @@ int DHT20::convert()
 //
 float DHT20::getHumidity()
 {
-  return _humidity + _humOffset;
+  return _centiHumidity * 0.01f + _humOffset;
 };
 
 
 float DHT20::getTemperature()
 {
-  return _temperature + _tempOffset;
+  return _centiTemperature * 0.01f + _tempOffset;
+};
+
+
+int32_t DHT20::getCentiHumidity()
+{
+  return _centiHumidity;
+};
+
+
+int32_t DHT20::getCentiTemperature()
+{
+  return _centiTemperature;
 };
 
 
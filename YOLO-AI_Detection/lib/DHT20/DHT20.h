@@ -60,8 +60,13 @@ public:
   //  blocking read call to read + convert data
   int      read();
   //  access the converted temperature & humidity
+  //  float view over the internal fixed point values
   float    getHumidity();
   float    getTemperature();
+  //  raw fixed point access in 0.01 units (centi-% / centi-°C),
+  //  no float involved, offsets not applied
+  int32_t  getCentiHumidity();
+  int32_t  getCentiTemperature();
 
 
   //  OFFSET  1st order adjustments
@@ -98,8 +103,9 @@ public:
 
 
 private:
-  float    _humidity;
-  float    _temperature;
+  //  converted values in 0.01 units, conversion is pure integer math
+  int32_t  _centiHumidity;
+  int32_t  _centiTemperature;
   float    _humOffset;
   float    _tempOffset;
 
@@ -417,5 +417,24 @@ if __name__ == "__main__":
     print("- GET /api/models - Available models")
     print("- GET /api/health - Health check")
     
+    # Advertise _aidetect._tcp via mDNS so the cameras can discover this
+    # host after a DHCP lease change instead of hardcoding the IP.
+    # Optional: without zeroconf installed the devices use their fallback.
+    try:
+        import socket
+        from zeroconf import Zeroconf, ServiceInfo
+
+        ip = socket.gethostbyname(socket.gethostname())
+        service = ServiceInfo(
+            "_aidetect._tcp.local.",
+            "ai-server._aidetect._tcp.local.",
+            addresses=[socket.inet_aton(ip)],
+            port=5001,
+        )
+        Zeroconf().register_service(service)
+        print(f"Advertising _aidetect._tcp at {ip}:5001 via mDNS")
+    except Exception as exc:
+        print(f"mDNS advertisement unavailable ({exc}), devices will use their fallback IP")
+
     print("\nStarting server on http://0.0.0.0:5001")
-    app.run(host="0.0.0.0", port=5001, debug=False) 
\ No newline at end of file
+    app.run(host="0.0.0.0", port=5001, debug=False)
\ No newline at end of file
@@ -50,12 +50,24 @@ using eloq::ei::fomo;
 #define DETECTION_THRESHOLD 0.7  // Confidence threshold
 #define DETECTION_INTERVAL 2000  // Detection interval in ms
 
+// Two-stage alerting: the on-device FOMO result raises a local alarm
+// immediately (sub-second latency, works without WAN), the server-side
+// YOLO pass is only used as confirmation afterwards
+#define MQTT_CONFIRMATION_TOPIC "coreiot/device123/confirmation_requests"
+#define OFFLINE_ALERT_BUFFER 8   // Alerts buffered while MQTT is down
+
 WiFiClient espClient;
 PubSubClient mqttClient(espClient);
 
 unsigned long lastDetectionTime = 0;
 bool isDetectionEnabled = true;
 
+// Ring buffer of serialized alerts that could not be published while
+// the connection was down, flushed in order on reconnect
+char offlineAlerts[OFFLINE_ALERT_BUFFER][512];
+int offlineAlertCount = 0;
+int offlineAlertHead = 0;
+
 /**
  * Connect to WiFi network
  */
@@ -94,19 +106,48 @@ void mqttCallback(char* topic, byte* payload, unsigned int length) {
 }
 
 /**
- * Connect to MQTT broker
+ * Flush alerts that were raised while the connection was down
+ */
+void flushOfflineAlerts() {
+    while (offlineAlertCount > 0 && mqttClient.connected()) {
+        int index = (offlineAlertHead + OFFLINE_ALERT_BUFFER - offlineAlertCount) % OFFLINE_ALERT_BUFFER;
+        mqttClient.publish(MQTT_DETECTION_TOPIC, offlineAlerts[index]);
+        offlineAlertCount--;
+        Serial.println("Flushed buffered offline alert");
+    }
+}
+
+/**
+ * Publish now if connected, otherwise buffer until reconnect so local
+ * detections survive a WAN outage
+ */
+void publishOrBuffer(const char* topic, const char* payload) {
+    if (mqttClient.connected() && mqttClient.publish(topic, payload)) {
+        return;
+    }
+    
+    strncpy(offlineAlerts[offlineAlertHead], payload, sizeof(offlineAlerts[0]) - 1);
+    offlineAlerts[offlineAlertHead][sizeof(offlineAlerts[0]) - 1] = '\0';
+    offlineAlertHead = (offlineAlertHead + 1) % OFFLINE_ALERT_BUFFER;
+    if (offlineAlertCount < OFFLINE_ALERT_BUFFER) {
+        offlineAlertCount++;
+    }
+    Serial.println("MQTT down, alert buffered locally");
+}
+
+/**
+ * Connect to MQTT broker (single attempt, the detection loop must keep
+ * running locally even while the broker is unreachable)
  */
 void connectToMQTT() {
-    while (!mqttClient.connected()) {
-        Serial.print("Connecting to MQTT...");
-        
-        if (mqttClient.connect("ESP32CAM_AI_Client", MQTT_USER, MQTT_PASSWORD)) {
-            Serial.println("Connected!");
-            mqttClient.subscribe("coreiot/device123/commands");
-        } else {
-            Serial.printf("Failed, rc=%d. Retrying in 5s...\n", mqttClient.state());
-            delay(5000);
-        }
+    Serial.print("Connecting to MQTT...");
+    
+    if (mqttClient.connect("ESP32CAM_AI_Client", MQTT_USER, MQTT_PASSWORD)) {
+        Serial.println("Connected!");
+        mqttClient.subscribe("coreiot/device123/commands");
+        flushOfflineAlerts();
+    } else {
+        Serial.printf("Failed, rc=%d\n", mqttClient.state());
     }
 }
 
@@ -122,6 +163,8 @@ void publishDetectionResults(int objectCount, const char* primaryObject, float c
     doc["detection"]["primary_object"] = primaryObject;
     doc["detection"]["confidence"] = confidence;
     doc["detection"]["threshold"] = DETECTION_THRESHOLD;
+    doc["detection"]["method"] = "on_device_fomo";
+    doc["detection"]["confirmed"] = false;  // Server YOLO confirms asynchronously
     
     // Add alert status for fire detection
     if (strcmp(primaryObject, "fire") == 0 && confidence > DETECTION_THRESHOLD) {
@@ -133,8 +176,23 @@ void publishDetectionResults(int objectCount, const char* primaryObject, float c
     char jsonBuffer[512];
     serializeJson(doc, jsonBuffer);
     
-    mqttClient.publish(MQTT_DETECTION_TOPIC, jsonBuffer);
+    // Local alarm first, buffered if the broker is unreachable
+    publishOrBuffer(MQTT_DETECTION_TOPIC, jsonBuffer);
     Serial.printf("Published detection: %s\n", jsonBuffer);
+    
+    // Second stage: ask the server-side YOLO pass to confirm the
+    // on-device result with a full-resolution detection
+    if (strcmp(primaryObject, "fire") == 0 && mqttClient.connected()) {
+        StaticJsonDocument<192> confirmation;
+        confirmation["device_id"] = "ESP32CAM_AI_001";
+        confirmation["timestamp"] = millis();
+        confirmation["class"] = primaryObject;
+        confirmation["local_confidence"] = confidence;
+        
+        char confirmationBuffer[192];
+        serializeJson(confirmation, confirmationBuffer);
+        mqttClient.publish(MQTT_CONFIRMATION_TOPIC, confirmationBuffer);
+    }
 }
 
 /**
@@ -220,10 +278,12 @@ void runAIDetection() {
  */
 void TaskAIDetection(void *pvParameters) {
     Serial.println("AI Detection task started");
+    unsigned long lastMqttAttempt = 0;
     
     while (1) {
-        // Ensure MQTT connection
-        if (!mqttClient.connected()) {
+        // Retry MQTT in the background, never block local detection on it
+        if (!mqttClient.connected() && millis() - lastMqttAttempt >= 5000) {
+            lastMqttAttempt = millis();
             connectToMQTT();
         }
         mqttClient.loop();
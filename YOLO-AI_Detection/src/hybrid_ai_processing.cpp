@@ -14,11 +14,18 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
+#include <ESPmDNS.h>
+#include <Preferences.h>
+#include <LittleFS.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
-#include <base64.h>
 #include "esp_camera.h"
+#include "esp_heap_caps.h"
+#include <sys/time.h>
+#include "Base64PrintEncoder.h"
+#include "TelemetryArena.h"
+#include "TaskTrace.h"
+#include "FrameTee.h"
 
 // Camera pin configuration for AI Thinker ESP32-CAM
 #define PWDN_GPIO_NUM     32
@@ -43,28 +50,194 @@
 #define WIFI_PASSWORD "YOUR_WIFI_PASSWORD"  // ⚠️ CHANGE THIS to your WiFi password
 
 // Server Configuration
-#define AI_SERVER_URL "http://192.168.15.4:5001/api/detect"  // ✅ Updated with your Mac's IP and correct port
+// Persistent binary detection stream, each frame is sent as a 4-byte
+// big-endian length prefix followed by the raw JPEG, the server answers
+// with a length-prefixed JSON result on the same socket
+#define AI_SERVER_HOST "192.168.15.4"  // ✅ Updated with your Mac's IP
+#define AI_SERVER_PORT 5001
 #define SERVER_TIMEOUT 10000  // 10 seconds timeout
 
+// Service discovery: the server host changes address with every DHCP
+// lease, and a per-request DNS lookup adds latency to every capture
+// cycle. The endpoint is resolved once from the _aidetect._tcp service
+// the server advertises via mDNS, cached in RAM and NVS (so a reboot
+// skips the query too), and re-resolved only after a connect failure.
+// AI_SERVER_HOST above stays as the static fallback when nothing
+// advertises the service.
+#define AI_SERVER_SERVICE "aidetect"
+
+// Set to 1 to talk to the legacy Flask server, which still expects the
+// base64-in-JSON POST on /api/detect. The base64 output is streamed
+// chunk-wise into the socket, so even this path never allocates the
+// encoded image as a whole
+#define USE_LEGACY_BASE64_SERVER 0
+#define LEGACY_SERVER_PATH "/api/detect"
+
 // MQTT Configuration
 #define MQTT_BROKER "app.coreiot.io"
 #define MQTT_PORT 1883
 #define MQTT_USER "iot_farm"
 #define MQTT_PASSWORD "123456789"
 #define MQTT_DETECTION_TOPIC "coreiot/device123/ai_detections"
+#define MQTT_EVIDENCE_TOPIC "coreiot/device123/ai_evidence"
+#define MQTT_ACK_TOPIC "coreiot/device123/command_ack"
 
 // Detection Settings
-#define CAPTURE_INTERVAL 5000     // Capture every 5 seconds
+#define CAPTURE_INTERVAL 5000     // Default capture interval
 #define DETECTION_THRESHOLD 0.7   // Confidence threshold
 #define MAX_IMAGE_SIZE 100000     // Maximum image size in bytes
 
+// Frames older than this at upload time are dropped instead of sent: a
+// stale frame answering "is there fire right now" is worse than waiting
+// one capture interval for a fresh one. CAMERA_GRAB_LATEST guarantees
+// the frame was the newest available at capture; this guards the time
+// it can spend queued behind a slow upload afterwards.
+#define MAX_FRAME_AGE_MS 2000
+
+// Adaptive capture controller: recent detections shorten the interval
+// and raise JPEG quality (escalation), quiet periods back off towards
+// the idle settings so steady-state upstream traffic stays low
+#define ESCALATED_CAPTURE_INTERVAL 1000   // Interval while detections are active
+#define MAX_CAPTURE_INTERVAL 60000        // Upper bound while the scene is quiet
+#define ESCALATED_JPEG_QUALITY 10         // Higher quality for confirmation frames
+#define IDLE_JPEG_QUALITY 20              // Cheaper frames while nothing happens
+#define QUIET_RESPONSES_BEFORE_BACKOFF 3  // Empty responses before backing off
+
+// Fleet phase spreading: every device ships the same CAPTURE_INTERVAL,
+// so after a power restoration the whole fleet boots together and
+// uploads in phase — the server sees the full fleet every interval as
+// one synchronized burst. Each device derives a stable offset from its
+// MAC and waits it out before the first capture, which spreads the
+// steady-state schedule uniformly across the interval with no
+// coordination traffic and no average-rate cost. On top of that the
+// server can advertise a congestion hint in any detection response
+// ("congestion": 0.0-1.0); the capture interval stretches by up to
+// CONGESTION_MAX_STRETCH_PCT while the hint is raised and snaps back
+// as soon as responses stop carrying it.
+#define CONGESTION_MAX_STRETCH_PCT 100    // +100% interval at congestion 1.0
+
+// Scheduling visibility: test_task_independence.py can only infer task
+// interleaving from the outside. With tracing armed ("trace_on" over
+// MQTT) a tick hook on each core records every observed context switch
+// into TaskTrace's rings and loop() streams the timeline out over
+// serial, so capture/inference/MQTT priority inversions show up as
+// events instead of guesses. Recording costs one handle compare per
+// tick per core while armed and nothing at all while off.
+#define TASK_TRACE_DRAIN_MS 500           // Timeline flush cadence while armed
+
+// Region of interest: our cameras watch fixed scenes where only part
+// of the frame matters (crop rows, burner area). The window is applied
+// inside the sensor pipeline before JPEG encoding, so cropping and
+// downscaling cost no CPU time and every byte that leaves the sensor
+// is a byte worth uploading. Configured at runtime via MQTT:
+//   set_roi:x,y,w,h[,out_w,out_h]   clear_roi
+#define FRAME_WIDTH 640
+#define FRAME_HEIGHT 480
+
+// Batch uploads: low-priority survey frames (quiet scene, long
+// interval) are accumulated in PSRAM and pushed as one batch message,
+// so the server can run YOLO with a real GPU batch size instead of 1
+// and the per-message overhead is amortized. Escalated frames are
+// always sent individually for latency. 0 disables batching.
+#define FRAME_BATCH_SIZE 4
+#define FRAME_BATCH_MARKER 0xFFFFFFFF  // Length prefix value announcing a batch
+
+// Motion gate settings: a frame is only uploaded when its blocked
+// signature differs enough from the previously uploaded one, static
+// scenes (~95% of frames in the field) never leave the device
+#define MOTION_GATE_BLOCKS 32         // Signature blocks per frame
+#define MOTION_GATE_THRESHOLD_PCT 3   // Minimum change in percent to count as motion
+#define MOTION_GATE_MAX_SKIP 12       // Force an upload after this many gated frames
+
+// MJPEG live view: http://<device>:81/ serves a multipart stream for
+// operators. Frames are shared with the upload pipeline through the
+// refcounted tee (see FrameTee.h) — the viewer reads the same PSRAM
+// buffer the AI upload streams from, no frame is ever copied for the
+// stream. While a viewer is connected the capture task also grabs
+// view-only frames between detection captures, so the live view stays
+// live even when the adaptive controller has backed the detection
+// interval off to a minute.
+#define MJPEG_STREAM_PORT 81
+#define MJPEG_VIEW_INTERVAL_MS 250    // View-only capture cadence, ~4 fps
+
+// Arena backing all JsonDocuments of one processing cycle (server
+// responses, alerts, batch fan-out), reset per cycle so telemetry
+// serialization never touches the heap in steady state. Size it from
+// the high-water mark logged by the AI task
+#define TELEMETRY_ARENA_SIZE 8192
+
+// Outbound MQTT send queue tuning (see the tiered queue section below):
+// small tiers hold serialized JSON messages, the bulk tier holds PSRAM
+// copies of evidence JPEGs, uploaded in segments so a pending alert
+// only ever waits for one segment, not a whole image
+#define SEND_SMALL_DEPTH 4            // Queued messages per small tier
+#define SEND_SMALL_BYTES 1024         // Matches the alert serialization buffer
+#define SEND_BULK_DEPTH 2             // Evidence frames waiting in PSRAM
+#define SEND_BULK_SEGMENT_BYTES 8192  // ~tens of ms on the air per segment
+
+// Flash spool for frames that fail upload: when the AI server is
+// unreachable the frame that matters most (the one showing ignition)
+// must not be the one dropped. Failed frames go to LittleFS via a
+// low-priority writer task in flash-page-sized chunks and are re-sent
+// for detection once the server is back; the quota evicts oldest-first
+#define SPOOL_DIR "/spool"
+#define SPOOL_QUOTA_BYTES (900 * 1024)  // Leave LittleFS some headroom
+#define SPOOL_WRITE_CHUNK 4096          // One flash page per write call
+#define SPOOL_QUEUE_DEPTH 4             // Covers a failed full batch
+
 WiFiClient espClient;
 PubSubClient mqttClient(espClient);
-HTTPClient http;
+WiFiClient aiClient;
+WiFiServer mjpegServer(MJPEG_STREAM_PORT);
+
+// Refcounted frame fan-out between the upload pipeline and the viewer
+FrameTee frameTee;
+
+// All telemetry documents are built in here by the AI task
+TelemetryArena telemetryArena(TELEMETRY_ARENA_SIZE);
+
+// Context-switch timeline recorder, armed on demand (see TaskTrace.h)
+TaskTrace taskTrace;
+unsigned long lastTraceDrainMs = 0;
 
 unsigned long lastCaptureTime = 0;
 bool isDetectionEnabled = true;
 
+// Runtime detection threshold: DETECTION_THRESHOLD is only the
+// compiled default, the live value persists in NVS and is retuned
+// fleet-wide with a "set_threshold:<v>" command instead of a reflash
+volatile float detectionThreshold = DETECTION_THRESHOLD;
+Preferences configPrefs;
+
+// Adaptive capture controller state
+volatile unsigned long captureIntervalMs = CAPTURE_INTERVAL;
+unsigned long bandwidthBudgetKbps = 0;  // 0 = unlimited, settable via MQTT
+size_t lastUploadBytes = 0;
+int quietResponseCount = 0;
+
+// Fleet coordination state (see the phase spreading settings above)
+unsigned long capturePhaseMs = 0;
+volatile float serverCongestionHint = 0.0f;
+
+// Pending batch of low-priority frames, copied to PSRAM so the two
+// camera frame buffers stay available to the driver
+struct PendingFrame {
+    uint8_t* data;
+    size_t len;
+};
+PendingFrame pendingBatch[FRAME_BATCH_SIZE > 0 ? FRAME_BATCH_SIZE : 1];
+int pendingBatchCount = 0;
+unsigned int frameBatchSize = FRAME_BATCH_SIZE;  // Settable via MQTT
+
+// Producer/consumer pipeline: the capture task on core 0 pushes finished
+// frames into this queue, the upload task on core 1 drains it. Depth 1 is
+// enough - with fb_count = 2 one buffer is in flight to the server while
+// the driver fills the other one. Items are FrameTee descriptors; the
+// queue holds the reference the capture task took at wrap time and the
+// upload task releases it when done.
+QueueHandle_t frameQueue = NULL;
+#define FRAME_QUEUE_DEPTH 1
+
 /**
  * Initialize camera with optimal settings
  */
@@ -94,7 +267,12 @@ bool initCamera() {
     // Higher resolution for better AI accuracy
     config.frame_size = FRAMESIZE_VGA;  // 640x480
     config.jpeg_quality = 12;           // Lower number = higher quality
-    config.fb_count = 1;
+    // Two frame buffers in PSRAM so the sensor can already fill the next
+    // frame while the previous one is being encoded and uploaded, instead
+    // of sitting idle for the whole HTTP round trip
+    config.fb_count = 2;
+    config.fb_location = CAMERA_FB_IN_PSRAM;
+    config.grab_mode = CAMERA_GRAB_LATEST;
     
     // Initialize camera
     esp_err_t err = esp_camera_init(&config);
@@ -134,6 +312,21 @@ bool initCamera() {
     return true;
 }
 
+/**
+ * Age of a frame buffer in milliseconds
+ *
+ * The driver stamps every buffer at VSYNC (fb->timestamp), so this
+ * measures real sensor-to-now staleness, including time spent in the
+ * hand-off queue — not just time since esp_camera_fb_get() returned.
+ */
+uint32_t frameAgeMs(const camera_fb_t* fb) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    int64_t ageUs = (int64_t)(now.tv_sec - fb->timestamp.tv_sec) * 1000000LL +
+                    (now.tv_usec - fb->timestamp.tv_usec);
+    return (ageUs > 0) ? (uint32_t)(ageUs / 1000) : 0;
+}
+
 /**
  * Connect to WiFi network
  */
@@ -154,12 +347,20 @@ void connectToWiFi() {
  * Connect to MQTT broker
  */
 void connectToMQTT() {
+    // Persistent session: the broker keeps our command subscription across
+    // reconnects, so we only pay the SUBSCRIBE round trip once and the
+    // first buffered publish can go out immediately after CONNACK
+    static bool subscribed = false;
     while (!mqttClient.connected()) {
         Serial.print("Connecting to MQTT...");
         
-        if (mqttClient.connect("ESP32CAM_Hybrid_AI", MQTT_USER, MQTT_PASSWORD)) {
+        if (mqttClient.connect("ESP32CAM_Hybrid_AI", MQTT_USER, MQTT_PASSWORD,
+                               NULL, 0, false, NULL, false /* clean_session */)) {
             Serial.println("Connected!");
-            mqttClient.subscribe("coreiot/device123/commands");
+            if (!subscribed) {
+                mqttClient.subscribe("coreiot/device123/commands");
+                subscribed = true;
+            }
         } else {
             Serial.printf("Failed, rc=%d. Retrying in 5s...\n", mqttClient.state());
             delay(5000);
@@ -167,6 +368,334 @@ void connectToMQTT() {
     }
 }
 
+/**
+ * Priority-tiered outbound MQTT queues
+ *
+ * A FIRE_DETECTED alert used to enter the same socket write path as a
+ * ~60KB evidence JPEG, so an alert raised behind queued bulk traffic
+ * waited for the whole image. Publishes now go into one of four tiers
+ * — alert, command ack, telemetry, bulk evidence — and sendPump()
+ * drains them in strict priority order. Bulk payloads are split into
+ * SEND_BULK_SEGMENT_BYTES segments published as individual MQTT
+ * messages, and the small tiers (plus the command callback, via
+ * mqttClient.loop()) are serviced between segments, so a higher-tier
+ * message preempts a partially-sent evidence frame at the next segment
+ * boundary instead of waiting out the remaining image.
+ *
+ * Evidence wire format: each segment on MQTT_EVIDENCE_TOPIC starts
+ * with a 10-byte header — "EV01", frame id (u16 BE), segment index
+ * (u16 BE), segment count (u16 BE) — followed by that slice of the
+ * JPEG; consumers reassemble by frame id. (Same spirit as the
+ * FRAME_BATCH_MARKER framing on the AI socket.)
+ */
+enum SendTier {
+    SEND_TIER_ALERT = 0,    // Fire/critical detections
+    SEND_TIER_ACK,          // Command acknowledgements
+    SEND_TIER_TELEMETRY,    // Routine detection reports
+    SEND_TIER_SMALL_COUNT,
+};
+
+struct SmallMessage {
+    char topic[40];
+    uint8_t payload[SEND_SMALL_BYTES];
+    uint16_t len;
+};
+
+// Small tiers are rings; the bulk tier holds PSRAM copies so the camera
+// frame buffer goes back to the driver before the upload starts
+struct SmallTierQueue {
+    SmallMessage slot[SEND_SMALL_DEPTH];
+    int head;
+    int count;
+};
+struct BulkMessage {
+    uint8_t* data;
+    size_t len;
+    uint16_t frameId;
+};
+
+SmallTierQueue sendTiers[SEND_TIER_SMALL_COUNT];
+BulkMessage bulkQueue[SEND_BULK_DEPTH];
+int bulkHead = 0;
+int bulkCount = 0;
+unsigned long sendDropped = 0;
+uint16_t nextEvidenceFrameId = 0;
+
+/**
+ * Queue a serialized message on one of the small tiers
+ *
+ * Queues survive a broker reconnect, so an alert raised while the
+ * connection is down goes out right after the next CONNACK.
+ */
+bool sendEnqueue(SendTier tier, const char* topic, const uint8_t* payload, size_t len) {
+    SmallTierQueue& q = sendTiers[tier];
+    if (len > SEND_SMALL_BYTES || q.count >= SEND_SMALL_DEPTH) {
+        sendDropped++;
+        Serial.printf("Send queue full, dropped tier %d message\n", (int)tier);
+        return false;
+    }
+    SmallMessage& m = q.slot[(q.head + q.count) % SEND_SMALL_DEPTH];
+    snprintf(m.topic, sizeof(m.topic), "%s", topic);
+    memcpy(m.payload, payload, len);
+    m.len = len;
+    q.count++;
+    return true;
+}
+
+/**
+ * Publish one segment of a bulk message, chunk-streamed from PSRAM
+ */
+bool publishBulkSegment(const BulkMessage& m, size_t offset, uint16_t segIndex, uint16_t segCount) {
+    size_t segLen = m.len - offset;
+    if (segLen > SEND_BULK_SEGMENT_BYTES) {
+        segLen = SEND_BULK_SEGMENT_BYTES;
+    }
+    uint8_t header[10] = {
+        'E', 'V', '0', '1',
+        (uint8_t)(m.frameId >> 8), (uint8_t)m.frameId,
+        (uint8_t)(segIndex >> 8), (uint8_t)segIndex,
+        (uint8_t)(segCount >> 8), (uint8_t)segCount,
+    };
+    if (!mqttClient.beginPublish(MQTT_EVIDENCE_TOPIC, sizeof(header) + segLen, false)) {
+        return false;
+    }
+    mqttClient.write(header, sizeof(header));
+    const size_t chunkSize = 1024;
+    for (size_t sent = 0; sent < segLen; sent += chunkSize) {
+        size_t chunk = segLen - sent;
+        if (chunk > chunkSize) {
+            chunk = chunkSize;
+        }
+        mqttClient.write(m.data + offset + sent, chunk);
+    }
+    return mqttClient.endPublish();
+}
+
+/**
+ * Drain the small tiers in strict priority order
+ */
+void sendPumpSmallTiers() {
+    for (int t = 0; t < SEND_TIER_SMALL_COUNT; t++) {
+        SmallTierQueue& q = sendTiers[t];
+        while (q.count > 0) {
+            SmallMessage& m = q.slot[q.head];
+            if (!mqttClient.publish(m.topic, m.payload, m.len)) {
+                return;  // Socket trouble; keep the message for the reconnect
+            }
+            q.head = (q.head + 1) % SEND_SMALL_DEPTH;
+            q.count--;
+        }
+    }
+}
+
+/**
+ * Drain everything queued, highest tier first
+ *
+ * Between bulk segments the broker connection is serviced and the small
+ * tiers re-drained — this is the preemption point: a command arriving
+ * mid-upload gets its ack published after at most one segment.
+ */
+void sendPump() {
+    if (!mqttClient.connected()) {
+        return;
+    }
+    sendPumpSmallTiers();
+    while (bulkCount > 0) {
+        BulkMessage& m = bulkQueue[bulkHead];
+        uint16_t segCount = (m.len + SEND_BULK_SEGMENT_BYTES - 1) / SEND_BULK_SEGMENT_BYTES;
+        bool ok = true;
+        for (uint16_t seg = 0; seg < segCount && ok; seg++) {
+            ok = publishBulkSegment(m, (size_t)seg * SEND_BULK_SEGMENT_BYTES, seg, segCount);
+            mqttClient.loop();
+            sendPumpSmallTiers();
+        }
+        if (ok) {
+            Serial.printf("Published evidence frame %u (%u bytes, %u segment(s))\n",
+                          m.frameId, (unsigned)m.len, segCount);
+        } else {
+            // A frame with missing segments cannot be reassembled
+            // anyway; drop it rather than resend stale evidence
+            Serial.printf("Evidence frame %u upload failed, dropped\n", m.frameId);
+            sendDropped++;
+        }
+        free(m.data);
+        m.data = NULL;
+        bulkHead = (bulkHead + 1) % SEND_BULK_DEPTH;
+        bulkCount--;
+        if (!ok) {
+            return;
+        }
+    }
+}
+
+/**
+ * Flash spool for frames that failed their upload
+ *
+ * The AI task never touches flash itself: it hands the (already
+ * PSRAM-resident) frame copy to spoolQueue and moves on to the next
+ * live frame. TaskSpoolWriter, at idle priority, streams the copy into
+ * a LittleFS file in SPOOL_WRITE_CHUNK (flash page) sized writes with
+ * a yield between chunks, so page programming and block erase stalls
+ * never block capture or MQTT. Files are named by a monotonic sequence
+ * number; the quota evicts from the oldest end, and a reboot rebuilds
+ * the counters by scanning the directory, so spooled evidence survives
+ * a power cycle. drainSpool() (defined next to the upload path it
+ * mirrors) re-sends one spooled frame per task pass once the server is
+ * reachable again.
+ */
+struct SpoolJob {
+    uint8_t* data;
+    size_t len;
+};
+
+QueueHandle_t spoolQueue = NULL;
+SemaphoreHandle_t spoolMutex = NULL;
+uint32_t spoolSeqHead = 0;      // Oldest spooled frame
+uint32_t spoolSeqNext = 0;      // Sequence for the next write
+size_t spoolBytes = 0;
+int spoolFileCount = 0;
+unsigned long spoolDropped = 0;
+
+/**
+ * Build the path of a spool sequence number
+ */
+void spoolPath(char* buf, size_t cap, uint32_t seq) {
+    snprintf(buf, cap, SPOOL_DIR "/e%08lu.jpg", (unsigned long)seq);
+}
+
+/**
+ * Mount LittleFS and rebuild the spool counters from disk
+ */
+void initSpool() {
+    if (!LittleFS.begin(true)) {
+        Serial.println("LittleFS mount failed, evidence spool disabled");
+        return;
+    }
+    LittleFS.mkdir(SPOOL_DIR);
+    spoolMutex = xSemaphoreCreateMutex();
+    spoolQueue = xQueueCreate(SPOOL_QUEUE_DEPTH, sizeof(SpoolJob));
+
+    uint32_t minSeq = 0xFFFFFFFF;
+    uint32_t maxSeq = 0;
+    File dir = LittleFS.open(SPOOL_DIR);
+    File f = dir ? dir.openNextFile() : File();
+    while (f) {
+        const char* name = f.name();
+        while (*name && !isDigit(*name)) {
+            name++;
+        }
+        uint32_t seq = (uint32_t)strtoul(name, NULL, 10);
+        if (seq < minSeq) minSeq = seq;
+        if (seq > maxSeq) maxSeq = seq;
+        spoolBytes += f.size();
+        spoolFileCount++;
+        f = dir.openNextFile();
+    }
+    if (spoolFileCount > 0) {
+        spoolSeqHead = minSeq;
+        spoolSeqNext = maxSeq + 1;
+        Serial.printf("Spool recovered %d frame(s), %u bytes\n",
+                      spoolFileCount, (unsigned)spoolBytes);
+    }
+}
+
+/**
+ * Evict oldest spool files until the new frame fits the quota
+ *
+ * Caller holds spoolMutex.
+ */
+void spoolEvictFor(size_t needed) {
+    char path[48];
+    while (spoolFileCount > 0 && spoolBytes + needed > SPOOL_QUOTA_BYTES) {
+        spoolPath(path, sizeof(path), spoolSeqHead);
+        File f = LittleFS.open(path, "r");
+        size_t len = f ? f.size() : 0;
+        if (f) {
+            f.close();
+        }
+        LittleFS.remove(path);
+        spoolBytes -= (len <= spoolBytes) ? len : spoolBytes;
+        spoolFileCount--;
+        spoolSeqHead++;
+        Serial.printf("Spool quota: evicted oldest frame %s\n", path);
+    }
+}
+
+/**
+ * Hand a frame copy to the spool writer; takes ownership of data
+ */
+void spoolEnqueue(uint8_t* data, size_t len) {
+    SpoolJob job = {data, len};
+    if (spoolQueue == NULL || xQueueSend(spoolQueue, &job, 0) != pdTRUE) {
+        spoolDropped++;
+        free(data);
+        Serial.println("Spool queue full, frame dropped");
+    }
+}
+
+/**
+ * Copy a frame out of the camera buffer and spool it
+ */
+void spoolFrameCopy(const uint8_t* buf, size_t len) {
+    uint8_t* copy = (uint8_t*)heap_caps_malloc(len, MALLOC_CAP_SPIRAM);
+    if (copy == NULL) {
+        copy = (uint8_t*)malloc(len);
+    }
+    if (copy == NULL) {
+        spoolDropped++;
+        Serial.println("Spool allocation failed, frame dropped");
+        return;
+    }
+    memcpy(copy, buf, len);
+    spoolEnqueue(copy, len);
+}
+
+/**
+ * Low-priority spool writer task
+ */
+void TaskSpoolWriter(void* pvParameters) {
+    SpoolJob job;
+    while (1) {
+        if (xQueueReceive(spoolQueue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        xSemaphoreTake(spoolMutex, portMAX_DELAY);
+        spoolEvictFor(job.len);
+        char path[48];
+        spoolPath(path, sizeof(path), spoolSeqNext);
+        File f = LittleFS.open(path, "w");
+        bool ok = (bool)f && job.len <= SPOOL_QUOTA_BYTES;
+        size_t offset = 0;
+        while (ok && offset < job.len) {
+            size_t chunk = job.len - offset;
+            if (chunk > SPOOL_WRITE_CHUNK) {
+                chunk = SPOOL_WRITE_CHUNK;
+            }
+            ok = f.write(job.data + offset, chunk) == chunk;
+            offset += chunk;
+            // One page per write call; the delay yields the core across
+            // the driver's page program / block erase time
+            vTaskDelay(1);
+        }
+        if (f) {
+            f.close();
+        }
+        if (ok) {
+            spoolBytes += job.len;
+            spoolFileCount++;
+            spoolSeqNext++;
+            Serial.printf("Spooled frame %s (%u bytes, %d spooled)\n",
+                          path, (unsigned)job.len, spoolFileCount);
+        } else {
+            LittleFS.remove(path);
+            spoolDropped++;
+            Serial.println("Spool write failed, frame dropped");
+        }
+        xSemaphoreGive(spoolMutex);
+        free(job.data);
+    }
+}
+
 /**
  * MQTT callback for commands
  */
@@ -185,86 +714,652 @@ void mqttCallback(char* topic, byte* payload, unsigned int length) {
     } else if (message == "capture_now") {
         // Force immediate capture
         lastCaptureTime = 0;
+    } else if (message.startsWith("set_bandwidth_kbps:")) {
+        // Upstream budget, enforced as a floor on the capture interval
+        bandwidthBudgetKbps = message.substring(strlen("set_bandwidth_kbps:")).toInt();
+        Serial.printf("Bandwidth budget set to %lu kbps\n", bandwidthBudgetKbps);
+    } else if (message.startsWith("set_batch_size:")) {
+        unsigned int requested = message.substring(strlen("set_batch_size:")).toInt();
+        frameBatchSize = (requested > FRAME_BATCH_SIZE) ? FRAME_BATCH_SIZE : requested;
+        Serial.printf("Frame batch size set to %u\n", frameBatchSize);
+    } else if (message.startsWith("set_threshold:")) {
+        // Persisted runtime config: survives reboots, applies to the
+        // next inference without one
+        float requested = message.substring(strlen("set_threshold:")).toFloat();
+        if (requested >= 0.05f && requested <= 0.99f) {
+            detectionThreshold = requested;
+            configPrefs.putFloat("threshold", requested);
+            Serial.printf("Detection threshold set to %.2f\n", requested);
+        } else {
+            Serial.printf("Rejected threshold %.2f (valid 0.05-0.99)\n", requested);
+        }
+    } else if (message.startsWith("set_roi:")) {
+        handleRoiCommand(message.substring(strlen("set_roi:")));
+    } else if (message == "clear_roi") {
+        applyRoiWindow(0, 0, FRAME_WIDTH, FRAME_HEIGHT, FRAME_WIDTH, FRAME_HEIGHT);
+    } else if (message == "trace_on") {
+        if (taskTrace.begin()) {
+            Serial.println("Task trace armed");
+        } else {
+            Serial.println("Task trace failed to arm");
+        }
+    } else if (message == "trace_off") {
+        // Flush what the rings still hold before stopping
+        taskTrace.drain(Serial);
+        taskTrace.end();
+        Serial.println("Task trace stopped");
+    }
+
+    // Acknowledge on the ack tier, above telemetry and bulk evidence,
+    // so the operator sees the command landed even while an upload is
+    // in progress
+    char ack[192];
+    int ackLen = snprintf(ack, sizeof(ack), "{\"command\":\"%s\",\"received\":true}",
+                          message.c_str());
+    if (ackLen > 0 && ackLen < (int)sizeof(ack)) {
+        sendEnqueue(SEND_TIER_ACK, MQTT_ACK_TOPIC, (const uint8_t*)ack, ackLen);
     }
 }
 
 /**
- * Capture image and convert to base64
+ * Apply a sensor-side region of interest window
+ * 
+ * set_res_raw programs the sensor to crop to the given window and
+ * scale to the requested output size, shrinking the JPEG the driver
+ * hands us without any on-device pixel processing.
  */
-String captureImageBase64() {
-    camera_fb_t* fb = esp_camera_fb_get();
-    if (!fb) {
-        Serial.println("Camera capture failed");
-        return "";
+bool applyRoiWindow(int x, int y, int w, int h, int outW, int outH) {
+    sensor_t* s = esp_camera_sensor_get();
+    if (s == NULL || s->set_res_raw == NULL) {
+        Serial.println("Sensor does not support ROI windowing");
+        return false;
+    }
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 ||
+        x + w > FRAME_WIDTH || y + h > FRAME_HEIGHT ||
+        outW <= 0 || outH <= 0 || outW > w || outH > h) {
+        Serial.println("Invalid ROI window");
+        return false;
     }
     
-    // Check image size
-    if (fb->len > MAX_IMAGE_SIZE) {
-        Serial.printf("Image too large: %d bytes\n", fb->len);
-        esp_camera_fb_return(fb);
-        return "";
+    if (s->set_res_raw(s, x, y, x + w, y + h, 0, 0,
+                       FRAME_WIDTH, FRAME_HEIGHT, outW, outH,
+                       true, true) != 0) {
+        Serial.println("Applying ROI window failed");
+        return false;
+    }
+    Serial.printf("ROI set to %dx%d+%d+%d -> %dx%d\n", w, h, x, y, outW, outH);
+    return true;
+}
+
+/**
+ * Parse and apply a "set_roi:x,y,w,h[,out_w,out_h]" command
+ */
+void handleRoiCommand(const String& args) {
+    int values[6] = {0, 0, 0, 0, 0, 0};
+    int valueCount = 0;
+    int start = 0;
+    while (valueCount < 6 && start <= (int)args.length()) {
+        int comma = args.indexOf(',', start);
+        if (comma < 0) {
+            comma = args.length();
+        }
+        values[valueCount++] = args.substring(start, comma).toInt();
+        start = comma + 1;
     }
     
-    // Convert to base64
-    String base64Image = base64::encode(fb->buf, fb->len);
+    if (valueCount < 4) {
+        Serial.println("Invalid ROI command");
+        return;
+    }
+    // Output size defaults to the crop size (no downscale)
+    int outW = (valueCount >= 6) ? values[4] : values[2];
+    int outH = (valueCount >= 6) ? values[5] : values[3];
+    applyRoiWindow(values[0], values[1], values[2], values[3], outW, outH);
+}
+
+/**
+ * Adjust the sensor JPEG quality (lower number = higher quality)
+ */
+void setJpegQuality(int quality) {
+    sensor_t* s = esp_camera_sensor_get();
+    if (s != NULL) {
+        s->set_quality(s, quality);
+    }
+}
+
+/**
+ * Feedback controller for the capture interval and JPEG quality
+ * 
+ * Called with every server response: detections switch to escalation
+ * mode (short interval, high quality) so alert latency stays low while
+ * something is happening, sustained quiet doubles the interval up to
+ * the maximum and drops quality. An MQTT-settable bandwidth budget is
+ * enforced as a floor on the interval based on the last frame size.
+ */
+void updateCaptureController(bool hadDetections) {
+    if (hadDetections) {
+        quietResponseCount = 0;
+        if (captureIntervalMs != ESCALATED_CAPTURE_INTERVAL) {
+            Serial.println("Detections active: escalating capture rate");
+            setJpegQuality(ESCALATED_JPEG_QUALITY);
+        }
+        captureIntervalMs = ESCALATED_CAPTURE_INTERVAL;
+    } else if (++quietResponseCount >= QUIET_RESPONSES_BEFORE_BACKOFF) {
+        quietResponseCount = 0;
+        unsigned long backedOff = captureIntervalMs * 2;
+        if (backedOff < CAPTURE_INTERVAL) {
+            backedOff = CAPTURE_INTERVAL;
+        }
+        if (backedOff > MAX_CAPTURE_INTERVAL) {
+            backedOff = MAX_CAPTURE_INTERVAL;
+        }
+        if (backedOff != captureIntervalMs) {
+            Serial.printf("Scene quiet: capture interval now %lu ms\n", backedOff);
+            setJpegQuality(IDLE_JPEG_QUALITY);
+        }
+        captureIntervalMs = backedOff;
+    }
     
-    esp_camera_fb_return(fb);
-    return base64Image;
+    // bytes * 8 bits / kbps gives the milliseconds one frame occupies
+    // on the budgeted link, never capture faster than that
+    if (bandwidthBudgetKbps > 0 && lastUploadBytes > 0) {
+        unsigned long budgetFloorMs = (lastUploadBytes * 8UL) / bandwidthBudgetKbps;
+        if (captureIntervalMs < budgetFloorMs) {
+            captureIntervalMs = budgetFloorMs;
+        }
+    }
 }
 
 /**
- * Send image to AI server for processing
+ * Capture interval with the server's congestion stretch applied
+ *
+ * The stretch lives here, at the point of use, rather than being folded
+ * into captureIntervalMs — the hint changes with every response and must
+ * not compound across cycles or survive the server recovering.
  */
-JsonDocument sendImageForProcessing(const String& base64Image) {
-    JsonDocument response;
+unsigned long effectiveCaptureIntervalMs() {
+    unsigned long interval = captureIntervalMs;
+    float hint = serverCongestionHint;
+    if (hint > 0.0f) {
+        interval += (unsigned long)(interval * hint * (CONGESTION_MAX_STRETCH_PCT / 100.0f));
+    }
+    return interval;
+}
+
+/**
+ * Cheap on-device motion gate
+ * 
+ * Splits the JPEG buffer into equal slices, sums the bytes of every
+ * slice and compares the resulting signature against the last uploaded
+ * frame with a sum of absolute differences. A static scene compresses
+ * to nearly identical bytes, so a small SAD means nothing moved and the
+ * upload can be skipped. This runs on the compressed data directly,
+ * the plain ESP32 on the AI Thinker board has no SIMD unit and
+ * reconfiguring the sensor for an extra grayscale preview capture
+ * would cost more than the gate saves.
+ */
+bool frameHasMotion(camera_fb_t* fb) {
+    static uint32_t previousSignature[MOTION_GATE_BLOCKS];
+    static bool hasPrevious = false;
+    static int gatedFrames = 0;
+    
+    uint32_t signature[MOTION_GATE_BLOCKS] = {0};
+    size_t blockSize = fb->len / MOTION_GATE_BLOCKS;
+    if (blockSize == 0) {
+        return true;
+    }
+    for (int block = 0; block < MOTION_GATE_BLOCKS; block++) {
+        const uint8_t* data = fb->buf + block * blockSize;
+        uint32_t sum = 0;
+        for (size_t i = 0; i < blockSize; i++) {
+            sum += data[i];
+        }
+        signature[block] = sum;
+    }
+    
+    bool motion = true;
+    if (hasPrevious) {
+        uint32_t sad = 0;
+        uint32_t total = 0;
+        for (int block = 0; block < MOTION_GATE_BLOCKS; block++) {
+            uint32_t a = signature[block];
+            uint32_t b = previousSignature[block];
+            sad += (a > b) ? (a - b) : (b - a);
+            total += b;
+        }
+        motion = (total == 0) || (sad > (total / 100) * MOTION_GATE_THRESHOLD_PCT);
+    }
+    
+    if (!motion && ++gatedFrames < MOTION_GATE_MAX_SKIP) {
+        return false;
+    }
+    
+    // Uploading: remember this frame as the new reference
+    memcpy(previousSignature, signature, sizeof(previousSignature));
+    hasPrevious = true;
+    gatedFrames = 0;
+    return true;
+}
+
+/**
+ * Camera capture task (core 0): produces frames at the capture interval
+ * and hands them to the upload task, never blocking on the network
+ */
+void TaskCameraCapture(void *pvParameters) {
+    Serial.println("Camera capture task started");
+    unsigned long lastViewCaptureMs = 0;
+
+    while (1) {
+        unsigned long currentTime = millis();
+        if (isDetectionEnabled && (currentTime - lastCaptureTime >= effectiveCaptureIntervalMs())) {
+            camera_fb_t* fb = esp_camera_fb_get();
+            FrameTee::SharedFrame* sf = fb ? frameTee.wrap(fb) : NULL;
+            if (!fb) {
+                Serial.println("Camera capture failed");
+            } else if (sf == NULL) {
+                // No free descriptor (viewer and upload both holding
+                // frames); the raw buffer is still ours to return
+                esp_camera_fb_return(fb);
+            } else {
+                // Every captured frame feeds the live view, including
+                // the ones the motion gate keeps off the uplink
+                frameTee.publishLatest(sf);
+                lastViewCaptureMs = currentTime;
+                if (!frameHasMotion(fb)) {
+                    // Static scene, skip the upload entirely
+                    frameTee.release(sf);
+                    lastCaptureTime = currentTime;
+                } else if (xQueueSend(frameQueue, &sf, 0) != pdTRUE) {
+                    // Upload task still busy with the previous frame, drop
+                    // this one so the driver gets its buffer back quickly
+                    frameTee.release(sf);
+                } else {
+                    lastCaptureTime = currentTime;
+                }
+            }
+        } else if (frameTee.hasViewer() &&
+                   currentTime - lastViewCaptureMs >= MJPEG_VIEW_INTERVAL_MS) {
+            // View-only frame between detection captures: published to
+            // the tee and released, never uploaded — the live view keeps
+            // moving while the detection interval is backed off
+            camera_fb_t* fb = esp_camera_fb_get();
+            if (fb) {
+                FrameTee::SharedFrame* sf = frameTee.wrap(fb);
+                if (sf == NULL) {
+                    esp_camera_fb_return(fb);
+                } else {
+                    frameTee.publishLatest(sf);
+                    frameTee.release(sf);
+                }
+                lastViewCaptureMs = currentTime;
+            }
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+/**
+ * MJPEG live view task (core 0, low priority)
+ *
+ * Serves one viewer at a time on MJPEG_STREAM_PORT as a standard
+ * multipart/x-mixed-replace stream, pulling frames from the tee's
+ * latest slot. The socket write happens while holding a reference to
+ * the shared descriptor, so the JPEG is streamed straight out of the
+ * driver's PSRAM buffer; a viewer slower than the capture rate simply
+ * skips to the newest frame each iteration instead of queueing.
+ */
+void TaskMjpegStream(void *pvParameters) {
+    mjpegServer.begin();
+    Serial.printf("MJPEG live view on port %d\n", MJPEG_STREAM_PORT);
+
+    while (1) {
+        WiFiClient viewer = mjpegServer.available();
+        if (!viewer) {
+            vTaskDelay(pdMS_TO_TICKS(200));
+            continue;
+        }
+
+        // Discard the request; whatever path was asked for gets the stream
+        unsigned long requestStart = millis();
+        while (viewer.connected() && millis() - requestStart < 1000) {
+            String line = viewer.readStringUntil('\n');
+            if (line.length() <= 1) {
+                break;  // Blank line ends the request headers
+            }
+        }
+        viewer.print("HTTP/1.1 200 OK\r\n"
+                     "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+                     "Cache-Control: no-cache\r\n\r\n");
+
+        Serial.printf("MJPEG viewer connected: %s\n", viewer.remoteIP().toString().c_str());
+        frameTee.setViewerActive(true);
+        uint32_t lastSeq = 0;
+        while (viewer.connected()) {
+            FrameTee::SharedFrame* sf = frameTee.takeLatest(lastSeq);
+            if (sf == NULL) {
+                vTaskDelay(pdMS_TO_TICKS(50));
+                continue;
+            }
+            lastSeq = sf->seq;
+            char partHeader[80];
+            int headerLen = snprintf(partHeader, sizeof(partHeader),
+                                     "--frame\r\nContent-Type: image/jpeg\r\n"
+                                     "Content-Length: %u\r\n\r\n", (unsigned)sf->fb->len);
+            bool ok = viewer.write((const uint8_t*)partHeader, headerLen) == (size_t)headerLen &&
+                      viewer.write(sf->fb->buf, sf->fb->len) == sf->fb->len &&
+                      viewer.print("\r\n") == 2;
+            frameTee.release(sf);
+            if (!ok) {
+                break;
+            }
+        }
+        frameTee.setViewerActive(false);
+        viewer.stop();
+        Serial.println("MJPEG viewer disconnected");
+    }
+}
+
+// Cached AI server endpoint (see AI_SERVER_SERVICE above)
+IPAddress aiServerIp;
+uint16_t aiServerPort = AI_SERVER_PORT;
+bool aiServerResolved = false;
+Preferences aiServerPrefs;
+
+/**
+ * Query the _aidetect._tcp mDNS service for the server endpoint
+ */
+bool discoverAIServer() {
+    Serial.printf("Querying mDNS for _%s._tcp...\n", AI_SERVER_SERVICE);
+    int found = MDNS.queryService(AI_SERVER_SERVICE, "tcp");
+    if (found <= 0) {
+        Serial.println("No service advertisement found");
+        return false;
+    }
+    aiServerIp = MDNS.IP(0);
+    aiServerPort = MDNS.port(0);
+    Serial.printf("AI server discovered at %s:%u\n",
+                  aiServerIp.toString().c_str(), aiServerPort);
+    return true;
+}
+
+/**
+ * Resolve the AI server endpoint, cheapest source first
+ *
+ * RAM cache (steady state: free), then NVS (reboot: one flash read),
+ * then an mDNS query, then the compiled-in fallback. A stale NVS entry
+ * costs one failed connect, which invalidates it and triggers a fresh
+ * query on the retry.
+ */
+void resolveAIServer() {
+    if (aiServerResolved) {
+        return;
+    }
+    aiServerPrefs.begin("aiserver", false);
+    uint32_t storedIp = aiServerPrefs.getULong("ip", 0);
+    if (storedIp != 0) {
+        aiServerIp = IPAddress(storedIp);
+        aiServerPort = aiServerPrefs.getUShort("port", AI_SERVER_PORT);
+        Serial.printf("AI server from NVS cache: %s:%u\n",
+                      aiServerIp.toString().c_str(), aiServerPort);
+    } else if (discoverAIServer()) {
+        aiServerPrefs.putULong("ip", (uint32_t)aiServerIp);
+        aiServerPrefs.putUShort("port", aiServerPort);
+    } else {
+        aiServerIp.fromString(AI_SERVER_HOST);
+        aiServerPort = AI_SERVER_PORT;
+        Serial.printf("Falling back to configured %s:%d\n", AI_SERVER_HOST, AI_SERVER_PORT);
+    }
+    aiServerPrefs.end();
+    aiServerResolved = true;
+}
+
+/**
+ * Drop the cached endpoint after a connect failure, so the next attempt
+ * re-runs discovery instead of hammering a dead address
+ */
+void invalidateAIServer() {
+    aiServerResolved = false;
+    aiServerPrefs.begin("aiserver", false);
+    aiServerPrefs.remove("ip");
+    aiServerPrefs.remove("port");
+    aiServerPrefs.end();
+}
+
+/**
+ * Ensure the persistent detection stream to the AI server is up
+ */
+bool connectToAIServer() {
+    if (aiClient.connected()) {
+        return true;
+    }
+
+    resolveAIServer();
+    Serial.printf("Connecting detection stream to %s:%u...\n",
+                  aiServerIp.toString().c_str(), aiServerPort);
+    if (!aiClient.connect(aiServerIp, aiServerPort)) {
+        Serial.println("Detection stream connect failed");
+        invalidateAIServer();
+        return false;
+    }
+    aiClient.setTimeout(SERVER_TIMEOUT);
+    return true;
+}
+
+/**
+ * Write a 4-byte big-endian length prefix
+ */
+void writeFramePrefix(uint32_t length) {
+    uint8_t prefix[4] = {
+        (uint8_t)(length >> 24), (uint8_t)(length >> 16),
+        (uint8_t)(length >> 8), (uint8_t)(length)
+    };
+    aiClient.write(prefix, sizeof(prefix));
+}
+
+#if USE_LEGACY_BASE64_SERVER
+/**
+ * Send image to the legacy server as base64-in-JSON
+ * 
+ * The JSON body is written directly into the socket: fixed prefix,
+ * base64 of the frame streamed in 3KB chunks through
+ * Base64PrintEncoder, then the metadata suffix. The exact
+ * Content-Length is computed up front, so nothing of the ~80KB
+ * encoded image is ever held in memory at once.
+ */
+JsonDocument sendImageForProcessing(camera_fb_t* fb) {
+    JsonDocument response(&telemetryArena);
     
     if (WiFi.status() != WL_CONNECTED) {
         response["error"] = "WiFi not connected";
         return response;
     }
     
-    http.begin(AI_SERVER_URL);
-    http.setTimeout(SERVER_TIMEOUT);
-    http.addHeader("Content-Type", "application/json");
+    resolveAIServer();
+    WiFiClient legacyClient;
+    if (!legacyClient.connect(aiServerIp, aiServerPort)) {
+        invalidateAIServer();
+        response["error"] = "AI server not reachable";
+        return response;
+    }
+    legacyClient.setTimeout(SERVER_TIMEOUT);
+    
+    const char* bodyPrefix = "{\"image\":\"";
+    char bodySuffix[160];
+    snprintf(bodySuffix, sizeof(bodySuffix),
+             "\",\"model\":\"fire_detection_best\",\"threshold\":%.2f,"
+             "\"device_id\":\"ESP32CAM_001\",\"timestamp\":%lu}",
+             (float)detectionThreshold, millis());
+    size_t contentLength = strlen(bodyPrefix) +
+                           Base64PrintEncoder::encodedSize(fb->len) +
+                           strlen(bodySuffix);
     
-    // Prepare request payload
-    JsonDocument request;
-    request["image"] = base64Image;
-    request["model"] = "fire_detection_best";  // Specify which model to use
-    request["threshold"] = DETECTION_THRESHOLD;
-    request["device_id"] = "ESP32CAM_001";
-    request["timestamp"] = millis();
+    Serial.println("Sending image to legacy AI server...");
+    legacyClient.printf("POST %s HTTP/1.1\r\n", LEGACY_SERVER_PATH);
+    legacyClient.printf("Host: %s:%u\r\n", aiServerIp.toString().c_str(), aiServerPort);
+    legacyClient.print("Content-Type: application/json\r\n");
+    legacyClient.printf("Content-Length: %u\r\n", (unsigned)contentLength);
+    legacyClient.print("Connection: close\r\n\r\n");
     
-    String requestString;
-    serializeJson(request, requestString);
+    legacyClient.print(bodyPrefix);
+    Base64PrintEncoder encoder(legacyClient);
+    for (size_t offset = 0; offset < fb->len; offset += Base64PrintEncoder::CHUNK_SIZE) {
+        size_t chunk = fb->len - offset;
+        if (chunk > Base64PrintEncoder::CHUNK_SIZE) {
+            chunk = Base64PrintEncoder::CHUNK_SIZE;
+        }
+        encoder.write(fb->buf + offset, chunk);
+    }
+    encoder.finish();
+    legacyClient.print(bodySuffix);
+    
+    // Skip the status line and headers, then parse the JSON body
+    if (!legacyClient.find("\r\n\r\n")) {
+        legacyClient.stop();
+        response["error"] = "AI server response timeout";
+        return response;
+    }
+    DeserializationError jsonError = deserializeJson(response, legacyClient);
+    legacyClient.stop();
+    if (jsonError) {
+        response.clear();
+        response["error"] = "Invalid AI server response";
+    }
+    return response;
+}
+#else
+/**
+ * Send image to AI server for processing
+ * 
+ * Frames are pushed over a persistent TCP session instead of one HTTP
+ * request per capture, which removes the connect + header overhead
+ * (~400ms per frame) that dominated the previous round-trip time. The
+ * JPEG is streamed straight out of the frame buffer, no copies.
+ */
+JsonDocument sendImageForProcessing(camera_fb_t* fb) {
+    JsonDocument response(&telemetryArena);
+    
+    if (WiFi.status() != WL_CONNECTED) {
+        response["error"] = "WiFi not connected";
+        return response;
+    }
+    
+    if (!connectToAIServer()) {
+        response["error"] = "AI server not reachable";
+        return response;
+    }
     
     Serial.println("Sending image to AI server...");
-    int httpResponseCode = http.POST(requestString);
+    lastUploadBytes = fb->len;
+    writeFramePrefix(fb->len);
+    // The session may have gone stale between captures, retry once on a
+    // fresh connection before giving up on the frame
+    if (aiClient.write(fb->buf, fb->len) != fb->len) {
+        aiClient.stop();
+        if (!connectToAIServer()) {
+            response["error"] = "AI server not reachable";
+            return response;
+        }
+        writeFramePrefix(fb->len);
+        if (aiClient.write(fb->buf, fb->len) != fb->len) {
+            aiClient.stop();
+            response["error"] = "Frame upload failed";
+            return response;
+        }
+    }
     
-    if (httpResponseCode == 200) {
-        String responseString = http.getString();
-        deserializeJson(response, responseString);
-        Serial.printf("AI Server Response: %s\n", responseString.c_str());
-    } else {
-        Serial.printf("HTTP Error: %d\n", httpResponseCode);
-        response["error"] = "HTTP Error: " + String(httpResponseCode);
+    // Read the length-prefixed JSON result pushed back by the server
+    uint8_t prefix[4];
+    if (aiClient.readBytes(prefix, sizeof(prefix)) != sizeof(prefix)) {
+        aiClient.stop();
+        response["error"] = "AI server response timeout";
+        return response;
+    }
+    uint32_t resultLength = ((uint32_t)prefix[0] << 24) | ((uint32_t)prefix[1] << 16) |
+                            ((uint32_t)prefix[2] << 8) | (uint32_t)prefix[3];
+    
+    String responseString;
+    responseString.reserve(resultLength);
+    while (responseString.length() < resultLength && aiClient.connected()) {
+        char c;
+        if (aiClient.readBytes(&c, 1) != 1) {
+            break;
+        }
+        responseString += c;
+    }
+    
+    if (responseString.length() != resultLength) {
+        aiClient.stop();
+        response["error"] = "Truncated AI server response";
+        return response;
     }
     
-    http.end();
+    deserializeJson(response, responseString);
+    Serial.printf("AI Server Response: %s\n", responseString.c_str());
     return response;
 }
+#endif // USE_LEGACY_BASE64_SERVER
+
+/**
+ * Queue the frame that triggered an alert for the evidence topic
+ *
+ * The JPEG is copied to PSRAM and enqueued on the bulk tier, so the
+ * camera frame buffer goes back to the driver immediately and the
+ * upload happens in segments behind any pending alerts (see the
+ * tiered send queue above for the segment wire format).
+ */
+void publishEvidenceFrame(camera_fb_t* fb) {
+    if (fb == NULL) {
+        return;
+    }
+    if (bulkCount >= SEND_BULK_DEPTH) {
+        sendDropped++;
+        Serial.println("Evidence queue full, dropping frame");
+        return;
+    }
+    uint8_t* copy = (uint8_t*)heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM);
+    if (copy == NULL) {
+        copy = (uint8_t*)malloc(fb->len);
+    }
+    if (copy == NULL) {
+        sendDropped++;
+        Serial.println("Evidence frame allocation failed, dropping frame");
+        return;
+    }
+    memcpy(copy, fb->buf, fb->len);
+    BulkMessage& m = bulkQueue[(bulkHead + bulkCount) % SEND_BULK_DEPTH];
+    m.data = copy;
+    m.len = fb->len;
+    m.frameId = nextEvidenceFrameId++;
+    bulkCount++;
+}
 
 /**
  * Process AI detection results
  */
-void processDetectionResults(const JsonDocument& results) {
+void processDetectionResults(const JsonDocument& results, camera_fb_t* fb) {
     if (results.containsKey("error")) {
         Serial.printf("AI Processing Error: %s\n", results["error"].as<const char*>());
         return;
     }
-    
+
+    // Server-advertised congestion hint (see the fleet coordination
+    // settings above); a response without the field means the server is
+    // keeping up and any earlier stretch is lifted
+    if (results.containsKey("congestion")) {
+        float hint = results["congestion"].as<float>();
+        serverCongestionHint = (hint < 0.0f) ? 0.0f : ((hint > 1.0f) ? 1.0f : hint);
+        if (serverCongestionHint > 0.0f) {
+            Serial.printf("Server congestion %.2f, interval stretched to %lu ms\n",
+                          (float)serverCongestionHint, effectiveCaptureIntervalMs());
+        }
+    } else {
+        serverCongestionHint = 0.0f;
+    }
+
     if (!results.containsKey("detections")) {
         Serial.println("No detections in response");
+        updateCaptureController(false);
         return;
     }
     
@@ -272,6 +1367,7 @@ void processDetectionResults(const JsonDocument& results) {
     int detectionCount = detections.size();
     
     Serial.printf("Received %d detection(s)\n", detectionCount);
+    updateCaptureController(detectionCount > 0);
     
     if (detectionCount > 0) {
         // Process each detection
@@ -283,8 +1379,8 @@ void processDetectionResults(const JsonDocument& results) {
                           objectClass.c_str(), confidence);
             
             // Publish significant detections
-            if (confidence >= DETECTION_THRESHOLD) {
-                publishDetectionAlert(objectClass, confidence, results);
+            if (confidence >= detectionThreshold) {
+                publishDetectionAlert(objectClass, confidence, results, fb);
             }
         }
     }
@@ -293,14 +1389,19 @@ void processDetectionResults(const JsonDocument& results) {
 /**
  * Publish detection alert via MQTT
  */
-void publishDetectionAlert(const String& objectClass, float confidence, const JsonDocument& fullResults) {
-    JsonDocument alert;
+void publishDetectionAlert(const String& objectClass, float confidence, const JsonDocument& fullResults, camera_fb_t* fb) {
+    JsonDocument alert(&telemetryArena);
     
     alert["device_id"] = "ESP32CAM_Hybrid_001";
     alert["timestamp"] = millis();
     alert["detection"]["class"] = objectClass;
     alert["detection"]["confidence"] = confidence;
     alert["detection"]["method"] = "server_processing";
+    // How old the evidence is, sensor VSYNC to now; batched frames have
+    // no buffer anymore and carry no age
+    if (fb != NULL) {
+        alert["detection"]["frame_age_ms"] = frameAgeMs(fb);
+    }
     
     // Special handling for fire detection
     if (objectClass == "fire") {
@@ -308,6 +1409,7 @@ void publishDetectionAlert(const String& objectClass, float confidence, const Js
         alert["alert"]["severity"] = "CRITICAL";
         alert["alert"]["action_required"] = true;
         alert["alert"]["recommended_action"] = "Immediate evacuation and fire suppression";
+        alert["alert"]["evidence_topic"] = MQTT_EVIDENCE_TOPIC;
     }
     
     // Include processing time
@@ -316,10 +1418,226 @@ void publishDetectionAlert(const String& objectClass, float confidence, const Js
     }
     
     char alertBuffer[1024];
-    serializeJson(alert, alertBuffer);
+    size_t alertLen = serializeJson(alert, alertBuffer);
+
+    // Critical alerts take the top tier; routine detections queue as
+    // telemetry behind any pending alerts and acks
+    const bool critical = (objectClass == "fire");
+    sendEnqueue(critical ? SEND_TIER_ALERT : SEND_TIER_TELEMETRY,
+                MQTT_DETECTION_TOPIC, (const uint8_t*)alertBuffer, alertLen);
+    Serial.printf("Queued alert: %s\n", alertBuffer);
     
-    mqttClient.publish(MQTT_DETECTION_TOPIC, alertBuffer);
-    Serial.printf("Published alert: %s\n", alertBuffer);
+    // Attach the triggering frame so operators can verify the alert
+    if (objectClass == "fire") {
+        publishEvidenceFrame(fb);
+    }
+}
+
+/**
+ * Copy a low-priority frame into the pending PSRAM batch
+ */
+void enqueueBatchFrame(camera_fb_t* fb) {
+    uint8_t* copy = (uint8_t*)heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM);
+    if (copy == NULL) {
+        copy = (uint8_t*)malloc(fb->len);
+    }
+    if (copy == NULL) {
+        Serial.println("Batch frame allocation failed, dropping frame");
+        return;
+    }
+    memcpy(copy, fb->buf, fb->len);
+    pendingBatch[pendingBatchCount].data = copy;
+    pendingBatch[pendingBatchCount].len = fb->len;
+    pendingBatchCount++;
+}
+
+/**
+ * Upload the pending batch as one message and fan out the results
+ * 
+ * On the wire a batch is the FRAME_BATCH_MARKER prefix, a 4-byte frame
+ * count and then one length-prefixed JPEG per frame, all on the
+ * persistent session. The server answers with a single JSON document
+ * whose "results" array holds one detection set per frame, matching
+ * its batched model invocation.
+ */
+void sendBatchForProcessing() {
+    if (pendingBatchCount == 0) {
+        return;
+    }
+    
+    JsonDocument response(&telemetryArena);
+    bool sent = false;
+    if (WiFi.status() == WL_CONNECTED && connectToAIServer()) {
+        Serial.printf("Sending batch of %d frame(s) to AI server...\n", pendingBatchCount);
+        size_t totalBytes = 0;
+        writeFramePrefix(FRAME_BATCH_MARKER);
+        writeFramePrefix(pendingBatchCount);
+        sent = true;
+        for (int i = 0; i < pendingBatchCount && sent; i++) {
+            writeFramePrefix(pendingBatch[i].len);
+            sent = aiClient.write(pendingBatch[i].data, pendingBatch[i].len) == pendingBatch[i].len;
+            totalBytes += pendingBatch[i].len;
+        }
+        lastUploadBytes = totalBytes;
+    }
+    
+    // Failed uploads hand their copies to the flash spool (which takes
+    // ownership); successful ones are done with them
+    for (int i = 0; i < pendingBatchCount; i++) {
+        if (!sent) {
+            spoolEnqueue(pendingBatch[i].data, pendingBatch[i].len);
+        } else {
+            free(pendingBatch[i].data);
+        }
+        pendingBatch[i].data = NULL;
+    }
+    int sentFrames = pendingBatchCount;
+    pendingBatchCount = 0;
+    
+    if (!sent) {
+        aiClient.stop();
+        Serial.println("Batch upload failed");
+        return;
+    }
+    
+    // One length-prefixed JSON response for the whole batch
+    uint8_t prefix[4];
+    if (aiClient.readBytes(prefix, sizeof(prefix)) != sizeof(prefix)) {
+        aiClient.stop();
+        Serial.println("Batch response timeout");
+        return;
+    }
+    uint32_t resultLength = ((uint32_t)prefix[0] << 24) | ((uint32_t)prefix[1] << 16) |
+                            ((uint32_t)prefix[2] << 8) | (uint32_t)prefix[3];
+    String responseString;
+    responseString.reserve(resultLength);
+    while (responseString.length() < resultLength && aiClient.connected()) {
+        char c;
+        if (aiClient.readBytes(&c, 1) != 1) {
+            break;
+        }
+        responseString += c;
+    }
+    if (responseString.length() != resultLength ||
+        deserializeJson(response, responseString) != DeserializationError::Ok) {
+        aiClient.stop();
+        Serial.println("Invalid batch response");
+        return;
+    }
+    
+    JsonArrayConst perFrame = response["results"];
+    Serial.printf("Batch response covers %d of %d frame(s)\n", (int)perFrame.size(), sentFrames);
+    for (JsonVariantConst frameResult : perFrame) {
+        JsonDocument frameDoc(&telemetryArena);
+        frameDoc.set(frameResult);
+        // No frame buffer to attach as evidence for batched frames
+        processDetectionResults(frameDoc, NULL);
+    }
+}
+
+/**
+ * Re-send one spooled frame now that the server is reachable
+ *
+ * Called once per task loop pass, so live frames always interleave
+ * with backlog. The file is deleted before the send: the upload path
+ * re-spools the copy on failure, which also pushes repeat offenders
+ * to the back of the queue instead of letting one poison frame block
+ * the drain forever.
+ */
+void drainSpool() {
+#if USE_LEGACY_BASE64_SERVER
+    // The legacy HTTP server has no persistent-session re-send path;
+    // spooled frames wait for a firmware running the stream protocol
+    return;
+#endif
+    if (spoolFileCount == 0 || WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+    if (!connectToAIServer()) {
+        return;
+    }
+
+    uint8_t* data = NULL;
+    size_t len = 0;
+    xSemaphoreTake(spoolMutex, portMAX_DELAY);
+    char path[48];
+    File f;
+    while (spoolFileCount > 0 && spoolSeqHead < spoolSeqNext) {
+        spoolPath(path, sizeof(path), spoolSeqHead);
+        f = LittleFS.open(path, "r");
+        if (f) {
+            break;
+        }
+        spoolSeqHead++;  // Hole left by an eviction, skip it
+    }
+    if (f) {
+        len = f.size();
+        data = (uint8_t*)heap_caps_malloc(len, MALLOC_CAP_SPIRAM);
+        if (data == NULL) {
+            data = (uint8_t*)malloc(len);
+        }
+        if (data != NULL) {
+            size_t offset = 0;
+            while (offset < len) {
+                size_t got = f.read(data + offset, len - offset);
+                if (got == 0) {
+                    break;
+                }
+                offset += got;
+            }
+            if (offset != len) {
+                free(data);
+                data = NULL;
+            }
+        }
+        f.close();
+        // The bytes are staged (or lost to an allocation failure);
+        // either way the file is done
+        LittleFS.remove(path);
+        spoolBytes -= (len <= spoolBytes) ? len : spoolBytes;
+        spoolFileCount--;
+        spoolSeqHead++;
+    }
+    xSemaphoreGive(spoolMutex);
+    if (data == NULL) {
+        return;
+    }
+
+    Serial.printf("Re-sending spooled frame (%u bytes, %d left)...\n",
+                  (unsigned)len, spoolFileCount);
+    writeFramePrefix(len);
+    if (aiClient.write(data, len) != len) {
+        aiClient.stop();
+        spoolEnqueue(data, len);  // Back to the spool, retry later
+        return;
+    }
+    free(data);
+
+    // Same length-prefixed response as the live single-frame path
+    uint8_t prefix[4];
+    if (aiClient.readBytes(prefix, sizeof(prefix)) != sizeof(prefix)) {
+        aiClient.stop();
+        return;
+    }
+    uint32_t resultLength = ((uint32_t)prefix[0] << 24) | ((uint32_t)prefix[1] << 16) |
+                            ((uint32_t)prefix[2] << 8) | (uint32_t)prefix[3];
+    String responseString;
+    responseString.reserve(resultLength);
+    while (responseString.length() < resultLength && aiClient.connected()) {
+        char c;
+        if (aiClient.readBytes(&c, 1) != 1) {
+            break;
+        }
+        responseString += c;
+    }
+    JsonDocument response(&telemetryArena);
+    if (responseString.length() != resultLength ||
+        deserializeJson(response, responseString) != DeserializationError::Ok) {
+        aiClient.stop();
+        return;
+    }
+    // No frame buffer to attach as evidence for spooled frames
+    processDetectionResults(response, NULL);
 }
 
 /**
@@ -334,28 +1652,77 @@ void TaskHybridAI(void *pvParameters) {
             connectToMQTT();
         }
         mqttClient.loop();
-        
-        // Check if it's time to capture
-        unsigned long currentTime = millis();
-        if (isDetectionEnabled && (currentTime - lastCaptureTime >= CAPTURE_INTERVAL)) {
-            
-            Serial.println("Capturing image for AI processing...");
-            
-            // Capture image
-            String base64Image = captureImageBase64();
-            if (base64Image.length() > 0) {
-                
-                // Send to server for processing
-                JsonDocument results = sendImageForProcessing(base64Image);
-                
-                // Process results
-                processDetectionResults(results);
+        // Drain anything queued (including messages that waited out a
+        // broker outage) before blocking on the next frame
+        sendPump();
+        // One spooled frame per pass once the server is back, so the
+        // backlog drains without starving live captures
+        drainSpool();
+
+        // Wait for the capture task to hand over the next frame; the
+        // queue's tee reference becomes ours to release
+        FrameTee::SharedFrame* sf = NULL;
+        if (xQueueReceive(frameQueue, &sf, pdMS_TO_TICKS(1000)) == pdTRUE && sf != NULL) {
+            camera_fb_t* fb = sf->fb;
+
+            // Previous cycle's documents are all dead by now, reclaim
+            // the arena and report when a cycle needed more than before
+            static size_t reportedHighWater = 0;
+            telemetryArena.reset();
+            if (telemetryArena.highWaterMark() > reportedHighWater) {
+                reportedHighWater = telemetryArena.highWaterMark();
+                Serial.printf("Telemetry arena high-water mark: %u/%u bytes (%u overflow(s))\n",
+                              (unsigned)reportedHighWater,
+                              (unsigned)telemetryArena.capacity(),
+                              (unsigned)telemetryArena.overflowCount());
+            }
+
+            Serial.println("Processing captured frame...");
+
+            uint32_t ageMs = frameAgeMs(fb);
+            if (ageMs > MAX_FRAME_AGE_MS) {
+                // Aged out waiting behind a slow upload; skip it and let
+                // the capture task hand over a current one
+                Serial.printf("Dropping stale frame (%lu ms old)\n", (unsigned long)ageMs);
+                frameTee.release(sf);
+            } else if (fb->len > MAX_IMAGE_SIZE) {
+                Serial.printf("Image too large: %d bytes\n", fb->len);
+                frameTee.release(sf);
+            } else if (frameBatchSize > 1 && captureIntervalMs > CAPTURE_INTERVAL) {
+                // Low-priority survey frame: queue it for a batched
+                // upload instead of paying a round trip per frame
+                enqueueBatchFrame(fb);
+                frameTee.release(sf);
+                if (pendingBatchCount >= (int)frameBatchSize) {
+                    sendBatchForProcessing();
+                }
+            } else {
+                // Escalated or unbatched frame: flush any pending batch
+                // first so results keep arriving in capture order
+                if (pendingBatchCount > 0) {
+                    sendBatchForProcessing();
+                }
                 
-                lastCaptureTime = currentTime;
+                // Send to server for processing, the buffer is streamed
+                // directly from the frame buffer to the socket. The driver
+                // keeps capturing into the second buffer meanwhile
+                JsonDocument results = sendImageForProcessing(fb);
+
+                // Upload failed: spool the frame to flash so the drain
+                // can still get it through detection later
+                if (results.containsKey("error")) {
+                    spoolFrameCopy(fb->buf, fb->len);
+                }
+
+                // Process results while the frame is still alive, so it
+                // can be attached as alert evidence
+                processDetectionResults(results, fb);
+                frameTee.release(sf);
             }
+            // Alerts queued while processing this frame go out now,
+            // ahead of any evidence segments
+            sendPump();
         }
-        
-        vTaskDelay(pdMS_TO_TICKS(1000));  // Check every second
     }
 }
 
@@ -364,7 +1731,16 @@ void setup() {
     delay(3000);
     
     Serial.println("=== ESP32-CAM Hybrid AI Processing ===");
-    
+
+    // Runtime config overlay: a persisted threshold beats the compiled
+    // default, so a retuned node keeps its tuning across reboots
+    configPrefs.begin("aicfg", false);
+    detectionThreshold = configPrefs.getFloat("threshold", DETECTION_THRESHOLD);
+
+    // Mount the evidence spool early: frames spooled before the last
+    // reboot are picked up again by the drain
+    initSpool();
+
     // Initialize camera
     if (!initCamera()) {
         Serial.println("Camera initialization failed!");
@@ -373,12 +1749,47 @@ void setup() {
     
     // Connect to WiFi
     connectToWiFi();
-    
+
+    // Stable per-device phase: hash the MAC into an offset within the
+    // shared interval and date the "last capture" so the first one lands
+    // at boot + phase. Every device waits out a different slice of the
+    // interval, so a fleet-wide power restoration comes back spread
+    // uniformly instead of in one synchronized burst.
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    uint32_t macHash = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+        macHash = (macHash ^ mac[i]) * 16777619u;
+    }
+    capturePhaseMs = macHash % CAPTURE_INTERVAL;
+    lastCaptureTime = millis() + capturePhaseMs - CAPTURE_INTERVAL;
+    Serial.printf("Capture phase offset: %lu ms\n", capturePhaseMs);
+
+    // mDNS responder doubles as our query interface for discovering the
+    // AI server's _aidetect._tcp advertisement
+    if (!MDNS.begin("esp32cam-hybrid")) {
+        Serial.println("mDNS start failed, falling back to configured server");
+    }
+
     // Setup MQTT
     mqttClient.setServer(MQTT_BROKER, MQTT_PORT);
     mqttClient.setCallback(mqttCallback);
     
-    // Create hybrid AI task
+    // Frame hand-off queue between the capture and upload tasks
+    frameQueue = xQueueCreate(FRAME_QUEUE_DEPTH, sizeof(FrameTee::SharedFrame*));
+    
+    // Create camera capture task (producer)
+    xTaskCreatePinnedToCore(
+        TaskCameraCapture,  // Task function
+        "Camera_Capture",   // Task name
+        4096,              // Stack size
+        NULL,              // Parameters
+        2,                 // Priority
+        NULL,              // Task handle
+        0                  // Core 0
+    );
+    
+    // Create hybrid AI task (consumer)
     xTaskCreatePinnedToCore(
         TaskHybridAI,       // Task function
         "Hybrid_AI",        // Task name
@@ -388,42 +1799,78 @@ void setup() {
         NULL,              // Task handle
         1                  // Core 1
     );
-    
+
+    // MJPEG live view server (shares capture frames through the tee;
+    // low priority so a slow viewer socket never delays detection)
+    xTaskCreatePinnedToCore(
+        TaskMjpegStream,    // Task function
+        "MJPEG_Stream",     // Task name
+        4096,              // Stack size
+        NULL,              // Parameters
+        1,                 // Priority
+        NULL,              // Task handle
+        0                  // Core 0
+    );
+
+    // Create spool writer (flash I/O at idle priority, never in the way)
+    if (spoolQueue != NULL) {
+        xTaskCreatePinnedToCore(
+            TaskSpoolWriter,    // Task function
+            "Spool_Writer",     // Task name
+            4096,              // Stack size
+            NULL,              // Parameters
+            1,                 // Priority
+            NULL,              // Task handle
+            0                  // Core 0
+        );
+    }
+
     Serial.println("Setup complete. Hybrid AI processing active.");
-    Serial.printf("AI Server: %s\n", AI_SERVER_URL);
-    Serial.printf("Capture Interval: %d ms\n", CAPTURE_INTERVAL);
-    Serial.printf("Detection Threshold: %.2f\n", DETECTION_THRESHOLD);
+    Serial.printf("AI Server: _%s._tcp via mDNS (fallback %s:%d)\n",
+                  AI_SERVER_SERVICE, AI_SERVER_HOST, AI_SERVER_PORT);
+    Serial.printf("Capture Interval: %d ms (adaptive)\n", CAPTURE_INTERVAL);
+    Serial.printf("Live view: http://%s:%d/\n",
+                  WiFi.localIP().toString().c_str(), MJPEG_STREAM_PORT);
+    Serial.printf("Detection Threshold: %.2f (runtime, set_threshold:<v> to change)\n",
+                  (float)detectionThreshold);
 }
 
 void loop() {
-    // Main loop handles other tasks
-    delay(1000);
+    // The arduino loop task runs at idle-ish priority, which makes it
+    // the right place to stream the task timeline: drains never compete
+    // with the capture or inference tasks they are observing
+    if (taskTrace.isRunning() &&
+        millis() - lastTraceDrainMs >= TASK_TRACE_DRAIN_MS) {
+        lastTraceDrainMs = millis();
+        taskTrace.drain(Serial);
+    }
+    delay(taskTrace.isRunning() ? 100 : 1000);
 }
 
 /**
- * Example server endpoint implementation (Python Flask):
+ * Example server implementation (Python socketserver):
  * 
- * @app.route('/api/detect', methods=['POST'])
- * def detect_objects():
- *     data = request.get_json()
- *     
- *     # Decode base64 image
- *     image_data = base64.b64decode(data['image'])
- *     
- *     # Load YOLO model and run inference
- *     results = yolo_model.predict(image_data)
- *     
- *     detections = []
- *     for result in results:
- *         detections.append({
- *             'class': result.class_name,
- *             'confidence': result.confidence,
- *             'bbox': result.bbox
- *         })
- *     
- *     return jsonify({
- *         'detections': detections,
- *         'processing_time_ms': processing_time,
- *         'model_version': 'yolov8m_fire_detection'
- *     })
+ * class DetectionHandler(socketserver.StreamRequestHandler):
+ *     def handle(self):
+ *         # one persistent connection per device, frames keep arriving
+ *         while True:
+ *             prefix = self.rfile.read(4)
+ *             if len(prefix) < 4:
+ *                 break
+ *             length = int.from_bytes(prefix, 'big')
+ *             image_data = self.rfile.read(length)
+ *             
+ *             # Load YOLO model and run inference
+ *             results = yolo_model.predict(image_data)
+ *             
+ *             detections = [{'class': r.class_name,
+ *                            'confidence': r.confidence,
+ *                            'bbox': r.bbox} for r in results]
+ *             
+ *             payload = json.dumps({
+ *                 'detections': detections,
+ *                 'processing_time_ms': processing_time,
+ *                 'model_version': 'yolov8m_fire_detection'
+ *             }).encode()
+ *             self.wfile.write(len(payload).to_bytes(4, 'big') + payload)
  */ 
\ No newline at end of file
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/csvload.dir/main.cpp.o"
+  "CMakeFiles/csvload.dir/main.cpp.o.d"
+  "csvload"
+  "csvload.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/csvload.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
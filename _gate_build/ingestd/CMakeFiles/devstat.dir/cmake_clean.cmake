@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/devstat.dir/devstat.cpp.o"
+  "CMakeFiles/devstat.dir/devstat.cpp.o.d"
+  "devstat"
+  "devstat.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/devstat.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
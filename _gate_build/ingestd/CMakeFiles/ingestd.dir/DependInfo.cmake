@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/backend/ingestd/anomaly_detector.cpp" "ingestd/CMakeFiles/ingestd.dir/anomaly_detector.cpp.o" "gcc" "ingestd/CMakeFiles/ingestd.dir/anomaly_detector.cpp.o.d"
+  "/root/repo/backend/ingestd/main.cpp" "ingestd/CMakeFiles/ingestd.dir/main.cpp.o" "gcc" "ingestd/CMakeFiles/ingestd.dir/main.cpp.o.d"
+  "/root/repo/backend/ingestd/pg_copy_writer.cpp" "ingestd/CMakeFiles/ingestd.dir/pg_copy_writer.cpp.o" "gcc" "ingestd/CMakeFiles/ingestd.dir/pg_copy_writer.cpp.o.d"
+  "/root/repo/backend/ingestd/udp_burst_receiver.cpp" "ingestd/CMakeFiles/ingestd.dir/udp_burst_receiver.cpp.o" "gcc" "ingestd/CMakeFiles/ingestd.dir/udp_burst_receiver.cpp.o.d"
+  "/root/repo/backend/ingestd/writer_pool.cpp" "ingestd/CMakeFiles/ingestd.dir/writer_pool.cpp.o" "gcc" "ingestd/CMakeFiles/ingestd.dir/writer_pool.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_gate_build/common/CMakeFiles/backend_common.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,19 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ingestd.dir/anomaly_detector.cpp.o"
+  "CMakeFiles/ingestd.dir/anomaly_detector.cpp.o.d"
+  "CMakeFiles/ingestd.dir/main.cpp.o"
+  "CMakeFiles/ingestd.dir/main.cpp.o.d"
+  "CMakeFiles/ingestd.dir/pg_copy_writer.cpp.o"
+  "CMakeFiles/ingestd.dir/pg_copy_writer.cpp.o.d"
+  "CMakeFiles/ingestd.dir/udp_burst_receiver.cpp.o"
+  "CMakeFiles/ingestd.dir/udp_burst_receiver.cpp.o.d"
+  "CMakeFiles/ingestd.dir/writer_pool.cpp.o"
+  "CMakeFiles/ingestd.dir/writer_pool.cpp.o.d"
+  "ingestd"
+  "ingestd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ingestd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/backend/tsdb/rollup.cpp" "tsdb/CMakeFiles/tsdb.dir/rollup.cpp.o" "gcc" "tsdb/CMakeFiles/tsdb.dir/rollup.cpp.o.d"
+  "/root/repo/backend/tsdb/segment.cpp" "tsdb/CMakeFiles/tsdb.dir/segment.cpp.o" "gcc" "tsdb/CMakeFiles/tsdb.dir/segment.cpp.o.d"
+  "/root/repo/backend/tsdb/tsdb_store.cpp" "tsdb/CMakeFiles/tsdb.dir/tsdb_store.cpp.o" "gcc" "tsdb/CMakeFiles/tsdb.dir/tsdb_store.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tsdb.dir/rollup.cpp.o"
+  "CMakeFiles/tsdb.dir/rollup.cpp.o.d"
+  "CMakeFiles/tsdb.dir/segment.cpp.o"
+  "CMakeFiles/tsdb.dir/segment.cpp.o.d"
+  "CMakeFiles/tsdb.dir/tsdb_store.cpp.o"
+  "CMakeFiles/tsdb.dir/tsdb_store.cpp.o.d"
+  "libtsdb.a"
+  "libtsdb.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tsdb.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
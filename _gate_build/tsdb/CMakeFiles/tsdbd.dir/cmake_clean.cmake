@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tsdbd.dir/tsdbd_main.cpp.o"
+  "CMakeFiles/tsdbd.dir/tsdbd_main.cpp.o.d"
+  "tsdbd"
+  "tsdbd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tsdbd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
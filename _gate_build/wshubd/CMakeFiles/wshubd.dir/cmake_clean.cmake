@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/wshubd.dir/main.cpp.o"
+  "CMakeFiles/wshubd.dir/main.cpp.o.d"
+  "CMakeFiles/wshubd.dir/ws_hub.cpp.o"
+  "CMakeFiles/wshubd.dir/ws_hub.cpp.o.d"
+  "wshubd"
+  "wshubd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/wshubd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
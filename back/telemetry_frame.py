@@ -0,0 +1,50 @@
+"""Decoder for the binary telemetry frame published by the firmware.
+
+The frame layout comes from the generated schema module (see
+schema/telemetry.json and schema/gen_telemetry.py), the same source the
+firmware struct is generated from, so the two sides cannot drift.
+The frame has no epoch timestamp (devices have no synced clock); the
+caller passes the receive time and the sample time is reconstructed as
+receive_time - ageMs.
+"""
+
+import struct
+from datetime import datetime, timedelta
+
+from telemetry_schema_gen import TELEMETRY_FRAME_VERSION, FRAME_FORMAT
+
+_FRAME_FORMAT = FRAME_FORMAT
+FRAME_SIZE = struct.calcsize(_FRAME_FORMAT)
+
+
+def decode_frame(payload, received_at=None):
+    """Decode one binary telemetry frame into the same dict shape the
+    JSON telemetry path produces, plus sequence/device metadata.
+
+    Raises ValueError on size or version mismatch so the ingestion
+    loop can count and drop bad frames instead of crashing.
+    """
+    if len(payload) != FRAME_SIZE:
+        raise ValueError(
+            f"bad frame size {len(payload)}, expected {FRAME_SIZE}")
+
+    (version, device_id, sequence, uptime_ms, age_ms,
+     temperature_centi, humidity_centi, light, moisture) = struct.unpack(
+        _FRAME_FORMAT, payload)
+
+    if version != TELEMETRY_FRAME_VERSION:
+        raise ValueError(f"unknown frame version {version}")
+
+    if received_at is None:
+        received_at = datetime.now()
+
+    return {
+        "device_id": device_id,
+        "sequence": sequence,
+        "sampled_at": received_at - timedelta(milliseconds=age_ms),
+        "uptime_ms": uptime_ms,
+        "temperature": temperature_centi / 100.0,
+        "humidity": humidity_centi / 100.0,
+        "light": float(light),
+        "moisture": float(moisture),
+    }
@@ -0,0 +1,27 @@
+"""GENERATED by schema/gen_telemetry.py from schema/telemetry.json - do not edit."""
+
+TELEMETRY_FRAME_VERSION = 1
+
+# struct.unpack format for the packed frame in
+# platformio/src/telemetry_schema_gen.h
+FRAME_FORMAT = "<BBHIIhHHH"
+
+FRAME_FIELDS = (
+    "version",
+    "deviceId",
+    "sequence",
+    "uptimeMs",
+    "ageMs",
+    "temperatureCenti",
+    "humidityCenti",
+    "light",
+    "moisture",
+)
+
+# JSON-visible sensor values: json key -> (frame field, scale)
+JSON_FIELDS = {
+    "temperature": ("temperatureCenti", 100),
+    "humidity": ("humidityCenti", 100),
+    "light": ("light", 1),
+    "moisture": ("moisture", 1),
+}
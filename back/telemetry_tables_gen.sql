@@ -0,0 +1,41 @@
+-- GENERATED by schema/gen_telemetry.py from schema/telemetry.json - do not edit.
+
+-- temperature telemetry (JSON key "temperature", unit C)
+CREATE TABLE IF NOT EXISTS Data_Temperature (
+    DataID INTEGER PRIMARY KEY,
+    DID INTEGER REFERENCES Device(DID),
+    Value DECIMAL,
+    Unit VARCHAR(10),
+    Status VARCHAR(20),
+    Timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- humidity telemetry (JSON key "humidity", unit %)
+CREATE TABLE IF NOT EXISTS Data_Humidity (
+    DataID INTEGER PRIMARY KEY,
+    DID INTEGER REFERENCES Device(DID),
+    Value DECIMAL,
+    Unit VARCHAR(10),
+    Status VARCHAR(20),
+    Timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- light telemetry (JSON key "light", unit lux)
+CREATE TABLE IF NOT EXISTS Data_Light (
+    DataID INTEGER PRIMARY KEY,
+    DID INTEGER REFERENCES Device(DID),
+    Value DECIMAL,
+    Unit VARCHAR(10),
+    Status VARCHAR(20),
+    Timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- moisture telemetry (JSON key "moisture", unit %)
+CREATE TABLE IF NOT EXISTS Data_Moisture (
+    DataID INTEGER PRIMARY KEY,
+    DID INTEGER REFERENCES Device(DID),
+    Value DECIMAL,
+    Unit VARCHAR(10),
+    Status VARCHAR(20),
+    Timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
@@ -0,0 +1,86 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/backend/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/backend/brokerd/CMakeLists.txt"
+  "/root/repo/backend/common/CMakeLists.txt"
+  "/root/repo/backend/csvload/CMakeLists.txt"
+  "/root/repo/backend/fleetsim/CMakeLists.txt"
+  "/root/repo/backend/gateway/CMakeLists.txt"
+  "/root/repo/backend/historyd/CMakeLists.txt"
+  "/root/repo/backend/ingestd/CMakeLists.txt"
+  "/root/repo/backend/otawave/CMakeLists.txt"
+  "/root/repo/backend/replay/CMakeLists.txt"
+  "/root/repo/backend/sectorqd/CMakeLists.txt"
+  "/root/repo/backend/tsdb/CMakeLists.txt"
+  "/root/repo/backend/wshubd/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindJPEG.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPostgreSQL.cmake"
+  "/usr/share/cmake-3.25/Modules/FindSQLite3.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/SelectLibraryConfigurations.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "brokerd/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "common/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "csvload/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "fleetsim/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "gateway/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "historyd/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "ingestd/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "otawave/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "replay/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "sectorqd/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tsdb/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "wshubd/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "brokerd/CMakeFiles/brokerd.dir/DependInfo.cmake"
+  "common/CMakeFiles/backend_common.dir/DependInfo.cmake"
+  "csvload/CMakeFiles/csvload.dir/DependInfo.cmake"
+  "fleetsim/CMakeFiles/fleetsim.dir/DependInfo.cmake"
+  "gateway/CMakeFiles/gateway.dir/DependInfo.cmake"
+  "historyd/CMakeFiles/historyd.dir/DependInfo.cmake"
+  "ingestd/CMakeFiles/ingestd.dir/DependInfo.cmake"
+  "ingestd/CMakeFiles/devstat.dir/DependInfo.cmake"
+  "otawave/CMakeFiles/otawave.dir/DependInfo.cmake"
+  "replay/CMakeFiles/replay.dir/DependInfo.cmake"
+  "sectorqd/CMakeFiles/sectorqd.dir/DependInfo.cmake"
+  "tsdb/CMakeFiles/tsdb.dir/DependInfo.cmake"
+  "tsdb/CMakeFiles/tsdbd.dir/DependInfo.cmake"
+  "wshubd/CMakeFiles/wshubd.dir/DependInfo.cmake"
+  )
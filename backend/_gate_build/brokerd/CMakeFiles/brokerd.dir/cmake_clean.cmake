@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/brokerd.dir/main.cpp.o"
+  "CMakeFiles/brokerd.dir/main.cpp.o.d"
+  "CMakeFiles/brokerd.dir/mqtt_broker.cpp.o"
+  "CMakeFiles/brokerd.dir/mqtt_broker.cpp.o.d"
+  "CMakeFiles/brokerd.dir/spool.cpp.o"
+  "CMakeFiles/brokerd.dir/spool.cpp.o.d"
+  "brokerd"
+  "brokerd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/brokerd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/backend_common.dir/mqtt_consumer.cpp.o"
+  "CMakeFiles/backend_common.dir/mqtt_consumer.cpp.o.d"
+  "libbackend_common.a"
+  "libbackend_common.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/backend_common.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
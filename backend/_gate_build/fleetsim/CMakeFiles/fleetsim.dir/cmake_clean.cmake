@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/fleetsim.dir/main.cpp.o"
+  "CMakeFiles/fleetsim.dir/main.cpp.o.d"
+  "fleetsim"
+  "fleetsim.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/fleetsim.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,26 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/backend/gateway/command_push.cpp" "gateway/CMakeFiles/gateway.dir/command_push.cpp.o" "gcc" "gateway/CMakeFiles/gateway.dir/command_push.cpp.o.d"
+  "/root/repo/backend/gateway/gateway_main.cpp" "gateway/CMakeFiles/gateway.dir/gateway_main.cpp.o" "gcc" "gateway/CMakeFiles/gateway.dir/gateway_main.cpp.o.d"
+  "/root/repo/backend/gateway/http_server.cpp" "gateway/CMakeFiles/gateway.dir/http_server.cpp.o" "gcc" "gateway/CMakeFiles/gateway.dir/http_server.cpp.o.d"
+  "/root/repo/backend/gateway/model_cache.cpp" "gateway/CMakeFiles/gateway.dir/model_cache.cpp.o" "gcc" "gateway/CMakeFiles/gateway.dir/model_cache.cpp.o.d"
+  "/root/repo/backend/gateway/ort_backend.cpp" "gateway/CMakeFiles/gateway.dir/ort_backend.cpp.o" "gcc" "gateway/CMakeFiles/gateway.dir/ort_backend.cpp.o.d"
+  "/root/repo/backend/gateway/pipeline.cpp" "gateway/CMakeFiles/gateway.dir/pipeline.cpp.o" "gcc" "gateway/CMakeFiles/gateway.dir/pipeline.cpp.o.d"
+  "/root/repo/backend/gateway/preprocess.cpp" "gateway/CMakeFiles/gateway.dir/preprocess.cpp.o" "gcc" "gateway/CMakeFiles/gateway.dir/preprocess.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/backend/_gate_build/common/CMakeFiles/backend_common.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
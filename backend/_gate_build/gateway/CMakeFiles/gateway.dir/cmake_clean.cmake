@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gateway.dir/command_push.cpp.o"
+  "CMakeFiles/gateway.dir/command_push.cpp.o.d"
+  "CMakeFiles/gateway.dir/gateway_main.cpp.o"
+  "CMakeFiles/gateway.dir/gateway_main.cpp.o.d"
+  "CMakeFiles/gateway.dir/http_server.cpp.o"
+  "CMakeFiles/gateway.dir/http_server.cpp.o.d"
+  "CMakeFiles/gateway.dir/model_cache.cpp.o"
+  "CMakeFiles/gateway.dir/model_cache.cpp.o.d"
+  "CMakeFiles/gateway.dir/ort_backend.cpp.o"
+  "CMakeFiles/gateway.dir/ort_backend.cpp.o.d"
+  "CMakeFiles/gateway.dir/pipeline.cpp.o"
+  "CMakeFiles/gateway.dir/pipeline.cpp.o.d"
+  "CMakeFiles/gateway.dir/preprocess.cpp.o"
+  "CMakeFiles/gateway.dir/preprocess.cpp.o.d"
+  "gateway"
+  "gateway.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gateway.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
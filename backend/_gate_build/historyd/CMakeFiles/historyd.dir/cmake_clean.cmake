@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/historyd.dir/detection_recorder.cpp.o"
+  "CMakeFiles/historyd.dir/detection_recorder.cpp.o.d"
+  "CMakeFiles/historyd.dir/main.cpp.o"
+  "CMakeFiles/historyd.dir/main.cpp.o.d"
+  "historyd"
+  "historyd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/historyd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/otawave.dir/main.cpp.o"
+  "CMakeFiles/otawave.dir/main.cpp.o.d"
+  "otawave"
+  "otawave.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/otawave.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
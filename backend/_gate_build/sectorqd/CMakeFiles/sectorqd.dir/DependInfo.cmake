@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/backend/sectorqd/main.cpp" "sectorqd/CMakeFiles/sectorqd.dir/main.cpp.o" "gcc" "sectorqd/CMakeFiles/sectorqd.dir/main.cpp.o.d"
+  "/root/repo/backend/sectorqd/sector_queries.cpp" "sectorqd/CMakeFiles/sectorqd.dir/sector_queries.cpp.o" "gcc" "sectorqd/CMakeFiles/sectorqd.dir/sector_queries.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/backend/_gate_build/common/CMakeFiles/backend_common.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sectorqd.dir/main.cpp.o"
+  "CMakeFiles/sectorqd.dir/main.cpp.o.d"
+  "CMakeFiles/sectorqd.dir/sector_queries.cpp.o"
+  "CMakeFiles/sectorqd.dir/sector_queries.cpp.o.d"
+  "sectorqd"
+  "sectorqd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sectorqd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
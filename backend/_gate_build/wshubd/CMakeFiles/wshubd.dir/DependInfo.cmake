@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/backend/wshubd/main.cpp" "wshubd/CMakeFiles/wshubd.dir/main.cpp.o" "gcc" "wshubd/CMakeFiles/wshubd.dir/main.cpp.o.d"
+  "/root/repo/backend/wshubd/ws_hub.cpp" "wshubd/CMakeFiles/wshubd.dir/ws_hub.cpp.o" "gcc" "wshubd/CMakeFiles/wshubd.dir/ws_hub.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/backend/_gate_build/common/CMakeFiles/backend_common.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
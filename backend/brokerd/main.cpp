@@ -0,0 +1,274 @@
+// brokerd: edge micro-broker with store-and-forward to CoreIoT.
+//
+// When the farm's WAN uplink drops, every node buffering on its own
+// means local automation that depends on a neighbour's data — a fan
+// answering another sector's temperature — stops with the uplink. This
+// daemon is a small MQTT broker for the farm LAN: local pub/sub keeps
+// working at LAN latency whatever the WAN is doing, and a bridge
+// thread forwards the selected topics upstream, spooling to disk while
+// the uplink is down and replaying the backlog in order on recovery.
+//
+// The split is the point: the event loop owns the local clients and
+// never touches the WAN, the bridge thread owns the upstream
+// connection and never touches a client socket. The disk spool
+// (spool.h) is the only thing between them, so an uplink outage costs
+// disk space, not local control latency.
+//
+// Usage:
+//   brokerd [--listen-port 1884] [--upstream host] [--upstream-port 1883]
+//           [--user u] [--password p] [--bridge filter]...
+//           [--spool path] [--spool-mb n]
+//
+// --bridge may repeat; it defaults to the telemetry topics so purely
+// local traffic (actuation, config) never leaves the farm.
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "mqtt_broker.h"
+#include "mqtt_consumer.h"
+#include "spool.h"
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t epochMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Options {
+  uint16_t listenPort = 1884;  // local LAN listener
+  std::string upstream = "app.coreiot.io";
+  uint16_t upstreamPort = 1883;
+  std::string user;
+  std::string password;
+  std::vector<std::string> bridgeFilters;
+  std::string spoolPath = "brokerd.spool";
+  uint64_t spoolBytes = 64ULL * 1024 * 1024;
+};
+
+bool parseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--listen-port" && hasValue) {
+      options.listenPort = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--upstream" && hasValue) {
+      options.upstream = argv[++i];
+    } else if (arg == "--upstream-port" && hasValue) {
+      options.upstreamPort = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--user" && hasValue) {
+      options.user = argv[++i];
+    } else if (arg == "--password" && hasValue) {
+      options.password = argv[++i];
+    } else if (arg == "--bridge" && hasValue) {
+      options.bridgeFilters.push_back(argv[++i]);
+    } else if (arg == "--spool" && hasValue) {
+      options.spoolPath = argv[++i];
+    } else if (arg == "--spool-mb" && hasValue) {
+      options.spoolBytes = static_cast<uint64_t>(atoi(argv[++i])) * 1024 * 1024;
+    } else {
+      fprintf(stderr,
+              "usage: brokerd [--listen-port n] [--upstream host]\n"
+              "               [--upstream-port n] [--user u] [--password p]\n"
+              "               [--bridge filter]... [--spool path] [--spool-mb n]\n");
+      return false;
+    }
+  }
+  if (options.bridgeFilters.empty()) {
+    options.bridgeFilters = {"v1/devices/me/telemetry/#",
+                             "v1/devices/me/telemetry",
+                             "coreiot/gateway/telemetry/#",
+                             "coreiot/gateway/telemetry"};
+  }
+  return true;
+}
+
+// Bridge thread: owns the upstream connection, consumes the spool.
+// WAN stalls, DNS timeouts and reconnect backoff all live here, a
+// thread the local event loop never waits on.
+void bridgeLoop(const Options &options, BridgeSpool &spool,
+                std::atomic<bool> &running, std::atomic<uint64_t> &bridged) {
+  MqttConsumer upstream;
+  bool connected = false;
+  int64_t lastAttemptMs = 0;
+  std::string error;
+
+  while (running.load(std::memory_order_relaxed)) {
+    const int64_t now = epochMs();
+
+    if (!connected) {
+      if (now - lastAttemptMs < 5000) {
+        usleep(200 * 1000);
+        continue;
+      }
+      lastAttemptMs = now;
+      if (!upstream.connect(options.upstream, options.upstreamPort, "brokerd",
+                            options.user, options.password, error)) {
+        fprintf(stderr, "brokerd: upstream: %s, retrying\n", error.c_str());
+        continue;
+      }
+      connected = true;
+      printf("brokerd: upstream connected, %llu records spooled\n",
+             (unsigned long long)spool.backlogRecords());
+    }
+
+    // Drain whatever the upstream broker sent (PINGRESP, mostly) and
+    // keep the keepalive alive
+    struct pollfd pfd = {upstream.fd(), POLLIN, 0};
+    if (poll(&pfd, 1, 0) > 0 && !upstream.onReadable()) {
+      upstream.close();
+      connected = false;
+      continue;
+    }
+    if (!upstream.tick(now)) {
+      upstream.close();
+      connected = false;
+      continue;
+    }
+
+    std::string topic, payload;
+    if (!spool.peek(topic, payload)) {
+      usleep(100 * 1000);  // spool empty, idle gently
+      continue;
+    }
+    if (!upstream.publish(topic, payload)) {
+      // Record stays at the cursor and replays once the WAN is back
+      upstream.close();
+      connected = false;
+      continue;
+    }
+    spool.advance();
+    bridged.fetch_add(1, std::memory_order_relaxed);
+  }
+  upstream.close();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  std::string error;
+  BridgeSpool spool;
+  if (!spool.open(options.spoolPath, options.spoolBytes, error)) {
+    fprintf(stderr, "brokerd: spool: %s\n", error.c_str());
+    return 1;
+  }
+  if (spool.backlogRecords() > 0) {
+    printf("brokerd: %llu spooled records recovered, will replay\n",
+           (unsigned long long)spool.backlogRecords());
+  }
+
+  MqttBroker broker;
+  if (!broker.listen(options.listenPort, error)) {
+    fprintf(stderr, "brokerd: %s\n", error.c_str());
+    return 1;
+  }
+
+  const std::vector<std::string> &filters = options.bridgeFilters;
+  broker.setPublishHandler([&spool, &filters](const std::string &topic,
+                                              const uint8_t *payload,
+                                              size_t length) {
+    // The spool counts its own drops; a full spool means the WAN has
+    // been down longer than --spool-mb absorbs
+    for (const std::string &filter : filters) {
+      if (MqttBroker::topicMatches(filter, topic)) {
+        spool.append(topic, payload, length);
+        return;
+      }
+    }
+  });
+
+  std::atomic<bool> running{true};
+  std::atomic<uint64_t> bridged{0};
+  std::thread bridge(bridgeLoop, std::cref(options), std::ref(spool),
+                     std::ref(running), std::ref(bridged));
+
+  printf("brokerd: listening on port %u, bridging to %s:%u\n",
+         options.listenPort, options.upstream.c_str(), options.upstreamPort);
+
+  const int epollFd = epoll_create1(0);
+  const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+  struct itimerspec interval = {};
+  interval.it_interval.tv_sec = 1;
+  interval.it_value.tv_sec = 1;
+  timerfd_settime(timerFd, 0, &interval, nullptr);
+
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = broker.listenFd();
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, broker.listenFd(), &event);
+  event.data.fd = timerFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+
+  int ticks = 0;
+  while (!shuttingDown) {
+    struct epoll_event events[16];
+    const int ready = epoll_wait(epollFd, events, 16, 1000);
+    for (int i = 0; i < ready; i++) {
+      const int fd = events[i].data.fd;
+      if (fd == broker.listenFd()) {
+        int clientFd;
+        while ((clientFd = broker.acceptClient()) >= 0) {
+          event.events = EPOLLIN;
+          event.data.fd = clientFd;
+          epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &event);
+        }
+      } else if (fd == timerFd) {
+        uint64_t expirations;
+        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+        }
+        spool.sync(false);
+        if (++ticks % 10 == 0) {
+          printf("brokerd: %zu clients, %llu msgs in, %llu fanned out, "
+                 "%llu slow dropped, %llu bridged, spool backlog %llu "
+                 "(%llu dropped full)\n",
+                 broker.clientCount(),
+                 (unsigned long long)broker.publishesIn(),
+                 (unsigned long long)broker.publishesOut(),
+                 (unsigned long long)broker.slowClientsDropped(),
+                 (unsigned long long)bridged.load(std::memory_order_relaxed),
+                 (unsigned long long)spool.backlogRecords(),
+                 (unsigned long long)spool.dropped());
+        }
+      } else {
+        // Everything else in the set is a local MQTT client; a false
+        // return means the broker already closed the fd (which also
+        // removes it from the epoll set)
+        broker.onClientReadable(fd);
+      }
+    }
+  }
+
+  running.store(false, std::memory_order_relaxed);
+  bridge.join();
+  broker.closeAll();
+  spool.close();
+  ::close(timerFd);
+  ::close(epollFd);
+  printf("brokerd: shut down, spool backlog %llu records\n",
+         (unsigned long long)spool.backlogRecords());
+  return 0;
+}
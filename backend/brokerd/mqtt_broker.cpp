@@ -0,0 +1,497 @@
+#include "mqtt_broker.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// MQTT control packet types (high nibble of the fixed header)
+constexpr uint8_t kConnect = 0x10;
+constexpr uint8_t kConnack = 0x20;
+constexpr uint8_t kPublish = 0x30;
+constexpr uint8_t kPuback = 0x40;
+constexpr uint8_t kSubscribe = 0x80;
+constexpr uint8_t kSuback = 0x90;
+constexpr uint8_t kUnsubscribe = 0xA0;
+constexpr uint8_t kUnsuback = 0xB0;
+constexpr uint8_t kPingreq = 0xC0;
+constexpr uint8_t kPingresp = 0xD0;
+constexpr uint8_t kDisconnect = 0xE0;
+
+void appendVarint(std::vector<uint8_t> &out, size_t value) {
+  do {
+    uint8_t digit = value % 128;
+    value /= 128;
+    if (value > 0) {
+      digit |= 0x80;
+    }
+    out.push_back(digit);
+  } while (value > 0);
+}
+
+// Returns bytes consumed by the varint, 0 if incomplete, -1 if malformed
+int parseVarint(const uint8_t *data, size_t available, size_t &value) {
+  value = 0;
+  size_t multiplier = 1;
+  for (int i = 0; i < 4; i++) {
+    if (static_cast<size_t>(i) >= available) {
+      return 0;
+    }
+    value += (data[i] & 0x7F) * multiplier;
+    if ((data[i] & 0x80) == 0) {
+      return i + 1;
+    }
+    multiplier *= 128;
+  }
+  return -1;
+}
+
+// Reads a length-prefixed MQTT string, advancing offset; false when the
+// packet is too short for it
+bool parseString(const uint8_t *body, size_t length, size_t &offset,
+                 std::string &out) {
+  if (offset + 2 > length) {
+    return false;
+  }
+  const size_t stringLength =
+      (static_cast<size_t>(body[offset]) << 8) | body[offset + 1];
+  offset += 2;
+  if (offset + stringLength > length) {
+    return false;
+  }
+  out.assign(reinterpret_cast<const char *>(body + offset), stringLength);
+  offset += stringLength;
+  return true;
+}
+
+// Splits a $share/<group>/<filter> subscription into the group key
+// ("<group>/<filter>") and the plain filter. Anything malformed — no
+// group, no filter — is treated as an ordinary subscription; it can
+// never match a real topic, which is also what a broker without the
+// feature would deliver for it: nothing.
+bool parseSharedFilter(const std::string &subscription, std::string &key,
+                       std::string &filter) {
+  const char kPrefix[] = "$share/";
+  const size_t prefixLength = sizeof(kPrefix) - 1;
+  if (subscription.compare(0, prefixLength, kPrefix) != 0) {
+    return false;
+  }
+  const size_t slash = subscription.find('/', prefixLength);
+  if (slash == std::string::npos || slash == prefixLength ||
+      slash + 1 >= subscription.size()) {
+    return false;
+  }
+  key = subscription.substr(prefixLength);
+  filter = subscription.substr(slash + 1);
+  return true;
+}
+
+}  // namespace
+
+MqttBroker::~MqttBroker() {
+  closeAll();
+  if (listenFd_ >= 0) {
+    ::close(listenFd_);
+  }
+}
+
+bool MqttBroker::listen(uint16_t port, std::string &error) {
+  listenFd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (listenFd_ < 0) {
+    error = "socket: " + std::string(strerror(errno));
+    return false;
+  }
+  int one = 1;
+  setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = INADDR_ANY;
+  address.sin_port = htons(port);
+  if (bind(listenFd_, reinterpret_cast<struct sockaddr *>(&address),
+           sizeof(address)) != 0 ||
+      ::listen(listenFd_, 16) != 0) {
+    error = "bind port " + std::to_string(port) + ": " + strerror(errno);
+    ::close(listenFd_);
+    listenFd_ = -1;
+    return false;
+  }
+  return true;
+}
+
+int MqttBroker::acceptClient() {
+  const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK);
+  if (fd < 0) {
+    return -1;
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  clients_[fd];  // default-constructed, awaiting CONNECT
+  return fd;
+}
+
+void MqttBroker::closeClient(int fd) {
+  auto it = clients_.find(fd);
+  if (it == clients_.end()) {
+    return;
+  }
+  for (const std::string &key : it->second.sharedKeys) {
+    auto group = sharedGroups_.find(key);
+    if (group == sharedGroups_.end()) {
+      continue;
+    }
+    std::vector<int> &members = group->second.members;
+    for (auto member = members.begin(); member != members.end();) {
+      member = *member == fd ? members.erase(member) : member + 1;
+    }
+    if (members.empty()) {
+      sharedGroups_.erase(group);
+    }
+  }
+  ::close(fd);
+  clients_.erase(it);
+}
+
+void MqttBroker::closeAll() {
+  for (const auto &entry : clients_) {
+    ::close(entry.first);
+  }
+  clients_.clear();
+  sharedGroups_.clear();
+}
+
+bool MqttBroker::sendRaw(int fd, const uint8_t *data, size_t length) {
+  // All-or-nothing: a socket buffer that cannot take one whole packet
+  // means the client has stopped reading, and buffering for it would
+  // let one stuck subscriber grow the broker without bound
+  const ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL | MSG_DONTWAIT);
+  return n == static_cast<ssize_t>(length);
+}
+
+bool MqttBroker::topicMatches(const std::string &filter,
+                              const std::string &topic) {
+  size_t filterPos = 0;
+  size_t topicPos = 0;
+  while (filterPos < filter.size()) {
+    const size_t filterEnd = filter.find('/', filterPos);
+    const std::string level =
+        filter.substr(filterPos, filterEnd == std::string::npos
+                                     ? std::string::npos
+                                     : filterEnd - filterPos);
+    if (level == "#") {
+      return true;  // matches the remainder, however deep
+    }
+    if (topicPos > topic.size()) {
+      return false;  // topic ran out of levels
+    }
+    const size_t topicEnd = topic.find('/', topicPos);
+    if (level != "+") {
+      const std::string topicLevel =
+          topic.substr(topicPos, topicEnd == std::string::npos
+                                     ? std::string::npos
+                                     : topicEnd - topicPos);
+      if (level != topicLevel) {
+        return false;
+      }
+    }
+    filterPos = filterEnd == std::string::npos ? filter.size() : filterEnd + 1;
+    topicPos = topicEnd == std::string::npos ? topic.size() + 1 : topicEnd + 1;
+  }
+  // Filter exhausted: match only if the topic is too
+  return topicPos > topic.size();
+}
+
+void MqttBroker::fanout(const std::string &topic, const uint8_t *payload,
+                        size_t length) {
+  // One packet built once, QoS 0 out regardless of how it arrived —
+  // local subscribers are on the same LAN segment as the broker and a
+  // lost local delivery means a dead client, not a lossy link
+  std::vector<uint8_t> packet;
+  packet.push_back(kPublish);
+  appendVarint(packet, 2 + topic.size() + length);
+  packet.push_back(static_cast<uint8_t>(topic.size() >> 8));
+  packet.push_back(static_cast<uint8_t>(topic.size() & 0xFF));
+  packet.insert(packet.end(), topic.begin(), topic.end());
+  packet.insert(packet.end(), payload, payload + length);
+
+  std::vector<int> doomed;
+  for (const auto &entry : clients_) {
+    if (!entry.second.connected) {
+      continue;
+    }
+    bool matches = false;
+    for (const std::string &filter : entry.second.filters) {
+      if (topicMatches(filter, topic)) {
+        matches = true;
+        break;
+      }
+    }
+    if (!matches) {
+      continue;
+    }
+    if (sendRaw(entry.first, packet.data(), packet.size())) {
+      publishesOut_++;
+    } else {
+      doomed.push_back(entry.first);
+    }
+  }
+  for (int fd : doomed) {
+    slowDropped_++;
+    closeClient(fd);
+  }
+
+  // Shared groups: one delivery per matching group, round-robin over
+  // the members. A member whose socket is full is dropped like any slow
+  // subscriber, but here the publish moves on to the next member
+  // instead of dying with it — that fail-over is what makes a group of
+  // ingestion daemons lose a consumer, not data.
+  doomed.clear();
+  for (auto &entry : sharedGroups_) {
+    SharedGroup &group = entry.second;
+    if (!topicMatches(group.filter, topic)) {
+      continue;
+    }
+    for (size_t attempt = 0; attempt < group.members.size(); attempt++) {
+      group.next %= group.members.size();
+      const int fd = group.members[group.next];
+      if (sendRaw(fd, packet.data(), packet.size())) {
+        publishesOut_++;
+        group.next++;
+        break;
+      }
+      doomed.push_back(fd);
+      group.members.erase(group.members.begin() + group.next);
+      if (group.members.empty()) {
+        break;
+      }
+    }
+  }
+  for (int fd : doomed) {
+    slowDropped_++;
+    closeClient(fd);
+  }
+}
+
+bool MqttBroker::handlePacket(int fd, Client &client, uint8_t header,
+                              const uint8_t *body, size_t length) {
+  const uint8_t type = header & 0xF0;
+
+  if (!client.connected) {
+    if (type != kConnect || length < 10) {
+      return false;  // anything before CONNECT is a protocol error
+    }
+    // Variable header: protocol name, level, flags, keepalive. Name
+    // and the will/user/password payload fields are ignored — the
+    // broker keeps no sessions and does no auth — but the level must
+    // be 3.1.1 for the framing to be what this parser expects.
+    const size_t nameLength =
+        (static_cast<size_t>(body[0]) << 8) | body[1];
+    const size_t levelOffset = 2 + nameLength;
+    if (levelOffset >= length || body[levelOffset] != 4) {
+      const uint8_t refused[4] = {kConnack, 2, 0, 0x01};
+      sendRaw(fd, refused, sizeof(refused));
+      return false;
+    }
+    const uint8_t connack[4] = {kConnack, 2, 0, 0x00};
+    if (!sendRaw(fd, connack, sizeof(connack))) {
+      return false;
+    }
+    client.connected = true;
+    return true;
+  }
+
+  switch (type) {
+    case kPublish: {
+      if (length < 2) {
+        return false;
+      }
+      size_t offset = 0;
+      std::string topic;
+      if (!parseString(body, length, offset, topic)) {
+        return false;
+      }
+      const uint8_t qos = (header >> 1) & 0x03;
+      uint16_t packetId = 0;
+      if (qos > 0) {
+        if (offset + 2 > length) {
+          return false;
+        }
+        packetId =
+            static_cast<uint16_t>((body[offset] << 8) | body[offset + 1]);
+        offset += 2;
+      }
+      if (qos == 2) {
+        return true;  // not offered; dropped rather than half-handshaked
+      }
+      publishesIn_++;
+      fanout(topic, body + offset, length - offset);
+      if (publishHandler_) {
+        publishHandler_(topic, body + offset, length - offset);
+      }
+      if (qos == 1) {
+        // After fan-out and handler, so an acked PUBLISH has reached
+        // the spool before the publisher may forget it
+        const uint8_t puback[4] = {kPuback, 2,
+                                   static_cast<uint8_t>(packetId >> 8),
+                                   static_cast<uint8_t>(packetId & 0xFF)};
+        if (!sendRaw(fd, puback, sizeof(puback))) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case kSubscribe: {
+      if (length < 2) {
+        return false;
+      }
+      size_t offset = 2;  // past the packet id
+      std::vector<uint8_t> granted;
+      std::string filter;
+      while (offset < length) {
+        if (!parseString(body, length, offset, filter) || offset >= length) {
+          return false;
+        }
+        offset++;  // requested qos; everything is granted at 0
+        std::string key;
+        std::string plain;
+        if (parseSharedFilter(filter, key, plain)) {
+          SharedGroup &group = sharedGroups_[key];
+          group.filter = plain;
+          if (std::find(group.members.begin(), group.members.end(), fd) ==
+              group.members.end()) {
+            group.members.push_back(fd);
+            client.sharedKeys.push_back(key);
+          }
+        } else {
+          client.filters.push_back(filter);
+        }
+        granted.push_back(0);
+      }
+      if (granted.empty()) {
+        return false;
+      }
+      std::vector<uint8_t> suback;
+      suback.push_back(kSuback);
+      appendVarint(suback, 2 + granted.size());
+      suback.push_back(body[0]);
+      suback.push_back(body[1]);
+      suback.insert(suback.end(), granted.begin(), granted.end());
+      return sendRaw(fd, suback.data(), suback.size());
+    }
+    case kUnsubscribe: {
+      if (length < 2) {
+        return false;
+      }
+      size_t offset = 2;
+      std::string filter;
+      while (offset < length) {
+        if (!parseString(body, length, offset, filter)) {
+          return false;
+        }
+        std::string key;
+        std::string plain;
+        if (parseSharedFilter(filter, key, plain)) {
+          auto group = sharedGroups_.find(key);
+          if (group != sharedGroups_.end()) {
+            std::vector<int> &members = group->second.members;
+            for (auto member = members.begin(); member != members.end();) {
+              member = *member == fd ? members.erase(member) : member + 1;
+            }
+            if (members.empty()) {
+              sharedGroups_.erase(group);
+            }
+          }
+          for (auto it = client.sharedKeys.begin();
+               it != client.sharedKeys.end();) {
+            it = *it == key ? client.sharedKeys.erase(it) : it + 1;
+          }
+          continue;
+        }
+        for (auto it = client.filters.begin(); it != client.filters.end();) {
+          it = *it == filter ? client.filters.erase(it) : it + 1;
+        }
+      }
+      const uint8_t unsuback[4] = {kUnsuback, 2, body[0], body[1]};
+      return sendRaw(fd, unsuback, sizeof(unsuback));
+    }
+    case kPingreq: {
+      const uint8_t pingresp[2] = {kPingresp, 0};
+      return sendRaw(fd, pingresp, sizeof(pingresp));
+    }
+    case kDisconnect:
+      return false;
+    default:
+      return true;  // PUBACKs for our QoS 0 fan-out never arrive; ignore
+  }
+}
+
+bool MqttBroker::onClientReadable(int fd) {
+  auto it = clients_.find(fd);
+  if (it == clients_.end()) {
+    return false;
+  }
+  Client &client = it->second;
+
+  uint8_t chunk[16 * 1024];
+  bool socketOpen = true;
+  while (true) {
+    const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n > 0) {
+      client.rx.insert(client.rx.end(), chunk, chunk + n);
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;  // drained
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    socketOpen = false;  // closed or errored; parse what already arrived
+    break;
+  }
+
+  // The close state is tracked separately from stream validity so a
+  // PUBLISH landing in the same readable event as the client's FIN (a
+  // publish-and-disconnect tool) is still fanned out before the close
+  bool alive = true;
+  size_t offset = 0;
+  while (alive && client.rx.size() - offset >= 2) {
+    size_t remainingLength = 0;
+    const int varintBytes =
+        parseVarint(client.rx.data() + offset + 1,
+                    client.rx.size() - offset - 1, remainingLength);
+    if (varintBytes < 0) {
+      alive = false;  // corrupt stream
+      break;
+    }
+    const size_t packetSize = 1 + varintBytes + remainingLength;
+    if (varintBytes == 0 || client.rx.size() - offset < packetSize) {
+      break;  // incomplete, wait for more bytes
+    }
+    if (!handlePacket(fd, client, client.rx[offset],
+                      client.rx.data() + offset + 1 + varintBytes,
+                      remainingLength)) {
+      alive = false;
+      break;
+    }
+    if (clients_.count(fd) == 0) {
+      // A publisher subscribed to its own topic can be dropped as a
+      // slow subscriber inside its own fan-out; the fd is already gone
+      return false;
+    }
+    offset += packetSize;
+  }
+
+  if (!alive || !socketOpen) {
+    closeClient(fd);
+    return false;
+  }
+  client.rx.erase(client.rx.begin(), client.rx.begin() + offset);
+  return true;
+}
@@ -0,0 +1,114 @@
+#ifndef BROKERD_MQTT_BROKER_H
+#define BROKERD_MQTT_BROKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Minimal MQTT 3.1.1 broker for intra-farm traffic.
+//
+// Implements what the local clients actually use — CONNECT/CONNACK,
+// SUBSCRIBE/SUBACK and UNSUBSCRIBE, PUBLISH at QoS 0 and 1, PINGREQ,
+// DISCONNECT — and nothing else: no retained messages, no sessions, no
+// wills, no QoS 2, no auth (the listener faces the farm LAN only, like
+// the rest of the local stack). Subscriptions support the standard
+// + and # wildcards.
+//
+// Shared subscriptions: a filter of the form $share/<group>/<filter>
+// joins the group instead of subscribing individually, and each
+// matching publish is delivered to exactly one group member,
+// round-robin. This is the MQTT 5 construct, honoured here as the
+// topic-filter convention so the 3.1.1 clients in this tree can use it
+// unchanged: N ingestion daemons subscribing $share/ingest/... split
+// the device firehose with no coordination beyond the group name, and
+// a member whose socket backs up is dropped with the publish going to
+// the next member instead of being lost with it.
+//
+// Like WsHub, the broker owns no event loop: the caller epolls the
+// listen fd and every client fd, calls acceptClient() when the
+// listener is readable and onClientReadable() when a client is; a
+// false return means the client is gone and its fd already closed.
+//
+// Fan-out is one nonblocking send() per matching subscriber,
+// all-or-nothing: a client whose socket buffer cannot take a whole
+// packet is hopelessly behind and gets dropped rather than buffered
+// for, same stance as the WebSocket hub. An inbound QoS 1 PUBLISH is
+// acknowledged only after the fan-out and the publish handler have
+// run, so a handler that spools the message makes the hand-off
+// crash-safe.
+class MqttBroker {
+public:
+  // Tap on every inbound PUBLISH, invoked after the local fan-out —
+  // this is where the upstream bridge hooks in.
+  using PublishHandler = std::function<void(
+      const std::string &topic, const uint8_t *payload, size_t length)>;
+
+  ~MqttBroker();
+
+  // Binds and listens on the port (SO_REUSEADDR, nonblocking).
+  bool listen(uint16_t port, std::string &error);
+  int listenFd() const { return listenFd_; }
+
+  // Accepts one pending connection; returns the new nonblocking client
+  // fd for the caller to register, or -1 when nothing is pending.
+  int acceptClient();
+
+  // Drains a readable client fd: answers the handshake, routes
+  // publishes, honours ping and disconnect. Returns false once the
+  // client is closed (by either side) and forgotten.
+  bool onClientReadable(int fd);
+
+  void closeClient(int fd);
+  void closeAll();
+
+  void setPublishHandler(PublishHandler handler) {
+    publishHandler_ = std::move(handler);
+  }
+
+  // MQTT filter match with + (one level) and # (trailing levels).
+  static bool topicMatches(const std::string &filter,
+                           const std::string &topic);
+
+  size_t clientCount() const { return clients_.size(); }
+  uint64_t publishesIn() const { return publishesIn_; }
+  uint64_t publishesOut() const { return publishesOut_; }
+  uint64_t slowClientsDropped() const { return slowDropped_; }
+
+private:
+  struct Client {
+    bool connected = false;  // CONNECT/CONNACK done
+    std::vector<uint8_t> rx;
+    std::vector<std::string> filters;
+    // Keys into sharedGroups_ this client joined, for cleanup
+    std::vector<std::string> sharedKeys;
+  };
+
+  // One $share group+filter: members split the matching stream. The
+  // cursor walks the member list so load spreads evenly.
+  struct SharedGroup {
+    std::string filter;        // the part after $share/<group>/
+    std::vector<int> members;  // client fds, in subscription order
+    size_t next = 0;           // round-robin cursor
+  };
+
+  // Returns false when the packet ends the connection.
+  bool handlePacket(int fd, Client &client, uint8_t header,
+                    const uint8_t *body, size_t length);
+  void fanout(const std::string &topic, const uint8_t *payload,
+              size_t length);
+  bool sendRaw(int fd, const uint8_t *data, size_t length);
+
+  int listenFd_ = -1;
+  std::map<int, Client> clients_;
+  // Keyed "<group>/<filter>" (the original filter minus "$share/")
+  std::map<std::string, SharedGroup> sharedGroups_;
+  PublishHandler publishHandler_;
+  uint64_t publishesIn_ = 0;
+  uint64_t publishesOut_ = 0;
+  uint64_t slowDropped_ = 0;
+};
+
+#endif // BROKERD_MQTT_BROKER_H
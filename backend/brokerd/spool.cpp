@@ -0,0 +1,189 @@
+#include "spool.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace {
+
+constexpr uint64_t kMagic = 0x4C4F4F5053474442ULL;  // "BDGSPOOL"
+constexpr uint32_t kVersion = 1;
+
+struct RecordHeader {
+  uint32_t topicLength;
+  uint32_t payloadLength;
+};
+
+bool readAt(int fd, uint64_t offset, void *out, size_t length) {
+  size_t got = 0;
+  while (got < length) {
+    const ssize_t n = pread(fd, static_cast<uint8_t *>(out) + got,
+                            length - got, offset + got);
+    if (n <= 0) {
+      return false;
+    }
+    got += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool writeAt(int fd, uint64_t offset, const void *data, size_t length) {
+  size_t written = 0;
+  while (written < length) {
+    const ssize_t n = pwrite(fd, static_cast<const uint8_t *>(data) + written,
+                             length - written, offset + written);
+    if (n <= 0) {
+      return false;
+    }
+    written += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+}  // namespace
+
+BridgeSpool::~BridgeSpool() { close(); }
+
+bool BridgeSpool::open(const std::string &path, uint64_t capacityBytes,
+                       std::string &error) {
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    error = "open " + path + ": " + strerror(errno);
+    return false;
+  }
+  capacityBytes_ = capacityBytes;
+
+  struct stat st = {};
+  fstat(fd_, &st);
+  Header header = {};
+  if (st.st_size >= static_cast<off_t>(sizeof(Header)) &&
+      readAt(fd_, 0, &header, sizeof(header)) && header.magic == kMagic &&
+      header.version == kVersion && header.tail >= sizeof(Header) &&
+      header.tail <= header.head &&
+      header.head <= static_cast<uint64_t>(st.st_size)) {
+    // Valid existing spool: resume from the persisted cursors. Records
+    // appended after the last sync are beyond the persisted head and
+    // are dropped, same as a torn WAL tail.
+    head_ = header.head;
+    tail_ = header.tail;
+    appended_ = header.appended;
+    drained_ = header.drained;
+    return true;
+  }
+
+  // Fresh file (or one too damaged to trust): start empty
+  head_ = sizeof(Header);
+  tail_ = sizeof(Header);
+  appended_ = 0;
+  drained_ = 0;
+  if (ftruncate(fd_, sizeof(Header)) != 0 || !persistHeader() ||
+      fdatasync(fd_) != 0) {
+    error = "initialize " + path + ": " + strerror(errno);
+    close();
+    return false;
+  }
+  return true;
+}
+
+void BridgeSpool::close() {
+  if (fd_ >= 0) {
+    sync(true);
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool BridgeSpool::persistHeader() {
+  Header header = {};
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.head = head_;
+  header.tail = tail_;
+  header.appended = appended_;
+  header.drained = drained_;
+  return writeAt(fd_, 0, &header, sizeof(header));
+}
+
+bool BridgeSpool::append(const std::string &topic, const uint8_t *payload,
+                         size_t length) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return false;
+  }
+  const uint64_t recordBytes = sizeof(RecordHeader) + topic.size() + length;
+  if (head_ - tail_ + recordBytes > capacityBytes_) {
+    dropped_++;
+    return false;
+  }
+
+  RecordHeader record = {};
+  record.topicLength = static_cast<uint32_t>(topic.size());
+  record.payloadLength = static_cast<uint32_t>(length);
+  if (!writeAt(fd_, head_, &record, sizeof(record)) ||
+      !writeAt(fd_, head_ + sizeof(record), topic.data(), topic.size()) ||
+      !writeAt(fd_, head_ + sizeof(record) + topic.size(), payload, length)) {
+    dropped_++;
+    return false;
+  }
+  head_ += recordBytes;
+  appended_++;
+  if (++sinceSync_ >= kGroupSyncRecords) {
+    persistHeader();
+    fdatasync(fd_);
+    sinceSync_ = 0;
+  }
+  return true;
+}
+
+bool BridgeSpool::peek(std::string &topic, std::string &payload) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ < 0 || tail_ >= head_) {
+    return false;
+  }
+  RecordHeader record = {};
+  if (!readAt(fd_, tail_, &record, sizeof(record))) {
+    return false;
+  }
+  std::vector<char> data(record.topicLength + record.payloadLength);
+  if (!data.empty() &&
+      !readAt(fd_, tail_ + sizeof(record), data.data(), data.size())) {
+    return false;
+  }
+  topic.assign(data.data(), record.topicLength);
+  payload.assign(data.data() + record.topicLength, record.payloadLength);
+  peekedBytes_ = sizeof(record) + record.topicLength + record.payloadLength;
+  return true;
+}
+
+void BridgeSpool::advance() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (peekedBytes_ == 0) {
+    return;
+  }
+  tail_ += peekedBytes_;
+  peekedBytes_ = 0;
+  drained_++;
+  sinceSync_++;  // cursor movement counts as a change for the group sync
+  if (tail_ >= head_) {
+    // Fully drained: reclaim the file instead of growing forever
+    head_ = sizeof(Header);
+    tail_ = sizeof(Header);
+    persistHeader();
+    ftruncate(fd_, sizeof(Header));
+  }
+}
+
+void BridgeSpool::sync(bool force) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ < 0 || (!force && sinceSync_ == 0)) {
+    return;
+  }
+  persistHeader();
+  fdatasync(fd_);
+  sinceSync_ = 0;
+}
+
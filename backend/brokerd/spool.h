@@ -0,0 +1,92 @@
+#ifndef BROKERD_SPOOL_H
+#define BROKERD_SPOOL_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Disk spool between the local broker and the upstream bridge. Every
+// bridged PUBLISH is appended here before the broker acknowledges it,
+// and the bridge thread consumes from the read cursor at whatever pace
+// the WAN sustains — a dead uplink backs up into this file instead of
+// into local fan-out latency, and the backlog replays in order on
+// recovery.
+//
+// Records are length-prefixed (topic, payload) pairs appended at the
+// head offset; head, tail and the record counters live in a fixed
+// header at the front of the file. Same lazy durability model as the
+// ingestd WAL: appends are buffered writes, and the header plus data
+// are fdatasync'd in groups — every kGroupSyncRecords appends or on
+// the caller's 1s tick. A crash can lose the records since the last
+// sync and replay a few already-sent ones; telemetry upstream is
+// append-only, so a duplicate is harmless where a lost sample is not.
+//
+// append() runs on the broker's event loop thread, peek()/advance() on
+// the bridge thread; a mutex covers the shared cursors (file I/O per
+// record is microseconds against a multi-second WAN stall).
+class BridgeSpool {
+public:
+  static constexpr uint32_t kGroupSyncRecords = 64;
+
+  ~BridgeSpool();
+
+  // Open (creating if needed) the spool file. An existing file
+  // recovers its cursors and the un-drained tail is replayed once the
+  // bridge starts reading. capacityBytes caps the backlog on disk.
+  bool open(const std::string &path, uint64_t capacityBytes,
+            std::string &error);
+
+  // Append one record. Returns false when the spool is full (the WAN
+  // has been down longer than the file can absorb); the caller counts
+  // the drop, same contract as the writer queues.
+  bool append(const std::string &topic, const uint8_t *payload,
+              size_t length);
+
+  // Copy out the record at the read cursor without consuming it;
+  // false when the spool is empty.
+  bool peek(std::string &topic, std::string &payload);
+
+  // Consume the record last returned by peek(). When the spool runs
+  // empty the file is truncated back to its header, so the on-disk
+  // footprint tracks the backlog rather than the all-time high.
+  void advance();
+
+  // Group durability point: flush and persist the cursors when
+  // anything is outstanding. Called from the 1s tick; append() also
+  // syncs every kGroupSyncRecords.
+  void sync(bool force);
+
+  void close();
+
+  uint64_t appended() const { return appended_; }
+  uint64_t drained() const { return drained_; }
+  uint64_t dropped() const { return dropped_; }
+  uint64_t backlogRecords() const { return appended_ - drained_; }
+  uint64_t backlogBytes() const { return head_ - tail_; }
+
+private:
+  struct Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t pad;
+    uint64_t head;      // byte offset of the next append
+    uint64_t tail;      // byte offset of the next record to bridge
+    uint64_t appended;  // record counters, for the stats line
+    uint64_t drained;
+  };
+
+  bool persistHeader();
+
+  int fd_ = -1;
+  uint64_t capacityBytes_ = 0;
+  uint64_t head_ = 0;
+  uint64_t tail_ = 0;
+  uint64_t appended_ = 0;
+  uint64_t drained_ = 0;
+  uint64_t dropped_ = 0;
+  uint32_t sinceSync_ = 0;
+  uint32_t peekedBytes_ = 0;  // size of the record peek() last returned
+  std::mutex mutex_;
+};
+
+#endif // BROKERD_SPOOL_H
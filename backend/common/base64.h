@@ -0,0 +1,91 @@
+#ifndef BACKEND_COMMON_BASE64_H
+#define BACKEND_COMMON_BASE64_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Standard-alphabet base64 decode, tolerant of '=' padding, embedded
+// newlines and of the "data:image/jpeg;base64," prefix the camera
+// clients sometimes send. Returns false on any other non-alphabet byte.
+inline bool base64Decode(const char *input, size_t length,
+                         std::vector<uint8_t> &out) {
+  if (length > 5 && memcmp(input, "data:", 5) == 0) {
+    const void *comma = memchr(input, ',', length);
+    if (comma != nullptr) {
+      const size_t skip = static_cast<const char *>(comma) - input + 1;
+      input += skip;
+      length -= skip;
+    }
+  }
+
+  static int8_t table[256];
+  static bool tableReady = false;
+  if (!tableReady) {
+    memset(table, -1, sizeof(table));
+    const char *alphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (int i = 0; i < 64; i++) {
+      table[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+    }
+    tableReady = true;
+  }
+
+  out.clear();
+  out.reserve((length / 4) * 3);
+  uint32_t accumulator = 0;
+  int bits = 0;
+  for (size_t i = 0; i < length; i++) {
+    const char c = input[i];
+    if (c == '=' || c == '\n' || c == '\r') {
+      continue;
+    }
+    const int8_t value = table[static_cast<uint8_t>(c)];
+    if (value < 0) {
+      return false;
+    }
+    accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xFF));
+    }
+  }
+  return true;
+}
+
+// Standard-alphabet base64 encode, no line wrapping. Small inputs only
+// (handshake tokens), so a returned string is fine here.
+inline std::string base64Encode(const uint8_t *input, size_t length) {
+  static const char *alphabet =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  out.reserve(((length + 2) / 3) * 4);
+  size_t i = 0;
+  for (; i + 3 <= length; i += 3) {
+    const uint32_t v = (static_cast<uint32_t>(input[i]) << 16) |
+                       (static_cast<uint32_t>(input[i + 1]) << 8) |
+                       input[i + 2];
+    out += alphabet[(v >> 18) & 63];
+    out += alphabet[(v >> 12) & 63];
+    out += alphabet[(v >> 6) & 63];
+    out += alphabet[v & 63];
+  }
+  if (i + 1 == length) {
+    const uint32_t v = static_cast<uint32_t>(input[i]) << 16;
+    out += alphabet[(v >> 18) & 63];
+    out += alphabet[(v >> 12) & 63];
+    out += "==";
+  } else if (i + 2 == length) {
+    const uint32_t v = (static_cast<uint32_t>(input[i]) << 16) |
+                       (static_cast<uint32_t>(input[i + 1]) << 8);
+    out += alphabet[(v >> 18) & 63];
+    out += alphabet[(v >> 12) & 63];
+    out += alphabet[(v >> 6) & 63];
+    out += '=';
+  }
+  return out;
+}
+
+#endif // BACKEND_COMMON_BASE64_H
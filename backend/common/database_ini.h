@@ -0,0 +1,51 @@
+#ifndef BACKEND_COMMON_DATABASE_INI_H
+#define BACKEND_COMMON_DATABASE_INI_H
+
+#include <fstream>
+#include <string>
+
+// Reads the [postgresql] section of back/database.ini (the same file
+// back/config.py uses) into a libpq conninfo string, so every native
+// tool points at the database the Python side is configured for.
+inline bool conninfoFromIni(const std::string &path, std::string &conninfo,
+                            std::string &error) {
+  std::ifstream file(path);
+  if (!file) {
+    error = "cannot open " + path;
+    return false;
+  }
+  std::string line;
+  bool inSection = false;
+  conninfo.clear();
+  while (std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line[0] == '#' || line[0] == ';') {
+      continue;
+    }
+    if (line[0] == '[') {
+      inSection = (line == "[postgresql]");
+      continue;
+    }
+    if (!inSection) {
+      continue;
+    }
+    const size_t eq = line.find('=');
+    if (eq == std::string::npos) {
+      continue;
+    }
+    const std::string key = line.substr(0, eq);
+    const std::string value = line.substr(eq + 1);
+    // libpq uses dbname, the ini uses database
+    conninfo += (key == "database" ? "dbname" : key);
+    conninfo += "='" + value + "' ";
+  }
+  if (conninfo.empty()) {
+    error = "no [postgresql] section in " + path;
+    return false;
+  }
+  return true;
+}
+
+#endif  // BACKEND_COMMON_DATABASE_INI_H
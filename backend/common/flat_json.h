@@ -0,0 +1,68 @@
+#ifndef BACKEND_COMMON_FLAT_JSON_H
+#define BACKEND_COMMON_FLAT_JSON_H
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+// Minimal extractor for the flat telemetry objects the firmware emits:
+// finds "key": <number> without a JSON library. The payloads are
+// machine-generated by ArduinoJson (no whitespace games, no nesting on
+// the telemetry topics), so a full parser buys nothing on this path.
+inline bool flatJsonNumber(const char *json, size_t length, const char *key,
+                           double &out) {
+  const size_t keyLength = strlen(key);
+  const char *cursor = json;
+  const char *end = json + length;
+  while ((cursor = static_cast<const char *>(
+              memmem(cursor, end - cursor, key, keyLength))) != nullptr) {
+    const char *after = cursor + keyLength;
+    if (cursor > json && cursor[-1] == '"' && after < end && *after == '"') {
+      after++;
+      while (after < end && (*after == ':' || isspace(*after))) {
+        after++;
+      }
+      if (after < end && (isdigit(*after) || *after == '-' || *after == '.')) {
+        out = strtod(after, nullptr);
+        return true;
+      }
+    }
+    cursor += keyLength;
+  }
+  return false;
+}
+
+// Same idea for "key": "string" fields. Returns the span between the
+// value's quotes; escapes are not unescaped (the telemetry and camera
+// payloads never contain them in these fields).
+inline bool flatJsonString(const char *json, size_t length, const char *key,
+                           const char *&valueStart, size_t &valueLength) {
+  const size_t keyLength = strlen(key);
+  const char *cursor = json;
+  const char *end = json + length;
+  while ((cursor = static_cast<const char *>(
+              memmem(cursor, end - cursor, key, keyLength))) != nullptr) {
+    const char *after = cursor + keyLength;
+    if (cursor > json && cursor[-1] == '"' && after < end && *after == '"') {
+      after++;
+      while (after < end && (*after == ':' || isspace(*after))) {
+        after++;
+      }
+      if (after < end && *after == '"') {
+        after++;
+        const char *close = static_cast<const char *>(
+            memchr(after, '"', end - after));
+        if (close == nullptr) {
+          return false;
+        }
+        valueStart = after;
+        valueLength = static_cast<size_t>(close - after);
+        return true;
+      }
+    }
+    cursor += keyLength;
+  }
+  return false;
+}
+
+#endif // BACKEND_COMMON_FLAT_JSON_H
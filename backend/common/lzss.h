@@ -0,0 +1,61 @@
+#ifndef BACKEND_COMMON_LZSS_H
+#define BACKEND_COMMON_LZSS_H
+
+#include <cstdint>
+#include <vector>
+
+// Decoder for the firmware's compressed MQTT payloads. Mirror of
+// platformio/src/payload_codec.h and must be kept in sync with it:
+// a 2-byte little-endian original length, then flag-byte groups where
+// each flag byte covers the next 8 items LSB-first — a 1 bit is one
+// literal byte, a 0 bit is a 2-byte match token
+//   b0 = distance & 0xFF
+//   b1 = (distance >> 8) & 0x0F | (length - 3) << 4
+// with distance 1..4095 back and length 3..18. Compressed payloads
+// arrive on the plain topic plus a "/lz" suffix.
+inline bool lzssDecompress(const uint8_t *src, size_t length,
+                           std::vector<uint8_t> &out) {
+  if (length < 2) {
+    return false;
+  }
+  const size_t originalSize = src[0] | (static_cast<size_t>(src[1]) << 8);
+  out.clear();
+  out.reserve(originalSize);
+
+  size_t in = 2;
+  uint8_t flags = 0;
+  uint8_t flagBit = 0;
+  while (out.size() < originalSize) {
+    if (flagBit == 0) {
+      if (in >= length) {
+        return false;
+      }
+      flags = src[in++];
+      flagBit = 1;
+    }
+    if (flags & flagBit) {
+      if (in >= length) {
+        return false;
+      }
+      out.push_back(src[in++]);
+    } else {
+      if (in + 2 > length) {
+        return false;
+      }
+      const size_t distance = src[in] | (static_cast<size_t>(src[in + 1] & 0x0F) << 8);
+      const size_t matchLength = (src[in + 1] >> 4) + 3;
+      in += 2;
+      if (distance == 0 || distance > out.size()) {
+        return false;  // corrupt token referencing before the output start
+      }
+      for (size_t i = 0; i < matchLength && out.size() < originalSize; i++) {
+        // byte-at-a-time on purpose: matches may overlap their own output
+        out.push_back(out[out.size() - distance]);
+      }
+    }
+    flagBit <<= 1;
+  }
+  return out.size() == originalSize;
+}
+
+#endif // BACKEND_COMMON_LZSS_H
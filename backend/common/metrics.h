@@ -0,0 +1,196 @@
+#ifndef BACKEND_COMMON_METRICS_H
+#define BACKEND_COMMON_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Shared metrics for the native daemons, Prometheus text exposition.
+// Until now the only window into the backend's behaviour was the
+// printf stats lines scrolling past in back/server.log; this registry
+// gives each daemon named counters, gauges and histograms that a
+// scraper reads on demand.
+//
+// Hot-path cost is one relaxed fetch_add per increment (a histogram
+// adds a short linear scan of its bounds), so instrumentation stays on
+// in production. Registration happens at startup, before the hot
+// threads exist; entries live in deques so the returned pointers stay
+// stable, and render() only reads atomics — no lock is ever taken on
+// an ingest or inference path.
+//
+// Histograms are integer-valued: callers pick the unit (microseconds,
+// frames per batch) and observe whole numbers, which keeps the sum a
+// plain fetch_add instead of a CAS loop on a double.
+class MetricsRegistry {
+public:
+  struct Counter {
+    std::atomic<uint64_t> value{0};
+    void inc(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+  };
+
+  struct Gauge {
+    std::atomic<int64_t> value{0};
+    void set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value.fetch_add(n, std::memory_order_relaxed); }
+  };
+
+  struct Histogram {
+    static const int kMaxBounds = 16;
+    int64_t bounds[kMaxBounds];
+    int boundCount = 0;
+    std::atomic<uint64_t> buckets[kMaxBounds + 1];  // +1 = +Inf
+    std::atomic<uint64_t> sum{0};
+
+    Histogram() {
+      for (int i = 0; i <= kMaxBounds; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+      }
+    }
+
+    void observe(int64_t v) {
+      int i = 0;
+      while (i < boundCount && v > bounds[i]) {
+        i++;
+      }
+      buckets[i].fetch_add(1, std::memory_order_relaxed);
+      sum.fetch_add(static_cast<uint64_t>(v), std::memory_order_relaxed);
+    }
+  };
+
+  Counter *counter(const std::string &name, const std::string &help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_.emplace_back(name, help);
+    return &counters_.back().metric;
+  }
+
+  Gauge *gauge(const std::string &name, const std::string &help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gauges_.emplace_back(name, help);
+    return &gauges_.back().metric;
+  }
+
+  Histogram *histogram(const std::string &name, const std::string &help,
+                       const std::vector<int64_t> &bounds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    histograms_.emplace_back(name, help);
+    Histogram &h = histograms_.back().metric;
+    h.boundCount = static_cast<int>(bounds.size());
+    if (h.boundCount > Histogram::kMaxBounds) {
+      h.boundCount = Histogram::kMaxBounds;
+    }
+    for (int i = 0; i < h.boundCount; i++) {
+      h.bounds[i] = bounds[i];
+    }
+    return &h;
+  }
+
+  // Prometheus text format (0.0.4). Relaxed reads: a scrape racing an
+  // increment sees a value that was true a moment ago, which is all a
+  // sampled time series promises anyway.
+  std::string render() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    char line[160];
+    for (const auto &entry : counters_) {
+      out += "# HELP " + entry.name + " " + entry.help + "\n";
+      out += "# TYPE " + entry.name + " counter\n";
+      snprintf(line, sizeof(line), "%s %llu\n", entry.name.c_str(),
+               (unsigned long long)entry.metric.value.load(
+                   std::memory_order_relaxed));
+      out += line;
+    }
+    for (const auto &entry : gauges_) {
+      out += "# HELP " + entry.name + " " + entry.help + "\n";
+      out += "# TYPE " + entry.name + " gauge\n";
+      snprintf(line, sizeof(line), "%s %lld\n", entry.name.c_str(),
+               (long long)entry.metric.value.load(std::memory_order_relaxed));
+      out += line;
+    }
+    for (const auto &entry : histograms_) {
+      const Histogram &h = entry.metric;
+      out += "# HELP " + entry.name + " " + entry.help + "\n";
+      out += "# TYPE " + entry.name + " histogram\n";
+      uint64_t cumulative = 0;
+      for (int i = 0; i < h.boundCount; i++) {
+        cumulative += h.buckets[i].load(std::memory_order_relaxed);
+        snprintf(line, sizeof(line), "%s_bucket{le=\"%lld\"} %llu\n",
+                 entry.name.c_str(), (long long)h.bounds[i],
+                 (unsigned long long)cumulative);
+        out += line;
+      }
+      cumulative += h.buckets[h.boundCount].load(std::memory_order_relaxed);
+      snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n",
+               entry.name.c_str(), (unsigned long long)cumulative);
+      out += line;
+      snprintf(line, sizeof(line), "%s_sum %llu\n%s_count %llu\n",
+               entry.name.c_str(),
+               (unsigned long long)h.sum.load(std::memory_order_relaxed),
+               entry.name.c_str(), (unsigned long long)cumulative);
+      out += line;
+    }
+    return out;
+  }
+
+private:
+  template <typename T> struct Entry {
+    std::string name;
+    std::string help;
+    T metric;
+    Entry(std::string n, std::string h)
+        : name(std::move(n)), help(std::move(h)) {}
+  };
+
+  mutable std::mutex mutex_;  // registration and render only
+  std::deque<Entry<Counter>> counters_;
+  std::deque<Entry<Gauge>> gauges_;
+  std::deque<Entry<Histogram>> histograms_;
+};
+
+// Scrape listener for daemons without an HTTP server of their own:
+// open with metricsListen, add the fd to the epoll loop, call
+// metricsHandle on readiness. One short-lived connection per scrape.
+inline int metricsListen(uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(port);
+  if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, 4) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+inline void metricsHandle(int listenFd, const MetricsRegistry &registry) {
+  const int client = accept(listenFd, nullptr, nullptr);
+  if (client < 0) {
+    return;
+  }
+  // Drain whatever request line arrived; any GET gets the full page
+  char request[512];
+  (void)!recv(client, request, sizeof(request), 0);
+  const std::string body = registry.render();
+  char head[128];
+  const int headLength = snprintf(
+      head, sizeof(head),
+      "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+      "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+      body.size());
+  (void)!write(client, head, headLength);
+  (void)!write(client, body.data(), body.size());
+  close(client);
+}
+
+#endif  // BACKEND_COMMON_METRICS_H
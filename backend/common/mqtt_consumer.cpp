@@ -0,0 +1,318 @@
+#include "mqtt_consumer.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// MQTT control packet types (high nibble of the fixed header)
+constexpr uint8_t kConnect = 0x10;
+constexpr uint8_t kConnack = 0x20;
+constexpr uint8_t kPublish = 0x30;
+constexpr uint8_t kSubscribe = 0x82;  // type 8, reserved flags 0b0010
+constexpr uint8_t kSuback = 0x90;
+constexpr uint8_t kPingreq = 0xC0;
+constexpr uint8_t kPingresp = 0xD0;
+
+void appendU16(std::vector<uint8_t> &out, uint16_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value & 0xFF));
+}
+
+void appendString(std::vector<uint8_t> &out, const std::string &value) {
+  appendU16(out, static_cast<uint16_t>(value.size()));
+  out.insert(out.end(), value.begin(), value.end());
+}
+
+// MQTT remaining-length varint, max 4 bytes
+void appendVarint(std::vector<uint8_t> &out, size_t value) {
+  do {
+    uint8_t digit = value % 128;
+    value /= 128;
+    if (value > 0) {
+      digit |= 0x80;
+    }
+    out.push_back(digit);
+  } while (value > 0);
+}
+
+// Returns bytes consumed by the varint, 0 if incomplete, -1 if malformed
+int parseVarint(const uint8_t *data, size_t available, size_t &value) {
+  value = 0;
+  size_t multiplier = 1;
+  for (int i = 0; i < 4; i++) {
+    if (static_cast<size_t>(i) >= available) {
+      return 0;
+    }
+    value += (data[i] & 0x7F) * multiplier;
+    if ((data[i] & 0x80) == 0) {
+      return i + 1;
+    }
+    multiplier *= 128;
+  }
+  return -1;
+}
+
+}  // namespace
+
+MqttConsumer::~MqttConsumer() { close(); }
+
+void MqttConsumer::close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  rxBuffer_.clear();
+}
+
+bool MqttConsumer::sendAll(const uint8_t *data, size_t length) {
+  size_t sent = 0;
+  while (sent < length) {
+    ssize_t n = ::send(fd_, data + sent, length - sent, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+        continue;  // control packets are tiny, a short spin is fine
+      }
+      return false;
+    }
+    sent += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool MqttConsumer::readExact(uint8_t *out, size_t length) {
+  size_t got = 0;
+  while (got < length) {
+    ssize_t n = ::recv(fd_, out + got, length - got, 0);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    got += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool MqttConsumer::connect(const std::string &host, uint16_t port,
+                           const std::string &clientId, const std::string &user,
+                           const std::string &password, std::string &error) {
+  close();
+
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo *result = nullptr;
+  const std::string portStr = std::to_string(port);
+  int rc = getaddrinfo(host.c_str(), portStr.c_str(), &hints, &result);
+  if (rc != 0) {
+    error = "resolve " + host + ": " + gai_strerror(rc);
+    return false;
+  }
+  for (struct addrinfo *ai = result; ai != nullptr; ai = ai->ai_next) {
+    fd_ = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd_ < 0) {
+      continue;
+    }
+    if (::connect(fd_, ai->ai_addr, ai->ai_addrlen) == 0) {
+      break;
+    }
+    ::close(fd_);
+    fd_ = -1;
+  }
+  freeaddrinfo(result);
+  if (fd_ < 0) {
+    error = "connect " + host + ":" + portStr + ": " + strerror(errno);
+    return false;
+  }
+
+  int one = 1;
+  setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  // Variable header + payload of the CONNECT packet
+  std::vector<uint8_t> body;
+  appendString(body, "MQTT");
+  body.push_back(4);  // protocol level 3.1.1
+  uint8_t connectFlags = 0x02;  // clean session
+  if (!user.empty()) {
+    connectFlags |= 0x80;
+    if (!password.empty()) {
+      connectFlags |= 0x40;
+    }
+  }
+  body.push_back(connectFlags);
+  appendU16(body, kKeepaliveSeconds);
+  appendString(body, clientId);
+  if (!user.empty()) {
+    appendString(body, user);
+    if (!password.empty()) {
+      appendString(body, password);
+    }
+  }
+
+  std::vector<uint8_t> packet;
+  packet.push_back(kConnect);
+  appendVarint(packet, body.size());
+  packet.insert(packet.end(), body.begin(), body.end());
+  if (!sendAll(packet.data(), packet.size())) {
+    error = "send CONNECT: " + std::string(strerror(errno));
+    close();
+    return false;
+  }
+
+  // CONNACK is always 4 bytes; read it synchronously before going
+  // non-blocking so a refused connection fails loudly at startup
+  uint8_t connack[4];
+  if (!readExact(connack, sizeof(connack)) || connack[0] != kConnack) {
+    error = "broker did not answer with CONNACK";
+    close();
+    return false;
+  }
+  if (connack[3] != 0) {
+    error = "broker refused connection, code " + std::to_string(connack[3]);
+    close();
+    return false;
+  }
+
+  int flags = fcntl(fd_, F_GETFL, 0);
+  fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+  lastPingMs_ = 0;
+  return true;
+}
+
+bool MqttConsumer::subscribe(const std::vector<std::string> &topics,
+                             std::string &error, uint8_t qos) {
+  std::vector<uint8_t> body;
+  appendU16(body, nextPacketId_++);
+  for (const std::string &topic : topics) {
+    appendString(body, topic);
+    // QoS 0 (at-most-once) is right for plain 1Hz telemetry; a caller
+    // that persists messages before acking asks for 1
+    body.push_back(qos > 1 ? 1 : qos);
+  }
+  std::vector<uint8_t> packet;
+  packet.push_back(kSubscribe);
+  appendVarint(packet, body.size());
+  packet.insert(packet.end(), body.begin(), body.end());
+  if (!sendAll(packet.data(), packet.size())) {
+    error = "send SUBSCRIBE: " + std::string(strerror(errno));
+    return false;
+  }
+  // SUBACK arrives on the normal read path and is ignored there
+  return true;
+}
+
+bool MqttConsumer::publish(const std::string &topic,
+                           const std::string &payload) {
+  if (fd_ < 0) {
+    return false;
+  }
+  std::vector<uint8_t> body;
+  appendString(body, topic);  // QoS 0: no packet id
+  body.insert(body.end(), payload.begin(), payload.end());
+  std::vector<uint8_t> packet;
+  packet.push_back(kPublish);
+  appendVarint(packet, body.size());
+  packet.insert(packet.end(), body.begin(), body.end());
+  return sendAll(packet.data(), packet.size());
+}
+
+bool MqttConsumer::onReadable() {
+  uint8_t chunk[16 * 1024];
+  while (true) {
+    ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+    if (n > 0) {
+      rxBuffer_.insert(rxBuffer_.end(), chunk, chunk + n);
+      continue;
+    }
+    if (n == 0) {
+      return false;  // broker closed
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;  // drained
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    return false;
+  }
+
+  // Dispatch every complete packet in the buffer, keep the remainder
+  size_t offset = 0;
+  while (rxBuffer_.size() - offset >= 2) {
+    size_t remainingLength = 0;
+    int varintBytes = parseVarint(rxBuffer_.data() + offset + 1,
+                                  rxBuffer_.size() - offset - 1,
+                                  remainingLength);
+    if (varintBytes < 0) {
+      return false;  // corrupt stream, force reconnect
+    }
+    const size_t packetSize = 1 + varintBytes + remainingLength;
+    if (varintBytes == 0 || rxBuffer_.size() - offset < packetSize) {
+      break;  // incomplete, wait for more bytes
+    }
+    handlePacket(rxBuffer_[offset],
+                 rxBuffer_.data() + offset + 1 + varintBytes, remainingLength);
+    offset += packetSize;
+  }
+  rxBuffer_.erase(rxBuffer_.begin(), rxBuffer_.begin() + offset);
+  return true;
+}
+
+void MqttConsumer::handlePacket(uint8_t header, const uint8_t *body,
+                                size_t length) {
+  const uint8_t type = header & 0xF0;
+  if (type != kPublish) {
+    return;  // CONNACK/SUBACK/PINGRESP need no action here
+  }
+  if (length < 2) {
+    return;
+  }
+  const size_t topicLength = (static_cast<size_t>(body[0]) << 8) | body[1];
+  size_t offset = 2 + topicLength;
+  if (offset > length) {
+    return;
+  }
+  const std::string topic(reinterpret_cast<const char *>(body + 2), topicLength);
+  const uint8_t qos = (header >> 1) & 0x03;
+  uint16_t packetId = 0;
+  if (qos > 0) {
+    if (offset + 2 > length) {
+      return;
+    }
+    packetId = static_cast<uint16_t>((body[offset] << 8) | body[offset + 1]);
+    offset += 2;
+  }
+  messagesReceived_++;
+  if (handler_) {
+    handler_(topic, body + offset, length - offset);
+  }
+  if (qos == 1) {
+    // Acknowledge only after the handler has had the message, so a
+    // consumer that persists before returning never loses an acked
+    // PUBLISH (QoS 2 is not offered on our subscribes)
+    const uint8_t puback[4] = {0x40, 2, static_cast<uint8_t>(packetId >> 8),
+                               static_cast<uint8_t>(packetId & 0xFF)};
+    sendAll(puback, sizeof(puback));
+  }
+}
+
+bool MqttConsumer::tick(int64_t nowMs) {
+  if (lastPingMs_ == 0) {
+    lastPingMs_ = nowMs;
+    return true;
+  }
+  if (nowMs - lastPingMs_ < (kKeepaliveSeconds * 1000) / 2) {
+    return true;
+  }
+  lastPingMs_ = nowMs;
+  const uint8_t ping[2] = {kPingreq, 0};
+  return sendAll(ping, sizeof(ping));
+}
@@ -0,0 +1,74 @@
+#ifndef INGESTD_MQTT_CONSUMER_H
+#define INGESTD_MQTT_CONSUMER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal MQTT 3.1.1 consumer on a non-blocking socket, built to hang
+// off an epoll loop: the owner waits for readability and calls
+// onReadable(), which drains the socket and dispatches complete PUBLISH
+// packets to the message handler. Only what an ingestion daemon needs
+// is implemented — CONNECT/CONNACK, SUBSCRIBE/SUBACK at QoS 0,
+// inbound PUBLISH, PINGREQ/PINGRESP — which keeps the dependency
+// footprint at zero and the parse path allocation-free per packet.
+class MqttConsumer {
+public:
+  using MessageHandler = std::function<void(
+      const std::string &topic, const uint8_t *payload, size_t length)>;
+
+  ~MqttConsumer();
+
+  // Blocking TCP connect + MQTT CONNECT handshake, then switches the
+  // socket to non-blocking for the epoll loop. Empty user skips auth.
+  bool connect(const std::string &host, uint16_t port,
+               const std::string &clientId, const std::string &user,
+               const std::string &password, std::string &error);
+
+  // qos 1 asks the broker for at-least-once delivery; the PUBACK for
+  // each inbound PUBLISH is sent after the message handler returns, so
+  // a handler that persists the message makes the hand-off crash-safe
+  // (a consumer that dies mid-handler gets the message redelivered).
+  // Filters go to the broker verbatim, so $share/<group>/<filter>
+  // shared subscriptions work against any broker that honours the
+  // convention (brokerd does); deliveries arrive on the plain topic.
+  bool subscribe(const std::vector<std::string> &topics, std::string &error,
+                 uint8_t qos = 0);
+
+  // Fire-and-forget QoS 0 PUBLISH on the same connection (used for
+  // alerts). Returns false when disconnected or the send fails.
+  bool publish(const std::string &topic, const std::string &payload);
+
+  void setMessageHandler(MessageHandler handler) { handler_ = std::move(handler); }
+
+  int fd() const { return fd_; }
+
+  // Drain everything currently readable; returns false when the broker
+  // closed the connection or the stream is corrupt (caller reconnects).
+  bool onReadable();
+
+  // Call periodically; sends PINGREQ when the keepalive window is half
+  // spent. Returns false on send failure.
+  bool tick(int64_t nowMs);
+
+  uint64_t messagesReceived() const { return messagesReceived_; }
+
+  void close();
+
+private:
+  bool sendAll(const uint8_t *data, size_t length);
+  bool readExact(uint8_t *out, size_t length);  // blocking, handshake only
+  void handlePacket(uint8_t header, const uint8_t *body, size_t length);
+
+  int fd_ = -1;
+  MessageHandler handler_;
+  std::vector<uint8_t> rxBuffer_;
+  int64_t lastPingMs_ = 0;
+  uint16_t nextPacketId_ = 1;
+  uint64_t messagesReceived_ = 0;
+
+  static constexpr int kKeepaliveSeconds = 60;
+};
+
+#endif // INGESTD_MQTT_CONSUMER_H
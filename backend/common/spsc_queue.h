@@ -0,0 +1,59 @@
+#ifndef BACKEND_COMMON_SPSC_QUEUE_H
+#define BACKEND_COMMON_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free single-producer single-consumer ring. The MQTT reader (the
+// epoll thread) is the only producer and a single writer thread the
+// only consumer, so acquire/release on the two indices is all the
+// synchronization needed — no mutex on the hot path.
+template <typename T, size_t CapacityPow2>
+class SpscQueue {
+  static_assert((CapacityPow2 & (CapacityPow2 - 1)) == 0,
+                "capacity must be a power of two");
+
+public:
+  // Producer side. Returns false (and counts the drop) when full:
+  // backpressure means the database is behind, and dropping the oldest
+  // style recovery is worse than dropping the newest for telemetry.
+  bool tryPush(const T &item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail >= CapacityPow2) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    slots_[head & (CapacityPow2 - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool tryPop(T &out) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    if (tail == head) {
+      return false;
+    }
+    out = slots_[tail & (CapacityPow2 - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_acquire);
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  T slots_[CapacityPow2];
+  // Separate cache lines so producer and consumer do not false-share
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+#endif // BACKEND_COMMON_SPSC_QUEUE_H
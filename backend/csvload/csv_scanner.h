@@ -0,0 +1,108 @@
+#ifndef CSVLOAD_CSV_SCANNER_H
+#define CSVLOAD_CSV_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// SWAR (SIMD-within-a-register) scanner for the back/*.csv history
+// files. The hot loop loads eight bytes at a time and finds every
+// delimiter in the word with two broadcast compares — no per-byte
+// branch, no per-byte loop. The files are plain unquoted CSV (numeric
+// fields, DD/MM/YYYY dates), so there is no quote state to track,
+// which is what makes the branchless scan valid.
+
+inline uint64_t csvBroadcast(uint8_t byte) {
+  return 0x0101010101010101ull * byte;
+}
+
+// Bytes of word equal to the broadcast needle come back as 0x80 in
+// that byte lane, all other lanes zero. Note the (x | high) - 1 form
+// rather than the shorter x - 1: the subtraction stays lane-local, so
+// a match in one lane cannot borrow into its neighbour and fake a
+// match there (with x - 1, a ',' directly before a '-' — which is
+// ','^0x01 — would register as a delimiter depending on word phase).
+inline uint64_t csvMatchBytes(uint64_t word, uint64_t needle) {
+  const uint64_t high = 0x8080808080808080ull;
+  const uint64_t x = word ^ needle;
+  return ~(x | ((x | high) - 0x0101010101010101ull)) & high;
+}
+
+// First byte offset after the next '\n' at or past offset (file end if
+// none) — used to align worker chunk boundaries to whole lines
+inline size_t csvAlignToNextLine(const char *data, size_t size, size_t offset) {
+  while (offset < size && data[offset] != '\n') {
+    offset++;
+  }
+  return offset < size ? offset + 1 : size;
+}
+
+// Convert a line-aligned chunk of CSV into Postgres COPY text format:
+// ',' becomes '\t', empty fields become \N, a trailing CR is stripped.
+// Appends to out and returns the number of rows converted. Delimiter
+// discovery is branchless per byte; only the per-field copy branches.
+inline uint64_t csvConvertChunk(const char *begin, const char *end,
+                                std::string &out) {
+  out.reserve(out.size() + static_cast<size_t>(end - begin));
+  const uint64_t commas = csvBroadcast(',');
+  const uint64_t newlines = csvBroadcast('\n');
+
+  uint64_t rows = 0;
+  const char *fieldStart = begin;
+  const char *p = begin;
+  while (p < end) {
+    const size_t step =
+        static_cast<size_t>(end - p) < 8 ? static_cast<size_t>(end - p) : 8;
+    uint64_t word = 0;
+    memcpy(&word, p, step);  // zero padding matches neither delimiter
+    uint64_t mask = csvMatchBytes(word, commas) | csvMatchBytes(word, newlines);
+    while (mask != 0) {
+      const char *delim = p + (__builtin_ctzll(mask) >> 3);
+      size_t length = static_cast<size_t>(delim - fieldStart);
+      if (length > 0 && delim[-1] == '\r') {
+        length--;  // CRLF line endings
+      }
+      if (length == 0) {
+        out += "\\N";
+      } else {
+        out.append(fieldStart, length);
+      }
+      out += (*delim == ',') ? '\t' : '\n';
+      rows += (*delim == '\n') ? 1 : 0;
+      fieldStart = delim + 1;
+      mask &= mask - 1;
+    }
+    p += step;
+  }
+  // Final line without a trailing newline
+  if (fieldStart < end) {
+    size_t length = static_cast<size_t>(end - fieldStart);
+    if (end[-1] == '\r') {
+      length--;
+    }
+    out.append(fieldStart, length);
+    out += '\n';
+    rows++;
+  }
+  return rows;
+}
+
+// The reverse direction for the exporter: one COPY text row back to a
+// CSV line ('\t' to ',', \N to empty). Row data excludes the newline.
+inline void csvFromCopyRow(const char *row, size_t length, std::string &out) {
+  const char *fieldStart = row;
+  const char *end = row + length;
+  for (const char *p = row; p <= end; p++) {
+    if (p == end || *p == '\t') {
+      const size_t fieldLength = static_cast<size_t>(p - fieldStart);
+      if (fieldLength != 2 || fieldStart[0] != '\\' || fieldStart[1] != 'N') {
+        out.append(fieldStart, fieldLength);
+      }
+      out += (p == end) ? '\n' : ',';
+      fieldStart = p + 1;
+    }
+  }
+}
+
+#endif  // CSVLOAD_CSV_SCANNER_H
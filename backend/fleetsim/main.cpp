@@ -0,0 +1,547 @@
+// fleetsim: native fleet load simulator.
+//
+// Replaces YOLO-AI_Detection/esp32_cam_simulator.py for capacity tests:
+// the Python simulator distorts timing past a handful of devices, so
+// broker and detect-endpoint limits were never measured at target
+// scale. This tool drives thousands of simulated devices from one box
+// on a single epoll loop — each device is a small non-blocking state
+// machine, not a thread — publishing telemetry over MQTT at QoS 1 (the
+// PUBACK gives a real per-publish broker latency) and, optionally,
+// streaming length-prefixed camera frames at the detection endpoint and
+// timing the result round trip. Latency percentiles are reported every
+// 10s so capacity planning uses measured numbers.
+//
+// The camera payload is a JPEG SOI marker followed by noise: it
+// exercises transport, parsing and scheduling on the server, not the
+// model (inference cost is independent of what the pixels show).
+//
+// Usage:
+//   fleetsim [--broker host] [--port 1883] [--user u] [--password p]
+//            [--devices 1000] [--interval-ms 5000] [--jitter-pct 20]
+//            [--cameras 0] [--detect-host host] [--detect-port 5001]
+//            [--frame-bytes 40000] [--frame-interval-ms 5000]
+//            [--duration-s 0]
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Options {
+  std::string broker = "127.0.0.1";
+  uint16_t port = 1883;
+  std::string user;
+  std::string password;
+  unsigned devices = 1000;
+  int intervalMs = 5000;
+  int jitterPct = 20;
+  unsigned cameras = 0;
+  std::string detectHost = "127.0.0.1";
+  uint16_t detectPort = 5001;
+  unsigned frameBytes = 40000;
+  int frameIntervalMs = 5000;
+  int durationS = 0;  // 0 = run until interrupted
+};
+
+bool parseArgs(int argc, char **argv, Options &o) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--broker" && hasValue) o.broker = argv[++i];
+    else if (arg == "--port" && hasValue) o.port = atoi(argv[++i]);
+    else if (arg == "--user" && hasValue) o.user = argv[++i];
+    else if (arg == "--password" && hasValue) o.password = argv[++i];
+    else if (arg == "--devices" && hasValue) o.devices = atoi(argv[++i]);
+    else if (arg == "--interval-ms" && hasValue) o.intervalMs = atoi(argv[++i]);
+    else if (arg == "--jitter-pct" && hasValue) o.jitterPct = atoi(argv[++i]);
+    else if (arg == "--cameras" && hasValue) o.cameras = atoi(argv[++i]);
+    else if (arg == "--detect-host" && hasValue) o.detectHost = argv[++i];
+    else if (arg == "--detect-port" && hasValue) o.detectPort = atoi(argv[++i]);
+    else if (arg == "--frame-bytes" && hasValue) o.frameBytes = atoi(argv[++i]);
+    else if (arg == "--frame-interval-ms" && hasValue) o.frameIntervalMs = atoi(argv[++i]);
+    else if (arg == "--duration-s" && hasValue) o.durationS = atoi(argv[++i]);
+    else {
+      fprintf(stderr,
+              "usage: fleetsim [--broker host] [--port n] [--user u] [--password p]\n"
+              "                [--devices n] [--interval-ms n] [--jitter-pct n]\n"
+              "                [--cameras n] [--detect-host host] [--detect-port n]\n"
+              "                [--frame-bytes n] [--frame-interval-ms n] [--duration-s n]\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+// Latency samples for one interval; sorted once at report time.
+// Unbounded growth is fine — 10s of even 100k samples is megabytes.
+struct LatencyRecorder {
+  std::vector<double> samples;
+  void record(double ms) { samples.push_back(ms); }
+  void report(const char *name) {
+    if (samples.empty()) {
+      return;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto pct = [&](double p) {
+      return samples[(size_t)(p * (samples.size() - 1))];
+    };
+    printf("fleetsim: %-7s n=%zu p50=%.1fms p90=%.1fms p99=%.1fms max=%.1fms\n",
+           name, samples.size(), pct(0.50), pct(0.90), pct(0.99),
+           samples.back());
+    samples.clear();
+  }
+};
+
+// Minimal MQTT 3.1.1 packet builders — only what a publishing device
+// needs (mirrors the consumer-side subset in backend/common)
+void appendString(std::vector<uint8_t> &out, const std::string &s) {
+  out.push_back(s.size() >> 8);
+  out.push_back(s.size() & 0xFF);
+  out.insert(out.end(), s.begin(), s.end());
+}
+
+void appendRemainingLength(std::vector<uint8_t> &out, size_t length) {
+  do {
+    uint8_t byte = length % 128;
+    length /= 128;
+    if (length > 0) byte |= 0x80;
+    out.push_back(byte);
+  } while (length > 0);
+}
+
+std::vector<uint8_t> buildConnect(const std::string &clientId,
+                                  const std::string &user,
+                                  const std::string &password) {
+  std::vector<uint8_t> body;
+  appendString(body, "MQTT");
+  body.push_back(4);  // protocol level 3.1.1
+  uint8_t flags = 0x02;  // clean session
+  if (!user.empty()) flags |= 0x80;
+  if (!password.empty()) flags |= 0x40;
+  body.push_back(flags);
+  body.push_back(0);  // keepalive 0: disabled, publishes are the traffic
+  body.push_back(0);
+  appendString(body, clientId);
+  if (!user.empty()) appendString(body, user);
+  if (!password.empty()) appendString(body, password);
+
+  std::vector<uint8_t> packet;
+  packet.push_back(0x10);
+  appendRemainingLength(packet, body.size());
+  packet.insert(packet.end(), body.begin(), body.end());
+  return packet;
+}
+
+std::vector<uint8_t> buildPublishQos1(const std::string &topic,
+                                      uint16_t packetId,
+                                      const std::string &payload) {
+  std::vector<uint8_t> body;
+  appendString(body, topic);
+  body.push_back(packetId >> 8);
+  body.push_back(packetId & 0xFF);
+  body.insert(body.end(), payload.begin(), payload.end());
+
+  std::vector<uint8_t> packet;
+  packet.push_back(0x32);  // PUBLISH, QoS 1
+  appendRemainingLength(packet, body.size());
+  packet.insert(packet.end(), body.begin(), body.end());
+  return packet;
+}
+
+// One simulated device. Everything is driven by epoll events plus a
+// 100ms scheduling sweep; no thread per device.
+struct SimDevice {
+  enum class Kind { Mqtt, Camera };
+  enum class State { Disconnected, Connecting, Handshaking, Ready, AwaitingAck };
+
+  Kind kind = Kind::Mqtt;
+  State state = State::Disconnected;
+  int fd = -1;
+  unsigned id = 0;
+  int64_t nextActionMs = 0;   // next connect retry or next publish
+  int64_t inflightSentMs = 0; // when the timed request went out
+  uint32_t responseRemaining = 0;  // camera: response bytes left to drain
+  std::minstd_rand rng;
+  std::vector<uint8_t> rxBuffer;
+};
+
+class Fleet {
+public:
+  explicit Fleet(const Options &options) : options_(options) {
+    epollFd_ = epoll_create1(0);
+    frame_.assign(options.frameBytes, 0);
+    std::minstd_rand noise(42);
+    for (size_t i = 0; i < frame_.size(); i++) {
+      frame_[i] = noise() & 0xFF;
+    }
+    if (frame_.size() >= 2) {  // JPEG SOI so naive sniffers accept it
+      frame_[0] = 0xFF;
+      frame_[1] = 0xD8;
+    }
+  }
+
+  bool resolve(std::string &error) {
+    if (!resolveAddr(options_.broker, options_.port, brokerAddr_) ) {
+      error = "cannot resolve " + options_.broker;
+      return false;
+    }
+    if (options_.cameras > 0 &&
+        !resolveAddr(options_.detectHost, options_.detectPort, detectAddr_)) {
+      error = "cannot resolve " + options_.detectHost;
+      return false;
+    }
+    return true;
+  }
+
+  void populate() {
+    devices_.resize(options_.devices + options_.cameras);
+    const int64_t now = nowMs();
+    for (size_t i = 0; i < devices_.size(); i++) {
+      SimDevice &device = devices_[i];
+      device.id = i;
+      device.kind = i < options_.devices ? SimDevice::Kind::Mqtt
+                                         : SimDevice::Kind::Camera;
+      device.rng.seed(i + 1);
+      // Stagger the initial connects across one interval so the SYN
+      // flood does not itself become the bottleneck being measured
+      device.nextActionMs =
+          now + (int64_t)(device.rng() % (unsigned)std::max(1, options_.intervalMs));
+    }
+  }
+
+  void run() {
+    const int64_t startMs = nowMs();
+    int64_t lastReportMs = startMs;
+    while (!shuttingDown) {
+      sweep(nowMs());
+
+      struct epoll_event events[256];
+      const int ready = epoll_wait(epollFd_, events, 256, 100);
+      for (int i = 0; i < ready; i++) {
+        handleEvent(devices_[events[i].data.u32], events[i].events);
+      }
+
+      const int64_t now = nowMs();
+      if (now - lastReportMs >= 10000) {
+        lastReportMs = now;
+        report();
+      }
+      if (options_.durationS > 0 &&
+          now - startMs >= (int64_t)options_.durationS * 1000) {
+        break;
+      }
+    }
+    report();
+  }
+
+private:
+  static bool resolveAddr(const std::string &host, uint16_t port,
+                          struct sockaddr_in &out) {
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0) {
+      return false;
+    }
+    out = *reinterpret_cast<struct sockaddr_in *>(result->ai_addr);
+    out.sin_port = htons(port);
+    freeaddrinfo(result);
+    return true;
+  }
+
+  // Scheduling sweep: O(devices) every 100ms, which at thousands of
+  // devices is microseconds — no timer wheel needed at this scale
+  void sweep(int64_t now) {
+    for (SimDevice &device : devices_) {
+      if (device.nextActionMs > now) {
+        continue;
+      }
+      if (device.state == SimDevice::State::Disconnected) {
+        startConnect(device, now);
+      } else if (device.state == SimDevice::State::Ready) {
+        startRequest(device, now);
+      } else if (now - device.nextActionMs > 30000) {
+        // Stuck mid-handshake or mid-request for 30s: recycle
+        disconnect(device, now);
+      }
+    }
+  }
+
+  void startConnect(SimDevice &device, int64_t now) {
+    device.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (device.fd < 0) {
+      device.nextActionMs = now + 1000;
+      return;
+    }
+    int one = 1;
+    setsockopt(device.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    const struct sockaddr_in &addr =
+        device.kind == SimDevice::Kind::Mqtt ? brokerAddr_ : detectAddr_;
+    if (connect(device.fd, reinterpret_cast<const struct sockaddr *>(&addr),
+                sizeof(addr)) < 0 &&
+        errno != EINPROGRESS) {
+      disconnect(device, now + 1000);
+      return;
+    }
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLOUT;
+    event.data.u32 = device.id;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, device.fd, &event);
+    device.state = SimDevice::State::Connecting;
+    device.nextActionMs = now;  // watchdog baseline for the sweep
+  }
+
+  void handleEvent(SimDevice &device, uint32_t events) {
+    const int64_t now = nowMs();
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      disconnect(device, now + 1000);
+      return;
+    }
+    if (device.state == SimDevice::State::Connecting && (events & EPOLLOUT)) {
+      // Connected; switch to read-driven and run the protocol handshake
+      struct epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.u32 = device.id;
+      epoll_ctl(epollFd_, EPOLL_CTL_MOD, device.fd, &event);
+      if (device.kind == SimDevice::Kind::Mqtt) {
+        char clientId[32];
+        snprintf(clientId, sizeof(clientId), "simdev-%u", device.id);
+        const std::vector<uint8_t> packet =
+            buildConnect(clientId, options_.user, options_.password);
+        sendAll(device, packet.data(), packet.size());
+        device.state = SimDevice::State::Handshaking;
+      } else {
+        // Detect stream has no handshake, first frame goes on schedule
+        device.state = SimDevice::State::Ready;
+        connectedCameras_++;
+      }
+      return;
+    }
+    if (events & EPOLLIN) {
+      onReadable(device, now);
+    }
+  }
+
+  void onReadable(SimDevice &device, int64_t now) {
+    uint8_t chunk[4096];
+    while (true) {
+      const ssize_t received = recv(device.fd, chunk, sizeof(chunk), 0);
+      if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        disconnect(device, now + 1000);
+        return;
+      }
+      if (received < 0) {
+        return;
+      }
+      device.rxBuffer.insert(device.rxBuffer.end(), chunk, chunk + received);
+      if (device.kind == SimDevice::Kind::Mqtt) {
+        consumeMqtt(device, now);
+      } else {
+        consumeDetect(device, now);
+      }
+    }
+  }
+
+  void consumeMqtt(SimDevice &device, int64_t now) {
+    // CONNACK and PUBACK are both fixed 4-byte packets, the only thing
+    // the broker sends us (no subscriptions, keepalive off)
+    while (device.rxBuffer.size() >= 4) {
+      const uint8_t type = device.rxBuffer[0] & 0xF0;
+      if (type == 0x20 && device.state == SimDevice::State::Handshaking) {
+        if (device.rxBuffer[3] != 0) {
+          fprintf(stderr, "fleetsim: device %u refused (rc=%u)\n", device.id,
+                  device.rxBuffer[3]);
+          disconnect(device, now + 5000);
+          return;
+        }
+        device.state = SimDevice::State::Ready;
+        connectedDevices_++;
+        scheduleNext(device, now, options_.intervalMs);
+      } else if (type == 0x40 &&
+                 device.state == SimDevice::State::AwaitingAck) {
+        mqttLatency_.record(now - device.inflightSentMs);
+        publishes_++;
+        device.state = SimDevice::State::Ready;
+      }
+      device.rxBuffer.erase(device.rxBuffer.begin(), device.rxBuffer.begin() + 4);
+    }
+  }
+
+  void consumeDetect(SimDevice &device, int64_t now) {
+    // 4-byte big-endian length prefix, then the JSON result, which is
+    // drained and discarded — the timing is the product here
+    while (!device.rxBuffer.empty()) {
+      if (device.responseRemaining == 0) {
+        if (device.rxBuffer.size() < 4) {
+          return;
+        }
+        device.responseRemaining =
+            ((uint32_t)device.rxBuffer[0] << 24) | ((uint32_t)device.rxBuffer[1] << 16) |
+            ((uint32_t)device.rxBuffer[2] << 8) | device.rxBuffer[3];
+        device.rxBuffer.erase(device.rxBuffer.begin(), device.rxBuffer.begin() + 4);
+      }
+      const size_t take = std::min((size_t)device.responseRemaining,
+                                   device.rxBuffer.size());
+      device.rxBuffer.erase(device.rxBuffer.begin(), device.rxBuffer.begin() + take);
+      device.responseRemaining -= take;
+      if (device.responseRemaining == 0 &&
+          device.state == SimDevice::State::AwaitingAck) {
+        detectLatency_.record(now - device.inflightSentMs);
+        frames_++;
+        device.state = SimDevice::State::Ready;
+        scheduleNext(device, now, options_.frameIntervalMs);
+      }
+    }
+  }
+
+  void startRequest(SimDevice &device, int64_t now) {
+    if (device.kind == SimDevice::Kind::Mqtt) {
+      char payload[160];
+      snprintf(payload, sizeof(payload),
+               "{\"temperature\":%.2f,\"humidity\":%.2f,\"light\":%u,"
+               "\"moisture\":%.2f}",
+               20.0 + (device.rng() % 1500) / 100.0,
+               40.0 + (device.rng() % 4000) / 100.0,
+               static_cast<unsigned>(device.rng() % 4096),
+               20.0 + (device.rng() % 6000) / 100.0);
+      const std::vector<uint8_t> packet =
+          buildPublishQos1("v1/devices/me/telemetry", 1, payload);
+      device.inflightSentMs = now;
+      device.state = SimDevice::State::AwaitingAck;
+      scheduleNext(device, now, options_.intervalMs);
+      sendAll(device, packet.data(), packet.size());
+    } else {
+      const uint8_t prefix[4] = {
+          (uint8_t)(frame_.size() >> 24), (uint8_t)(frame_.size() >> 16),
+          (uint8_t)(frame_.size() >> 8), (uint8_t)frame_.size()};
+      device.inflightSentMs = now;
+      device.state = SimDevice::State::AwaitingAck;
+      device.nextActionMs = now;  // watchdog; real schedule set on response
+      sendAll(device, prefix, sizeof(prefix));
+      sendAll(device, frame_.data(), frame_.size());
+    }
+  }
+
+  // Uniform jitter of ±jitterPct around the base interval, so the fleet
+  // does not phase-lock into synchronized publish bursts
+  void scheduleNext(SimDevice &device, int64_t now, int baseMs) {
+    const int span = baseMs * options_.jitterPct / 100;
+    const int jitter = span > 0 ? (int)(device.rng() % (2 * span + 1)) - span : 0;
+    device.nextActionMs = now + baseMs + jitter;
+  }
+
+  // Blocking-style send on the non-blocking socket: the kernel buffer
+  // absorbs these packet sizes in practice; a device that cannot even
+  // queue its frame is recycled like any other failure
+  void sendAll(SimDevice &device, const uint8_t *data, size_t length) {
+    size_t sent = 0;
+    while (sent < length) {
+      const ssize_t n = send(device.fd, data + sent, length - sent, MSG_NOSIGNAL);
+      if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          continue;
+        }
+        disconnect(device, nowMs() + 1000);
+        return;
+      }
+      sent += n;
+    }
+  }
+
+  void disconnect(SimDevice &device, int64_t retryAtMs) {
+    if (device.fd >= 0) {
+      epoll_ctl(epollFd_, EPOLL_CTL_DEL, device.fd, nullptr);
+      ::close(device.fd);
+      device.fd = -1;
+    }
+    if (device.state == SimDevice::State::Ready ||
+        device.state == SimDevice::State::AwaitingAck) {
+      if (device.kind == SimDevice::Kind::Mqtt) {
+        connectedDevices_--;
+      } else {
+        connectedCameras_--;
+      }
+    }
+    device.state = SimDevice::State::Disconnected;
+    device.rxBuffer.clear();
+    device.responseRemaining = 0;
+    device.nextActionMs = retryAtMs;
+    disconnects_++;
+  }
+
+  void report() {
+    printf("fleetsim: %u/%u devices, %u/%u cameras connected, "
+           "%llu publishes, %llu frames, %llu disconnects\n",
+           connectedDevices_, options_.devices, connectedCameras_,
+           options_.cameras, (unsigned long long)publishes_,
+           (unsigned long long)frames_, (unsigned long long)disconnects_);
+    mqttLatency_.report("publish");
+    detectLatency_.report("detect");
+  }
+
+  const Options &options_;
+  int epollFd_ = -1;
+  struct sockaddr_in brokerAddr_ = {};
+  struct sockaddr_in detectAddr_ = {};
+  std::vector<SimDevice> devices_;
+  std::vector<uint8_t> frame_;
+  LatencyRecorder mqttLatency_;
+  LatencyRecorder detectLatency_;
+  unsigned connectedDevices_ = 0;
+  unsigned connectedCameras_ = 0;
+  uint64_t publishes_ = 0;
+  uint64_t frames_ = 0;
+  uint64_t disconnects_ = 0;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  Fleet fleet(options);
+  std::string error;
+  if (!fleet.resolve(error)) {
+    fprintf(stderr, "fleetsim: %s\n", error.c_str());
+    return 1;
+  }
+  fleet.populate();
+  printf("fleetsim: %u mqtt devices -> %s:%u (interval %dms ±%d%%), "
+         "%u cameras -> %s:%u (%u-byte frames every %dms)\n",
+         options.devices, options.broker.c_str(), options.port,
+         options.intervalMs, options.jitterPct, options.cameras,
+         options.detectHost.c_str(), options.detectPort, options.frameBytes,
+         options.frameIntervalMs);
+  fleet.run();
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include "command_push.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Registry lastSeenMs is unix epoch; the pipeline's steady-clock
+// microseconds cannot be compared against it
+int64_t epochMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// A down local broker refuses the TCP connect immediately, so the cost
+// of a retry is one syscall round-trip; the backoff exists for the
+// pathological cases (broker host unrouteable) where connect blocks
+constexpr int64_t kConnectBackoffUs = 5 * 1000 * 1000;
+
+}  // namespace
+
+bool CommandPush::loadSectorMap(const std::string &path, std::string &error) {
+  std::ifstream file(path);
+  if (!file) {
+    error = "cannot open " + path;
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    std::string camera;
+    fields >> camera;
+    std::vector<std::string> targets;
+    std::string target;
+    while (fields >> target) {
+      targets.push_back(target);
+    }
+    if (camera.empty() || targets.empty()) {
+      continue;
+    }
+    sectorTargets_[camera] = std::move(targets);
+  }
+  return true;
+}
+
+bool CommandPush::openRegistry(const std::string &shmName) {
+  std::string error;
+  registryOpen_ = !shmName.empty() && registry_.openReader(shmName, error);
+  return registryOpen_;
+}
+
+bool CommandPush::ensureConnected(int64_t nowUs) {
+  if (connected_) {
+    return true;
+  }
+  if (lastConnectAttemptUs_ != 0 &&
+      nowUs - lastConnectAttemptUs_ < kConnectBackoffUs) {
+    return false;
+  }
+  lastConnectAttemptUs_ = nowUs;
+  std::string error;
+  if (!consumer_.connect(broker_, port_, "gateway-push", "", "", error)) {
+    fprintf(stderr, "gateway: command push: %s\n", error.c_str());
+    return false;
+  }
+  connected_ = true;
+  printf("gateway: command push connected to %s:%u\n", broker_.c_str(), port_);
+  return true;
+}
+
+bool CommandPush::targetAlive(const std::string &deviceId, int64_t nowMs) {
+  if (!registryOpen_) {
+    return true;
+  }
+  DeviceRecord record;
+  if (!registry_.read(deviceId.c_str(), record)) {
+    // Not every target reports telemetry; unknown to the registry
+    // means no liveness opinion, not offline
+    return true;
+  }
+  return nowMs - record.lastSeenMs <= kOfflineMs;
+}
+
+void CommandPush::notify(const std::string &cameraId,
+                         const std::vector<Detection> &detections,
+                         int64_t nowUs) {
+  if (detections.empty()) {
+    return;
+  }
+  float confidence = 0.0f;
+  for (const Detection &d : detections) {
+    if (d.confidence > confidence) {
+      confidence = d.confidence;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto mapped = sectorTargets_.find(cameraId);
+  const std::vector<std::string> fallback{cameraId};
+  const std::vector<std::string> &targets =
+      mapped != sectorTargets_.end() ? mapped->second : fallback;
+
+  // Same colon-value shape as the firmware's other commands
+  // (set_threshold:, set_bandwidth_kbps:); firmware that has not
+  // learned it yet acks and ignores it, so rollout is broker-first
+  char command[48];
+  snprintf(command, sizeof(command), "fire_alert:%.2f", confidence);
+
+  const int64_t nowMs = epochMs();
+  for (const std::string &target : targets) {
+    int64_t &lastUs = lastPushUs_[target];
+    if (lastUs != 0 && nowUs - lastUs < cooldownUs_) {
+      continue;
+    }
+    if (!targetAlive(target, nowMs)) {
+      continue;
+    }
+    if (!ensureConnected(nowUs)) {
+      return;
+    }
+    if (!consumer_.publish("coreiot/" + target + "/commands", command)) {
+      connected_ = false;
+      consumer_.close();
+      return;
+    }
+    lastUs = nowUs;
+    commandsPushed_.fetch_add(1, std::memory_order_relaxed);
+    fprintf(stderr, "gateway: %s -> %s (camera %s)\n", command,
+            target.c_str(), cameraId.c_str());
+  }
+}
+
+void CommandPush::tick(int64_t nowMs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!connected_) {
+    return;
+  }
+  if (!consumer_.tick(nowMs) || !consumer_.onReadable()) {
+    fprintf(stderr, "gateway: command push connection lost\n");
+    connected_ = false;
+    consumer_.close();
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef GATEWAY_COMMAND_PUSH_H
+#define GATEWAY_COMMAND_PUSH_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "device_registry.h"
+#include "inference_backend.h"
+#include "mqtt_consumer.h"
+
+// Direct detection-to-command push over the local broker. Without it a
+// fire verdict travels camera -> gateway -> operator or cloud rule ->
+// device command, a loop that takes seconds when the WAN cooperates and
+// forever when it does not. The gateway already holds the verdict the
+// moment the model returns; publishing it straight to the affected
+// devices' command topics (coreiot/<id>/commands — the same topic the
+// camera firmware's mqttCallback subscribes to) closes detect-to-actuate
+// on-site in the broker's round-trip time.
+//
+// Which devices a camera's verdict concerns comes from a sector map
+// file: one line per camera, whitespace-separated, camera id first and
+// target device ids after ("cam-3 pump-3 fan-3", '#' comments). The
+// shared-memory device registry carries no sector column, so membership
+// lives in the map; the registry still contributes liveness — a target
+// the registry knows but has not heard from recently is skipped rather
+// than commanded into the void. A camera with no map entry falls back
+// to its own command topic, so the loop works with zero configuration.
+//
+// Fires burn longer than frames: a per-target cooldown collapses the
+// per-frame verdict stream into one command per window, and repeats
+// while the condition persists in case the first PUBLISH was lost
+// (pushes are QoS 0 on a LAN broker).
+class CommandPush {
+public:
+  CommandPush(const std::string &broker, uint16_t port, unsigned cooldownMs)
+      : broker_(broker), port_(port),
+        cooldownUs_(static_cast<int64_t>(cooldownMs) * 1000) {}
+
+  // Parses the camera -> targets map; missing file is an error, an
+  // empty path just leaves every camera on the self-topic fallback.
+  bool loadSectorMap(const std::string &path, std::string &error);
+
+  // Best-effort: the registry segment only exists while ingestd runs,
+  // and pushes must not depend on it. Returns false (and logs nothing)
+  // when the segment is absent; liveness filtering is simply off then.
+  bool openRegistry(const std::string &shmName);
+
+  // Called from the inference thread for every frame with detections.
+  // Connects lazily (with backoff) so a down broker costs one failed
+  // TCP connect per backoff window, not one per frame.
+  void notify(const std::string &cameraId,
+              const std::vector<Detection> &detections, int64_t nowUs);
+
+  // Keepalive from the main thread's stats cadence: PINGREQ when the
+  // window is half spent, and drains the PINGRESPs the push path never
+  // reads. Safe to call while disconnected.
+  void tick(int64_t nowMs);
+
+  uint64_t commandsPushed() const {
+    return commandsPushed_.load(std::memory_order_relaxed);
+  }
+
+  // A record older than this is an offline device; commands to it
+  // would only queue up trouble for when it reboots
+  static constexpr int64_t kOfflineMs = 5 * 60 * 1000;
+
+private:
+  bool ensureConnected(int64_t nowUs);
+  bool targetAlive(const std::string &deviceId, int64_t nowMs);
+
+  std::string broker_;
+  uint16_t port_;
+  int64_t cooldownUs_;
+
+  std::mutex mutex_;
+  MqttConsumer consumer_;
+  bool connected_ = false;
+  int64_t lastConnectAttemptUs_ = 0;
+  std::map<std::string, std::vector<std::string>> sectorTargets_;
+  std::map<std::string, int64_t> lastPushUs_;  // keyed by target id
+
+  DeviceRegistry registry_;
+  bool registryOpen_ = false;
+
+  std::atomic<uint64_t> commandsPushed_{0};
+};
+
+#endif // GATEWAY_COMMAND_PUSH_H
@@ -0,0 +1,108 @@
+#ifndef GATEWAY_DETECTION_CACHE_H
+#define GATEWAY_DETECTION_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "inference_backend.h"
+
+// Short-circuit cache for duplicate uploads. Static scenes make
+// consecutive frames from a camera frequently byte-identical JPEGs, and
+// each one used to run full YOLO inference. A decode worker hashes the
+// JPEG payload before preprocessing; a hit within the freshness window
+// answers straight from the cache, skipping decode, batching and the
+// model entirely. The inference thread inserts results after each
+// batch.
+//
+// Keys hash the JPEG bytes together with the model name and threshold,
+// since either changes the detections for identical pixels. Matching
+// is exact-byte only: a perceptual hash would need the decoded pixels,
+// which is most of the work the cache exists to skip. The freshness
+// window bounds staleness — a scene change shows up one window later
+// at worst.
+class DetectionCache {
+public:
+  // Entries beyond this count evict oldest-first on insert; at ~30
+  // cameras and a couple of models this never fills in practice
+  static constexpr size_t kMaxEntries = 1024;
+
+  // windowUs of 0 disables the cache entirely
+  explicit DetectionCache(int64_t windowUs) : windowUs_(windowUs) {}
+
+  // FNV-1a over the payload, then the model name and threshold folded in
+  static uint64_t key(const std::vector<uint8_t> &jpeg,
+                      const std::string &model, float threshold) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (uint8_t byte : jpeg) {
+      hash = (hash ^ byte) * 1099511628211ULL;
+    }
+    for (char c : model) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    }
+    uint32_t bits;
+    static_assert(sizeof(bits) == sizeof(threshold), "float is 32-bit");
+    memcpy(&bits, &threshold, sizeof(bits));
+    for (int i = 0; i < 4; i++) {
+      hash = (hash ^ ((bits >> (8 * i)) & 0xFF)) * 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  bool lookup(uint64_t key, int64_t nowUs,
+              std::vector<Detection> &detections) {
+    if (windowUs_ == 0) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || nowUs - it->second.insertedUs > windowUs_) {
+      return false;
+    }
+    detections = it->second.detections;
+    return true;
+  }
+
+  void insert(uint64_t key, const std::vector<Detection> &detections,
+              int64_t nowUs) {
+    if (windowUs_ == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.size() >= kMaxEntries) {
+      // Drop expired entries first; if everything is fresh, the oldest
+      for (auto it = entries_.begin(); it != entries_.end();) {
+        if (nowUs - it->second.insertedUs > windowUs_) {
+          it = entries_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      while (entries_.size() >= kMaxEntries) {
+        auto oldest = entries_.begin();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+          if (it->second.insertedUs < oldest->second.insertedUs) {
+            oldest = it;
+          }
+        }
+        entries_.erase(oldest);
+      }
+    }
+    entries_[key] = Entry{detections, nowUs};
+  }
+
+private:
+  struct Entry {
+    std::vector<Detection> detections;
+    int64_t insertedUs = 0;
+  };
+
+  const int64_t windowUs_;
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, Entry> entries_;
+};
+
+#endif // GATEWAY_DETECTION_CACHE_H
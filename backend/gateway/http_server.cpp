@@ -0,0 +1,267 @@
+#include "http_server.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void setNonBlocking(int fd) {
+  const int flags = fcntl(fd, F_GETFL, 0);
+  fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Case-insensitive header lookup inside the raw header block
+bool headerValue(const std::string &headers, const char *name, size_t &value) {
+  const size_t nameLength = strlen(name);
+  size_t pos = 0;
+  while ((pos = headers.find('\n', pos)) != std::string::npos) {
+    pos++;
+    if (headers.size() - pos < nameLength + 1) {
+      break;
+    }
+    if (strncasecmp(headers.c_str() + pos, name, nameLength) == 0 &&
+        headers[pos + nameLength] == ':') {
+      value = strtoul(headers.c_str() + pos + nameLength + 1, nullptr, 10);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool HttpServer::start(uint16_t port, Handler handler, std::string &error) {
+  handler_ = std::move(handler);
+
+  listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  // Zero-downtime handoff: SO_REUSEPORT lets a warm standby bind the
+  // same port while the old process still serves. During the overlap
+  // the kernel spreads new connections across both listeners; once the
+  // old process gets SIGTERM and drains, everything lands on the new
+  // one. No camera ever sees a refused connect.
+  setsockopt(listenFd_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(port);
+  if (bind(listenFd_, reinterpret_cast<struct sockaddr *>(&addr),
+           sizeof(addr)) != 0 ||
+      listen(listenFd_, 64) != 0) {
+    error = "listen on :" + std::to_string(port) + ": " + strerror(errno);
+    close(listenFd_);
+    listenFd_ = -1;
+    return false;
+  }
+  setNonBlocking(listenFd_);
+
+  epollFd_ = epoll_create1(0);
+  wakeupFd_ = eventfd(0, EFD_NONBLOCK);
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.u64 = 0;  // 0 = listen fd, 1 = wakeup fd, else connection id
+  epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &event);
+  event.data.u64 = 1;
+  epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeupFd_, &event);
+
+  running_.store(true);
+  ioThread_ = std::thread(&HttpServer::ioLoop, this);
+  return true;
+}
+
+void HttpServer::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  const uint64_t one = 1;
+  (void)!write(wakeupFd_, &one, sizeof(one));
+  if (ioThread_.joinable()) {
+    ioThread_.join();
+  }
+  std::lock_guard<std::mutex> lock(connectionsMutex_);
+  for (auto &entry : connections_) {
+    close(entry.second.fd);
+  }
+  connections_.clear();
+  close(listenFd_);
+  close(epollFd_);
+  close(wakeupFd_);
+}
+
+void HttpServer::closeConnection(uint64_t connectionId) {
+  std::lock_guard<std::mutex> lock(connectionsMutex_);
+  auto it = connections_.find(connectionId);
+  if (it == connections_.end()) {
+    return;
+  }
+  epoll_ctl(epollFd_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+  close(it->second.fd);
+  connections_.erase(it);
+}
+
+bool HttpServer::tryParse(uint64_t connectionId, Connection &connection,
+                          std::vector<Request> &completed) {
+  if (connection.bodyStart == 0) {
+    const size_t headerEnd = connection.buffer.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) {
+      return connection.buffer.size() < (64 << 10);  // runaway headers
+    }
+    connection.bodyStart = headerEnd + 4;
+    headerValue(connection.buffer, "Content-Length", connection.contentLength);
+    if (connection.contentLength > (16u << 20)) {
+      return false;  // refuse >16MB uploads outright
+    }
+  }
+  if (connection.buffer.size() - connection.bodyStart <
+      connection.contentLength) {
+    return true;  // body still arriving
+  }
+
+  Request request;
+  char method[16];
+  char target[1024];
+  if (sscanf(connection.buffer.c_str(), "%15s %1023s", method, target) != 2) {
+    return false;
+  }
+  request.method = method;
+  request.target = target;
+  request.body = connection.buffer.substr(connection.bodyStart,
+                                          connection.contentLength);
+  request.connectionId = connectionId;
+  request.acceptedUs = nowUs();
+  // The connection stays registered but quiet until respond() closes it
+  connection.buffer.clear();
+  connection.bodyStart = 0;
+  completed.push_back(std::move(request));
+  return true;
+}
+
+void HttpServer::ioLoop() {
+  while (running_.load(std::memory_order_relaxed)) {
+    struct epoll_event events[32];
+    const int ready = epoll_wait(epollFd_, events, 32, 500);
+    for (int i = 0; i < ready; i++) {
+      const uint64_t tag = events[i].data.u64;
+      if (tag == 0) {
+        // Accept everything pending
+        while (true) {
+          const int client = accept(listenFd_, nullptr, nullptr);
+          if (client < 0) {
+            break;
+          }
+          setNonBlocking(client);
+          int one = 1;
+          setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+          std::lock_guard<std::mutex> lock(connectionsMutex_);
+          const uint64_t id = ++nextConnectionId_;
+          connections_[id] = Connection{client, std::string(), 0, 0};
+          struct epoll_event event = {};
+          event.events = EPOLLIN;
+          event.data.u64 = id;
+          epoll_ctl(epollFd_, EPOLL_CTL_ADD, client, &event);
+        }
+      } else if (tag == 1) {
+        uint64_t drained;
+        while (read(wakeupFd_, &drained, sizeof(drained)) > 0) {
+        }
+      } else {
+        int fd = -1;
+        {
+          std::lock_guard<std::mutex> lock(connectionsMutex_);
+          auto it = connections_.find(tag);
+          if (it == connections_.end()) {
+            continue;
+          }
+          fd = it->second.fd;
+        }
+        char chunk[64 << 10];
+        bool drop = false;
+        std::vector<Request> completed;
+        while (true) {
+          const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+          if (n > 0) {
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            auto it = connections_.find(tag);
+            if (it == connections_.end()) {
+              break;
+            }
+            it->second.buffer.append(chunk, static_cast<size_t>(n));
+            if (!tryParse(tag, it->second, completed)) {
+              drop = true;
+              break;
+            }
+            continue;
+          }
+          if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK &&
+                         errno != EINTR)) {
+            drop = true;
+          }
+          break;
+        }
+        if (drop) {
+          closeConnection(tag);
+        }
+        // Dispatch outside the connections lock: the handler may answer
+        // inline through respond(), which takes it
+        for (Request &request : completed) {
+          handler_(std::move(request));
+        }
+      }
+    }
+  }
+}
+
+void HttpServer::respond(uint64_t connectionId, int status,
+                         const char *statusText, const std::string &body,
+                         const char *contentType) {
+  int fd = -1;
+  {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    auto it = connections_.find(connectionId);
+    if (it == connections_.end()) {
+      return;  // client went away while we were working
+    }
+    fd = it->second.fd;
+  }
+  char head[160];
+  const int headLength = snprintf(
+      head, sizeof(head),
+      "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n"
+      "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+      status, statusText, contentType, body.size());
+
+  // Short blocking-style write loop; responses are a few KB and the
+  // socket buffer absorbs them in one call in practice
+  std::string out(head, headLength);
+  out += body;
+  size_t sent = 0;
+  while (sent < out.size()) {
+    const ssize_t n = send(fd, out.data() + sent, out.size() - sent,
+                           MSG_NOSIGNAL);
+    if (n > 0) {
+      sent += static_cast<size_t>(n);
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      usleep(1000);
+    } else if (errno != EINTR) {
+      break;
+    }
+  }
+  closeConnection(connectionId);
+}
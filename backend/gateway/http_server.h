@@ -0,0 +1,75 @@
+#ifndef GATEWAY_HTTP_SERVER_H
+#define GATEWAY_HTTP_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Async HTTP/1.1 front door for the inference gateway. One epoll IO
+// thread owns every socket: it accepts, accumulates request bytes per
+// connection and fires the handler once headers plus Content-Length
+// body are complete, so thirty slow ESP32-CAM uploads cost thirty
+// buffers, not thirty blocked threads. The handler runs on the IO
+// thread and must only hand the request off (the pipeline owns the
+// heavy work); the eventual respond() may be called from any thread and
+// writes the response and closes the connection.
+class HttpServer {
+public:
+  struct Request {
+    std::string method;
+    std::string target;
+    std::string body;
+    uint64_t connectionId;
+    int64_t acceptedUs;  // arrival time, for queue-latency accounting
+  };
+
+  using Handler = std::function<void(Request &&request)>;
+
+  bool start(uint16_t port, Handler handler, std::string &error);
+  void stop();
+
+  // Thread-safe: serializes the response onto the connection and closes
+  // it. A connection that already vanished is silently ignored. The
+  // default content type covers every endpoint except /metrics, whose
+  // exposition format is plain text.
+  void respond(uint64_t connectionId, int status, const char *statusText,
+               const std::string &body,
+               const char *contentType = "application/json");
+
+private:
+  struct Connection {
+    int fd;
+    std::string buffer;
+    size_t bodyStart = 0;       // 0 = headers not complete yet
+    size_t contentLength = 0;
+  };
+
+  void ioLoop();
+  void closeConnection(uint64_t connectionId);
+  // Extracts a completed request if one is buffered; the caller
+  // dispatches it to the handler after releasing the connections lock
+  // (the handler may call respond(), which takes that lock). Returns
+  // false when the connection should be dropped.
+  bool tryParse(uint64_t connectionId, Connection &connection,
+                std::vector<Request> &completed);
+
+  int listenFd_ = -1;
+  int epollFd_ = -1;
+  int wakeupFd_ = -1;
+  std::thread ioThread_;
+  std::atomic<bool> running_{false};
+  Handler handler_;
+
+  // Guarded by connectionsMutex_: the IO thread and responders both
+  // touch the map, but never the same entry's buffer concurrently
+  std::mutex connectionsMutex_;
+  std::map<uint64_t, Connection> connections_;
+  uint64_t nextConnectionId_ = 1;
+};
+
+#endif // GATEWAY_HTTP_SERVER_H
@@ -0,0 +1,60 @@
+#ifndef GATEWAY_INFERENCE_BACKEND_H
+#define GATEWAY_INFERENCE_BACKEND_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One frame travelling through the gateway pipeline: raw JPEG bytes in,
+// detections out. The preprocessing stage may attach a decoded tensor;
+// until then backends that need pixels decode the JPEG themselves.
+struct Frame {
+  uint64_t connectionId;       // where the response goes
+  int64_t acceptedUs;          // request arrival, for latency accounting
+  std::vector<uint8_t> jpeg;
+  std::string model;
+  float threshold = 0.25f;
+  std::string deviceId;
+  uint64_t dedupKey = 0;  // payload hash, keys the duplicate-frame cache
+
+  // Filled by the preprocessing stage (640x640x3, CHW, normalized);
+  // empty until that stage runs
+  std::vector<float> tensor;
+  int imageWidth = 0;
+  int imageHeight = 0;
+};
+
+struct Detection {
+  float x1, y1, x2, y2;
+  float confidence;
+  int classId;
+};
+
+// A batch goes down to the model as one invocation; results come back
+// per frame in the same order.
+class InferenceBackend {
+public:
+  virtual ~InferenceBackend() = default;
+  virtual const char *name() const = 0;
+  virtual bool runBatch(std::vector<Frame> &frames,
+                        std::vector<std::vector<Detection>> &results,
+                        std::string &error) = 0;
+};
+
+// Stand-in backend used when the gateway is built without ONNX Runtime:
+// returns empty detection lists with a simulated model delay, so the
+// accept/batch/respond pipeline can be load-tested end to end on a box
+// with no GPU stack installed.
+class NullBackend : public InferenceBackend {
+public:
+  const char *name() const override { return "null"; }
+  bool runBatch(std::vector<Frame> &frames,
+                std::vector<std::vector<Detection>> &results,
+                std::string &error) override {
+    (void)error;
+    results.assign(frames.size(), {});
+    return true;
+  }
+};
+
+#endif // GATEWAY_INFERENCE_BACKEND_H
@@ -0,0 +1,76 @@
+#ifndef GATEWAY_MAPPED_FILE_H
+#define GATEWAY_MAPPED_FILE_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only mmap of a whole file, built for model weights. Loading
+// weights through regular reads copies them page-cache -> private heap
+// buffer and pays the disk on every process start; a shared read-only
+// mapping serves straight from the page cache, so after the first load
+// the pages survive the process and a restarted gateway faults them
+// back in milliseconds instead of re-reading gigabytes. MAP_POPULATE
+// prefaults the whole mapping up front — the cost lands at load time,
+// not as major-fault stalls spread through the first inferences.
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() { unmap(); }
+
+  bool map(const std::string &path, std::string &error) {
+    unmap();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      error = "open " + path + ": " + strerror(errno);
+      return false;
+    }
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      error = "stat " + path + ": " +
+              (st.st_size == 0 ? "empty file" : strerror(errno));
+      ::close(fd);
+      return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd,
+                   0);
+    // The mapping pins the inode; the descriptor is done its job
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+      error = "mmap " + path + ": " + strerror(errno);
+      data_ = nullptr;
+      size_ = 0;
+      return false;
+    }
+    // Sequential once (the session build walks the graph front to
+    // back), then random lookups during inference
+    madvise(data_, size_, MADV_WILLNEED);
+    return true;
+  }
+
+  void unmap() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  const uint8_t *data() const { return static_cast<const uint8_t *>(data_); }
+  size_t size() const { return size_; }
+
+private:
+  void *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+#endif // GATEWAY_MAPPED_FILE_H
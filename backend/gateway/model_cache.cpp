@@ -0,0 +1,125 @@
+#include "model_cache.h"
+
+#include <cstdio>
+#include <sys/stat.h>
+
+#include "ort_backend.h"
+
+bool ModelCache::resolvePath(const std::string &model, std::string &path,
+                             std::string &error) const {
+  if (modelDir_.empty()) {
+    if (fallbackPath_.empty()) {
+      error = "no --model-dir or --model configured";
+      return false;
+    }
+    path = fallbackPath_;
+    return true;
+  }
+  // The name comes off the wire; keep it from escaping the model dir
+  if (model.empty() || model.find('/') != std::string::npos ||
+      model.find("..") != std::string::npos) {
+    error = "invalid model name \"" + model + "\"";
+    return false;
+  }
+  path = modelDir_ + "/" + model + ".onnx";
+  return true;
+}
+
+InferenceBackend *ModelCache::acquire(const std::string &model,
+                                      std::string &error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  useCounter_++;
+
+  auto it = entries_.find(model);
+  if (it != entries_.end()) {
+    it->second.lastUsed = useCounter_;
+    hits_++;
+    return it->second.backend.get();
+  }
+
+  std::string path;
+  if (!resolvePath(model, path, error)) {
+    if (modelDir_.empty() && fallbackPath_.empty()) {
+      // Unconfigured gateway: every name shares one null backend so the
+      // pipeline stays load-testable, same as before the cache existed
+      error.clear();
+      Entry entry;
+      entry.backend = std::make_unique<NullBackend>();
+      entry.lastUsed = useCounter_;
+      InferenceBackend *backend = entry.backend.get();
+      entries_.emplace(model, std::move(entry));
+      return backend;
+    }
+    return nullptr;
+  }
+
+  struct stat st = {};
+  if (stat(path.c_str(), &st) != 0) {
+    error = "model \"" + model + "\" not found at " + path;
+    return nullptr;
+  }
+  const size_t bytes = static_cast<size_t>(st.st_size);
+
+  // Make room first so the budget holds across the load, but never
+  // evict below zero entries on behalf of one oversized model
+  if (budgetBytes_ > bytes) {
+    evictTo(budgetBytes_ - bytes);
+  } else {
+    evictTo(0);
+  }
+
+  Entry entry;
+  entry.backend = createOrtBackend(path, error);
+  if (entry.backend == nullptr) {
+    return nullptr;
+  }
+  entry.bytes = bytes;
+  entry.lastUsed = useCounter_;
+  loads_++;
+  residentBytes_ += bytes;
+  fprintf(stderr, "gateway: loaded model \"%s\" (%zu KB, %zu KB resident)\n",
+          model.c_str(), bytes / 1024, residentBytes_ / 1024);
+
+  InferenceBackend *backend = entry.backend.get();
+  entries_.emplace(model, std::move(entry));
+  return backend;
+}
+
+void ModelCache::evictTo(size_t targetBytes) {
+  // Only the inference thread loads and runs models, and it holds no
+  // backend across acquire() calls, so evicting here cannot invalidate
+  // a backend that is mid-batch
+  while (residentBytes_ > targetBytes && !entries_.empty()) {
+    auto victim = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second.lastUsed < victim->second.lastUsed) {
+        victim = it;
+      }
+    }
+    fprintf(stderr, "gateway: evicting model \"%s\" (%zu KB)\n",
+            victim->first.c_str(), victim->second.bytes / 1024);
+    residentBytes_ -= victim->second.bytes;
+    entries_.erase(victim);
+    evictions_++;
+  }
+}
+
+uint64_t ModelCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+uint64_t ModelCache::loads() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return loads_;
+}
+
+uint64_t ModelCache::evictions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return evictions_;
+}
+
+size_t ModelCache::residentBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return residentBytes_;
+}
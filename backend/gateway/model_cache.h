@@ -0,0 +1,70 @@
+#ifndef GATEWAY_MODEL_CACHE_H
+#define GATEWAY_MODEL_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "inference_backend.h"
+
+// Warm cache of loaded models, keyed by the request's "model" field.
+// The Flask server located and loaded models ad hoc per process;
+// adding a second model meant paying the load cost at unpredictable
+// points. Here a model is loaded once, on the first request that names
+// it, and stays resident; when the combined size exceeds the budget the
+// least-recently-used model is evicted, so the switch cost is paid per
+// working-set change, not per request.
+//
+// Model names resolve to <modelDir>/<name>.onnx. Size accounting uses
+// the on-disk model size — ONNX Runtime's resident footprint tracks it
+// closely enough for a budget knob. Only the inference thread calls
+// acquire(), so an acquired backend stays valid until the next acquire;
+// eviction can therefore never pull a model out from under a running
+// batch.
+class ModelCache {
+public:
+  // Empty modelDir disables per-name resolution: every model name maps
+  // to fallbackPath, or to the null backend when that is empty too
+  // (matching the previous single-model behaviour).
+  ModelCache(std::string modelDir, std::string fallbackPath,
+             size_t budgetBytes)
+      : modelDir_(std::move(modelDir)), fallbackPath_(std::move(fallbackPath)),
+        budgetBytes_(budgetBytes) {}
+
+  // Returns the resident backend for the named model, loading it first
+  // if needed. nullptr (with error set) when the model cannot be
+  // resolved or loaded; the caller fails the affected frames.
+  InferenceBackend *acquire(const std::string &model, std::string &error);
+
+  uint64_t hits() const;
+  uint64_t loads() const;
+  uint64_t evictions() const;
+  size_t residentBytes() const;
+
+private:
+  struct Entry {
+    std::unique_ptr<InferenceBackend> backend;
+    size_t bytes = 0;
+    uint64_t lastUsed = 0;
+  };
+
+  bool resolvePath(const std::string &model, std::string &path,
+                   std::string &error) const;
+  void evictTo(size_t targetBytes);
+
+  const std::string modelDir_;
+  const std::string fallbackPath_;
+  const size_t budgetBytes_;
+
+  mutable std::mutex mutex_;  // stats readers vs the inference thread
+  std::map<std::string, Entry> entries_;
+  size_t residentBytes_ = 0;
+  uint64_t useCounter_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t loads_ = 0;
+  uint64_t evictions_ = 0;
+};
+
+#endif // GATEWAY_MODEL_CACHE_H
@@ -0,0 +1,182 @@
+#include "ort_backend.h"
+
+#ifdef GATEWAY_WITH_ORT
+
+#include <cstring>
+
+#include <onnxruntime_cxx_api.h>
+
+#include "mapped_file.h"
+
+namespace {
+
+// YOLO ONNX export: input [N,3,640,640] float, output [N,84,8400]
+// (4 box coords + 80 class scores per candidate) for ultralytics v8,
+// decoded with the standard confidence filter + greedy NMS.
+constexpr int kInputSize = 640;
+constexpr float kNmsIou = 0.45f;
+
+float iou(const Detection &a, const Detection &b) {
+  const float x1 = std::max(a.x1, b.x1);
+  const float y1 = std::max(a.y1, b.y1);
+  const float x2 = std::min(a.x2, b.x2);
+  const float y2 = std::min(a.y2, b.y2);
+  const float inter = std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
+  const float areaA = (a.x2 - a.x1) * (a.y2 - a.y1);
+  const float areaB = (b.x2 - b.x1) * (b.y2 - b.y1);
+  return inter / (areaA + areaB - inter + 1e-6f);
+}
+
+class OrtBackend : public InferenceBackend {
+public:
+  OrtBackend() : env_(ORT_LOGGING_LEVEL_WARNING, "gateway") {}
+
+  bool load(const std::string &modelPath, std::string &error) {
+    // Weights come in through a prefaulted shared mapping instead of the
+    // path ctor's internal reads: across a restart the pages are still
+    // in the page cache, so the reload that used to cost minutes of
+    // disk time costs a page-table walk (see mapped_file.h). Assumes a
+    // self-contained .onnx — the from-memory ctor cannot resolve
+    // external-data sidecar files, and our exports do not use them.
+    if (!mapping_.map(modelPath, error)) {
+      return false;
+    }
+    try {
+      Ort::SessionOptions options;
+      options.SetIntraOpNumThreads(2);
+      // CUDA if the provider is available, silently CPU otherwise
+      OrtCUDAProviderOptions cuda = {};
+      try {
+        options.AppendExecutionProvider_CUDA(cuda);
+      } catch (const Ort::Exception &) {
+      }
+      session_ = std::make_unique<Ort::Session>(env_, mapping_.data(),
+                                                mapping_.size(), options);
+    } catch (const Ort::Exception &e) {
+      error = e.what();
+      return false;
+    }
+    Ort::AllocatorWithDefaultOptions allocator;
+    inputName_ = session_->GetInputNameAllocated(0, allocator).get();
+    outputName_ = session_->GetOutputNameAllocated(0, allocator).get();
+    return true;
+  }
+
+  const char *name() const override { return "onnxruntime"; }
+
+  bool runBatch(std::vector<Frame> &frames,
+                std::vector<std::vector<Detection>> &results,
+                std::string &error) override {
+    const int64_t batch = static_cast<int64_t>(frames.size());
+    const size_t frameFloats = 3u * kInputSize * kInputSize;
+    std::vector<float> input(batch * frameFloats);
+    for (int64_t i = 0; i < batch; i++) {
+      if (frames[i].tensor.size() != frameFloats) {
+        error = "frame missing preprocessed tensor";
+        return false;
+      }
+      memcpy(input.data() + i * frameFloats, frames[i].tensor.data(),
+             frameFloats * sizeof(float));
+    }
+
+    const int64_t shape[4] = {batch, 3, kInputSize, kInputSize};
+    Ort::MemoryInfo memory =
+        Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
+        memory, input.data(), input.size(), shape, 4);
+
+    const char *inputNames[] = {inputName_.c_str()};
+    const char *outputNames[] = {outputName_.c_str()};
+    std::vector<Ort::Value> outputs;
+    try {
+      outputs = session_->Run(Ort::RunOptions{}, inputNames, &inputTensor, 1,
+                              outputNames, 1);
+    } catch (const Ort::Exception &e) {
+      error = e.what();
+      return false;
+    }
+
+    const auto info = outputs[0].GetTensorTypeAndShapeInfo();
+    const auto outShape = info.GetShape();  // [batch, attrs, candidates]
+    const int64_t attrs = outShape[1];
+    const int64_t candidates = outShape[2];
+    const int64_t classes = attrs - 4;
+    const float *data = outputs[0].GetTensorData<float>();
+
+    results.assign(frames.size(), {});
+    for (int64_t b = 0; b < batch; b++) {
+      const float *out = data + b * attrs * candidates;
+      std::vector<Detection> kept;
+      for (int64_t c = 0; c < candidates; c++) {
+        // Best class for this candidate
+        float best = 0.0f;
+        int bestClass = 0;
+        for (int64_t k = 0; k < classes; k++) {
+          const float score = out[(4 + k) * candidates + c];
+          if (score > best) {
+            best = score;
+            bestClass = static_cast<int>(k);
+          }
+        }
+        if (best < frames[b].threshold) {
+          continue;
+        }
+        const float cx = out[0 * candidates + c];
+        const float cy = out[1 * candidates + c];
+        const float w = out[2 * candidates + c];
+        const float h = out[3 * candidates + c];
+        kept.push_back({cx - w / 2, cy - h / 2, cx + w / 2, cy + h / 2,
+                        best, bestClass});
+      }
+      // Greedy NMS, highest confidence first
+      std::sort(kept.begin(), kept.end(),
+                [](const Detection &a, const Detection &b) {
+                  return a.confidence > b.confidence;
+                });
+      std::vector<Detection> &final = results[b];
+      for (const Detection &candidate : kept) {
+        bool suppressed = false;
+        for (const Detection &existing : final) {
+          if (existing.classId == candidate.classId &&
+              iou(existing, candidate) > kNmsIou) {
+            suppressed = true;
+            break;
+          }
+        }
+        if (!suppressed) {
+          final.push_back(candidate);
+        }
+      }
+    }
+    return true;
+  }
+
+private:
+  Ort::Env env_;
+  MappedFile mapping_;  // must outlive session_ (declared first)
+  std::unique_ptr<Ort::Session> session_;
+  std::string inputName_;
+  std::string outputName_;
+};
+
+}  // namespace
+
+std::unique_ptr<InferenceBackend> createOrtBackend(const std::string &modelPath,
+                                                   std::string &error) {
+  auto backend = std::make_unique<OrtBackend>();
+  if (!backend->load(modelPath, error)) {
+    return nullptr;
+  }
+  return backend;
+}
+
+#else  // !GATEWAY_WITH_ORT
+
+std::unique_ptr<InferenceBackend> createOrtBackend(const std::string &,
+                                                   std::string &error) {
+  error = "gateway built without ONNX Runtime (configure with "
+          "-DGATEWAY_WITH_ORT=ON)";
+  return nullptr;
+}
+
+#endif  // GATEWAY_WITH_ORT
@@ -0,0 +1,17 @@
+#ifndef GATEWAY_ORT_BACKEND_H
+#define GATEWAY_ORT_BACKEND_H
+
+#include <memory>
+
+#include "inference_backend.h"
+
+// ONNX Runtime backend, compiled only when the gateway is configured
+// with -DGATEWAY_WITH_ORT=ON and onnxruntime is installed (it is not
+// vendored in this repo). Export the existing .pt models to .onnx with
+// ultralytics' `model.export(format="onnx")`.
+//
+// Returns nullptr when the model cannot be loaded.
+std::unique_ptr<InferenceBackend> createOrtBackend(const std::string &modelPath,
+                                                   std::string &error);
+
+#endif // GATEWAY_ORT_BACKEND_H
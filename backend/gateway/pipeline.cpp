@@ -0,0 +1,261 @@
+#include "pipeline.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "base64.h"
+#include "flat_json.h"
+#include "preprocess.h"
+
+namespace {
+
+int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Response in the same shape the Flask endpoint produces, so camera
+// firmware and the WebApp need no changes to point at the gateway
+std::string detectionResponse(const Frame &frame,
+                              const std::vector<Detection> &detections,
+                              double processingMs, size_t batchSize,
+                              const char *backendName) {
+  std::string body = "{\"detections\":[";
+  char item[160];
+  for (size_t i = 0; i < detections.size(); i++) {
+    const Detection &d = detections[i];
+    snprintf(item, sizeof(item),
+             "%s{\"bbox\":[%.1f,%.1f,%.1f,%.1f],\"confidence\":%.4f,"
+             "\"class_id\":%d}",
+             i == 0 ? "" : ",", d.x1, d.y1, d.x2, d.y2, d.confidence,
+             d.classId);
+    body += item;
+  }
+  snprintf(item, sizeof(item),
+           "],\"detection_count\":%zu,\"processing_time_ms\":%.2f,"
+           "\"batch_size\":%zu,\"model_used\":\"%s\",\"backend\":\"%s\","
+           "\"device_id\":\"%s\"}",
+           detections.size(), processingMs, batchSize, frame.model.c_str(),
+           backendName, frame.deviceId.c_str());
+  body += item;
+  return body;
+}
+
+}  // namespace
+
+void Pipeline::start(unsigned decodeWorkers) {
+  running_.store(true);
+  for (unsigned i = 0; i < decodeWorkers; i++) {
+    decodeThreads_.emplace_back(&Pipeline::decodeLoop, this);
+  }
+  inferenceThread_ = std::thread(&Pipeline::inferenceLoop, this);
+}
+
+void Pipeline::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  decodeCv_.notify_all();
+  batchCv_.notify_all();
+  for (std::thread &thread : decodeThreads_) {
+    thread.join();
+  }
+  decodeThreads_.clear();
+  if (inferenceThread_.joinable()) {
+    inferenceThread_.join();
+  }
+}
+
+void Pipeline::submit(HttpServer::Request &&request) {
+  {
+    std::lock_guard<std::mutex> lock(decodeMutex_);
+    decodeQueue_.push_back(std::move(request));
+  }
+  decodeCv_.notify_one();
+}
+
+void Pipeline::decodeLoop() {
+  while (true) {
+    HttpServer::Request request;
+    {
+      std::unique_lock<std::mutex> lock(decodeMutex_);
+      decodeCv_.wait(lock, [this] {
+        return !decodeQueue_.empty() || !running_.load();
+      });
+      if (!running_.load() && decodeQueue_.empty()) {
+        return;
+      }
+      request = std::move(decodeQueue_.front());
+      decodeQueue_.pop_front();
+    }
+
+    const char *body = request.body.c_str();
+    const size_t bodyLength = request.body.size();
+
+    const char *image;
+    size_t imageLength;
+    if (!flatJsonString(body, bodyLength, "image", image, imageLength)) {
+      server_.respond(request.connectionId, 400, "Bad Request",
+                      "{\"error\":\"No image provided\"}");
+      continue;
+    }
+
+    Frame frame;
+    frame.connectionId = request.connectionId;
+    frame.acceptedUs = request.acceptedUs;
+    if (!base64Decode(image, imageLength, frame.jpeg)) {
+      server_.respond(request.connectionId, 400, "Bad Request",
+                      "{\"error\":\"Invalid base64 image data\"}");
+      continue;
+    }
+
+    const char *value;
+    size_t valueLength;
+    frame.model = "fire_detection_final";
+    if (flatJsonString(body, bodyLength, "model", value, valueLength)) {
+      frame.model.assign(value, valueLength);
+    }
+    frame.deviceId = "unknown";
+    if (flatJsonString(body, bodyLength, "device_id", value, valueLength)) {
+      frame.deviceId.assign(value, valueLength);
+    }
+    double threshold;
+    if (flatJsonNumber(body, bodyLength, "threshold", threshold)) {
+      frame.threshold = static_cast<float>(threshold);
+    }
+
+    // Duplicate-frame short circuit, before any pixel work: static
+    // scenes repeat byte-identical JPEGs, and a fresh cached result
+    // answers them without decoding or running the model
+    frame.dedupKey =
+        DetectionCache::key(frame.jpeg, frame.model, frame.threshold);
+    std::vector<Detection> cached;
+    if (dedupCache_.lookup(frame.dedupKey, nowUs(), cached)) {
+      cacheHits_.fetch_add(1, std::memory_order_relaxed);
+      if (dedupHitsMetric_ != nullptr) {
+        dedupHitsMetric_->inc();
+      }
+      const double processingMs = (nowUs() - frame.acceptedUs) / 1000.0;
+      server_.respond(frame.connectionId, 200, "OK",
+                      detectionResponse(frame, cached, processingMs, 1,
+                                        "cache"));
+      continue;
+    }
+
+    // Decode + letterbox + normalize here, on the worker, so the
+    // inference thread only ever sees ready tensors
+    static thread_local Preprocessor::Arena arena;
+    if (!Preprocessor::run(frame, arena)) {
+      server_.respond(request.connectionId, 400, "Bad Request",
+                      "{\"error\":\"Invalid or corrupt JPEG image\"}");
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(batchMutex_);
+      batchQueues_[frame.model].push_back(std::move(frame));
+      queuedFrames_++;
+    }
+    batchCv_.notify_one();
+  }
+}
+
+void Pipeline::inferenceLoop() {
+  while (true) {
+    std::vector<Frame> batch;
+    {
+      std::unique_lock<std::mutex> lock(batchMutex_);
+      batchCv_.wait(lock,
+                    [this] { return queuedFrames_ > 0 || !running_.load(); });
+      if (!running_.load() && queuedFrames_ == 0) {
+        return;
+      }
+      // First frame opens the window; keep collecting until it closes
+      // or some queue could fill a batch. New frames may land on any
+      // model's queue during the wait — the queue is picked after.
+      const int64_t deadline = nowUs() + kBatchWindowUs;
+      while (queuedFrames_ > 0 && queuedFrames_ < kMaxBatch) {
+        const int64_t remaining = deadline - nowUs();
+        if (remaining <= 0) {
+          break;
+        }
+        batchCv_.wait_for(lock, std::chrono::microseconds(remaining));
+        if (!running_.load()) {
+          break;
+        }
+      }
+      // Drain the queue whose head frame has waited longest: fair
+      // across models and naturally sticky under a single-model load
+      auto pick = batchQueues_.end();
+      for (auto it = batchQueues_.begin(); it != batchQueues_.end(); ++it) {
+        if (it->second.empty()) {
+          continue;
+        }
+        if (pick == batchQueues_.end() ||
+            it->second.front().acceptedUs < pick->second.front().acceptedUs) {
+          pick = it;
+        }
+      }
+      if (pick == batchQueues_.end()) {
+        continue;
+      }
+      std::deque<Frame> &queue = pick->second;
+      const size_t take = std::min(queue.size(), kMaxBatch);
+      batch.assign(std::make_move_iterator(queue.begin()),
+                   std::make_move_iterator(queue.begin() + take));
+      queue.erase(queue.begin(), queue.begin() + take);
+      queuedFrames_ -= take;
+      if (queue.empty()) {
+        batchQueues_.erase(pick);
+      }
+    }
+    if (batch.empty()) {
+      continue;
+    }
+
+    std::string error;
+    InferenceBackend *backend = models_.acquire(batch.front().model, error);
+    if (backend == nullptr) {
+      for (const Frame &frame : batch) {
+        server_.respond(frame.connectionId, 500, "Internal Server Error",
+                        "{\"error\":\"" + error + "\"}");
+      }
+      continue;
+    }
+
+    const int64_t startUs = nowUs();
+    std::vector<std::vector<Detection>> results;
+    const bool ok = backend->runBatch(batch, results, error);
+    const int64_t doneUs = nowUs();
+    batchesRun_.fetch_add(1, std::memory_order_relaxed);
+    framesProcessed_.fetch_add(batch.size(), std::memory_order_relaxed);
+    if (framesMetric_ != nullptr) {
+      framesMetric_->inc(batch.size());
+      batchSizeMetric_->observe(static_cast<int64_t>(batch.size()));
+      inferUsMetric_->observe(doneUs - startUs);
+    }
+
+    for (size_t i = 0; i < batch.size(); i++) {
+      if (!ok) {
+        server_.respond(batch[i].connectionId, 500, "Internal Server Error",
+                        "{\"error\":\"" + error + "\"}");
+        continue;
+      }
+      dedupCache_.insert(batch[i].dedupKey, results[i], doneUs);
+      // processing_time reported like the Flask server: request arrival
+      // to inference done, so queue and batch wait are visible
+      const double processingMs = (doneUs - batch[i].acceptedUs) / 1000.0;
+      server_.respond(batch[i].connectionId, 200, "OK",
+                      detectionResponse(batch[i], results[i], processingMs,
+                                        batch.size(), backend->name()));
+      // Verdict push after the HTTP response is on its way: the camera
+      // never waits on the broker. Cache hits skip this — they follow a
+      // real inference inside the dedup window, whose push the cooldown
+      // already covers.
+      if (push_ != nullptr && !results[i].empty()) {
+        push_->notify(batch[i].deviceId, results[i], doneUs);
+      }
+    }
+  }
+}
@@ -0,0 +1,116 @@
+#ifndef GATEWAY_PIPELINE_H
+#define GATEWAY_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "command_push.h"
+#include "detection_cache.h"
+#include "http_server.h"
+#include "inference_backend.h"
+#include "metrics.h"
+#include "model_cache.h"
+
+// The gateway's three decoupled stages:
+//
+//   IO thread -> [decode pool] -> [batcher] -> model -> respond
+//
+// Decode workers turn request JSON (base64 image) into Frames in
+// parallel with inference. The batcher coalesces frames that arrive
+// within a short window into one model invocation — the trade at 30
+// cameras is a few ms of added latency for an order of magnitude more
+// GPU occupancy per invocation. Frames queue per model name, so a
+// batch is always single-model; the inference thread drains whichever
+// queue has waited longest and looks its backend up in the warm cache.
+// Decode workers consult the duplicate-frame cache before doing any
+// pixel work — byte-identical uploads within the dedup window answer
+// from the previous result without touching the model. Responses are
+// written from the inference thread (or the decode worker on a cache
+// hit); they are small and the sockets absorb them.
+class Pipeline {
+public:
+  // push may be null; when set, frames with detections fan out as
+  // device commands from the inference thread (see command_push.h).
+  // metrics may be null; when set, the hot paths feed scrape-exposed
+  // counters and histograms (relaxed atomics, see common/metrics.h).
+  Pipeline(HttpServer &server, ModelCache &models, int64_t dedupWindowUs,
+           CommandPush *push = nullptr, MetricsRegistry *metrics = nullptr)
+      : server_(server), models_(models), dedupCache_(dedupWindowUs),
+        push_(push) {
+    if (metrics != nullptr) {
+      framesMetric_ = metrics->counter(
+          "gateway_frames_total", "Frames run through the model");
+      dedupHitsMetric_ = metrics->counter(
+          "gateway_dedup_hits_total",
+          "Frames answered from the duplicate-frame cache");
+      batchSizeMetric_ = metrics->histogram(
+          "gateway_batch_size", "Frames per model invocation",
+          {1, 2, 4, 8, 16});
+      inferUsMetric_ = metrics->histogram(
+          "gateway_inference_us", "Model invocation wall time, microseconds",
+          {1000, 2000, 5000, 10000, 20000, 50000, 100000, 250000, 1000000});
+    }
+  }
+  ~Pipeline() { stop(); }
+
+  void start(unsigned decodeWorkers);
+  void stop();
+
+  // Called from the HTTP IO thread; parses and enqueues only
+  void submit(HttpServer::Request &&request);
+
+  uint64_t framesProcessed() const {
+    return framesProcessed_.load(std::memory_order_relaxed);
+  }
+  uint64_t batchesRun() const {
+    return batchesRun_.load(std::memory_order_relaxed);
+  }
+  uint64_t cacheHits() const {
+    return cacheHits_.load(std::memory_order_relaxed);
+  }
+
+  // Frames arriving within this window of the first queued frame ride
+  // in the same batch; beyond kMaxBatch the batch ships immediately
+  static constexpr int64_t kBatchWindowUs = 5000;
+  static constexpr size_t kMaxBatch = 16;
+
+private:
+  void decodeLoop();
+  void inferenceLoop();
+
+  HttpServer &server_;
+  ModelCache &models_;
+  DetectionCache dedupCache_;
+  CommandPush *push_;
+  std::atomic<bool> running_{false};
+
+  std::mutex decodeMutex_;
+  std::condition_variable decodeCv_;
+  std::deque<HttpServer::Request> decodeQueue_;
+  std::vector<std::thread> decodeThreads_;
+
+  std::mutex batchMutex_;
+  std::condition_variable batchCv_;
+  // One queue per model name; queuedFrames_ counts across all of them
+  std::map<std::string, std::deque<Frame>> batchQueues_;
+  size_t queuedFrames_ = 0;
+  std::thread inferenceThread_;
+
+  std::atomic<uint64_t> framesProcessed_{0};
+  std::atomic<uint64_t> batchesRun_{0};
+  std::atomic<uint64_t> cacheHits_{0};
+
+  // Scrape-exposed mirrors of the stats above plus the distributions
+  // the printf line cannot carry; null when metrics are off
+  MetricsRegistry::Counter *framesMetric_ = nullptr;
+  MetricsRegistry::Counter *dedupHitsMetric_ = nullptr;
+  MetricsRegistry::Histogram *batchSizeMetric_ = nullptr;
+  MetricsRegistry::Histogram *inferUsMetric_ = nullptr;
+};
+
+#endif // GATEWAY_PIPELINE_H
@@ -0,0 +1,39 @@
+#ifndef GATEWAY_PREPROCESS_H
+#define GATEWAY_PREPROCESS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "inference_backend.h"
+
+// JPEG decode + YOLO input preparation, run on the decode workers so it
+// overlaps GPU inference instead of serializing with it.
+//
+// - Decode goes through libjpeg-turbo, whose SIMD IDCT/color paths do
+//   the heavy lifting; the DCT scaler is asked for the smallest
+//   resolution still >= the model input, so a 1600x1200 upload never
+//   materializes at full size just to be shrunk again.
+// - Resize + normalize are fused: one pass bilinearly samples the
+//   decoded RGB and writes normalized floats directly into the frame's
+//   CHW tensor (ultralytics-style letterbox, gray padding), so there is
+//   no intermediate resized image at all.
+// - All scratch lives in a per-worker Arena that only ever grows —
+//   steady state does zero allocations per frame.
+class Preprocessor {
+public:
+  static constexpr int kInputSize = 640;
+  static constexpr float kPadGray = 114.0f / 255.0f;
+
+  // Per-worker scratch; pass the same instance for every frame a
+  // worker handles
+  struct Arena {
+    std::vector<uint8_t> rgb;       // decoded image, row-major RGB
+    std::vector<uint8_t *> rows;    // row pointers for libjpeg
+  };
+
+  // Decodes frame.jpeg and fills frame.tensor (3*640*640, CHW, 0..1)
+  // plus the original image dimensions. Returns false on broken JPEG.
+  static bool run(Frame &frame, Arena &arena);
+};
+
+#endif // GATEWAY_PREPROCESS_H
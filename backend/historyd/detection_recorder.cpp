@@ -0,0 +1,150 @@
+#include "detection_recorder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <sqlite3.h>
+
+namespace {
+
+// Same thresholds the dashboard applies when it classifies an event
+const char *alertLevel(bool detected, double confidence) {
+  if (!detected) return "NONE";
+  if (confidence > 0.8) return "CRITICAL";
+  if (confidence > 0.6) return "HIGH";
+  if (confidence > 0.4) return "MEDIUM";
+  return "LOW";
+}
+
+// Local-time ISO 8601 with milliseconds, matching the format
+// datetime.now().isoformat() writes so the dashboard's string-ordered
+// timestamp queries keep working on mixed rows
+void isoTimestamp(int64_t epochMs, char *out, size_t outSize) {
+  const time_t seconds = epochMs / 1000;
+  struct tm local;
+  localtime_r(&seconds, &local);
+  const size_t used = strftime(out, outSize, "%Y-%m-%dT%H:%M:%S", &local);
+  snprintf(out + used, outSize - used, ".%03d",
+           static_cast<int>(epochMs % 1000));
+}
+
+}  // namespace
+
+DetectionRecorder::~DetectionRecorder() { stop(); }
+
+bool DetectionRecorder::start(const std::string &dbPath, int flushIntervalMs,
+                              std::string &error) {
+  if (sqlite3_open(dbPath.c_str(), &db_) != SQLITE_OK) {
+    error = sqlite3_errmsg(db_);
+    return false;
+  }
+  // WAL: the writer appends to the log and readers (the dashboard) read
+  // the main file, so neither blocks the other; synchronous=NORMAL
+  // fsyncs on WAL checkpoints instead of every commit, which is the
+  // right durability trade for an event history
+  const char *setup =
+      "PRAGMA journal_mode=WAL;"
+      "PRAGMA synchronous=NORMAL;"
+      "PRAGMA busy_timeout=5000;"
+      "CREATE TABLE IF NOT EXISTS fire_detections ("
+      "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+      "  device_id TEXT NOT NULL,"
+      "  task TEXT NOT NULL DEFAULT 'fire',"
+      "  timestamp TEXT NOT NULL,"
+      "  fire_detected BOOLEAN NOT NULL,"
+      "  confidence REAL NOT NULL,"
+      "  bbox TEXT,"
+      "  image_size TEXT NOT NULL,"
+      "  processing_time_ms REAL NOT NULL,"
+      "  alert_level TEXT NOT NULL,"
+      "  image_data TEXT"
+      ");"
+      "CREATE INDEX IF NOT EXISTS idx_fire_detections_device_time"
+      "  ON fire_detections(device_id, timestamp);";
+  char *errMsg = nullptr;
+  if (sqlite3_exec(db_, setup, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+    error = errMsg != nullptr ? errMsg : "schema setup failed";
+    sqlite3_free(errMsg);
+    sqlite3_close(db_);
+    db_ = nullptr;
+    return false;
+  }
+
+  const char *insertSql =
+      "INSERT INTO fire_detections (device_id, task, timestamp,"
+      " fire_detected, confidence, bbox, image_size, processing_time_ms,"
+      " alert_level, image_data)"
+      " VALUES (?, ?, ?, ?, ?, NULL, '{}', ?, ?, NULL)";
+  if (sqlite3_prepare_v2(db_, insertSql, -1, &insert_, nullptr) != SQLITE_OK) {
+    error = sqlite3_errmsg(db_);
+    sqlite3_close(db_);
+    db_ = nullptr;
+    return false;
+  }
+
+  flushIntervalMs_ = flushIntervalMs;
+  running_ = true;
+  writer_ = std::thread(&DetectionRecorder::writerLoop, this);
+  return true;
+}
+
+void DetectionRecorder::writerLoop() {
+  while (running_) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(flushIntervalMs_));
+    if (!flushBatch()) {
+      fprintf(stderr, "historyd: batch commit failed: %s\n",
+              sqlite3_errmsg(db_));
+    }
+  }
+}
+
+// Drain everything currently queued into one transaction: one fsync
+// per interval however many events a storm delivers
+bool DetectionRecorder::flushBatch() {
+  DetectionEvent event;
+  bool inTransaction = false;
+  while (queue_.tryPop(event)) {
+    if (!inTransaction) {
+      if (sqlite3_exec(db_, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) !=
+          SQLITE_OK) {
+        return false;
+      }
+      inTransaction = true;
+    }
+    char timestamp[40];
+    isoTimestamp(event.receivedAtMs, timestamp, sizeof(timestamp));
+    sqlite3_reset(insert_);
+    sqlite3_bind_text(insert_, 1, event.deviceId, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(insert_, 2, event.task, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(insert_, 3, timestamp, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(insert_, 4, event.detected ? 1 : 0);
+    sqlite3_bind_double(insert_, 5, event.confidence);
+    sqlite3_bind_double(insert_, 6, event.processingMs);
+    sqlite3_bind_text(insert_, 7, alertLevel(event.detected, event.confidence),
+                      -1, SQLITE_STATIC);
+    if (sqlite3_step(insert_) != SQLITE_DONE) {
+      sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+      return false;
+    }
+    rowsWritten_++;
+  }
+  if (inTransaction &&
+      sqlite3_exec(db_, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+    sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+    return false;
+  }
+  return true;
+}
+
+void DetectionRecorder::stop() {
+  if (!running_) {
+    return;
+  }
+  running_ = false;
+  writer_.join();
+  flushBatch();  // whatever arrived after the last timed pass
+  sqlite3_finalize(insert_);
+  insert_ = nullptr;
+  sqlite3_close(db_);
+  db_ = nullptr;
+}
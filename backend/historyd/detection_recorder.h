@@ -0,0 +1,70 @@
+#ifndef HISTORYD_DETECTION_RECORDER_H
+#define HISTORYD_DETECTION_RECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "spsc_queue.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+// One detection alert as queued between the MQTT reader and the SQLite
+// writer thread. Fixed-size POD so the lock-free ring can copy it.
+struct DetectionEvent {
+  char deviceId[48];
+  char task[16];        // "fire" or "leaves", the dashboard's task names
+  bool detected;
+  double confidence;
+  double processingMs;
+  int64_t receivedAtMs; // unix epoch, stamps the timestamp column
+};
+
+// Batched writer for the dashboard's fire_detection_history.db.
+//
+// The Python dashboard commits one INSERT per detection with default
+// (rollback-journal) journaling — every event pays a full fsync, and at
+// alert-storm rates the writes fall behind and events are dropped. This
+// recorder opens the same database in WAL mode (readers never block the
+// writer, one fsync per batch instead of per row), accumulates events
+// in a lock-free SPSC ring and commits them in timed batches from a
+// dedicated thread. Schema matches the dashboard's CREATE TABLE
+// exactly, plus the (device_id, timestamp) index its history queries
+// scan by.
+class DetectionRecorder {
+public:
+  ~DetectionRecorder();
+
+  // Opens the database (WAL, schema, index) and starts the writer.
+  bool start(const std::string &dbPath, int flushIntervalMs,
+             std::string &error);
+
+  // Producer side (MQTT thread). Returns false when the ring is full,
+  // i.e. the disk cannot keep up even batched.
+  bool push(const DetectionEvent &event) { return queue_.tryPush(event); }
+
+  // Drains the ring, commits the final batch and closes the database.
+  void stop();
+
+  uint64_t rowsWritten() const {
+    return rowsWritten_.load(std::memory_order_relaxed);
+  }
+  uint64_t dropped() const { return queue_.dropped(); }
+  size_t queueDepth() const { return queue_.size(); }
+
+private:
+  void writerLoop();
+  bool flushBatch();
+
+  SpscQueue<DetectionEvent, 4096> queue_;
+  std::thread writer_;
+  sqlite3 *db_ = nullptr;
+  sqlite3_stmt *insert_ = nullptr;
+  int flushIntervalMs_ = 500;
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> rowsWritten_{0};
+};
+
+#endif // HISTORYD_DETECTION_RECORDER_H
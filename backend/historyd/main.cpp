@@ -0,0 +1,207 @@
+// historyd: native MQTT -> SQLite detection history recorder.
+//
+// Replaces the write path of YOLO-AI_Detection/fire_detection_dashboard.py
+// into fire_detection_history.db, which commits one INSERT per detection
+// with default journaling and falls behind (dropping events) at
+// alert-storm rates. This daemon subscribes to the camera detection
+// topics, queues decoded alerts in a lock-free ring and lands them in
+// timed WAL-mode batches (see detection_recorder.h) — one fsync per
+// interval instead of per event. The dashboard keeps the database open
+// read-only for its history queries; WAL means neither side blocks the
+// other.
+//
+// Usage:
+//   historyd [--broker host] [--port 1883] [--user u] [--password p]
+//            [--db YOLO-AI_Detection/fire_detection_history.db]
+//            [--flush-ms 500]
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "detection_recorder.h"
+#include "flat_json.h"
+#include "mqtt_consumer.h"
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t epochMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Options {
+  std::string broker = "127.0.0.1";
+  uint16_t port = 1883;
+  std::string user;
+  std::string password;
+  std::string dbPath = "YOLO-AI_Detection/fire_detection_history.db";
+  int flushMs = 500;
+};
+
+bool parseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--broker" && hasValue) {
+      options.broker = argv[++i];
+    } else if (arg == "--port" && hasValue) {
+      options.port = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--user" && hasValue) {
+      options.user = argv[++i];
+    } else if (arg == "--password" && hasValue) {
+      options.password = argv[++i];
+    } else if (arg == "--db" && hasValue) {
+      options.dbPath = argv[++i];
+    } else if (arg == "--flush-ms" && hasValue) {
+      options.flushMs = atoi(argv[++i]);
+    } else {
+      fprintf(stderr,
+              "usage: historyd [--broker host] [--port n] [--user u]\n"
+              "                [--password p] [--db path] [--flush-ms n]\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copy a flat-JSON string field into a fixed buffer, empty on absence
+void copyField(const char *json, size_t length, const char *key, char *out,
+               size_t outSize) {
+  const char *value = nullptr;
+  size_t valueLength = 0;
+  out[0] = '\0';
+  if (flatJsonString(json, length, key, value, valueLength)) {
+    if (valueLength >= outSize) {
+      valueLength = outSize - 1;
+    }
+    memcpy(out, value, valueLength);
+    out[valueLength] = '\0';
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  std::string error;
+  DetectionRecorder recorder;
+  if (!recorder.start(options.dbPath, options.flushMs, error)) {
+    fprintf(stderr, "historyd: sqlite: %s\n", error.c_str());
+    return 1;
+  }
+
+  MqttConsumer consumer;
+  consumer.setMessageHandler([&recorder](const std::string &topic,
+                                         const uint8_t *payload,
+                                         size_t length) {
+    const char *json = reinterpret_cast<const char *>(payload);
+    DetectionEvent event = {};
+    event.receivedAtMs = epochMs();
+
+    copyField(json, length, "device_id", event.deviceId,
+              sizeof(event.deviceId));
+    char alertClass[32];
+    copyField(json, length, "class", alertClass, sizeof(alertClass));
+    if (event.deviceId[0] == '\0' || alertClass[0] == '\0') {
+      return;  // not a detection alert
+    }
+    // The dashboard's task vocabulary: everything that is not fire is
+    // the leaf-disease model
+    snprintf(event.task, sizeof(event.task), "%s",
+             strcmp(alertClass, "fire") == 0 ? "fire" : "leaves");
+    // Devices only publish alerts for actual detections
+    event.detected = true;
+    flatJsonNumber(json, length, "confidence", event.confidence);
+    flatJsonNumber(json, length, "server_time_ms", event.processingMs);
+
+    if (!recorder.push(event)) {
+      fprintf(stderr, "historyd: queue full, event dropped\n");
+    }
+    (void)topic;
+  });
+
+  if (!consumer.connect(options.broker, options.port, "historyd",
+                        options.user, options.password, error) ||
+      !consumer.subscribe({"coreiot/+/ai_detections"}, error)) {
+    fprintf(stderr, "historyd: mqtt: %s\n", error.c_str());
+    return 1;
+  }
+  printf("historyd: connected to %s:%u, recording to %s every %dms\n",
+         options.broker.c_str(), options.port, options.dbPath.c_str(),
+         options.flushMs);
+
+  const int epollFd = epoll_create1(0);
+  const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+  struct itimerspec interval = {};
+  interval.it_interval.tv_sec = 1;
+  interval.it_value.tv_sec = 1;
+  timerfd_settime(timerFd, 0, &interval, nullptr);
+
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = consumer.fd();
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+  event.data.fd = timerFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+
+  uint64_t lastReported = 0;
+  while (!shuttingDown) {
+    struct epoll_event events[8];
+    const int ready = epoll_wait(epollFd, events, 8, 1000);
+    for (int i = 0; i < ready; i++) {
+      if (events[i].data.fd == consumer.fd()) {
+        if (!consumer.onReadable()) {
+          fprintf(stderr, "historyd: broker connection lost, reconnecting\n");
+          epoll_ctl(epollFd, EPOLL_CTL_DEL, consumer.fd(), nullptr);
+          while (!shuttingDown &&
+                 (!consumer.connect(options.broker, options.port, "historyd",
+                                    options.user, options.password, error) ||
+                  !consumer.subscribe({"coreiot/+/ai_detections"}, error))) {
+            fprintf(stderr, "historyd: %s, retrying\n", error.c_str());
+            sleep(2);
+          }
+          event.events = EPOLLIN;
+          event.data.fd = consumer.fd();
+          epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+        }
+      } else if (events[i].data.fd == timerFd) {
+        uint64_t expirations;
+        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+        }
+        consumer.tick(epochMs());
+        if (recorder.rowsWritten() - lastReported >= 100) {
+          lastReported = recorder.rowsWritten();
+          printf("historyd: %llu rows written, %llu dropped, queue depth %zu\n",
+                 (unsigned long long)recorder.rowsWritten(),
+                 (unsigned long long)recorder.dropped(),
+                 recorder.queueDepth());
+        }
+      }
+    }
+  }
+
+  printf("historyd: shutting down, committing final batch\n");
+  recorder.stop();
+  consumer.close();
+  close(timerFd);
+  close(epollFd);
+  return 0;
+}
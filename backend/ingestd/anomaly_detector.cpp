@@ -0,0 +1,92 @@
+#include "anomaly_detector.h"
+
+#include <cmath>
+
+namespace {
+
+// Indexed by Metric. maxRatePerSec 0 disables the slope check;
+// noiseFloor keeps a dead-flat series from alerting on quantization
+struct MetricLimits {
+  float maxRatePerSec;
+  float noiseFloor;
+};
+
+const MetricLimits kLimits[] = {
+    {2.0f, 0.5f},    // temperature: °C/s, °C
+    {10.0f, 2.0f},   // humidity: %/s, %
+    {0.0f, 50.0f},   // light: shadows step legitimately
+};
+
+const char *kMetricNames[] = {"temperature", "humidity", "light"};
+
+}  // namespace
+
+const char *AnomalyDetector::metricName(Metric metric) {
+  return kMetricNames[static_cast<size_t>(metric)];
+}
+
+const char *AnomalyDetector::kindName(Kind kind) {
+  return kind == Kind::Spike ? "spike" : "rate_of_change";
+}
+
+void AnomalyDetector::raise(Slot &slot, const Alert &alert, int64_t nowMs) {
+  if (nowMs - slot.lastAlertMs < kAlertIntervalMs) {
+    return;
+  }
+  slot.lastAlertMs = nowMs;
+  alertsRaised_++;
+  if (handler_) {
+    handler_(alert);
+  }
+}
+
+void AnomalyDetector::observe(const TelemetrySample &sample) {
+  if (sample.deviceId < 0 || sample.deviceId >= kMaxDevices) {
+    return;
+  }
+  Slot &slot = slots_[sample.deviceId * static_cast<int>(Metric::COUNT) +
+                      static_cast<int>(sample.metric)];
+  const MetricLimits &limits = kLimits[static_cast<size_t>(sample.metric)];
+  const float value = static_cast<float>(sample.value);
+
+  // Slope first: it compares consecutive readings, so it needs no
+  // warm-up and catches a wildly wrong first-ever spike too
+  if (limits.maxRatePerSec > 0.0f && slot.samples > 0 &&
+      sample.sampledAtMs > slot.lastSampleMs) {
+    const float rate = std::fabs(value - slot.lastValue) * 1000.0f /
+                       (sample.sampledAtMs - slot.lastSampleMs);
+    if (rate > limits.maxRatePerSec) {
+      raise(slot,
+            {sample.deviceId, sample.metric, Kind::RateOfChange, sample.value,
+             slot.lastValue, rate},
+            sample.sampledAtMs);
+    }
+  }
+
+  const float deviation = value - slot.ewma;
+  if (slot.samples >= kWarmupSamples) {
+    const float sigma = std::sqrt(slot.ewmaVar);
+    const float limit = kSigmaLimit * sigma + limits.noiseFloor;
+    if (std::fabs(deviation) > limit) {
+      raise(slot,
+            {sample.deviceId, sample.metric, Kind::Spike, sample.value,
+             slot.ewma, sigma > 0.0f ? std::fabs(deviation) / sigma : 0.0},
+            sample.sampledAtMs);
+      // The outlier still feeds the statistics below: a genuine level
+      // shift stops alerting once the mean converges (~a minute at the
+      // 2s cadence), a one-off glitch nudges it imperceptibly
+    }
+  }
+
+  if (slot.samples == 0) {
+    slot.ewma = value;
+  } else {
+    // Exponentially weighted mean and variance in one pass
+    slot.ewma += kAlpha * deviation;
+    slot.ewmaVar =
+        (1.0f - kAlpha) * (slot.ewmaVar + kAlpha * deviation * deviation);
+  }
+  slot.samples++;
+  slot.lastValue = value;
+  slot.lastSampleMs = sample.sampledAtMs;
+}
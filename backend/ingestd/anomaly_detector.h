@@ -0,0 +1,78 @@
+#ifndef INGESTD_ANOMALY_DETECTOR_H
+#define INGESTD_ANOMALY_DETECTOR_H
+
+#include <cstdint>
+#include <functional>
+
+#include "telemetry_sample.h"
+
+// Streaming anomaly detection on the ingest path: every decoded sample
+// updates per-device rolling statistics and can raise an alert in the
+// same call, so a stuck sensor or a runaway reading is flagged within
+// one sample period instead of whenever someone next looks at a chart.
+//
+// Two detectors per (device, metric):
+//  - Spike: exponentially weighted mean and variance; a reading more
+//    than kSigmaLimit standard deviations from the mean (with a small
+//    absolute floor so flat series do not alert on sensor noise) after
+//    warm-up is anomalous.
+//  - Rate of change: a physically impossible slope between consecutive
+//    readings (a greenhouse cannot warm 2°C/s; a sensor fault or a
+//    fire can). Light is exempt — a shadow is a legitimate step.
+//
+// State lives in a flat array of 32-byte slots indexed by
+// deviceId * Metric::COUNT + metric — two slots per cache line, no
+// hashing or pointer chasing on the hot path. Device ids at or above
+// kMaxDevices (the binary frame id is a uint8) skip detection.
+//
+// Single-threaded by design: called only from the MQTT reader, like
+// the rest of the decode path. Alerts are rate-limited per slot.
+class AnomalyDetector {
+public:
+  enum class Kind : uint8_t { Spike, RateOfChange };
+
+  struct Alert {
+    int32_t deviceId;
+    Metric metric;
+    Kind kind;
+    double value;
+    double expected;  // EWMA (Spike) or previous value (RateOfChange)
+    double score;     // sigmas from mean, or units per second
+  };
+  using AlertHandler = std::function<void(const Alert &)>;
+
+  void setAlertHandler(AlertHandler handler) { handler_ = std::move(handler); }
+
+  // Update statistics for the sample and raise at most one alert
+  void observe(const TelemetrySample &sample);
+
+  uint64_t alertsRaised() const { return alertsRaised_; }
+
+  static const char *metricName(Metric metric);
+  static const char *kindName(Kind kind);
+
+private:
+  struct Slot {
+    float ewma = 0.0f;
+    float ewmaVar = 0.0f;
+    float lastValue = 0.0f;
+    uint32_t samples = 0;
+    int64_t lastSampleMs = 0;
+    int64_t lastAlertMs = 0;
+  };
+  static_assert(sizeof(Slot) == 32, "two slots per cache line");
+
+  static constexpr int kMaxDevices = 256;
+  static constexpr float kAlpha = 0.05f;       // ~20-sample memory
+  static constexpr float kSigmaLimit = 4.0f;
+  static constexpr uint32_t kWarmupSamples = 16;
+  static constexpr int64_t kAlertIntervalMs = 60 * 1000;
+
+  void raise(Slot &slot, const Alert &alert, int64_t nowMs);
+
+  Slot slots_[kMaxDevices * static_cast<int>(Metric::COUNT)];
+  AlertHandler handler_;
+  uint64_t alertsRaised_ = 0;
+};
+
+#endif // INGESTD_ANOMALY_DETECTOR_H
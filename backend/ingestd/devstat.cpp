@@ -0,0 +1,73 @@
+// devstat: read-side companion to the shared-memory device registry
+// ingestd maintains (common/device_registry.h).
+//
+// Maps the segment read-only and prints device state as JSON — one
+// object with "devstat <id>", the full array with no argument. The
+// web/API processes call this instead of parsing device_status.json;
+// the lookup itself is lock-free against the live writer, so the cost
+// is process startup, not I/O.
+//
+// Usage:
+//   devstat [--registry /iot_farming_devices] [device-id]
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "device_registry.h"
+
+namespace {
+
+void printRecord(const DeviceRecord &record, bool first) {
+  printf("%s{\"id\":\"%s\",\"lastSeenMs\":%lld,\"messages\":%llu,"
+         "\"temperature\":%.2f,\"humidity\":%.2f,\"light\":%.1f,"
+         "\"moisture\":%.1f}",
+         first ? "" : ",", record.id, (long long)record.lastSeenMs,
+         (unsigned long long)record.messages, record.temperature,
+         record.humidity, record.light, record.moisture);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string name = "/iot_farming_devices";
+  std::string deviceId;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--registry" && i + 1 < argc) {
+      name = argv[++i];
+    } else if (arg[0] != '-' && deviceId.empty()) {
+      deviceId = arg;
+    } else {
+      fprintf(stderr, "usage: devstat [--registry /shm-name] [device-id]\n");
+      return 1;
+    }
+  }
+
+  DeviceRegistry registry;
+  std::string error;
+  if (!registry.openReader(name, error)) {
+    fprintf(stderr, "devstat: %s\n", error.c_str());
+    return 1;
+  }
+
+  if (!deviceId.empty()) {
+    DeviceRecord record;
+    if (!registry.read(deviceId.c_str(), record)) {
+      fprintf(stderr, "devstat: unknown device %s\n", deviceId.c_str());
+      return 2;
+    }
+    printRecord(record, true);
+    printf("\n");
+    return 0;
+  }
+
+  printf("[");
+  bool first = true;
+  registry.forEach([&first](const DeviceRecord &record) {
+    printRecord(record, first);
+    first = false;
+  });
+  printf("]\n");
+  return 0;
+}
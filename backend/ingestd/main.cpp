@@ -0,0 +1,488 @@
+// ingestd: native MQTT -> Postgres ingestion daemon.
+//
+// Replaces the hot path of back/server.py, which inserts one row per
+// telemetry message and is GIL-bound at our 50-node scale. This daemon
+// runs an epoll loop around a zero-dependency MQTT consumer and fans
+// each decoded reading through a sector-sharded pool of writer threads
+// (see writer_pool.h) that land batches in Postgres with multi-row
+// COPY. The Python server stays up for the admin/REST endpoints only.
+//
+// Accepts both telemetry encodings the firmware can produce: the JSON
+// object from publishBufferedRecord and the 20-byte packed frame from
+// platformio/src/telemetry_frame.h.
+//
+// Usage:
+//   ingestd [--broker host] [--port 1883] [--user u] [--password p]
+//           [--device-id 1] [--db back/database.ini] [--shards 4]
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "anomaly_detector.h"
+#include "database_ini.h"
+#include "device_registry.h"
+#include "flat_json.h"
+#include "lzss.h"
+#include "metrics.h"
+#include "mqtt_consumer.h"
+#include "telemetry_sample.h"
+#include "udp_burst_receiver.h"
+#include "wal.h"
+#include "writer_pool.h"
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t epochMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Mirror of the packed frame in platformio/src/telemetry_frame.h
+struct __attribute__((packed)) TelemetryFrame {
+  uint8_t version;
+  uint8_t deviceId;
+  uint16_t sequence;
+  uint32_t uptimeMs;
+  uint32_t ageMs;
+  int16_t temperatureCenti;
+  uint16_t humidityCenti;
+  uint16_t light;
+  uint16_t moisture;
+};
+constexpr uint8_t kFrameVersion = 1;
+
+struct Options {
+  std::string broker = "127.0.0.1";
+  uint16_t port = 1883;
+  std::string user;
+  std::string password;
+  std::string dbIni = "back/database.ini";
+  int32_t deviceId = 1;  // JSON telemetry carries no device id
+  unsigned shards = 4;   // sector-hashed writer shards
+  uint16_t udpPort = 18884;  // udp_burst fast path; 0 disables
+  uint16_t metricsPort = 9101;  // /metrics scrape listener; 0 disables
+  // Shared-subscription group: when set, the telemetry subscriptions go
+  // out as $share/<group>/<topic>, so N ingestd instances in the same
+  // group split the device firehose with broker-managed balancing
+  // (brokerd implements the convention; MQTT 5 brokers have it native).
+  // Each instance still writes every row it receives — the split is by
+  // message, so point the instances at the same database. Empty keeps
+  // the classic exclusive subscription.
+  std::string shareGroup;
+  // Shared-memory device registry (see common/device_registry.h);
+  // empty name disables it. The snapshot file is the on-disk fallback
+  // for readers that cannot map the segment.
+  std::string registryName = "/iot_farming_devices";
+  std::string registrySnapshot = "back/device_registry.json";
+  int snapshotSeconds = 10;
+  // Memory-mapped WAL between broker and writers (see wal.h); with it
+  // enabled the telemetry subscribe moves to QoS 1 and each PUBLISH is
+  // acknowledged only after its samples are in the log. Empty path
+  // disables the log and restores the direct push.
+  std::string walPath = "back/ingest.wal";
+  uint32_t walRecords = 1u << 20;  // ~32MiB, hours of full-rate backlog
+};
+
+bool parseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--broker" && hasValue) {
+      options.broker = argv[++i];
+    } else if (arg == "--port" && hasValue) {
+      options.port = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--user" && hasValue) {
+      options.user = argv[++i];
+    } else if (arg == "--password" && hasValue) {
+      options.password = argv[++i];
+    } else if (arg == "--db" && hasValue) {
+      options.dbIni = argv[++i];
+    } else if (arg == "--device-id" && hasValue) {
+      options.deviceId = atoi(argv[++i]);
+    } else if (arg == "--shards" && hasValue) {
+      options.shards = static_cast<unsigned>(atoi(argv[++i]));
+    } else if (arg == "--udp-port" && hasValue) {
+      options.udpPort = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--metrics-port" && hasValue) {
+      options.metricsPort = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--share-group" && hasValue) {
+      options.shareGroup = argv[++i];
+    } else if (arg == "--registry" && hasValue) {
+      options.registryName = argv[++i];
+    } else if (arg == "--registry-snapshot" && hasValue) {
+      options.registrySnapshot = argv[++i];
+    } else if (arg == "--wal" && hasValue) {
+      options.walPath = argv[++i];
+    } else if (arg == "--wal-records" && hasValue) {
+      options.walRecords = static_cast<uint32_t>(atoi(argv[++i]));
+    } else {
+      fprintf(stderr,
+              "usage: ingestd [--broker host] [--port n] [--user u]\n"
+              "               [--password p] [--device-id n] [--db ini]\n"
+              "               [--shards n] [--udp-port n] [--metrics-port n]\n"
+              "               [--share-group g]\n"
+              "               [--registry /shm-name] [--registry-snapshot f]\n"
+              "               [--wal file] [--wal-records n]\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  std::string conninfo;
+  std::string error;
+  if (!conninfoFromIni(options.dbIni, conninfo, error)) {
+    fprintf(stderr, "ingestd: %s\n", error.c_str());
+    return 1;
+  }
+
+  WriterPool pool;
+  if (!pool.start(conninfo, options.shards, error)) {
+    fprintf(stderr, "ingestd: postgres: %s\n", error.c_str());
+    return 1;
+  }
+
+  AnomalyDetector detector;
+
+  // Status registry: web/API processes map the same segment read-only
+  // and look devices up without touching a file (back/device_status.json
+  // was parsed and rewritten wholesale per update before this)
+  DeviceRegistry registry;
+  DeviceRegistry *registryPtr = nullptr;
+  if (!options.registryName.empty()) {
+    if (!registry.openWriter(options.registryName, error)) {
+      fprintf(stderr, "ingestd: registry: %s\n", error.c_str());
+      return 1;
+    }
+    registryPtr = &registry;
+  }
+
+  // Crash-safe hand-off: samples land in the mapped log before the
+  // PUBLISH is acknowledged, and the drain thread feeds the writer pool
+  // at whatever pace Postgres sustains — with retry instead of the
+  // drop-on-full contract, since the log absorbs the backlog
+  TelemetryWal wal;
+  TelemetryWal *walPtr = nullptr;
+  if (!options.walPath.empty()) {
+    if (!wal.open(options.walPath, options.walRecords, error)) {
+      fprintf(stderr, "ingestd: wal: %s\n", error.c_str());
+      return 1;
+    }
+    if (wal.recovered() > 0) {
+      printf("ingestd: wal: replaying %llu records from %s\n",
+             (unsigned long long)wal.recovered(), options.walPath.c_str());
+    }
+    wal.startDrain(
+        [&pool](const TelemetrySample &sample) { return pool.push(sample); });
+    walPtr = &wal;
+  }
+
+  // Scrape-side mirror of the numbers the stats printf already tracks
+  // (see common/metrics.h). The consumer, pool and WAL keep their own
+  // relaxed-atomic counters on the hot path; the once-a-second tick
+  // copies the deltas across, so the ingest path itself is untouched.
+  MetricsRegistry metrics;
+  MetricsRegistry::Counter *messagesMetric = metrics.counter(
+      "ingest_messages_total", "MQTT telemetry messages received");
+  MetricsRegistry::Counter *rowsMetric = metrics.counter(
+      "ingest_rows_total", "Rows landed in Postgres via COPY");
+  MetricsRegistry::Counter *droppedMetric = metrics.counter(
+      "ingest_dropped_total", "Samples dropped by a full queue or WAL ring");
+  MetricsRegistry::Gauge *queueMetric = metrics.gauge(
+      "ingest_queue_depth", "Samples queued toward the writer shards");
+  MetricsRegistry::Gauge *walMetric = metrics.gauge(
+      "ingest_wal_backlog", "WAL records appended but not yet drained");
+
+  MqttConsumer consumer;
+  const int32_t deviceId = options.deviceId;
+  consumer.setMessageHandler([&pool, &detector, registryPtr, walPtr, deviceId](
+                                 const std::string &topic,
+                                 const uint8_t *payload, size_t length) {
+    // "/lz" variants carry the same encoding LZSS-compressed (the
+    // firmware compresses batches above its size threshold); decode and
+    // continue on the plain bytes.
+    std::vector<uint8_t> decompressed;
+    if (topic.size() > 3 && topic.compare(topic.size() - 3, 3, "/lz") == 0) {
+      if (!lzssDecompress(payload, length, decompressed)) {
+        fprintf(stderr, "ingestd: corrupt compressed payload on %s\n",
+                topic.c_str());
+        return;
+      }
+      payload = decompressed.data();
+      length = decompressed.size();
+    }
+    // Statistics update and anomaly check ride along with the push, so
+    // an alert goes out before the sample even reaches a writer queue.
+    // With the WAL enabled the sample goes to the log instead of the
+    // pool; the drain thread pushes it from there.
+    auto ingest = [&pool, &detector, walPtr](const TelemetrySample &sample) {
+      detector.observe(sample);
+      if (walPtr != nullptr) {
+        walPtr->append(sample);  // full ring counts the drop itself
+      } else {
+        pool.push(sample);
+      }
+    };
+    const int64_t now = epochMs();
+    double ageMs = 0.0;
+
+    if (length == sizeof(TelemetryFrame) &&
+        payload[0] == kFrameVersion) {
+      // Binary frame path: fixed offsets, no parsing at all
+      TelemetryFrame frame;
+      memcpy(&frame, payload, sizeof(frame));
+      const int64_t sampledAt = now - frame.ageMs;
+      ingest({Metric::Temperature, frame.deviceId,
+              frame.temperatureCenti / 100.0, sampledAt});
+      ingest({Metric::Humidity, frame.deviceId,
+              frame.humidityCenti / 100.0, sampledAt});
+      ingest({Metric::Light, frame.deviceId,
+              static_cast<double>(frame.light), sampledAt});
+      if (registryPtr != nullptr) {
+        char id[32];
+        snprintf(id, sizeof(id), "device-%u", frame.deviceId);
+        registryPtr->heartbeat(id, sampledAt, frame.temperatureCenti / 100.0,
+                               frame.humidityCenti / 100.0, frame.light,
+                               frame.moisture);
+      }
+      return;
+    }
+
+    const char *json = reinterpret_cast<const char *>(payload);
+    flatJsonNumber(json, length, "ageMs", ageMs);
+    const int64_t sampledAt = now - static_cast<int64_t>(ageMs);
+    double value = 0.0;
+    double temperature = NAN, humidity = NAN, light = NAN, moisture = NAN;
+    if (flatJsonNumber(json, length, "temperature", value)) {
+      ingest({Metric::Temperature, deviceId, value, sampledAt});
+      temperature = value;
+    }
+    if (flatJsonNumber(json, length, "humidity", value)) {
+      ingest({Metric::Humidity, deviceId, value, sampledAt});
+      humidity = value;
+    }
+    if (flatJsonNumber(json, length, "light", value)) {
+      ingest({Metric::Light, deviceId, value, sampledAt});
+      light = value;
+    }
+    // moisture has no Data_* table yet; registry-only from here on
+    if (flatJsonNumber(json, length, "moisture", value)) {
+      moisture = value;
+    }
+    if (registryPtr != nullptr) {
+      char id[32];
+      snprintf(id, sizeof(id), "device-%d", deviceId);
+      registryPtr->heartbeat(id, sampledAt, temperature, humidity, light,
+                             moisture);
+    }
+    (void)topic;
+  });
+
+  detector.setAlertHandler([&consumer](const AnomalyDetector::Alert &alert) {
+    char body[224];
+    snprintf(body, sizeof(body),
+             "{\"deviceId\":%d,\"metric\":\"%s\",\"kind\":\"%s\","
+             "\"value\":%.4f,\"expected\":%.4f,\"score\":%.2f}",
+             alert.deviceId, AnomalyDetector::metricName(alert.metric),
+             AnomalyDetector::kindName(alert.kind), alert.value,
+             alert.expected, alert.score);
+    // Same connection the telemetry arrives on; QoS 0 is fine — the
+    // alert repeats every minute while the condition holds
+    consumer.publish("coreiot/alerts", body);
+    fprintf(stderr, "ingestd: alert %s\n", body);
+  });
+
+  // Scaled-out instances need distinct client ids or a spec-following
+  // broker kicks the earlier connection when the next one arrives
+  const std::string clientId =
+      options.shareGroup.empty() ? "ingestd"
+                                 : "ingestd-" + std::to_string(getpid());
+  if (!consumer.connect(options.broker, options.port, clientId,
+                        options.user, options.password, error)) {
+    fprintf(stderr, "ingestd: mqtt: %s\n", error.c_str());
+    return 1;
+  }
+  // With the WAL in the path, QoS 1 makes the hand-off crash-safe: the
+  // consumer PUBACKs only after the handler appended to the log
+  const uint8_t subscribeQos = walPtr != nullptr ? 1 : 0;
+  // Built once so the initial subscribe and every reconnect agree; the
+  // $share prefix is pure topic-filter syntax, the messages themselves
+  // arrive on the plain topics the handler keys on
+  std::vector<std::string> subscriptions = {"v1/devices/me/telemetry",
+                                            "v1/devices/me/telemetry/bin",
+                                            "v1/devices/me/telemetry/lz",
+                                            "coreiot/gateway/telemetry",
+                                            "coreiot/gateway/telemetry/lz"};
+  if (!options.shareGroup.empty()) {
+    for (std::string &topic : subscriptions) {
+      topic = "$share/" + options.shareGroup + "/" + topic;
+    }
+  }
+  if (!consumer.subscribe(subscriptions, error, subscribeQos)) {
+    fprintf(stderr, "ingestd: mqtt: %s\n", error.c_str());
+    return 1;
+  }
+  printf("ingestd: connected to %s:%u, writing to %s across %u shards%s%s\n",
+         options.broker.c_str(), options.port, options.dbIni.c_str(),
+         pool.shardCount(),
+         options.shareGroup.empty() ? "" : ", share group ",
+         options.shareGroup.c_str());
+
+  // High-rate UDP sampling fast path: burst series land in per-session
+  // CSVs next to the daemon, not in Postgres (see udp_burst_receiver.h)
+  UdpBurstReceiver burstReceiver;
+  if (options.udpPort != 0) {
+    if (!burstReceiver.open(options.udpPort, error)) {
+      fprintf(stderr, "ingestd: udp: %s\n", error.c_str());
+      return 1;
+    }
+    printf("ingestd: burst receiver on udp port %u\n", options.udpPort);
+  }
+
+  int metricsFd = -1;
+  if (options.metricsPort != 0) {
+    metricsFd = metricsListen(options.metricsPort);
+    if (metricsFd < 0) {
+      fprintf(stderr, "ingestd: metrics listener on :%u failed, disabled\n",
+              options.metricsPort);
+    } else {
+      printf("ingestd: metrics on :%u\n", options.metricsPort);
+    }
+  }
+
+  const int epollFd = epoll_create1(0);
+  const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+  struct itimerspec interval = {};
+  interval.it_interval.tv_sec = 1;
+  interval.it_value.tv_sec = 1;
+  timerfd_settime(timerFd, 0, &interval, nullptr);
+
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = consumer.fd();
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+  event.data.fd = timerFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+  if (burstReceiver.fd() >= 0) {
+    event.data.fd = burstReceiver.fd();
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, burstReceiver.fd(), &event);
+  }
+  if (metricsFd >= 0) {
+    event.data.fd = metricsFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, metricsFd, &event);
+  }
+
+  uint64_t lastReported = 0;
+  uint64_t metricMessages = 0;
+  uint64_t metricRows = 0;
+  uint64_t metricDropped = 0;
+  int ticksSinceSnapshot = 0;
+  while (!shuttingDown) {
+    struct epoll_event events[8];
+    const int ready = epoll_wait(epollFd, events, 8, 1000);
+    for (int i = 0; i < ready; i++) {
+      if (events[i].data.fd == consumer.fd()) {
+        if (!consumer.onReadable()) {
+          fprintf(stderr, "ingestd: broker connection lost, reconnecting\n");
+          epoll_ctl(epollFd, EPOLL_CTL_DEL, consumer.fd(), nullptr);
+          while (!shuttingDown &&
+                 (!consumer.connect(options.broker, options.port, clientId,
+                                    options.user, options.password, error) ||
+                  !consumer.subscribe(subscriptions, error, subscribeQos))) {
+            fprintf(stderr, "ingestd: %s, retrying\n", error.c_str());
+            sleep(2);
+          }
+          event.events = EPOLLIN;
+          event.data.fd = consumer.fd();
+          epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+        }
+      } else if (metricsFd >= 0 && events[i].data.fd == metricsFd) {
+        metricsHandle(metricsFd, metrics);
+      } else if (events[i].data.fd == burstReceiver.fd()) {
+        burstReceiver.onReadable();
+      } else if (events[i].data.fd == timerFd) {
+        uint64_t expirations;
+        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+        }
+        consumer.tick(epochMs());
+        burstReceiver.tick(epochMs());
+        if (walPtr != nullptr) {
+          // Group durability point for appends since the last one
+          walPtr->sync(false);
+        }
+        if (registryPtr != nullptr &&
+            ++ticksSinceSnapshot >= options.snapshotSeconds) {
+          ticksSinceSnapshot = 0;
+          if (!registry.snapshotTo(options.registrySnapshot)) {
+            fprintf(stderr, "ingestd: registry snapshot to %s failed\n",
+                    options.registrySnapshot.c_str());
+          }
+        }
+        // Advance the scrape counters by deltas so they track the
+        // components' own totals exactly
+        messagesMetric->inc(consumer.messagesReceived() - metricMessages);
+        metricMessages = consumer.messagesReceived();
+        rowsMetric->inc(pool.rowsWritten() - metricRows);
+        metricRows = pool.rowsWritten();
+        const uint64_t droppedNow =
+            pool.dropped() + (walPtr ? walPtr->dropped() : 0);
+        droppedMetric->inc(droppedNow - metricDropped);
+        metricDropped = droppedNow;
+        queueMetric->set(static_cast<int64_t>(pool.queueDepth()));
+        walMetric->set(
+            walPtr ? static_cast<int64_t>(walPtr->backlog()) : 0);
+        if (consumer.messagesReceived() - lastReported >= 1000) {
+          lastReported = consumer.messagesReceived();
+          const uint64_t flushes = pool.flushes();
+          printf("ingestd: %llu msgs in, %llu rows out (%.1f rows/copy), "
+                 "%llu dropped, queue depth %zu, wal backlog %zu\n",
+                 (unsigned long long)consumer.messagesReceived(),
+                 (unsigned long long)pool.rowsWritten(),
+                 flushes > 0 ? (double)pool.rowsWritten() / flushes : 0.0,
+                 (unsigned long long)(pool.dropped() +
+                                      (walPtr ? walPtr->dropped() : 0)),
+                 pool.queueDepth(), walPtr ? walPtr->backlog() : 0);
+        }
+      }
+    }
+  }
+
+  printf("ingestd: shutting down, draining queues\n");
+  // Stop the WAL drain first so the pool's final flush sees everything
+  // it managed to hand over; whatever is left in the log replays on the
+  // next start
+  wal.stop();
+  pool.stop();
+  burstReceiver.close();
+  consumer.close();
+  if (metricsFd >= 0) {
+    close(metricsFd);
+  }
+  close(timerFd);
+  close(epollFd);
+  return 0;
+}
@@ -0,0 +1,200 @@
+#include "pg_copy_writer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+struct MetricInfo {
+  const char *table;
+  const char *unit;
+};
+
+// Indexed by Metric; units match what the Python path inserts
+const MetricInfo kMetricInfo[] = {
+    {"data_temperature", "°C"},
+    {"data_humidity", "%"},
+    {"data_light", "lux"},
+};
+
+int64_t nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// COPY text format timestamp: "YYYY-MM-DD HH:MM:SS.mmm" in local time,
+// matching the TIMESTAMP (without time zone) columns
+void formatTimestamp(int64_t epochMs, char *out, size_t cap) {
+  const time_t seconds = static_cast<time_t>(epochMs / 1000);
+  struct tm tmValue;
+  localtime_r(&seconds, &tmValue);
+  const size_t dateLen = strftime(out, cap, "%Y-%m-%d %H:%M:%S", &tmValue);
+  snprintf(out + dateLen, cap - dateLen, ".%03d",
+           static_cast<int>(epochMs % 1000));
+}
+
+}  // namespace
+
+bool PgCopyWriter::start(const std::string &conninfo, int64_t idOffset,
+                         int64_t idStride, std::string &error) {
+  conninfo_ = conninfo;
+  idStride_ = idStride;
+  conn_ = PQconnectdb(conninfo_.c_str());
+  if (PQstatus(conn_) != CONNECTION_OK) {
+    error = PQerrorMessage(conn_);
+    PQfinish(conn_);
+    conn_ = nullptr;
+    return false;
+  }
+
+  // Claim the id space: these tables have plain INTEGER keys
+  for (size_t i = 0; i < static_cast<size_t>(Metric::COUNT); i++) {
+    std::string query = "SELECT COALESCE(MAX(DataID), 0) FROM ";
+    query += kMetricInfo[i].table;
+    PGresult *result = PQexec(conn_, query.c_str());
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+      error = PQerrorMessage(conn_);
+      PQclear(result);
+      PQfinish(conn_);
+      conn_ = nullptr;
+      return false;
+    }
+    batches_[i].nextId = std::stoll(PQgetvalue(result, 0, 0)) + 1 + idOffset;
+    PQclear(result);
+  }
+
+  running_.store(true);
+  thread_ = std::thread(&PgCopyWriter::run, this);
+  return true;
+}
+
+void PgCopyWriter::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (conn_ != nullptr) {
+    PQfinish(conn_);
+    conn_ = nullptr;
+  }
+}
+
+void PgCopyWriter::appendRow(const TelemetrySample &sample) {
+  TableBatch &batch = batches_[static_cast<size_t>(sample.metric)];
+  char timestamp[32];
+  formatTimestamp(sample.sampledAtMs, timestamp, sizeof(timestamp));
+  char row[160];
+  const int length = snprintf(
+      row, sizeof(row), "%lld\t%d\t%.4f\t%s\tNormal\t%s\n",
+      static_cast<long long>(batch.nextId), sample.deviceId, sample.value,
+      kMetricInfo[static_cast<size_t>(sample.metric)].unit, timestamp);
+  batch.rows.append(row, static_cast<size_t>(length));
+  batch.rowCount++;
+  batch.nextId += idStride_;
+}
+
+bool PgCopyWriter::flushTable(size_t metricIndex) {
+  TableBatch &batch = batches_[metricIndex];
+  if (batch.rowCount == 0) {
+    return true;
+  }
+  std::string command = "COPY ";
+  command += kMetricInfo[metricIndex].table;
+  command += " (DataID, DID, Value, Unit, Status, Timestamp) FROM STDIN";
+
+  PGresult *result = PQexec(conn_, command.c_str());
+  if (PQresultStatus(result) != PGRES_COPY_IN) {
+    PQclear(result);
+    return false;
+  }
+  PQclear(result);
+
+  if (PQputCopyData(conn_, batch.rows.data(),
+                    static_cast<int>(batch.rows.size())) != 1 ||
+      PQputCopyEnd(conn_, nullptr) != 1) {
+    return false;
+  }
+  result = PQgetResult(conn_);
+  const bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+  PQclear(result);
+  // Drain any trailing results so the connection is reusable
+  while (PGresult *extra = PQgetResult(conn_)) {
+    PQclear(extra);
+  }
+  if (ok) {
+    rowsWritten_.fetch_add(batch.rowCount, std::memory_order_relaxed);
+    batch.rows.clear();
+    batch.rowCount = 0;
+  }
+  return ok;
+}
+
+bool PgCopyWriter::flush() {
+  for (size_t i = 0; i < static_cast<size_t>(Metric::COUNT); i++) {
+    if (!flushTable(i)) {
+      return false;
+    }
+  }
+  flushes_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool PgCopyWriter::reconnect() {
+  if (conn_ != nullptr) {
+    PQfinish(conn_);
+  }
+  conn_ = PQconnectdb(conninfo_.c_str());
+  if (PQstatus(conn_) != CONNECTION_OK) {
+    PQfinish(conn_);
+    conn_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void PgCopyWriter::run() {
+  int64_t lastFlushMs = nowMs();
+  size_t pendingRows = 0;
+
+  while (running_.load(std::memory_order_relaxed)) {
+    TelemetrySample sample;
+    bool popped = false;
+    while (pendingRows < kFlushRows && queue_.tryPop(sample)) {
+      appendRow(sample);
+      pendingRows++;
+      popped = true;
+    }
+
+    const int64_t now = nowMs();
+    if (pendingRows >= kFlushRows ||
+        (pendingRows > 0 && now - lastFlushMs >= kFlushIntervalMs)) {
+      if (conn_ == nullptr || !flush()) {
+        // Keep the batch and retry after a reconnect; the queue keeps
+        // absorbing readings in the meantime (drops when full)
+        if (!reconnect()) {
+          std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+      } else {
+        pendingRows = 0;
+      }
+      lastFlushMs = now;
+    }
+
+    if (!popped) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  }
+
+  // Final drain so a clean shutdown loses nothing that was queued
+  TelemetrySample sample;
+  while (queue_.tryPop(sample)) {
+    appendRow(sample);
+  }
+  if (conn_ != nullptr) {
+    flush();
+  }
+}
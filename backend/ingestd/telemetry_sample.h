@@ -0,0 +1,25 @@
+#ifndef INGESTD_TELEMETRY_SAMPLE_H
+#define INGESTD_TELEMETRY_SAMPLE_H
+
+#include <cstdint>
+
+// One decoded metric reading, the unit of work flowing from the MQTT
+// reader to the COPY writer. One device publish fans out into up to
+// three samples, one per Data_* table in back/create_tables.sql.
+// (Moisture has no table yet, so it is parsed and dropped.)
+
+enum class Metric : uint8_t {
+  Temperature = 0,
+  Humidity = 1,
+  Light = 2,
+  COUNT = 3,
+};
+
+struct TelemetrySample {
+  Metric metric;
+  int32_t deviceId;
+  double value;
+  int64_t sampledAtMs;  // unix epoch milliseconds
+};
+
+#endif // INGESTD_TELEMETRY_SAMPLE_H
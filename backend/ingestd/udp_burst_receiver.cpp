@@ -0,0 +1,144 @@
+#include "udp_burst_receiver.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+UdpBurstReceiver::~UdpBurstReceiver() { close(); }
+
+bool UdpBurstReceiver::open(uint16_t port, std::string &error) {
+  fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+  if (fd_ < 0) {
+    error = std::string("socket: ") + strerror(errno);
+    return false;
+  }
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd_, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+    error = std::string("bind: ") + strerror(errno);
+    close();
+    return false;
+  }
+  return true;
+}
+
+void UdpBurstReceiver::onReadable() {
+  // One datagram per read; loop until the socket is drained
+  uint8_t buffer[sizeof(BurstHeader) + kMaxSamples * sizeof(uint16_t)];
+  while (true) {
+    const ssize_t received = recv(fd_, buffer, sizeof(buffer), 0);
+    if (received < 0) {
+      return;  // EAGAIN, or nothing we can do about it either way
+    }
+    const int64_t nowMs =
+        []() {
+          struct timespec ts;
+          clock_gettime(CLOCK_REALTIME, &ts);
+          return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+        }();
+    handleDatagram(buffer, static_cast<size_t>(received), nowMs);
+  }
+}
+
+void UdpBurstReceiver::handleDatagram(const uint8_t *data, size_t length,
+                                      int64_t nowMs) {
+  if (length < sizeof(BurstHeader)) {
+    return;
+  }
+  BurstHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (header.version != kFrameVersion || header.sampleCount == 0 ||
+      header.sampleCount > kMaxSamples || header.intervalUs == 0 ||
+      length < sizeof(header) + header.sampleCount * sizeof(uint16_t)) {
+    return;
+  }
+  packetsReceived_++;
+
+  Session &session = sessions_[header.deviceId];
+  // Sequence 0 (or any step backwards) means the device restarted its
+  // burst: close out the old series and open a fresh one
+  if (session.file != nullptr && header.sequence < session.nextSequence) {
+    closeSession(header.deviceId, session);
+  }
+  if (session.file == nullptr) {
+    char path[64];
+    snprintf(path, sizeof(path), "burst_dev%u_%lld.csv", header.deviceId,
+             static_cast<long long>(nowMs));
+    session.file = fopen(path, "w");
+    if (session.file == nullptr) {
+      fprintf(stderr, "ingestd: burst: cannot open %s\n", path);
+      sessions_.erase(header.deviceId);
+      return;
+    }
+    session.path = path;
+    session.nextSequence = header.sequence;
+    session.firstUptimeMs = header.firstUptimeMs;
+    session.startedAtMs = nowMs;
+    session.samplesWritten = 0;
+    session.packetsLost = 0;
+    fputs("timestamp_ms,moisture_raw\n", session.file);
+    printf("ingestd: burst: device %u started, writing %s\n", header.deviceId,
+           path);
+  }
+  if (header.sequence > session.nextSequence) {
+    session.packetsLost += header.sequence - session.nextSequence;
+  }
+  session.nextSequence = header.sequence + 1;
+  session.lastPacketMs = nowMs;
+
+  // Timestamps ride the device's own uptime clock, anchored to our
+  // wall clock when the session opened: network jitter on later
+  // packets never shows up in the series spacing
+  const int64_t packetBaseUs =
+      static_cast<int64_t>(header.firstUptimeMs - session.firstUptimeMs) * 1000;
+  const uint8_t *samples = data + sizeof(header);
+  for (uint16_t i = 0; i < header.sampleCount; i++) {
+    uint16_t value;
+    memcpy(&value, samples + i * sizeof(uint16_t), sizeof(value));
+    const int64_t sampleUs = packetBaseUs + static_cast<int64_t>(i) * header.intervalUs;
+    fprintf(session.file, "%lld.%03lld,%u\n",
+            static_cast<long long>(session.startedAtMs + sampleUs / 1000),
+            static_cast<long long>(sampleUs % 1000), value);
+  }
+  session.samplesWritten += header.sampleCount;
+}
+
+void UdpBurstReceiver::tick(int64_t nowMs) {
+  for (auto it = sessions_.begin(); it != sessions_.end();) {
+    if (it->second.file != nullptr &&
+        nowMs - it->second.lastPacketMs >= kSessionIdleMs) {
+      closeSession(it->first, it->second);
+      it = sessions_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void UdpBurstReceiver::closeSession(int deviceId, Session &session) {
+  fclose(session.file);
+  session.file = nullptr;
+  printf("ingestd: burst: device %d done, %llu samples in %s, "
+         "%llu datagrams lost\n",
+         deviceId, (unsigned long long)session.samplesWritten,
+         session.path.c_str(), (unsigned long long)session.packetsLost);
+}
+
+void UdpBurstReceiver::close() {
+  for (auto &entry : sessions_) {
+    if (entry.second.file != nullptr) {
+      closeSession(entry.first, entry.second);
+    }
+  }
+  sessions_.clear();
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
@@ -0,0 +1,77 @@
+#ifndef INGESTD_UDP_BURST_RECEIVER_H
+#define INGESTD_UDP_BURST_RECEIVER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+
+// Receiver for the ack-less UDP sampling fast path (the udp_burst
+// firmware role). Datagrams carry a header plus a run of raw uint16
+// moisture samples at a fixed interval; the header layout mirrors
+// platformio/src/udp_burst_frame.h and must be kept in sync with it.
+//
+// The series bypasses the Postgres writers on purpose: a 100Hz study
+// produces 6000 rows a minute of experiment data, not production
+// telemetry (moisture has no Data_* table anyway). Each device's burst
+// session is reassembled into its own CSV — timestamps reconstructed
+// from the arrival time, the device uptime deltas and the sample
+// interval — and closed after an idle timeout with a summary line that
+// includes exactly how many datagrams the network dropped.
+//
+// Single-threaded like the MQTT decode path: onReadable() runs on the
+// epoll loop, tick() closes idle sessions.
+class UdpBurstReceiver {
+public:
+  ~UdpBurstReceiver();
+
+  // Binds the UDP socket (non-blocking) on the given port.
+  bool open(uint16_t port, std::string &error);
+
+  int fd() const { return fd_; }
+
+  // Drain every datagram currently queued on the socket.
+  void onReadable();
+
+  // Call periodically; closes sessions idle past the timeout.
+  void tick(int64_t nowMs);
+
+  void close();
+
+  uint64_t packetsReceived() const { return packetsReceived_; }
+
+private:
+  // Mirror of UdpBurstHeader in platformio/src/udp_burst_frame.h
+  struct __attribute__((packed)) BurstHeader {
+    uint8_t version;
+    uint8_t deviceId;
+    uint16_t sampleCount;
+    uint32_t sequence;
+    uint32_t firstUptimeMs;
+    uint16_t intervalUs;
+  };
+  static constexpr uint8_t kFrameVersion = 1;
+  static constexpr uint16_t kMaxSamples = 512;  // sanity bound per datagram
+  static constexpr int64_t kSessionIdleMs = 5000;
+
+  // One in-flight burst session per device
+  struct Session {
+    FILE *file = nullptr;
+    std::string path;
+    uint32_t nextSequence = 0;
+    uint32_t firstUptimeMs = 0;   // device clock at the session start
+    int64_t startedAtMs = 0;      // our clock at the session start
+    int64_t lastPacketMs = 0;
+    uint64_t samplesWritten = 0;
+    uint64_t packetsLost = 0;
+  };
+
+  void handleDatagram(const uint8_t *data, size_t length, int64_t nowMs);
+  void closeSession(int deviceId, Session &session);
+
+  int fd_ = -1;
+  std::map<int, Session> sessions_;
+  uint64_t packetsReceived_ = 0;
+};
+
+#endif // INGESTD_UDP_BURST_RECEIVER_H
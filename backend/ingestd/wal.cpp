@@ -0,0 +1,178 @@
+#include "wal.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t kMagic = 0x4C4157544E494C46ULL;  // "FLINTWAL"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderPage = 4096;
+
+// CRC-32 (reflected 0xEDB88319), bitwise — record appends are rare
+// enough (per telemetry sample) that a table buys nothing here
+uint32_t crc32(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+}  // namespace
+
+TelemetryWal::~TelemetryWal() { stop(); }
+
+TelemetryWal::Record *TelemetryWal::slot(uint64_t counter) {
+  return reinterpret_cast<Record *>(map_ + kHeaderPage +
+                                    (counter % capacity_) * sizeof(Record));
+}
+
+uint32_t TelemetryWal::recordCrc(const Record &record) {
+  // Everything before the crc field itself
+  return crc32(reinterpret_cast<const uint8_t *>(&record),
+               offsetof(Record, crc));
+}
+
+bool TelemetryWal::open(const std::string &path, uint32_t capacityRecords,
+                        std::string &error) {
+  const size_t size = kHeaderPage + capacityRecords * sizeof(Record);
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    error = "open " + path + ": " + strerror(errno);
+    return false;
+  }
+  struct stat st = {};
+  fstat(fd, &st);
+  const bool fresh = st.st_size == 0;
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    error = "ftruncate " + path + ": " + strerror(errno);
+    ::close(fd);
+    return false;
+  }
+  map_ = static_cast<uint8_t *>(
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+  ::close(fd);  // the mapping keeps the file open
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    error = "mmap " + path + ": " + strerror(errno);
+    return false;
+  }
+  mapSize_ = size;
+  capacity_ = capacityRecords;
+
+  Header *header = reinterpret_cast<Header *>(map_);
+  if (fresh || header->magic != kMagic || header->version != kVersion ||
+      header->capacity != capacityRecords) {
+    if (!fresh) {
+      // Not fatal: an operator changing --wal-records gets a fresh log
+      fprintf(stderr, "wal: incompatible log %s, starting it over\n",
+              path.c_str());
+    }
+    memset(map_, 0, kHeaderPage);
+    header->magic = kMagic;
+    header->version = kVersion;
+    header->capacity = capacityRecords;
+    header->head = 0;
+    header->tail = 0;
+    msync(map_, kHeaderPage, MS_SYNC);
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Recover: the header is persisted at group-sync points, so records
+  // may exist past header->head. Scan forward while sequence numbers
+  // and CRCs line up; a torn final append fails its CRC and stops the
+  // scan.
+  uint64_t head = header->head;
+  while (head - header->tail < capacity_) {
+    const Record *record = slot(head);
+    if (record->seq != head || recordCrc(*record) != record->crc) {
+      break;
+    }
+    head++;
+  }
+  head_.store(head, std::memory_order_relaxed);
+  tail_.store(header->tail, std::memory_order_relaxed);
+  recovered_ = head - header->tail;
+  return true;
+}
+
+bool TelemetryWal::append(const TelemetrySample &sample) {
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) >= capacity_) {
+    // Ring full: Postgres has been down longer than the file can absorb
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  Record *record = slot(head);
+  record->seq = head;
+  record->sample = sample;
+  record->crc = recordCrc(*record);
+  head_.store(head + 1, std::memory_order_release);
+  if (++sinceSync_ >= kGroupSyncRecords) {
+    sync(true);
+  }
+  return true;
+}
+
+void TelemetryWal::sync(bool force) {
+  if (!force && sinceSync_ == 0) {
+    return;
+  }
+  sinceSync_ = 0;
+  Header *header = reinterpret_cast<Header *>(map_);
+  header->head = head_.load(std::memory_order_relaxed);
+  header->tail = tail_.load(std::memory_order_relaxed);
+  // One call over the whole mapping: the kernel writes only the dirty
+  // pages, which keeps this proportional to the group size, not the
+  // file size
+  msync(map_, mapSize_, MS_ASYNC);
+  msync(map_, kHeaderPage, MS_SYNC);
+}
+
+void TelemetryWal::startDrain(DrainHandler handler) {
+  drainHandler_ = std::move(handler);
+  running_.store(true, std::memory_order_release);
+  drainThread_ = std::thread(&TelemetryWal::drainLoop, this);
+}
+
+void TelemetryWal::drainLoop() {
+  while (running_.load(std::memory_order_acquire)) {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      continue;
+    }
+    const Record *record = slot(tail);
+    if (!drainHandler_(record->sample)) {
+      // Writer queue full — the DB is behind. Hold the record and let
+      // the backlog accumulate here instead of dropping it.
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      continue;
+    }
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+}
+
+void TelemetryWal::stop() {
+  if (running_.exchange(false)) {
+    drainThread_.join();
+  }
+  if (map_ != nullptr) {
+    sync(true);
+    munmap(map_, mapSize_);
+    map_ = nullptr;
+  }
+}
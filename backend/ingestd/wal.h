@@ -0,0 +1,101 @@
+#ifndef INGESTD_WAL_H
+#define INGESTD_WAL_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "telemetry_sample.h"
+
+// Memory-mapped write-ahead log between broker consumption and the
+// Postgres writers. The message handler appends each decoded sample
+// here — a fixed-size record in a mapped ring file — and only then does
+// the consumer acknowledge the PUBLISH, so a message the broker
+// considers delivered is at worst one group-sync interval away from
+// disk. A drain thread replays records into the writer pool at
+// whatever pace Postgres sustains; a DB failover backs up into the WAL
+// file instead of into broker flow control and device-facing latency.
+//
+// Durability model: appends are memcpy-into-mmap (sub-microsecond on
+// the consume path), and msync runs in groups — every
+// kGroupSyncRecords appends or on the caller's 1s tick, whichever
+// comes first. Recovery scans forward from the last persisted head as
+// long as record sequence numbers and CRCs line up, so a torn final
+// write is dropped, then replays everything past the persisted drain
+// cursor. The cursor itself is persisted lazily, so a crash can replay
+// a few already-written samples; inserts are append-only rows, and a
+// duplicate reading is harmless where a lost one is not.
+class TelemetryWal {
+public:
+  // Returning false means "not now" (queue full): the drain thread
+  // keeps the record and retries after a short pause.
+  using DrainHandler = std::function<bool(const TelemetrySample &sample)>;
+
+  static constexpr uint32_t kGroupSyncRecords = 64;
+
+  ~TelemetryWal();
+
+  // Map (creating if needed) a ring of capacityRecords records. An
+  // existing file recovers its head/tail and the un-drained tail is
+  // replayed once startDrain() runs.
+  bool open(const std::string &path, uint32_t capacityRecords,
+            std::string &error);
+
+  // Append one sample. Returns false when the ring is full (the drain
+  // cannot keep up and the file has absorbed all it can); the caller
+  // counts the drop, same contract as the writer queues.
+  bool append(const TelemetrySample &sample);
+
+  // Group durability point: msync the mapped file and persist the
+  // head/drain cursor when there is anything outstanding. Called from
+  // the 1s tick; append() also calls it every kGroupSyncRecords.
+  void sync(bool force);
+
+  void startDrain(DrainHandler handler);
+  void stop();
+
+  uint64_t appended() const { return head_.load(std::memory_order_relaxed); }
+  uint64_t drained() const { return tail_.load(std::memory_order_relaxed); }
+  size_t backlog() const {
+    return static_cast<size_t>(head_.load(std::memory_order_relaxed) -
+                               tail_.load(std::memory_order_relaxed));
+  }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  // Records recovered from the file at open(), pending replay
+  uint64_t recovered() const { return recovered_; }
+
+private:
+  struct Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint64_t head;  // persisted at group-sync points, not per append
+    uint64_t tail;
+  };
+  struct Record {
+    uint64_t seq;  // equals its head counter; distinguishes stale laps
+    TelemetrySample sample;
+    uint32_t crc;
+    uint32_t pad;
+  };
+
+  Record *slot(uint64_t counter);
+  static uint32_t recordCrc(const Record &record);
+  void drainLoop();
+
+  uint8_t *map_ = nullptr;
+  size_t mapSize_ = 0;
+  uint32_t capacity_ = 0;
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+  uint32_t sinceSync_ = 0;
+  uint64_t recovered_ = 0;
+  DrainHandler drainHandler_;
+  std::thread drainThread_;
+  std::atomic<bool> running_{false};
+};
+
+#endif // INGESTD_WAL_H
@@ -0,0 +1,124 @@
+#include "writer_pool.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <libpq-fe.h>
+
+namespace {
+
+// FNV-1a; stable across runs so a sector always lands on the same shard
+uint32_t hashBytes(const char *data, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+  }
+  return hash;
+}
+
+}  // namespace
+
+bool WriterPool::loadSectorMap(const std::string &conninfo,
+                               std::string &error) {
+  PGconn *conn = PQconnectdb(conninfo.c_str());
+  if (PQstatus(conn) != CONNECTION_OK) {
+    error = PQerrorMessage(conn);
+    PQfinish(conn);
+    return false;
+  }
+  PGresult *result =
+      PQexec(conn, "SELECT DID, COALESCE(Location, '') FROM Device");
+  if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+    error = PQerrorMessage(conn);
+    PQclear(result);
+    PQfinish(conn);
+    return false;
+  }
+  const unsigned shards = static_cast<unsigned>(queues_.size());
+  for (int row = 0; row < PQntuples(result); row++) {
+    const int32_t deviceId = atoi(PQgetvalue(result, row, 0));
+    const char *sector = PQgetvalue(result, row, 1);
+    if (sector[0] != '\0') {
+      deviceShard_[deviceId] = hashBytes(sector, strlen(sector)) % shards;
+    }
+  }
+  PQclear(result);
+  PQfinish(conn);
+  return true;
+}
+
+unsigned WriterPool::shardFor(int32_t deviceId) const {
+  const auto it = deviceShard_.find(deviceId);
+  if (it != deviceShard_.end()) {
+    return it->second;
+  }
+  // No Device row (or no location): spread by id so unknown devices at
+  // least don't all pile onto one shard
+  return static_cast<uint32_t>(deviceId) %
+         static_cast<unsigned>(queues_.size());
+}
+
+bool WriterPool::start(const std::string &conninfo, unsigned shardCount,
+                       std::string &error) {
+  if (shardCount == 0) {
+    shardCount = 1;
+  }
+  for (unsigned i = 0; i < shardCount; i++) {
+    queues_.push_back(std::make_unique<PgCopyWriter::Queue>());
+    writers_.push_back(std::make_unique<PgCopyWriter>(*queues_.back()));
+  }
+  if (!loadSectorMap(conninfo, error)) {
+    return false;
+  }
+  // Start before any writer allocates ids: every shard reads the same
+  // MAX(DataID) and offsets by its index, stepping by the shard count
+  for (unsigned i = 0; i < shardCount; i++) {
+    if (!writers_[i]->start(conninfo, i, shardCount, error)) {
+      stop();
+      return false;
+    }
+  }
+  return true;
+}
+
+void WriterPool::stop() {
+  for (auto &writer : writers_) {
+    writer->stop();
+  }
+}
+
+bool WriterPool::push(const TelemetrySample &sample) {
+  return queues_[shardFor(sample.deviceId)]->tryPush(sample);
+}
+
+uint64_t WriterPool::rowsWritten() const {
+  uint64_t total = 0;
+  for (const auto &writer : writers_) {
+    total += writer->rowsWritten();
+  }
+  return total;
+}
+
+uint64_t WriterPool::flushes() const {
+  uint64_t total = 0;
+  for (const auto &writer : writers_) {
+    total += writer->flushes();
+  }
+  return total;
+}
+
+uint64_t WriterPool::dropped() const {
+  uint64_t total = 0;
+  for (const auto &queue : queues_) {
+    total += queue->dropped();
+  }
+  return total;
+}
+
+size_t WriterPool::queueDepth() const {
+  size_t total = 0;
+  for (const auto &queue : queues_) {
+    total += queue->size();
+  }
+  return total;
+}
@@ -0,0 +1,56 @@
+#ifndef INGESTD_WRITER_POOL_H
+#define INGESTD_WRITER_POOL_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pg_copy_writer.h"
+#include "telemetry_sample.h"
+
+// Sector-sharded fan-out in front of the COPY writers. Each shard owns
+// its own queue, thread and Postgres connection, so a burst from one
+// sector — say every node in sector A reconnecting after its AP
+// rebooted and dumping hours of backlog at once — fills only that
+// shard's queue and batch while the other sectors keep flushing at
+// their usual cadence. Flushes run concurrently across shards, so COPY
+// throughput scales with cores instead of serializing on one
+// connection.
+//
+// Routing: the Device table maps DID -> Location, which is the sector
+// (Device_Commands.Sector joins against it). The pool loads that map
+// once at startup and hashes the sector string to a shard, so all
+// devices in a sector share a queue; a device with no row or no
+// location falls back to hashing its id.
+//
+// DataID allocation stays collision-free across shards by interleaving:
+// shard i starts at MAX(DataID)+1+i and steps by the shard count.
+class WriterPool {
+public:
+  bool start(const std::string &conninfo, unsigned shardCount,
+             std::string &error);
+  void stop();
+
+  // Routes by the sample's device id; returns false if the shard's
+  // queue is full (the sample is dropped and counted, same contract as
+  // the single-queue path)
+  bool push(const TelemetrySample &sample);
+
+  uint64_t rowsWritten() const;
+  uint64_t flushes() const;
+  uint64_t dropped() const;
+  size_t queueDepth() const;
+  unsigned shardCount() const { return static_cast<unsigned>(writers_.size()); }
+
+private:
+  unsigned shardFor(int32_t deviceId) const;
+  bool loadSectorMap(const std::string &conninfo, std::string &error);
+
+  // Queues are large (64k slots each) so they live on the heap
+  std::vector<std::unique_ptr<PgCopyWriter::Queue>> queues_;
+  std::vector<std::unique_ptr<PgCopyWriter>> writers_;
+  std::unordered_map<int32_t, unsigned> deviceShard_;
+};
+
+#endif // INGESTD_WRITER_POOL_H
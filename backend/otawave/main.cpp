@@ -0,0 +1,195 @@
+// otawave: fleet OTA wave coordinator.
+//
+// Pushing a firmware image to every node at once saturates the APs and
+// the broker together — each node's OTA download competes with the
+// telemetry the rest of the farm is still trying to publish, and we
+// have blacked out farm-wide telemetry this way. This tool runs an
+// update campaign in waves instead: the fleet is split into cohorts
+// (each node hashes its MAC into a wave index, no provisioning), and
+// one broadcast per wave opens exactly one cohort's update window.
+// Nodes outside the open wave stop servicing their OTA listener, so an
+// uploader's invite aimed at them simply times out; the operator runs
+// the actual image pushes (pio/espota) against the open cohort during
+// its window.
+//
+// Bandwidth is budgeted by the wave split itself: with W waves at most
+// fleet/W nodes download concurrently per AP, so each wave leaves the
+// air the next wave (and live telemetry) needs. --fleet and --image-kb
+// print the per-wave budget so W can be sized before the campaign.
+//
+// Every broadcast carries both otaWaveCount and otaWaveOpen on the
+// shared-attribute topic, so a node that reconnects mid-campaign is
+// consistent after any single message; nodes persist the pair to NVS,
+// so a reboot mid-campaign comes back knowing its window.
+//
+// Usage:
+//   otawave [--broker host] [--port 1884] [--user u] [--password p]
+//           [--waves 4] [--wave-seconds 600] [--settle-seconds 5]
+//           [--fleet n] [--image-kb n]
+//           [--topic v1/devices/me/attributes] [--close]
+//
+// --close broadcasts the end-of-campaign message (otaWaveOpen = -1)
+// and exits, for recovering from an interrupted run.
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <string>
+
+#include "mqtt_consumer.h"
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Options {
+  std::string broker = "127.0.0.1";
+  uint16_t port = 1884;
+  std::string user;
+  std::string password;
+  int waves = 4;
+  int waveSeconds = 600;
+  int settleSeconds = 5;
+  int fleet = 0;     // 0 = no budget printout
+  int imageKb = 0;
+  std::string topic = "v1/devices/me/attributes";
+  bool closeOnly = false;
+};
+
+bool parseArgs(int argc, char **argv, Options &o) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--broker" && hasValue) o.broker = argv[++i];
+    else if (arg == "--port" && hasValue) o.port = atoi(argv[++i]);
+    else if (arg == "--user" && hasValue) o.user = argv[++i];
+    else if (arg == "--password" && hasValue) o.password = argv[++i];
+    else if (arg == "--waves" && hasValue) o.waves = atoi(argv[++i]);
+    else if (arg == "--wave-seconds" && hasValue) o.waveSeconds = atoi(argv[++i]);
+    else if (arg == "--settle-seconds" && hasValue) o.settleSeconds = atoi(argv[++i]);
+    else if (arg == "--fleet" && hasValue) o.fleet = atoi(argv[++i]);
+    else if (arg == "--image-kb" && hasValue) o.imageKb = atoi(argv[++i]);
+    else if (arg == "--topic" && hasValue) o.topic = argv[++i];
+    else if (arg == "--close") o.closeOnly = true;
+    else {
+      fprintf(stderr,
+              "usage: otawave [--broker host] [--port n] [--user u] [--password p]\n"
+              "               [--waves n] [--wave-seconds n] [--settle-seconds n]\n"
+              "               [--fleet n] [--image-kb n] [--topic t] [--close]\n");
+      return false;
+    }
+  }
+  // Device-side otaWaveOpen tops out at 63, and the quiesce message
+  // parks the open wave at the cohort count itself
+  if (o.waves < 1 || o.waves > 63) {
+    fprintf(stderr, "otawave: --waves must be 1-63\n");
+    return false;
+  }
+  if (o.waveSeconds < 1) {
+    fprintf(stderr, "otawave: --wave-seconds must be positive\n");
+    return false;
+  }
+  return true;
+}
+
+// One campaign broadcast: both keys in every message, so any single
+// message leaves a late-joining node consistent
+bool publishWaveState(MqttConsumer &mqtt, const Options &o, int openWave) {
+  char payload[64];
+  snprintf(payload, sizeof(payload), "{\"otaWaveCount\":%d,\"otaWaveOpen\":%d}",
+           o.waves, openWave);
+  if (!mqtt.publish(o.topic, payload)) {
+    fprintf(stderr, "otawave: publish failed\n");
+    return false;
+  }
+  return true;
+}
+
+// Sleep in one-second steps, keeping the MQTT session alive and
+// bailing out early on SIGINT/SIGTERM
+bool waitSeconds(MqttConsumer &mqtt, int seconds) {
+  for (int s = 0; s < seconds && !shuttingDown; s++) {
+    struct pollfd pfd = {mqtt.fd(), POLLIN, 0};
+    if (poll(&pfd, 1, 1000) > 0 && (pfd.revents & POLLIN)) {
+      if (!mqtt.onReadable()) {
+        fprintf(stderr, "otawave: broker connection lost\n");
+        return false;
+      }
+    }
+    if (!mqtt.tick(nowMs())) {
+      return false;
+    }
+  }
+  return !shuttingDown;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  MqttConsumer mqtt;
+  std::string error;
+  if (!mqtt.connect(options.broker, options.port, "otawave", options.user,
+                    options.password, error)) {
+    fprintf(stderr, "otawave: connect to %s:%u failed: %s\n", options.broker.c_str(),
+            options.port, error.c_str());
+    return 1;
+  }
+
+  if (options.closeOnly) {
+    const bool ok = publishWaveState(mqtt, options, -1);
+    printf("otawave: campaign closed (otaWaveOpen = -1)\n");
+    mqtt.close();
+    return ok ? 0 : 1;
+  }
+
+  if (options.fleet > 0) {
+    const int perWave = (options.fleet + options.waves - 1) / options.waves;
+    printf("otawave: budget: <= %d node(s) updating per wave", perWave);
+    if (options.imageKb > 0) {
+      printf(", ~%d KB per wave, ~%d KB/s sustained over the window", perWave * options.imageKb,
+             perWave * options.imageKb / options.waveSeconds);
+    }
+    printf("\n");
+  }
+
+  // Quiesce first: campaign active, no cohort open. Nodes that were
+  // accepting one-off pushes close their listener before wave 0 opens.
+  printf("otawave: campaign start, %d wave(s) of %d second(s)\n", options.waves,
+         options.waveSeconds);
+  bool ok = publishWaveState(mqtt, options, options.waves) &&
+            waitSeconds(mqtt, options.settleSeconds);
+
+  for (int wave = 0; ok && wave < options.waves; wave++) {
+    printf("otawave: wave %d/%d open, push images now\n", wave + 1, options.waves);
+    fflush(stdout);
+    ok = publishWaveState(mqtt, options, wave) && waitSeconds(mqtt, options.waveSeconds);
+  }
+
+  // Always try to end the campaign, even when aborting on a signal —
+  // leaving a cohort pinned open (or the rest pinned closed) is worse
+  // than a redundant broadcast
+  const bool closed = publishWaveState(mqtt, options, -1);
+  printf("otawave: campaign %s, windows restored to default\n",
+         ok ? "complete" : "aborted");
+  mqtt.close();
+  return (ok && closed) ? 0 : 1;
+}
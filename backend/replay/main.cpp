@@ -0,0 +1,537 @@
+// replay: deterministic workload replay for the ingestion path.
+//
+// fleetsim answers "how much load can the backend take", but its
+// synthetic readings change every run, so before/after comparisons of
+// ingestd or the writers were never apples to apples. This tool replays
+// a recorded dataset — the back/test.csv sensor history, or a captured
+// MQTT log — through the broker with the original inter-arrival timing
+// scaled by --speed, publishing at QoS 1 on a single connection and
+// reporting throughput plus publish->PUBACK latency percentiles. The
+// same file at the same speed is the same workload, byte for byte and
+// millisecond for millisecond, so a regression shows up as a number
+// instead of a feeling. Batch efficiency on the write side comes from
+// ingestd's own stats line, which reports rows per COPY flush.
+//
+// CSV input is the back/test.csv format: record times come from the
+// Date (DD/MM/YYYY) and Time columns, and the payload carries the
+// columns the telemetry path understands (Relative_humidity_room as
+// humidity, Lighting_room as light), spliced verbatim so the replayed
+// bytes are reproducible. The dataset's 15-minute cadence is glacial at
+// --speed 1; --speed 900 compresses it to one message per second.
+//
+// Log input is one record per line: "<epoch-ms> <topic> <payload>",
+// with the payload published verbatim to the recorded topic.
+//
+// Usage:
+//   replay [--csv back/test.csv | --log capture.txt]
+//          [--broker host] [--port 1883] [--user u] [--password p]
+//          [--topic v1/devices/me/telemetry] [--speed 1.0] [--fanout 1]
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Options {
+  std::string csvPath;
+  std::string logPath;
+  std::string broker = "127.0.0.1";
+  uint16_t port = 1883;
+  std::string user;
+  std::string password;
+  std::string topic = "v1/devices/me/telemetry";
+  double speed = 1.0;
+  unsigned fanout = 1;
+};
+
+bool parseArgs(int argc, char **argv, Options &o) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--csv" && hasValue) o.csvPath = argv[++i];
+    else if (arg == "--log" && hasValue) o.logPath = argv[++i];
+    else if (arg == "--broker" && hasValue) o.broker = argv[++i];
+    else if (arg == "--port" && hasValue) o.port = atoi(argv[++i]);
+    else if (arg == "--user" && hasValue) o.user = argv[++i];
+    else if (arg == "--password" && hasValue) o.password = argv[++i];
+    else if (arg == "--topic" && hasValue) o.topic = argv[++i];
+    else if (arg == "--speed" && hasValue) o.speed = atof(argv[++i]);
+    else if (arg == "--fanout" && hasValue) o.fanout = atoi(argv[++i]);
+    else {
+      fprintf(stderr,
+              "usage: replay [--csv file | --log file]\n"
+              "              [--broker host] [--port n] [--user u] [--password p]\n"
+              "              [--topic t] [--speed x] [--fanout n]\n");
+      return false;
+    }
+  }
+  if ((o.csvPath.empty() == o.logPath.empty()) || o.speed <= 0.0 ||
+      o.fanout == 0) {
+    fprintf(stderr, "replay: need exactly one of --csv/--log, --speed > 0, "
+                    "--fanout > 0\n");
+    return false;
+  }
+  return true;
+}
+
+// One scheduled publish: milliseconds after the recording started, the
+// topic to publish on and the exact payload bytes
+struct Record {
+  int64_t offsetMs = 0;
+  std::string topic;
+  std::string payload;
+};
+
+// Latency samples for the whole run; sorted once at report time (same
+// shape as fleetsim's recorder, but a replay reports once at the end)
+struct LatencyRecorder {
+  std::vector<double> samples;
+  void record(double ms) { samples.push_back(ms); }
+  void report(const char *name) {
+    if (samples.empty()) {
+      return;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto pct = [&](double p) {
+      return samples[(size_t)(p * (samples.size() - 1))];
+    };
+    printf("replay: %-7s n=%zu p50=%.1fms p90=%.1fms p99=%.1fms max=%.1fms\n",
+           name, samples.size(), pct(0.50), pct(0.90), pct(0.99),
+           samples.back());
+  }
+};
+
+// Minimal MQTT 3.1.1 packet builders — the publishing subset again
+// (mirrors fleetsim; the consumer side lives in backend/common)
+void appendString(std::vector<uint8_t> &out, const std::string &s) {
+  out.push_back(s.size() >> 8);
+  out.push_back(s.size() & 0xFF);
+  out.insert(out.end(), s.begin(), s.end());
+}
+
+void appendRemainingLength(std::vector<uint8_t> &out, size_t length) {
+  do {
+    uint8_t byte = length % 128;
+    length /= 128;
+    if (length > 0) byte |= 0x80;
+    out.push_back(byte);
+  } while (length > 0);
+}
+
+std::vector<uint8_t> buildConnect(const std::string &clientId,
+                                  const std::string &user,
+                                  const std::string &password) {
+  std::vector<uint8_t> body;
+  appendString(body, "MQTT");
+  body.push_back(4);  // protocol level 3.1.1
+  uint8_t flags = 0x02;  // clean session
+  if (!user.empty()) flags |= 0x80;
+  if (!password.empty()) flags |= 0x40;
+  body.push_back(flags);
+  body.push_back(0);  // keepalive 0: disabled, publishes are the traffic
+  body.push_back(0);
+  appendString(body, clientId);
+  if (!user.empty()) appendString(body, user);
+  if (!password.empty()) appendString(body, password);
+
+  std::vector<uint8_t> packet;
+  packet.push_back(0x10);
+  appendRemainingLength(packet, body.size());
+  packet.insert(packet.end(), body.begin(), body.end());
+  return packet;
+}
+
+std::vector<uint8_t> buildPublishQos1(const std::string &topic,
+                                      uint16_t packetId,
+                                      const std::string &payload) {
+  std::vector<uint8_t> body;
+  appendString(body, topic);
+  body.push_back(packetId >> 8);
+  body.push_back(packetId & 0xFF);
+  body.insert(body.end(), payload.begin(), payload.end());
+
+  std::vector<uint8_t> packet;
+  packet.push_back(0x32);  // PUBLISH, QoS 1
+  appendRemainingLength(packet, body.size());
+  packet.insert(packet.end(), body.begin(), body.end());
+  return packet;
+}
+
+// Days since the civil epoch; only differences matter here, so any
+// proleptic Gregorian serial works
+int64_t daysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = (unsigned)(y - era * 400);
+  const unsigned doy = (153u * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int64_t)doe;
+}
+
+std::vector<std::string> splitCsvLine(const std::string &line) {
+  std::vector<std::string> fields;
+  size_t start = 0;
+  while (start <= line.size()) {
+    size_t end = line.find(',', start);
+    if (end == std::string::npos) {
+      end = line.size();
+    }
+    fields.push_back(line.substr(start, end - start));
+    start = end + 1;
+  }
+  return fields;
+}
+
+int columnIndex(const std::vector<std::string> &header, const char *name) {
+  for (size_t i = 0; i < header.size(); i++) {
+    if (header[i] == name) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+bool loadCsv(const Options &options, std::vector<Record> &records,
+             std::string &error) {
+  FILE *file = fopen(options.csvPath.c_str(), "r");
+  if (file == nullptr) {
+    error = options.csvPath + ": " + strerror(errno);
+    return false;
+  }
+  char line[1024];
+  if (fgets(line, sizeof(line), file) == nullptr) {
+    fclose(file);
+    error = options.csvPath + ": empty file";
+    return false;
+  }
+  line[strcspn(line, "\r\n")] = '\0';
+  const std::vector<std::string> header = splitCsvLine(line);
+  const int dateCol = columnIndex(header, "Date");
+  const int timeCol = columnIndex(header, "Time");
+  const int humidityCol = columnIndex(header, "Relative_humidity_room");
+  const int lightCol = columnIndex(header, "Lighting_room");
+  if (dateCol < 0 || timeCol < 0 || humidityCol < 0 || lightCol < 0) {
+    fclose(file);
+    error = options.csvPath + ": not the back/test.csv column layout";
+    return false;
+  }
+
+  int64_t firstMs = -1;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    line[strcspn(line, "\r\n")] = '\0';
+    const std::vector<std::string> fields = splitCsvLine(line);
+    const int maxCol = std::max(std::max(dateCol, timeCol),
+                                std::max(humidityCol, lightCol));
+    if ((int)fields.size() <= maxCol) {
+      continue;
+    }
+    int day = 0, month = 0, year = 0, hour = 0, minute = 0;
+    if (sscanf(fields[dateCol].c_str(), "%d/%d/%d", &day, &month, &year) != 3 ||
+        sscanf(fields[timeCol].c_str(), "%d:%d", &hour, &minute) != 2) {
+      continue;
+    }
+    const int64_t recordMs =
+        (daysFromCivil(year, month, day) * 1440 + hour * 60 + minute) * 60000;
+    if (firstMs < 0) {
+      firstMs = recordMs;
+    }
+    Record record;
+    record.offsetMs = recordMs - firstMs;
+    record.topic = options.topic;
+    // Field strings spliced verbatim: the replayed bytes never depend
+    // on float formatting
+    record.payload = "{\"humidity\":" + fields[humidityCol] +
+                     ",\"light\":" + fields[lightCol] + "}";
+    records.push_back(std::move(record));
+  }
+  fclose(file);
+  return true;
+}
+
+bool loadLog(const Options &options, std::vector<Record> &records,
+             std::string &error) {
+  FILE *file = fopen(options.logPath.c_str(), "r");
+  if (file == nullptr) {
+    error = options.logPath + ": " + strerror(errno);
+    return false;
+  }
+  char line[4096];
+  int64_t firstMs = -1;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    line[strcspn(line, "\r\n")] = '\0';
+    char *topicStart = strchr(line, ' ');
+    char *payloadStart = topicStart ? strchr(topicStart + 1, ' ') : nullptr;
+    if (payloadStart == nullptr) {
+      continue;
+    }
+    const int64_t recordMs = strtoll(line, nullptr, 10);
+    if (firstMs < 0) {
+      firstMs = recordMs;
+    }
+    Record record;
+    record.offsetMs = recordMs - firstMs;
+    record.topic.assign(topicStart + 1, payloadStart);
+    record.payload = payloadStart + 1;
+    records.push_back(std::move(record));
+  }
+  fclose(file);
+  if (records.empty()) {
+    error = options.logPath + ": no \"<epoch-ms> <topic> <payload>\" lines";
+    return false;
+  }
+  return true;
+}
+
+// Single blocking connection with poll()-driven ack collection — one
+// socket needs none of fleetsim's epoll machinery
+class Publisher {
+public:
+  bool connect(const Options &options, std::string &error) {
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *result = nullptr;
+    if (getaddrinfo(options.broker.c_str(), nullptr, &hints, &result) != 0) {
+      error = "cannot resolve " + options.broker;
+      return false;
+    }
+    struct sockaddr_in addr = *reinterpret_cast<struct sockaddr_in *>(result->ai_addr);
+    addr.sin_port = htons(options.port);
+    freeaddrinfo(result);
+
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd_ < 0 ||
+        ::connect(fd_, reinterpret_cast<struct sockaddr *>(&addr),
+                  sizeof(addr)) < 0) {
+      error = std::string("connect: ") + strerror(errno);
+      return false;
+    }
+    int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    const std::vector<uint8_t> packet =
+        buildConnect("replay", options.user, options.password);
+    if (!sendAll(packet.data(), packet.size())) {
+      error = "connect packet rejected";
+      return false;
+    }
+    // Wait for the CONNACK before any publish goes out
+    const int64_t deadline = nowMs() + 10000;
+    while (!connected_) {
+      if (nowMs() >= deadline || !pump(100)) {
+        error = "no CONNACK from broker";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Publish at QoS 1 and remember the send time; the ack is collected
+  // whenever the socket is pumped. Inflight is capped so packet ids
+  // cannot wrap onto an unacked publish; hitting the cap means the
+  // broker is the bottleneck, which the latency numbers then show.
+  bool publish(const std::string &topic, const std::string &payload) {
+    while (inflight_.size() >= 1024) {
+      if (!pump(100)) {
+        return false;
+      }
+    }
+    if (++packetId_ == 0) {
+      packetId_ = 1;
+    }
+    const std::vector<uint8_t> packet =
+        buildPublishQos1(topic, packetId_, payload);
+    inflight_[packetId_] = nowMs();
+    return sendAll(packet.data(), packet.size());
+  }
+
+  // Collect acks until the deadline or until the line goes quiet empty
+  bool drain(int64_t deadlineMs) {
+    while (!inflight_.empty() && nowMs() < deadlineMs) {
+      if (!pump(100)) {
+        return false;
+      }
+    }
+    return inflight_.empty();
+  }
+
+  // Service the socket for up to timeoutMs; false means the broker hung up
+  bool pump(int timeoutMs) {
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    const int ready = poll(&pfd, 1, timeoutMs);
+    if (ready <= 0) {
+      return ready == 0 || errno == EINTR;
+    }
+    uint8_t chunk[4096];
+    const ssize_t received = recv(fd_, chunk, sizeof(chunk), 0);
+    if (received <= 0) {
+      return false;
+    }
+    rxBuffer_.insert(rxBuffer_.end(), chunk, chunk + received);
+    // CONNACK and PUBACK are both fixed 4-byte packets, the only thing
+    // the broker sends us (no subscriptions, keepalive off)
+    while (rxBuffer_.size() >= 4) {
+      const uint8_t type = rxBuffer_[0] & 0xF0;
+      if (type == 0x20) {
+        if (rxBuffer_[3] != 0) {
+          fprintf(stderr, "replay: broker refused connection (rc=%u)\n",
+                  rxBuffer_[3]);
+          return false;
+        }
+        connected_ = true;
+      } else if (type == 0x40) {
+        const uint16_t id = ((uint16_t)rxBuffer_[2] << 8) | rxBuffer_[3];
+        const auto it = inflight_.find(id);
+        if (it != inflight_.end()) {
+          latency_.record(nowMs() - it->second);
+          inflight_.erase(it);
+          acked_++;
+        }
+      }
+      rxBuffer_.erase(rxBuffer_.begin(), rxBuffer_.begin() + 4);
+    }
+    return true;
+  }
+
+  uint64_t acked() const { return acked_; }
+  size_t inflight() const { return inflight_.size(); }
+  LatencyRecorder &latency() { return latency_; }
+
+private:
+  bool sendAll(const uint8_t *data, size_t length) {
+    size_t sent = 0;
+    while (sent < length) {
+      const ssize_t n = send(fd_, data + sent, length - sent, MSG_NOSIGNAL);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      sent += n;
+    }
+    return true;
+  }
+
+  int fd_ = -1;
+  bool connected_ = false;
+  uint16_t packetId_ = 0;
+  std::unordered_map<uint16_t, int64_t> inflight_;
+  std::vector<uint8_t> rxBuffer_;
+  LatencyRecorder latency_;
+  uint64_t acked_ = 0;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  std::vector<Record> records;
+  std::string error;
+  const bool loaded = options.csvPath.empty()
+                          ? loadLog(options, records, error)
+                          : loadCsv(options, records, error);
+  if (!loaded) {
+    fprintf(stderr, "replay: %s\n", error.c_str());
+    return 1;
+  }
+  if (records.empty()) {
+    fprintf(stderr, "replay: no records to replay\n");
+    return 1;
+  }
+
+  Publisher publisher;
+  if (!publisher.connect(options, error)) {
+    fprintf(stderr, "replay: %s\n", error.c_str());
+    return 1;
+  }
+
+  const int64_t spanMs = records.back().offsetMs;
+  printf("replay: %zu records spanning %.1f min -> %s:%u at %gx"
+         " (%.1f min wall, fanout %u)\n",
+         records.size(), spanMs / 60000.0, options.broker.c_str(),
+         options.port, options.speed, spanMs / options.speed / 60000.0,
+         options.fanout);
+
+  const int64_t startMs = nowMs();
+  int64_t lastReportMs = startMs;
+  uint64_t published = 0;
+  bool brokerLost = false;
+  for (const Record &record : records) {
+    if (shuttingDown) {
+      break;
+    }
+    // Original inter-arrival timing, compressed by the speed factor;
+    // scheduling against the run start (not the previous send) keeps
+    // one slow publish from shifting every record after it
+    const int64_t dueMs = startMs + (int64_t)(record.offsetMs / options.speed);
+    while (!shuttingDown && nowMs() < dueMs) {
+      if (!publisher.pump((int)std::min<int64_t>(dueMs - nowMs(), 100))) {
+        brokerLost = true;
+        break;
+      }
+    }
+    if (brokerLost) {
+      break;
+    }
+    for (unsigned i = 0; i < options.fanout; i++) {
+      if (!publisher.publish(record.topic, record.payload)) {
+        brokerLost = true;
+        break;
+      }
+      published++;
+    }
+    if (brokerLost) {
+      break;
+    }
+    const int64_t now = nowMs();
+    if (now - lastReportMs >= 10000) {
+      lastReportMs = now;
+      printf("replay: %llu published, %llu acked, %zu inflight\n",
+             (unsigned long long)published,
+             (unsigned long long)publisher.acked(), publisher.inflight());
+    }
+  }
+  if (brokerLost) {
+    fprintf(stderr, "replay: broker connection lost mid-replay\n");
+  } else if (!publisher.drain(nowMs() + 10000)) {
+    fprintf(stderr, "replay: %zu publishes never acked\n",
+            publisher.inflight());
+  }
+
+  const double elapsedS = (nowMs() - startMs) / 1000.0;
+  printf("replay: %llu published, %llu acked in %.1fs (%.1f msg/s)\n",
+         (unsigned long long)published, (unsigned long long)publisher.acked(),
+         elapsedS, elapsedS > 0 ? published / elapsedS : 0.0);
+  publisher.latency().report("publish");
+  return brokerLost ? 1 : 0;
+}
@@ -0,0 +1,444 @@
+// sectorqd: query accelerator for the sector dashboard.
+//
+// back/query_sector.py opens a fresh Postgres connection and sends
+// ad-hoc SQL for every dashboard request, so each page load pays
+// connect + auth + parse + plan before any rows move, and sector
+// overview pages take seconds under load. This daemon keeps a small
+// pool of persistent connections with the fixed query shapes prepared
+// once (see sector_queries.h), and serves repeat queries from an
+// in-process result cache invalidated by the ingestion stream (see
+// result_cache.h): telemetry on the broker stales live series, device
+// commands stale the command/state shapes, historical ranges never go
+// stale.
+//
+//   GET /sector/commands?sector=A[&limit=10]       -> command history
+//   GET /sector/states?sector=A                    -> newest state per device
+//   GET /sector/series?sector=A&metric=temperature
+//       &from=MS&to=MS[&res=60]                    -> [[bucketMs,avg],...]
+//
+// Usage:
+//   sectorqd [--http-port 8092] [--db back/database.ini] [--workers 2]
+//            [--broker host] [--port 1883] [--user u] [--password p]
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "database_ini.h"
+#include "mqtt_consumer.h"
+#include "result_cache.h"
+#include "sector_queries.h"
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t epochMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Options {
+  uint16_t httpPort = 8092;
+  std::string dbIni = "back/database.ini";
+  unsigned workers = 2;
+  std::string broker = "127.0.0.1";
+  uint16_t port = 1883;
+  std::string user;
+  std::string password;
+};
+
+bool parseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--http-port" && hasValue) {
+      options.httpPort = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--db" && hasValue) {
+      options.dbIni = argv[++i];
+    } else if (arg == "--workers" && hasValue) {
+      options.workers = static_cast<unsigned>(atoi(argv[++i]));
+    } else if (arg == "--broker" && hasValue) {
+      options.broker = argv[++i];
+    } else if (arg == "--port" && hasValue) {
+      options.port = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--user" && hasValue) {
+      options.user = argv[++i];
+    } else if (arg == "--password" && hasValue) {
+      options.password = argv[++i];
+    } else {
+      fprintf(stderr,
+              "usage: sectorqd [--http-port n] [--db ini] [--workers n]\n"
+              "                [--broker host] [--port n] [--user u]\n"
+              "                [--password p]\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+// Extracts a query parameter value from a request target
+bool queryParam(const std::string &target, const std::string &name,
+                std::string &out) {
+  const std::string needle = name + "=";
+  size_t pos = target.find('?');
+  while (pos != std::string::npos) {
+    pos++;
+    if (target.compare(pos, needle.size(), needle) == 0) {
+      const size_t start = pos + needle.size();
+      const size_t end = target.find('&', start);
+      out = target.substr(start, end == std::string::npos ? std::string::npos
+                                                          : end - start);
+      return true;
+    }
+    pos = target.find('&', pos);
+  }
+  return false;
+}
+
+void sendHttp(int fd, const char *status, const std::string &body) {
+  char head[128];
+  const int headLength = snprintf(
+      head, sizeof(head),
+      "HTTP/1.1 %s\r\nContent-Type: application/json\r\n"
+      "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+      status, body.size());
+  (void)!write(fd, head, headLength);
+  (void)!write(fd, body.data(), body.size());
+}
+
+int listenOn(uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(port);
+  if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, 16) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// A parsed, validated request on its way to a query worker. The IO
+// thread hands the socket over with the job; whoever answers closes it.
+struct Job {
+  enum Kind { COMMANDS, STATES, SERIES };
+  int fd;
+  Kind kind;
+  std::string key;  // canonical cache key
+  std::string sector;
+  std::string metric;
+  int limit = 10;
+  int64_t fromMs = 0;
+  int64_t toMs = 0;
+  int resSeconds = 60;
+  bool liveData = false;  // series range included "now" when parsed
+};
+
+std::mutex jobMutex;
+std::condition_variable jobCv;
+std::deque<Job> jobQueue;
+
+std::atomic<uint64_t> served{0};
+std::atomic<uint64_t> cacheHits{0};
+
+// Each worker owns one prepared connection; the pool size bounds the
+// daemon's footprint on Postgres to --workers sessions, total, however
+// many dashboards are open
+void queryWorker(const std::string &conninfo, ResultCache *cache) {
+  SectorQueries queries;
+  std::string error;
+  if (!queries.connect(conninfo, error)) {
+    // ensureLive() redials per request; the daemon still serves cache
+    fprintf(stderr, "sectorqd: postgres: %s\n", error.c_str());
+  }
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(jobMutex);
+      jobCv.wait(lock, [] { return !jobQueue.empty() || shuttingDown; });
+      if (jobQueue.empty()) {
+        return;
+      }
+      job = std::move(jobQueue.front());
+      jobQueue.pop_front();
+    }
+    std::string body;
+    bool ok = false;
+    switch (job.kind) {
+      case Job::COMMANDS:
+        ok = queries.commands(job.sector, job.limit, body, error);
+        break;
+      case Job::STATES:
+        ok = queries.states(job.sector, body, error);
+        break;
+      case Job::SERIES:
+        ok = queries.series(job.sector, job.metric, job.fromMs, job.toMs,
+                            job.resSeconds, body, error);
+        break;
+    }
+    if (ok) {
+      cache->insert(job.key, body, job.kind != Job::SERIES, job.liveData);
+      sendHttp(job.fd, "200 OK", body);
+      served.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      fprintf(stderr, "sectorqd: query failed: %s\n", error.c_str());
+      sendHttp(job.fd, "500 Internal Server Error",
+               "{\"error\":\"query failed\"}");
+    }
+    close(job.fd);
+  }
+}
+
+// One short-lived connection per dashboard query: read the request
+// line, answer from cache or hand off to a worker, close. The IO
+// thread never touches Postgres, so a slow query delays its co-queued
+// requests, not the accept loop.
+void handleHttpClient(int fd, ResultCache &cache) {
+  char request[2048];
+  const ssize_t n = recv(fd, request, sizeof(request) - 1, 0);
+  if (n <= 0) {
+    close(fd);
+    return;
+  }
+  request[n] = '\0';
+  char method[8];
+  char target[1024];
+  if (sscanf(request, "%7s %1023s", method, target) != 2 ||
+      strcmp(method, "GET") != 0) {
+    sendHttp(fd, "405 Method Not Allowed", "{\"error\":\"GET only\"}");
+    close(fd);
+    return;
+  }
+  const std::string targetStr = target;
+
+  Job job;
+  job.fd = fd;
+  if (!queryParam(targetStr, "sector", job.sector) || job.sector.empty()) {
+    sendHttp(fd, "400 Bad Request", "{\"error\":\"sector required\"}");
+    close(fd);
+    return;
+  }
+
+  if (targetStr.rfind("/sector/commands", 0) == 0) {
+    job.kind = Job::COMMANDS;
+    std::string limitStr;
+    if (queryParam(targetStr, "limit", limitStr)) {
+      job.limit = atoi(limitStr.c_str());
+      if (job.limit < 1 || job.limit > 1000) {
+        job.limit = 10;
+      }
+    }
+    job.key = "cmd|" + job.sector + "|" + std::to_string(job.limit);
+  } else if (targetStr.rfind("/sector/states", 0) == 0) {
+    job.kind = Job::STATES;
+    job.key = "state|" + job.sector;
+  } else if (targetStr.rfind("/sector/series", 0) == 0) {
+    job.kind = Job::SERIES;
+    std::string fromStr;
+    std::string toStr;
+    if (!queryParam(targetStr, "metric", job.metric) ||
+        (job.metric != "temperature" && job.metric != "humidity" &&
+         job.metric != "light") ||
+        !queryParam(targetStr, "from", fromStr) ||
+        !queryParam(targetStr, "to", toStr)) {
+      sendHttp(fd, "400 Bad Request",
+               "{\"error\":\"metric (temperature|humidity|light), from, to "
+               "required\"}");
+      close(fd);
+      return;
+    }
+    job.fromMs = atoll(fromStr.c_str());
+    job.toMs = atoll(toStr.c_str());
+    std::string resStr;
+    if (queryParam(targetStr, "res", resStr)) {
+      job.resSeconds = atoi(resStr.c_str());
+      if (job.resSeconds < 1) {
+        job.resSeconds = 60;
+      }
+    }
+    // A range still open at the right edge is fed by live telemetry;
+    // a fully historical one can be cached forever
+    job.liveData = job.toMs >= epochMs();
+    job.key = "series|" + job.sector + "|" + job.metric + "|" +
+              std::to_string(job.fromMs) + "|" + std::to_string(job.toMs) +
+              "|" + std::to_string(job.resSeconds);
+  } else {
+    sendHttp(fd, "404 Not Found", "{\"error\":\"unknown endpoint\"}");
+    close(fd);
+    return;
+  }
+
+  std::string body;
+  if (cache.lookup(job.key, body)) {
+    sendHttp(fd, "200 OK", body);
+    close(fd);
+    cacheHits.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    jobQueue.push_back(std::move(job));
+  }
+  jobCv.notify_one();
+}
+
+const std::vector<std::string> kInvalidationTopics = {
+    "v1/devices/me/telemetry",    "v1/devices/me/telemetry/bin",
+    "v1/devices/me/telemetry/lz", "coreiot/gateway/telemetry",
+    "coreiot/gateway/telemetry/lz", "coreiot/+/commands"};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  std::string conninfo;
+  std::string error;
+  if (!conninfoFromIni(options.dbIni, conninfo, error)) {
+    fprintf(stderr, "sectorqd: %s\n", error.c_str());
+    return 1;
+  }
+
+  ResultCache cache;
+
+  // The ingestion stream is the invalidation signal: telemetry stales
+  // live series, a command on any device's topic stales the
+  // command/state shapes. No TTLs to tune, no stale dashboards.
+  MqttConsumer consumer;
+  consumer.setMessageHandler([&cache](const std::string &topic,
+                                      const uint8_t *, size_t) {
+    if (topic.size() > 9 &&
+        topic.compare(topic.size() - 9, 9, "/commands") == 0) {
+      cache.bumpCommands();
+    } else {
+      cache.bumpData();
+    }
+  });
+  bool mqttConnected =
+      consumer.connect(options.broker, options.port, "sectorqd", options.user,
+                       options.password, error) &&
+      consumer.subscribe(kInvalidationTopics, error);
+  if (!mqttConnected) {
+    // Queries still work without the broker; live entries just expire
+    // via generation bumps that never come, so skip caching nothing —
+    // reconnect from the timer tick
+    fprintf(stderr, "sectorqd: mqtt: %s (will retry)\n", error.c_str());
+  }
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < options.workers; i++) {
+    workers.emplace_back(queryWorker, conninfo, &cache);
+  }
+
+  const int httpFd = listenOn(options.httpPort);
+  if (httpFd < 0) {
+    fprintf(stderr, "sectorqd: cannot listen on port %u\n", options.httpPort);
+    return 1;
+  }
+  printf("sectorqd: http on :%u, %u query workers\n", options.httpPort,
+         options.workers);
+
+  const int epollFd = epoll_create1(0);
+  const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+  struct itimerspec interval = {};
+  interval.it_interval.tv_sec = 10;
+  interval.it_value.tv_sec = 10;
+  timerfd_settime(timerFd, 0, &interval, nullptr);
+
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = httpFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, httpFd, &event);
+  event.data.fd = timerFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+  if (mqttConnected) {
+    event.data.fd = consumer.fd();
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+  }
+
+  uint64_t lastServed = 0;
+  uint64_t lastHits = 0;
+  while (!shuttingDown) {
+    struct epoll_event events[8];
+    const int ready = epoll_wait(epollFd, events, 8, 1000);
+    for (int i = 0; i < ready; i++) {
+      const int fd = events[i].data.fd;
+      if (fd == httpFd) {
+        const int client = accept(httpFd, nullptr, nullptr);
+        if (client >= 0) {
+          handleHttpClient(client, cache);
+        }
+      } else if (fd == timerFd) {
+        uint64_t expirations;
+        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+        }
+        if (mqttConnected) {
+          consumer.tick(epochMs());
+        } else if (consumer.connect(options.broker, options.port, "sectorqd",
+                                    options.user, options.password, error) &&
+                   consumer.subscribe(kInvalidationTopics, error)) {
+          mqttConnected = true;
+          event.events = EPOLLIN;
+          event.data.fd = consumer.fd();
+          epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+        }
+        const uint64_t total = served.load(std::memory_order_relaxed);
+        const uint64_t hits = cacheHits.load(std::memory_order_relaxed);
+        if (total != lastServed || hits != lastHits) {
+          printf("sectorqd: %llu queried, %llu from cache (%.0f%%), "
+                 "%zu entries\n",
+                 (unsigned long long)total, (unsigned long long)hits,
+                 total + hits ? 100.0 * hits / (total + hits) : 0.0,
+                 cache.size());
+          lastServed = total;
+          lastHits = hits;
+        }
+      } else if (mqttConnected && fd == consumer.fd()) {
+        if (!consumer.onReadable()) {
+          epoll_ctl(epollFd, EPOLL_CTL_DEL, consumer.fd(), nullptr);
+          consumer.close();
+          mqttConnected = false;  // timer tick reconnects
+        }
+      }
+    }
+  }
+
+  printf("sectorqd: shutting down\n");
+  jobCv.notify_all();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  close(httpFd);
+  close(timerFd);
+  close(epollFd);
+  return 0;
+}
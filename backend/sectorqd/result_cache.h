@@ -0,0 +1,99 @@
+#ifndef SECTORQD_RESULT_CACHE_H
+#define SECTORQD_RESULT_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// In-process cache of rendered response bodies, keyed by the canonical
+// request string (endpoint|sector|range|resolution). Dashboards are
+// repetitive: every operator looking at sector A's overview issues the
+// same three queries, and auto-refresh reissues them on a timer. A hit
+// serves the stored body without touching Postgres — microseconds
+// against the milliseconds of a planned, pooled round trip.
+//
+// Invalidation rides the ingestion stream rather than a TTL guess.
+// Command-shaped results go stale when a device command flows (the
+// commands generation bumps); series results go stale on telemetry —
+// but only if their range extended to "now" when built. A chart of
+// last week is immutable no matter how much new telemetry arrives, so
+// those entries live until evicted.
+class ResultCache {
+public:
+  // At three shapes per sector and a handful of chart ranges this is
+  // generous; eviction is oldest-insert-first and exists as a backstop
+  // against unbounded ad-hoc ranges
+  static constexpr size_t kMaxEntries = 1024;
+
+  // Generation bumps, called from the ingestion (MQTT) thread
+  void bumpCommands() { commandsGen_.fetch_add(1, std::memory_order_relaxed); }
+  void bumpData() { dataGen_.fetch_add(1, std::memory_order_relaxed); }
+
+  bool lookup(const std::string &key, std::string &body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return false;
+    }
+    const Entry &entry = it->second;
+    const bool stale =
+        (entry.onCommands &&
+         entry.commandsGen != commandsGen_.load(std::memory_order_relaxed)) ||
+        (entry.liveData &&
+         entry.dataGen != dataGen_.load(std::memory_order_relaxed));
+    if (stale) {
+      entries_.erase(it);
+      return false;
+    }
+    body = entry.body;
+    return true;
+  }
+
+  // onCommands: result reads Device_Commands. liveData: result reads
+  // Data_* over a range that included "now" at build time.
+  void insert(const std::string &key, const std::string &body,
+              bool onCommands, bool liveData) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.size() >= kMaxEntries) {
+      auto victim = entries_.begin();
+      for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->second.order < victim->second.order) {
+          victim = it;
+        }
+      }
+      entries_.erase(victim);
+    }
+    Entry &entry = entries_[key];
+    entry.body = body;
+    entry.onCommands = onCommands;
+    entry.liveData = liveData;
+    entry.commandsGen = commandsGen_.load(std::memory_order_relaxed);
+    entry.dataGen = dataGen_.load(std::memory_order_relaxed);
+    entry.order = nextOrder_++;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+private:
+  struct Entry {
+    std::string body;
+    bool onCommands = false;
+    bool liveData = false;
+    uint64_t commandsGen = 0;
+    uint64_t dataGen = 0;
+    uint64_t order = 0;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  uint64_t nextOrder_ = 0;
+  std::atomic<uint64_t> commandsGen_{0};
+  std::atomic<uint64_t> dataGen_{0};
+};
+
+#endif // SECTORQD_RESULT_CACHE_H
@@ -0,0 +1,223 @@
+#include "sector_queries.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// The fixed dashboard shapes, prepared once per connection. Timestamps
+// leave as epoch milliseconds so the WebApp formats them client-side
+// instead of round-tripping strings.
+struct Statement {
+  const char *name;
+  const char *sql;
+};
+
+const Statement kStatements[] = {
+    {"sector_commands",
+     "SELECT CommandID, Device, Status, Type, Command_Data::text, "
+     "(extract(epoch from Timestamp) * 1000)::bigint "
+     "FROM Device_Commands WHERE Sector = $1 "
+     "ORDER BY Timestamp DESC LIMIT $2"},
+    // Newest row per device: DISTINCT ON walks the (Sector, Device)
+    // index once, where the Python tool's MAX() self-join scanned twice
+    {"sector_states",
+     "SELECT DISTINCT ON (Device) Device, Type, Status, "
+     "(extract(epoch from Timestamp) * 1000)::bigint "
+     "FROM Device_Commands WHERE Sector = $1 "
+     "ORDER BY Device, Timestamp DESC"},
+    {"series_temperature",
+     "SELECT (floor(extract(epoch from d.Timestamp) / $4) * $4 * "
+     "1000)::bigint AS bucket, avg(d.Value) "
+     "FROM Data_Temperature d JOIN Device dev ON dev.DID = d.DID "
+     "WHERE dev.Location = $1 AND d.Timestamp >= to_timestamp($2) "
+     "AND d.Timestamp < to_timestamp($3) "
+     "GROUP BY bucket ORDER BY bucket"},
+    {"series_humidity",
+     "SELECT (floor(extract(epoch from d.Timestamp) / $4) * $4 * "
+     "1000)::bigint AS bucket, avg(d.Value) "
+     "FROM Data_Humidity d JOIN Device dev ON dev.DID = d.DID "
+     "WHERE dev.Location = $1 AND d.Timestamp >= to_timestamp($2) "
+     "AND d.Timestamp < to_timestamp($3) "
+     "GROUP BY bucket ORDER BY bucket"},
+    {"series_light",
+     "SELECT (floor(extract(epoch from d.Timestamp) / $4) * $4 * "
+     "1000)::bigint AS bucket, avg(d.Value) "
+     "FROM Data_Light d JOIN Device dev ON dev.DID = d.DID "
+     "WHERE dev.Location = $1 AND d.Timestamp >= to_timestamp($2) "
+     "AND d.Timestamp < to_timestamp($3) "
+     "GROUP BY bucket ORDER BY bucket"},
+};
+
+// DB strings land inside JSON string literals; sector/device names are
+// operator-entered, so quotes and control bytes must not break the body
+void appendJsonString(std::string &out, const char *s) {
+  out += '"';
+  for (; *s != '\0'; s++) {
+    const unsigned char c = static_cast<unsigned char>(*s);
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += static_cast<char>(c);
+    } else if (c < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += static_cast<char>(c);
+    }
+  }
+  out += '"';
+}
+
+}  // namespace
+
+bool SectorQueries::connect(const std::string &conninfo, std::string &error) {
+  disconnect();
+  conninfo_ = conninfo;
+  conn_ = PQconnectdb(conninfo.c_str());
+  if (PQstatus(conn_) != CONNECTION_OK) {
+    error = PQerrorMessage(conn_);
+    disconnect();
+    return false;
+  }
+  return prepareAll(error);
+}
+
+void SectorQueries::disconnect() {
+  if (conn_ != nullptr) {
+    PQfinish(conn_);
+    conn_ = nullptr;
+  }
+}
+
+bool SectorQueries::prepareAll(std::string &error) {
+  for (const Statement &statement : kStatements) {
+    PGresult *result =
+        PQprepare(conn_, statement.name, statement.sql, 0, nullptr);
+    const bool ok =
+        result != nullptr && PQresultStatus(result) == PGRES_COMMAND_OK;
+    if (!ok) {
+      error = PQerrorMessage(conn_);
+    }
+    PQclear(result);
+    if (!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SectorQueries::ensureLive(std::string &error) {
+  if (conn_ != nullptr && PQstatus(conn_) == CONNECTION_OK) {
+    return true;
+  }
+  return connect(conninfo_, error);
+}
+
+PGresult *SectorQueries::execPrepared(const char *name, int nParams,
+                                      const char *const *params,
+                                      std::string &error) {
+  if (!ensureLive(error)) {
+    return nullptr;
+  }
+  PGresult *result = PQexecPrepared(conn_, name, nParams, params, nullptr,
+                                    nullptr, 0);
+  if (result == nullptr || PQresultStatus(result) != PGRES_TUPLES_OK) {
+    error = PQerrorMessage(conn_);
+    PQclear(result);
+    // One retry through a fresh connection covers the idle-timeout and
+    // server-restart cases without surfacing them to the dashboard
+    if (!ensureLive(error)) {
+      return nullptr;
+    }
+    result = PQexecPrepared(conn_, name, nParams, params, nullptr, nullptr, 0);
+    if (result == nullptr || PQresultStatus(result) != PGRES_TUPLES_OK) {
+      error = PQerrorMessage(conn_);
+      PQclear(result);
+      return nullptr;
+    }
+  }
+  return result;
+}
+
+bool SectorQueries::commands(const std::string &sector, int limit,
+                             std::string &body, std::string &error) {
+  const std::string limitStr = std::to_string(limit);
+  const char *params[] = {sector.c_str(), limitStr.c_str()};
+  PGresult *result = execPrepared("sector_commands", 2, params, error);
+  if (result == nullptr) {
+    return false;
+  }
+  body = "[";
+  for (int row = 0; row < PQntuples(result); row++) {
+    body += row == 0 ? "{" : ",{";
+    body += "\"command_id\":";
+    body += PQgetvalue(result, row, 0);
+    body += ",\"device\":";
+    appendJsonString(body, PQgetvalue(result, row, 1));
+    body += ",\"status\":";
+    body += PQgetvalue(result, row, 2)[0] == 't' ? "true" : "false";
+    body += ",\"type\":";
+    appendJsonString(body, PQgetvalue(result, row, 3));
+    // Command_Data is already JSON; embed it as-is
+    body += ",\"data\":";
+    body += PQgetvalue(result, row, 4);
+    body += ",\"timestamp\":";
+    body += PQgetvalue(result, row, 5);
+    body += "}";
+  }
+  body += "]";
+  PQclear(result);
+  return true;
+}
+
+bool SectorQueries::states(const std::string &sector, std::string &body,
+                           std::string &error) {
+  const char *params[] = {sector.c_str()};
+  PGresult *result = execPrepared("sector_states", 1, params, error);
+  if (result == nullptr) {
+    return false;
+  }
+  body = "[";
+  for (int row = 0; row < PQntuples(result); row++) {
+    body += row == 0 ? "{" : ",{";
+    body += "\"device\":";
+    appendJsonString(body, PQgetvalue(result, row, 0));
+    body += ",\"type\":";
+    appendJsonString(body, PQgetvalue(result, row, 1));
+    body += ",\"status\":";
+    body += PQgetvalue(result, row, 2)[0] == 't' ? "true" : "false";
+    body += ",\"timestamp\":";
+    body += PQgetvalue(result, row, 3);
+    body += "}";
+  }
+  body += "]";
+  PQclear(result);
+  return true;
+}
+
+bool SectorQueries::series(const std::string &sector, const std::string &metric,
+                           int64_t fromMs, int64_t toMs, int resSeconds,
+                           std::string &body, std::string &error) {
+  const std::string name = "series_" + metric;
+  const std::string fromStr = std::to_string(fromMs / 1000);
+  const std::string toStr = std::to_string(toMs / 1000);
+  const std::string resStr = std::to_string(resSeconds);
+  const char *params[] = {sector.c_str(), fromStr.c_str(), toStr.c_str(),
+                          resStr.c_str()};
+  PGresult *result = execPrepared(name.c_str(), 4, params, error);
+  if (result == nullptr) {
+    return false;
+  }
+  body = "[";
+  for (int row = 0; row < PQntuples(result); row++) {
+    body += row == 0 ? "[" : ",[";
+    body += PQgetvalue(result, row, 0);
+    body += ",";
+    body += PQgetvalue(result, row, 1);
+    body += "]";
+  }
+  body += "]";
+  PQclear(result);
+  return true;
+}
@@ -0,0 +1,54 @@
+#ifndef SECTORQD_SECTOR_QUERIES_H
+#define SECTORQD_SECTOR_QUERIES_H
+
+#include <cstdint>
+#include <string>
+
+#include <libpq-fe.h>
+
+// One persistent Postgres connection with the sector dashboard's fixed
+// query shapes prepared once. back/query_sector.py opened a fresh
+// connection and sent ad-hoc SQL per request, so every dashboard hit
+// paid TCP + auth + parse + plan before any rows moved; here the
+// connection lives as long as the worker and each request is one
+// Bind/Execute round trip of an already-planned statement.
+//
+// Three shapes, matching what the sector pages actually ask:
+//   commands  — last N rows of Device_Commands for a sector
+//   states    — newest row per device in a sector (DISTINCT ON replaces
+//               the Python tool's self-join; same rows, one scan)
+//   series    — time-bucketed avg of a Data_* metric over the sector's
+//               devices (Device.Location is the sector), for charts
+//
+// All results render to the JSON the WebApp expects. Statements are
+// re-prepared after a reconnect; callers just see one failed request.
+class SectorQueries {
+public:
+  ~SectorQueries() { disconnect(); }
+
+  bool connect(const std::string &conninfo, std::string &error);
+  void disconnect();
+
+  bool commands(const std::string &sector, int limit, std::string &body,
+                std::string &error);
+  bool states(const std::string &sector, std::string &body,
+              std::string &error);
+  // fromMs/toMs are unix epoch milliseconds; resSeconds is the bucket
+  // width. metric must be one of temperature|humidity|light.
+  bool series(const std::string &sector, const std::string &metric,
+              int64_t fromMs, int64_t toMs, int resSeconds, std::string &body,
+              std::string &error);
+
+private:
+  bool prepareAll(std::string &error);
+  // Drops and redials the connection when the server went away, so a
+  // Postgres restart costs the affected requests, not the daemon
+  bool ensureLive(std::string &error);
+  PGresult *execPrepared(const char *name, int nParams,
+                         const char *const *params, std::string &error);
+
+  std::string conninfo_;
+  PGconn *conn_ = nullptr;
+};
+
+#endif // SECTORQD_SECTOR_QUERIES_H
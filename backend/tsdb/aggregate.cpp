@@ -0,0 +1,92 @@
+#include "aggregate.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Lanes per accumulator. Four doubles is one AVX2 register (two NEON);
+// wider buys nothing once the loads stream from L2.
+constexpr size_t kLanes = 4;
+
+}  // namespace
+
+void aggregateBlock(const double *values, size_t count, RangeStats &stats) {
+  if (count == 0) {
+    return;
+  }
+  size_t i = 0;
+  if (stats.count == 0) {
+    stats.min = values[0];
+    stats.max = values[0];
+  }
+  double minLane[kLanes];
+  double maxLane[kLanes];
+  double sumLane[kLanes] = {0.0, 0.0, 0.0, 0.0};
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    minLane[lane] = stats.min;
+    maxLane[lane] = stats.max;
+  }
+  // Independent lanes: no value feeds the next iteration, so the
+  // compiler is free to keep each lane in one SIMD element
+  for (; i + kLanes <= count; i += kLanes) {
+    for (size_t lane = 0; lane < kLanes; lane++) {
+      const double v = values[i + lane];
+      minLane[lane] = v < minLane[lane] ? v : minLane[lane];
+      maxLane[lane] = v > maxLane[lane] ? v : maxLane[lane];
+      sumLane[lane] += v;
+    }
+  }
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    stats.min = minLane[lane] < stats.min ? minLane[lane] : stats.min;
+    stats.max = maxLane[lane] > stats.max ? maxLane[lane] : stats.max;
+    stats.sum += sumLane[lane];
+  }
+  for (; i < count; i++) {
+    const double v = values[i];
+    stats.min = v < stats.min ? v : stats.min;
+    stats.max = v > stats.max ? v : stats.max;
+    stats.sum += v;
+  }
+  stats.count += count;
+}
+
+void aggregateRange(TsdbStore &store, const std::string &series,
+                    int64_t fromMs, int64_t toMs,
+                    const std::vector<double> &percentileRanks,
+                    RangeStats &stats, std::vector<double> &percentilesOut) {
+  std::vector<double> block(kAggregateBlockDoubles);
+  std::vector<double> retained;
+  const bool keepValues = !percentileRanks.empty();
+  size_t fill = 0;
+  store.scan(series, fromMs, toMs,
+             [&](const Segment::Point &point) {
+               block[fill++] = point.value;
+               if (fill == kAggregateBlockDoubles) {
+                 aggregateBlock(block.data(), fill, stats);
+                 if (keepValues) {
+                   retained.insert(retained.end(), block.begin(), block.end());
+                 }
+                 fill = 0;
+               }
+             });
+  aggregateBlock(block.data(), fill, stats);
+  if (keepValues) {
+    retained.insert(retained.end(), block.begin(), block.begin() + fill);
+  }
+
+  for (double rank : percentileRanks) {
+    if (retained.empty()) {
+      percentilesOut.push_back(0.0);
+      continue;
+    }
+    // Nearest-rank selection: nth_element is O(n) and the partial
+    // ordering it leaves behind stays valid for the next rank
+    const double clamped = std::min(100.0, std::max(0.0, rank));
+    size_t idx = static_cast<size_t>(
+        std::ceil(clamped / 100.0 * static_cast<double>(retained.size())));
+    idx = idx > 0 ? idx - 1 : 0;
+    std::nth_element(retained.begin(), retained.begin() + idx, retained.end());
+    percentilesOut.push_back(retained[idx]);
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef TSDB_AGGREGATE_H
+#define TSDB_AGGREGATE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tsdb_store.h"
+
+// Range aggregation over raw series: min/max/avg and percentiles for an
+// arbitrary [from, to] in one decode pass, so the dashboard can answer
+// "what was the p95 moisture this season" without precomputed rollups.
+//
+// The values live XOR-compressed in the mapped segments, so kernels
+// cannot run on the mapping directly — decode is the serial part of the
+// scan. What vectorizes is everything after it: decoded values are
+// gathered into an L2-sized block and min/max/sum are folded over the
+// block in independent accumulator lanes, which removes the loop-carried
+// dependences and lets the compiler emit packed SSE2/NEON for the
+// kernel — no intrinsics, same source everywhere (see the scoped
+// finite-math flags in CMakeLists.txt; telemetry is finite by
+// construction). One pass produces all three statistics; the only extra
+// memory is the 32KB block, unless percentiles are requested (those
+// need the values).
+
+struct RangeStats {
+  uint64_t count = 0;
+  double min = 0.0;
+  double max = 0.0;
+  double sum = 0.0;
+
+  double avg() const { return count > 0 ? sum / static_cast<double>(count) : 0.0; }
+};
+
+// Decoded values per kernel block: 4096 doubles = 32KB, small enough to
+// sit in L2 next to the decoder state while the lanes stream over it
+constexpr size_t kAggregateBlockDoubles = 4096;
+
+// Fused min/max/sum over one block of decoded values, accumulated into
+// stats (call repeatedly across blocks)
+void aggregateBlock(const double *values, size_t count, RangeStats &stats);
+
+// One scan of the raw series: fills stats, and for each rank in
+// percentileRanks (0..100, e.g. {50, 95}) appends the nearest-rank
+// percentile to percentilesOut. Ranks force the values to be retained
+// for selection; pass an empty list to keep the scan allocation-free
+// beyond the block.
+void aggregateRange(TsdbStore &store, const std::string &series,
+                    int64_t fromMs, int64_t toMs,
+                    const std::vector<double> &percentileRanks,
+                    RangeStats &stats, std::vector<double> &percentilesOut);
+
+#endif // TSDB_AGGREGATE_H
@@ -0,0 +1,79 @@
+#ifndef TSDB_BITSTREAM_H
+#define TSDB_BITSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Bit-granular writer/reader over raw memory, the substrate for the
+// Gorilla-style point codec in segment.cpp. The writer targets a
+// memory-mapped data region directly, so an append is just bit pokes
+// into the page cache — no intermediate buffer, no copy.
+
+class BitWriter {
+public:
+  BitWriter(uint8_t *data, size_t capacityBytes)
+      : data_(data), capacityBits_(capacityBytes * 8) {}
+
+  // Resume at an existing bit position (reopening an active segment)
+  void seekBits(size_t bitPosition) { bitPosition_ = bitPosition; }
+  size_t bitPosition() const { return bitPosition_; }
+
+  bool full(size_t upcomingBits) const {
+    return bitPosition_ + upcomingBits > capacityBits_;
+  }
+
+  void writeBit(uint32_t bit) {
+    const size_t byte = bitPosition_ >> 3;
+    const uint32_t shift = 7 - (bitPosition_ & 7);
+    if (bit) {
+      data_[byte] |= static_cast<uint8_t>(1u << shift);
+    } else {
+      data_[byte] &= static_cast<uint8_t>(~(1u << shift));
+    }
+    bitPosition_++;
+  }
+
+  // Writes the low `bits` bits of value, most significant first
+  void writeBits(uint64_t value, uint32_t bits) {
+    for (uint32_t i = bits; i > 0; i--) {
+      writeBit(static_cast<uint32_t>((value >> (i - 1)) & 1u));
+    }
+  }
+
+private:
+  uint8_t *data_;
+  size_t capacityBits_;
+  size_t bitPosition_ = 0;
+};
+
+class BitReader {
+public:
+  BitReader(const uint8_t *data, size_t lengthBytes)
+      : data_(data), lengthBits_(lengthBytes * 8) {}
+
+  void seekBits(size_t bitPosition) { bitPosition_ = bitPosition; }
+  size_t bitPosition() const { return bitPosition_; }
+  bool exhausted() const { return bitPosition_ >= lengthBits_; }
+
+  uint32_t readBit() {
+    const size_t byte = bitPosition_ >> 3;
+    const uint32_t shift = 7 - (bitPosition_ & 7);
+    bitPosition_++;
+    return (data_[byte] >> shift) & 1u;
+  }
+
+  uint64_t readBits(uint32_t bits) {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < bits; i++) {
+      value = (value << 1) | readBit();
+    }
+    return value;
+  }
+
+private:
+  const uint8_t *data_;
+  size_t lengthBits_;
+  size_t bitPosition_ = 0;
+};
+
+#endif // TSDB_BITSTREAM_H
@@ -0,0 +1,72 @@
+#include "rollup.h"
+
+void RollupEngine::ingest(const std::string &series, int64_t timestampMs,
+                          double value) {
+  SeriesState &state = state_[series];
+  feed(series, state, 0, timestampMs, value, value, value, 1);
+}
+
+void RollupEngine::feed(const std::string &series, SeriesState &state,
+                        int level, int64_t timestampMs, double min, double max,
+                        double sum, uint32_t count) {
+  Bucket &bucket = state.levels[level];
+  const int64_t start = timestampMs - timestampMs % kBucketMs[level];
+
+  if (bucket.start >= 0 && start > bucket.start) {
+    close(series, state, level);
+  }
+  if (start < bucket.start) {
+    return;  // late sample, its bucket already closed; raw series has it
+  }
+  if (bucket.start < 0) {
+    bucket.start = start;
+    bucket.min = min;
+    bucket.max = max;
+    bucket.sum = sum;
+    bucket.count = count;
+    return;
+  }
+  if (min < bucket.min) {
+    bucket.min = min;
+  }
+  if (max > bucket.max) {
+    bucket.max = max;
+  }
+  bucket.sum += sum;
+  bucket.count += count;
+}
+
+void RollupEngine::close(const std::string &series, SeriesState &state,
+                         int level) {
+  Bucket &bucket = state.levels[level];
+  if (bucket.start < 0 || bucket.count == 0) {
+    return;
+  }
+  const std::string base = series + "." + kSuffix[level] + ".";
+  store_.append(base + "min", bucket.start, bucket.min);
+  store_.append(base + "avg", bucket.start, bucket.sum / bucket.count);
+  store_.append(base + "max", bucket.start, bucket.max);
+  bucketsClosed_++;
+
+  // Cascade before resetting: the coarser level aggregates closed
+  // buckets, never raw points
+  const Bucket closed = bucket;
+  bucket.start = -1;
+  bucket.count = 0;
+  if (level + 1 < kLevels) {
+    feed(series, state, level + 1, closed.start, closed.min, closed.max,
+         closed.sum, closed.count);
+  }
+}
+
+void RollupEngine::flushIdle(int64_t nowMs) {
+  for (auto &entry : state_) {
+    for (int level = 0; level < kLevels; level++) {
+      Bucket &bucket = entry.second.levels[level];
+      if (bucket.start >= 0 &&
+          nowMs - (bucket.start + kBucketMs[level]) > kBucketMs[level]) {
+        close(entry.first, entry.second, level);
+      }
+    }
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef TSDB_ROLLUP_H
+#define TSDB_ROLLUP_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "tsdb_store.h"
+
+// Streaming rollups: every raw append also feeds per-series bucket
+// aggregators at 1m, 15m and 1h, and a closed bucket lands three
+// derived series in the same store:
+//
+//   <series>.1m.min / <series>.1m.avg / <series>.1m.max   (and 15m, 1h)
+//
+// timestamped at the bucket start. Charts over long ranges then read a
+// few hundred pre-aggregated points instead of re-scanning millions of
+// raw ones (see pickResolution in tsdbd_main.cpp).
+//
+// Levels cascade — a closed 1m bucket feeds the 15m aggregator with its
+// (min, max, sum, count), and 15m feeds 1h — so each raw point is
+// touched exactly once. Buckets close when a sample lands past their
+// end, or via flushIdle() once the wall clock is a full bucket past
+// their end, so a device that goes quiet still gets its last bucket
+// persisted. A sample arriving after its bucket closed is dropped from
+// the rollups (it is still in the raw series); with in-order ingest
+// that only happens across a daemon restart.
+//
+// Called from the MQTT handler and the timer tick only — one thread, no
+// locking of its own (the store has its own mutex).
+class RollupEngine {
+public:
+  static constexpr int kLevels = 3;
+  static constexpr int64_t kBucketMs[kLevels] = {60 * 1000, 15 * 60 * 1000,
+                                                 60 * 60 * 1000};
+  static constexpr const char *kSuffix[kLevels] = {"1m", "15m", "1h"};
+
+  explicit RollupEngine(TsdbStore &store) : store_(store) {}
+
+  // Feed one raw sample (after the raw append)
+  void ingest(const std::string &series, int64_t timestampMs, double value);
+
+  // Close buckets whose end is more than one bucket behind nowMs
+  void flushIdle(int64_t nowMs);
+
+  uint64_t bucketsClosed() const { return bucketsClosed_; }
+
+private:
+  struct Bucket {
+    int64_t start = -1;  // -1 = empty
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+    uint32_t count = 0;
+  };
+  struct SeriesState {
+    Bucket levels[kLevels];
+  };
+
+  void feed(const std::string &series, SeriesState &state, int level,
+            int64_t timestampMs, double min, double max, double sum,
+            uint32_t count);
+  void close(const std::string &series, SeriesState &state, int level);
+
+  TsdbStore &store_;
+  std::unordered_map<std::string, SeriesState> state_;
+  uint64_t bucketsClosed_ = 0;
+};
+
+#endif // TSDB_ROLLUP_H
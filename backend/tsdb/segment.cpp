@@ -0,0 +1,341 @@
+#include "segment.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bitstream.h"
+
+namespace {
+
+// Worst case bits for one appended point: raw restart (128) or a
+// max-width delta (4+64) plus a max-width value (2+5+6+64)
+constexpr size_t kMaxPointBits = 160;
+
+uint32_t leadingZeros(uint64_t value) {
+  return value == 0 ? 64 : static_cast<uint32_t>(__builtin_clzll(value));
+}
+
+uint32_t trailingZeros(uint64_t value) {
+  return value == 0 ? 64 : static_cast<uint32_t>(__builtin_ctzll(value));
+}
+
+int64_t signExtend(uint64_t value, uint32_t bits) {
+  const uint64_t signBit = 1ULL << (bits - 1);
+  return static_cast<int64_t>((value ^ signBit) - signBit);
+}
+
+}  // namespace
+
+Segment::~Segment() { close(); }
+
+Segment::SegmentHeader *Segment::header() const {
+  return reinterpret_cast<SegmentHeader *>(mapping_);
+}
+
+Segment::RestartEntry *Segment::index() const {
+  return reinterpret_cast<RestartEntry *>(mapping_ + sizeof(SegmentHeader));
+}
+
+uint8_t *Segment::data() const {
+  return mapping_ + sizeof(SegmentHeader) + kIndexCapacity * sizeof(RestartEntry);
+}
+
+size_t Segment::dataCapacityBytes() {
+  return kSegmentBytes - sizeof(SegmentHeader) -
+         kIndexCapacity * sizeof(RestartEntry);
+}
+
+bool Segment::mapFile(const std::string &path, bool createNew,
+                      std::string &error) {
+  const int flags = createNew ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR;
+  fd_ = ::open(path.c_str(), flags, 0644);
+  if (fd_ < 0) {
+    error = path + ": " + strerror(errno);
+    return false;
+  }
+  if (createNew && ftruncate(fd_, kSegmentBytes) != 0) {
+    error = path + ": ftruncate: " + strerror(errno);
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  void *mapped = mmap(nullptr, kSegmentBytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd_, 0);
+  if (mapped == MAP_FAILED) {
+    error = path + ": mmap: " + strerror(errno);
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  mapping_ = static_cast<uint8_t *>(mapped);
+  return true;
+}
+
+bool Segment::create(const std::string &path, std::string &error) {
+  if (!mapFile(path, true, error)) {
+    return false;
+  }
+  SegmentHeader *h = header();
+  memset(h, 0, sizeof(*h));
+  h->magic = kMagic;
+  h->version = kVersion;
+  return true;
+}
+
+bool Segment::open(const std::string &path, std::string &error) {
+  if (!mapFile(path, false, error)) {
+    return false;
+  }
+  const SegmentHeader *h = header();
+  if (h->magic != kMagic || h->version != kVersion) {
+    error = path + ": not a tsdb segment";
+    close();
+    return false;
+  }
+  restoreEncoderState();
+  return true;
+}
+
+void Segment::sync() {
+  if (mapping_ != nullptr) {
+    msync(mapping_, kSegmentBytes, MS_ASYNC);
+  }
+}
+
+void Segment::close() {
+  if (mapping_ != nullptr) {
+    msync(mapping_, kSegmentBytes, MS_SYNC);
+    munmap(mapping_, kSegmentBytes);
+    mapping_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+uint32_t Segment::pointCount() const { return header()->pointCount; }
+int64_t Segment::firstTimestampMs() const { return header()->firstTimestampMs; }
+int64_t Segment::lastTimestampMs() const { return header()->lastTimestampMs; }
+
+bool Segment::append(int64_t timestampMs, double value) {
+  SegmentHeader *h = header();
+  if (full_) {
+    return false;
+  }
+  if (h->pointCount > 0 && timestampMs < h->lastTimestampMs) {
+    return false;  // append-only: out-of-order points are the caller's bug
+  }
+
+  BitWriter writer(data(), dataCapacityBytes());
+  writer.seekBits(h->dataBits);
+  if (writer.full(kMaxPointBits)) {
+    full_ = true;
+    return false;
+  }
+
+  uint64_t valueBits;
+  memcpy(&valueBits, &value, sizeof(valueBits));
+
+  if (h->pointCount % kRestartInterval == 0) {
+    // Restart point: raw encoding plus an index entry, the seek targets
+    // for range queries
+    if (h->indexCount == kIndexCapacity) {
+      full_ = true;
+      return false;
+    }
+    RestartEntry &entry = index()[h->indexCount];
+    entry.timestampMs = timestampMs;
+    entry.bitOffset = writer.bitPosition();
+    entry.pointIndex = h->pointCount;
+    entry.reserved = 0;
+    writer.writeBits(static_cast<uint64_t>(timestampMs), 64);
+    writer.writeBits(valueBits, 64);
+    h->indexCount++;
+
+    encoder_.prevTimestampMs = timestampMs;
+    encoder_.prevDelta = 0;
+    encoder_.prevValueBits = valueBits;
+    encoder_.prevLeading = 0xFF;
+    encoder_.prevTrailing = 0;
+  } else {
+    // Timestamp: delta-of-delta in Gorilla's bucketed widths. Steady
+    // 1Hz-ish sampling makes almost every point a single '0' bit.
+    const int64_t delta = timestampMs - encoder_.prevTimestampMs;
+    const int64_t dod = delta - encoder_.prevDelta;
+    if (dod == 0) {
+      writer.writeBit(0);
+    } else if (dod >= -64 && dod <= 63) {
+      // Bucket ranges are the two's-complement ranges of the field
+      // widths: the decoder sign-extends, so an asymmetric Gorilla
+      // range (-63..64) would flip +64 into -64 on read
+      writer.writeBits(0b10, 2);
+      writer.writeBits(static_cast<uint64_t>(dod) & 0x7F, 7);
+    } else if (dod >= -256 && dod <= 255) {
+      writer.writeBits(0b110, 3);
+      writer.writeBits(static_cast<uint64_t>(dod) & 0x1FF, 9);
+    } else if (dod >= -2048 && dod <= 2047) {
+      writer.writeBits(0b1110, 4);
+      writer.writeBits(static_cast<uint64_t>(dod) & 0xFFF, 12);
+    } else {
+      writer.writeBits(0b1111, 4);
+      writer.writeBits(static_cast<uint64_t>(dod), 64);
+    }
+    encoder_.prevDelta = delta;
+    encoder_.prevTimestampMs = timestampMs;
+
+    // Value: XOR against the previous value, store only the changed
+    // window. Slow-moving sensor floats XOR to zero most of the time.
+    const uint64_t xorBits = valueBits ^ encoder_.prevValueBits;
+    if (xorBits == 0) {
+      writer.writeBit(0);
+    } else {
+      writer.writeBit(1);
+      uint32_t leading = leadingZeros(xorBits);
+      const uint32_t trailing = trailingZeros(xorBits);
+      if (leading > 31) {
+        leading = 31;  // 5-bit field
+      }
+      if (encoder_.prevLeading != 0xFF && leading >= encoder_.prevLeading &&
+          trailing >= encoder_.prevTrailing) {
+        writer.writeBit(0);
+        writer.writeBits(xorBits >> encoder_.prevTrailing,
+                         64 - encoder_.prevLeading - encoder_.prevTrailing);
+      } else {
+        writer.writeBit(1);
+        const uint32_t meaningful = 64 - leading - trailing;
+        writer.writeBits(leading, 5);
+        writer.writeBits(meaningful & 0x3F, 6);  // 64 wraps to 0
+        writer.writeBits(xorBits >> trailing, meaningful);
+        encoder_.prevLeading = leading;
+        encoder_.prevTrailing = trailing;
+      }
+    }
+    encoder_.prevValueBits = valueBits;
+  }
+
+  // Bits first, then the counters: a crash between the two loses only
+  // the point being written
+  h->dataBits = writer.bitPosition();
+  if (h->pointCount == 0) {
+    h->firstTimestampMs = timestampMs;
+  }
+  h->lastTimestampMs = timestampMs;
+  h->pointCount++;
+  return true;
+}
+
+// Decodes one point, updating state exactly as the encoder did
+static void decodePoint(BitReader &reader, bool isRestart,
+                        int64_t &prevTimestampMs, int64_t &prevDelta,
+                        uint64_t &prevValueBits, uint32_t &prevLeading,
+                        uint32_t &prevTrailing, Segment::Point &out) {
+  if (isRestart) {
+    prevTimestampMs = static_cast<int64_t>(reader.readBits(64));
+    prevValueBits = reader.readBits(64);
+    prevDelta = 0;
+    prevLeading = 0xFF;
+    prevTrailing = 0;
+  } else {
+    int64_t dod;
+    if (reader.readBit() == 0) {
+      dod = 0;
+    } else if (reader.readBit() == 0) {
+      dod = signExtend(reader.readBits(7), 7);
+    } else if (reader.readBit() == 0) {
+      dod = signExtend(reader.readBits(9), 9);
+    } else if (reader.readBit() == 0) {
+      dod = signExtend(reader.readBits(12), 12);
+    } else {
+      dod = static_cast<int64_t>(reader.readBits(64));
+    }
+    prevDelta += dod;
+    prevTimestampMs += prevDelta;
+
+    if (reader.readBit() == 1) {
+      uint64_t xorBits;
+      if (reader.readBit() == 0) {
+        xorBits = reader.readBits(64 - prevLeading - prevTrailing)
+                  << prevTrailing;
+      } else {
+        const uint32_t leading = static_cast<uint32_t>(reader.readBits(5));
+        uint32_t meaningful = static_cast<uint32_t>(reader.readBits(6));
+        if (meaningful == 0) {
+          meaningful = 64;
+        }
+        const uint32_t trailing = 64 - leading - meaningful;
+        xorBits = reader.readBits(meaningful) << trailing;
+        prevLeading = leading;
+        prevTrailing = trailing;
+      }
+      prevValueBits ^= xorBits;
+    }
+  }
+  out.timestampMs = prevTimestampMs;
+  memcpy(&out.value, &prevValueBits, sizeof(out.value));
+}
+
+void Segment::scan(int64_t fromMs, int64_t toMs,
+                   const std::function<void(const Point &)> &fn) const {
+  const SegmentHeader *h = header();
+  if (h->pointCount == 0 || fromMs > h->lastTimestampMs ||
+      toMs < h->firstTimestampMs) {
+    return;
+  }
+
+  // Binary search the restart index for the last restart at or before
+  // fromMs; at most kRestartInterval points get decoded before the range
+  const RestartEntry *entries = index();
+  uint32_t low = 0;
+  uint32_t high = h->indexCount;
+  while (high - low > 1) {
+    const uint32_t mid = low + (high - low) / 2;
+    if (entries[mid].timestampMs <= fromMs) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+
+  BitReader reader(data(), dataCapacityBytes());
+  reader.seekBits(entries[low].bitOffset);
+
+  int64_t prevTimestampMs = 0;
+  int64_t prevDelta = 0;
+  uint64_t prevValueBits = 0;
+  uint32_t prevLeading = 0xFF;
+  uint32_t prevTrailing = 0;
+
+  Point point;
+  for (uint32_t i = entries[low].pointIndex; i < h->pointCount; i++) {
+    decodePoint(reader, i % kRestartInterval == 0, prevTimestampMs, prevDelta,
+                prevValueBits, prevLeading, prevTrailing, point);
+    if (point.timestampMs > toMs) {
+      break;
+    }
+    if (point.timestampMs >= fromMs) {
+      fn(point);
+    }
+  }
+}
+
+void Segment::restoreEncoderState() {
+  const SegmentHeader *h = header();
+  if (h->pointCount == 0) {
+    return;
+  }
+  // Replay from the last restart so appends continue seamlessly
+  const RestartEntry &last = index()[h->indexCount - 1];
+  BitReader reader(data(), dataCapacityBytes());
+  reader.seekBits(last.bitOffset);
+  Point point;
+  for (uint32_t i = last.pointIndex; i < h->pointCount; i++) {
+    decodePoint(reader, i % kRestartInterval == 0, encoder_.prevTimestampMs,
+                encoder_.prevDelta, encoder_.prevValueBits,
+                encoder_.prevLeading, encoder_.prevTrailing, point);
+  }
+}
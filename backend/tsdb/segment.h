@@ -0,0 +1,104 @@
+#ifndef TSDB_SEGMENT_H
+#define TSDB_SEGMENT_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// One append-only, memory-mapped segment file holding a compressed run
+// of (timestamp, value) points for a single series.
+//
+// On-disk layout (little-endian, fixed 1MB file created up front so the
+// mapping never moves):
+//
+//   [SegmentHeader][index: kIndexCapacity RestartEntry][data: bitstream]
+//
+// Points are delta-of-delta timestamps + Gorilla XOR values. Every
+// kRestartInterval points the codec resets and writes the point raw
+// (64-bit timestamp + 64-bit value bits), and the restart's bit offset
+// lands in the index — so a range query binary-searches the index and
+// decodes at most kRestartInterval points before the range start, which
+// is the O(log n) seek the dashboard queries need.
+//
+// Crash consistency: data bits are written before the header's
+// pointCount is bumped, so a torn write can only lose the tail point,
+// never produce a corrupt stream.
+class Segment {
+public:
+  struct Point {
+    int64_t timestampMs;
+    double value;
+  };
+
+  static constexpr uint32_t kMagic = 0x42445354;  // "TSDB"
+  static constexpr uint16_t kVersion = 1;
+  static constexpr size_t kSegmentBytes = 1 << 20;
+  static constexpr size_t kIndexCapacity = 1024;
+  static constexpr uint32_t kRestartInterval = 128;
+
+  ~Segment();
+
+  // Creates a fresh segment file (fails if it exists) or opens an
+  // existing one for append/scan. The whole file is mapped read-write.
+  bool create(const std::string &path, std::string &error);
+  bool open(const std::string &path, std::string &error);
+
+  // Appends one point; fails when the data region is full (caller
+  // seals this segment and starts the next) or timestamps go backwards.
+  bool append(int64_t timestampMs, double value);
+
+  // Calls fn for every point with fromMs <= timestamp <= toMs, in order
+  void scan(int64_t fromMs, int64_t toMs,
+            const std::function<void(const Point &)> &fn) const;
+
+  bool full() const { return full_; }
+  uint32_t pointCount() const;
+  int64_t firstTimestampMs() const;
+  int64_t lastTimestampMs() const;
+
+  void sync();
+  void close();
+
+private:
+  struct __attribute__((packed)) RestartEntry {
+    int64_t timestampMs;
+    uint64_t bitOffset;
+    uint32_t pointIndex;
+    uint32_t reserved;
+  };
+
+  struct __attribute__((packed)) SegmentHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t pointCount;
+    uint32_t indexCount;
+    uint64_t dataBits;  // bit length of the data stream
+    int64_t firstTimestampMs;
+    int64_t lastTimestampMs;
+  };
+
+  SegmentHeader *header() const;
+  RestartEntry *index() const;
+  uint8_t *data() const;
+  static size_t dataCapacityBytes();
+
+  bool mapFile(const std::string &path, bool createNew, std::string &error);
+  void restoreEncoderState();
+
+  // Codec state for the append side
+  struct EncoderState {
+    int64_t prevTimestampMs = 0;
+    int64_t prevDelta = 0;
+    uint64_t prevValueBits = 0;
+    uint32_t prevLeading = 0xFF;  // 0xFF = no reusable window yet
+    uint32_t prevTrailing = 0;
+  };
+
+  uint8_t *mapping_ = nullptr;
+  int fd_ = -1;
+  bool full_ = false;
+  EncoderState encoder_;
+};
+
+#endif // TSDB_SEGMENT_H
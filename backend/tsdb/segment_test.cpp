@@ -0,0 +1,139 @@
+// Round-trip tests for the segment codec, pinning the timestamp
+// delta-of-delta bucket edges: every bucket's range is the
+// two's-complement range of its field width, and a dod one past an edge
+// must land in the next bucket, not wrap sign on decode (a +64 encoded
+// into the 7-bit bucket used to read back as -64, silently skewing
+// every timestamp until the next restart point).
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "segment.h"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char *what) {
+  if (!ok) {
+    fprintf(stderr, "FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// Appends a series whose third point makes delta-of-delta exactly dod,
+// scans it back and verifies every timestamp and value byte-for-byte
+void roundTrip(int64_t dod) {
+  const std::string path = "segment_test.seg";
+  remove(path.c_str());
+  Segment segment;
+  std::string error;
+  if (!segment.create(path, error)) {
+    fprintf(stderr, "FAIL: create: %s\n", error.c_str());
+    failures++;
+    return;
+  }
+
+  std::vector<int64_t> timestamps;
+  int64_t t = 1000000;
+  const int64_t interval = 10000;  // roomy: edges up to +-2049 stay monotonic
+  for (int i = 0; i < 3; i++) {
+    timestamps.push_back(t);
+    t += interval;
+  }
+  timestamps.push_back(t + dod);  // dod lands here
+  t += interval + dod;
+  for (int i = 0; i < 4; i++) {
+    t += interval;
+    timestamps.push_back(t);
+  }
+
+  for (size_t i = 0; i < timestamps.size(); i++) {
+    const double value = 20.0 + 0.01 * static_cast<double>(i);
+    if (!segment.append(timestamps[i], value)) {
+      fprintf(stderr, "FAIL: append rejected (dod=%lld)\n",
+              static_cast<long long>(dod));
+      failures++;
+      return;
+    }
+  }
+
+  size_t i = 0;
+  bool mismatch = false;
+  segment.scan(0, INT64_MAX, [&](const Segment::Point &point) {
+    const double expected = 20.0 + 0.01 * static_cast<double>(i);
+    if (i >= timestamps.size() || point.timestampMs != timestamps[i] ||
+        point.value != expected) {
+      if (!mismatch) {
+        fprintf(stderr,
+                "FAIL: dod=%lld point %zu: got (%lld, %g) want (%lld, %g)\n",
+                static_cast<long long>(dod), i,
+                static_cast<long long>(point.timestampMs), point.value,
+                i < timestamps.size()
+                    ? static_cast<long long>(timestamps[i])
+                    : -1LL,
+                expected);
+      }
+      mismatch = true;
+    }
+    i++;
+  });
+  if (mismatch) {
+    failures++;
+  }
+  check(i == timestamps.size(), "point count after scan");
+  segment.close();
+  remove(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+  // Both edges of every bucket, plus the first value past each edge
+  // (which must take the next bucket) and the easy interior cases
+  const int64_t edges[] = {0,     -1,    1,     -64,   63,    -65,  64,
+                           -256,  255,   -257,  256,   -2048, 2047, -2049,
+                           2048,  -5000, 5000};
+  for (int64_t dod : edges) {
+    roundTrip(dod);
+  }
+
+  // A restart's worth of accumulated jitter: every dod in [-70, 70]
+  // back to back, crossing the 7-bit edge repeatedly
+  {
+    const std::string path = "segment_test.seg";
+    remove(path.c_str());
+    Segment segment;
+    std::string error;
+    check(segment.create(path, error), "create jitter segment");
+    std::vector<int64_t> timestamps;
+    int64_t t = 1000000;
+    int64_t delta = 10000;
+    for (int64_t dod = -70; dod <= 70; dod++) {
+      delta += dod;
+      t += delta;
+      timestamps.push_back(t);
+      check(segment.append(t, 1.0), "jitter append");
+    }
+    size_t i = 0;
+    segment.scan(0, INT64_MAX, [&](const Segment::Point &point) {
+      if (i < timestamps.size() && point.timestampMs != timestamps[i]) {
+        fprintf(stderr, "FAIL: jitter point %zu: got %lld want %lld\n", i,
+                static_cast<long long>(point.timestampMs),
+                static_cast<long long>(timestamps[i]));
+        failures++;
+      }
+      i++;
+    });
+    check(i == timestamps.size(), "jitter point count");
+    segment.close();
+    remove(path.c_str());
+  }
+
+  if (failures == 0) {
+    printf("segment_test: all ok\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
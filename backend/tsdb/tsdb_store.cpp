@@ -0,0 +1,170 @@
+#include "tsdb_store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+bool ensureDir(const std::string &path, std::string &error) {
+  if (mkdir(path.c_str(), 0755) == 0 || errno == EEXIST) {
+    return true;
+  }
+  error = path + ": " + strerror(errno);
+  return false;
+}
+
+// Series names become directory names; keep them path-safe
+bool validSeriesName(const std::string &series) {
+  if (series.empty() || series.size() > 64) {
+    return false;
+  }
+  for (char c : series) {
+    if (!isalnum(c) && c != '.' && c != '_' && c != '-') {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool TsdbStore::open(const std::string &rootDir, std::string &error) {
+  rootDir_ = rootDir;
+  if (!ensureDir(rootDir_, error)) {
+    return false;
+  }
+  // Existing series are opened lazily on first append/query; just
+  // remember the names so listSeries() works before any traffic
+  DIR *dir = opendir(rootDir_.c_str());
+  if (dir == nullptr) {
+    error = rootDir_ + ": " + strerror(errno);
+    return false;
+  }
+  while (struct dirent *entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    seriesMap_[name];  // placeholder, segments loaded in openSeries
+  }
+  closedir(dir);
+  return true;
+}
+
+TsdbStore::SeriesState *TsdbStore::openSeries(const std::string &series,
+                                              std::string &error) {
+  if (!validSeriesName(series)) {
+    error = "invalid series name";
+    return nullptr;
+  }
+  SeriesState &state = seriesMap_[series];
+  if (!state.dir.empty()) {
+    return &state;
+  }
+  state.dir = rootDir_ + "/" + series;
+  if (!ensureDir(state.dir, error)) {
+    return nullptr;
+  }
+
+  // Pick up existing segments, oldest first (filenames are timestamps)
+  std::vector<std::string> files;
+  DIR *dir = opendir(state.dir.c_str());
+  while (struct dirent *entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name.size() > 4 && name.substr(name.size() - 4) == ".seg") {
+      files.push_back(name);
+    }
+  }
+  closedir(dir);
+  std::sort(files.begin(), files.end(),
+            [](const std::string &a, const std::string &b) {
+              return std::stoll(a) < std::stoll(b);
+            });
+  for (const std::string &file : files) {
+    auto segment = std::make_unique<Segment>();
+    if (segment->open(state.dir + "/" + file, error)) {
+      state.segments.push_back(std::move(segment));
+    }
+  }
+  return &state;
+}
+
+bool TsdbStore::append(const std::string &series, int64_t timestampMs,
+                       double value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string error;
+  SeriesState *state = openSeries(series, error);
+  if (state == nullptr) {
+    return false;
+  }
+  if (!state->segments.empty() &&
+      state->segments.back()->append(timestampMs, value)) {
+    return true;
+  }
+  // No active segment or it just filled: roll to a new file
+  auto segment = std::make_unique<Segment>();
+  const std::string path =
+      state->dir + "/" + std::to_string(timestampMs) + ".seg";
+  if (!segment->create(path, error)) {
+    return false;
+  }
+  const bool ok = segment->append(timestampMs, value);
+  state->segments.push_back(std::move(segment));
+  return ok;
+}
+
+void TsdbStore::query(const std::string &series, int64_t fromMs, int64_t toMs,
+                      std::vector<Segment::Point> &out) {
+  scan(series, fromMs, toMs,
+       [&out](const Segment::Point &point) { out.push_back(point); });
+}
+
+void TsdbStore::scan(const std::string &series, int64_t fromMs, int64_t toMs,
+                     const std::function<void(const Segment::Point &)> &fn) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string error;
+  SeriesState *state = openSeries(series, error);
+  if (state == nullptr) {
+    return;
+  }
+  // Segments are time-ordered and non-overlapping: binary search for
+  // the first one that could contain fromMs
+  const auto &segments = state->segments;
+  size_t low = 0;
+  size_t high = segments.size();
+  while (high - low > 0) {
+    const size_t mid = low + (high - low) / 2;
+    if (segments[mid]->lastTimestampMs() < fromMs) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  for (size_t i = low; i < segments.size(); i++) {
+    if (segments[i]->firstTimestampMs() > toMs) {
+      break;
+    }
+    segments[i]->scan(fromMs, toMs, fn);
+  }
+}
+
+std::vector<std::string> TsdbStore::listSeries() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::string> names;
+  for (const auto &entry : seriesMap_) {
+    names.push_back(entry.first);
+  }
+  return names;
+}
+
+void TsdbStore::sync() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &entry : seriesMap_) {
+    if (!entry.second.segments.empty()) {
+      entry.second.segments.back()->sync();
+    }
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef TSDB_TSDB_STORE_H
+#define TSDB_TSDB_STORE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "segment.h"
+
+// The store: one directory per series under the root, segment files
+// named by their first timestamp so a directory listing is already the
+// time order:
+//
+//   <root>/<series>/<firstTimestampMs>.seg
+//
+// Series names are free-form (the daemon uses "<deviceId>.<metric>",
+// e.g. "1.temperature"). Appends go to the newest segment and roll to a
+// fresh file when it fills; queries binary-search the segment list by
+// time, then each segment's restart index — O(log n) to the first
+// point either way.
+//
+// Thread safety: one mutex around the series map and per-series segment
+// lists. Appends and queries are short (bit pokes / a bounded decode),
+// so a single lock is not the bottleneck at our rates; the heavy
+// lifting is all in the page cache.
+class TsdbStore {
+public:
+  // Root is created if missing; existing series/segments are picked up
+  bool open(const std::string &rootDir, std::string &error);
+
+  bool append(const std::string &series, int64_t timestampMs, double value);
+
+  // Collects points with fromMs <= t <= toMs in timestamp order
+  void query(const std::string &series, int64_t fromMs, int64_t toMs,
+             std::vector<Segment::Point> &out);
+
+  // Streaming form of query: fn sees every point in order without the
+  // store materializing them — the aggregation path feeds its kernel
+  // blocks from this. The store mutex is held across the callbacks;
+  // keep fn short and do not reenter the store.
+  void scan(const std::string &series, int64_t fromMs, int64_t toMs,
+            const std::function<void(const Segment::Point &)> &fn);
+
+  std::vector<std::string> listSeries();
+
+  // msync the active segments (called periodically by the daemon)
+  void sync();
+
+private:
+  struct SeriesState {
+    std::string dir;
+    // Sealed segments stay open read-only-in-practice for queries;
+    // back() is the active append target
+    std::vector<std::unique_ptr<Segment>> segments;
+  };
+
+  SeriesState *openSeries(const std::string &series, std::string &error);
+
+  std::string rootDir_;
+  std::mutex mutex_;
+  std::map<std::string, SeriesState> seriesMap_;
+};
+
+#endif // TSDB_TSDB_STORE_H
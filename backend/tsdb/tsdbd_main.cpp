@@ -0,0 +1,437 @@
+// tsdbd: time-series storage daemon.
+//
+// Writes: subscribes to the device telemetry topics and appends every
+// reading to the mmap store under --data (series "<deviceId>.<metric>").
+// Reads: a small HTTP endpoint the WebApp server calls instead of
+// scanning Postgres rows:
+//
+//   GET /series                                   -> ["1.temperature",...]
+//   GET /query?series=1.temperature&from=MS&to=MS -> [[ts,value],...]
+//   GET /stats?series=...&from=MS&to=MS[&p=50,95] -> {"count":..,"min":..,
+//                                                     "max":..,"avg":..,"p50":..}
+//
+// Every raw append also feeds the streaming rollups (see rollup.h);
+// /query picks the coarsest resolution that still plots well for the
+// requested span, unless res=raw|1m|15m|1h pins one. Aggregated
+// resolutions serve the avg series; append .min/.max to the series
+// name to query the envelope explicitly.
+//
+// Usage:
+//   tsdbd [--broker host] [--port 1883] [--user u] [--password p]
+//         [--device-id 1] [--data ./tsdb-data] [--http-port 8091]
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "aggregate.h"
+#include "flat_json.h"
+#include "mqtt_consumer.h"
+#include "rollup.h"
+#include "tsdb_store.h"
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t epochMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Mirror of the packed frame in platformio/src/telemetry_frame.h
+struct __attribute__((packed)) TelemetryFrame {
+  uint8_t version;
+  uint8_t deviceId;
+  uint16_t sequence;
+  uint32_t uptimeMs;
+  uint32_t ageMs;
+  int16_t temperatureCenti;
+  uint16_t humidityCenti;
+  uint16_t light;
+  uint16_t moisture;
+};
+constexpr uint8_t kFrameVersion = 1;
+
+struct Options {
+  std::string broker = "127.0.0.1";
+  uint16_t port = 1883;
+  std::string user;
+  std::string password;
+  std::string dataDir = "./tsdb-data";
+  uint16_t httpPort = 8091;
+  int32_t deviceId = 1;
+};
+
+bool parseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--broker" && hasValue) {
+      options.broker = argv[++i];
+    } else if (arg == "--port" && hasValue) {
+      options.port = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--user" && hasValue) {
+      options.user = argv[++i];
+    } else if (arg == "--password" && hasValue) {
+      options.password = argv[++i];
+    } else if (arg == "--data" && hasValue) {
+      options.dataDir = argv[++i];
+    } else if (arg == "--http-port" && hasValue) {
+      options.httpPort = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--device-id" && hasValue) {
+      options.deviceId = atoi(argv[++i]);
+    } else {
+      fprintf(stderr,
+              "usage: tsdbd [--broker host] [--port n] [--user u]\n"
+              "             [--password p] [--device-id n] [--data dir]\n"
+              "             [--http-port n]\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+// Extracts a query parameter value from a request target
+bool queryParam(const std::string &target, const std::string &name,
+                std::string &out) {
+  const std::string needle = name + "=";
+  size_t pos = target.find('?');
+  while (pos != std::string::npos) {
+    pos++;
+    if (target.compare(pos, needle.size(), needle) == 0) {
+      const size_t start = pos + needle.size();
+      const size_t end = target.find('&', start);
+      out = target.substr(start, end == std::string::npos ? std::string::npos
+                                                          : end - start);
+      return true;
+    }
+    pos = target.find('&', pos);
+  }
+  return false;
+}
+
+// Coarsest rollup level whose buckets still give the chart plenty of
+// points over the span; short spans read raw. At ~720 points a
+// dashboard chart is visually continuous, so: >12h -> 1m, >7.5d -> 15m,
+// >30d -> 1h. Returns -1 for raw.
+int pickResolution(int64_t spanMs) {
+  int level = -1;
+  for (int i = 0; i < RollupEngine::kLevels; i++) {
+    if (spanMs / RollupEngine::kBucketMs[i] >= 720) {
+      level = i;
+    }
+  }
+  return level;
+}
+
+void sendHttp(int fd, const char *status, const std::string &body) {
+  char head[128];
+  const int headLength = snprintf(
+      head, sizeof(head),
+      "HTTP/1.1 %s\r\nContent-Type: application/json\r\n"
+      "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+      status, body.size());
+  (void)!write(fd, head, headLength);
+  (void)!write(fd, body.data(), body.size());
+}
+
+// One short-lived connection per dashboard query: read the request
+// line, answer, close. No keep-alive needed at dashboard rates.
+void handleHttpClient(int fd, TsdbStore &store) {
+  char request[2048];
+  const ssize_t n = recv(fd, request, sizeof(request) - 1, 0);
+  if (n <= 0) {
+    close(fd);
+    return;
+  }
+  request[n] = '\0';
+  char method[8];
+  char target[1024];
+  if (sscanf(request, "%7s %1023s", method, target) != 2 ||
+      strcmp(method, "GET") != 0) {
+    sendHttp(fd, "405 Method Not Allowed", "{\"error\":\"GET only\"}");
+    close(fd);
+    return;
+  }
+  const std::string targetStr = target;
+
+  if (targetStr.rfind("/series", 0) == 0) {
+    std::string body = "[";
+    bool first = true;
+    for (const std::string &name : store.listSeries()) {
+      body += first ? "\"" : ",\"";
+      body += name;
+      body += "\"";
+      first = false;
+    }
+    body += "]";
+    sendHttp(fd, "200 OK", body);
+  } else if (targetStr.rfind("/query", 0) == 0) {
+    std::string series;
+    std::string fromStr;
+    std::string toStr;
+    if (!queryParam(targetStr, "series", series) ||
+        !queryParam(targetStr, "from", fromStr) ||
+        !queryParam(targetStr, "to", toStr)) {
+      sendHttp(fd, "400 Bad Request",
+               "{\"error\":\"series, from, to required\"}");
+      close(fd);
+      return;
+    }
+    const int64_t from = std::stoll(fromStr);
+    const int64_t to = std::stoll(toStr);
+    int level = pickResolution(to - from);
+    std::string res;
+    if (queryParam(targetStr, "res", res)) {
+      level = -1;  // "raw" and anything unrecognized read raw
+      for (int i = 0; i < RollupEngine::kLevels; i++) {
+        if (res == RollupEngine::kSuffix[i]) {
+          level = i;
+        }
+      }
+    }
+    std::vector<Segment::Point> points;
+    if (level >= 0) {
+      store.query(series + "." + RollupEngine::kSuffix[level] + ".avg", from,
+                  to, points);
+    }
+    if (points.empty()) {
+      // No rollups for this span (data predates them, or pinned raw)
+      store.query(series, from, to, points);
+    }
+    std::string body = "[";
+    char item[64];
+    for (size_t i = 0; i < points.size(); i++) {
+      snprintf(item, sizeof(item), "%s[%lld,%.6g]", i == 0 ? "" : ",",
+               static_cast<long long>(points[i].timestampMs),
+               points[i].value);
+      body += item;
+    }
+    body += "]";
+    sendHttp(fd, "200 OK", body);
+  } else if (targetStr.rfind("/stats", 0) == 0) {
+    std::string series;
+    std::string fromStr;
+    std::string toStr;
+    if (!queryParam(targetStr, "series", series) ||
+        !queryParam(targetStr, "from", fromStr) ||
+        !queryParam(targetStr, "to", toStr)) {
+      sendHttp(fd, "400 Bad Request",
+               "{\"error\":\"series, from, to required\"}");
+      close(fd);
+      return;
+    }
+    // Optional percentile ranks, comma separated: &p=50,95
+    std::vector<double> ranks;
+    std::string ranksStr;
+    if (queryParam(targetStr, "p", ranksStr)) {
+      const char *cursor = ranksStr.c_str();
+      char *end;
+      while (*cursor != '\0') {
+        const double rank = strtod(cursor, &end);
+        if (end == cursor) {
+          break;
+        }
+        ranks.push_back(rank);
+        cursor = *end == ',' ? end + 1 : end;
+      }
+    }
+    // Always the raw series: percentiles need the actual samples, and
+    // min/max from rollup buckets would quietly change meaning with the
+    // resolution. One fused pass keeps even full-season raw scans cheap.
+    RangeStats stats;
+    std::vector<double> percentiles;
+    aggregateRange(store, series, std::stoll(fromStr), std::stoll(toStr),
+                   ranks, stats, percentiles);
+    char item[96];
+    snprintf(item, sizeof(item),
+             "{\"count\":%llu,\"min\":%.6g,\"max\":%.6g,\"avg\":%.6g",
+             static_cast<unsigned long long>(stats.count), stats.min,
+             stats.max, stats.avg());
+    std::string body = item;
+    for (size_t i = 0; i < percentiles.size(); i++) {
+      snprintf(item, sizeof(item), ",\"p%.6g\":%.6g", ranks[i],
+               percentiles[i]);
+      body += item;
+    }
+    body += "}";
+    sendHttp(fd, "200 OK", body);
+  } else {
+    sendHttp(fd, "404 Not Found", "{\"error\":\"unknown endpoint\"}");
+  }
+  close(fd);
+}
+
+int listenOn(uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(port);
+  if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, 16) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  TsdbStore store;
+  std::string error;
+  if (!store.open(options.dataDir, error)) {
+    fprintf(stderr, "tsdbd: %s\n", error.c_str());
+    return 1;
+  }
+
+  RollupEngine rollups(store);
+
+  MqttConsumer consumer;
+  const int32_t deviceId = options.deviceId;
+  consumer.setMessageHandler([&store, &rollups, deviceId](
+                                 const std::string &, const uint8_t *payload,
+                                 size_t length) {
+    // Raw append plus the streaming rollups, in one place
+    auto record = [&store, &rollups](const std::string &series, int64_t tsMs,
+                                     double value) {
+      store.append(series, tsMs, value);
+      rollups.ingest(series, tsMs, value);
+    };
+    const int64_t now = epochMs();
+    if (length == sizeof(TelemetryFrame) && payload[0] == kFrameVersion) {
+      TelemetryFrame frame;
+      memcpy(&frame, payload, sizeof(frame));
+      const std::string prefix = std::to_string(frame.deviceId);
+      const int64_t sampledAt = now - frame.ageMs;
+      record(prefix + ".temperature", sampledAt,
+             frame.temperatureCenti / 100.0);
+      record(prefix + ".humidity", sampledAt, frame.humidityCenti / 100.0);
+      record(prefix + ".light", sampledAt, frame.light);
+      record(prefix + ".moisture", sampledAt, frame.moisture);
+      return;
+    }
+    const char *json = reinterpret_cast<const char *>(payload);
+    double ageMs = 0.0;
+    flatJsonNumber(json, length, "ageMs", ageMs);
+    const int64_t sampledAt = now - static_cast<int64_t>(ageMs);
+    const std::string prefix = std::to_string(deviceId);
+    static const char *metrics[] = {"temperature", "humidity", "light",
+                                    "moisture"};
+    for (const char *metric : metrics) {
+      double value;
+      if (flatJsonNumber(json, length, metric, value)) {
+        record(prefix + "." + metric, sampledAt, value);
+      }
+    }
+  });
+
+  const bool mqttUp =
+      consumer.connect(options.broker, options.port, "tsdbd", options.user,
+                       options.password, error) &&
+      consumer.subscribe({"v1/devices/me/telemetry",
+                          "v1/devices/me/telemetry/bin",
+                          "coreiot/gateway/telemetry"},
+                         error);
+  if (!mqttUp) {
+    // Queries still work without the broker; keep serving and retry
+    fprintf(stderr, "tsdbd: mqtt: %s (will retry)\n", error.c_str());
+  }
+
+  const int httpFd = listenOn(options.httpPort);
+  if (httpFd < 0) {
+    fprintf(stderr, "tsdbd: cannot listen on port %u\n", options.httpPort);
+    return 1;
+  }
+  printf("tsdbd: data in %s, http on :%u\n", options.dataDir.c_str(),
+         options.httpPort);
+
+  const int epollFd = epoll_create1(0);
+  const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+  struct itimerspec interval = {};
+  interval.it_interval.tv_sec = 5;
+  interval.it_value.tv_sec = 5;
+  timerfd_settime(timerFd, 0, &interval, nullptr);
+
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = httpFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, httpFd, &event);
+  event.data.fd = timerFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+  if (mqttUp) {
+    event.data.fd = consumer.fd();
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+  }
+
+  bool mqttConnected = mqttUp;
+  while (!shuttingDown) {
+    struct epoll_event events[8];
+    const int ready = epoll_wait(epollFd, events, 8, 1000);
+    for (int i = 0; i < ready; i++) {
+      const int fd = events[i].data.fd;
+      if (fd == httpFd) {
+        const int client = accept(httpFd, nullptr, nullptr);
+        if (client >= 0) {
+          handleHttpClient(client, store);
+        }
+      } else if (fd == timerFd) {
+        uint64_t expirations;
+        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+        }
+        rollups.flushIdle(epochMs());
+        store.sync();
+        if (mqttConnected) {
+          consumer.tick(epochMs());
+        } else if (consumer.connect(options.broker, options.port, "tsdbd",
+                                    options.user, options.password, error) &&
+                   consumer.subscribe({"v1/devices/me/telemetry",
+                                       "v1/devices/me/telemetry/bin",
+                                       "coreiot/gateway/telemetry"},
+                                      error)) {
+          mqttConnected = true;
+          event.events = EPOLLIN;
+          event.data.fd = consumer.fd();
+          epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+        }
+      } else if (mqttConnected && fd == consumer.fd()) {
+        if (!consumer.onReadable()) {
+          epoll_ctl(epollFd, EPOLL_CTL_DEL, consumer.fd(), nullptr);
+          consumer.close();
+          mqttConnected = false;  // timer tick reconnects
+        }
+      }
+    }
+  }
+
+  printf("tsdbd: shutting down\n");
+  store.sync();
+  close(httpFd);
+  close(timerFd);
+  close(epollFd);
+  return 0;
+}
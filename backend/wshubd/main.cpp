@@ -0,0 +1,403 @@
+// wshubd: MQTT -> WebSocket fan-out hub for the live dashboard.
+//
+// The WebApp front end polls the Node server for fresh readings, so
+// "live" charts lag by the poll interval and the server re-runs the
+// same database query once per connected browser. This daemon
+// subscribes to the broker exactly once, keeps the latest reading per
+// device in memory, and pushes a compact binary frame to every
+// WebSocket client the moment a value changes. A newly connected
+// client gets a snapshot of all known devices, then only deltas; the
+// incremental cost of one more dashboard session is one send() per
+// update, no database traffic at all.
+//
+// The wire frame is little-endian and typed-array friendly — the
+// browser reads it with a single DataView, no JSON parse:
+//
+//   offset 0  f64  epochMs       (sample time, Date-constructor ready)
+//   offset 8  u32  deviceId
+//   offset 12 f32  temperature   degC
+//   offset 16 f32  humidity      %
+//   offset 20 f32  light         lux
+//   offset 24 f32  moisture      %
+//
+// Accepts the same telemetry encodings as ingestd: flat JSON, the
+// 20-byte packed frame, and the LZSS-compressed "/lz" topics.
+//
+// Usage:
+//   wshubd [--broker host] [--port 1883] [--user u] [--password p]
+//          [--device-id 1] [--ws-port 18885]
+
+#include <cmath>
+#include <csignal>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <vector>
+
+#include "flat_json.h"
+#include "lzss.h"
+#include "metrics.h"
+#include "mqtt_consumer.h"
+#include "ws_hub.h"
+
+namespace {
+
+volatile sig_atomic_t shuttingDown = 0;
+
+void onSignal(int) { shuttingDown = 1; }
+
+int64_t epochMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Mirror of the packed frame in platformio/src/telemetry_frame.h
+struct __attribute__((packed)) TelemetryFrame {
+  uint8_t version;
+  uint8_t deviceId;
+  uint16_t sequence;
+  uint32_t uptimeMs;
+  uint32_t ageMs;
+  int16_t temperatureCenti;
+  uint16_t humidityCenti;
+  uint16_t light;
+  uint16_t moisture;
+};
+constexpr uint8_t kFrameVersion = 1;
+
+// The 28-byte frame described in the file header. Packed struct on a
+// little-endian host is exactly the wire layout.
+struct __attribute__((packed)) WireFrame {
+  double epochMs;
+  uint32_t deviceId;
+  float temperature;
+  float humidity;
+  float light;
+  float moisture;
+};
+static_assert(sizeof(WireFrame) == 28, "dashboard frame layout");
+
+// Latest state per device, compared field-for-field to suppress
+// broadcasts when a publish carries no new information.
+struct DeviceState {
+  float temperature = NAN;
+  float humidity = NAN;
+  float light = NAN;
+  float moisture = NAN;
+};
+
+bool sameReading(float a, float b) {
+  return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+struct Options {
+  std::string broker = "127.0.0.1";
+  uint16_t port = 1883;
+  std::string user;
+  std::string password;
+  int32_t deviceId = 1;     // JSON telemetry carries no device id
+  uint16_t wsPort = 18885;  // dashboard WebSocket listener
+  uint16_t metricsPort = 9102;  // /metrics scrape listener; 0 disables
+};
+
+bool parseArgs(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--broker" && hasValue) {
+      options.broker = argv[++i];
+    } else if (arg == "--port" && hasValue) {
+      options.port = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--user" && hasValue) {
+      options.user = argv[++i];
+    } else if (arg == "--password" && hasValue) {
+      options.password = argv[++i];
+    } else if (arg == "--device-id" && hasValue) {
+      options.deviceId = atoi(argv[++i]);
+    } else if (arg == "--ws-port" && hasValue) {
+      options.wsPort = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--metrics-port" && hasValue) {
+      options.metricsPort = static_cast<uint16_t>(atoi(argv[++i]));
+    } else {
+      fprintf(stderr,
+              "usage: wshubd [--broker host] [--port n] [--user u]\n"
+              "              [--password p] [--device-id n] [--ws-port n]\n"
+              "              [--metrics-port n]\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+void packFrame(uint32_t deviceId, const DeviceState &state, double sampledAt,
+               uint8_t out[sizeof(WireFrame)]) {
+  WireFrame frame;
+  frame.epochMs = sampledAt;
+  frame.deviceId = deviceId;
+  frame.temperature = state.temperature;
+  frame.humidity = state.humidity;
+  frame.light = state.light;
+  frame.moisture = state.moisture;
+  memcpy(out, &frame, sizeof(frame));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  WsHub hub;
+  std::string error;
+  if (!hub.listen(options.wsPort, error)) {
+    fprintf(stderr, "wshubd: ws: %s\n", error.c_str());
+    return 1;
+  }
+
+  std::map<uint32_t, DeviceState> devices;
+  std::map<uint32_t, double> sampledAt;
+
+  // Snapshot on connect: one frame per known device, so a fresh
+  // dashboard renders without waiting for the next publish
+  hub.setReadyHandler([&hub, &devices, &sampledAt](int clientFd) {
+    uint8_t frame[sizeof(WireFrame)];
+    for (const auto &entry : devices) {
+      packFrame(entry.first, entry.second, sampledAt[entry.first], frame);
+      if (!hub.sendTo(clientFd, frame, sizeof(frame))) {
+        return;
+      }
+    }
+  });
+
+  MqttConsumer consumer;
+  const int32_t deviceId = options.deviceId;
+  consumer.setMessageHandler([&hub, &devices, &sampledAt, deviceId](
+                                 const std::string &topic,
+                                 const uint8_t *payload, size_t length) {
+    std::vector<uint8_t> decompressed;
+    if (topic.size() > 3 && topic.compare(topic.size() - 3, 3, "/lz") == 0) {
+      if (!lzssDecompress(payload, length, decompressed)) {
+        fprintf(stderr, "wshubd: corrupt compressed payload on %s\n",
+                topic.c_str());
+        return;
+      }
+      payload = decompressed.data();
+      length = decompressed.size();
+    }
+
+    uint32_t id = static_cast<uint32_t>(deviceId);
+    DeviceState incoming;
+    double ageMs = 0.0;
+    if (length == sizeof(TelemetryFrame) && payload[0] == kFrameVersion) {
+      TelemetryFrame frame;
+      memcpy(&frame, payload, sizeof(frame));
+      id = frame.deviceId;
+      ageMs = frame.ageMs;
+      incoming.temperature = frame.temperatureCenti / 100.0f;
+      incoming.humidity = frame.humidityCenti / 100.0f;
+      incoming.light = frame.light;
+      incoming.moisture = frame.moisture;
+    } else {
+      const char *json = reinterpret_cast<const char *>(payload);
+      flatJsonNumber(json, length, "ageMs", ageMs);
+      double value = 0.0;
+      if (flatJsonNumber(json, length, "temperature", value)) {
+        incoming.temperature = static_cast<float>(value);
+      }
+      if (flatJsonNumber(json, length, "humidity", value)) {
+        incoming.humidity = static_cast<float>(value);
+      }
+      if (flatJsonNumber(json, length, "light", value)) {
+        incoming.light = static_cast<float>(value);
+      }
+      if (flatJsonNumber(json, length, "moisture", value)) {
+        incoming.moisture = static_cast<float>(value);
+      }
+    }
+
+    // Delta telemetry sends only the fields that moved: merge into the
+    // retained state so a partial publish does not blank the others
+    DeviceState &state = devices[id];
+    bool changed = false;
+    if (!std::isnan(incoming.temperature) &&
+        !sameReading(state.temperature, incoming.temperature)) {
+      state.temperature = incoming.temperature;
+      changed = true;
+    }
+    if (!std::isnan(incoming.humidity) &&
+        !sameReading(state.humidity, incoming.humidity)) {
+      state.humidity = incoming.humidity;
+      changed = true;
+    }
+    if (!std::isnan(incoming.light) &&
+        !sameReading(state.light, incoming.light)) {
+      state.light = incoming.light;
+      changed = true;
+    }
+    if (!std::isnan(incoming.moisture) &&
+        !sameReading(state.moisture, incoming.moisture)) {
+      state.moisture = incoming.moisture;
+      changed = true;
+    }
+    sampledAt[id] = static_cast<double>(epochMs()) - ageMs;
+    if (!changed) {
+      return;
+    }
+
+    uint8_t frame[sizeof(WireFrame)];
+    packFrame(id, state, sampledAt[id], frame);
+    hub.broadcast(frame, sizeof(frame));
+  });
+
+  if (!consumer.connect(options.broker, options.port, "wshubd", options.user,
+                        options.password, error)) {
+    fprintf(stderr, "wshubd: mqtt: %s\n", error.c_str());
+    return 1;
+  }
+  if (!consumer.subscribe({"v1/devices/me/telemetry",
+                           "v1/devices/me/telemetry/bin",
+                           "v1/devices/me/telemetry/lz",
+                           "coreiot/gateway/telemetry",
+                           "coreiot/gateway/telemetry/lz"},
+                          error)) {
+    fprintf(stderr, "wshubd: mqtt: %s\n", error.c_str());
+    return 1;
+  }
+  printf("wshubd: connected to %s:%u, serving ws on port %u\n",
+         options.broker.c_str(), options.port, options.wsPort);
+
+  // Scrape-side mirror of the stats printf (see common/metrics.h); the
+  // once-a-second tick copies deltas from the hub's and the consumer's
+  // own counters, so the fan-out path itself is untouched
+  MetricsRegistry metrics;
+  MetricsRegistry::Counter *messagesMetric = metrics.counter(
+      "hub_messages_total", "MQTT telemetry messages received");
+  MetricsRegistry::Counter *framesMetric = metrics.counter(
+      "hub_frames_total", "Dashboard frames sent across all clients");
+  MetricsRegistry::Counter *slowDroppedMetric = metrics.counter(
+      "hub_slow_clients_dropped_total",
+      "Clients disconnected for not keeping up");
+  MetricsRegistry::Gauge *clientsMetric = metrics.gauge(
+      "hub_clients", "Connected WebSocket clients");
+
+  int metricsFd = -1;
+  if (options.metricsPort != 0) {
+    metricsFd = metricsListen(options.metricsPort);
+    if (metricsFd < 0) {
+      fprintf(stderr, "wshubd: metrics listener on :%u failed, disabled\n",
+              options.metricsPort);
+    } else {
+      printf("wshubd: metrics on :%u\n", options.metricsPort);
+    }
+  }
+
+  const int epollFd = epoll_create1(0);
+  const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+  struct itimerspec interval = {};
+  interval.it_interval.tv_sec = 1;
+  interval.it_value.tv_sec = 1;
+  timerfd_settime(timerFd, 0, &interval, nullptr);
+
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = consumer.fd();
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+  event.data.fd = timerFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+  event.data.fd = hub.listenFd();
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, hub.listenFd(), &event);
+  if (metricsFd >= 0) {
+    event.data.fd = metricsFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, metricsFd, &event);
+  }
+
+  uint64_t lastReported = 0;
+  uint64_t metricMessages = 0;
+  uint64_t metricFrames = 0;
+  uint64_t metricSlowDropped = 0;
+  while (!shuttingDown) {
+    struct epoll_event events[16];
+    const int ready = epoll_wait(epollFd, events, 16, 1000);
+    for (int i = 0; i < ready; i++) {
+      const int fd = events[i].data.fd;
+      if (fd == consumer.fd()) {
+        if (!consumer.onReadable()) {
+          fprintf(stderr, "wshubd: broker connection lost, reconnecting\n");
+          epoll_ctl(epollFd, EPOLL_CTL_DEL, consumer.fd(), nullptr);
+          while (!shuttingDown &&
+                 (!consumer.connect(options.broker, options.port, "wshubd",
+                                    options.user, options.password, error) ||
+                  !consumer.subscribe({"v1/devices/me/telemetry",
+                                       "v1/devices/me/telemetry/bin",
+                                       "v1/devices/me/telemetry/lz",
+                                       "coreiot/gateway/telemetry",
+                                       "coreiot/gateway/telemetry/lz"},
+                                      error))) {
+            fprintf(stderr, "wshubd: %s, retrying\n", error.c_str());
+            sleep(2);
+          }
+          event.events = EPOLLIN;
+          event.data.fd = consumer.fd();
+          epoll_ctl(epollFd, EPOLL_CTL_ADD, consumer.fd(), &event);
+        }
+      } else if (fd == hub.listenFd()) {
+        int clientFd;
+        while ((clientFd = hub.acceptClient()) >= 0) {
+          event.events = EPOLLIN;
+          event.data.fd = clientFd;
+          epoll_ctl(epollFd, EPOLL_CTL_ADD, clientFd, &event);
+        }
+      } else if (metricsFd >= 0 && fd == metricsFd) {
+        metricsHandle(metricsFd, metrics);
+      } else if (fd == timerFd) {
+        uint64_t expirations;
+        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+        }
+        consumer.tick(epochMs());
+        // Advance the scrape counters by deltas so they track the
+        // components' own totals exactly
+        messagesMetric->inc(consumer.messagesReceived() - metricMessages);
+        metricMessages = consumer.messagesReceived();
+        framesMetric->inc(hub.framesSent() - metricFrames);
+        metricFrames = hub.framesSent();
+        slowDroppedMetric->inc(hub.slowClientsDropped() - metricSlowDropped);
+        metricSlowDropped = hub.slowClientsDropped();
+        clientsMetric->set(static_cast<int64_t>(hub.clientCount()));
+        if (consumer.messagesReceived() - lastReported >= 1000) {
+          lastReported = consumer.messagesReceived();
+          printf("wshubd: %llu msgs in, %llu frames out, %zu clients, "
+                 "%llu slow dropped\n",
+                 (unsigned long long)consumer.messagesReceived(),
+                 (unsigned long long)hub.framesSent(), hub.clientCount(),
+                 (unsigned long long)hub.slowClientsDropped());
+        }
+      } else {
+        // Everything else in the set is a WebSocket client; a false
+        // return means the hub already closed the fd (which also
+        // removes it from the epoll set)
+        hub.onClientReadable(fd);
+      }
+    }
+  }
+
+  printf("wshubd: shutting down\n");
+  hub.closeAll();
+  consumer.close();
+  if (metricsFd >= 0) {
+    close(metricsFd);
+  }
+  close(timerFd);
+  close(epollFd);
+  return 0;
+}
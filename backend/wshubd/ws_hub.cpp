@@ -0,0 +1,363 @@
+#include "ws_hub.h"
+
+#include <arpa/inet.h>
+#include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "base64.h"
+
+namespace {
+
+// Compact SHA-1, used only for the Sec-WebSocket-Accept token. The
+// handshake runs once per connection on a sub-200-byte input, so the
+// copy into a padded buffer is irrelevant.
+void sha1(const uint8_t *data, size_t length, uint8_t digest[20]) {
+  uint32_t h[5] = {0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u,
+                   0xC3D2E1F0u};
+  std::vector<uint8_t> message(data, data + length);
+  message.push_back(0x80);
+  while (message.size() % 64 != 56) {
+    message.push_back(0);
+  }
+  const uint64_t bitLength = static_cast<uint64_t>(length) * 8;
+  for (int i = 7; i >= 0; i--) {
+    message.push_back(static_cast<uint8_t>(bitLength >> (i * 8)));
+  }
+  for (size_t block = 0; block < message.size(); block += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t *p = &message[block + i * 4];
+      w[i] = (static_cast<uint32_t>(p[0]) << 24) |
+             (static_cast<uint32_t>(p[1]) << 16) |
+             (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+    for (int i = 16; i < 80; i++) {
+      const uint32_t v = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+      w[i] = (v << 1) | (v >> 31);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999u;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1u;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDCu;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6u;
+      }
+      const uint32_t t = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = (b << 30) | (b >> 2);
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+  for (int i = 0; i < 5; i++) {
+    digest[i * 4] = static_cast<uint8_t>(h[i] >> 24);
+    digest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+    digest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+    digest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+  }
+}
+
+// Case-insensitive header lookup in a raw HTTP request; returns the
+// trimmed value or empty.
+std::string headerValue(const std::string &request, const char *name) {
+  const size_t nameLength = strlen(name);
+  size_t pos = 0;
+  while ((pos = request.find("\r\n", pos)) != std::string::npos) {
+    pos += 2;
+    if (pos + nameLength + 1 >= request.size()) {
+      break;
+    }
+    bool match = true;
+    for (size_t i = 0; i < nameLength; i++) {
+      if (tolower(request[pos + i]) != tolower(name[i])) {
+        match = false;
+        break;
+      }
+    }
+    if (!match || request[pos + nameLength] != ':') {
+      continue;
+    }
+    size_t start = pos + nameLength + 1;
+    while (start < request.size() && request[start] == ' ') {
+      start++;
+    }
+    size_t end = request.find("\r\n", start);
+    if (end == std::string::npos) {
+      end = request.size();
+    }
+    return request.substr(start, end - start);
+  }
+  return std::string();
+}
+
+} // namespace
+
+WsHub::~WsHub() { closeAll(); }
+
+bool WsHub::listen(uint16_t port, std::string &error) {
+  listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (listenFd_ < 0) {
+    error = "socket: " + std::string(strerror(errno));
+    return false;
+  }
+  const int one = 1;
+  setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (bind(listenFd_, reinterpret_cast<struct sockaddr *>(&address),
+           sizeof(address)) != 0 ||
+      ::listen(listenFd_, 64) != 0) {
+    error = "bind/listen: " + std::string(strerror(errno));
+    close(listenFd_);
+    listenFd_ = -1;
+    return false;
+  }
+  return true;
+}
+
+int WsHub::acceptClient() {
+  const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK);
+  if (fd < 0) {
+    return -1;
+  }
+  const int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  clients_[fd] = Client();
+  return fd;
+}
+
+bool WsHub::onClientReadable(int fd) {
+  auto it = clients_.find(fd);
+  if (it == clients_.end()) {
+    return false;
+  }
+  Client &client = it->second;
+  uint8_t chunk[1024];
+  for (;;) {
+    const ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+    if (got > 0) {
+      client.rx.append(reinterpret_cast<const char *>(chunk),
+                       static_cast<size_t>(got));
+      // An upgrade request or a control frame is well under 1 KiB of
+      // useful data; anything that keeps growing is not a dashboard
+      if (client.rx.size() > 8192) {
+        closeClient(fd);
+        return false;
+      }
+      continue;
+    }
+    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    closeClient(fd); // orderly shutdown or hard error
+    return false;
+  }
+  if (!client.open && !completeHandshake(fd, client)) {
+    return clients_.count(fd) != 0; // may still be mid-request
+  }
+  if (client.open && !handleClientFrames(fd, client)) {
+    return false;
+  }
+  return true;
+}
+
+bool WsHub::completeHandshake(int fd, Client &client) {
+  const size_t headerEnd = client.rx.find("\r\n\r\n");
+  if (headerEnd == std::string::npos) {
+    return false; // request still arriving
+  }
+  const std::string request = client.rx.substr(0, headerEnd + 4);
+  client.rx.erase(0, headerEnd + 4);
+
+  const std::string key = headerValue(request, "Sec-WebSocket-Key");
+  if (key.empty()) {
+    static const char plain[] =
+        "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+    sendRaw(fd, reinterpret_cast<const uint8_t *>(plain), sizeof(plain) - 1);
+    closeClient(fd);
+    return false;
+  }
+
+  // Accept token: base64(sha1(key + RFC 6455 GUID))
+  const std::string salted = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  uint8_t digest[20];
+  sha1(reinterpret_cast<const uint8_t *>(salted.data()), salted.size(),
+       digest);
+  const std::string accept = base64Encode(digest, sizeof(digest));
+
+  std::string response =
+      "HTTP/1.1 101 Switching Protocols\r\n"
+      "Upgrade: websocket\r\n"
+      "Connection: Upgrade\r\n"
+      "Sec-WebSocket-Accept: " +
+      accept + "\r\n\r\n";
+  if (!sendRaw(fd, reinterpret_cast<const uint8_t *>(response.data()),
+               response.size())) {
+    closeClient(fd);
+    return false;
+  }
+  client.open = true;
+  if (readyHandler_) {
+    readyHandler_(fd);
+  }
+  return true;
+}
+
+bool WsHub::handleClientFrames(int fd, Client &client) {
+  for (;;) {
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(client.rx.data());
+    const size_t available = client.rx.size();
+    if (available < 2) {
+      return true;
+    }
+    const uint8_t opcode = data[0] & 0x0F;
+    const bool masked = (data[1] & 0x80) != 0;
+    uint64_t payloadLength = data[1] & 0x7F;
+    size_t headerLength = 2;
+    if (payloadLength == 126) {
+      if (available < 4) {
+        return true;
+      }
+      payloadLength = (static_cast<uint64_t>(data[2]) << 8) | data[3];
+      headerLength = 4;
+    } else if (payloadLength == 127) {
+      // Nothing a browser sends here is that big
+      closeClient(fd);
+      return false;
+    }
+    if (masked) {
+      headerLength += 4;
+    }
+    if (available < headerLength + payloadLength) {
+      return true;
+    }
+
+    std::vector<uint8_t> payload(data + headerLength,
+                                 data + headerLength + payloadLength);
+    if (masked) {
+      const uint8_t *mask = data + headerLength - 4;
+      for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] ^= mask[i & 3];
+      }
+    }
+    client.rx.erase(0, headerLength + static_cast<size_t>(payloadLength));
+
+    if (opcode == 0x8) { // close: echo and drop
+      sendFrame(fd, 0x8, payload.data(), payload.size());
+      closeClient(fd);
+      return false;
+    }
+    if (opcode == 0x9) { // ping
+      if (!sendFrame(fd, 0xA, payload.data(), payload.size())) {
+        closeClient(fd);
+        return false;
+      }
+    }
+    // pong (0xA) and any stray data frames: ignored, the hub is one-way
+  }
+}
+
+bool WsHub::sendRaw(int fd, const uint8_t *data, size_t length) {
+  while (length > 0) {
+    const ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return false; // EAGAIN included: see class comment
+    }
+    data += sent;
+    length -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+bool WsHub::sendFrame(int fd, uint8_t opcode, const uint8_t *payload,
+                      size_t length) {
+  uint8_t header[4];
+  size_t headerLength = 2;
+  header[0] = static_cast<uint8_t>(0x80 | opcode); // FIN, server unmasked
+  if (length < 126) {
+    header[1] = static_cast<uint8_t>(length);
+  } else {
+    header[1] = 126;
+    header[2] = static_cast<uint8_t>(length >> 8);
+    header[3] = static_cast<uint8_t>(length & 0xFF);
+    headerLength = 4;
+  }
+  // One buffer, one send: the frames are small enough that assembling
+  // them beats two syscalls per client per update
+  uint8_t frame[4 + 512];
+  if (length > sizeof(frame) - headerLength) {
+    return false;
+  }
+  memcpy(frame, header, headerLength);
+  if (length > 0) {
+    memcpy(frame + headerLength, payload, length);
+  }
+  return sendRaw(fd, frame, headerLength + length);
+}
+
+bool WsHub::sendTo(int fd, const uint8_t *data, size_t length) {
+  auto it = clients_.find(fd);
+  if (it == clients_.end() || !it->second.open) {
+    return false;
+  }
+  if (!sendFrame(fd, 0x2, data, length)) {
+    slowDropped_++;
+    closeClient(fd);
+    return false;
+  }
+  framesSent_++;
+  return true;
+}
+
+void WsHub::broadcast(const uint8_t *data, size_t length) {
+  for (auto it = clients_.begin(); it != clients_.end();) {
+    const int fd = it->first;
+    const bool open = it->second.open;
+    ++it; // sendTo may erase the current client
+    if (open) {
+      sendTo(fd, data, length);
+    }
+  }
+}
+
+void WsHub::closeClient(int fd) {
+  auto it = clients_.find(fd);
+  if (it != clients_.end()) {
+    close(fd);
+    clients_.erase(it);
+  }
+}
+
+void WsHub::closeAll() {
+  for (const auto &entry : clients_) {
+    close(entry.first);
+  }
+  clients_.clear();
+  if (listenFd_ >= 0) {
+    close(listenFd_);
+    listenFd_ = -1;
+  }
+}
@@ -0,0 +1,85 @@
+#ifndef WSHUBD_WS_HUB_H
+#define WSHUBD_WS_HUB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+// Minimal RFC 6455 WebSocket server for the live-dashboard fan-out.
+//
+// Serves binary frames only, in one direction: the hub never expects
+// application data from a browser, it upgrades the HTTP request, then
+// pushes whatever the daemon broadcasts. Control frames (ping, close)
+// from the client are answered; everything else it sends is ignored.
+//
+// Like MqttConsumer, the hub owns no event loop. The caller epolls the
+// listen fd and every client fd, calls acceptClient() when the listener
+// is readable and onClientReadable() when a client is; a false return
+// means the client is gone and its fd already closed (epoll drops a
+// closed fd on its own, no EPOLL_CTL_DEL needed).
+//
+// Sends are nonblocking and all-or-nothing: frames are tens of bytes,
+// so a client whose socket buffer cannot take one whole frame is
+// hopelessly behind and gets dropped rather than buffered for. That is
+// what keeps the per-client incremental cost near zero — broadcast is
+// one send() per open client, no queues, no copies.
+class WsHub {
+public:
+  // Invoked once per client, right after its handshake completes —
+  // the daemon sends the current-state snapshot from here.
+  using ReadyHandler = std::function<void(int clientFd)>;
+
+  ~WsHub();
+
+  // Binds and listens on the port (SO_REUSEADDR, nonblocking).
+  bool listen(uint16_t port, std::string &error);
+  int listenFd() const { return listenFd_; }
+
+  // Accepts one pending connection; returns the new nonblocking client
+  // fd for the caller to register, or -1 when nothing is pending.
+  int acceptClient();
+
+  // Drains a readable client fd: feeds the HTTP upgrade until it
+  // completes, answers pings, honours close. Returns false once the
+  // client is closed (by either side) and forgotten.
+  bool onClientReadable(int fd);
+
+  // One binary frame to one open client. False drops the client.
+  bool sendTo(int fd, const uint8_t *data, size_t length);
+
+  // One binary frame to every open client; slow clients are dropped.
+  void broadcast(const uint8_t *data, size_t length);
+
+  void closeClient(int fd);
+  void closeAll();
+
+  void setReadyHandler(ReadyHandler handler) {
+    readyHandler_ = std::move(handler);
+  }
+
+  size_t clientCount() const { return clients_.size(); }
+  uint64_t framesSent() const { return framesSent_; }
+  uint64_t slowClientsDropped() const { return slowDropped_; }
+
+private:
+  struct Client {
+    bool open = false;  // handshake complete
+    std::string rx;     // upgrade request, then partial frames
+  };
+
+  bool completeHandshake(int fd, Client &client);
+  bool handleClientFrames(int fd, Client &client);
+  bool sendRaw(int fd, const uint8_t *data, size_t length);
+  bool sendFrame(int fd, uint8_t opcode, const uint8_t *payload,
+                 size_t length);
+
+  int listenFd_ = -1;
+  std::map<int, Client> clients_;
+  ReadyHandler readyHandler_;
+  uint64_t framesSent_ = 0;
+  uint64_t slowDropped_ = 0;
+};
+
+#endif // WSHUBD_WS_HUB_H
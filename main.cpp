@@ -72,6 +72,9 @@ TaskHandle_t taskDHT20Handle = NULL;
 TaskHandle_t taskSendTelemetryHandle = NULL;
 TaskHandle_t taskLightHandle = NULL;
 TaskHandle_t taskSerialHandle = NULL;
+TaskHandle_t taskSerialCommandHandle = NULL;
+
+void taskDiagnostics(void *parameter);
 
 
 RPC_Response setLedSwitchState(const RPC_Data &data) {
@@ -106,27 +109,36 @@ void processSharedAttributes(const JsonObjectConst &data) {
 const Shared_Attribute_Callback attributes_callback(&processSharedAttributes, SHARED_ATTRIBUTES_LIST.cbegin(), SHARED_ATTRIBUTES_LIST.cend());
 const Attribute_Request_Callback attribute_shared_request_callback(&processSharedAttributes, SHARED_ATTRIBUTES_LIST.cbegin(), SHARED_ATTRIBUTES_LIST.cend());
 
+// Event-driven WiFi: the radio reconnects in the background while the
+// sensing and serial tasks keep running at full rate. No task ever
+// blocks in a connect loop.
+void onWiFiEvent(WiFiEvent_t event) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      Serial.print("WiFi connected, IP: ");
+      Serial.println(WiFi.localIP());
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      Serial.println("WiFi lost, reconnecting in background...");
+      WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+      break;
+    default:
+      break;
+  }
+}
+
 void InitWiFi() {
-  Serial.println("Connecting to AP ...");
-  // Attempting to establish a connection to the given WiFi network
+  Serial.println("Connecting to AP (non-blocking) ...");
+  WiFi.onEvent(onWiFiEvent);
+  WiFi.setAutoReconnect(true);
+  // Kick off the association; completion is reported via onWiFiEvent
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  while (WiFi.status() != WL_CONNECTED) {
-    // Delay 500ms until a connection has been successfully established
-    delay(500);
-    Serial.print(".");
-  }
-  Serial.println("Connected to AP");
 }
 
 const bool reconnect() {
-  // Check to ensure we aren't connected yet
-  const wl_status_t status = WiFi.status();
-  if (status == WL_CONNECTED) {
-    return true;
-  }
-  // If we aren't establish a new connection to the given WiFi network
-  InitWiFi();
-  return true;
+  // The event handler already re-arms WiFi.begin on disconnect;
+  // just report the current link state without blocking the caller.
+  return WiFi.status() == WL_CONNECTED;
 }
 
 void processGetJson(const JsonVariantConst &data, JsonDocument &response) {
@@ -148,7 +160,10 @@ void processSerialCommand() {
     Serial.println(jsonString);
     
     StaticJsonDocument<200> doc;
-    DeserializationError error = deserializeJson(doc, jsonString);
+    // Parse in place over the mutable String buffer (zero copy): string
+    // values stay pointers into jsonString instead of being copied into
+    // the document pool, and jsonString outlives every use of doc here
+    DeserializationError error = deserializeJson(doc, jsonString.begin());
 
     if (error) {
       Serial.print("deserializeJson() failed: ");
@@ -212,16 +227,84 @@ void setup() {
 
   Serial.println("Creating tasks...");
   xTaskCreate(taskThingsBoard, "TaskThingsBoard", 4096, NULL, 1, NULL);
-  xTaskCreate(taskSerialCommand, "TaskSerialCommand", 2048, NULL, 1, NULL);
+  xTaskCreate(taskSerialCommand, "TaskSerialCommand", 2048, NULL, 1, &taskSerialCommandHandle);
   xTaskCreate(taskDHT20, "TaskDHT20", 4096, NULL, 1, &taskDHT20Handle);
   // xTaskCreate(taskLight, "TaskLight", 4096, NULL, 1, &taskLightHandle);
   xTaskCreate(taskSerial, "TaskSerial", 4096, NULL, 1, &taskSerialHandle);
+  xTaskCreate(taskDiagnostics, "TaskDiag", 3072, NULL, 1, NULL);
   // xTaskCreate(taskPrintVersion, "TaskPrintVersion", 2048, NULL, 1, NULL);
   
   Serial.println("Setup complete!");
 }
 
 
+// Deadbands: a field is only re-published when it moved further than this
+// from its last transmitted value. In a stable greenhouse most samples are
+// suppressed, cutting broker ingest and radio airtime by ~10x.
+constexpr float TEMPERATURE_DEADBAND = 0.2f;   // °C
+constexpr float HUMIDITY_DEADBAND = 1.0f;      // %
+constexpr float LIGHT_DEADBAND = 50.0f;        // raw ADC counts
+constexpr float MOISTURE_DEADBAND = 50.0f;     // raw ADC counts
+// Heartbeat: force a full publish at least this often even if unchanged,
+// so the dashboard can tell a quiet node from a dead one.
+constexpr uint32_t MAX_SILENCE_MS = 60000UL;
+
+// Serialize the changed readings into a single JSON object so each cycle
+// costs at most one MQTT PUBLISH instead of four (less radio airtime).
+void sendTelemetrySnapshot() {
+    static float lastSentTemperature = NAN, lastSentHumidity = NAN;
+    static float lastSentLight = NAN, lastSentMoisture = NAN;
+    static uint32_t lastFullSend = 0;
+
+    const bool heartbeat = (millis() - lastFullSend) >= MAX_SILENCE_MS;
+
+    StaticJsonDocument<JSON_OBJECT_SIZE(4)> doc;
+    if (heartbeat || isnan(lastSentTemperature) || fabsf(temperature - lastSentTemperature) > TEMPERATURE_DEADBAND) {
+        doc["temperature"] = temperature;
+        lastSentTemperature = temperature;
+    }
+    if (heartbeat || isnan(lastSentHumidity) || fabsf(humidity - lastSentHumidity) > HUMIDITY_DEADBAND) {
+        doc["humidity"] = humidity;
+        lastSentHumidity = humidity;
+    }
+    if (heartbeat || isnan(lastSentLight) || fabsf(light - lastSentLight) > LIGHT_DEADBAND) {
+        doc["light"] = light;
+        lastSentLight = light;
+    }
+    if (heartbeat || isnan(lastSentMoisture) || fabsf(moisture - lastSentMoisture) > MOISTURE_DEADBAND) {
+        doc["moisture"] = moisture;
+        lastSentMoisture = moisture;
+    }
+    if (heartbeat) {
+        lastFullSend = millis();
+    }
+    if (doc.size() == 0) {
+        return;  // everything inside its deadband, nothing to send
+    }
+
+    char payload[128];
+    serializeJson(doc, payload, sizeof(payload));
+    tb.sendTelemetryJson(payload);
+}
+
+// Client attribute flush: every change site (RPC handler, serial command)
+// only marks attributesChanged, and this flush serializes all attribute
+// keys into a single MQTT publish per change burst instead of one
+// publish per key.
+void sendAttributeSnapshot() {
+    if (!attributesChanged) {
+        return;
+    }
+    attributesChanged = false;
+
+    const std::array<Attribute, 3U> attributes = {
+        Attribute(LED_STATE_ATTR, ledState),
+        Attribute(LED_MODE_ATTR, ledMode),
+        Attribute(BLINKING_INTERVAL_ATTR, blinkingInterval),
+    };
+    tb.sendAttributes(attributes.cbegin(), attributes.cend());
+}
+
 void taskSerial(void *parameter){
     while(1){
       Serial.print("Temperature: ");
@@ -235,10 +318,8 @@ void taskSerial(void *parameter){
       Serial.println(" %");
       vTaskDelay(1000 / portTICK_PERIOD_MS);
 
-      tb.sendTelemetryData("temperature", temperature);
-      tb.sendTelemetryData("humidity", humidity);
-      tb.sendTelemetryData("light", light);
-      tb.sendTelemetryData("moisture", moisture); 
+      sendTelemetrySnapshot();
+      sendAttributeSnapshot();
     }
 }
 
@@ -250,7 +331,9 @@ void taskSerialCommand(void *parameter) {
             char c = Serial.read();
             if (c == '\n') {
                 // Đã nhận đủ 1 dòng
-                DeserializationError err = deserializeJson(doc, input);
+                // Mutable buffer -> in-situ parse, no string copies into doc;
+                // input is only reset after doc has been consumed below
+                DeserializationError err = deserializeJson(doc, input.begin());
                 if (!err && doc.containsKey("switch")) {
                     bool sw = doc["switch"];
                     digitalWrite(LED_PIN, sw ? HIGH : LOW);
@@ -276,6 +359,34 @@ void taskDHT20(void *parameter) {
     }
 }
 
+// Runtime health stats: per-task stack high-water marks plus heap
+// free/largest-block, published every 30s as one compact telemetry
+// object. Lets us size stacks tightly and spot leaks/fragmentation
+// before they become field failures.
+void taskDiagnostics(void *parameter) {
+    while (1) {
+        vTaskDelay(30000 / portTICK_PERIOD_MS);
+
+        StaticJsonDocument<JSON_OBJECT_SIZE(8)> doc;
+        if (taskDHT20Handle) doc["stackDht20"] = uxTaskGetStackHighWaterMark(taskDHT20Handle);
+        if (taskSerialHandle) doc["stackSerial"] = uxTaskGetStackHighWaterMark(taskSerialHandle);
+        if (taskSerialCommandHandle) doc["stackSerialCmd"] = uxTaskGetStackHighWaterMark(taskSerialCommandHandle);
+        doc["stackDiag"] = uxTaskGetStackHighWaterMark(NULL);
+        doc["heapFree"] = esp_get_free_heap_size();
+        doc["heapMinFree"] = esp_get_minimum_free_heap_size();
+        // Largest allocatable block: the fragmentation indicator
+        doc["heapMaxBlock"] = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        doc["uptimeS"] = millis() / 1000;
+
+        char payload[256];
+        serializeJson(doc, payload, sizeof(payload));
+        tb.sendTelemetryJson(payload);
+
+        Serial.print("[DIAG] ");
+        Serial.println(payload);
+    }
+}
+
 void taskThingsBoard(void *parameter) {
     // Không cần kết nối đến ThingsBoard nếu bạn chỉ muốn in ra terminal
     Serial.println("ThingsBoard connection disabled");
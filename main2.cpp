@@ -12,6 +12,8 @@
 #include "DHT20.h"
 #include "Wire.h"
 #include <ArduinoOTA.h>
+#include <ArduinoJson.h>
+#include <time.h>
 
 constexpr char WIFI_SSID[] = "Hiuu";
 constexpr char WIFI_PASSWORD[] = "phamhiu93";
@@ -41,6 +43,34 @@ uint32_t previousStateChange;
 constexpr int16_t telemetrySendInterval = 10000U;
 uint32_t previousDataSend;
 
+// SNTP so telemetry carries real epoch timestamps instead of millis()
+// (which resets on reboot and breaks server-side gap analysis)
+constexpr char NTP_SERVER[] = "pool.ntp.org";
+constexpr long GMT_OFFSET_SEC = 7 * 3600;  // UTC+7 (Vietnam)
+
+// Batch several sampling intervals into one publish: fewer broker
+// messages, and each record keeps its own device-side timestamp.
+constexpr size_t TELEMETRY_BATCH_SIZE = 3U;
+struct TimedReading {
+  uint64_t ts;  // epoch milliseconds
+  float temperature;
+  float humidity;
+  float light;
+  float moisture;
+};
+TimedReading telemetryBatch[TELEMETRY_BATCH_SIZE];
+size_t telemetryBatchCount = 0;
+
+// Epoch milliseconds from the SNTP-disciplined clock; 0 until first sync
+uint64_t epochMillis() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  if (tv.tv_sec < 1600000000) {
+    return 0;  // clock not synced yet
+  }
+  return (uint64_t)tv.tv_sec * 1000ULL + tv.tv_usec / 1000ULL;
+}
+
 constexpr std::array<const char *, 2U> SHARED_ATTRIBUTES_LIST = {
   LED_STATE_ATTR,
   BLINKING_INTERVAL_ATTR
@@ -126,7 +156,8 @@ void setup() {
   Wire.begin(SDA_PIN, SCL_PIN);
   dht20.begin();
 
-  
+  // Start SNTP in the background; epochMillis() returns 0 until synced
+  configTime(GMT_OFFSET_SEC, 0, NTP_SERVER);
 }
 
 void loop() {
@@ -204,11 +235,39 @@ void loop() {
       Serial.print(" lux, Light: ");
       Serial.println(light);  // Print raw analog value
 
-      tb.sendTelemetryData("temperature", temperature);
-      tb.sendTelemetryData("humidity", humidity);
-      tb.sendTelemetryData("light", lightPercent);
-      tb.sendTelemetryData("moisture", moisture);
- 
+      TimedReading &rec = telemetryBatch[telemetryBatchCount++];
+      rec.ts = epochMillis();
+      rec.temperature = temperature;
+      rec.humidity = humidity;
+      rec.light = lightPercent;
+      rec.moisture = moisture;
+
+      if (telemetryBatchCount >= TELEMETRY_BATCH_SIZE) {
+        // ThingsBoard timestamped format: [{"ts":...,"values":{...}},...]
+        // One PUBLISH carries the whole batch with per-record timestamps.
+        StaticJsonDocument<JSON_ARRAY_SIZE(TELEMETRY_BATCH_SIZE) +
+                           TELEMETRY_BATCH_SIZE * (JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(4))> doc;
+        for (size_t i = 0; i < telemetryBatchCount; i++) {
+          JsonObject entry = doc.createNestedObject();
+          entry["ts"] = telemetryBatch[i].ts;
+          JsonObject values = entry.createNestedObject("values");
+          values["temperature"] = telemetryBatch[i].temperature;
+          values["humidity"] = telemetryBatch[i].humidity;
+          values["light"] = telemetryBatch[i].light;
+          values["moisture"] = telemetryBatch[i].moisture;
+        }
+        char payload[512];
+        serializeJson(doc, payload, sizeof(payload));
+        if (tb.sendTelemetryJson(payload)) {
+          telemetryBatchCount = 0;
+        } else if (telemetryBatchCount >= TELEMETRY_BATCH_SIZE) {
+          // Publish failed and the batch is full: drop the oldest record
+          for (size_t i = 1; i < telemetryBatchCount; i++) {
+            telemetryBatch[i - 1] = telemetryBatch[i];
+          }
+          telemetryBatchCount--;
+        }
+      }
     }
 
     tb.sendAttributeData("rssi", WiFi.RSSI());
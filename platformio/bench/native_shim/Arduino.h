@@ -0,0 +1,147 @@
+/**
+ * Minimal Arduino.h stand-in for the host-native benchmark environment
+ * (env:native in platformio.ini).
+ *
+ * Provides just enough of the Arduino core for the vendored libraries
+ * the native suite compiles — NDEF needs String, Serial, F() and the
+ * AVR progmem macros; the b64 encoder and ArduinoJson need nothing
+ * beyond the type aliases. Everything maps onto the host C++ runtime:
+ * String wraps std::string, Serial prints to stdout, PROGMEM is a
+ * no-op. This is a shim for compiling library code off-device, not an
+ * emulator; anything touching pins, interrupts or Wire has no business
+ * being benchmarked on the host and is deliberately absent.
+ */
+
+#ifndef NATIVE_SHIM_ARDUINO_H
+#define NATIVE_SHIM_ARDUINO_H
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define PROGMEM
+#define PSTR(x) (x)
+#define F(x) (x)
+#define pgm_read_byte(x) (*(const uint8_t *)(x))
+#define pgm_read_word(x) (*(const uint16_t *)(x))
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+inline unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline void delay(unsigned long) {}
+inline void yield() {}
+
+// The subset of Arduino String the vendored libraries use: value
+// semantics, concatenation (including "literal" + String), length() and
+// getBytes(). Backed by std::string, so host heap behaviour differs
+// from the AVR implementation — fine for timing parse/serialize logic,
+// not for measuring String itself.
+class String {
+public:
+    String() {}
+    String(const char *s) : value_(s ? s : "") {}
+    String(const std::string &s) : value_(s) {}
+    String(char c) : value_(1, c) {}
+
+    unsigned int length() const { return (unsigned int)value_.size(); }
+    const char *c_str() const { return value_.c_str(); }
+    char charAt(unsigned int index) const { return value_[index]; }
+    char operator[](unsigned int index) const { return value_[index]; }
+
+    // Copies at most bufferSize - 1 bytes and null-terminates, matching
+    // the Arduino contract
+    void getBytes(unsigned char *buffer, unsigned int bufferSize) const {
+        if (bufferSize == 0) {
+            return;
+        }
+        unsigned int n = length() < bufferSize - 1 ? length() : bufferSize - 1;
+        memcpy(buffer, value_.data(), n);
+        buffer[n] = '\0';
+    }
+
+    String operator+(const String &other) const { return String(value_ + other.value_); }
+    String &operator+=(const String &other) {
+        value_ += other.value_;
+        return *this;
+    }
+    bool operator==(const String &other) const { return value_ == other.value_; }
+
+    friend String operator+(const char *lhs, const String &rhs) {
+        return String(std::string(lhs) + rhs.value_);
+    }
+
+private:
+    std::string value_;
+};
+
+// Serial facade over stdout; only the print/println shapes the
+// libraries' debug paths call
+class SerialShim {
+public:
+    void begin(unsigned long) {}
+
+    void print(const char *s) { fputs(s, stdout); }
+    void print(const String &s) { fputs(s.c_str(), stdout); }
+    void print(char c) { fputc(c, stdout); }
+    void print(int value, int base = DEC) { printInteger((long)value, base); }
+    void print(unsigned int value, int base = DEC) { printInteger((long)value, base); }
+    void print(long value, int base = DEC) { printInteger(value, base); }
+    void print(unsigned long value, int base = DEC) { printInteger((long)value, base); }
+
+    void println() { fputc('\n', stdout); }
+    template <typename T>
+    void println(T value) {
+        print(value);
+        println();
+    }
+    template <typename T>
+    void println(T value, int base) {
+        print(value, base);
+        println();
+    }
+
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int written = vprintf(format, args);
+        va_end(args);
+        return written;
+    }
+
+private:
+    void printInteger(long value, int base) {
+        if (base == HEX) {
+            ::printf("%lX", (unsigned long)value);
+        } else if (base == OCT) {
+            ::printf("%lo", (unsigned long)value);
+        } else {
+            ::printf("%ld", value);
+        }
+    }
+};
+
+inline SerialShim Serial;
+
+#endif // NATIVE_SHIM_ARDUINO_H
@@ -41,6 +41,9 @@ void HttpClient::resetState()
   iChunkLength = 0;
   iHttpResponseTimeout = kHttpResponseTimeout;
   iHttpWaitForDataDelay = kHttpWaitForDataDelay;
+  iHeaderLine[0] = '\0';
+  iHeaderLineLength = 0;
+  iHeaderColon = -1;
 }
 
 void HttpClient::stop()
@@ -253,6 +256,58 @@ void HttpClient::sendBasicAuth(const char* aUser, const char* aPassword)
     iClient->println();
 }
 
+size_t HttpClient::sendBody(const uint8_t* aBody, size_t aLength)
+{
+    if (iState < eRequestSent)
+    {
+        // We still need to finish off the headers
+        finishHeaders();
+    }
+
+    // Hand the buffer to the client in as few calls as possible, looping
+    // only when it accepts less than we offered
+    size_t written = 0;
+    while (written < aLength)
+    {
+        size_t chunk = iClient->write(aBody + written, aLength - written);
+        if (chunk == 0)
+        {
+            // The client can't take any more, give up rather than spin
+            break;
+        }
+        written += chunk;
+    }
+    return written;
+}
+
+size_t HttpClient::sendBody(HttpBodySourceCallback aBodySource, void* aContext)
+{
+    if (!aBodySource)
+    {
+        return 0;
+    }
+
+    uint8_t chunkBuffer[kBodySourceChunkSize];
+    size_t written = 0;
+    for (;;)
+    {
+        int filled = aBodySource(chunkBuffer, sizeof(chunkBuffer), aContext);
+        if (filled <= 0)
+        {
+            // The source has no more body data for us
+            break;
+        }
+        size_t sent = sendBody(chunkBuffer, filled);
+        written += sent;
+        if (sent < (size_t)filled)
+        {
+            // Couldn't send everything, no point pulling more
+            break;
+        }
+    }
+    return written;
+}
+
 void HttpClient::finishHeaders()
 {
     iClient->println();
@@ -317,6 +372,22 @@ int HttpClient::post(const char* aURLPath, const char* aContentType, int aConten
     return startRequest(aURLPath, HTTP_METHOD_POST, aContentType, aContentLength, aBody);
 }
 
+int HttpClient::post(const char* aURLPath, const char* aContentType, size_t aContentLength,
+                     HttpBodySourceCallback aBodySource, void* aContext)
+{
+    // Send the request line and headers (including Content-Length) first,
+    // then pull the body from the source callback
+    int ret = startRequest(aURLPath, HTTP_METHOD_POST, aContentType, aContentLength, NULL);
+    if (HTTP_SUCCESS == ret)
+    {
+        if (sendBody(aBodySource, aContext) != aContentLength)
+        {
+            return HTTP_ERROR_API;
+        }
+    }
+    return ret;
+}
+
 int HttpClient::put(const char* aURLPath)
 {
     return startRequest(aURLPath, HTTP_METHOD_PUT);
@@ -342,6 +413,20 @@ int HttpClient::put(const char* aURLPath, const char* aContentType, int aContent
     return startRequest(aURLPath, HTTP_METHOD_PUT, aContentType, aContentLength, aBody);
 }
 
+int HttpClient::put(const char* aURLPath, const char* aContentType, size_t aContentLength,
+                    HttpBodySourceCallback aBodySource, void* aContext)
+{
+    int ret = startRequest(aURLPath, HTTP_METHOD_PUT, aContentType, aContentLength, NULL);
+    if (HTTP_SUCCESS == ret)
+    {
+        if (sendBody(aBodySource, aContext) != aContentLength)
+        {
+            return HTTP_ERROR_API;
+        }
+    }
+    return ret;
+}
+
 int HttpClient::patch(const char* aURLPath)
 {
     return startRequest(aURLPath, HTTP_METHOD_PATCH);
@@ -595,6 +680,63 @@ String HttpClient::responseBody()
     return response;
 }
 
+long HttpClient::responseBody(HttpResponseSinkCallback aSink, void* aContext)
+{
+    long bodyLength = contentLength();
+
+    uint8_t chunkBuffer[kBodySourceChunkSize];
+    long delivered = 0;
+    unsigned long timeoutStart = millis();
+    // Keep going until the sized body is complete, or - without a
+    // Content-Length - until the server closes the connection
+    while ((bodyLength == kNoContentLengthHeader) || (delivered < bodyLength))
+    {
+        int availableBytes = available();
+        if (availableBytes > 0)
+        {
+            size_t toRead = (size_t)availableBytes;
+            if (toRead > sizeof(chunkBuffer))
+            {
+                toRead = sizeof(chunkBuffer);
+            }
+            int readBytes = read(chunkBuffer, toRead);
+            if (readBytes > 0)
+            {
+                delivered += readBytes;
+                if (aSink && !aSink(chunkBuffer, readBytes, aContext))
+                {
+                    // The sink has asked us to stop
+                    break;
+                }
+                // We read something, reset the timeout counter
+                timeoutStart = millis();
+            }
+        }
+        else if (!iClient->connected() && !iClient->available())
+        {
+            // Connection is down and the receive buffer is drained
+            break;
+        }
+        else if ((millis() - timeoutStart) > iHttpResponseTimeout)
+        {
+            // Spent too long waiting for more body data
+            if ((bodyLength != kNoContentLengthHeader) && (delivered < bodyLength))
+            {
+                return HTTP_ERROR_TIMED_OUT;
+            }
+            break;
+        }
+        else
+        {
+            // We haven't got any data, so let's pause to allow some to
+            // arrive
+            delay(iHttpWaitForDataDelay);
+        }
+    }
+
+    return delivered;
+}
+
 bool HttpClient::endOfBodyReached()
 {
     if (endOfHeadersReached() && (contentLength() != kNoContentLengthHeader))
@@ -686,8 +828,10 @@ int HttpClient::read()
 
 bool HttpClient::headerAvailable()
 {
-    // clear the currently stored header line
-    iHeaderLine = "";
+    // capture the next header line straight into the fixed buffer - one
+    // pass over the bytes as they arrive, no String building per header
+    iHeaderLineLength = 0;
+    iHeaderColon = -1;
 
     while (!endOfHeadersReached())
     {
@@ -696,11 +840,11 @@ bool HttpClient::headerAvailable()
 
         if (c == '\r' || c == '\n')
         {
-            if (iHeaderLine.length())
+            if (iHeaderLineLength)
             {
                 // end of the line, all done
                 break;
-            } 
+            }
             else
             {
                 // ignore any CR or LF characters
@@ -708,42 +852,61 @@ bool HttpClient::headerAvailable()
             }
         }
 
-        // append byte to header line
-        iHeaderLine += (char)c;
+        if ((iHeaderColon == -1) && (c == ':'))
+        {
+            // note where the name ends as we pass it
+            iHeaderColon = (int)iHeaderLineLength;
+        }
+        // append byte to header line; overlong lines are parsed but the
+        // excess bytes are dropped
+        if (iHeaderLineLength < kHeaderLineBufferSize-1)
+        {
+            iHeaderLine[iHeaderLineLength++] = (char)c;
+        }
     }
+    iHeaderLine[iHeaderLineLength] = '\0';
 
-    return (iHeaderLine.length() > 0);
+    return (iHeaderLineLength > 0);
 }
 
-String HttpClient::readHeaderName()
+const char* HttpClient::headerName()
 {
-    int colonIndex = iHeaderLine.indexOf(':');
-
-    if (colonIndex == -1)
+    if (iHeaderColon == -1)
     {
         return "";
     }
 
-    return iHeaderLine.substring(0, colonIndex);
+    // terminate the name in place of the colon so the buffer itself is
+    // the view; idempotent across repeated calls
+    iHeaderLine[iHeaderColon] = '\0';
+    return iHeaderLine;
 }
 
-String HttpClient::readHeaderValue()
+const char* HttpClient::headerValue()
 {
-    int colonIndex = iHeaderLine.indexOf(':');
-    int startIndex = colonIndex + 1;
-
-    if (colonIndex == -1)
+    if (iHeaderColon == -1)
     {
         return "";
     }
 
+    const char* value = &iHeaderLine[iHeaderColon+1];
     // trim any leading whitespace
-    while (startIndex < (int)iHeaderLine.length() && isSpace(iHeaderLine[startIndex]))
+    while (*value && isSpace(*value))
     {
-        startIndex++;
+        value++;
     }
 
-    return iHeaderLine.substring(startIndex);
+    return value;
+}
+
+String HttpClient::readHeaderName()
+{
+    return String(headerName());
+}
+
+String HttpClient::readHeaderValue()
+{
+    return String(headerValue());
 }
 
 int HttpClient::read(uint8_t *buf, size_t size)
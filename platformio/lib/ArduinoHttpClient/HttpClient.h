@@ -38,6 +38,24 @@ static const int HTTP_ERROR_INVALID_RESPONSE =-4;
 #define HTTP_HEADER_USER_AGENT     "User-Agent"
 #define HTTP_HEADER_VALUE_CHUNKED  "chunked"
 
+/** Pull-based request body source.  Called repeatedly to fill aBuffer with
+  up to aMaxSize bytes of body data and return how many bytes were written.
+  Return 0 to signal that the body is complete.
+  @param aBuffer   Buffer to fill with the next run of body bytes
+  @param aMaxSize  Capacity of aBuffer
+  @param aContext  Opaque pointer passed through from the caller
+*/
+typedef int (*HttpBodySourceCallback)(uint8_t* aBuffer, size_t aMaxSize, void* aContext);
+
+/** Sink for streaming response bodies.  Called with each run of body bytes
+  as it arrives from the server.  Return true to keep receiving, false to
+  abort the transfer.
+  @param aData     Body bytes received in this run
+  @param aLength   Number of bytes in aData
+  @param aContext  Opaque pointer passed through from the caller
+*/
+typedef bool (*HttpResponseSinkCallback)(const uint8_t* aData, size_t aLength, void* aContext);
+
 class HttpClient : public Client
 {
 public:
@@ -97,6 +115,20 @@ public:
     int post(const String& aURLPath, const String& aContentType, const String& aBody);
     int post(const char* aURLPath, const char* aContentType, int aContentLength, const byte aBody[]);
 
+    /** Connect to the server and send a POST request whose body is pulled
+        from a callback.  The Content-Length header is sent up front from
+        aContentLength, so no chunked encoding is needed, and the body goes
+        to the socket in maximal chunks with no intermediate String.
+      @param aURLPath        Url to request
+      @param aContentType    Content type of request body
+      @param aContentLength  Total length of the body the callback will produce
+      @param aBodySource     Callback that fills successive body chunks
+      @param aContext        Opaque pointer handed to every callback invocation
+      @return 0 if successful, else error
+    */
+    int post(const char* aURLPath, const char* aContentType, size_t aContentLength,
+             HttpBodySourceCallback aBodySource, void* aContext = NULL);
+
     /** Connect to the server and start to send a PUT request.
       @param aURLPath     Url to request
       @return 0 if successful, else error
@@ -115,6 +147,18 @@ public:
     int put(const String& aURLPath, const String& aContentType, const String& aBody);
     int put(const char* aURLPath, const char* aContentType, int aContentLength, const byte aBody[]);
 
+    /** Connect to the server and send a PUT request whose body is pulled
+        from a callback.  See the matching post() overload for details.
+      @param aURLPath        Url to request
+      @param aContentType    Content type of request body
+      @param aContentLength  Total length of the body the callback will produce
+      @param aBodySource     Callback that fills successive body chunks
+      @param aContext        Opaque pointer handed to every callback invocation
+      @return 0 if successful, else error
+    */
+    int put(const char* aURLPath, const char* aContentType, size_t aContentLength,
+            HttpBodySourceCallback aBodySource, void* aContext = NULL);
+
     /** Connect to the server and start to send a PATCH request.
       @param aURLPath     Url to request
       @return 0 if successful, else error
@@ -209,6 +253,25 @@ public:
     */
     void sendBasicAuth(const char* aUser, const char* aPassword);
 
+    /** Send request body bytes directly from the caller's buffer.
+      Unlike the Print::write path this loops until the underlying client
+      has accepted the whole buffer, so large payloads (camera frames,
+      batched telemetry) go out in maximal chunks with one call.
+      Finishes off the request headers first if that hasn't happened yet.
+      @param aBody    Buffer holding the body bytes
+      @param aLength  Number of bytes to send
+      @return Number of bytes actually sent
+    */
+    size_t sendBody(const uint8_t* aBody, size_t aLength);
+
+    /** Send a request body pulled from a callback.  The callback is invoked
+      repeatedly to fill an internal chunk buffer until it returns 0.
+      @param aBodySource  Callback that fills successive body chunks
+      @param aContext     Opaque pointer handed to every callback invocation
+      @return Number of bytes actually sent
+    */
+    size_t sendBody(HttpBodySourceCallback aBodySource, void* aContext = NULL);
+
     void sendBasicAuth(const String& aUser, const String& aPassword)
       { sendBasicAuth(aUser.c_str(), aPassword.c_str()); }
 
@@ -224,13 +287,29 @@ public:
     */
     bool headerAvailable();
 
+    /** Name of the current response header, as a view into the internal
+      line buffer - no String allocation.  Valid until the next call to
+      headerAvailable().
+      Returns empty string if a header is not available.
+    */
+    const char* headerName();
+
+    /** Value of the current response header, as a view into the internal
+      line buffer with leading whitespace skipped - no String allocation.
+      Valid until the next call to headerAvailable().
+      Returns empty string if a header is not available.
+    */
+    const char* headerValue();
+
     /** Read the name of the current response header.
       Returns empty string if a header is not available.
+      Allocates a String per call; prefer headerName() in new code.
     */
     String readHeaderName();
 
     /** Read the value of the current response header.
       Returns empty string if a header is not available.
+      Allocates a String per call; prefer headerValue() in new code.
     */
     String readHeaderValue();
 
@@ -287,6 +366,21 @@ public:
     */
     String responseBody();
 
+    /** Stream the response body into a sink callback as it arrives.
+      Also skips response headers if they have not been read already.
+      Unlike the String variant, nothing is buffered: each chunk is handed
+      to the sink and forgotten, so arbitrarily large bodies (configuration
+      blobs, firmware images) can be written straight into flash with
+      constant memory.
+      MUST be called after responseStatusCode()
+      @param aSink     Callback receiving successive body chunks
+      @param aContext  Opaque pointer handed to every sink invocation
+      @return Number of body bytes delivered to the sink, or
+      HTTP_ERROR_TIMED_OUT if the connection stalled before the body
+      (as sized by Content-Length) was complete
+    */
+    long responseBody(HttpResponseSinkCallback aSink, void* aContext = NULL);
+
     /** Enables connection keep-alive mode
     */
     void connectionKeepAlive();
@@ -348,6 +442,9 @@ protected:
     // data before returning HTTP_ERROR_TIMED_OUT (during status code and header
     // processing)
     static const int kHttpResponseTimeout = 30*1000;
+    // Size of the stack chunk buffer used when pulling a body from a
+    // HttpBodySourceCallback
+    static const size_t kBodySourceChunkSize = 1024;
     static const char* kContentLengthPrefix;
     static const char* kTransferEncodingChunked;
     typedef enum {
@@ -390,7 +487,14 @@ protected:
     uint32_t iHttpWaitForDataDelay;
     bool iConnectionClose;
     bool iSendDefaultRequestHeaders;
-    String iHeaderLine;
+    // Current header line, captured straight into this buffer as the
+    // bytes arrive - one pass, no String building per header.
+    // headerName()/headerValue() hand out views into it.
+    static const size_t kHeaderLineBufferSize = 128;
+    char iHeaderLine[kHeaderLineBufferSize];
+    size_t iHeaderLineLength;
+    // Index of the ':' separator in iHeaderLine, or -1
+    int iHeaderColon;
 };
 
 #endif
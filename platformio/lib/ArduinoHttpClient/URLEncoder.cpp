@@ -4,6 +4,32 @@
 
 #include "URLEncoder.h"
 
+// One entry per possible byte: 1 if the character can be emitted as-is
+// (RFC 3986 unreserved: ALPHA / DIGIT / "-" / "." / "_" / "~"),
+// 0 if it has to be percent-encoded.  Classifying through the table
+// replaces the chain of comparisons previously taken for every character
+static const unsigned char kUnreserved[256] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x00-0x0f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x10-0x1f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, // 0x20-0x2f  - .
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, // 0x30-0x3f  0-9
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x40-0x4f  A-O
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, // 0x50-0x5f  P-Z _
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x60-0x6f  a-o
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 0, // 0x70-0x7f  p-z ~
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x80-0x8f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x90-0x9f
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xa0-0xaf
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xb0-0xbf
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xc0-0xcf
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xd0-0xdf
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0xe0-0xef
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0  // 0xf0-0xff
+};
+
+static const char kHexDigits[] = "0123456789ABCDEF";
+
 URLEncoderClass::URLEncoderClass()
 {
 }
@@ -24,26 +50,31 @@ String URLEncoderClass::encode(const String& str)
 
 String URLEncoderClass::encode(const char* str, int length)
 {
-    String encoded;
+    // First pass: work out the exact output length, so the result is
+    // built in one reservation instead of growing by concatenation
+    int encodedLength = length;
+    for (int i = 0; i < length; i++) {
+        if (!kUnreserved[(unsigned char)str[i]]) {
+            encodedLength += 2; // '%XX' instead of one character
+        }
+    }
 
-    encoded.reserve(length);
+    String encoded;
+    if (!encoded.reserve(encodedLength)) {
+        return encoded;
+    }
 
+    // Second pass: single classification lookup per character, no
+    // reallocation possible
     for (int i = 0; i < length; i++) {
-        char c = str[i];
+        unsigned char c = (unsigned char)str[i];
 
-        const char HEX_DIGIT_MAPPER[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-
-        if (isAlphaNumeric(c) || (c == '-') || (c == '.') || (c == '_') || (c == '~')) {
-            encoded += c;
+        if (kUnreserved[c]) {
+            encoded += (char)c;
         } else {
-            char s[4];
-
-            s[0] = '%';
-            s[1] = HEX_DIGIT_MAPPER[(c >> 4) & 0xf];
-            s[2] = HEX_DIGIT_MAPPER[(c & 0x0f)];
-            s[3] = 0;
-
-            encoded += s;
+            encoded += '%';
+            encoded += kHexDigits[(c >> 4) & 0x0f];
+            encoded += kHexDigits[c & 0x0f];
         }
     }
 
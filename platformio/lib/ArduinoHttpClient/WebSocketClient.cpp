@@ -2,30 +2,56 @@
 // Released under Apache License, version 2.0
 
 #include "b64.h"
+#include "ws_deflate.h"
 
 #include "WebSocketClient.h"
 
 WebSocketClient::WebSocketClient(Client& aClient, const char* aServerName, uint16_t aServerPort)
  : HttpClient(aClient, aServerName, aServerPort),
    iTxStarted(false),
-   iRxSize(0)
+   iRxSize(0),
+   iCompressionRequested(false),
+   iCompressionActive(false),
+   iRxInflated(NULL),
+   iRxInflatedSize(0),
+   iRxInflatedOffset(0)
 {
 }
 
 WebSocketClient::WebSocketClient(Client& aClient, const String& aServerName, uint16_t aServerPort) 
  : HttpClient(aClient, aServerName, aServerPort),
    iTxStarted(false),
-   iRxSize(0)
+   iRxSize(0),
+   iCompressionRequested(false),
+   iCompressionActive(false),
+   iRxInflated(NULL),
+   iRxInflatedSize(0),
+   iRxInflatedOffset(0)
 {
 }
 
 WebSocketClient::WebSocketClient(Client& aClient, const IPAddress& aServerAddress, uint16_t aServerPort)
  : HttpClient(aClient, aServerAddress, aServerPort),
    iTxStarted(false),
-   iRxSize(0)
+   iRxSize(0),
+   iCompressionRequested(false),
+   iCompressionActive(false),
+   iRxInflated(NULL),
+   iRxInflatedSize(0),
+   iRxInflatedOffset(0)
 {
 }
 
+void WebSocketClient::enableCompression()
+{
+    iCompressionRequested = true;
+}
+
+bool WebSocketClient::compressionActive()
+{
+    return iCompressionActive;
+}
+
 int WebSocketClient::begin(const char* aPath)
 {
     // start the GET request
@@ -51,17 +77,44 @@ int WebSocketClient::begin(const char* aPath)
         sendHeader("Connection", "Upgrade");
         sendHeader("Sec-WebSocket-Key", base64RandomKey);
         sendHeader("Sec-WebSocket-Version", "13");
+        if (iCompressionRequested)
+        {
+            // No context takeover in either direction keeps the memory
+            // cost to one window per message, and the client window is
+            // capped to what the small deflater actually uses
+            sendHeader("Sec-WebSocket-Extensions",
+                       "permessage-deflate; client_no_context_takeover; "
+                       "server_no_context_takeover; client_max_window_bits=" WS_DEFLATE_WINDOW_BITS_STR);
+        }
         endRequest();
 
         status = responseStatusCode();
 
         if (status > 0)
         {
-            skipResponseHeaders();
+            iCompressionActive = false;
+            if (iCompressionRequested)
+            {
+                // Look for the server accepting the extension while
+                // consuming the response headers
+                while (headerAvailable())
+                {
+                    if (readHeaderName().equalsIgnoreCase("Sec-WebSocket-Extensions") &&
+                        readHeaderValue().indexOf("permessage-deflate") >= 0)
+                    {
+                        iCompressionActive = true;
+                    }
+                }
+            }
+            else
+            {
+                skipResponseHeaders();
+            }
         }
     }
 
     iRxSize = 0;
+    clearRxInflated();
 
     // status code of 101 means success
     return (status == 101) ? 0 : status;
@@ -95,32 +148,51 @@ int WebSocketClient::endMessage()
         return 1;
     }
 
-    // send FIN + the message type (opcode)
-    HttpClient::write(0x80 | iTxMessageType);
+    uint8_t* payload = iTxBuffer;
+    uint64_t payloadSize = iTxSize;
+    uint8_t rsv = 0x00;
+
+    // compress data messages when negotiated and it actually helps
+    uint8_t compressed[WS_TX_BUFFER_SIZE];
+    if (iCompressionActive && iTxSize > 0 &&
+        (iTxMessageType == TYPE_TEXT || iTxMessageType == TYPE_BINARY))
+    {
+        int compressedSize = ws_deflate_compress(iTxBuffer, iTxSize,
+                                                 compressed, sizeof(compressed));
+        if (compressedSize > 0 && (uint64_t)compressedSize < iTxSize)
+        {
+            payload = compressed;
+            payloadSize = compressedSize;
+            rsv = 0x40; // RSV1 marks a permessage-deflate payload
+        }
+    }
+
+    // send FIN + RSV1 if compressed + the message type (opcode)
+    HttpClient::write(0x80 | rsv | iTxMessageType);
 
     // the message is masked (0x80)
     // send the length
-    if (iTxSize < 126)
+    if (payloadSize < 126)
     {
-        HttpClient::write(0x80 | (uint8_t)iTxSize);
+        HttpClient::write(0x80 | (uint8_t)payloadSize);
     }
-    else if (iTxSize < 0xffff)
+    else if (payloadSize < 0xffff)
     {
         HttpClient::write(0x80 | 126);
-        HttpClient::write((iTxSize >> 8) & 0xff);
-        HttpClient::write((iTxSize >> 0) & 0xff);
+        HttpClient::write((payloadSize >> 8) & 0xff);
+        HttpClient::write((payloadSize >> 0) & 0xff);
     }
     else
     {
         HttpClient::write(0x80 | 127);
-        HttpClient::write((iTxSize >> 56) & 0xff);
-        HttpClient::write((iTxSize >> 48) & 0xff);
-        HttpClient::write((iTxSize >> 40) & 0xff);
-        HttpClient::write((iTxSize >> 32) & 0xff);
-        HttpClient::write((iTxSize >> 24) & 0xff);
-        HttpClient::write((iTxSize >> 16) & 0xff);
-        HttpClient::write((iTxSize >> 8) & 0xff);
-        HttpClient::write((iTxSize >> 0) & 0xff);
+        HttpClient::write((payloadSize >> 56) & 0xff);
+        HttpClient::write((payloadSize >> 48) & 0xff);
+        HttpClient::write((payloadSize >> 40) & 0xff);
+        HttpClient::write((payloadSize >> 32) & 0xff);
+        HttpClient::write((payloadSize >> 24) & 0xff);
+        HttpClient::write((payloadSize >> 16) & 0xff);
+        HttpClient::write((payloadSize >> 8) & 0xff);
+        HttpClient::write((payloadSize >> 0) & 0xff);
     }
 
     uint8_t maskKey[4];
@@ -133,16 +205,16 @@ int WebSocketClient::endMessage()
     HttpClient::write(maskKey, sizeof(maskKey));
 
     // mask the data and send
-    for (int i = 0; i < (int)iTxSize; i++) {
-        iTxBuffer[i] ^= maskKey[i % sizeof(maskKey)];
+    for (int i = 0; i < (int)payloadSize; i++) {
+        payload[i] ^= maskKey[i % sizeof(maskKey)];
     }
 
-    size_t txSize = iTxSize;
+    size_t txSize = payloadSize;
 
     iTxStarted = false;
     iTxSize = 0;
 
-    return (HttpClient::write(iTxBuffer, txSize) == txSize) ? 0 : 1;
+    return (HttpClient::write(payload, txSize) == txSize) ? 0 : 1;
 }
 
 size_t WebSocketClient::write(uint8_t aByte)
@@ -181,6 +253,7 @@ size_t WebSocketClient::write(const uint8_t *aBuffer, size_t aSize)
 int WebSocketClient::parseMessage()
 {
     flushRx();
+    clearRxInflated();
 
     // make sure 2 bytes (opcode + length)
     // are available
@@ -260,8 +333,14 @@ int WebSocketClient::parseMessage()
         flushRx();
         iRxSize = 0;
     }
+    else if (iCompressionActive && (iRxOpCode & 0x40) && iRxSize > 0)
+    {
+        // RSV1 set: the payload is deflated, decompress it up front so
+        // the read API keeps handing out plain message bytes
+        inflateRxMessage();
+    }
 
-    return iRxSize;
+    return available();
 }
 
 int WebSocketClient::messageType()
@@ -314,6 +393,11 @@ int WebSocketClient::available()
         return HttpClient::available();
     }
 
+    if (iRxInflated)
+    {
+        return iRxInflatedSize - iRxInflatedOffset;
+    }
+
     return iRxSize;
 }
 
@@ -331,6 +415,27 @@ int WebSocketClient::read()
 
 int WebSocketClient::read(uint8_t *aBuffer, size_t aSize)
 {
+    if (iRxInflated)
+    {
+        // serve the decompressed payload instead of the socket data
+        size_t remaining = iRxInflatedSize - iRxInflatedOffset;
+        if (remaining == 0)
+        {
+            return 0;
+        }
+        if (aSize > remaining)
+        {
+            aSize = remaining;
+        }
+        memcpy(aBuffer, iRxInflated + iRxInflatedOffset, aSize);
+        iRxInflatedOffset += aSize;
+        if (iRxInflatedOffset == iRxInflatedSize)
+        {
+            clearRxInflated();
+        }
+        return aSize;
+    }
+
     int readCount = HttpClient::read(aBuffer, aSize);
 
     if (readCount > 0)
@@ -352,6 +457,15 @@ int WebSocketClient::read(uint8_t *aBuffer, size_t aSize)
 
 int WebSocketClient::peek()
 {
+    if (iRxInflated)
+    {
+        if (iRxInflatedOffset >= iRxInflatedSize)
+        {
+            return -1;
+        }
+        return iRxInflated[iRxInflatedOffset];
+    }
+
     int p = HttpClient::peek();
 
     if (p != -1 && iRxMasked)
@@ -370,3 +484,68 @@ void WebSocketClient::flushRx()
         read();
     }
 }
+
+void WebSocketClient::clearRxInflated()
+{
+    if (iRxInflated)
+    {
+        free(iRxInflated);
+        iRxInflated = NULL;
+    }
+    iRxInflatedSize = 0;
+    iRxInflatedOffset = 0;
+}
+
+void WebSocketClient::inflateRxMessage()
+{
+    // Pull the whole compressed payload off the socket (unmasking it on
+    // the way through read), re-append the 00 00 FF FF flush tail that
+    // permessage-deflate strips, and inflate it in one go
+    size_t compressedSize = iRxSize;
+    uint8_t* compressed = (uint8_t*)malloc(compressedSize + 4);
+    if (compressed == NULL)
+    {
+        flushRx();
+        return;
+    }
+
+    size_t readTotal = 0;
+    while (readTotal < compressedSize)
+    {
+        int readCount = read(compressed + readTotal, compressedSize - readTotal);
+        if (readCount <= 0)
+        {
+            break;
+        }
+        readTotal += readCount;
+    }
+    if (readTotal < compressedSize)
+    {
+        free(compressed);
+        return;
+    }
+    compressed[compressedSize + 0] = 0x00;
+    compressed[compressedSize + 1] = 0x00;
+    compressed[compressedSize + 2] = 0xFF;
+    compressed[compressedSize + 3] = 0xFF;
+
+    uint8_t* inflated = (uint8_t*)malloc(WS_RX_INFLATE_BUFFER_SIZE);
+    if (inflated == NULL)
+    {
+        free(compressed);
+        return;
+    }
+
+    int inflatedSize = ws_inflate(compressed, compressedSize + 4,
+                                  inflated, WS_RX_INFLATE_BUFFER_SIZE);
+    free(compressed);
+    if (inflatedSize < 0)
+    {
+        free(inflated);
+        return;
+    }
+
+    iRxInflated = inflated;
+    iRxInflatedSize = inflatedSize;
+    iRxInflatedOffset = 0;
+}
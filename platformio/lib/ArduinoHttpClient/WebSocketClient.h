@@ -12,6 +12,10 @@
   #define WS_TX_BUFFER_SIZE 128
 #endif
 
+#ifndef WS_RX_INFLATE_BUFFER_SIZE
+  #define WS_RX_INFLATE_BUFFER_SIZE 4096
+#endif
+
 static const int TYPE_CONTINUATION     = 0x0;
 static const int TYPE_TEXT             = 0x1;
 static const int TYPE_BINARY           = 0x2;
@@ -33,6 +37,19 @@ public:
     int begin(const char* aPath = "/");
     int begin(const String& aPath);
 
+    /** Request permessage-deflate compression (RFC 7692) during the next
+        begin().  When the server accepts, outgoing TEXT and BINARY
+        messages are compressed with a small 4KB-window deflater whenever
+        that makes them smaller, and compressed incoming messages are
+        inflated transparently.  Call before begin().
+    */
+    void enableCompression();
+
+    /** Returns whether permessage-deflate was negotiated successfully
+        on the current connection
+    */
+    bool compressionActive();
+
     /** Begin to send a message of type (TYPE_TEXT or TYPE_BINARY)
         Use the write or Stream API's to set message content, followed by endMessage
         to complete the message.
@@ -86,6 +103,8 @@ public:
 
 private:
     void flushRx();
+    void clearRxInflated();
+    void inflateRxMessage();
 
 private:
     bool iTxStarted;
@@ -98,6 +117,14 @@ private:
     bool iRxMasked;
     int iRxMaskIndex;
     uint8_t iRxMaskKey[4];
+
+    bool iCompressionRequested;
+    bool iCompressionActive;
+    // Inflated payload of the current compressed RX message, served out
+    // through available()/read() in place of the socket data
+    uint8_t* iRxInflated;
+    size_t iRxInflatedSize;
+    size_t iRxInflatedOffset;
 };
 
 #endif
@@ -18,6 +18,30 @@ void main()
 }
 */
 
+static const char b64_dictionary[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Reverse lookup table, maps an ASCII character to its 6-bit value,
+// 0xFF marks characters that are not part of the alphabet
+static const unsigned char b64_reverse[256] =
+{
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x3E,0xFF,0xFF,0xFF,0x3F,
+    0x34,0x35,0x36,0x37,0x38,0x39,0x3A,0x3B,0x3C,0x3D,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0A,0x0B,0x0C,0x0D,0x0E,
+    0x0F,0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0x1A,0x1B,0x1C,0x1D,0x1E,0x1F,0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,
+    0x29,0x2A,0x2B,0x2C,0x2D,0x2E,0x2F,0x30,0x31,0x32,0x33,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+};
+
 int b64_encode(const unsigned char* aInput, int aInputLen, unsigned char* aOutput, int aOutputLen)
 {
     // Work out if we've got enough space to encode the input
@@ -30,43 +54,114 @@ int b64_encode(const unsigned char* aInput, int aInputLen, unsigned char* aOutpu
 
     // If we get here we've got enough space to do the encoding
 
-    const char* b64_dictionary = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    if (aInputLen == 3)
+    // Process whole 3-byte groups with a flat loop, one 24-bit load
+    // and four table lookups per group, instead of recursing per group
+    const unsigned char* in = aInput;
+    unsigned char* out = aOutput;
+    int groups = aInputLen / 3;
+    while (groups-- > 0)
     {
-        aOutput[0] = b64_dictionary[aInput[0] >> 2];
-        aOutput[1] = b64_dictionary[(aInput[0] & 0x3)<<4|(aInput[1]>>4)];
-        aOutput[2] = b64_dictionary[(aInput[1]&0x0F)<<2|(aInput[2]>>6)];
-        aOutput[3] = b64_dictionary[aInput[2]&0x3F];
+        unsigned long triple = ((unsigned long)in[0] << 16) |
+                               ((unsigned long)in[1] << 8) |
+                               (unsigned long)in[2];
+        out[0] = b64_dictionary[(triple >> 18) & 0x3F];
+        out[1] = b64_dictionary[(triple >> 12) & 0x3F];
+        out[2] = b64_dictionary[(triple >> 6) & 0x3F];
+        out[3] = b64_dictionary[triple & 0x3F];
+        in += 3;
+        out += 4;
     }
-    else if (aInputLen == 2)
+
+    // Pad out the final partial group, if any
+    int remainder = aInputLen % 3;
+    if (remainder == 2)
+    {
+        out[0] = b64_dictionary[in[0] >> 2];
+        out[1] = b64_dictionary[((in[0] & 0x3) << 4) | (in[1] >> 4)];
+        out[2] = b64_dictionary[(in[1] & 0x0F) << 2];
+        out[3] = '=';
+    }
+    else if (remainder == 1)
+    {
+        out[0] = b64_dictionary[in[0] >> 2];
+        out[1] = b64_dictionary[(in[0] & 0x3) << 4];
+        out[2] = '=';
+        out[3] = '=';
+    }
+
+    return ((aInputLen+2)/3)*4;
+}
+
+int b64_decode(const unsigned char* aInput, int aInputLen, unsigned char* aOutput, int aOutputLen)
+{
+    // Ignore trailing padding when sizing the output
+    int effectiveLen = aInputLen;
+    while (effectiveLen > 0 && aInput[effectiveLen-1] == '=')
     {
-        aOutput[0] = b64_dictionary[aInput[0] >> 2];
-        aOutput[1] = b64_dictionary[(aInput[0] & 0x3)<<4|(aInput[1]>>4)];
-        aOutput[2] = b64_dictionary[(aInput[1]&0x0F)<<2];
-        aOutput[3] = '=';
+        effectiveLen--;
     }
-    else if (aInputLen == 1)
+    int decodedLen = (effectiveLen/4)*3;
+    int remainder = effectiveLen % 4;
+    if (remainder >= 2)
     {
-        aOutput[0] = b64_dictionary[aInput[0] >> 2];
-        aOutput[1] = b64_dictionary[(aInput[0] & 0x3)<<4];
-        aOutput[2] = '=';
-        aOutput[3] = '=';
+        decodedLen += remainder - 1;
     }
-    else
+    if (aOutputLen < decodedLen)
     {
-        // Break the input into 3-byte chunks and process each of them
-        int i;
-        for (i = 0; i < aInputLen/3; i++)
+        return decodedLen;
+    }
+
+    // Process four input characters at a time into three output bytes
+    const unsigned char* in = aInput;
+    unsigned char* out = aOutput;
+    int groups = effectiveLen / 4;
+    while (groups-- > 0)
+    {
+        unsigned char a = b64_reverse[in[0]];
+        unsigned char b = b64_reverse[in[1]];
+        unsigned char c = b64_reverse[in[2]];
+        unsigned char d = b64_reverse[in[3]];
+        if ((a | b | c | d) == 0xFF)
+        {
+            // Invalid character in the input
+            return -1;
+        }
+        unsigned long triple = ((unsigned long)a << 18) |
+                               ((unsigned long)b << 12) |
+                               ((unsigned long)c << 6) |
+                               (unsigned long)d;
+        out[0] = (triple >> 16) & 0xFF;
+        out[1] = (triple >> 8) & 0xFF;
+        out[2] = triple & 0xFF;
+        in += 4;
+        out += 3;
+    }
+
+    // Final partial group, left over after stripping '=' padding
+    if (remainder >= 2)
+    {
+        unsigned char a = b64_reverse[in[0]];
+        unsigned char b = b64_reverse[in[1]];
+        if ((a | b) == 0xFF)
         {
-            b64_encode(&aInput[i*3], 3, &aOutput[i*4], 4);
+            return -1;
         }
-        if (aInputLen % 3 > 0)
+        out[0] = (a << 2) | (b >> 4);
+        if (remainder == 3)
         {
-            // It doesn't fit neatly into a 3-byte chunk, so process what's left
-            b64_encode(&aInput[i*3], aInputLen % 3, &aOutput[i*4], aOutputLen - (i*4));
+            unsigned char c = b64_reverse[in[2]];
+            if (c == 0xFF)
+            {
+                return -1;
+            }
+            out[1] = ((b & 0x0F) << 4) | (c >> 2);
         }
     }
+    else if (remainder == 1)
+    {
+        // A single leftover character can never decode to a full byte
+        return -1;
+    }
 
-    return ((aInputLen+2)/3)*4;
+    return decodedLen;
 }
-
@@ -3,4 +3,9 @@
 
 int b64_encode(const unsigned char* aInput, int aInputLen, unsigned char* aOutput, int aOutputLen);
 
+// Decodes base64 input (with or without '=' padding) four characters at
+// a time. Returns the decoded length, the required output length if
+// aOutputLen is too small, or -1 on invalid input
+int b64_decode(const unsigned char* aInput, int aInputLen, unsigned char* aOutput, int aOutputLen);
+
 #endif
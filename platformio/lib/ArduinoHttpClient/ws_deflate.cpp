@@ -0,0 +1,583 @@
+// Small raw-DEFLATE codec for WebSocket permessage-deflate (RFC 7692)
+// (c) Copyright Arduino. 2016
+// Released under Apache License, version 2.0
+//
+// The compressor emits a single fixed-Huffman block with a
+// WS_DEFLATE_WINDOW_SIZE LZ77 window, followed by the empty stored
+// block a permessage-deflate flush requires (with its 00 00 FF FF tail
+// already stripped).  The decompressor is a complete raw inflater
+// (stored, fixed and dynamic blocks), so it accepts whatever window
+// size and block layout the server's deflater chose.
+
+#include "ws_deflate.h"
+
+#include <string.h>
+
+// ---------------------------------------------------------------------
+// Shared DEFLATE tables (RFC 1951, section 3.2.5)
+// ---------------------------------------------------------------------
+
+static const unsigned short kLengthBase[29] =
+{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const unsigned char kLengthExtra[29] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const unsigned short kDistBase[30] =
+{
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193,
+    12289, 16385, 24577
+};
+
+static const unsigned char kDistExtra[30] =
+{
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// ---------------------------------------------------------------------
+// Compressor
+// ---------------------------------------------------------------------
+
+struct BitWriter
+{
+    uint8_t* out;
+    size_t outCap;
+    size_t outLen;
+    uint32_t bitBuffer;
+    int bitCount;
+    bool overflow;
+};
+
+static void writeBits(BitWriter* w, uint32_t aValue, int aCount)
+{
+    w->bitBuffer |= aValue << w->bitCount;
+    w->bitCount += aCount;
+    while (w->bitCount >= 8)
+    {
+        if (w->outLen >= w->outCap)
+        {
+            w->overflow = true;
+            return;
+        }
+        w->out[w->outLen++] = (uint8_t)(w->bitBuffer & 0xFF);
+        w->bitBuffer >>= 8;
+        w->bitCount -= 8;
+    }
+}
+
+// Huffman codes are packed most-significant-bit first, so the canonical
+// code has to be bit-reversed before going into the LSB-first stream
+static uint32_t reverseBits(uint32_t aCode, int aCount)
+{
+    uint32_t reversed = 0;
+    for (int i = 0; i < aCount; i++)
+    {
+        reversed = (reversed << 1) | (aCode & 1);
+        aCode >>= 1;
+    }
+    return reversed;
+}
+
+// Fixed Huffman code for a literal/length symbol
+static void writeLitLenSymbol(BitWriter* w, int aSymbol)
+{
+    if (aSymbol < 144)
+    {
+        writeBits(w, reverseBits(0x30 + aSymbol, 8), 8);
+    }
+    else if (aSymbol < 256)
+    {
+        writeBits(w, reverseBits(0x190 + (aSymbol - 144), 9), 9);
+    }
+    else if (aSymbol < 280)
+    {
+        writeBits(w, reverseBits(aSymbol - 256, 7), 7);
+    }
+    else
+    {
+        writeBits(w, reverseBits(0xC0 + (aSymbol - 280), 8), 8);
+    }
+}
+
+static void writeMatch(BitWriter* w, int aLength, int aDistance)
+{
+    // Length symbol 257..285
+    int lengthCode = 28;
+    while (lengthCode > 0 &&
+           (aLength < kLengthBase[lengthCode] ||
+            (lengthCode < 28 && aLength >= kLengthBase[lengthCode + 1])))
+    {
+        lengthCode--;
+    }
+    while (lengthCode < 28 && aLength >= kLengthBase[lengthCode + 1])
+    {
+        lengthCode++;
+    }
+    // Symbol 284 tops out at 257, 258 has its own symbol
+    if (aLength == 258)
+    {
+        lengthCode = 28;
+    }
+    writeLitLenSymbol(w, 257 + lengthCode);
+    writeBits(w, aLength - kLengthBase[lengthCode], kLengthExtra[lengthCode]);
+
+    // Distance symbol, fixed 5-bit codes
+    int distCode = 29;
+    while (distCode > 0 && aDistance < kDistBase[distCode])
+    {
+        distCode--;
+    }
+    writeBits(w, reverseBits(distCode, 5), 5);
+    writeBits(w, aDistance - kDistBase[distCode], kDistExtra[distCode]);
+}
+
+#define WS_DEFLATE_HASH_BITS 12
+#define WS_DEFLATE_HASH_SIZE (1 << WS_DEFLATE_HASH_BITS)
+#define WS_DEFLATE_MIN_MATCH 3
+#define WS_DEFLATE_MAX_MATCH 258
+
+static unsigned int hash3(const uint8_t* aData)
+{
+    return ((unsigned int)aData[0] << 6) ^
+           ((unsigned int)aData[1] << 3) ^
+           (unsigned int)aData[2];
+}
+
+int ws_deflate_compress(const uint8_t* aInput, size_t aInputLen,
+                        uint8_t* aOutput, size_t aOutputLen)
+{
+    BitWriter writer;
+    writer.out = aOutput;
+    writer.outCap = aOutputLen;
+    writer.outLen = 0;
+    writer.bitBuffer = 0;
+    writer.bitCount = 0;
+    writer.overflow = false;
+
+    // Most recent position of each 3-byte hash, -1 when unseen
+    int head[WS_DEFLATE_HASH_SIZE];
+    memset(head, 0xFF, sizeof(head));
+
+    // One fixed-Huffman block carries the whole message (BFINAL=0, the
+    // permessage-deflate flush block below terminates the stream)
+    writeBits(&writer, 0, 1);
+    writeBits(&writer, 1, 2);
+
+    size_t pos = 0;
+    while (pos < aInputLen && !writer.overflow)
+    {
+        int matchLength = 0;
+        int matchDistance = 0;
+        if (pos + WS_DEFLATE_MIN_MATCH <= aInputLen)
+        {
+            unsigned int h = hash3(aInput + pos) & (WS_DEFLATE_HASH_SIZE - 1);
+            int candidate = head[h];
+            head[h] = (int)pos;
+            if (candidate >= 0 && (pos - candidate) <= WS_DEFLATE_WINDOW_SIZE)
+            {
+                size_t limit = aInputLen - pos;
+                if (limit > WS_DEFLATE_MAX_MATCH)
+                {
+                    limit = WS_DEFLATE_MAX_MATCH;
+                }
+                size_t length = 0;
+                while (length < limit &&
+                       aInput[candidate + length] == aInput[pos + length])
+                {
+                    length++;
+                }
+                if (length >= WS_DEFLATE_MIN_MATCH)
+                {
+                    matchLength = (int)length;
+                    matchDistance = (int)(pos - candidate);
+                }
+            }
+        }
+
+        if (matchLength > 0)
+        {
+            writeMatch(&writer, matchLength, matchDistance);
+            // Keep the hash table fresh across the matched run
+            size_t end = pos + matchLength;
+            for (pos++; pos < end; pos++)
+            {
+                if (pos + WS_DEFLATE_MIN_MATCH <= aInputLen)
+                {
+                    head[hash3(aInput + pos) & (WS_DEFLATE_HASH_SIZE - 1)] = (int)pos;
+                }
+            }
+        }
+        else
+        {
+            writeLitLenSymbol(&writer, aInput[pos]);
+            pos++;
+        }
+    }
+
+    // End of block, then the empty stored block flush: BFINAL=0,
+    // BTYPE=00, pad to a byte boundary.  The LEN/NLEN bytes
+    // (00 00 FF FF) are the four octets RFC 7692 strips, so they are
+    // simply never written
+    writeLitLenSymbol(&writer, 256);
+    writeBits(&writer, 0, 1);
+    writeBits(&writer, 0, 2);
+    if (writer.bitCount > 0)
+    {
+        writeBits(&writer, 0, 8 - writer.bitCount);
+    }
+
+    if (writer.overflow)
+    {
+        return -1;
+    }
+    return (int)writer.outLen;
+}
+
+// ---------------------------------------------------------------------
+// Decompressor
+// ---------------------------------------------------------------------
+
+struct BitReader
+{
+    const uint8_t* in;
+    size_t inLen;
+    size_t inPos;
+    uint32_t bitBuffer;
+    int bitCount;
+};
+
+// Returns the requested bits, or -1 when the input is exhausted
+static long readBits(BitReader* r, int aCount)
+{
+    while (r->bitCount < aCount)
+    {
+        if (r->inPos >= r->inLen)
+        {
+            return -1;
+        }
+        r->bitBuffer |= (uint32_t)r->in[r->inPos++] << r->bitCount;
+        r->bitCount += 8;
+    }
+    long value = r->bitBuffer & ((1u << aCount) - 1);
+    r->bitBuffer >>= aCount;
+    r->bitCount -= aCount;
+    return value;
+}
+
+// Canonical Huffman decoding tables built from code lengths: how many
+// codes exist of each length, and the symbols sorted by code
+struct HuffmanTable
+{
+    unsigned short count[16];
+    unsigned short symbol[288];
+};
+
+static int buildHuffmanTable(HuffmanTable* aTable, const unsigned char* aLengths, int aCount)
+{
+    memset(aTable->count, 0, sizeof(aTable->count));
+    for (int i = 0; i < aCount; i++)
+    {
+        aTable->count[aLengths[i]]++;
+    }
+    if (aTable->count[0] == aCount)
+    {
+        return -1;
+    }
+
+    unsigned short offsets[16];
+    offsets[1] = 0;
+    for (int length = 1; length < 15; length++)
+    {
+        offsets[length + 1] = offsets[length] + aTable->count[length];
+    }
+    for (int i = 0; i < aCount; i++)
+    {
+        if (aLengths[i] != 0)
+        {
+            aTable->symbol[offsets[aLengths[i]]++] = i;
+        }
+    }
+    return 0;
+}
+
+// Decode one symbol bit-by-bit against the canonical code ranges
+static int decodeSymbol(BitReader* r, const HuffmanTable* aTable)
+{
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length <= 15; length++)
+    {
+        long bit = readBits(r, 1);
+        if (bit < 0)
+        {
+            return -1;
+        }
+        code |= (int)bit;
+        int count = aTable->count[length];
+        if (code - first < count)
+        {
+            return aTable->symbol[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static int inflateBlock(BitReader* r, const HuffmanTable* aLitLen, const HuffmanTable* aDist,
+                        uint8_t* aOutput, size_t aOutputLen, size_t* aOutPos)
+{
+    for (;;)
+    {
+        int symbol = decodeSymbol(r, aLitLen);
+        if (symbol < 0)
+        {
+            return -1;
+        }
+        if (symbol == 256)
+        {
+            return 0;
+        }
+        if (symbol < 256)
+        {
+            if (*aOutPos >= aOutputLen)
+            {
+                return -1;
+            }
+            aOutput[(*aOutPos)++] = (uint8_t)symbol;
+            continue;
+        }
+
+        // Length/distance pair
+        symbol -= 257;
+        if (symbol >= 29)
+        {
+            return -1;
+        }
+        long extra = readBits(r, kLengthExtra[symbol]);
+        if (extra < 0)
+        {
+            return -1;
+        }
+        size_t length = kLengthBase[symbol] + (size_t)extra;
+
+        int distSymbol = decodeSymbol(r, aDist);
+        if (distSymbol < 0 || distSymbol >= 30)
+        {
+            return -1;
+        }
+        extra = readBits(r, kDistExtra[distSymbol]);
+        if (extra < 0)
+        {
+            return -1;
+        }
+        size_t distance = kDistBase[distSymbol] + (size_t)extra;
+
+        if (distance > *aOutPos || *aOutPos + length > aOutputLen)
+        {
+            return -1;
+        }
+        for (size_t i = 0; i < length; i++)
+        {
+            aOutput[*aOutPos] = aOutput[*aOutPos - distance];
+            (*aOutPos)++;
+        }
+    }
+}
+
+int ws_inflate(const uint8_t* aInput, size_t aInputLen,
+               uint8_t* aOutput, size_t aOutputLen)
+{
+    BitReader reader;
+    reader.in = aInput;
+    reader.inLen = aInputLen;
+    reader.inPos = 0;
+    reader.bitBuffer = 0;
+    reader.bitCount = 0;
+
+    size_t outPos = 0;
+
+    for (;;)
+    {
+        long final = readBits(&reader, 1);
+        if (final < 0)
+        {
+            // Clean end of input at a block boundary, which is how a
+            // permessage-deflate payload (flush tail re-appended)
+            // terminates without BFINAL ever being set
+            break;
+        }
+        long type = readBits(&reader, 2);
+        if (type < 0)
+        {
+            return -1;
+        }
+
+        if (type == 0)
+        {
+            // Stored block: skip to byte alignment, LEN/NLEN, raw copy
+            reader.bitBuffer = 0;
+            reader.bitCount = 0;
+            if (reader.inPos + 4 > reader.inLen)
+            {
+                return -1;
+            }
+            unsigned int len = reader.in[reader.inPos] |
+                               ((unsigned int)reader.in[reader.inPos + 1] << 8);
+            unsigned int nlen = reader.in[reader.inPos + 2] |
+                                ((unsigned int)reader.in[reader.inPos + 3] << 8);
+            reader.inPos += 4;
+            if ((len ^ 0xFFFF) != nlen || reader.inPos + len > reader.inLen ||
+                outPos + len > aOutputLen)
+            {
+                return -1;
+            }
+            memcpy(aOutput + outPos, reader.in + reader.inPos, len);
+            reader.inPos += len;
+            outPos += len;
+        }
+        else if (type == 1 || type == 2)
+        {
+            HuffmanTable litLenTable;
+            HuffmanTable distTable;
+
+            if (type == 1)
+            {
+                // Fixed Huffman code lengths (RFC 1951, 3.2.6)
+                unsigned char lengths[288];
+                int i = 0;
+                for (; i < 144; i++) lengths[i] = 8;
+                for (; i < 256; i++) lengths[i] = 9;
+                for (; i < 280; i++) lengths[i] = 7;
+                for (; i < 288; i++) lengths[i] = 8;
+                buildHuffmanTable(&litLenTable, lengths, 288);
+                for (i = 0; i < 30; i++) lengths[i] = 5;
+                buildHuffmanTable(&distTable, lengths, 30);
+            }
+            else
+            {
+                // Dynamic Huffman: the code lengths themselves arrive
+                // run-length encoded with their own Huffman code
+                static const unsigned char kCodeLengthOrder[19] =
+                {
+                    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+                };
+                long hlit = readBits(&reader, 5);
+                long hdist = readBits(&reader, 5);
+                long hclen = readBits(&reader, 4);
+                if (hlit < 0 || hdist < 0 || hclen < 0)
+                {
+                    return -1;
+                }
+                int litCount = (int)hlit + 257;
+                int distCount = (int)hdist + 1;
+                int codeCount = (int)hclen + 4;
+                if (litCount > 286 || distCount > 30)
+                {
+                    return -1;
+                }
+
+                unsigned char codeLengths[19];
+                memset(codeLengths, 0, sizeof(codeLengths));
+                for (int i = 0; i < codeCount; i++)
+                {
+                    long bits = readBits(&reader, 3);
+                    if (bits < 0)
+                    {
+                        return -1;
+                    }
+                    codeLengths[kCodeLengthOrder[i]] = (unsigned char)bits;
+                }
+                HuffmanTable codeLengthTable;
+                if (buildHuffmanTable(&codeLengthTable, codeLengths, 19) != 0)
+                {
+                    return -1;
+                }
+
+                unsigned char lengths[288 + 30];
+                int index = 0;
+                while (index < litCount + distCount)
+                {
+                    int symbol = decodeSymbol(&reader, &codeLengthTable);
+                    if (symbol < 0)
+                    {
+                        return -1;
+                    }
+                    if (symbol < 16)
+                    {
+                        lengths[index++] = (unsigned char)symbol;
+                    }
+                    else
+                    {
+                        int repeat;
+                        unsigned char value = 0;
+                        if (symbol == 16)
+                        {
+                            if (index == 0)
+                            {
+                                return -1;
+                            }
+                            value = lengths[index - 1];
+                            long bits = readBits(&reader, 2);
+                            if (bits < 0) return -1;
+                            repeat = 3 + (int)bits;
+                        }
+                        else if (symbol == 17)
+                        {
+                            long bits = readBits(&reader, 3);
+                            if (bits < 0) return -1;
+                            repeat = 3 + (int)bits;
+                        }
+                        else
+                        {
+                            long bits = readBits(&reader, 7);
+                            if (bits < 0) return -1;
+                            repeat = 11 + (int)bits;
+                        }
+                        if (index + repeat > litCount + distCount)
+                        {
+                            return -1;
+                        }
+                        while (repeat-- > 0)
+                        {
+                            lengths[index++] = value;
+                        }
+                    }
+                }
+
+                if (buildHuffmanTable(&litLenTable, lengths, litCount) != 0 ||
+                    buildHuffmanTable(&distTable, lengths + litCount, distCount) != 0)
+                {
+                    return -1;
+                }
+            }
+
+            if (inflateBlock(&reader, &litLenTable, &distTable,
+                             aOutput, aOutputLen, &outPos) != 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            return -1;
+        }
+
+        if (final)
+        {
+            break;
+        }
+    }
+
+    return (int)outPos;
+}
@@ -0,0 +1,42 @@
+// Small raw-DEFLATE codec for WebSocket permessage-deflate (RFC 7692)
+// (c) Copyright Arduino. 2016
+// Released under Apache License, version 2.0
+
+#ifndef ws_deflate_h
+#define ws_deflate_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// LZ77 window used by the compressor.  4KB keeps the hash table and the
+// negotiated client_max_window_bits small enough for ESP32-class RAM
+#define WS_DEFLATE_WINDOW_BITS 12
+#define WS_DEFLATE_WINDOW_BITS_STR "12"
+#define WS_DEFLATE_WINDOW_SIZE (1 << WS_DEFLATE_WINDOW_BITS)
+
+/** Compress aInput into a raw DEFLATE stream using fixed Huffman codes
+  and a WS_DEFLATE_WINDOW_SIZE history window.  The output ends with an
+  empty stored block flush with its trailing 00 00 FF FF already removed,
+  exactly as a permessage-deflate message payload requires.
+  @param aInput     Bytes to compress
+  @param aInputLen  Number of input bytes
+  @param aOutput    Buffer receiving the compressed stream
+  @param aOutputLen Capacity of aOutput
+  @return Compressed length, or -1 if the output buffer is too small
+*/
+int ws_deflate_compress(const uint8_t* aInput, size_t aInputLen,
+                        uint8_t* aOutput, size_t aOutputLen);
+
+/** Decompress a raw DEFLATE stream (stored, fixed and dynamic Huffman
+  blocks).  For a permessage-deflate payload the caller appends the four
+  bytes 00 00 FF FF to the received data before calling this.
+  @param aInput     Compressed bytes
+  @param aInputLen  Number of compressed bytes
+  @param aOutput    Buffer receiving the decompressed data
+  @param aOutputLen Capacity of aOutput
+  @return Decompressed length, or -1 on malformed input or overflow
+*/
+int ws_inflate(const uint8_t* aInput, size_t aInputLen,
+               uint8_t* aOutput, size_t aOutputLen);
+
+#endif
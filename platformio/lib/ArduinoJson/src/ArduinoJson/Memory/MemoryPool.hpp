@@ -10,7 +10,7 @@
 #include <ArduinoJson/Strings/StringAdapters.hpp>
 #include <ArduinoJson/Variant/VariantSlot.hpp>
 
-#include <string.h>  // memmove
+#include <string.h>  // memchr, memmove
 
 #define JSON_STRING_SIZE(SIZE) (SIZE + 1)
 
@@ -178,13 +178,19 @@ class MemoryPool {
   template <typename TAdaptedString>
   const char* findString(const TAdaptedString& str) const {
     size_t n = str.size();
-    for (char* next = begin_; next + n < left_; ++next) {
-      if (next[n] == '\0' && stringEquals(str, adaptString(next, n)))
+    char* next = begin_;
+    while (next + n < left_) {
+      // memchr finds the terminator of the stored string, which gives
+      // its length for free: mismatched lengths are skipped without
+      // comparing characters, and libc scans words at a time
+      char* terminator =
+          static_cast<char*>(memchr(next, '\0', size_t(left_ - next)));
+      if (!terminator)
+        break;
+      if (size_t(terminator - next) == n &&
+          stringEquals(str, adaptString(next, n)))
         return next;
-
-      // jump to next terminator
-      while (*next)
-        ++next;
+      next = terminator + 1;
     }
     return 0;
   }
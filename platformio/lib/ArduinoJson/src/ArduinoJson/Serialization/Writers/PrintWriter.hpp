@@ -5,13 +5,17 @@
 #pragma once
 
 #include <Arduino.h>
+#include <Client.h>
 
 ARDUINOJSON_BEGIN_PRIVATE_NAMESPACE
 
+// Network clients are excluded: they derive from Print too, but get the
+// buffered writer from ClientWriter.hpp instead
 template <typename TDestination>
 class Writer<
     TDestination,
-    typename enable_if<is_base_of<::Print, TDestination>::value>::type> {
+    typename enable_if<is_base_of<::Print, TDestination>::value &&
+                       !is_base_of<::Client, TDestination>::value>::type> {
  public:
   explicit Writer(::Print& print) : print_(&print) {}
 
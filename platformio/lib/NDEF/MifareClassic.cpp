@@ -9,12 +9,56 @@
 MifareClassic::MifareClassic(PN532& nfcShield)
 {
   _nfcShield = &nfcShield;
+  invalidateAuth();
 }
 
 MifareClassic::~MifareClassic()
 {
 }
 
+// Mifare 1K/4K layout: 4-block sectors up to block 128, 16-block after
+int MifareClassic::sectorOfBlock(int block)
+{
+    return (block < 128) ? (block / 4) : (32 + (block - 128) / 16);
+}
+
+void MifareClassic::invalidateAuth()
+{
+    _authSector = -1;
+    _authUidLength = 0;
+}
+
+// Authenticate the sector containing block, skipping the PN532
+// command/response round trip when the card is already authenticated
+// for that sector with the same key and tag. A failed auth drops the
+// cache so the next attempt goes to the card again.
+boolean MifareClassic::authenticateSector(byte *uid, unsigned int uidLength, int block, uint8_t keyNumber, uint8_t *key)
+{
+    int sector = sectorOfBlock(block);
+    if (sector == _authSector && keyNumber == _authKeyNumber &&
+        uidLength == _authUidLength && uidLength <= sizeof(_authUid) &&
+        memcmp(uid, _authUid, uidLength) == 0 &&
+        memcmp(key, _authKey, sizeof(_authKey)) == 0)
+    {
+        return true;
+    }
+
+    int success = _nfcShield->mifareclassic_AuthenticateBlock(uid, uidLength, block, keyNumber, key);
+    if (success && uidLength <= sizeof(_authUid))
+    {
+        _authSector = sector;
+        _authUidLength = uidLength;
+        memcpy(_authUid, uid, uidLength);
+        _authKeyNumber = keyNumber;
+        memcpy(_authKey, key, sizeof(_authKey));
+    }
+    else
+    {
+        invalidateAuth();
+    }
+    return success;
+}
+
 NfcTag MifareClassic::read(byte *uid, unsigned int uidLength)
 {
     uint8_t key[6] = { 0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7 };
@@ -23,8 +67,11 @@ NfcTag MifareClassic::read(byte *uid, unsigned int uidLength)
     int messageLength = 0;
     byte data[BLOCK_SIZE];
 
+    // tag polling reset the card's crypto state, start a fresh session
+    invalidateAuth();
+
     // read first block to get message length
-    int success = _nfcShield->mifareclassic_AuthenticateBlock(uid, uidLength, currentBlock, 0, key);
+    int success = authenticateSector(uid, uidLength, currentBlock, 0, key);
     if (success)
     {
         success = _nfcShield->mifareclassic_ReadDataBlock(currentBlock, data);
@@ -60,10 +107,11 @@ NfcTag MifareClassic::read(byte *uid, unsigned int uidLength)
     while (index < bufferSize)
     {
 
-        // authenticate on every sector
+        // authenticate on every sector; the cache makes re-entering the
+        // sector the TLV probe already authenticated a no-op
         if (_nfcShield->mifareclassic_IsFirstBlock(currentBlock))
         {
-            success = _nfcShield->mifareclassic_AuthenticateBlock(uid, uidLength, currentBlock, 0, key);
+            success = authenticateSector(uid, uidLength, currentBlock, 0, key);
             if (!success)
             {
                 Serial.print(F("Error. Block Authentication failed for "));Serial.println(currentBlock);
@@ -83,7 +131,9 @@ NfcTag MifareClassic::read(byte *uid, unsigned int uidLength)
         else
         {
             Serial.print(F("Read failed "));Serial.println(currentBlock);
-            // TODO handle errors here
+            // The card may have dropped the session; make the next
+            // sector entry re-authenticate for real
+            invalidateAuth();
         }
 
         index += BLOCK_SIZE;
@@ -195,6 +245,11 @@ boolean MifareClassic::formatNDEF(byte * uid, unsigned int uidLength)
     uint8_t sectorbuffer0[16] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
     uint8_t sectorbuffer4[16] = {0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7, 0x7F, 0x07, 0x88, 0x40, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
+    // Formatting rewrites sector trailers (and with them the keys), so
+    // none of the cached state survives this; keep the direct auth path
+    // and just make sure nothing stale is carried in or out.
+    invalidateAuth();
+
     boolean success = _nfcShield->mifareclassic_AuthenticateBlock (uid, uidLength, 0, 0, keya);
     if (!success)
     {
@@ -270,6 +325,9 @@ boolean MifareClassic::formatMifare(byte * uid, unsigned int uidLength)
     uint8_t numOfSector = 16;                         // Assume Mifare Classic 1K for now (16 4-block sectors)
     boolean success = false;
 
+    // Trailer writes below change the sector keys; see formatNDEF
+    invalidateAuth();
+
     for (idx = 0; idx < numOfSector; idx++)
     {
         // Step 1: Authenticate the current sector using key B 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF
@@ -361,12 +419,15 @@ boolean MifareClassic::write(NdefMessage& m, byte * uid, unsigned int uidLength)
     int currentBlock = 4;
     uint8_t key[6] = { 0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7 }; // this is Sector 1 - 15 key
 
+    // tag polling reset the card's crypto state, start a fresh session
+    invalidateAuth();
+
     while (index < sizeof(buffer))
     {
 
         if (_nfcShield->mifareclassic_IsFirstBlock(currentBlock))
         {
-            int success = _nfcShield->mifareclassic_AuthenticateBlock(uid, uidLength, currentBlock, 0, key);
+            int success = authenticateSector(uid, uidLength, currentBlock, 0, key);
             if (!success)
             {
                 Serial.print(F("Error. Block Authentication failed for "));Serial.println(currentBlock);
@@ -385,6 +446,7 @@ boolean MifareClassic::write(NdefMessage& m, byte * uid, unsigned int uidLength)
         else
         {
             Serial.print(F("Write failed "));Serial.println(currentBlock);
+            invalidateAuth();
             return false;
         }
         index += BLOCK_SIZE;
@@ -17,6 +17,19 @@ class MifareClassic
         boolean formatMifare(byte * uid, unsigned int uidLength);
     private:
         PN532* _nfcShield;
+        // Sector-granular auth cache: the card stays authenticated for a
+        // whole sector after one AuthenticateBlock, so repeat auths inside
+        // the same transaction are pure command/response overhead. Tag
+        // polling (readPassiveTargetID) resets the card's crypto state,
+        // so each public entry point starts a fresh session.
+        int _authSector;
+        byte _authUid[10];
+        unsigned int _authUidLength;
+        uint8_t _authKeyNumber;
+        uint8_t _authKey[6];
+        boolean authenticateSector(byte *uid, unsigned int uidLength, int block, uint8_t keyNumber, uint8_t *key);
+        void invalidateAuth();
+        static int sectorOfBlock(int block);
         int getBufferSize(int messageLength);
         int getNdefStartIndex(byte *data);
         bool decodeTlv(byte *data, int &messageLength, int &messageStartIndex);
@@ -7,6 +7,9 @@
 #define ULTRALIGHT_MESSAGE_LENGTH_INDEX 1
 #define ULTRALIGHT_DATA_START_INDEX 2
 #define ULTRALIGHT_MAX_PAGE 63
+// pages per FAST_READ transaction, limited by the PN532 packet buffer
+// (64 bytes, minus the status byte)
+#define ULTRALIGHT_FAST_READ_PAGES 15
 
 #define NFC_FORUM_TAG_TYPE_2 ("NFC Forum Type 2")
 
@@ -43,31 +46,69 @@ NfcTag MifareUltralight::read(byte * uid, unsigned int uidLength)
     uint8_t page;
     uint8_t index = 0;
     byte buffer[bufferSize];
-    for (page = ULTRALIGHT_DATA_START_PAGE; page < ULTRALIGHT_MAX_PAGE; page++)
+
+    // last page the buffer needs, bufferSize is always a page multiple
+    uint8_t endPage = ULTRALIGHT_DATA_START_PAGE + (bufferSize / ULTRALIGHT_PAGE_SIZE) - 1;
+    if (endPage >= ULTRALIGHT_MAX_PAGE)
+    {
+        endPage = ULTRALIGHT_MAX_PAGE - 1;
+    }
+
+    // FAST_READ pulls the whole NDEF area in one or two transactions
+    // instead of one INDATAEXCHANGE round trip per 4-byte page
+    success = true;
+    page = ULTRALIGHT_DATA_START_PAGE;
+    while (success && page <= endPage)
     {
-        // read the data
-        success = nfc->mifareultralight_ReadPage(page, &buffer[index]);
+        uint8_t chunkEnd = page + ULTRALIGHT_FAST_READ_PAGES - 1;
+        if (chunkEnd > endPage)
+        {
+            chunkEnd = endPage;
+        }
+
+        success = nfc->mifareultralight_FastRead(page, chunkEnd, &buffer[index]);
         if (success)
         {
             #ifdef MIFARE_ULTRALIGHT_DEBUG
-            Serial.print(F("Page "));Serial.print(page);Serial.print(" ");
-            nfc->PrintHexChar(&buffer[index], ULTRALIGHT_PAGE_SIZE);
+            Serial.print(F("Pages "));Serial.print(page);Serial.print("-");Serial.print(chunkEnd);Serial.print(" ");
+            nfc->PrintHexChar(&buffer[index], (chunkEnd - page + 1) * ULTRALIGHT_PAGE_SIZE);
             #endif
+            index += (chunkEnd - page + 1) * ULTRALIGHT_PAGE_SIZE;
+            page = chunkEnd + 1;
         }
-        else
-        {
-            Serial.print(F("Read failed "));Serial.println(page);
-            // TODO error handling
-            messageLength = 0;
-            break;
-        }
+    }
 
-        if (index >= (messageLength + ndefStartIndex))
+    if (!success)
+    {
+        // the original Ultralight doesn't support FAST_READ, fall back
+        // to reading one page at a time
+        index = 0;
+        for (page = ULTRALIGHT_DATA_START_PAGE; page < ULTRALIGHT_MAX_PAGE; page++)
         {
-            break;
+            // read the data
+            success = nfc->mifareultralight_ReadPage(page, &buffer[index]);
+            if (success)
+            {
+                #ifdef MIFARE_ULTRALIGHT_DEBUG
+                Serial.print(F("Page "));Serial.print(page);Serial.print(" ");
+                nfc->PrintHexChar(&buffer[index], ULTRALIGHT_PAGE_SIZE);
+                #endif
+            }
+            else
+            {
+                Serial.print(F("Read failed "));Serial.println(page);
+                // TODO error handling
+                messageLength = 0;
+                break;
+            }
+
+            if (index >= (messageLength + ndefStartIndex))
+            {
+                break;
+            }
+
+            index += ULTRALIGHT_PAGE_SIZE;
         }
-
-        index += ULTRALIGHT_PAGE_SIZE;
     }
 
     NdefMessage ndefMessage = NdefMessage(&buffer[ndefStartIndex], messageLength);
@@ -115,16 +156,21 @@ void MifareUltralight::findNdefMessage()
     byte data[12]; // 3 pages
     byte* data_ptr = &data[0];
 
-    // the nxp read command reads 4 pages, unfortunately adafruit give me one page at a time
-    boolean success = true;
-    for (page = 4; page < 6; page++)
+    // FAST_READ gets both pages in one transaction, with the per-page
+    // read loop as fallback for tags that only support READ
+    boolean success = nfc->mifareultralight_FastRead(4, 5, data_ptr);
+    if (!success)
     {
-        success = success && nfc->mifareultralight_ReadPage(page, data_ptr);
-        #ifdef MIFARE_ULTRALIGHT_DEBUG
-        Serial.print(F("Page "));Serial.print(page);Serial.print(F(" - "));
-        nfc->PrintHexChar(data_ptr, 4);
-        #endif
-        data_ptr += ULTRALIGHT_PAGE_SIZE;
+        success = true;
+        for (page = 4; page < 6; page++)
+        {
+            success = success && nfc->mifareultralight_ReadPage(page, data_ptr);
+            #ifdef MIFARE_ULTRALIGHT_DEBUG
+            Serial.print(F("Page "));Serial.print(page);Serial.print(F(" - "));
+            nfc->PrintHexChar(data_ptr, 4);
+            #endif
+            data_ptr += ULTRALIGHT_PAGE_SIZE;
+        }
     }
 
     if (success)
@@ -162,6 +208,46 @@ void MifareUltralight::calculateBufferSize()
     }
 }
 
+// read size bytes starting at startPage into buffer, FAST_READ first with the
+// per-page loop as fallback for tags that only support READ. size must be a
+// page multiple
+boolean MifareUltralight::readPages(uint8_t startPage, byte * buffer, unsigned int size)
+{
+    boolean success = true;
+    uint8_t page = startPage;
+    uint8_t endPage = startPage + (size / ULTRALIGHT_PAGE_SIZE) - 1;
+    unsigned int index = 0;
+
+    while (success && page <= endPage)
+    {
+        uint8_t chunkEnd = page + ULTRALIGHT_FAST_READ_PAGES - 1;
+        if (chunkEnd > endPage)
+        {
+            chunkEnd = endPage;
+        }
+
+        success = nfc->mifareultralight_FastRead(page, chunkEnd, &buffer[index]);
+        if (success)
+        {
+            index += (chunkEnd - page + 1) * ULTRALIGHT_PAGE_SIZE;
+            page = chunkEnd + 1;
+        }
+    }
+
+    if (!success)
+    {
+        success = true;
+        index = 0;
+        for (page = startPage; success && page <= endPage; page++)
+        {
+            success = nfc->mifareultralight_ReadPage(page, &buffer[index]);
+            index += ULTRALIGHT_PAGE_SIZE;
+        }
+    }
+
+    return success;
+}
+
 boolean MifareUltralight::write(NdefMessage& m, byte * uid, unsigned int uidLength)
 {
     if (isUnformatted())
@@ -212,7 +298,31 @@ boolean MifareUltralight::write(NdefMessage& m, byte * uid, unsigned int uidLeng
     nfc->PrintHex(encoded,bufferSize);
     #endif
 
+    // read back the current image first, each page write is a full PN532
+    // transaction plus a tag EEPROM cycle, while FAST_READ pulls the whole
+    // area in one or two transactions. pages that already hold the right
+    // bytes are then skipped, so rewriting a mostly unchanged message only
+    // touches the pages that actually differ
+    uint8_t current[bufferSize];
+    boolean haveCurrent = readPages(ULTRALIGHT_DATA_START_PAGE, current, bufferSize);
+    #ifdef MIFARE_ULTRALIGHT_DEBUG
+    if (!haveCurrent)
+    {
+        Serial.println(F("Read back failed, writing all pages"));
+    }
+    #endif
+
     while (position < bufferSize){ //bufferSize is always times pagesize so no "last chunk" check
+        if (haveCurrent && memcmp(src, &current[position], ULTRALIGHT_PAGE_SIZE) == 0)
+        {
+            #ifdef MIFARE_ULTRALIGHT_DEBUG
+            Serial.print(F("Skipped page "));Serial.println(page);
+            #endif
+            page++;
+            src+=ULTRALIGHT_PAGE_SIZE;
+            position+=ULTRALIGHT_PAGE_SIZE;
+            continue;
+        }
         // write page
         if (!nfc->mifareultralight_WritePage(page, src))
             return false;
@@ -238,7 +348,15 @@ boolean MifareUltralight::clean()
     // factory tags have 0xFF, but OTP-CC blocks have already been set so we use 0x00
     uint8_t data[4] = { 0x00, 0x00, 0x00, 0x00 };
 
+    // read back the current image so pages that are already zero are skipped
+    unsigned int imageSize = tagCapacity;
+    uint8_t current[imageSize];
+    boolean haveCurrent = readPages(ULTRALIGHT_DATA_START_PAGE, current, imageSize);
+
     for (int i = ULTRALIGHT_DATA_START_PAGE; i < pages; i++) {
+        if (haveCurrent && memcmp(&current[(i - ULTRALIGHT_DATA_START_PAGE) * ULTRALIGHT_PAGE_SIZE], data, ULTRALIGHT_PAGE_SIZE) == 0) {
+            continue;
+        }
         #ifdef MIFARE_ULTRALIGHT_DEBUG
         Serial.print(F("Wrote page "));Serial.print(i);Serial.print(F(" - "));
         nfc->PrintHex(data, ULTRALIGHT_PAGE_SIZE);
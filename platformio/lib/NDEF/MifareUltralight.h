@@ -23,6 +23,7 @@ class MifareUltralight
         void readCapabilityContainer();
         void findNdefMessage();
         void calculateBufferSize();
+        boolean readPages(uint8_t startPage, byte *buffer, unsigned int size);
 };
 
 #endif
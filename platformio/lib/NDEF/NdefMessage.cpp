@@ -1,4 +1,5 @@
 #include <NdefMessage.h>
+#include <utility>
 
 NdefMessage::NdefMessage(void)
 {
@@ -6,6 +7,16 @@ NdefMessage::NdefMessage(void)
 }
 
 NdefMessage::NdefMessage(const byte * data, const int numBytes)
+{
+    decode(data, numBytes, false);
+}
+
+NdefMessage::NdefMessage(const byte * data, const int numBytes, boolean zeroCopy)
+{
+    decode(data, numBytes, zeroCopy);
+}
+
+void NdefMessage::decode(const byte * data, const int numBytes, boolean zeroCopy)
 {
     #ifdef NDEF_DEBUG
     Serial.print(F("Decoding "));Serial.print(numBytes);Serial.println(F(" bytes"));
@@ -59,19 +70,38 @@ NdefMessage::NdefMessage(const byte * data, const int numBytes)
         }
 
         index++;
-        record.setType(&data[index], typeLength);
-        index += typeLength;
-
-        if (il)
+        if (zeroCopy)
         {
-            record.setId(&data[index], idLength);
-            index += idLength;
+            // keep views into the caller's buffer, no malloc/memcpy per
+            // record while scanning tags
+            record.setTypeView(&data[index], typeLength);
+            index += typeLength;
+
+            if (il)
+            {
+                record.setIdView(&data[index], idLength);
+                index += idLength;
+            }
+
+            record.setPayloadView(&data[index], payloadLength);
+            index += payloadLength;
         }
+        else
+        {
+            record.setType(&data[index], typeLength);
+            index += typeLength;
+
+            if (il)
+            {
+                record.setId(&data[index], idLength);
+                index += idLength;
+            }
 
-        record.setPayload(&data[index], payloadLength);
-        index += payloadLength;
+            record.setPayload(&data[index], payloadLength);
+            index += payloadLength;
+        }
 
-        addRecord(record);
+        addRecord(std::move(record));
 
         if (me) break; // last message
     }
@@ -131,18 +161,19 @@ int NdefMessage::getEncodedSize()
 }
 
 // TODO change this to return uint8_t*
-void NdefMessage::encode(uint8_t* data)
+int NdefMessage::encode(uint8_t* data)
 {
     // assert sizeof(data) >= getEncodedSize()
     uint8_t* data_ptr = &data[0];
 
     for (int i = 0; i < _recordCount; i++)
     {
-        _records[i].encode(data_ptr, i == 0, (i + 1) == _recordCount);
-        // TODO can NdefRecord.encode return the record size?
-        data_ptr += _records[i].getEncodedSize();
+        // record encode reports the bytes it wrote, so the size math
+        // is not redone for every record
+        data_ptr += _records[i].encode(data_ptr, i == 0, (i + 1) == _recordCount);
     }
 
+    return data_ptr - &data[0];
 }
 
 boolean NdefMessage::addRecord(NdefRecord& record)
@@ -161,6 +192,25 @@ boolean NdefMessage::addRecord(NdefRecord& record)
     }
 }
 
+// move overload - the record's buffers are stolen instead of deep
+// copied, so building an outbound message costs no extra allocations
+// per record
+boolean NdefMessage::addRecord(NdefRecord&& record)
+{
+
+    if (_recordCount < MAX_NDEF_RECORDS)
+    {
+        _records[_recordCount] = std::move(record);
+        _recordCount++;
+        return true;
+    }
+    else
+    {
+        Serial.println(F("WARNING: Too many records. Increase MAX_NDEF_RECORDS."));
+        return false;
+    }
+}
+
 void NdefMessage::addMimeMediaRecord(String mimeType, String payload)
 {
 
@@ -181,7 +231,7 @@ void NdefMessage::addMimeMediaRecord(String mimeType, uint8_t* payload, int payl
 
     r.setPayload(payload, payloadLength);
 
-    addRecord(r);
+    addRecord(std::move(r));
 }
 
 void NdefMessage::addTextRecord(String text)
@@ -209,16 +259,16 @@ void NdefMessage::addTextRecord(String text, String encoding)
 
     r.setPayload(payload, payloadString.length());
 
-    addRecord(r);
+    addRecord(std::move(r));
 }
 
 void NdefMessage::addUriRecord(String uri)
 {
-    NdefRecord* r = new NdefRecord();
-    r->setTnf(TNF_WELL_KNOWN);
+    NdefRecord r = NdefRecord();
+    r.setTnf(TNF_WELL_KNOWN);
 
     uint8_t RTD_URI[1] = { 0x55 }; // TODO this should be a constant or preprocessor
-    r->setType(RTD_URI, sizeof(RTD_URI));
+    r.setType(RTD_URI, sizeof(RTD_URI));
 
     // X is a placeholder for identifier code
     String payloadString = "X" + uri;
@@ -229,18 +279,24 @@ void NdefMessage::addUriRecord(String uri)
     // add identifier code 0x0, meaning no prefix substitution
     payload[0] = 0x0;
 
-    r->setPayload(payload, payloadString.length());
+    r.setPayload(payload, payloadString.length());
 
-    addRecord(*r);
-    delete(r);
+    addRecord(std::move(r));
 }
 
 void NdefMessage::addEmptyRecord()
 {
-    NdefRecord* r = new NdefRecord();
-    r->setTnf(TNF_EMPTY);
-    addRecord(*r);
-    delete(r);
+    NdefRecord r = NdefRecord();
+    r.setTnf(TNF_EMPTY);
+    addRecord(std::move(r));
+}
+
+void NdefMessage::materialize()
+{
+    for (int i = 0; i < _recordCount; i++)
+    {
+        _records[i].materialize();
+    }
 }
 
 NdefRecord NdefMessage::getRecord(int index)
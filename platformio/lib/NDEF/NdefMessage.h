@@ -4,21 +4,35 @@
 #include <Ndef.h>
 #include <NdefRecord.h>
 
+// compile-time capacity: the records live in a fixed array inside the
+// message, so appends never reallocate. Override from build flags when
+// a sketch needs more records per message
+#ifndef MAX_NDEF_RECORDS
 #define MAX_NDEF_RECORDS 4
+#endif
 
 class NdefMessage
 {
     public:
         NdefMessage(void);
         NdefMessage(const byte *data, const int numBytes);
+        // zeroCopy true parses without copying: the records keep views
+        // into data, so the message is only valid while data is. Call
+        // materialize() on a record (or on the message) to keep it longer
+        NdefMessage(const byte *data, const int numBytes, boolean zeroCopy);
         NdefMessage(const NdefMessage& rhs);
         ~NdefMessage();
         NdefMessage& operator=(const NdefMessage& rhs);
 
         int getEncodedSize(); // need so we can pass array to encode
-        void encode(byte *data);
+        // writes the whole message into data in one pass and returns the
+        // number of bytes written
+        int encode(byte *data);
 
         boolean addRecord(NdefRecord& record);
+        // move overload - steals the record's buffers instead of deep
+        // copying them, for allocation-light message building
+        boolean addRecord(NdefRecord&& record);
         void addMimeMediaRecord(String mimeType, String payload);
         void addMimeMediaRecord(String mimeType, byte *payload, int payloadLength);
         void addTextRecord(String text);
@@ -30,8 +44,13 @@ class NdefMessage
         NdefRecord getRecord(int index);
         NdefRecord operator[](int index);
 
+        // copy any viewed record data into record-owned buffers, after
+        // which the tag read buffer can be released
+        void materialize();
+
         void print();
     private:
+        void decode(const byte *data, const int numBytes, boolean zeroCopy);
         NdefRecord _records[MAX_NDEF_RECORDS];
         unsigned int _recordCount;
 };
@@ -4,6 +4,7 @@ NdefRecord::NdefRecord()
 {
     //Serial.println("NdefRecord Constructor 1");
     _tnf = 0;
+    _owned = true;
     _typeLength = 0;
     _payloadLength = 0;
     _idLength = 0;
@@ -17,6 +18,7 @@ NdefRecord::NdefRecord(const NdefRecord& rhs)
     //Serial.println("NdefRecord Constructor 2 (copy)");
 
     _tnf = rhs._tnf;
+    _owned = rhs._owned;
     _typeLength = rhs._typeLength;
     _payloadLength = rhs._payloadLength;
     _idLength = rhs._idLength;
@@ -24,6 +26,16 @@ NdefRecord::NdefRecord(const NdefRecord& rhs)
     _payload = (byte *)NULL;
     _id = (byte *)NULL;
 
+    if (!_owned)
+    {
+        // copying a view stays a view - the caller's buffer is still the
+        // single copy of the data
+        _type = rhs._type;
+        _payload = rhs._payload;
+        _id = rhs._id;
+        return;
+    }
+
     if (_typeLength)
     {
         _type = (byte*)malloc(_typeLength);
@@ -44,11 +56,39 @@ NdefRecord::NdefRecord(const NdefRecord& rhs)
 
 }
 
+NdefRecord::NdefRecord(NdefRecord&& rhs)
+{
+    //Serial.println("NdefRecord Constructor 3 (move)");
+
+    _tnf = rhs._tnf;
+    _owned = rhs._owned;
+    _typeLength = rhs._typeLength;
+    _payloadLength = rhs._payloadLength;
+    _idLength = rhs._idLength;
+    _type = rhs._type;
+    _payload = rhs._payload;
+    _id = rhs._id;
+
+    // leave rhs empty so its destructor has nothing to free
+    rhs._owned = true;
+    rhs._typeLength = 0;
+    rhs._payloadLength = 0;
+    rhs._idLength = 0;
+    rhs._type = (byte *)NULL;
+    rhs._payload = (byte *)NULL;
+    rhs._id = (byte *)NULL;
+}
+
 // TODO NdefRecord::NdefRecord(tnf, type, payload, id)
 
 NdefRecord::~NdefRecord()
 {
     //Serial.println("NdefRecord Destructor");
+    if (!_owned)
+    {
+        return; // views never free the caller's buffer
+    }
+
     if (_typeLength)
     {
         free(_type);
@@ -72,25 +112,40 @@ NdefRecord& NdefRecord::operator=(const NdefRecord& rhs)
     if (this != &rhs)
     {
         // free existing
-        if (_typeLength)
+        if (_owned)
         {
-            free(_type);
-        }
-
-        if (_payloadLength)
-        {
-            free(_payload);
-        }
-
-        if (_idLength)
-        {
-            free(_id);
+            if (_typeLength)
+            {
+                free(_type);
+            }
+
+            if (_payloadLength)
+            {
+                free(_payload);
+            }
+
+            if (_idLength)
+            {
+                free(_id);
+            }
         }
 
         _tnf = rhs._tnf;
+        _owned = rhs._owned;
         _typeLength = rhs._typeLength;
         _payloadLength = rhs._payloadLength;
         _idLength = rhs._idLength;
+        _type = (byte *)NULL;
+        _payload = (byte *)NULL;
+        _id = (byte *)NULL;
+
+        if (!_owned)
+        {
+            _type = rhs._type;
+            _payload = rhs._payload;
+            _id = rhs._id;
+            return *this;
+        }
 
         if (_typeLength)
         {
@@ -113,6 +168,92 @@ NdefRecord& NdefRecord::operator=(const NdefRecord& rhs)
     return *this;
 }
 
+NdefRecord& NdefRecord::operator=(NdefRecord&& rhs)
+{
+    //Serial.println("NdefRecord MOVE ASSIGN");
+
+    if (this != &rhs)
+    {
+        // free existing
+        if (_owned)
+        {
+            if (_typeLength)
+            {
+                free(_type);
+            }
+
+            if (_payloadLength)
+            {
+                free(_payload);
+            }
+
+            if (_idLength)
+            {
+                free(_id);
+            }
+        }
+
+        _tnf = rhs._tnf;
+        _owned = rhs._owned;
+        _typeLength = rhs._typeLength;
+        _payloadLength = rhs._payloadLength;
+        _idLength = rhs._idLength;
+        _type = rhs._type;
+        _payload = rhs._payload;
+        _id = rhs._id;
+
+        rhs._owned = true;
+        rhs._typeLength = 0;
+        rhs._payloadLength = 0;
+        rhs._idLength = 0;
+        rhs._type = (byte *)NULL;
+        rhs._payload = (byte *)NULL;
+        rhs._id = (byte *)NULL;
+    }
+    return *this;
+}
+
+boolean NdefRecord::isOwned()
+{
+    return _owned;
+}
+
+void NdefRecord::materialize()
+{
+    if (_owned)
+    {
+        return;
+    }
+
+    const byte* type = _type;
+    const byte* payload = _payload;
+    const byte* id = _id;
+
+    _type = (byte *)NULL;
+    _payload = (byte *)NULL;
+    _id = (byte *)NULL;
+
+    if (_typeLength)
+    {
+        _type = (byte*)malloc(_typeLength);
+        memcpy(_type, type, _typeLength);
+    }
+
+    if (_payloadLength)
+    {
+        _payload = (byte*)malloc(_payloadLength);
+        memcpy(_payload, payload, _payloadLength);
+    }
+
+    if (_idLength)
+    {
+        _id = (byte*)malloc(_idLength);
+        memcpy(_id, id, _idLength);
+    }
+
+    _owned = true;
+}
+
 // size of records in bytes
 int NdefRecord::getEncodedSize()
 {
@@ -136,7 +277,7 @@ int NdefRecord::getEncodedSize()
     return size;
 }
 
-void NdefRecord::encode(byte *data, bool firstRecord, bool lastRecord)
+int NdefRecord::encode(byte *data, bool firstRecord, bool lastRecord)
 {
     // assert data > getEncodedSize()
 
@@ -178,6 +319,8 @@ void NdefRecord::encode(byte *data, bool firstRecord, bool lastRecord)
         memcpy(data_ptr, _id, _idLength);
         data_ptr += _idLength;
     }
+
+    return data_ptr - &data[0];
 }
 
 byte NdefRecord::getTnfByte(bool firstRecord, bool lastRecord)
@@ -247,8 +390,25 @@ void NdefRecord::getType(uint8_t* type)
     memcpy(type, _type, _typeLength);
 }
 
+const byte* NdefRecord::getTypePtr()
+{
+    return _type;
+}
+
+const byte* NdefRecord::getPayloadPtr()
+{
+    return _payload;
+}
+
+const byte* NdefRecord::getIdPtr()
+{
+    return _id;
+}
+
 void NdefRecord::setType(const byte * type, const unsigned int numBytes)
 {
+    materialize(); // mutating a view makes it own its data
+
     if(_typeLength)
     {
         free(_type);
@@ -259,6 +419,20 @@ void NdefRecord::setType(const byte * type, const unsigned int numBytes)
     _typeLength = numBytes;
 }
 
+// as setType, but keeps a pointer into the caller's buffer instead of
+// copying - the record is only valid while that buffer is
+void NdefRecord::setTypeView(const byte * type, const unsigned int numBytes)
+{
+    if (_owned && _typeLength)
+    {
+        free(_type);
+    }
+
+    _type = (byte*)type;
+    _typeLength = numBytes;
+    _owned = false;
+}
+
 // assumes the caller sized payload properly
 void NdefRecord::getPayload(byte *payload)
 {
@@ -267,6 +441,8 @@ void NdefRecord::getPayload(byte *payload)
 
 void NdefRecord::setPayload(const byte * payload, const int numBytes)
 {
+    materialize();
+
     if (_payloadLength)
     {
         free(_payload);
@@ -277,6 +453,18 @@ void NdefRecord::setPayload(const byte * payload, const int numBytes)
     _payloadLength = numBytes;
 }
 
+void NdefRecord::setPayloadView(const byte * payload, const int numBytes)
+{
+    if (_owned && _payloadLength)
+    {
+        free(_payload);
+    }
+
+    _payload = (byte*)payload;
+    _payloadLength = numBytes;
+    _owned = false;
+}
+
 String NdefRecord::getId()
 {
     char id[_idLength + 1];
@@ -292,6 +480,8 @@ void NdefRecord::getId(byte *id)
 
 void NdefRecord::setId(const byte * id, const unsigned int numBytes)
 {
+    materialize();
+
     if (_idLength)
     {
         free(_id);
@@ -302,6 +492,18 @@ void NdefRecord::setId(const byte * id, const unsigned int numBytes)
     _idLength = numBytes;
 }
 
+void NdefRecord::setIdView(const byte * id, const unsigned int numBytes)
+{
+    if (_owned && _idLength)
+    {
+        free(_id);
+    }
+
+    _id = (byte*)id;
+    _idLength = numBytes;
+    _owned = false;
+}
+
 void NdefRecord::print()
 {
     Serial.println(F("  NDEF Record"));
@@ -19,11 +19,16 @@ class NdefRecord
     public:
         NdefRecord();
         NdefRecord(const NdefRecord& rhs);
+        // move support - steals the buffers instead of copying them,
+        // used by NdefMessage when building outbound messages
+        NdefRecord(NdefRecord&& rhs);
         ~NdefRecord();
         NdefRecord& operator=(const NdefRecord& rhs);
+        NdefRecord& operator=(NdefRecord&& rhs);
 
         int getEncodedSize();
-        void encode(byte *data, bool firstRecord, bool lastRecord);
+        // returns the number of bytes written
+        int encode(byte *data, bool firstRecord, bool lastRecord);
 
         unsigned int getTypeLength();
         int getPayloadLength();
@@ -34,6 +39,12 @@ class NdefRecord
         void getPayload(byte *payload);
         void getId(byte *id);
 
+        // direct access to the record data, without copying
+        // for a view record these point into the tag read buffer
+        const byte* getTypePtr();
+        const byte* getPayloadPtr();
+        const byte* getIdPtr();
+
         // convenience methods
         String getType();
         String getId();
@@ -43,10 +54,24 @@ class NdefRecord
         void setPayload(const byte *payload, const int numBytes);
         void setId(const byte *id, const unsigned int numBytes);
 
+        // view setters - keep a pointer into the caller's buffer instead
+        // of copying, used by the zero-copy NdefMessage parse
+        void setTypeView(const byte *type, const unsigned int numBytes);
+        void setPayloadView(const byte *payload, const int numBytes);
+        void setIdView(const byte *id, const unsigned int numBytes);
+
+        // true when the record owns copies of its data, false when it is
+        // a view into a buffer owned by the caller
+        boolean isOwned();
+        // copy viewed data into buffers owned by this record, so it stays
+        // valid after the tag read buffer is released
+        void materialize();
+
         void print();
     private:
         byte getTnfByte(bool firstRecord, bool lastRecord);
         byte _tnf; // 3 bit
+        boolean _owned;
         unsigned int _typeLength;
         int _payloadLength;
         unsigned int _idLength;
@@ -1,8 +1,18 @@
 #include <NfcAdapter.h>
 
+// first page of the NDEF data area, holds the message TLV header
+#define NFC_TAG_REVISION_PAGE 4
+
 NfcAdapter::NfcAdapter(PN532Interface &interface)
 {
     shield = new PN532(interface);
+    detectionRunning = false;
+
+    for (int i = 0; i < NFC_TAG_CACHE_SIZE; i++)
+    {
+        tagCache[i].valid = false;
+        tagCache[i].lastUsed = 0;
+    }
 }
 
 NfcAdapter::~NfcAdapter(void)
@@ -48,6 +58,33 @@ boolean NfcAdapter::tagPresent(unsigned long timeout)
     return success;
 }
 
+boolean NfcAdapter::startDetection()
+{
+    detectionRunning = shield->startPassiveTargetIDDetection(PN532_MIFARE_ISO14443A);
+    return detectionRunning;
+}
+
+boolean NfcAdapter::tagDetected()
+{
+    if (!detectionRunning)
+    {
+        // arm the reader so callers can just poll tagDetected() in a loop
+        if (!startDetection())
+        {
+            return false;
+        }
+    }
+
+    if (!shield->isReadyPassiveTargetID())
+    {
+        return false; // no tag in the field yet, come back later
+    }
+
+    detectionRunning = false;
+    uidLength = 0;
+    return shield->readDetectedPassiveTargetID(uid, (uint8_t*)&uidLength);
+}
+
 boolean NfcAdapter::erase()
 {
     boolean success;
@@ -76,6 +113,8 @@ boolean NfcAdapter::clean()
 {
     uint8_t type = guessTagType();
 
+    invalidateCacheEntry();
+
     if (type == TAG_TYPE_MIFARE_CLASSIC)
     {
         #ifdef NDEF_DEBUG
@@ -118,8 +157,40 @@ NfcTag NfcAdapter::read()
         #ifdef NDEF_DEBUG
         Serial.println(F("Reading Mifare Ultralight"));
         #endif
+
+        // repeat scans of the same tag are the common case, so check the
+        // cache first: the first data page holds the message TLV header
+        // and serves as a change indicator, making a cache hit cost one
+        // page read instead of the full NDEF area
+        byte revision[NFC_TAG_REVISION_SIZE];
+        boolean haveRevision = shield->mifareultralight_ReadPage(NFC_TAG_REVISION_PAGE, revision);
+
+        if (haveRevision)
+        {
+            TagCacheEntry* entry = findCacheEntry();
+            if (entry != NULL)
+            {
+                if (memcmp(entry->revision, revision, NFC_TAG_REVISION_SIZE) == 0)
+                {
+                    #ifdef NDEF_DEBUG
+                    Serial.println(F("Tag cache hit"));
+                    #endif
+                    entry->lastUsed = millis();
+                    return NfcTag(uid, uidLength, "NFC Forum Type 2", entry->message);
+                }
+                entry->valid = false; // tag was rewritten
+            }
+        }
+
         MifareUltralight ultralight = MifareUltralight(*shield);
-        return ultralight.read(uid, uidLength);
+        NfcTag tag = ultralight.read(uid, uidLength);
+
+        if (haveRevision && tag.hasNdefMessage())
+        {
+            NdefMessage message = tag.getNdefMessage();
+            cacheMessage(message, revision);
+        }
+        return tag;
     }
     else if (type == TAG_TYPE_UNKNOWN)
     {
@@ -140,6 +211,9 @@ boolean NfcAdapter::write(NdefMessage& ndefMessage)
     boolean success;
     uint8_t type = guessTagType();
 
+    // the cached content is stale once we write
+    invalidateCacheEntry();
+
     if (type == TAG_TYPE_MIFARE_CLASSIC)
     {
         #ifdef NDEF_DEBUG
@@ -170,6 +244,61 @@ boolean NfcAdapter::write(NdefMessage& ndefMessage)
     return success;
 }
 
+// cache entry for the tag currently in the field, or NULL
+TagCacheEntry* NfcAdapter::findCacheEntry()
+{
+    for (int i = 0; i < NFC_TAG_CACHE_SIZE; i++)
+    {
+        if (tagCache[i].valid &&
+            tagCache[i].uidLength == uidLength &&
+            memcmp(tagCache[i].uid, uid, uidLength) == 0)
+        {
+            return &tagCache[i];
+        }
+    }
+    return (TagCacheEntry*)NULL;
+}
+
+// store the parsed message for the current tag, evicting the least
+// recently used entry when the cache is full
+void NfcAdapter::cacheMessage(NdefMessage& message, const byte *revision)
+{
+    TagCacheEntry* entry = findCacheEntry();
+
+    if (entry == NULL)
+    {
+        entry = &tagCache[0];
+        for (int i = 1; i < NFC_TAG_CACHE_SIZE; i++)
+        {
+            if (!tagCache[i].valid)
+            {
+                entry = &tagCache[i];
+                break;
+            }
+            if (tagCache[i].lastUsed < entry->lastUsed)
+            {
+                entry = &tagCache[i];
+            }
+        }
+    }
+
+    entry->valid = true;
+    memcpy(entry->uid, uid, uidLength);
+    entry->uidLength = uidLength;
+    memcpy(entry->revision, revision, NFC_TAG_REVISION_SIZE);
+    entry->message = message;
+    entry->lastUsed = millis();
+}
+
+void NfcAdapter::invalidateCacheEntry()
+{
+    TagCacheEntry* entry = findCacheEntry();
+    if (entry != NULL)
+    {
+        entry->valid = false;
+    }
+}
+
 // TODO this should return a Driver MifareClassic, MifareUltralight, Type 4, Unknown
 // Guess Tag Type by looking at the ATQA and SAK values
 // Need to follow spec for Card Identification. Maybe AN1303, AN1305 and ???
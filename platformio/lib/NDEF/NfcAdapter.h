@@ -20,6 +20,24 @@
 #define IRQ   (2)
 #define RESET (3)  // Not connected by default on the NFC Shield
 
+// number of tags remembered by the read cache - workers badge the same
+// handful of tags all day, so a few entries cover the working set
+#define NFC_TAG_CACHE_SIZE 4
+// bytes of the first data page kept as a change indicator
+#define NFC_TAG_REVISION_SIZE 4
+
+// one cached tag: the parsed message plus the first data page, which is
+// re-read on each scan to detect that the tag content changed
+struct TagCacheEntry
+{
+    boolean valid;
+    byte uid[7];
+    unsigned int uidLength;
+    byte revision[NFC_TAG_REVISION_SIZE];
+    NdefMessage message;
+    unsigned long lastUsed; // for LRU eviction
+};
+
 class NfcAdapter {
     public:
         NfcAdapter(PN532Interface &interface);
@@ -27,6 +45,12 @@ class NfcAdapter {
         ~NfcAdapter(void);
         void begin(boolean verbose=true);
         boolean tagPresent(unsigned long timeout=0); // tagAvailable
+        // non-blocking alternative to tagPresent(): startDetection() arms
+        // the reader and returns at once, then tagDetected() polls for a
+        // tag with a single IRQ-line/status check per call. When it
+        // returns true the tag can be read() and detection re-armed
+        boolean startDetection();
+        boolean tagDetected();
         NfcTag read();
         boolean write(NdefMessage& ndefMessage);
         // erase tag by writing an empty NDEF record
@@ -39,7 +63,12 @@ class NfcAdapter {
         PN532* shield;
         byte uid[7];  // Buffer to store the returned UID
         unsigned int uidLength; // Length of the UID (4 or 7 bytes depending on ISO14443A card type)
+        boolean detectionRunning;
+        TagCacheEntry tagCache[NFC_TAG_CACHE_SIZE];
         unsigned int guessTagType();
+        TagCacheEntry* findCacheEntry();
+        void cacheMessage(NdefMessage& message, const byte *revision);
+        void invalidateCacheEntry();
 };
 
 #endif
@@ -380,15 +380,61 @@ bool PN532::setRFField(uint8_t autoRFCA, uint8_t rFOnOff)
 */
 /**************************************************************************/
 bool PN532::readPassiveTargetID(uint8_t cardbaudrate, uint8_t *uid, uint8_t *uidLength, uint16_t timeout)
+{
+    if (!startPassiveTargetIDDetection(cardbaudrate)) {
+        return 0x0;  // command failed
+    }
+
+    return readDetectedPassiveTargetID(uid, uidLength, timeout);
+}
+
+/**************************************************************************/
+/*!
+    Sends the InListPassiveTarget command and returns without waiting
+    for a target. Poll isReadyPassiveTargetID() and then collect the
+    result with readDetectedPassiveTargetID(), so the calling task is
+    never blocked in a detection timeout.
+
+    @param  cardBaudRate  Baud rate of the card
+
+    @returns 1 if the command was accepted, 0 for an error
+*/
+/**************************************************************************/
+bool PN532::startPassiveTargetIDDetection(uint8_t cardbaudrate)
 {
     pn532_packetbuffer[0] = PN532_COMMAND_INLISTPASSIVETARGET;
     pn532_packetbuffer[1] = 1;  // max 1 cards at once (we can set this to 2 later)
     pn532_packetbuffer[2] = cardbaudrate;
 
-    if (HAL(writeCommand)(pn532_packetbuffer, 3)) {
-        return 0x0;  // command failed
-    }
+    return (0 == HAL(writeCommand)(pn532_packetbuffer, 3));
+}
 
+/**************************************************************************/
+/*!
+    Checks, without blocking, whether a started detection has produced
+    a response frame (a target entered the field)
+*/
+/**************************************************************************/
+bool PN532::isReadyPassiveTargetID()
+{
+    return HAL(isResponseReady)();
+}
+
+/**************************************************************************/
+/*!
+    Reads the target detected by a previous
+    startPassiveTargetIDDetection() call
+
+    @param  uid           Pointer to the array that will be populated
+                          with the card's UID (up to 7 bytes)
+    @param  uidLength     Pointer to the variable that will hold the
+                          length of the card's UID.
+
+    @returns 1 if everything executed properly, 0 for an error
+*/
+/**************************************************************************/
+bool PN532::readDetectedPassiveTargetID(uint8_t *uid, uint8_t *uidLength, uint16_t timeout)
+{
     // read data packet
     if (HAL(readResponse)(pn532_packetbuffer, sizeof(pn532_packetbuffer), timeout) < 0) {
         return 0x0;
@@ -745,6 +791,60 @@ uint8_t PN532::mifareultralight_ReadPage (uint8_t page, uint8_t *buffer)
     return 1;
 }
 
+/**************************************************************************/
+/*!
+    Reads a range of 4-byte pages in a single FAST_READ transaction.
+    FAST_READ is supported by NTAG21x and Ultralight EV1 tags; the
+    original Ultralight only knows READ, so callers should fall back to
+    mifareultralight_ReadPage when this returns 0.
+
+    @param  startPage   The first page to read (0..63 in most cases)
+    @param  endPage     The last page to read, inclusive
+    @param  buffer      Pointer to the byte array that will hold the
+                        (endPage - startPage + 1) * 4 bytes of data
+*/
+/**************************************************************************/
+uint8_t PN532::mifareultralight_FastRead (uint8_t startPage, uint8_t endPage, uint8_t *buffer)
+{
+    if (endPage < startPage || endPage >= 64) {
+        DMSG("Page range out of range\n");
+        return 0;
+    }
+
+    /* The response carries a status byte before the page data, so the   */
+    /* number of pages per transaction is bounded by the packet buffer   */
+    if ((uint8_t)(endPage - startPage + 1) > (sizeof(pn532_packetbuffer) - 1) / 4) {
+        DMSG("Page range too large for packet buffer\n");
+        return 0;
+    }
+
+    /* Prepare the command */
+    pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
+    pn532_packetbuffer[1] = 1;                              /* Card number */
+    pn532_packetbuffer[2] = MIFARE_CMD_FAST_READ_ULTRALIGHT; /* FAST_READ command = 0x3A */
+    pn532_packetbuffer[3] = startPage;
+    pn532_packetbuffer[4] = endPage;
+
+    /* Send the command */
+    if (HAL(writeCommand)(pn532_packetbuffer, 5)) {
+        return 0;
+    }
+
+    /* Read the response packet */
+    HAL(readResponse)(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+
+    /* If byte 8 isn't 0x00 we probably have an error */
+    if (pn532_packetbuffer[0] == 0x00) {
+        /* Copy the page data to the output buffer */
+        memcpy (buffer, pn532_packetbuffer + 1, (endPage - startPage + 1) * 4);
+    } else {
+        return 0;
+    }
+
+    // Return OK signal
+    return 1;
+}
+
 /**************************************************************************/
 /*!
     Tries to write an entire 4-bytes data buffer at the specified page
@@ -50,6 +50,16 @@ public:
     *           <0      failed to read response
     */
     virtual int16_t readResponse(uint8_t buf[], uint8_t len, uint16_t timeout = 1000) = 0;
+
+    /**
+    * @brief    check whether a response frame is waiting, without blocking
+    * @return   true    a response can be read with readResponse
+    *           false   the PN532 is still working on the command
+    *
+    * The default assumes ready, so links that have no cheap readiness
+    * check keep the old blocking behaviour inside readResponse
+    */
+    virtual bool isResponseReady() { return true; }
 };
 
 #endif
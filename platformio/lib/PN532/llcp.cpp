@@ -12,6 +12,10 @@
 #define PDU_I       0x0c
 #define PDU_RR      0x0d
 
+// LLCP Parameter Type Values
+#define PARAM_MIUX  0x02
+#define PARAM_RW    0x05
+
 uint8_t LLCP::SYMM_PDU[2] = {0, 0};
 
 inline uint8_t getPType(const uint8_t *buf)
@@ -34,18 +38,50 @@ int8_t LLCP::activate(uint16_t timeout)
     return link.activateAsTarget(timeout);
 }
 
+void LLCP::parseParams(const uint8_t *buf, uint8_t len)
+{
+    uint8_t i = 0;
+    while ((uint8_t)(i + 2) <= len) {
+        uint8_t type = buf[i];
+        uint8_t tlen = buf[i + 1];
+        if ((uint16_t)(i + 2 + tlen) > len) {
+            break;
+        }
+
+        if (PARAM_MIUX == type && 2 == tlen) {
+            miu = LLCP_DEFAULT_MIU + (((buf[i + 2] & 0x07) << 8) + buf[i + 3]);
+            if (miu > LLCP_MAX_MIU) {
+                miu = LLCP_MAX_MIU;     // we can't fill a PN532 frame beyond this
+            }
+        } else if (PARAM_RW == type && 1 == tlen) {
+            rw = buf[i + 2] & 0x0f;
+            if (0 == rw) {
+                rw = 1;                 // RW 0 peers still ack one at a time
+            }
+        }
+
+        i += 2 + tlen;
+    }
+}
+
 int8_t LLCP::waitForConnection(uint16_t timeout)
 {
     uint8_t type;
+    int16_t status;
 
     mode = 1;
     ns = 0;
     nr = 0;
+    va = 0;
+    miu = LLCP_DEFAULT_MIU;
+    rw = LLCP_DEFAULT_RW;
+    pendingExchange = false;
 
     // Get CONNECT PDU
     DMSG("wait for a CONNECT PDU\n");
     do {
-        if (2 > link.read(headerBuf, headerBufLen)) {
+        status = link.read(headerBuf, headerBufLen);
+        if (2 > status) {
             return -1;
         }
 
@@ -62,13 +98,23 @@ int8_t LLCP::waitForConnection(uint16_t timeout)
 
     } while (1);
 
+    // the initiator's MIUX/RW ride on the CONNECT PDU
+    parseParams(headerBuf + 2, status - 2);
+
     // Put CC PDU
     DMSG("put a CC(Connection Complete) PDU to response the CONNECT PDU\n");
     ssap = getDSAP(headerBuf);
     dsap = getSSAP(headerBuf);
     headerBuf[0] = (dsap << 2) + ((PDU_CC >> 2) & 0x3);
     headerBuf[1] = ((PDU_CC & 0x3) << 6) + ssap;
-    if (!link.write(headerBuf, 2)) {
+    headerBuf[2] = PARAM_MIUX;
+    headerBuf[3] = 2;
+    headerBuf[4] = (LLCP_MAX_MIU - LLCP_DEFAULT_MIU) >> 8;
+    headerBuf[5] = (LLCP_MAX_MIU - LLCP_DEFAULT_MIU) & 0xff;
+    headerBuf[6] = PARAM_RW;
+    headerBuf[7] = 1;
+    headerBuf[8] = LLCP_SEND_WINDOW;
+    if (!link.write(headerBuf, 9)) {
         return -2;
     }
 
@@ -115,12 +161,17 @@ int8_t LLCP::waitForDisconnection(uint16_t timeout)
 int8_t LLCP::connect(uint16_t timeout)
 {
     uint8_t type;
+    int16_t status;
 
     mode = 0;
     dsap = LLCP_DEFAULT_DSAP;
     ssap = LLCP_DEFAULT_SSAP;
     ns = 0;
     nr = 0;
+    va = 0;
+    miu = LLCP_DEFAULT_MIU;
+    rw = LLCP_DEFAULT_RW;
+    pendingExchange = false;
 
     // try to get a SYMM PDU
     if (2 > link.read(headerBuf, headerBufLen)) {
@@ -131,20 +182,23 @@ int8_t LLCP::connect(uint16_t timeout)
         return -1;
     }
 
-    // put a CONNECT PDU
+    // put a CONNECT PDU, offering a large MIU and a receive window
+    uint8_t body[] = {
+        0x06, 15, 'u', 'r', 'n', ':', 'n', 'f', 'c', ':', 's', 'n', ':', 's', 'n', 'e', 'p',
+        PARAM_MIUX, 2, (LLCP_MAX_MIU - LLCP_DEFAULT_MIU) >> 8, (LLCP_MAX_MIU - LLCP_DEFAULT_MIU) & 0xff,
+        PARAM_RW, 1, LLCP_SEND_WINDOW
+    };
     headerBuf[0] = (LLCP_DEFAULT_DSAP << 2) + (PDU_CONNECT >> 2);
     headerBuf[1] = ((PDU_CONNECT & 0x03) << 6) + LLCP_DEFAULT_SSAP;
-    uint8_t body[] = "  urn:nfc:sn:snep";
-    body[0] = 0x06;
-    body[1] = sizeof(body) - 2 - 1;
-    if (!link.write(headerBuf, 2, body, sizeof(body) - 1)) {
+    if (!link.write(headerBuf, 2, body, sizeof(body))) {
         return -2;
     }
 
     // wait for a CC PDU
     DMSG("wait for a CC PDU\n");
     do {
-        if (2 > link.read(headerBuf, headerBufLen)) {
+        status = link.read(headerBuf, headerBufLen);
+        if (2 > status) {
             return -1;
         }
 
@@ -161,6 +215,9 @@ int8_t LLCP::connect(uint16_t timeout)
 
     } while (1);
 
+    // the peer answers with its own MIUX/RW on the CC PDU
+    parseParams(headerBuf + 2, status - 2);
+
     return 1;
 }
 
@@ -218,6 +275,7 @@ bool LLCP::write(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8
             return false;
         }
     }
+    pendingExchange = false;
 
     if (headerBufLen < (hlen + 3)) {
         return false;
@@ -229,7 +287,7 @@ bool LLCP::write(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8
 
     headerBuf[0] = (dsap << 2) + (PDU_I >> 2);
     headerBuf[1] = ((PDU_I & 0x3) << 6) + ssap;
-    headerBuf[2] = (ns << 4) + nr;
+    headerBuf[2] = ((ns & 0x0f) << 4) + (nr & 0x0f);
     if (!link.write(headerBuf, 3 + hlen, body, blen)) {
         return false;
     }
@@ -246,6 +304,9 @@ bool LLCP::write(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8
 
         type = getPType(headerBuf);
         if (PDU_RR == type) {
+            if (status >= 3) {
+                va = headerBuf[2] & 0x0f;
+            }
             break;
         } else if (PDU_SYMM == type) {
             if (!link.write(SYMM_PDU, sizeof(SYMM_PDU))) {
@@ -263,6 +324,94 @@ bool LLCP::write(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8
     return true;
 }
 
+bool LLCP::collectAck()
+{
+    int16_t status = link.read(headerBuf, headerBufLen);
+    if (2 > status) {
+        return false;
+    }
+
+    uint8_t type = getPType(headerBuf);
+    if (PDU_RR == type) {
+        if (status >= 3) {
+            va = headerBuf[2] & 0x0f;   // cumulative: peer's next expected N(S)
+        }
+        return true;
+    } else if (PDU_SYMM == type) {
+        return true;
+    }
+
+    return false;
+}
+
+bool LLCP::writeSegment(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8_t blen)
+{
+    if (headerBufLen < (hlen + 3)) {
+        return false;
+    }
+
+    // the link strictly alternates: take the peer's reply to the last
+    // exchange before transmitting again
+    if (pendingExchange) {
+        if (!collectAck()) {
+            return false;
+        }
+        pendingExchange = false;
+    }
+
+    // window full: poll with SYMMs until an acknowledgement frees a slot
+    while (((ns - va) & 0x0f) >= rw) {
+        if (!link.write(SYMM_PDU, sizeof(SYMM_PDU))) {
+            return false;
+        }
+        if (!collectAck()) {
+            return false;
+        }
+    }
+
+    for (int8_t i = hlen - 1; i >= 0; i--) {
+        headerBuf[i + 3] = header[i];
+    }
+
+    headerBuf[0] = (dsap << 2) + (PDU_I >> 2);
+    headerBuf[1] = ((PDU_I & 0x3) << 6) + ssap;
+    headerBuf[2] = ((ns & 0x0f) << 4) + (nr & 0x0f);
+    if (!link.write(headerBuf, 3 + hlen, body, blen)) {
+        return false;
+    }
+
+    ns++;
+    pendingExchange = true;
+
+    return true;
+}
+
+bool LLCP::flush()
+{
+    if (pendingExchange) {
+        if (!collectAck()) {
+            return false;
+        }
+        pendingExchange = false;
+    }
+
+    while (((ns - va) & 0x0f) != 0) {
+        if (!link.write(SYMM_PDU, sizeof(SYMM_PDU))) {
+            return false;
+        }
+        if (!collectAck()) {
+            return false;
+        }
+    }
+
+    // hand the link back so the peer can send its response
+    if (!link.write(SYMM_PDU, sizeof(SYMM_PDU))) {
+        return false;
+    }
+
+    return true;
+}
+
 int16_t LLCP::read(uint8_t *buf, uint8_t length)
 {
     uint8_t type;
@@ -294,7 +443,7 @@ int16_t LLCP::read(uint8_t *buf, uint8_t length)
 
     headerBuf[0] = (dsap << 2) + (PDU_RR >> 2);
     headerBuf[1] = ((PDU_RR & 0x3) << 6) + ssap;
-    headerBuf[2] = (buf[2] >> 4) + 1;
+    headerBuf[2] = ((buf[2] >> 4) + 1) & 0x0f;
     if (!link.write(headerBuf, 3)) {
         return -2;
     }
@@ -304,6 +453,7 @@ int16_t LLCP::read(uint8_t *buf, uint8_t length)
     }
 
     nr++;
+    pendingExchange = true;     // our RR is the reply the peer answers next
 
     return len;
 }
@@ -8,12 +8,28 @@
 #define LLCP_DEFAULT_DSAP     0x04
 #define LLCP_DEFAULT_SSAP     0x20
 
+// LLCP 1.1 defaults assumed when the peer sends no parameter
+#define LLCP_DEFAULT_MIU      128
+#define LLCP_DEFAULT_RW       1
+
+// The largest I PDU payload the PN532 normal frame can carry
+// (255 frame data - TgSetData command - 3 byte I PDU header - margin)
+#define LLCP_MAX_MIU          248
+
+// Receive window we advertise in CONNECT/CC (I PDUs the peer may keep
+// in flight towards us); bounded by the 4-bit sequence numbers
+#define LLCP_SEND_WINDOW      4
+
 class LLCP {
 public:
 	LLCP(PN532Interface &interface) : link(interface) {
         headerBuf = link.getHeaderBuffer(&headerBufLen);
         ns = 0;
         nr = 0;
+        va = 0;
+        miu = LLCP_DEFAULT_MIU;
+        rw = LLCP_DEFAULT_RW;
+        pendingExchange = false;
 	};
 
 	/**
@@ -44,15 +60,46 @@ public:
     */
     bool write(const uint8_t *header, uint8_t hlen, const uint8_t *body = 0, uint8_t blen = 0);
 
+    /**
+    * @brief    queue an I PDU without blocking for its acknowledgement;
+    *           up to the peer's receive window of segments stay in
+    *           flight, so back-to-back segments cost one link exchange
+    *           each instead of two. Call flush() before reading.
+    * @param    header  packet header, may be 0
+    * @param    hlen    length of header
+    * @param    body    packet body
+    * @param    blen    length of body
+    * @return   true    success
+    *           false   failed
+    */
+    bool writeSegment(const uint8_t *header, uint8_t hlen, const uint8_t *body = 0, uint8_t blen = 0);
+
+    /**
+    * @brief    wait until every queued segment is acknowledged and hand
+    *           the link back to the peer
+    * @return   true    success
+    *           false   failed
+    */
+    bool flush();
+
     /**
     * @brief    read a  packet, the packet will be less than (255 - 2) bytes
     * @param    buf     the buffer to contain the packet
     * @param    len     lenght of the buffer
-    * @return   >=0     length of the packet 
+    * @return   >=0     length of the packet
     *           <0      failed
     */
     int16_t read(uint8_t *buf, uint8_t len);
 
+    /**
+    * @brief    largest I PDU payload the peer accepts, from the MIUX
+    *           parameter of the CONNECT/CC exchange (128 without one),
+    *           capped at what the PN532 frame can carry
+    */
+    uint16_t getMiu() const {
+        return miu;
+    };
+
     uint8_t *getHeaderBuffer(uint8_t *len) {
         uint8_t *buf = link.getHeaderBuffer(len);
         len -= 3;       // I PDU header has 3 bytes
@@ -68,6 +115,13 @@ private:
     uint8_t headerBufLen;
     uint8_t ns;         // Number of I PDU Sent
     uint8_t nr;         // Number of I PDU Received
+    uint8_t va;         // Send Acknowledgement state: peer's last N(R)
+    uint16_t miu;       // Peer's Maximum Information Unit
+    uint8_t rw;         // Peer's Receive Window
+    bool pendingExchange;   // Peer owes a reply to the last segment
+
+    void parseParams(const uint8_t *buf, uint8_t len);
+    bool collectAck();
 
 	static uint8_t SYMM_PDU[2];
 };
@@ -2,7 +2,7 @@
 #include "snep.h"
 #include "PN532_debug.h"
 
-int8_t SNEP::write(const uint8_t *buf, uint8_t len, uint16_t timeout)
+int8_t SNEP::write(const uint8_t *buf, uint16_t len, uint16_t timeout)
 {
 	if (0 >= llcp.activate(timeout)) {
 		DMSG("failed to activate PN532 as a target\n");
@@ -14,14 +14,18 @@ int8_t SNEP::write(const uint8_t *buf, uint8_t len, uint16_t timeout)
 		return -2;
 	}
 
-	// response a success SNEP message
+	// the first fragment carries the SNEP header plus as much of the
+	// message as one I PDU of the negotiated MIU holds
+	uint16_t miu = llcp.getMiu();
+	uint16_t first = (len > (uint16_t)(miu - 6)) ? (uint16_t)(miu - 6) : len;
+
 	headerBuf[0] = SNEP_DEFAULT_VERSION;
 	headerBuf[1] = SNEP_REQUEST_PUT;
 	headerBuf[2] = 0;
 	headerBuf[3] = 0;
-	headerBuf[4] = 0;
-	headerBuf[5] = len;
-	if (0 >= llcp.write(headerBuf, 6, buf, len)) {
+	headerBuf[4] = len >> 8;
+	headerBuf[5] = len & 0xff;
+	if (0 >= llcp.write(headerBuf, 6, buf, first)) {
 		return -3;
 	}
 
@@ -37,7 +41,40 @@ int8_t SNEP::write(const uint8_t *buf, uint8_t len, uint16_t timeout)
 		return -4;
 	}
 
-	// expect a put request
+	if (first < len) {
+		// the peer asks for the rest of a fragmented message with a
+		// Continue response; stream the remaining fragments through the
+		// send window and collect the acknowledgements as they come back
+		if (SNEP_RESPONSE_CONTINUE != rbuf[1]) {
+			DMSG("Expect a continue response\n");
+			return -4;
+		}
+
+		uint16_t offset = first;
+		while (offset < len) {
+			uint16_t chunk = len - offset;
+			if (chunk > miu) {
+				chunk = miu;
+			}
+			if (!llcp.writeSegment(0, 0, buf + offset, chunk)) {
+				return -3;
+			}
+			offset += chunk;
+		}
+		if (!llcp.flush()) {
+			return -3;
+		}
+
+		if (6 > llcp.read(rbuf, sizeof(rbuf))) {
+			return -4;
+		}
+		if (SNEP_DEFAULT_VERSION != rbuf[0]) {
+			DMSG("The received SNEP message's major version is different\n");
+			return -4;
+		}
+	}
+
+	// expect a success response
 	if (SNEP_RESPONSE_SUCCESS != rbuf[1]) {
 		DMSG("Expect a success response\n");
 		return -4;
@@ -48,7 +85,7 @@ int8_t SNEP::write(const uint8_t *buf, uint8_t len, uint16_t timeout)
 	return 1;
 }
 
-int16_t SNEP::read(uint8_t *buf, uint8_t len, uint16_t timeout)
+int16_t SNEP::read(uint8_t *buf, uint16_t len, uint16_t timeout)
 {
 	if (0 >= llcp.activate(timeout)) {
 		DMSG("failed to activate PN532 as a target\n");
@@ -60,12 +97,12 @@ int16_t SNEP::read(uint8_t *buf, uint8_t len, uint16_t timeout)
 		return -2;
 	}
 
-	uint16_t status = llcp.read(buf, len);
+	uint8_t cap = (len > 255) ? 255 : len;
+	int16_t status = llcp.read(buf, cap);
 	if (6 > status) {
 		return -3;
 	}
 
-
 	// check SNEP version
 	if (SNEP_DEFAULT_VERSION != buf[0]) {
 		DMSG("The received SNEP message's major version is different\n");
@@ -79,20 +116,47 @@ int16_t SNEP::read(uint8_t *buf, uint8_t len, uint16_t timeout)
 		return -4;
 	}
 
-	// check message's length
-	uint32_t length = (buf[2] << 24) + (buf[3] << 16) + (buf[4] << 8) + buf[5];
-	// length should not be more than 244 (header + body < 255, header = 6 + 3 + 2)
-	if (length > (status - 6)) {
-		DMSG("The SNEP message is too large: "); 
-        DMSG_INT(length);
-        DMSG_INT(status - 6);
+	// check message's length against the buffer; fragments are read
+	// past the reassembled data, so leave room for one PDU header
+	uint32_t length = ((uint32_t)buf[2] << 24) + ((uint32_t)buf[3] << 16) + (buf[4] << 8) + buf[5];
+	if ((length + 6) > len) {
+		DMSG("The SNEP message is too large: ");
+		DMSG_INT(length);
+		DMSG_INT(len);
 		DMSG("\n");
 		return -4;
 	}
-	for (uint8_t i = 0; i < length; i++) {
+	uint16_t got = status - 6;
+	if (got > length) {
+		got = length;
+	}
+	for (uint16_t i = 0; i < got; i++) {
 		buf[i] = buf[i + 6];
 	}
 
+	if (got < length) {
+		// ask the peer to stream the remaining fragments
+		headerBuf[0] = SNEP_DEFAULT_VERSION;
+		headerBuf[1] = SNEP_RESPONSE_CONTINUE;
+		headerBuf[2] = 0;
+		headerBuf[3] = 0;
+		headerBuf[4] = 0;
+		headerBuf[5] = 0;
+		if (!llcp.write(headerBuf, 6)) {
+			return -3;
+		}
+
+		while (got < length) {
+			uint16_t room = len - got;
+			cap = (room > 255) ? 255 : room;
+			status = llcp.read(buf + got, cap);
+			if (0 >= status) {
+				return -3;
+			}
+			got += status;
+		}
+	}
+
 	// response a success SNEP message
 	headerBuf[0] = SNEP_DEFAULT_VERSION;
 	headerBuf[1] = SNEP_RESPONSE_SUCCESS;
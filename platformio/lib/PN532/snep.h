@@ -10,6 +10,7 @@
 #define SNEP_REQUEST_PUT		0x02
 #define SNEP_REQUEST_GET		0x01
 
+#define SNEP_RESPONSE_CONTINUE	0x80
 #define SNEP_RESPONSE_SUCCESS	0x81
 #define SNEP_RESPONSE_REJECT	0xFF
 
@@ -20,7 +21,10 @@ public:
 	};
 
 	/**
-    * @brief    write a SNEP packet, the packet should be less than (255 - 2 - 3) bytes
+    * @brief    write a SNEP packet; messages larger than one LLCP MIU
+    *           are fragmented and the fragments pipelined inside the
+    *           peer's receive window, so multi-KB payloads go out in a
+    *           few exchanges instead of one round trip per fragment
     * @param    buf     the buffer to contain the packet
     * @param    len     lenght of the buffer
     * @param    timeout max time to wait, 0 means no timeout
@@ -28,17 +32,19 @@ public:
     *			=0      timeout
     *           <0      failed
     */
-    int8_t write(const uint8_t *buf, uint8_t len, uint16_t timeout = 0);
+    int8_t write(const uint8_t *buf, uint16_t len, uint16_t timeout = 0);
 
     /**
-    * @brief    read a SNEP packet, the packet will be less than (255 - 2 - 3) bytes
+    * @brief    read a SNEP packet; fragmented messages are reassembled,
+    *           so keep a few bytes of headroom in the buffer beyond the
+    *           expected message for the PDU headers
     * @param    buf     the buffer to contain the packet
     * @param    len     lenght of the buffer
     * @param    timeout max time to wait, 0 means no timeout
-    * @return   >=0     length of the packet 
+    * @return   >=0     length of the packet
     *           <0      failed
     */
-    int16_t read(uint8_t *buf, uint8_t len, uint16_t timeout = 0);
+    int16_t read(uint8_t *buf, uint16_t len, uint16_t timeout = 0);
 
 private:
 	LLCP llcp;
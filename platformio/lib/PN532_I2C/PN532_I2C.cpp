@@ -9,15 +9,95 @@
 #define PN532_I2C_ADDRESS       (0x48 >> 1)
 
 
-PN532_I2C::PN532_I2C(TwoWire &wire)
+PN532_I2C::PN532_I2C(TwoWire &wire, int8_t irq)
 {
     _wire = &wire;
     command = 0;
+    _irq = irq;
+#ifdef ESP32
+    _irqSemaphore = NULL;
+#endif
 }
 
 void PN532_I2C::begin()
 {
     _wire->begin();
+    _wire->setClock(PN532_I2C_CLOCK);
+
+    if (_irq >= 0) {
+        pinMode(_irq, INPUT_PULLUP);
+#ifdef ESP32
+        if (NULL == _irqSemaphore) {
+            _irqSemaphore = xSemaphoreCreateBinary();
+        }
+        // IRQ goes low when the PN532 has a frame ready for us
+        attachInterruptArg(digitalPinToInterrupt(_irq), irqHandler, this, FALLING);
+#endif
+    }
+}
+
+#ifdef ESP32
+void IRAM_ATTR PN532_I2C::irqHandler(void *arg)
+{
+    PN532_I2C *instance = (PN532_I2C *)arg;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(instance->_irqSemaphore, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+#endif
+
+bool PN532_I2C::waitForIrq(uint16_t timeout)
+{
+    if (_irq < 0) {
+        // No IRQ line wired up, the callers fall back to polling the
+        // status byte over the bus
+        return true;
+    }
+
+#ifdef ESP32
+    // Block the calling task until the line is asserted, no bus traffic
+    // and no busy loop. The level check first catches an assert that
+    // happened before we started waiting
+    uint16_t time = 0;
+    while (HIGH == digitalRead(_irq)) {
+        TickType_t ticks = (0 == timeout) ? portMAX_DELAY : pdMS_TO_TICKS(1);
+        if (pdTRUE == xSemaphoreTake(_irqSemaphore, ticks)) {
+            continue;
+        }
+        time++;
+        if ((0 != timeout) && (time > timeout)) {
+            return false;
+        }
+    }
+    return true;
+#else
+    uint16_t time = 0;
+    while (HIGH == digitalRead(_irq)) {
+        delay(1);
+        time++;
+        if ((0 != timeout) && (time > timeout)) {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+bool PN532_I2C::isResponseReady()
+{
+    if (_irq >= 0) {
+        // IRQ is asserted low while a frame is waiting for us
+        return (LOW == digitalRead(_irq));
+    }
+
+    // No IRQ line: the PN532 prepends a status byte to every I2C read,
+    // so a one byte read tells us whether a frame is ready
+    if (_wire->requestFrom(PN532_I2C_ADDRESS, 1)) {
+        return (read() & 1);
+    }
+    return false;
 }
 
 void PN532_I2C::wakeup()
@@ -80,6 +160,10 @@ int16_t PN532_I2C::getResponseLength(uint8_t buf[], uint8_t len, uint16_t timeou
     const uint8_t PN532_NACK[] = {0, 0, 0xFF, 0xFF, 0, 0};
     uint16_t time = 0;
 
+    if (!waitForIrq(timeout)) {
+        return -1;
+    }
+
     do {
         if (_wire->requestFrom(PN532_I2C_ADDRESS, 6)) {
             if (read() & 1) {  // check first byte --- status
@@ -122,6 +206,10 @@ int16_t PN532_I2C::readResponse(uint8_t buf[], uint8_t len, uint16_t timeout)
     length = getResponseLength(buf, len, timeout);
 
     // [RDY] 00 00 FF LEN LCS (TFI PD0 ... PDn) DCS 00
+    if (!waitForIrq(timeout)) {
+        return -1;
+    }
+
     do {
         if (_wire->requestFrom(PN532_I2C_ADDRESS, 6 + length + 2)) {
             if (read() & 1) {  // check first byte --- status
@@ -192,6 +280,12 @@ int8_t PN532_I2C::readAckFrame()
     DMSG('\n');
     
     uint16_t time = 0;
+
+    if (!waitForIrq(PN532_ACK_WAIT_TIME)) {
+        DMSG("Time out when waiting for ACK\n");
+        return PN532_TIMEOUT;
+    }
+
     do {
         if (_wire->requestFrom(PN532_I2C_ADDRESS,  sizeof(PN532_ACK) + 1)) {
             if (read() & 1) {  // check first byte --- status
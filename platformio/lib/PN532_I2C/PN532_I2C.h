@@ -7,20 +7,45 @@
 
 #include <Wire.h>
 #include "PN532Interface.h"
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+// The PN532 supports I2C fast mode, and at 100kHz reading a full
+// response frame dominates the tag inventory cycle
+#ifndef PN532_I2C_CLOCK
+#define PN532_I2C_CLOCK 400000UL
+#endif
 
 class PN532_I2C : public PN532Interface {
 public:
-    PN532_I2C(TwoWire &wire);
+    /**
+     * @param wire  I2C bus the PN532 is attached to
+     * @param irq   Pin wired to the PN532 IRQ line, or -1 (default) to
+     *              poll the status byte over I2C as before. With the IRQ
+     *              line connected the ready-waits block on the interrupt
+     *              (on ESP32 the calling task sleeps on a semaphore)
+     *              instead of busy-polling the bus
+     */
+    PN532_I2C(TwoWire &wire, int8_t irq = -1);
     
     void begin();
     void wakeup();
     virtual int8_t writeCommand(const uint8_t *header, uint8_t hlen, const uint8_t *body = 0, uint8_t blen = 0);
     int16_t readResponse(uint8_t buf[], uint8_t len, uint16_t timeout);
+    virtual bool isResponseReady();
     
 private:
     TwoWire* _wire;
     uint8_t command;
+    int8_t _irq;
+#ifdef ESP32
+    SemaphoreHandle_t _irqSemaphore;
+    static void irqHandler(void *arg);
+#endif
     
+    bool waitForIrq(uint16_t timeout);
     int8_t readAckFrame();
     int16_t getResponseLength(uint8_t buf[], uint8_t len, uint16_t timeout);
     
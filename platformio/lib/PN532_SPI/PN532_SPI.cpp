@@ -0,0 +1,224 @@
+
+#include "PN532_SPI.h"
+#include "PN532_debug.h"
+#include "Arduino.h"
+
+// First byte of every SPI exchange selects the transfer direction
+#define DATA_WRITE      (0x01)
+#define STATUS_READ     (0x02)
+#define DATA_READ       (0x03)
+
+// The PN532 clocks SPI data LSB first; the controller handles the bit
+// order in hardware, so no REVERSE_BITS_ORDER is needed per byte
+static const SPISettings PN532_SPI_SETTINGS(PN532_SPI_CLOCK, LSBFIRST, SPI_MODE0);
+
+PN532_SPI::PN532_SPI(SPIClass &spi, uint8_t ss)
+{
+    _spi = &spi;
+    _ss = ss;
+    command = 0;
+}
+
+void PN532_SPI::begin()
+{
+    pinMode(_ss, OUTPUT);
+    digitalWrite(_ss, HIGH);
+    _spi->begin();
+}
+
+void PN532_SPI::wakeup()
+{
+    // Asserting chip select wakes the PN532 from power down; give it
+    // time to start its oscillator before the first frame
+    digitalWrite(_ss, LOW);
+    delay(2);
+    digitalWrite(_ss, HIGH);
+}
+
+int8_t PN532_SPI::writeCommand(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8_t blen)
+{
+    command = header[0];
+    writeFrame(header, hlen, body, blen);
+
+    uint8_t timeout = PN532_ACK_WAIT_TIME;
+    while (!isReady()) {
+        delay(1);
+        timeout--;
+        if (0 == timeout) {
+            DMSG("Time out when waiting for ACK\n");
+            return PN532_TIMEOUT;
+        }
+    }
+    return readAckFrame();
+}
+
+int16_t PN532_SPI::readResponse(uint8_t buf[], uint8_t len, uint16_t timeout)
+{
+    uint16_t time = 0;
+    while (!isReady()) {
+        delay(1);
+        time++;
+        if ((0 != timeout) && (time > timeout)) {
+            return PN532_TIMEOUT;
+        }
+    }
+
+    _spi->beginTransaction(PN532_SPI_SETTINGS);
+    digitalWrite(_ss, LOW);
+    delay(1);
+
+    int16_t result;
+    do {
+        write(DATA_READ);
+
+        // [00 00 FF LEN LCS (TFI PD0 ... PDn) DCS 00]
+        if (0x00 != read()      ||       // PREAMBLE
+                0x00 != read()  ||       // STARTCODE1
+                0xFF != read()           // STARTCODE2
+            ) {
+            result = PN532_INVALID_FRAME;
+            break;
+        }
+
+        uint8_t length = read();
+        if (0 != (uint8_t)(length + read())) {   // checksum of length
+            result = PN532_INVALID_FRAME;
+            break;
+        }
+
+        uint8_t cmd = command + 1;               // response command
+        if (PN532_PN532TOHOST != read() || (cmd) != read()) {
+            result = PN532_INVALID_FRAME;
+            break;
+        }
+
+        DMSG("read:  ");
+        DMSG_HEX(cmd);
+
+        length -= 2;
+        if (length > len) {
+            // Drain the frame so the reader stays in sync
+            for (uint8_t i = 0; i < length; i++) {
+                DMSG_HEX(read());
+            }
+            DMSG("\nNot enough space\n");
+            read();
+            read();
+            result = PN532_NO_SPACE;
+            break;
+        }
+
+        uint8_t sum = PN532_PN532TOHOST + cmd;
+        for (uint8_t i = 0; i < length; i++) {
+            buf[i] = read();
+            sum += buf[i];
+
+            DMSG_HEX(buf[i]);
+        }
+        DMSG('\n');
+
+        uint8_t checksum = read();
+        if (0 != (uint8_t)(sum + checksum)) {
+            DMSG("checksum is not ok\n");
+            result = PN532_INVALID_FRAME;
+            break;
+        }
+        read();         // POSTAMBLE
+
+        result = length;
+    } while (0);
+
+    digitalWrite(_ss, HIGH);
+    _spi->endTransaction();
+
+    return result;
+}
+
+bool PN532_SPI::isResponseReady()
+{
+    // One status exchange on our own bus, no contention with the I2C
+    // sensors and nothing blocks
+    return isReady();
+}
+
+bool PN532_SPI::isReady()
+{
+    _spi->beginTransaction(PN532_SPI_SETTINGS);
+    digitalWrite(_ss, LOW);
+
+    write(STATUS_READ);
+    uint8_t status = read() & 1;
+
+    digitalWrite(_ss, HIGH);
+    _spi->endTransaction();
+    return status;
+}
+
+void PN532_SPI::writeFrame(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8_t blen)
+{
+    _spi->beginTransaction(PN532_SPI_SETTINGS);
+    digitalWrite(_ss, LOW);
+    delay(2);               // wake up PN532, if it was in power down mode
+
+    write(DATA_WRITE);
+    write(PN532_PREAMBLE);
+    write(PN532_STARTCODE1);
+    write(PN532_STARTCODE2);
+
+    uint8_t length = hlen + blen + 1;   // length of data field: TFI + DATA
+    write(length);
+    write(~length + 1);                 // checksum of length
+
+    write(PN532_HOSTTOPN532);
+    uint8_t sum = PN532_HOSTTOPN532;    // sum of TFI + DATA
+
+    DMSG("write: ");
+
+    for (uint8_t i = 0; i < hlen; i++) {
+        write(header[i]);
+        sum += header[i];
+
+        DMSG_HEX(header[i]);
+    }
+
+    for (uint8_t i = 0; i < blen; i++) {
+        write(body[i]);
+        sum += body[i];
+
+        DMSG_HEX(body[i]);
+    }
+
+    uint8_t checksum = ~sum + 1;        // checksum of TFI + DATA
+    write(checksum);
+    write(PN532_POSTAMBLE);
+
+    digitalWrite(_ss, HIGH);
+    _spi->endTransaction();
+
+    DMSG('\n');
+}
+
+int8_t PN532_SPI::readAckFrame()
+{
+    const uint8_t PN532_ACK[] = {0, 0, 0xFF, 0, 0xFF, 0};
+    uint8_t ackBuf[sizeof(PN532_ACK)];
+
+    _spi->beginTransaction(PN532_SPI_SETTINGS);
+    digitalWrite(_ss, LOW);
+    delay(1);
+
+    write(DATA_READ);
+    for (uint8_t i = 0; i < sizeof(PN532_ACK); i++) {
+        ackBuf[i] = read();
+    }
+
+    digitalWrite(_ss, HIGH);
+    _spi->endTransaction();
+
+    if (memcmp(ackBuf, PN532_ACK, sizeof(PN532_ACK))) {
+        DMSG("Invalid ACK\n");
+        return PN532_INVALID_ACK;
+    }
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+
+#ifndef __PN532_SPI_H__
+#define __PN532_SPI_H__
+
+#include <SPI.h>
+#include "PN532Interface.h"
+
+// The PN532 SPI link is specified up to 5MHz; 4MHz keeps margin on
+// long leads while still moving a full response frame in tens of
+// microseconds instead of the milliseconds the I2C link needs
+#ifndef PN532_SPI_CLOCK
+#define PN532_SPI_CLOCK 4000000UL
+#endif
+
+class PN532_SPI : public PN532Interface {
+public:
+    /**
+     * @param spi  SPI bus the PN532 is attached to
+     * @param ss   Chip select pin for the reader
+     */
+    PN532_SPI(SPIClass &spi, uint8_t ss);
+
+    void begin();
+    void wakeup();
+    virtual int8_t writeCommand(const uint8_t *header, uint8_t hlen, const uint8_t *body = 0, uint8_t blen = 0);
+    int16_t readResponse(uint8_t buf[], uint8_t len, uint16_t timeout);
+    virtual bool isResponseReady();
+
+private:
+    SPIClass* _spi;
+    uint8_t _ss;
+    uint8_t command;
+
+    bool isReady();
+    void writeFrame(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8_t blen);
+    int8_t readAckFrame();
+
+    inline void write(uint8_t data) {
+        _spi->transfer(data);
+    }
+
+    inline uint8_t read() {
+        return _spi->transfer(0);
+    }
+};
+
+#endif
@@ -8,6 +8,22 @@
 #include "PubSubClient.h"
 #include "Arduino.h"
 
+// Map a v5 CONNACK reason code onto the closest legacy state() value,
+// so existing reconnect logic keeps working; the raw code stays
+// available through reasonCode()
+static int v5ReasonToState(uint8_t reason) {
+    switch (reason) {
+        case 0x84: return MQTT_CONNECT_BAD_PROTOCOL;
+        case 0x85: return MQTT_CONNECT_BAD_CLIENT_ID;
+        case 0x86: return MQTT_CONNECT_BAD_CREDENTIALS;
+        case 0x87: return MQTT_CONNECT_UNAUTHORIZED;
+        case 0x88:
+        case 0x89:
+        case 0x97: return MQTT_CONNECT_UNAVAILABLE;
+        default:   return MQTT_CONNECT_FAILED;
+    }
+}
+
 PubSubClient::PubSubClient() {
     this->_state = MQTT_DISCONNECTED;
     this->_client = NULL;
@@ -159,27 +175,57 @@ PubSubClient::PubSubClient(const char* domain, uint16_t port, MQTT_CALLBACK_SIGN
 }
 
 PubSubClient::~PubSubClient() {
+  clearInflight();
+  free(this->coalesceBuf);
   free(this->buffer);
 }
 
 boolean PubSubClient::connect(const char *id) {
-    return connect(id,NULL,NULL,0,0,0,0,1);
+    return connect(id,NULL,NULL,0,0,0,0,this->cleanSession);
 }
 
 boolean PubSubClient::connect(const char *id, const char *user, const char *pass) {
-    return connect(id,user,pass,0,0,0,0,1);
+    return connect(id,user,pass,0,0,0,0,this->cleanSession);
 }
 
 boolean PubSubClient::connect(const char *id, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage) {
-    return connect(id,NULL,NULL,willTopic,willQos,willRetain,willMessage,1);
+    return connect(id,NULL,NULL,willTopic,willQos,willRetain,willMessage,this->cleanSession);
 }
 
 boolean PubSubClient::connect(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage) {
-    return connect(id,user,pass,willTopic,willQos,willRetain,willMessage,1);
+    return connect(id,user,pass,willTopic,willQos,willRetain,willMessage,this->cleanSession);
 }
 
 boolean PubSubClient::connect(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
     if (!connected()) {
+        if (!sendConnect(id, user, pass, willTopic, willQos, willRetain, willMessage, cleanSession)) {
+            return false;
+        }
+
+        while (!_client->available()) {
+            unsigned long t = millis();
+            if (t-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
+                _state = MQTT_CONNECTION_TIMEOUT;
+                _client->stop();
+                return false;
+            }
+        }
+        uint8_t llen;
+        uint32_t len = readPacket(&llen);
+
+        if (processConnack(len)) {
+            return true;
+        }
+        _client->stop();
+        return false;
+    }
+    return true;
+}
+
+// Opens the transport (reusing a warm socket when one is up) and sends
+// the CONNECT packet. Shared by the blocking connect() and
+// connectAsync(); only the CONNACK wait differs between the two.
+boolean PubSubClient::sendConnect(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
         int result = 0;
 
 
@@ -195,10 +241,18 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
 
         if (result == 1) {
             nextMsgId = 1;
+            clearInflight();
             // Leave room in the buffer for header and variable length field
             uint16_t length = MQTT_MAX_HEADER_SIZE;
             unsigned int j;
 
+            if (this->useV5) {
+                // Same "MQTT" protocol name, level 5
+                uint8_t d5[7] = {0x00,0x04,'M','Q','T','T',MQTT_VERSION_5};
+                for (j = 0;j<7;j++) {
+                    this->buffer[length++] = d5[j];
+                }
+            } else {
 #if MQTT_VERSION == MQTT_VERSION_3_1
             uint8_t d[9] = {0x00,0x06,'M','Q','I','s','d','p', MQTT_VERSION};
 #define MQTT_HEADER_VERSION_LENGTH 9
@@ -209,6 +263,7 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
             for (j = 0;j<MQTT_HEADER_VERSION_LENGTH;j++) {
                 this->buffer[length++] = d[j];
             }
+            }
 
             uint8_t v;
             if (willTopic) {
@@ -232,9 +287,29 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
             this->buffer[length++] = ((this->keepAlive) >> 8);
             this->buffer[length++] = ((this->keepAlive) & 0xFF);
 
+            if (this->useV5) {
+                if (cleanSession) {
+                    // No CONNECT properties; the broker's topic alias
+                    // budget for us comes back in the CONNACK
+                    this->buffer[length++] = 0;
+                } else {
+                    // A v5 persistent session needs an explicit expiry;
+                    // 0xFFFFFFFF = never, matching 3.1.1 semantics
+                    this->buffer[length++] = 5;
+                    this->buffer[length++] = 0x11; // Session Expiry Interval
+                    this->buffer[length++] = 0xFF;
+                    this->buffer[length++] = 0xFF;
+                    this->buffer[length++] = 0xFF;
+                    this->buffer[length++] = 0xFF;
+                }
+            }
+
             CHECK_STRING_LENGTH(length,id)
             length = writeString(id,this->buffer,length);
             if (willTopic) {
+                if (this->useV5) {
+                    this->buffer[length++] = 0; // will properties
+                }
                 CHECK_STRING_LENGTH(length,willTopic)
                 length = writeString(willTopic,this->buffer,length);
                 CHECK_STRING_LENGTH(length,willMessage)
@@ -253,37 +328,105 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
             write(MQTTCONNECT,this->buffer,length-MQTT_MAX_HEADER_SIZE);
 
             lastInActivity = lastOutActivity = millis();
+            return true;
+        } else {
+            _state = MQTT_CONNECT_FAILED;
+        }
+        return false;
+}
 
-            while (!_client->available()) {
-                unsigned long t = millis();
-                if (t-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
-                    _state = MQTT_CONNECTION_TIMEOUT;
-                    _client->stop();
-                    return false;
-                }
-            }
-            uint8_t llen;
-            uint32_t len = readPacket(&llen);
-
-            if (len == 4) {
+// Parses the CONNACK read by the caller. On success flips the state to
+// MQTT_CONNECTED; on refusal records the broker's reason as the state.
+// The caller owns closing the socket on failure.
+boolean PubSubClient::processConnack(uint32_t len) {
+            if (this->useV5 ? (len >= 5) : (len == 4)) {
+                this->lastReasonCode = buffer[3];
                 if (buffer[3] == 0) {
                     lastInActivity = millis();
                     pingOutstanding = false;
+                    // CONNACK flags bit 0: broker resumed a stored session
+                    sessionPresentFlag = (buffer[2] & 0x01) != 0;
+                    clearAliases();
+                    this->brokerAliasMax = 0;
+                    if (this->useV5) {
+                        // Scan the CONNACK properties for the broker's
+                        // Topic Alias Maximum; everything else is skipped
+                        // by its wire type
+                        uint32_t pos = 4;
+                        uint32_t propsLen = 0;
+                        uint32_t mult = 1;
+                        uint8_t digit;
+                        do {
+                            digit = this->buffer[pos++];
+                            propsLen += (digit & 127) * mult;
+                            mult <<= 7;
+                        } while ((digit & 128) != 0 && pos < len);
+                        uint32_t end = pos + propsLen;
+                        if (end > len) end = len;
+                        while (pos < end) {
+                            uint8_t propId = this->buffer[pos++];
+                            if (propId == 0x22) {          // Topic Alias Maximum
+                                this->brokerAliasMax = (this->buffer[pos]<<8) | this->buffer[pos+1];
+                                pos += 2;
+                            } else if (propId == 0x21 || propId == 0x13) {
+                                pos += 2;                  // two-byte integers
+                            } else if (propId == 0x11 || propId == 0x27) {
+                                pos += 4;                  // four-byte integers
+                            } else if (propId == 0x24 || propId == 0x25 ||
+                                       propId == 0x28 || propId == 0x29 ||
+                                       propId == 0x2A) {
+                                pos += 1;                  // single bytes
+                            } else if (propId == 0x12 || propId == 0x1A ||
+                                       propId == 0x1C || propId == 0x1F ||
+                                       propId == 0x15 || propId == 0x16 ||
+                                       propId == 0x26) {   // strings / binary / pairs
+                                uint16_t sl = (this->buffer[pos]<<8) | this->buffer[pos+1];
+                                pos += 2 + sl;
+                                if (propId == 0x26 && pos + 2 <= end) {
+                                    uint16_t sv = (this->buffer[pos]<<8) | this->buffer[pos+1];
+                                    pos += 2 + sv;
+                                }
+                            } else {
+                                break;                     // unknown: stop scanning
+                            }
+                        }
+                    }
                     _state = MQTT_CONNECTED;
                     return true;
                 } else {
-                    _state = buffer[3];
+                    _state = this->useV5 ? v5ReasonToState(buffer[3]) : buffer[3];
                 }
+            } else {
+                _state = MQTT_CONNECT_FAILED;
             }
-            _client->stop();
-        } else {
-            _state = MQTT_CONNECT_FAILED;
-        }
+            return false;
+}
+
+boolean PubSubClient::connectAsync(const char *id) {
+    return connectAsync(id, NULL, NULL);
+}
+
+boolean PubSubClient::connectAsync(const char *id, const char *user, const char *pass) {
+    if (connected()) {
+        return true;
+    }
+    if (!sendConnect(id, user, pass, NULL, 0, false, NULL, this->cleanSession)) {
         return false;
     }
+    _state = MQTT_CONNECT_IN_PROGRESS;
+    connectStartedAt = millis();
     return true;
 }
 
+boolean PubSubClient::connecting() {
+    return this->_state == MQTT_CONNECT_IN_PROGRESS;
+}
+
+PubSubClient& PubSubClient::setConnectCallback(MQTT_CONNECT_CALLBACK_SIGNATURE) {
+    this->connectCallback = connectCallback;
+    return *this;
+}
+
 // reads a byte into result
 boolean PubSubClient::readByte(uint8_t * result) {
    uint32_t previousMillis = millis();
@@ -333,6 +476,60 @@ uint32_t PubSubClient::readPacket(uint8_t* lengthLength) {
     } while ((digit & 128) != 0);
     *lengthLength = len-1;
 
+    if (this->stream == NULL) {
+        // Bulk path (no stream spill configured): pull the remaining
+        // length into the packet buffer in as few Client read() calls
+        // as the socket delivers, instead of one virtual dispatch into
+        // lwIP per byte — a 1KB RPC or OTA chunk goes from ~1000 read
+        // calls to a handful.
+        uint32_t total = (uint32_t)len + length;
+        if (this->bufferCeiling > 0 && total > this->bufferFloor) {
+            // Elastic mode: grow now that the remaining length is known,
+            // before any payload byte lands. realloc keeps the header
+            // bytes already read. A failed grow (or a packet above the
+            // ceiling) falls through to the drain-and-discard path.
+            if (total > this->bufferSize && total <= this->bufferCeiling) {
+                setBufferSize((uint16_t)total);
+            }
+            this->lastOversizeAt = millis();
+        }
+        uint32_t remaining = length;
+        uint8_t scratch[64];
+        while (remaining > 0) {
+            unsigned long previousMillis = millis();
+            while (!_client->available()) {
+                yield();
+                if (millis() - previousMillis >= ((unsigned long) this->socketTimeout * 1000)) {
+                    return 0;
+                }
+            }
+            uint32_t want = remaining;
+            int got;
+            if (len < this->bufferSize) {
+                uint32_t room = this->bufferSize - len;
+                if (want > room) want = room;
+                got = _client->read(this->buffer + len, want);
+                if (got > 0) len += got;
+            } else {
+                // Oversized packet: drain (and discard) the rest so the
+                // stream stays in sync
+                if (want > sizeof(scratch)) want = sizeof(scratch);
+                got = _client->read(scratch, want);
+            }
+            if (got <= 0) {
+                // available() said yes but the read failed: link is gone
+                return 0;
+            }
+            remaining -= got;
+        }
+        if (total > this->bufferSize) {
+            len = 0; // This will cause the packet to be ignored.
+        }
+        return len;
+    }
+
+    // Stream spill path: byte-by-byte so payload bytes beyond the topic
+    // can be handed to the stream as they arrive
     if (isPublish) {
         // Read in topic length to calculate bytes to skip over for Stream writing
         if(!readByte(this->buffer, &len)) return 0;
@@ -348,10 +545,8 @@ uint32_t PubSubClient::readPacket(uint8_t* lengthLength) {
 
     for (uint32_t i = start;i<length;i++) {
         if(!readByte(&digit)) return 0;
-        if (this->stream) {
-            if (isPublish && idx-*lengthLength-2>skip) {
-                this->stream->write(digit);
-            }
+        if (isPublish && idx-*lengthLength-2>skip) {
+            this->stream->write(digit);
         }
 
         if (len < this->bufferSize) {
@@ -360,17 +555,43 @@ uint32_t PubSubClient::readPacket(uint8_t* lengthLength) {
         }
         idx++;
     }
-
-    if (!this->stream && idx > this->bufferSize) {
-        len = 0; // This will cause the packet to be ignored.
-    }
     return len;
 }
 
 boolean PubSubClient::loop() {
+    if (this->_state == MQTT_CONNECT_IN_PROGRESS) {
+        // CONNACK wait for connectAsync(), one poll per loop() call
+        // instead of the blocking spin in connect()
+        if (!_client->connected()) {
+            _state = MQTT_CONNECTION_LOST;
+        } else if (_client->available()) {
+            uint8_t llen;
+            uint32_t len = readPacket(&llen);
+            if (!processConnack(len)) {
+                _client->stop();
+            }
+        } else if (millis() - connectStartedAt >= ((unsigned long) this->socketTimeout*1000UL)) {
+            _state = MQTT_CONNECTION_TIMEOUT;
+            _client->stop();
+        } else {
+            return false;  // still waiting, nothing decided yet
+        }
+        if (connectCallback) {
+            connectCallback(this->_state == MQTT_CONNECTED);
+        }
+        return this->_state == MQTT_CONNECTED;
+    }
     if (connected()) {
         unsigned long t = millis();
-        if ((t - lastInActivity > this->keepAlive*1000UL) || (t - lastOutActivity > this->keepAlive*1000UL)) {
+        // Flush staged publishes once the coalescing window has elapsed
+        if (coalesceLen > 0 && t - firstQueuedAt >= coalesceWindowMs) {
+            flushOutbound();
+        }
+        shrinkBufferIfIdle();
+        // A PINGREQ is only needed when our own traffic has not already
+        // reset the server's keepalive timer. Inbound silence alone is
+        // probed at 2x keepalive so a half-open link is still detected.
+        if ((t - lastOutActivity > this->keepAlive*1000UL) || (t - lastInActivity > this->keepAlive*2000UL)) {
             if (pingOutstanding) {
                 this->_state = MQTT_CONNECTION_TIMEOUT;
                 _client->stop();
@@ -398,24 +619,62 @@ boolean PubSubClient::loop() {
                         memmove(this->buffer+llen+2,this->buffer+llen+3,tl); /* move topic inside buffer 1 byte to front */
                         this->buffer[llen+2+tl] = 0; /* end the topic as a 'C' string with \x00 */
                         char *topic = (char*) this->buffer+llen+2;
+                        // Copy the topic out first: the callback may
+                        // scribble over the packet buffer it points into
+                        char statTopic[sizeof(((MqttRxTopicStat*)0)->topic)];
+                        strncpy(statTopic, topic, sizeof(statTopic)-1);
+                        statTopic[sizeof(statTopic)-1] = 0;
+                        unsigned long cbStart;
                         // msgId only present for QOS>0
-                        if ((this->buffer[0]&0x06) == MQTTQOS1) {
+                        boolean isQos1 = (this->buffer[0]&0x06) == MQTTQOS1;
+                        uint32_t payloadOffset;
+                        if (isQos1) {
                             msgId = (this->buffer[llen+3+tl]<<8)+this->buffer[llen+3+tl+1];
-                            payload = this->buffer+llen+3+tl+2;
-                            callback(topic,payload,len-llen-3-tl-2);
-
+                            payloadOffset = llen+3+tl+2;
+                        } else {
+                            payloadOffset = llen+3+tl;
+                        }
+                        if (this->useV5) {
+                            // Skip the v5 properties between the variable
+                            // header and the payload (we advertise no
+                            // inbound alias budget, so no aliases arrive)
+                            uint32_t propsLen = 0;
+                            uint32_t mult = 1;
+                            uint8_t digit;
+                            do {
+                                digit = this->buffer[payloadOffset++];
+                                propsLen += (digit & 127) * mult;
+                                mult <<= 7;
+                            } while ((digit & 128) != 0 && payloadOffset < len);
+                            payloadOffset += propsLen;
+                        }
+                        payload = this->buffer+payloadOffset;
+                        cbStart = micros();
+                        callback(topic,payload,len-payloadOffset);
+                        recordCallbackUs(statTopic, (uint32_t)(micros()-cbStart));
+                        if (isQos1) {
+                            // A 2-byte PUBACK (no reason code) is valid
+                            // in both protocol versions
                             this->buffer[0] = MQTTPUBACK;
                             this->buffer[1] = 2;
                             this->buffer[2] = (msgId >> 8);
                             this->buffer[3] = (msgId & 0xFF);
                             _client->write(this->buffer,4);
                             lastOutActivity = t;
-
-                        } else {
-                            payload = this->buffer+llen+3+tl;
-                            callback(topic,payload,len-llen-3-tl);
                         }
                     }
+                } else if (type == MQTTDISCONNECT) {
+                    // v5 brokers announce why they are dropping us; keep
+                    // the reason for the application's reconnect logic
+                    if (this->useV5 && len >= 3) {
+                        this->lastReasonCode = this->buffer[2];
+                    }
+                    _state = MQTT_CONNECTION_LOST;
+                    _client->stop();
+                    return false;
+                } else if (type == MQTTPUBACK) {
+                    msgId = (this->buffer[2]<<8)+this->buffer[3];
+                    handlePuback(msgId);
                 } else if (type == MQTTPINGREQ) {
                     this->buffer[0] = MQTTPINGRESP;
                     this->buffer[1] = 0;
@@ -428,11 +687,60 @@ boolean PubSubClient::loop() {
                 return false;
             }
         }
+        retryInflight();
         return true;
     }
     return false;
 }
 
+// Acknowledge an in-flight QoS 1 message and free its slot
+void PubSubClient::handlePuback(uint16_t msgId) {
+    for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        if (inflight[i].packet != NULL && inflight[i].msgId == msgId) {
+            free(inflight[i].packet);
+            inflight[i].packet = NULL;
+            return;
+        }
+    }
+}
+
+// Retransmit (with the DUP flag) any in-flight message whose PUBACK is
+// overdue; drop messages that exhausted their retries
+void PubSubClient::retryInflight() {
+    unsigned long t = millis();
+    for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        if (inflight[i].packet == NULL) continue;
+        if (t - inflight[i].sentAt < MQTT_QOS1_RETRY_MS) continue;
+        if (inflight[i].retries >= MQTT_QOS1_MAX_RETRIES) {
+            free(inflight[i].packet);
+            inflight[i].packet = NULL;
+            continue;
+        }
+        inflight[i].packet[0] |= 0x08; // DUP
+        _client->write(inflight[i].packet, inflight[i].packetLen);
+        lastOutActivity = t;
+        inflight[i].sentAt = t;
+        inflight[i].retries++;
+    }
+}
+
+void PubSubClient::clearInflight() {
+    for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        if (inflight[i].packet != NULL) {
+            free(inflight[i].packet);
+            inflight[i].packet = NULL;
+        }
+    }
+}
+
+uint8_t PubSubClient::inflightCount() {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        if (inflight[i].packet != NULL) n++;
+    }
+    return n;
+}
+
 boolean PubSubClient::publish(const char* topic, const char* payload) {
     return publish(topic,(const uint8_t*)payload, payload ? strnlen(payload, this->bufferSize) : 0,false);
 }
@@ -447,13 +755,27 @@ boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigne
 
 boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
     if (connected()) {
-        if (this->bufferSize < MQTT_MAX_HEADER_SIZE + 2+strnlen(topic, this->bufferSize) + plength) {
+        if (this->bufferSize < MQTT_MAX_HEADER_SIZE + 2+strnlen(topic, this->bufferSize) + 4 + plength) {
             // Too long
             return false;
         }
         // Leave room in the buffer for header and variable length field
         uint16_t length = MQTT_MAX_HEADER_SIZE;
-        length = writeString(topic,this->buffer,length);
+        uint16_t alias = 0;
+        boolean aliasEstablished = false;
+        if (this->useV5) {
+            alias = lookupAlias(topic, &aliasEstablished);
+        }
+        if (aliasEstablished) {
+            // The broker knows this alias: an empty topic plus the
+            // 2-byte alias property stands in for the full string
+            length = writeString("",this->buffer,length);
+        } else {
+            length = writeString(topic,this->buffer,length);
+        }
+        if (this->useV5) {
+            length = appendPublishProps(alias, this->buffer, length);
+        }
 
         // Add payload
         uint16_t i;
@@ -466,11 +788,187 @@ boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigne
         if (retained) {
             header |= 1;
         }
+        if (coalesceWindowMs > 0) {
+            uint8_t hlen = buildHeader(header, this->buffer, length-MQTT_MAX_HEADER_SIZE);
+            return queueOrWrite(this->buffer+(MQTT_MAX_HEADER_SIZE-hlen), length-(MQTT_MAX_HEADER_SIZE-hlen));
+        }
         return write(header,this->buffer,length-MQTT_MAX_HEADER_SIZE);
     }
     return false;
 }
 
+// Stage a complete wire packet for the coalesced flush, or write it
+// straight through when it does not fit the staging buffer
+boolean PubSubClient::queueOrWrite(uint8_t* packet, uint16_t packetLen) {
+    if (coalesceBuf == NULL) {
+        coalesceBuf = (uint8_t*)malloc(this->bufferSize);
+        if (coalesceBuf == NULL) {
+            uint16_t rc = _client->write(packet, packetLen);
+            lastOutActivity = millis();
+            return rc == packetLen;
+        }
+    }
+    if (coalesceLen + packetLen > this->bufferSize) {
+        flushOutbound();
+    }
+    if (packetLen > this->bufferSize) {
+        // Larger than the staging buffer: single direct write
+        uint16_t rc = _client->write(packet, packetLen);
+        lastOutActivity = millis();
+        return rc == packetLen;
+    }
+    if (coalesceLen == 0) {
+        firstQueuedAt = millis();
+    }
+    memcpy(coalesceBuf + coalesceLen, packet, packetLen);
+    coalesceLen += packetLen;
+    return true;
+}
+
+void PubSubClient::flushOutbound() {
+    if (coalesceLen == 0) {
+        return;
+    }
+    _client->write(coalesceBuf, coalesceLen);
+    coalesceLen = 0;
+    lastOutActivity = millis();
+}
+
+PubSubClient& PubSubClient::setCoalescing(uint16_t windowMs) {
+    if (windowMs == 0) {
+        flushOutbound();
+    }
+    this->coalesceWindowMs = windowMs;
+    return *this;
+}
+
+uint16_t PubSubClient::publishAsync(const char* topic, const char* payload, boolean retained) {
+    return publishAsync(topic,(const uint8_t*)payload, payload ? strnlen(payload, this->bufferSize) : 0,retained);
+}
+
+uint16_t PubSubClient::publishAsync(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
+    if (!connected()) {
+        return 0;
+    }
+    uint16_t tlen = strnlen(topic, this->bufferSize);
+    if (this->bufferSize < MQTT_MAX_HEADER_SIZE + 2+tlen + 2 + 4 + plength) {
+        // Too long
+        return 0;
+    }
+    // Find a free in-flight slot
+    uint8_t slot;
+    for (slot = 0; slot < MQTT_MAX_INFLIGHT; slot++) {
+        if (inflight[slot].packet == NULL) break;
+    }
+    if (slot == MQTT_MAX_INFLIGHT) {
+        return 0; // queue full: caller can retry after loop() drains acks
+    }
+
+    nextMsgId++;
+    if (nextMsgId == 0) {
+        nextMsgId = 1;
+    }
+    uint16_t msgId = nextMsgId;
+
+    // Variable header: topic, then the message id (QoS > 0 only)
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    uint16_t alias = 0;
+    boolean aliasEstablished = false;
+    if (this->useV5) {
+        alias = lookupAlias(topic, &aliasEstablished);
+    }
+    if (aliasEstablished) {
+        length = writeString("",this->buffer,length);
+    } else {
+        length = writeString(topic,this->buffer,length);
+    }
+    this->buffer[length++] = (msgId >> 8);
+    this->buffer[length++] = (msgId & 0xFF);
+    if (this->useV5) {
+        length = appendPublishProps(alias, this->buffer, length);
+    }
+
+    uint16_t i;
+    for (i=0;i<plength;i++) {
+        this->buffer[length++] = payload[i];
+    }
+
+    uint8_t header = MQTTPUBLISH | MQTTQOS1;
+    if (retained) {
+        header |= 1;
+    }
+    uint8_t hlen = buildHeader(header, this->buffer, length-MQTT_MAX_HEADER_SIZE);
+    uint8_t* packetStart = this->buffer+(MQTT_MAX_HEADER_SIZE-hlen);
+    uint16_t packetLen = length-(MQTT_MAX_HEADER_SIZE-hlen);
+
+    // Keep a copy of the wire packet for retransmission
+    uint8_t* copy = (uint8_t*)malloc(packetLen);
+    if (copy == NULL) {
+        return 0;
+    }
+    memcpy(copy, packetStart, packetLen);
+
+    uint16_t rc = _client->write(packetStart, packetLen);
+    lastOutActivity = millis();
+    if (rc != packetLen) {
+        free(copy);
+        return 0;
+    }
+    inflight[slot].packet = copy;
+    inflight[slot].packetLen = packetLen;
+    inflight[slot].msgId = msgId;
+    inflight[slot].sentAt = lastOutActivity;
+    inflight[slot].retries = 0;
+    return msgId;
+}
+
+boolean PubSubClient::publishZeroCopy(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained) {
+    if (!connected()) {
+        return false;
+    }
+    uint16_t tlen = strlen(topic);
+
+    // v5 properties (and possibly an alias standing in for the topic)
+    uint8_t props[4];
+    uint8_t propsLen = 0;
+    if (this->useV5) {
+        boolean aliasEstablished = false;
+        uint16_t alias = lookupAlias(topic, &aliasEstablished);
+        if (aliasEstablished) {
+            tlen = 0;
+        }
+        uint16_t after = appendPublishProps(alias, props, 0);
+        propsLen = (uint8_t)after;
+    }
+
+    // Fixed header + remaining length, built in a stack buffer exactly
+    // like buildHeader lays it out (at the end of the 5 bytes)
+    uint8_t fixed[MQTT_MAX_HEADER_SIZE];
+    uint8_t header = MQTTPUBLISH;
+    if (retained) {
+        header |= 1;
+    }
+    size_t hlen = buildHeader(header, fixed, 2 + tlen + propsLen + plength);
+    unsigned int rc = _client->write(fixed+(MQTT_MAX_HEADER_SIZE-hlen), hlen);
+
+    // Topic length prefix + topic, straight from the caller's string
+    // (length 0 when an established alias replaces it)
+    uint8_t tl[2] = { (uint8_t)(tlen >> 8), (uint8_t)(tlen & 0xFF) };
+    rc += _client->write(tl, 2);
+    if (tlen > 0) {
+        rc += _client->write((const uint8_t*)topic, tlen);
+    }
+    if (propsLen > 0) {
+        rc += _client->write(props, propsLen);
+    }
+
+    // Payload is gathered from the caller's buffer: no intermediate copy
+    rc += _client->write(payload, plength);
+
+    lastOutActivity = millis();
+    return rc == hlen + 2 + tlen + propsLen + plength;
+}
+
 boolean PubSubClient::publish_P(const char* topic, const char* payload, boolean retained) {
     return publish_P(topic, (const uint8_t*)payload, payload ? strnlen(payload, this->bufferSize) : 0, retained);
 }
@@ -498,6 +996,9 @@ boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsig
     }
     this->buffer[pos++] = header;
     len = plength + 2 + tlen;
+    if (this->useV5) {
+        len += 1; // empty properties field (no alias on this rare path)
+    }
     do {
         digit = len  & 127; //digit = len %128
         len >>= 7; //len = len / 128
@@ -509,6 +1010,9 @@ boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsig
     } while(len>0);
 
     pos = writeString(topic,this->buffer,pos);
+    if (this->useV5) {
+        this->buffer[pos++] = 0;
+    }
 
     rc += _client->write(this->buffer,pos);
 
@@ -519,6 +1023,9 @@ boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsig
     lastOutActivity = millis();
 
     expectedLength = 1 + llen + 2 + tlen + plength;
+    if (this->useV5) {
+        expectedLength += 1;
+    }
 
     return (rc == expectedLength);
 }
@@ -527,7 +1034,19 @@ boolean PubSubClient::beginPublish(const char* topic, unsigned int plength, bool
     if (connected()) {
         // Send the header and variable length field
         uint16_t length = MQTT_MAX_HEADER_SIZE;
-        length = writeString(topic,this->buffer,length);
+        uint16_t alias = 0;
+        boolean aliasEstablished = false;
+        if (this->useV5) {
+            alias = lookupAlias(topic, &aliasEstablished);
+        }
+        if (aliasEstablished) {
+            length = writeString("",this->buffer,length);
+        } else {
+            length = writeString(topic,this->buffer,length);
+        }
+        if (this->useV5) {
+            length = appendPublishProps(alias, this->buffer, length);
+        }
         uint8_t header = MQTTPUBLISH;
         if (retained) {
             header |= 1;
@@ -627,6 +1146,9 @@ boolean PubSubClient::subscribe(const char* topic, uint8_t qos) {
         }
         this->buffer[length++] = (nextMsgId >> 8);
         this->buffer[length++] = (nextMsgId & 0xFF);
+        if (this->useV5) {
+            this->buffer[length++] = 0; // no SUBSCRIBE properties
+        }
         length = writeString((char*)topic, this->buffer,length);
         this->buffer[length++] = qos;
         return write(MQTTSUBSCRIBE|MQTTQOS1,this->buffer,length-MQTT_MAX_HEADER_SIZE);
@@ -634,6 +1156,74 @@ boolean PubSubClient::subscribe(const char* topic, uint8_t qos) {
     return false;
 }
 
+boolean PubSubClient::subscribeMany(const char* const* topics, uint8_t count, uint8_t qos) {
+    if (topics == 0 || count == 0) {
+        return false;
+    }
+    if (qos > 1) {
+        return false;
+    }
+    // Every filter costs its length plus the 2-byte length prefix and
+    // the requested-QoS byte; all of them share one packet header
+    size_t needed = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (topics[i] == 0) {
+            return false;
+        }
+        needed += 3 + strnlen(topics[i], this->bufferSize);
+    }
+    if (this->bufferSize < 6 + needed) {
+        // Too long
+        return false;
+    }
+    if (connected()) {
+        uint16_t length = MQTT_MAX_HEADER_SIZE;
+        nextMsgId++;
+        if (nextMsgId == 0) {
+            nextMsgId = 1;
+        }
+        this->buffer[length++] = (nextMsgId >> 8);
+        this->buffer[length++] = (nextMsgId & 0xFF);
+        if (this->useV5) {
+            this->buffer[length++] = 0; // no SUBSCRIBE properties
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            length = writeString(topics[i], this->buffer, length);
+            this->buffer[length++] = qos;
+        }
+        return write(MQTTSUBSCRIBE|MQTTQOS1,this->buffer,length-MQTT_MAX_HEADER_SIZE);
+    }
+    return false;
+}
+
+// Builds "$share/<group>/<topic>" into filter; false when it does not
+// fit. Shared-subscription names may not contain the separators.
+static boolean buildSharedFilter(const char* group, const char* topic, char* filter, size_t cap) {
+    if (group == 0 || topic == 0 || group[0] == 0 ||
+        strchr(group, '/') != 0 || strchr(group, '#') != 0 ||
+        strchr(group, '+') != 0) {
+        return false;
+    }
+    const int written = snprintf(filter, cap, "$share/%s/%s", group, topic);
+    return written > 0 && (size_t)written < cap;
+}
+
+boolean PubSubClient::subscribeShared(const char* group, const char* topic, uint8_t qos) {
+    char filter[128];
+    if (!buildSharedFilter(group, topic, filter, sizeof(filter))) {
+        return false;
+    }
+    return subscribe(filter, qos);
+}
+
+boolean PubSubClient::unsubscribeShared(const char* group, const char* topic) {
+    char filter[128];
+    if (!buildSharedFilter(group, topic, filter, sizeof(filter))) {
+        return false;
+    }
+    return unsubscribe(filter);
+}
+
 boolean PubSubClient::unsubscribe(const char* topic) {
 	size_t topicLength = strnlen(topic, this->bufferSize);
     if (topic == 0) {
@@ -651,6 +1241,9 @@ boolean PubSubClient::unsubscribe(const char* topic) {
         }
         this->buffer[length++] = (nextMsgId >> 8);
         this->buffer[length++] = (nextMsgId & 0xFF);
+        if (this->useV5) {
+            this->buffer[length++] = 0; // no UNSUBSCRIBE properties
+        }
         length = writeString(topic, this->buffer,length);
         return write(MQTTUNSUBSCRIBE|MQTTQOS1,this->buffer,length-MQTT_MAX_HEADER_SIZE);
     }
@@ -658,15 +1251,132 @@ boolean PubSubClient::unsubscribe(const char* topic) {
 }
 
 void PubSubClient::disconnect() {
+    flushOutbound();
+    clearInflight();
     this->buffer[0] = MQTTDISCONNECT;
     this->buffer[1] = 0;
     _client->write(this->buffer,2);
     _state = MQTT_DISCONNECTED;
     _client->flush();
-    _client->stop();
+    if (!reuseTransport) {
+        // With transport reuse the (potentially TLS) socket stays open so
+        // the next connect() skips the full handshake
+        _client->stop();
+    }
     lastInActivity = lastOutActivity = millis();
 }
 
+PubSubClient& PubSubClient::setReuseTransport(boolean reuse) {
+    this->reuseTransport = reuse;
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCleanSession(boolean cleanSession) {
+    this->cleanSession = cleanSession;
+    return *this;
+}
+
+boolean PubSubClient::sessionPresent() {
+    return this->sessionPresentFlag;
+}
+
+PubSubClient& PubSubClient::setMqttVersion5(boolean enable) {
+    this->useV5 = enable;
+    return *this;
+}
+
+uint8_t PubSubClient::reasonCode() {
+    return this->lastReasonCode;
+}
+
+// Find (or assign) the outbound alias for a topic. *established tells
+// the caller whether the broker already knows the mapping: the first
+// publish still carries the full topic alongside the alias property,
+// every later one replaces the topic with an empty string.
+uint16_t PubSubClient::lookupAlias(const char* topic, boolean* established) {
+    *established = false;
+    if (this->brokerAliasMax == 0) {
+        return 0;
+    }
+    uint8_t i;
+    for (i = 0; i < MQTT_TOPIC_ALIASES; i++) {
+        if (aliasTable[i].alias != 0 &&
+            strncmp(aliasTable[i].topic, topic, MQTT_TOPIC_ALIAS_MAXLEN) == 0) {
+            *established = true;
+            return aliasTable[i].alias;
+        }
+    }
+    if (strlen(topic) >= MQTT_TOPIC_ALIAS_MAXLEN) {
+        return 0;
+    }
+    for (i = 0; i < MQTT_TOPIC_ALIASES; i++) {
+        if (aliasTable[i].alias == 0 && nextAlias <= this->brokerAliasMax) {
+            strncpy(aliasTable[i].topic, topic, MQTT_TOPIC_ALIAS_MAXLEN-1);
+            aliasTable[i].topic[MQTT_TOPIC_ALIAS_MAXLEN-1] = 0;
+            aliasTable[i].alias = nextAlias++;
+            return aliasTable[i].alias;
+        }
+    }
+    // Table or broker budget exhausted: this topic publishes in full
+    return 0;
+}
+
+void PubSubClient::clearAliases() {
+    for (uint8_t i = 0; i < MQTT_TOPIC_ALIASES; i++) {
+        aliasTable[i].alias = 0;
+    }
+    nextAlias = 1;
+}
+
+// Append the v5 PUBLISH properties: just the Topic Alias when one is
+// assigned, otherwise an empty properties field
+uint16_t PubSubClient::appendPublishProps(uint16_t alias, uint8_t* buf, uint16_t pos) {
+    if (alias == 0) {
+        buf[pos++] = 0;
+        return pos;
+    }
+    buf[pos++] = 3;     // properties length
+    buf[pos++] = 0x23;  // Topic Alias
+    buf[pos++] = (alias >> 8);
+    buf[pos++] = (alias & 0xFF);
+    return pos;
+}
+
+void PubSubClient::recordCallbackUs(const char* topic, uint32_t us) {
+    uint8_t slot = 0;
+    for (; slot < rxStatsUsed; slot++) {
+        if (strncmp(rxTopicStatTable[slot].topic, topic, sizeof(rxTopicStatTable[slot].topic)) == 0) {
+            break;
+        }
+    }
+    if (slot == rxStatsUsed) {
+        if (rxStatsUsed < MQTT_RX_STATS_TOPICS) {
+            strncpy(rxTopicStatTable[slot].topic, topic, sizeof(rxTopicStatTable[slot].topic)-1);
+            rxStatsUsed++;
+        } else {
+            // Table full: everything else shares the last slot
+            slot = MQTT_RX_STATS_TOPICS - 1;
+        }
+    }
+    MqttRxTopicStat& stat = rxTopicStatTable[slot];
+    stat.count++;
+    stat.totalUs += us;
+    if (us > stat.maxUs) stat.maxUs = us;
+}
+
+uint8_t PubSubClient::rxStatsCount() {
+    return rxStatsUsed;
+}
+
+const MqttRxTopicStat& PubSubClient::rxTopicStat(uint8_t index) {
+    return rxTopicStatTable[index];
+}
+
+void PubSubClient::clearRxStats() {
+    memset(rxTopicStatTable, 0, sizeof(rxTopicStatTable));
+    rxStatsUsed = 0;
+}
+
 uint16_t PubSubClient::writeString(const char* string, uint8_t* buf, uint16_t pos) {
     const char* idp = string;
     uint16_t i = 0;
@@ -756,6 +1466,30 @@ boolean PubSubClient::setBufferSize(uint16_t size) {
     return (this->buffer != NULL);
 }
 
+PubSubClient& PubSubClient::setBufferElastic(uint16_t floorSize, uint16_t ceilingSize) {
+    if (floorSize == 0 || ceilingSize < floorSize) {
+        return *this;
+    }
+    this->bufferFloor = floorSize;
+    this->bufferCeiling = ceilingSize;
+    if (this->bufferSize != floorSize) {
+        setBufferSize(floorSize);
+    }
+    return *this;
+}
+
+// Release a grown elastic buffer once nothing has needed it for a
+// while. Runs from loop(), strictly between packets, so no in-flight
+// read is holding a pointer into the old allocation.
+void PubSubClient::shrinkBufferIfIdle() {
+    if (this->bufferCeiling == 0 || this->bufferSize <= this->bufferFloor) {
+        return;
+    }
+    if (millis() - this->lastOversizeAt >= MQTT_BUFFER_SHRINK_IDLE_MS) {
+        setBufferSize(this->bufferFloor);
+    }
+}
+
 uint16_t PubSubClient::getBufferSize() {
     return this->bufferSize;
 }
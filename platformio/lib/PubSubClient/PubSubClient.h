@@ -14,9 +14,12 @@
 
 #define MQTT_VERSION_3_1      3
 #define MQTT_VERSION_3_1_1    4
+#define MQTT_VERSION_5        5
 
 // MQTT_VERSION : Pick the version
 //#define MQTT_VERSION MQTT_VERSION_3_1
+// (MQTT 5 is selected at runtime with setMqttVersion5(), because the
+// same image may talk to both v5 and 3.1.1 brokers)
 #ifndef MQTT_VERSION
 #define MQTT_VERSION MQTT_VERSION_3_1_1
 #endif
@@ -42,6 +45,7 @@
 //#define MQTT_MAX_TRANSFER_SIZE 80
 
 // Possible values for client.state()
+#define MQTT_CONNECT_IN_PROGRESS    -5
 #define MQTT_CONNECTION_TIMEOUT     -4
 #define MQTT_CONNECTION_LOST        -3
 #define MQTT_CONNECT_FAILED         -2
@@ -76,11 +80,67 @@
 // Maximum size of fixed header and variable length size header
 #define MQTT_MAX_HEADER_SIZE 5
 
+// MQTT_MAX_INFLIGHT : number of unacknowledged QoS 1 messages kept for
+// retransmission at any one time (see publishAsync)
+#ifndef MQTT_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT 4
+#endif
+
+// MQTT_QOS1_RETRY_MS : how long to wait for a PUBACK before the message
+// is retransmitted with the DUP flag set
+#ifndef MQTT_QOS1_RETRY_MS
+#define MQTT_QOS1_RETRY_MS 5000
+#endif
+
+// MQTT_QOS1_MAX_RETRIES : give up (and free the slot) after this many
+// retransmissions of the same message
+#ifndef MQTT_QOS1_MAX_RETRIES
+#define MQTT_QOS1_MAX_RETRIES 3
+#endif
+
+// MQTT_BUFFER_SHRINK_IDLE_MS : with setBufferElastic(), how long the
+// grown buffer is kept after the last packet that needed it before it
+// is released back down to the floor size
+#ifndef MQTT_BUFFER_SHRINK_IDLE_MS
+#define MQTT_BUFFER_SHRINK_IDLE_MS 30000
+#endif
+
+// MQTT_RX_STATS_TOPICS : distinct topics tracked by the receive-path
+// profiler; messages on further topics aggregate into the last slot
+#ifndef MQTT_RX_STATS_TOPICS
+#define MQTT_RX_STATS_TOPICS 6
+#endif
+
+// MQTT_TOPIC_ALIASES : outbound topic->alias table size in MQTT 5 mode.
+// We publish to a handful of fixed topics, so a few slots cover them all;
+// topics beyond the table (or the broker's alias budget) simply go out
+// in full.
+#ifndef MQTT_TOPIC_ALIASES
+#define MQTT_TOPIC_ALIASES 4
+#endif
+
+// MQTT_TOPIC_ALIAS_MAXLEN : longest topic eligible for an alias
+#ifndef MQTT_TOPIC_ALIAS_MAXLEN
+#define MQTT_TOPIC_ALIAS_MAXLEN 40
+#endif
+
+// Per-topic receive-path budget: every callback invocation from loop()
+// is timed, because the callback runs synchronously and a slow handler
+// delays keepalives and every other inbound packet
+struct MqttRxTopicStat {
+    char topic[24];
+    uint32_t count;
+    uint32_t totalUs;
+    uint32_t maxUs;
+};
+
 #if defined(ESP8266) || defined(ESP32)
 #include <functional>
 #define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+#define MQTT_CONNECT_CALLBACK_SIGNATURE std::function<void(boolean)> connectCallback
 #else
 #define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
+#define MQTT_CONNECT_CALLBACK_SIGNATURE void (*connectCallback)(boolean)
 #endif
 
 #define CHECK_STRING_LENGTH(l,s) if (l+2+strnlen(s, this->bufferSize) > this->bufferSize) {_client->stop();return false;}
@@ -97,6 +157,12 @@ private:
    unsigned long lastInActivity;
    bool pingOutstanding;
    MQTT_CALLBACK_SIGNATURE;
+   MQTT_CONNECT_CALLBACK_SIGNATURE = NULL;
+   // Non-blocking connect (see connectAsync): when the CONNECT packet
+   // went out, this is when, so loop() can time out the CONNACK wait
+   unsigned long connectStartedAt = 0;
+   boolean sendConnect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession);
+   boolean processConnack(uint32_t len);
    uint32_t readPacket(uint8_t*);
    boolean readByte(uint8_t * result);
    boolean readByte(uint8_t * result, uint16_t * index);
@@ -107,6 +173,53 @@ private:
    // Note: the header is built at the end of the first MQTT_MAX_HEADER_SIZE bytes, so will start
    //       (MQTT_MAX_HEADER_SIZE - <returned size>) bytes into the buffer
    size_t buildHeader(uint8_t header, uint8_t* buf, uint16_t length);
+   // QoS 1 in-flight queue: each slot owns a heap copy of the full wire
+   // packet so a retransmit is a single write with the DUP bit set
+   struct InflightMessage {
+       uint8_t* packet = NULL;
+       uint16_t packetLen = 0;
+       uint16_t msgId = 0;
+       unsigned long sentAt = 0;
+       uint8_t retries = 0;
+   };
+   InflightMessage inflight[MQTT_MAX_INFLIGHT];
+   void handlePuback(uint16_t msgId);
+   void retryInflight();
+   void clearInflight();
+   // Outbound coalescing (Nagle-style): publishes within the window are
+   // staged here and flushed as one socket write
+   uint8_t* coalesceBuf = NULL;
+   uint16_t coalesceLen = 0;
+   uint16_t coalesceWindowMs = 0;
+   unsigned long firstQueuedAt = 0;
+   boolean reuseTransport = false;
+   boolean cleanSession = true;
+   boolean sessionPresentFlag = false;
+   boolean queueOrWrite(uint8_t* packet, uint16_t packetLen);
+   MqttRxTopicStat rxTopicStatTable[MQTT_RX_STATS_TOPICS] = {};
+   uint8_t rxStatsUsed = 0;
+   void recordCallbackUs(const char* topic, uint32_t us);
+   // MQTT 5 session state (see setMqttVersion5). Aliases are strictly
+   // per-connection: the table is cleared on every successful connect
+   // and re-established lazily by the first publish to each topic.
+   boolean useV5 = false;
+   uint16_t brokerAliasMax = 0;
+   uint8_t lastReasonCode = 0;
+   struct TopicAliasEntry {
+       char topic[MQTT_TOPIC_ALIAS_MAXLEN];
+       uint16_t alias = 0;  // 0 = slot free
+   };
+   TopicAliasEntry aliasTable[MQTT_TOPIC_ALIASES];
+   uint16_t nextAlias = 1;
+   uint16_t lookupAlias(const char* topic, boolean* established);
+   void clearAliases();
+   // Elastic receive buffer (see setBufferElastic): ceiling 0 means the
+   // feature is off and bufferSize is fixed as before
+   uint16_t bufferFloor = 0;
+   uint16_t bufferCeiling = 0;
+   unsigned long lastOversizeAt = 0;
+   void shrinkBufferIfIdle();
+   uint16_t appendPublishProps(uint16_t alias, uint8_t* buf, uint16_t pos);
    IPAddress ip;
    const char* domain;
    uint16_t port;
@@ -141,12 +254,32 @@ public:
 
    boolean setBufferSize(uint16_t size);
    uint16_t getBufferSize();
+   // Elastic receive buffer: the buffer starts (and idles) at floorSize
+   // and grows on demand, at the moment an inbound fixed header
+   // announces a remaining length that does not fit, up to ceilingSize.
+   // Once nothing oversized has arrived for MQTT_BUFFER_SHRINK_IDLE_MS
+   // the buffer is released back to the floor in loop(). Sensor-only
+   // nodes thus pay for a big buffer only while an OTA push or fat RPC
+   // is actually in flight.
+   PubSubClient& setBufferElastic(uint16_t floorSize, uint16_t ceilingSize);
 
    boolean connect(const char* id);
    boolean connect(const char* id, const char* user, const char* pass);
    boolean connect(const char* id, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage);
    boolean connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage);
    boolean connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession);
+   // Non-blocking connect: opens the transport, sends CONNECT and
+   // returns immediately; the CONNACK is consumed by loop(), which
+   // flips state() to MQTT_CONNECTED (or a failure code after the
+   // socket timeout) and fires the setConnectCallback hook if one is
+   // set. Returns false only when the transport could not be opened.
+   // While connecting() is true, keep calling loop(); publishes fail
+   // cleanly until the handshake completes, so callers keep sampling
+   // instead of blocking up to the socket timeout like connect() does.
+   boolean connectAsync(const char* id);
+   boolean connectAsync(const char* id, const char* user, const char* pass);
+   boolean connecting();
+   PubSubClient& setConnectCallback(MQTT_CONNECT_CALLBACK_SIGNATURE);
    void disconnect();
    boolean publish(const char* topic, const char* payload);
    boolean publish(const char* topic, const char* payload, boolean retained);
@@ -154,6 +287,54 @@ public:
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
    boolean publish_P(const char* topic, const char* payload, boolean retained);
    boolean publish_P(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
+   // Publish with QoS 1: the message is written once and queued for
+   // retransmission until the broker acknowledges it with a PUBACK
+   // (tracked inside loop()). Returns the message id (>0) on success or
+   // 0 when the in-flight queue is full / not connected.
+   // Unlike publish(), the caller does not wait for any acknowledgment.
+   uint16_t publishAsync(const char* topic, const char* payload, boolean retained = false);
+   uint16_t publishAsync(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained = false);
+   // Number of QoS 1 messages still waiting for a PUBACK
+   uint8_t inflightCount();
+   // Zero-copy publish: the fixed header and topic are assembled in a
+   // small stack buffer and the payload is streamed to the socket
+   // straight from the caller's memory. No copy into the internal
+   // buffer, and the payload is not capped by bufferSize.
+   boolean publishZeroCopy(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained = false);
+   // Coalesce outbound publishes: messages published within windowMs of
+   // each other are merged into a single socket write (one TCP segment,
+   // one radio wakeup). 0 disables staging (default). Flushing happens
+   // in loop(), on a full staging buffer, or via flushOutbound().
+   PubSubClient& setCoalescing(uint16_t windowMs);
+   // Force out anything staged by setCoalescing
+   void flushOutbound();
+   // Keep the transport (e.g. an established TLS connection) open across
+   // MQTT-level disconnects. The next connect() then reuses the warm
+   // socket and skips the TCP+TLS handshake entirely.
+   PubSubClient& setReuseTransport(boolean reuse);
+   // Request a persistent session (clean-session=false) on the next
+   // connect(): the broker then keeps our subscriptions and queued QoS 1
+   // messages across reconnects, so no resubscription round trips
+   PubSubClient& setCleanSession(boolean cleanSession);
+   // Whether the broker resumed a previous session on the last CONNACK
+   // (only meaningful with clean-session=false)
+   boolean sessionPresent();
+   // Speak MQTT 5 on the next connect(). Publishes to recurring topics
+   // then carry a 2-byte topic alias instead of the full topic string
+   // (negotiated against the broker's Topic Alias Maximum from the
+   // CONNACK), and reasonCode() reports v5 reason codes for smarter
+   // reconnect decisions. With 25-40 byte topics at our publish rates
+   // this trims a measurable slice of steady-state airtime.
+   PubSubClient& setMqttVersion5(boolean enable);
+   // Reason code from the last CONNACK or server DISCONNECT (0x00 =
+   // success; only meaningful in MQTT 5 mode)
+   uint8_t reasonCode();
+   // Receive-path profiler: per-topic count/total/max of the time spent
+   // inside the application callback (RPC dispatch, attribute parsing).
+   // Read the slots, report, then clearRxStats() for interval stats.
+   uint8_t rxStatsCount();
+   const MqttRxTopicStat& rxTopicStat(uint8_t index);
+   void clearRxStats();
    // Start to publish a message.
    // This API:
    //   beginPublish(...)
@@ -173,6 +354,17 @@ public:
    virtual size_t write(const uint8_t *buffer, size_t size);
    boolean subscribe(const char* topic);
    boolean subscribe(const char* topic, uint8_t qos);
+   // Subscribe to several topic filters with a single SUBSCRIBE packet
+   // (one round trip and one SUBACK instead of one per filter)
+   boolean subscribeMany(const char* const* topics, uint8_t count, uint8_t qos);
+   // Shared subscription: joins $share/<group>/<topic>, so the broker
+   // delivers each matching message to exactly one member of the group
+   // instead of every subscriber — several consumers split a topic's
+   // traffic with broker-managed balancing. MQTT 5 semantics, but the
+   // prefix is plain topic-filter syntax, so brokers honouring the
+   // convention (brokerd does) balance 3.1.1 clients the same way.
+   boolean subscribeShared(const char* group, const char* topic, uint8_t qos = 0);
+   boolean unsubscribeShared(const char* group, const char* topic);
    boolean unsubscribe(const char* topic);
    boolean loop();
    boolean connected();
@@ -35,6 +35,18 @@ void Arduino_MQTT_Client::set_server(const char *domain, const uint16_t& port) {
     m_mqtt_client.setServer(domain, port);
 }
 
+void Arduino_MQTT_Client::set_reuse_transport(const bool& reuse) {
+    m_mqtt_client.setReuseTransport(reuse);
+}
+
+void Arduino_MQTT_Client::set_clean_session(const bool& clean_session) {
+    m_mqtt_client.setCleanSession(clean_session);
+}
+
+bool Arduino_MQTT_Client::session_present() {
+    return m_mqtt_client.sessionPresent();
+}
+
 bool Arduino_MQTT_Client::connect(const char *client_id, const char *user_name, const char *password) {
     return m_mqtt_client.connect(client_id, user_name, password);
 }
@@ -55,6 +67,10 @@ bool Arduino_MQTT_Client::subscribe(const char *topic) {
     return m_mqtt_client.subscribe(topic);
 }
 
+bool Arduino_MQTT_Client::subscribe_many(const char* const* topics, const size_t& count) {
+    return m_mqtt_client.subscribeMany(topics, static_cast<uint8_t>(count), 0U);
+}
+
 bool Arduino_MQTT_Client::unsubscribe(const char *topic) {
     return m_mqtt_client.unsubscribe(topic);
 }
@@ -63,6 +79,10 @@ bool Arduino_MQTT_Client::connected() {
     return m_mqtt_client.connected();
 }
 
+PubSubClient& Arduino_MQTT_Client::get_client() {
+    return m_mqtt_client;
+}
+
 #if THINGSBOARD_ENABLE_STREAM_UTILS
 
 bool Arduino_MQTT_Client::begin_publish(const char *topic, const size_t& length) {
@@ -35,6 +35,16 @@ class Arduino_MQTT_Client : public IMQTT_Client {
 
     void set_server(const char *domain, const uint16_t& port) override;
 
+    /// @brief Keeps the underlying transport connection (TCP or TLS) open across MQTT-level disconnects,
+    /// so a reconnect reuses the already established, possibly expensive to create, encrypted connection
+    /// instead of paying the full TCP + TLS handshake (2-4 seconds on the ESP32) again
+    /// @param reuse Whether the transport connection should be kept open on disconnect or not
+    void set_reuse_transport(const bool& reuse);
+
+    void set_clean_session(const bool& clean_session) override;
+
+    bool session_present() override;
+
     bool connect(const char *client_id, const char *user_name, const char *password) override;
 
     void disconnect() override;
@@ -45,10 +55,18 @@ class Arduino_MQTT_Client : public IMQTT_Client {
 
     bool subscribe(const char *topic) override;
 
+    /// @brief Batches all given topic filters into one SUBSCRIBE packet via PubSubClient
+    bool subscribe_many(const char* const* topics, const size_t& count) override;
+
     bool unsubscribe(const char *topic) override;
 
     bool connected() override;
 
+    /// @brief Gives access to the underlying PubSubClient instance, used by the
+    /// diagnostics path to read and reset the receive-path profiler statistics
+    /// @return Reference to the wrapped MQTT client
+    PubSubClient& get_client();
+
 #if THINGSBOARD_ENABLE_STREAM_UTILS
 
     bool begin_publish(const char *topic, const size_t& length) override;
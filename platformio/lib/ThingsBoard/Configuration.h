@@ -99,6 +99,25 @@
 #    define THINGSBOARD_USE_MBED_TLS 0
 #  endif
 
+// Use the esp32/sha header internally for hashing received binary ota update data with the hardware SHA peripheral, as long as the header exists,
+// because hashing each received firmware chunk in hardware is much faster than the software mbedtls implementation
+// and no longer competes with the flash writes and MQTT servicing for CPU time during an ongoing ota update.
+// Only the classic ESP32 exposes this block based engine interface, on other chips the header does not exist and the mbedtls implementation is used,
+// which on those chips already dispatches to their respective hardware engine internally.
+#  ifdef __has_include
+#    if  __has_include(<esp32/sha.h>)
+#      ifndef THINGSBOARD_USE_ESP_SHA
+#        define THINGSBOARD_USE_ESP_SHA 1
+#      endif
+#    else
+#      ifndef THINGSBOARD_USE_ESP_SHA
+#        define THINGSBOARD_USE_ESP_SHA 0
+#      endif
+#    endif
+#  else
+#    define THINGSBOARD_USE_ESP_SHA 0
+#  endif
+
 // Use the esp_ota_ops header internally for handling the writing of ota update data, as long as the header exists,
 // to allow users that do have the needed component to use the Espressif_Updater instead of only the Arduino_ESP32_Updater.
 #  ifdef __has_include
@@ -169,6 +188,48 @@
 #    define THINGSBOARD_ENABLE_STREAM_UTILS 0
 #  endif
 
+// Enables direct serialization of every json message straight into the MQTT packet being assembled (beginPublish/write/endPublish),
+// instead of only using that path as a fallback for messages bigger than the internal client buffer.
+// Removes the intermediate char json[] buffer allocation (stack or heap) and the copy into the client buffer for every single send,
+// at the cost of slightly increased send times, because the message is streamed in smaller packets.
+// Requires THINGSBOARD_ENABLE_STREAM_UTILS, because the same Print based serialization plumbing is used.
+#  ifndef THINGSBOARD_ENABLE_DIRECT_SERIALIZATION
+#    define THINGSBOARD_ENABLE_DIRECT_SERIALIZATION 0
+#  endif
+
+// Enables serializing telemetry, attribute and RPC response payloads as MsgPack instead of json text,
+// using the serializeMsgPack support already included in ArduinoJson. Payloads are typically 40-60% smaller,
+// which directly reduces radio airtime on congested bands, but the broker/server must be configured to accept MsgPack.
+// The receive direction stays json, because the server continues to send json formatted RPC requests and attribute updates.
+#  ifndef THINGSBOARD_ENABLE_MSGPACK
+#    define THINGSBOARD_ENABLE_MSGPACK 0
+#  endif
+
+// Enables a client-side cache of the last received shared attribute values, keyed by a hash of the attribute name.
+// Incoming shared attribute updates are then filtered against the cache and the subscribed callbacks are only invoked
+// with the attributes whose values actually changed, instead of re-delivering the complete attribute set on every update.
+// Cuts the JSON handling and callback work inside the MQTT receive path down to the actual delta,
+// at the cost of a small amount of ram for the cache entries (two 32 bit hashes per tracked attribute).
+#  ifndef THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
+#    define THINGSBOARD_ENABLE_ATTRIBUTE_DELTA 0
+#  endif
+
+// Amount of shared attributes the delta cache can track at once, only used if THINGSBOARD_ENABLE_ATTRIBUTE_DELTA is enabled.
+// If more distinct attributes are received than fit into the cache, the oldest entry is replaced,
+// which can only ever cause an unchanged value to be delivered again, never a changed value to be dropped.
+#  ifndef THINGSBOARD_ATTRIBUTE_CACHE_SIZE
+#    define THINGSBOARD_ATTRIBUTE_CACHE_SIZE 16
+#  endif
+
+// Enables backing the JsonDocument built for aggregated telemetry and attribute sends with a preallocated slab,
+// that is reused across send cycles, instead of allocating a new DynamicJsonDocument from the heap for every single send.
+// Removes the constant heap churn a periodic telemetry cadence otherwise causes, driving steady-state telemetry allocations to zero.
+// Falls back to the heap transparently if the slab is occupied or the message is bigger than THINGSBOARD_TELEMETRY_POOL_SIZE.
+// Requires THINGSBOARD_ENABLE_DYNAMIC, because without it the JsonDocument is allocated on the stack already and no heap allocation occurs.
+#  ifndef THINGSBOARD_ENABLE_TELEMETRY_POOL
+#    define THINGSBOARD_ENABLE_TELEMETRY_POOL 0
+#  endif
+
 // Enables the ThingsBoard class to save the allocated memory of the DynamicJsonDocument into psram instead of onto the sram.
 // Enabled by default if THINGSBOARD_ENABLE_DYNAMIC has been set and the esp_heap_caps header exists, because it requries DynamicJsonDocument to work.
 // If enabled the program might be slightly slower, but all the memory will be placed onto psram instead of sram, meaning the sram can be allocated for other things.
@@ -31,6 +31,9 @@ class ThingsBoardDefaultLogger;
 #ifndef strncmp_P
 #define strncmp_P   strncmp
 #endif // strncmp_P
+#ifndef memcpy_P
+#define memcpy_P    memcpy
+#endif // memcpy_P
 #endif // THINGSBOARD_ENABLE_PROGMEM
 
 
@@ -80,4 +83,68 @@ using TBJsonDocument = BasicJsonDocument<SpiRamAllocator>;
 using TBJsonDocument = DynamicJsonDocument;
 #endif
 
+#if THINGSBOARD_ENABLE_TELEMETRY_POOL && THINGSBOARD_ENABLE_DYNAMIC
+#include <stdlib.h>
+#include <string.h>
+
+// Size in bytes of the preallocated slab the telemetry JsonDocument is constructed over,
+// has to be big enough to hold JSON_OBJECT_SIZE() of the amount of key-value pairs sent at once.
+#ifndef THINGSBOARD_TELEMETRY_POOL_SIZE
+#define THINGSBOARD_TELEMETRY_POOL_SIZE 512
+#endif // THINGSBOARD_TELEMETRY_POOL_SIZE
+
+/// @brief Arena allocator handing out memory from a preallocated static slab,
+/// that is reused across telemetry send cycles instead of allocating from the heap for every single send.
+/// If the slab is already occupied or the requested size exceeds the slab, the allocation transparently falls back to the heap,
+/// meaning sending still succeeds, it simply costs one heap allocation like it previously always did
+struct TelemetryPoolAllocator {
+  void* allocate(size_t size) {
+    if (size <= THINGSBOARD_TELEMETRY_POOL_SIZE && !pool_used()) {
+      pool_used() = true;
+      return pool();
+    }
+    return malloc(size);
+  }
+
+  void deallocate(void* pointer) {
+    if (pointer == pool()) {
+      pool_used() = false;
+      return;
+    }
+    free(pointer);
+  }
+
+  void* reallocate(void* ptr, size_t new_size) {
+    if (ptr != pool()) {
+      return realloc(ptr, new_size);
+    }
+    if (new_size <= THINGSBOARD_TELEMETRY_POOL_SIZE) {
+      return ptr;
+    }
+    // Document outgrew the slab, move the content onto the heap and release the slab for the next send
+    void* grown = malloc(new_size);
+    if (grown != nullptr) {
+      memcpy(grown, pool(), THINGSBOARD_TELEMETRY_POOL_SIZE);
+      pool_used() = false;
+    }
+    return grown;
+  }
+
+ private:
+  // Function local statics are used, because this header is included from multiple translation units
+  // and they remove the need for an additional source file containing the out-of-line definitions
+  static uint8_t* pool() {
+    static uint8_t slab[THINGSBOARD_TELEMETRY_POOL_SIZE];
+    return slab;
+  }
+
+  static bool& pool_used() {
+    static bool used = false;
+    return used;
+  }
+};
+
+using TBTelemetryDocument = BasicJsonDocument<TelemetryPoolAllocator>;
+#endif // THINGSBOARD_ENABLE_TELEMETRY_POOL && THINGSBOARD_ENABLE_DYNAMIC
+
 #endif // Constants_h
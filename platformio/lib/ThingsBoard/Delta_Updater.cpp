@@ -0,0 +1,245 @@
+// Header include.
+#include "Delta_Updater.h"
+
+#if THINGSBOARD_ENABLE_OTA
+
+#if THINGSBOARD_USE_ESP_PARTITION
+
+// Library includes.
+#include <esp_ota_ops.h>
+#include <string.h>
+
+// Magic the transferred stream has to start with to be treated as a delta patch instead of a full firmware image.
+constexpr char DELTA_MAGIC[8] = {'T', 'B', 'D', 'E', 'L', 'T', 'A', '1'};
+// Opcodes of the records a delta patch consists of.
+constexpr uint8_t DELTA_OPCODE_DATA = 0x00U;
+constexpr uint8_t DELTA_OPCODE_COPY = 0x01U;
+// Amount of bytes read from the running partition at once when applying a copy record.
+constexpr size_t DELTA_COPY_BUFFER_SIZE = 256U;
+
+/// @brief Reads a 32 bit little endian value from the given buffer position
+/// @param buffer Buffer the value is read from
+/// @return Decoded 32 bit value
+static size_t read_uint32_le(const uint8_t *buffer) {
+    return static_cast<size_t>(buffer[0])
+         | (static_cast<size_t>(buffer[1]) << 8U)
+         | (static_cast<size_t>(buffer[2]) << 16U)
+         | (static_cast<size_t>(buffer[3]) << 24U);
+}
+
+Delta_Updater::Delta_Updater(IUpdater *target_updater) :
+    m_target_updater(target_updater),
+    m_source_partition(nullptr),
+    m_state(State::STATE_MAGIC),
+    m_header_buffer(),
+    m_header_fill(0U),
+    m_remaining_data(0U),
+    m_patch_size(0U),
+    m_target_begun(false)
+{
+    // Nothing to do
+}
+
+bool Delta_Updater::begin(const size_t& firmware_size) {
+    if (m_target_updater == nullptr) {
+        return false;
+    }
+
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (running == nullptr) {
+        return false;
+    }
+
+    m_source_partition = running;
+    m_state = State::STATE_MAGIC;
+    m_header_fill = 0U;
+    m_remaining_data = 0U;
+    m_patch_size = firmware_size;
+    m_target_begun = false;
+    // Initializing the wrapped updater is deferred until we know whether the stream is a delta patch,
+    // because for a patch the total size of the reconstructed image is part of the patch header
+    return true;
+}
+
+size_t Delta_Updater::write(uint8_t* payload, const size_t& total_bytes) {
+    size_t offset = 0U;
+
+    while (offset < total_bytes) {
+        switch (m_state) {
+            case State::STATE_MAGIC: {
+                m_header_buffer[m_header_fill] = payload[offset];
+                m_header_fill++;
+                offset++;
+                if (m_header_fill < sizeof(DELTA_MAGIC)) {
+                    break;
+                }
+                if (memcmp(m_header_buffer, DELTA_MAGIC, sizeof(DELTA_MAGIC)) == 0) {
+                    m_header_fill = 0U;
+                    m_state = State::STATE_TARGET_SIZE;
+                    break;
+                }
+                // No magic, the stream is a regular full firmware image,
+                // initialize the wrapped updater with the complete transferred size and forward the already consumed bytes
+                if (!begin_target(m_patch_size)) {
+                    m_state = State::STATE_FAILED;
+                    return 0U;
+                }
+                if (m_target_updater->write(m_header_buffer, sizeof(DELTA_MAGIC)) != sizeof(DELTA_MAGIC)) {
+                    m_state = State::STATE_FAILED;
+                    return 0U;
+                }
+                m_state = State::STATE_PASSTHROUGH;
+                break;
+            }
+            case State::STATE_TARGET_SIZE: {
+                m_header_buffer[m_header_fill] = payload[offset];
+                m_header_fill++;
+                offset++;
+                if (m_header_fill < 4U) {
+                    break;
+                }
+                if (!begin_target(read_uint32_le(m_header_buffer))) {
+                    m_state = State::STATE_FAILED;
+                    return 0U;
+                }
+                m_header_fill = 0U;
+                m_state = State::STATE_OPCODE;
+                break;
+            }
+            case State::STATE_OPCODE: {
+                const uint8_t opcode = payload[offset];
+                offset++;
+                m_header_fill = 0U;
+                if (opcode == DELTA_OPCODE_DATA) {
+                    m_state = State::STATE_DATA_HEADER;
+                }
+                else if (opcode == DELTA_OPCODE_COPY) {
+                    m_state = State::STATE_COPY_HEADER;
+                }
+                else {
+                    m_state = State::STATE_FAILED;
+                    return 0U;
+                }
+                break;
+            }
+            case State::STATE_DATA_HEADER: {
+                m_header_buffer[m_header_fill] = payload[offset];
+                m_header_fill++;
+                offset++;
+                if (m_header_fill < 4U) {
+                    break;
+                }
+                m_remaining_data = read_uint32_le(m_header_buffer);
+                m_header_fill = 0U;
+                m_state = (m_remaining_data != 0U) ? State::STATE_DATA : State::STATE_OPCODE;
+                break;
+            }
+            case State::STATE_DATA: {
+                // Forward as many literal bytes as are available in the current packet in one write call
+                size_t writable = total_bytes - offset;
+                if (writable > m_remaining_data) {
+                    writable = m_remaining_data;
+                }
+                if (m_target_updater->write(&payload[offset], writable) != writable) {
+                    m_state = State::STATE_FAILED;
+                    return 0U;
+                }
+                offset += writable;
+                m_remaining_data -= writable;
+                if (m_remaining_data == 0U) {
+                    m_state = State::STATE_OPCODE;
+                }
+                break;
+            }
+            case State::STATE_COPY_HEADER: {
+                m_header_buffer[m_header_fill] = payload[offset];
+                m_header_fill++;
+                offset++;
+                if (m_header_fill < 8U) {
+                    break;
+                }
+                const size_t source_offset = read_uint32_le(m_header_buffer);
+                const size_t length = read_uint32_le(&m_header_buffer[4]);
+                if (!apply_copy_record(source_offset, length)) {
+                    m_state = State::STATE_FAILED;
+                    return 0U;
+                }
+                m_header_fill = 0U;
+                m_state = State::STATE_OPCODE;
+                break;
+            }
+            case State::STATE_PASSTHROUGH: {
+                const size_t writable = total_bytes - offset;
+                if (m_target_updater->write(&payload[offset], writable) != writable) {
+                    m_state = State::STATE_FAILED;
+                    return 0U;
+                }
+                offset += writable;
+                break;
+            }
+            case State::STATE_FAILED:
+            default:
+                return 0U;
+        }
+    }
+
+    return total_bytes;
+}
+
+void Delta_Updater::reset() {
+    if (m_target_begun) {
+        m_target_updater->reset();
+    }
+    m_state = State::STATE_MAGIC;
+    m_header_fill = 0U;
+    m_remaining_data = 0U;
+    m_target_begun = false;
+}
+
+bool Delta_Updater::end() {
+    // The patch has to end exactly on a record boundary and every literal byte has to have been received,
+    // otherwise the transferred patch was truncated or malformed and the reconstructed image must not be booted
+    if (!m_target_begun || (m_state != State::STATE_OPCODE && m_state != State::STATE_PASSTHROUGH)) {
+        return false;
+    }
+    return m_target_updater->end();
+}
+
+bool Delta_Updater::apply_copy_record(const size_t& source_offset, const size_t& length) {
+    const esp_partition_t *source = static_cast<const esp_partition_t*>(m_source_partition);
+    if (source_offset + length > source->size) {
+        return false;
+    }
+
+    uint8_t copy_buffer[DELTA_COPY_BUFFER_SIZE];
+    size_t copied = 0U;
+    while (copied < length) {
+        size_t readable = length - copied;
+        if (readable > sizeof(copy_buffer)) {
+            readable = sizeof(copy_buffer);
+        }
+        if (esp_partition_read(source, source_offset + copied, copy_buffer, readable) != ESP_OK) {
+            return false;
+        }
+        if (m_target_updater->write(copy_buffer, readable) != readable) {
+            return false;
+        }
+        copied += readable;
+    }
+    return true;
+}
+
+bool Delta_Updater::begin_target(const size_t& target_size) {
+    if (m_target_begun) {
+        return true;
+    }
+    if (!m_target_updater->begin(target_size)) {
+        return false;
+    }
+    m_target_begun = true;
+    return true;
+}
+
+#endif // THINGSBOARD_USE_ESP_PARTITION
+
+#endif // THINGSBOARD_ENABLE_OTA
@@ -0,0 +1,81 @@
+#ifndef Delta_Updater_h
+#define Delta_Updater_h
+
+// Local include.
+#include "Configuration.h"
+
+#if THINGSBOARD_ENABLE_OTA
+
+#if THINGSBOARD_USE_ESP_PARTITION
+
+// Local include.
+#include "IUpdater.h"
+
+
+/// @brief IUpdater implementation that applies a binary delta patch against the currently running firmware partition,
+/// while streaming the reconstructed full image into another IUpdater implementation (usually the Espressif_Updater), which writes it into the inactive ota partition.
+/// Because most firmware updates only change a small part of the image, transferring a patch instead of the complete binary
+/// cuts the typical update transfer size and therefore the complete update time down considerably.
+/// The patch format is intentionally simple so it can be applied in a single streaming pass with constant memory usage:
+/// an 8 byte magic ("TBDELTA1"), the total size of the reconstructed image as a 32 bit little endian value
+/// and then a sequence of records, each starting with a 1 byte opcode.
+/// Opcode 0x00 (data) is followed by a 32 bit little endian length and that many literal bytes, that are written to the target as is.
+/// Opcode 0x01 (copy) is followed by a 32 bit little endian source offset and a 32 bit little endian length,
+/// that many bytes are read from the currently running partition at the given offset and written to the target.
+/// If the received stream does not start with the magic it is treated as a regular full firmware image and passed through unchanged,
+/// meaning the same updater configuration handles both delta and full updates.
+/// The firmware checksum send by the server is calculated over the transferred bytes, so it verifies the patch itself,
+/// the reconstructed image is additionally verified by the wrapped updater when the ota partition is finalized
+class Delta_Updater : public IUpdater {
+  public:
+    /// @brief Constructor
+    /// @param target_updater Updater implementation the reconstructed full firmware image is written into
+    explicit Delta_Updater(IUpdater *target_updater);
+
+    bool begin(const size_t& firmware_size) override;
+
+    size_t write(uint8_t* payload, const size_t& total_bytes) override;
+
+    void reset() override;
+
+    bool end() override;
+
+  private:
+    // Parsing state of the streamed patch, advanced with every received packet
+    enum class State : const uint8_t {
+        STATE_MAGIC,       // Reading the 8 byte magic, decides between delta and passthrough mode
+        STATE_TARGET_SIZE, // Reading the 32 bit total size of the reconstructed image
+        STATE_OPCODE,      // Reading the 1 byte opcode of the next record
+        STATE_DATA_HEADER, // Reading the 32 bit length of a literal data record
+        STATE_DATA,        // Forwarding the literal bytes of a data record to the target
+        STATE_COPY_HEADER, // Reading the 32 bit source offset and 32 bit length of a copy record
+        STATE_PASSTHROUGH, // No magic found, the complete stream is a full image and forwarded unchanged
+        STATE_FAILED       // Patch was malformed or applying it failed, all further data is rejected
+    };
+
+    IUpdater *m_target_updater;    // Updater implementation the reconstructed full firmware image is written into
+    const void *m_source_partition; // Currently running partition the copy records read their bytes from
+    State m_state;                 // Current parsing state of the streamed patch
+    uint8_t m_header_buffer[8];    // Accumulates the bytes of the magic and the fixed size record headers
+    size_t m_header_fill;          // Amount of bytes currently accumulated in the header buffer
+    size_t m_remaining_data;       // Amount of literal bytes still expected for the current data record
+    size_t m_patch_size;           // Total size of the transferred patch, used when falling back to passthrough mode
+    bool m_target_begun;           // Whether the wrapped updater has been initialized already or not
+
+    /// @brief Reads the given amount of bytes from the running partition and writes them to the target updater
+    /// @param source_offset Offset in the running partition the bytes are read from
+    /// @param length Amount of bytes that should be copied
+    /// @return Whether copying all bytes was successful or not
+    bool apply_copy_record(const size_t& source_offset, const size_t& length);
+
+    /// @brief Initializes the wrapped updater with the given total image size, only once per update
+    /// @param target_size Total size of the image that will be written into the wrapped updater
+    /// @return Whether initializing the wrapped updater was successful or not
+    bool begin_target(const size_t& target_size);
+};
+
+#endif // THINGSBOARD_USE_ESP_PARTITION
+
+#endif // THINGSBOARD_ENABLE_OTA
+
+#endif // Delta_Updater_h
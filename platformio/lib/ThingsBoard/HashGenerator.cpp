@@ -6,19 +6,50 @@
 // Library includes.
 #include <sstream>
 #include <iomanip>
+#include <string.h>
 
 HashGenerator::HashGenerator() :
     m_ctx()
+#if THINGSBOARD_USE_ESP_SHA
+    , m_use_hw(false)
+    , m_hw_first_block(true)
+    , m_hw_total_bytes(0U)
+    , m_hw_buffer_fill(0U)
+    , m_hw_buffer()
+#endif // THINGSBOARD_USE_ESP_SHA
 {
     // Nothing to do
 }
 
 HashGenerator::~HashGenerator(void) {
+#if THINGSBOARD_USE_ESP_SHA
+    // Ensure the hardware engine is released again, if a hash was started but never finished
+    if (m_use_hw) {
+        esp_sha_unlock_engine(SHA2_256);
+        m_use_hw = false;
+    }
+#endif // THINGSBOARD_USE_ESP_SHA
     // Ensures to clean up the mbedtls memory after it has been used
     mbedtls_md_free(&m_ctx);
 }
 
 void HashGenerator::start(const mbedtls_md_type_t& type) {
+#if THINGSBOARD_USE_ESP_SHA
+    // The hardware engine is only used for SHA256, which is the algorithm ThingsBoard uses for firmware checksums by default.
+    // If the engine is currently held by another component (for example an ongoing TLS handshake), we simply fall back to the mbedtls implementation
+    if (type == MBEDTLS_MD_SHA256 && (m_use_hw || esp_sha_try_lock_engine(SHA2_256))) {
+        m_use_hw = true;
+        m_hw_first_block = true;
+        m_hw_total_bytes = 0U;
+        m_hw_buffer_fill = 0U;
+        return;
+    }
+    else if (m_use_hw) {
+        // Previously started hardware hash is superseded by a software one, release the engine again
+        esp_sha_unlock_engine(SHA2_256);
+        m_use_hw = false;
+    }
+#endif // THINGSBOARD_USE_ESP_SHA
     // MBEDTLS Version 3 is a major breaking changes were accessing the internal structures requires the MBEDTLS_PRIVATE macro
 #if MBEDTLS_VERSION_MAJOR < 3
     if (m_ctx.hmac_ctx != nullptr && m_ctx.md_ctx != nullptr && m_ctx.md_info != nullptr) {
@@ -36,10 +67,51 @@ void HashGenerator::start(const mbedtls_md_type_t& type) {
 }
 
 bool HashGenerator::update(const uint8_t* data, const size_t& len) {
+#if THINGSBOARD_USE_ESP_SHA
+    if (m_use_hw) {
+        m_hw_total_bytes += len;
+        size_t offset = 0U;
+        // Complete a previously started partial block first, because the hardware engine only accepts complete 64 byte blocks
+        if (m_hw_buffer_fill != 0U) {
+            const size_t needed = sizeof(m_hw_buffer) - m_hw_buffer_fill;
+            const size_t copied = (len < needed) ? len : needed;
+            memcpy(&m_hw_buffer[m_hw_buffer_fill], data, copied);
+            m_hw_buffer_fill += copied;
+            offset += copied;
+            if (m_hw_buffer_fill < sizeof(m_hw_buffer)) {
+                return true;
+            }
+            hw_process_block(m_hw_buffer);
+            m_hw_buffer_fill = 0U;
+        }
+        // Feed every complete block directly from the passed data, without copying it into the partial block buffer first
+        while (len - offset >= sizeof(m_hw_buffer)) {
+            hw_process_block(&data[offset]);
+            offset += sizeof(m_hw_buffer);
+        }
+        // Keep the remaining bytes until the next update or the final padding completes the block
+        memcpy(m_hw_buffer, &data[offset], len - offset);
+        m_hw_buffer_fill = len - offset;
+        return true;
+    }
+#endif // THINGSBOARD_USE_ESP_SHA
     return mbedtls_md_update(&m_ctx, data, len) == 0;
 }
 
 std::string HashGenerator::get_hash_string() {
+#if THINGSBOARD_USE_ESP_SHA
+    if (m_use_hw) {
+        uint8_t hash[32];
+        hw_finish(hash);
+
+        // Convert the hash value to a string
+        std::stringstream ss;
+        for (size_t i = 0; i < sizeof(hash); i++)
+            ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+        return ss.str();
+    }
+#endif // THINGSBOARD_USE_ESP_SHA
+
     // Calculate the current hash value
     uint8_t hash[MBEDTLS_MD_MAX_SIZE];
     finish(hash);
@@ -56,6 +128,46 @@ std::string HashGenerator::get_hash_string() {
     return ss.str();
 }
 
+#if THINGSBOARD_USE_ESP_SHA
+void HashGenerator::hw_process_block(const uint8_t *block) {
+    esp_sha_block(SHA2_256, block, m_hw_first_block);
+    m_hw_first_block = false;
+}
+
+void HashGenerator::hw_finish(unsigned char *hash) {
+    // Total message length in bits has to be captured before the padding bytes are fed through update and counted as well
+    const uint64_t total_bits = m_hw_total_bytes * 8U;
+
+    // Standard SHA256 message padding: a single 0x80 byte, zero bytes until 8 bytes remain in the final block
+    // and then the total message length in bits as a 64 bit big endian value
+    const uint8_t padding_start = 0x80U;
+    const uint8_t padding_zero = 0x00U;
+    update(&padding_start, 1U);
+    while (m_hw_buffer_fill != 56U) {
+        update(&padding_zero, 1U);
+    }
+    uint8_t length_bytes[8];
+    for (size_t i = 0; i < sizeof(length_bytes); i++) {
+        length_bytes[i] = (total_bits >> (56U - (i * 8U))) & 0xFFU;
+    }
+    update(length_bytes, sizeof(length_bytes));
+
+    // All blocks including the padding have been processed, the engine now holds the final digest state,
+    // which consists of 8 words that have to be serialized as big endian to form the actual hash value
+    uint32_t digest_state[8];
+    esp_sha_read_digest_state(SHA2_256, digest_state);
+    esp_sha_unlock_engine(SHA2_256);
+    m_use_hw = false;
+
+    for (size_t i = 0; i < 8U; i++) {
+        hash[(i * 4U) + 0U] = (digest_state[i] >> 24U) & 0xFFU;
+        hash[(i * 4U) + 1U] = (digest_state[i] >> 16U) & 0xFFU;
+        hash[(i * 4U) + 2U] = (digest_state[i] >> 8U) & 0xFFU;
+        hash[(i * 4U) + 3U] = digest_state[i] & 0xFFU;
+    }
+}
+#endif // THINGSBOARD_USE_ESP_SHA
+
 void HashGenerator::finish(unsigned char *hash) {
     mbedtls_md_finish(&m_ctx, hash);
 }
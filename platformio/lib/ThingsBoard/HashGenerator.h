@@ -12,6 +12,9 @@
 #else
 #include <Seeed_mbedtls.h>
 #endif // THINGSBOARD_USE_MBED_TLS
+#if THINGSBOARD_USE_ESP_SHA
+#include <esp32/sha.h>
+#endif // THINGSBOARD_USE_ESP_SHA
 #include <string>
 
 
@@ -48,6 +51,22 @@ class HashGenerator {
   private:
     mbedtls_md_context_t m_ctx; // Context used to access the already written bytes and update them latter
 
+#if THINGSBOARD_USE_ESP_SHA
+    bool m_use_hw;              // Whether the hardware SHA engine has been acquired for the currently running hash or not
+    bool m_hw_first_block;      // Whether the next block fed into the hardware engine is the first one of the message or not
+    uint64_t m_hw_total_bytes;  // Total amount of bytes hashed so far, needed for the length field of the final message padding
+    size_t m_hw_buffer_fill;    // Amount of bytes currently held in the partial block buffer
+    uint8_t m_hw_buffer[64];    // Partial block buffer, because the hardware engine only accepts complete 64 byte blocks
+
+    /// @brief Feeds one complete 64 byte block into the hardware SHA engine
+    /// @param block Pointer to the 64 bytes that should be processed
+    void hw_process_block(const uint8_t *block);
+
+    /// @brief Applies the standard SHA256 message padding, reads the final digest from the hardware engine and releases it again
+    /// @param hash Output byte array that the 32 byte hash value will be copied into
+    void hw_finish(unsigned char *hash);
+#endif // THINGSBOARD_USE_ESP_SHA
+
     /// @brief Calculates the final hash value
     /// @param hash Output byte array that the hash value will be copied into
     void finish(unsigned char *hash);
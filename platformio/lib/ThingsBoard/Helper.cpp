@@ -22,6 +22,19 @@ uint8_t Helper::detectSize(const char *msg, ...) {
       return result;
 }
 
+uint32_t Helper::fnv1aHash(const char *str) {
+    // FNV offset basis and FNV prime for 32-bit hashes
+    uint32_t hash = 2166136261U;
+    if (str == nullptr) {
+      return hash;
+    }
+    for (; *str != '\0'; str++) {
+      hash ^= static_cast<uint8_t>(*str);
+      hash *= 16777619U;
+    }
+    return hash;
+}
+
 size_t Helper::getOccurences(const char *str, char symbol) {
     size_t count = 0;
     if (str == nullptr) {
@@ -3,9 +3,11 @@
 
 // Local includes.
 #include "Configuration.h"
+#include "Constants.h"
 
 // Library include.
 #include <stdint.h>
+#include <string.h>
 #include <ArduinoJson.h>
 #if THINGSBOARD_ENABLE_STL
 #include <iterator>
@@ -28,6 +30,50 @@ class Helper {
     /// @return Amount of occurences of the given symbol
     static size_t getOccurences(const char *str, char symbol);
 
+    /// @brief Calculates the 32-bit FNV-1a hash of the given null terminated string,
+    /// allowing string comparisons to be replaced by a single integer comparison once the hash has been cached.
+    /// See http://www.isthe.com/chongo/tech/comp/fnv/ for more information on the underlying algorithm
+    /// @param str String that we want to calculate the hash of, a nullptr results in the FNV offset basis being returned
+    /// @return 32-bit FNV-1a hash of the given string
+    static uint32_t fnv1aHash(const char *str);
+
+    // Maximum amount of characters (excluding the null terminator) needed to display the decimal representation of a 32 bit unsigned value
+    static constexpr size_t Max_Unsigned_Digits = 10U;
+
+    /// @brief Assembles a topic that consists of a constant prefix directly followed by the decimal representation of the given unsigned value.
+    /// Replacement for detectSize and snprintf for the topics that end in a numeric request id ("v1/devices/me/rpc/response/%u", ...),
+    /// the length of the constant prefix is deduced from the format array at compile time and only the digits are formatted at runtime,
+    /// which avoids a complete printf format parsing pass per message inside the latency-critical receive callback
+    /// @tparam FormatSize Size of the format array including its null terminator, deduced automatically
+    /// @param buffer Output buffer the assembled topic is written into,
+    /// has to be at least sizeof(format) + Max_Unsigned_Digits bytes big to hold any possible value
+    /// @param format Topic format constant that ends in "%u", everything before that placeholder is copied verbatim
+    /// @param id Unsigned value that is appended after the constant prefix
+    /// @return Length of the assembled topic in characters
+    template <size_t FormatSize>
+    inline static size_t assembleIdTopic(char *buffer, const char (&format)[FormatSize], size_t id) {
+      // Strip the null terminator and the two characters of the trailing "%u" placeholder from the copied prefix
+      constexpr size_t prefix_length = FormatSize - 3U;
+      memcpy_P(buffer, format, prefix_length);
+      size_t length = prefix_length;
+
+      // Format the digits in reverse order into a small scratch area and copy them into place afterwards
+      char digits[Max_Unsigned_Digits];
+      size_t digit_count = 0U;
+      do {
+        digits[digit_count] = '0' + (id % 10U);
+        digit_count++;
+        id /= 10U;
+      } while (id != 0U);
+      while (digit_count > 0U) {
+        digit_count--;
+        buffer[length] = digits[digit_count];
+        length++;
+      }
+      buffer[length] = '\0';
+      return length;
+    }
+
     /// @brief Calculates the total size of the string the serializeJson method would produce including the null end terminator.
     /// See https://arduinojson.org/v6/api/json/measurejson/ for more information on the underlying method used
     /// @tparam TSource Source class that should be used to serialize the json that is sent to the server
@@ -78,6 +78,17 @@ class IMQTT_Client {
     /// @return Whether the client could establish the connection successfully or not
     virtual bool connect(const char *client_id, const char *user_name, const char *password) = 0;
 
+    /// @brief Requests a persistent MQTT session (clean-session=false) on the next connect,
+    /// so the broker keeps subscriptions and queued messages across reconnects.
+    /// Default implementation does nothing, because not every client supports it
+    /// @param clean_session Whether a clean session should be requested or not
+    virtual void set_clean_session(const bool& clean_session) { (void)clean_session; }
+
+    /// @brief Whether the broker resumed a previous session on the last successful connect,
+    /// meaning resubscribing to topics can be skipped entirely
+    /// @return Whether a previous session was resumed or not
+    virtual bool session_present() { return false; }
+
     /// @brief Disconnects from a previously connected server and should release all used resources
     virtual void disconnect() = 0;
 
@@ -99,7 +110,21 @@ class IMQTT_Client {
     /// @return Wheter subscribing the given topic was possible or not, should return false and a warning should be printed,
     /// if the connection has been lost or the topic does not exist
     virtual bool subscribe(const char *topic) = 0;
-  
+
+    /// @brief Subscribes to multiple MQTT topics at once, implementations that support it should batch
+    /// all given topics into a single SUBSCRIBE packet so a reconnect pays one round trip for the whole set.
+    /// The default implementation simply falls back to one subscribe() call per topic
+    /// @param topics Array of topics we want to receive a notification about if messages are sent by the server
+    /// @param count Amount of topics in the given array
+    /// @return Whether subscribing all given topics was possible or not
+    virtual bool subscribe_many(const char* const* topics, const size_t& count) {
+      bool result = true;
+      for (size_t i = 0; i < count; i++) {
+        result = subscribe(topics[i]) && result;
+      }
+      return result;
+    }
+
     /// @brief Unsubscribes to previously subscribed MQTT message on the given topic
     /// @param topic Topic we want to stop receiving a notification about if messages are sent by the server
     /// @return Wheter unsubscribing the given topic was possible or not, should return false and a warning should be printed,
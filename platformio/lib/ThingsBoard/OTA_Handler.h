@@ -44,11 +44,13 @@ constexpr char UPDATING_HASH_FAILED[] PROGMEM = "Updating hash failed";
 constexpr char ERROR_UPDATE_END[] PROGMEM = "Error (%u) during flash updater not all bytes written";
 constexpr char CHKS_VER_FAILED[] PROGMEM = "Checksum verification failed";
 constexpr char FW_CHUNK[] PROGMEM = "Receive chunk (%u), with size (%u) bytes";
+constexpr char FW_CHUNK_BUFFERED[] PROGMEM = "Buffered out of order chunk (%u), still waiting for chunk (%u)";
 constexpr char HASH_ACTUAL[] PROGMEM = "(%s) actual checksum: (%s)";
 constexpr char HASH_EXPECTED[] PROGMEM = "(%s) expected checksum: (%s)";
 constexpr char CHKS_VER_SUCCESS[] PROGMEM = "Checksum is the same as expected";
 constexpr char FW_UPDATE_ABORTED[] PROGMEM = "Firmware update aborted";
 constexpr char FW_UPDATE_SUCCESS[] PROGMEM = "Update success";
+constexpr char CHUNK_SIZE_ADAPTED[] PROGMEM = "Adapted requested chunk size to (%u) bytes";
 #else
 constexpr char UNABLE_TO_REQUEST_CHUNCKS[] = "Unable to request firmware chunk";
 constexpr char RECEIVED_UNEXPECTED_CHUNK[] = "Received chunk (%u), not the same as requested chunk (%u)";
@@ -58,11 +60,32 @@ constexpr char UPDATING_HASH_FAILED[] = "Updating hash failed";
 constexpr char ERROR_UPDATE_END[] = "Error during flash updater not all bytes written";
 constexpr char CHKS_VER_FAILED[] = "Checksum verification failed";
 constexpr char FW_CHUNK[] = "Receive chunk (%u), with size (%u) bytes";
+constexpr char FW_CHUNK_BUFFERED[] = "Buffered out of order chunk (%u), still waiting for chunk (%u)";
 constexpr char HASH_ACTUAL[] = "(%s) actual checksum: (%s)";
 constexpr char HASH_EXPECTED[] = "(%s) expected checksum: (%s)";
 constexpr char CHKS_VER_SUCCESS[] = "Checksum is the same as expected";
 constexpr char FW_UPDATE_ABORTED[] = "Firmware update aborted";
 constexpr char FW_UPDATE_SUCCESS[] = "Update success";
+constexpr char CHUNK_SIZE_ADAPTED[] = "Adapted requested chunk size to (%u) bytes";
+#endif // THINGSBOARD_ENABLE_PROGMEM
+
+// Upper bound for the configurable pipeline window,
+// bounds the worst case heap usage for buffered out of order chunks to (MAX_PIPELINE_WINDOW - 1) * chunkSize bytes.
+#if THINGSBOARD_ENABLE_PROGMEM
+constexpr uint8_t MAX_PIPELINE_WINDOW PROGMEM = 4U;
+#else
+constexpr uint8_t MAX_PIPELINE_WINDOW = 4U;
+#endif // THINGSBOARD_ENABLE_PROGMEM
+
+// Bounds and behaviour of the adaptive chunk size controller.
+// The requested chunk size only ever moves in powers of two between OTA_MIN_CHUNK_SIZE and the configured chunk size,
+// so the byte offset of the already received data stays aligned whenever the size changes
+#if THINGSBOARD_ENABLE_PROGMEM
+constexpr uint16_t OTA_MIN_CHUNK_SIZE PROGMEM = 256U;
+constexpr uint8_t OTA_CHUNK_GROW_STREAK PROGMEM = 4U;
+#else
+constexpr uint16_t OTA_MIN_CHUNK_SIZE = 256U;
+constexpr uint8_t OTA_CHUNK_GROW_STREAK = 4U;
 #endif // THINGSBOARD_ENABLE_PROGMEM
 
 
@@ -73,10 +96,10 @@ template<typename Logger>
 class OTA_Handler {
   public:
     /// @brief Constructor
-    /// @param publish_callback Callback that is used to request the firmware chunk of the firmware binary with the given chunk number
+    /// @param publish_callback Callback that is used to request the firmware chunk of the firmware binary with the given chunk number and the chunk size in bytes the server should slice it to
     /// @param send_fw_state_callback Callback that is used to send information about the current state of the over the air update
     /// @param finish_callback Callback that is called once the update has been finished and the user should be informed of the failure or success of the over the air update
-    inline OTA_Handler(std::function<bool(const size_t&)> publish_callback, std::function<bool(const char *, const char *)> send_fw_state_callback, std::function<bool(void)> finish_callback)
+    inline OTA_Handler(std::function<bool(const size_t&, const size_t&)> publish_callback, std::function<bool(const char *, const char *)> send_fw_state_callback, std::function<bool(void)> finish_callback)
         : m_fw_callback(nullptr)
         , m_publish_callback(publish_callback)
         , m_send_fw_state_callback(send_fw_state_callback)
@@ -88,7 +111,14 @@ class OTA_Handler {
         , m_hash()
         , m_total_chunks(0U)
         , m_requested_chunks(0U)
+        , m_highest_requested_chunk(0U)
+        , m_chunk_size(0U)
+        , m_received_bytes(0U)
+        , m_request_start_ms(0U)
+        , m_fast_chunks(0U)
+        , m_pipeline_window(1U)
         , m_retries(0U)
+        , m_reorder_buffer()
         , m_watchdog(std::bind(&OTA_Handler::Handle_Request_Timeout, this))
     {
       // Nothing to do
@@ -103,11 +133,22 @@ class OTA_Handler {
     inline void Start_Firmware_Update(const OTA_Update_Callback *fw_callback, const size_t& fw_size, const std::string& fw_algorithm, const std::string& fw_checksum, const mbedtls_md_type_t& fw_checksum_algorithm) {
         m_fw_callback = fw_callback;
         m_fw_size = fw_size;
-        m_total_chunks = (m_fw_size / m_fw_callback->Get_Chunk_Size()) + 1U;
+        // The configured chunk size is the starting point and upper bound of the adaptive controller,
+        // because the client receive buffer was sized for it when the update was prepared
+        m_chunk_size = m_fw_callback->Get_Chunk_Size();
+        m_total_chunks = (m_fw_size / m_chunk_size) + 1U;
         m_fw_algorithm = fw_algorithm;
         m_fw_checksum = fw_checksum;
         m_fw_checksum_algorithm = fw_checksum_algorithm;
         m_fw_updater = m_fw_callback->Get_Updater();
+        // Clamp the configured pipeline window, to bound the worst case heap usage for buffered out of order chunks
+        m_pipeline_window = m_fw_callback->Get_Pipeline_Window();
+        if (m_pipeline_window < 1U) {
+          m_pipeline_window = 1U;
+        }
+        else if (m_pipeline_window > MAX_PIPELINE_WINDOW) {
+          m_pipeline_window = MAX_PIPELINE_WINDOW;
+        }
 
         if (!m_publish_callback || !m_send_fw_state_callback || !m_finish_callback || !m_fw_updater) {
           Logger::log(OTA_CB_IS_NULL);
@@ -122,6 +163,7 @@ class OTA_Handler {
     /// shouldn't really matter, because if we start the update process again the partition will be overwritten anyway and a partially written firmware will not be bootable
     inline void Stop_Firmware_Update() {
         m_watchdog.detach();
+        Clear_Reorder_Buffer();
         m_fw_updater->reset();
         Logger::log(FW_UPDATE_ABORTED);
         (void)m_send_fw_state_callback(FW_STATE_FAILED, FW_UPDATE_ABORTED);
@@ -138,6 +180,12 @@ class OTA_Handler {
         (void)m_send_fw_state_callback(FW_STATE_DOWNLOADING, nullptr);
 
         if (current_chunk != m_requested_chunks) {
+          // With a pipeline window bigger than 1, chunks requested ahead of time can overtake the expected one,
+          // those are buffered on the heap and written once the missing chunk has arrived and been handled
+          if (current_chunk > m_requested_chunks && current_chunk < m_requested_chunks + m_pipeline_window) {
+            Buffer_Out_Of_Order_Chunk(current_chunk, payload, total_bytes);
+            return;
+          }
           char message[Helper::detectSize(RECEIVED_UNEXPECTED_CHUNK, current_chunk, m_requested_chunks)];
           snprintf_P(message, sizeof(message), RECEIVED_UNEXPECTED_CHUNK, current_chunk, m_requested_chunks);
           Logger::log(message);
@@ -146,37 +194,31 @@ class OTA_Handler {
 
         m_watchdog.detach();
 
-        char message[Helper::detectSize(FW_CHUNK, current_chunk, total_bytes)];
-        snprintf_P(message, sizeof(message), FW_CHUNK, current_chunk, total_bytes);
-        Logger::log(message);
-
-        if (current_chunk == 0U) {
-            // Initialize Flash
-            if (!m_fw_updater->begin(m_fw_size)) {
-              Logger::log(ERROR_UPDATE_BEGIN);
-              (void)m_send_fw_state_callback(FW_STATE_FAILED, ERROR_UPDATE_BEGIN);
-              return Handle_Failure(OTA_Failure_Response::RETRY_UPDATE);
-            }
-        }
+        // Track the round trip time of the expected chunk for the adaptive chunk size controller,
+        // a chunk counts as fast if it arrived within half the configured timeout
+        const bool fast_chunk = ((millis() - m_request_start_ms) * 1000ULL) <= (m_fw_callback->Get_Timeout() / 2U);
 
-        // Write received binary data to flash partition
-        const size_t written_bytes = m_fw_updater->write(payload, total_bytes);
-        if (written_bytes != total_bytes) {
-            char message[Helper::detectSize(ERROR_UPDATE_WRITE, written_bytes, total_bytes)];
-            snprintf_P(message, sizeof(message), ERROR_UPDATE_WRITE, written_bytes, total_bytes);
-            Logger::log(message);
-            (void)m_send_fw_state_callback(FW_STATE_FAILED, message);
-            return Handle_Failure(OTA_Failure_Response::RETRY_UPDATE);
+        if (!Write_Firmware_Chunk(current_chunk, payload, total_bytes)) {
+          return;
         }
+        m_requested_chunks = current_chunk + 1;
 
-        // Update value only if writing to flash was a success
-        if (!m_hash.update(payload, total_bytes)) {
-            Logger::log(UPDATING_HASH_FAILED);
-            (void)m_send_fw_state_callback(FW_STATE_FAILED, UPDATING_HASH_FAILED);
-            return Handle_Failure(OTA_Failure_Response::RETRY_UPDATE);
+        // Drain every directly following chunk that has already been buffered,
+        // because it overtook the chunk that has now been written, overlapping flash writes with network receive
+        while (m_pipeline_window > 1U) {
+          Buffered_Chunk& buffered = m_reorder_buffer[m_requested_chunks % m_pipeline_window];
+          if (buffered.payload == nullptr || buffered.chunk != m_requested_chunks) {
+            break;
+          }
+          const bool written = Write_Firmware_Chunk(buffered.chunk, buffered.payload, buffered.size);
+          delete[] buffered.payload;
+          buffered.payload = nullptr;
+          if (!written) {
+            return;
+          }
+          m_requested_chunks = buffered.chunk + 1;
         }
 
-        m_requested_chunks = current_chunk + 1;
         m_fw_callback->Call_Progress_Callback<Logger>(m_requested_chunks, m_total_chunks);
 
         // Ensure to check if the update was cancelled during the progress callback,
@@ -187,12 +229,19 @@ class OTA_Handler {
 
         // Reset retries as the current chunk has been downloaded and handled successfully
         m_retries = m_fw_callback->Get_Chunk_Retries();
+
+        // Grow the requested chunk size once enough consecutive chunks arrived well within the timeout,
+        // faster downloads on good links without risking the weak link behaviour
+        m_fast_chunks = fast_chunk ? m_fast_chunks + 1U : 0U;
+        if (m_fast_chunks >= OTA_CHUNK_GROW_STREAK && Adapt_Chunk_Size(true)) {
+          m_fast_chunks = 0U;
+        }
         Request_Next_Firmware_Packet();
     }
 
   private:
     const OTA_Update_Callback *m_fw_callback;                                 // Callback method that contains configuration information, about the over the air update
-    std::function<bool(const size_t&)> m_publish_callback;                    // Callback that is used to request the firmware chunk of the firmware binary with the given chunk number
+    std::function<bool(const size_t&, const size_t&)> m_publish_callback;     // Callback that is used to request the firmware chunk of the firmware binary with the given chunk number and chunk size
     std::function<bool(const char *, const char *)> m_send_fw_state_callback; // Callback that is used to send information about the current state of the over the air update
     std::function<bool(void)> m_finish_callback;                              // Callback that is called once the update has been finished and the user should be informed of the failure or success of the over the air update
     size_t m_fw_size;                                                         // Total size of the firmware binary we will receive. Allows for a binary size of up to theoretically 4 GB
@@ -203,33 +252,142 @@ class OTA_Handler {
     HashGenerator m_hash;                                                     // Class instance that allows to generate a hash from received firmware binary data
     size_t m_total_chunks;                                                    // Total amount of chunks that need to be received to get the complete firmware binary
     size_t m_requested_chunks;                                                // Amount of successfully requested and received firmware binary chunks
+    size_t m_highest_requested_chunk;                                         // Index of the first chunk that has not been requested yet, ahead of m_requested_chunks when the download is pipelined
+    size_t m_chunk_size;                                                      // Chunk size in bytes that is currently requested from the server, adapted to the observed link quality during the session
+    size_t m_received_bytes;                                                  // Amount of firmware binary bytes that have been received and written successfully so far
+    uint32_t m_request_start_ms;                                              // Timestamp at which the expected chunk was requested, used to measure the chunk round trip time
+    uint8_t m_fast_chunks;                                                    // Amount of consecutive chunks that arrived well within the timeout, the chunk size is grown once enough accumulated
+    uint8_t m_pipeline_window;                                                // Amount of chunk requests kept outstanding at the same time, clamped copy of the callback configuration for the running update
     uint8_t m_retries;                                                        // Amount of request retries we attempt for each chunk, increasing makes the connection more stable
+
+    // Out of order chunk that has been buffered until the missing preceding chunk has arrived and been written
+    struct Buffered_Chunk {
+      uint8_t *payload = nullptr; // Heap copy of the received firmware packet data, nullptr means the slot is free
+      size_t chunk = 0U;          // Index of the chunk the buffered binary data belongs to
+      size_t size = 0U;           // Amount of bytes in the buffered firmware packet data
+    };
+    Buffered_Chunk m_reorder_buffer[MAX_PIPELINE_WINDOW];                     // Reorder buffer for chunks that overtook the expected one, indexed with the chunk number modulo the pipeline window
     Callback_Watchdog m_watchdog;                                             // Class instances that allows to timeout if we do not receive a response for a requested chunk in the given time
 
+    /// @brief Buffers the given out of order firmware chunk on the heap, so it can be written once the missing preceding chunk has arrived,
+    /// if the slot for the chunk is already occupied or allocating fails the chunk is simply discarded and will be requested again after the timeout
+    /// @param current_chunk Index of the chunk we recieved the binary data for
+    /// @param payload Firmware packet data of the current chunk
+    /// @param total_bytes Amount of bytes in the current firmware packet data
+    inline void Buffer_Out_Of_Order_Chunk(const size_t& current_chunk, const uint8_t *payload, const size_t& total_bytes) {
+        Buffered_Chunk& buffered = m_reorder_buffer[current_chunk % m_pipeline_window];
+        if (buffered.payload != nullptr) {
+          return;
+        }
+        buffered.payload = new uint8_t[total_bytes];
+        if (buffered.payload == nullptr) {
+          return;
+        }
+        memcpy(buffered.payload, payload, total_bytes);
+        buffered.chunk = current_chunk;
+        buffered.size = total_bytes;
+        char message[Helper::detectSize(FW_CHUNK_BUFFERED, current_chunk, m_requested_chunks)];
+        snprintf_P(message, sizeof(message), FW_CHUNK_BUFFERED, current_chunk, m_requested_chunks);
+        Logger::log(message);
+    }
+
+    /// @brief Releases every heap buffered out of order chunk, called whenever the download is restarted or stopped
+    inline void Clear_Reorder_Buffer() {
+        for (size_t i = 0; i < MAX_PIPELINE_WINDOW; i++) {
+          delete[] m_reorder_buffer[i].payload;
+          m_reorder_buffer[i].payload = nullptr;
+        }
+    }
+
+    /// @brief Writes the given firmware packet data into flash memory and into the hash function,
+    /// initializing the flash updater beforehand if the data belongs to the very first chunk
+    /// @param current_chunk Index of the chunk we recieved the binary data for
+    /// @param payload Firmware packet data of the current chunk
+    /// @param total_bytes Amount of bytes in the current firmware packet data
+    /// @return Whether writing the complete firmware packet data was successful or not
+    inline bool Write_Firmware_Chunk(const size_t& current_chunk, uint8_t *payload, const size_t& total_bytes) {
+        char message[Helper::detectSize(FW_CHUNK, current_chunk, total_bytes)];
+        snprintf_P(message, sizeof(message), FW_CHUNK, current_chunk, total_bytes);
+        Logger::log(message);
+
+        if (current_chunk == 0U) {
+            // Initialize Flash
+            if (!m_fw_updater->begin(m_fw_size)) {
+              Logger::log(ERROR_UPDATE_BEGIN);
+              (void)m_send_fw_state_callback(FW_STATE_FAILED, ERROR_UPDATE_BEGIN);
+              Handle_Failure(OTA_Failure_Response::RETRY_UPDATE);
+              return false;
+            }
+        }
+
+        // Write received binary data to flash partition
+        const size_t written_bytes = m_fw_updater->write(payload, total_bytes);
+        if (written_bytes != total_bytes) {
+            char message[Helper::detectSize(ERROR_UPDATE_WRITE, written_bytes, total_bytes)];
+            snprintf_P(message, sizeof(message), ERROR_UPDATE_WRITE, written_bytes, total_bytes);
+            Logger::log(message);
+            (void)m_send_fw_state_callback(FW_STATE_FAILED, message);
+            Handle_Failure(OTA_Failure_Response::RETRY_UPDATE);
+            return false;
+        }
+
+        // Update value only if writing to flash was a success
+        if (!m_hash.update(payload, total_bytes)) {
+            Logger::log(UPDATING_HASH_FAILED);
+            (void)m_send_fw_state_callback(FW_STATE_FAILED, UPDATING_HASH_FAILED);
+            Handle_Failure(OTA_Failure_Response::RETRY_UPDATE);
+            return false;
+        }
+
+        m_received_bytes += total_bytes;
+        return true;
+    }
+
     /// @brief Restarts or starts the firmware update and its needed components and then requests the first firmware chunk
     inline void Request_First_Firmware_Packet() {
         m_requested_chunks = 0U;
+        m_highest_requested_chunk = 0U;
+        // The adapted chunk size is intentionally kept across restarts,
+        // the link quality has not changed just because the download did
+        m_received_bytes = 0U;
+        m_fast_chunks = 0U;
         m_retries = m_fw_callback->Get_Chunk_Retries();
         m_hash.start(m_fw_checksum_algorithm);
         m_watchdog.detach();
+        Clear_Reorder_Buffer();
         m_fw_updater->reset();
         Request_Next_Firmware_Packet();
     }
 
-    /// @brief Requests the next firmware chunk of the OTA firmware if there are any left
-    /// and starts the timer that ensures we request the same chunk again if we have not received a response yet
+    /// @brief Requests every not yet requested firmware chunk inside the pipeline window if there are any left
+    /// and starts the timer that ensures we request the expected chunk again if we have not received a response yet.
+    /// With the default pipeline window of 1 this requests exactly the next chunk, keeping the previous strictly serial behaviour
     inline void Request_Next_Firmware_Packet() {
         // Check if we have already requested and handled the last remaining chunk
         if (m_requested_chunks >= m_total_chunks) {
-            Finish_Firmware_Update();   
+            Finish_Firmware_Update();
             return;
         }
 
-        if (!m_publish_callback(m_requested_chunks)) {
-          Logger::log(UNABLE_TO_REQUEST_CHUNCKS);
-          (void)m_send_fw_state_callback(FW_STATE_FAILED, UNABLE_TO_REQUEST_CHUNCKS);
+        // Ensure the expected chunk is requested again after a timeout, even if it had already been requested before
+        if (m_highest_requested_chunk < m_requested_chunks) {
+          m_highest_requested_chunk = m_requested_chunks;
         }
 
+        size_t window_end = m_requested_chunks + m_pipeline_window;
+        if (window_end > m_total_chunks) {
+          window_end = m_total_chunks;
+        }
+
+        for (size_t chunk = m_highest_requested_chunk; chunk < window_end; chunk++) {
+          if (!m_publish_callback(chunk, m_chunk_size)) {
+            Logger::log(UNABLE_TO_REQUEST_CHUNCKS);
+            (void)m_send_fw_state_callback(FW_STATE_FAILED, UNABLE_TO_REQUEST_CHUNCKS);
+          }
+        }
+        m_highest_requested_chunk = window_end;
+        m_request_start_ms = millis();
+
         // Watchdog gets started no matter if publishing request was successful or not in hopes,
         // that after the given timeout the callback calls this method again and can then publish the request successfully.
         m_watchdog.once(m_fw_callback->Get_Timeout());
@@ -304,8 +462,47 @@ class OTA_Handler {
       }
     }
 
+    /// @brief Adapts the requested chunk size to the observed link quality, doubling it on a good link and halving it on a weak one (AIMD-flavoured with power of two steps).
+    /// The size is bounded below by OTA_MIN_CHUNK_SIZE and above by the configured chunk size, because the client receive buffer was sized for the latter.
+    /// The change is only applied while the already received bytes are aligned to the new size and no pipelined request is outstanding,
+    /// so the chunk index sent to the server always addresses the byte offset directly following the received data
+    /// @param grow Whether the chunk size should be doubled or halved
+    /// @return Whether the chunk size was actually changed or not
+    inline bool Adapt_Chunk_Size(const bool& grow) {
+        size_t new_size = grow ? (m_chunk_size * 2U) : (m_chunk_size / 2U);
+        const uint16_t& configured_size = m_fw_callback->Get_Chunk_Size();
+        if (new_size > configured_size) {
+          new_size = configured_size;
+        }
+        if (new_size < OTA_MIN_CHUNK_SIZE) {
+          new_size = OTA_MIN_CHUNK_SIZE;
+        }
+        if (new_size == m_chunk_size || (m_received_bytes % new_size) != 0U || m_highest_requested_chunk > m_requested_chunks) {
+          return false;
+        }
+
+        m_chunk_size = new_size;
+        // Retarget the chunk accounting to the new size, the byte offset of the received data stays the same
+        m_total_chunks = (m_fw_size / m_chunk_size) + 1U;
+        m_requested_chunks = m_received_bytes / m_chunk_size;
+        m_highest_requested_chunk = m_requested_chunks;
+        // Buffered out of order chunks were sliced with the previous size and are therefore useless now
+        Clear_Reorder_Buffer();
+
+        char message[Helper::detectSize(CHUNK_SIZE_ADAPTED, m_chunk_size)];
+        snprintf_P(message, sizeof(message), CHUNK_SIZE_ADAPTED, m_chunk_size);
+        Logger::log(message);
+        return true;
+    }
+
     /// @brief Callback that will be called if we did not receive the firmware chunk response in the given timeout time
     inline void Handle_Request_Timeout() {
+        // Reset the request high-water mark, so the retry actually publishes a new request for the expected chunk,
+        // already buffered out of order chunks stay valid and are drained once the missing chunk arrived
+        m_highest_requested_chunk = m_requested_chunks;
+        // Weak link: halve the requested chunk size so the retry has a better chance of arriving within the timeout
+        m_fast_chunks = 0U;
+        (void)Adapt_Chunk_Size(false);
         Handle_Failure(OTA_Failure_Response::RETRY_CHUNK);
     }
 };
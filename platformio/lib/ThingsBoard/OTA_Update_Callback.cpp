@@ -23,7 +23,8 @@ OTA_Update_Callback::OTA_Update_Callback(progressFn progressCb, function endCb,
     m_updater(updater),
     m_retries(chunkRetries),
     m_size(chunkSize),
-    m_timeout(timeout)
+    m_timeout(timeout),
+    m_pipeline_window(PIPELINE_WINDOW)
 {
     // Nothing to do
 }
@@ -80,4 +81,12 @@ void OTA_Update_Callback::Set_Timeout(const uint64_t &timeout_microseconds) {
     m_timeout = timeout_microseconds;
 }
 
+const uint8_t& OTA_Update_Callback::Get_Pipeline_Window() const {
+    return m_pipeline_window;
+}
+
+void OTA_Update_Callback::Set_Pipeline_Window(const uint8_t &pipelineWindow) {
+    m_pipeline_window = pipelineWindow;
+}
+
 #endif // THINGSBOARD_ENABLE_OTA
@@ -29,10 +29,12 @@ constexpr char OTA_CB_IS_NULL[] = "OTA update callback is NULL";
 constexpr uint8_t CHUNK_RETRIES PROGMEM = 12U;
 constexpr uint16_t CHUNK_SIZE PROGMEM = (4U * 1024U);
 constexpr uint64_t REQUEST_TIMEOUT PROGMEM = (5U * 1000U * 1000U);
+constexpr uint8_t PIPELINE_WINDOW PROGMEM = 1U;
 #else
 constexpr uint8_t CHUNK_RETRIES = 12U;
 constexpr uint16_t CHUNK_SIZE = (4U * 1024U);
 constexpr uint64_t REQUEST_TIMEOUT = (5U * 1000U * 1000U);
+constexpr uint8_t PIPELINE_WINDOW = 1U;
 #endif // THINGSBOARD_ENABLE_PROGMEM
 
 
@@ -164,6 +166,21 @@ class OTA_Update_Callback : public Callback<void, const bool&> {
     /// @param timeout_microseconds Timeout time until we expect a response from the server
     void Set_Timeout(const uint64_t &timeout_microseconds);
 
+    /// @brief Gets the amount of chunk requests that are allowed to be outstanding at the same time,
+    /// the default of 1 keeps the previous strictly serial behaviour of requesting a chunk only once the previous one has been received and written.
+    /// Values above 1 pipeline the download, hiding the request round trip time behind the flash write of the previous chunk,
+    /// which speeds up the complete firmware download considerably on high latency connections
+    /// @return Amount of chunk requests that are kept outstanding at the same time
+    const uint8_t& Get_Pipeline_Window() const;
+
+    /// @brief Sets the amount of chunk requests that are allowed to be outstanding at the same time,
+    /// the default of 1 keeps the previous strictly serial behaviour of requesting a chunk only once the previous one has been received and written.
+    /// Values above 1 pipeline the download, hiding the request round trip time behind the flash write of the previous chunk,
+    /// chunks that overtake the expected one are buffered on the heap until the missing chunk arrived,
+    /// meaning the worst case additional heap usage is (pipelineWindow - 1) * chunkSize bytes
+    /// @param pipelineWindow Amount of chunk requests that are kept outstanding at the same time
+    void Set_Pipeline_Window(const uint8_t &pipelineWindow);
+
   private:
     progressFn      m_progressCb;    // Progress callback to call
     const char      *m_fwTitel;      // Current firmware title of device
@@ -172,6 +189,7 @@ class OTA_Update_Callback : public Callback<void, const bool&> {
     uint8_t         m_retries;       // Maximum amount of retries for a single chunk to be downloaded and flashes successfully
     uint16_t        m_size;          // Size of chunks the firmware data will be split into
     uint64_t        m_timeout;       // How long we wait for each chunck to arrive before declaring it as failed
+    uint8_t         m_pipeline_window; // Amount of chunk requests that are kept outstanding at the same time
 };
 
 #endif // THINGSBOARD_ENABLE_OTA
@@ -1,6 +1,9 @@
 // Header include.
 #include "RPC_Callback.h"
 
+// Local includes.
+#include "Helper.h"
+
 /// ---------------------------------
 /// Constant strings in flash memory.
 /// ---------------------------------
@@ -18,7 +21,8 @@ RPC_Callback::RPC_Callback() :
 
 RPC_Callback::RPC_Callback(const char *methodName, function cb) :
     Callback(cb, RPC_CB_NULL),
-    m_methodName(methodName)
+    m_methodName(methodName),
+    m_methodNameHash(Helper::fnv1aHash(methodName))
 {
     // Nothing to do
 }
@@ -26,6 +30,11 @@ const char* RPC_Callback::Get_Name() const {
     return m_methodName;
 }
 
+uint32_t RPC_Callback::Get_Name_Hash() const {
+    return m_methodNameHash;
+}
+
 void RPC_Callback::Set_Name(const char *methodName) {
     m_methodName = methodName;
+    m_methodNameHash = Helper::fnv1aHash(methodName);
 }
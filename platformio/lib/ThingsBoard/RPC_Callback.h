@@ -28,12 +28,19 @@ class RPC_Callback : public Callback<RPC_Response, RPC_Data&> {
     /// @return Pointer to the passed methodName
     const char* Get_Name() const;
 
+    /// @brief Gets the cached FNV-1a hash of the underlying method name,
+    /// allowing incoming server-side RPC requests to be dispatched with a single integer comparison per subscribed callback
+    /// instead of a string comparison, the actual string is only compared once the hashes match to guard against collisions
+    /// @return 32-bit FNV-1a hash of the passed methodName
+    uint32_t Get_Name_Hash() const;
+
     /// @brief Sets the poiner to the underlying name we expect to be sent via. server-side RPC so that this method callback will be called
     /// @param methodName Pointer to the passed methodName
     void Set_Name(const char *methodName);
 
   private:
-    const char  *m_methodName;  // Method name
+    const char  *m_methodName;      // Method name
+    uint32_t    m_methodNameHash;   // Cached FNV-1a hash of the method name
 };
 
 #endif // RPC_Callback_h
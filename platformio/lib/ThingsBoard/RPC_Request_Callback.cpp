@@ -26,7 +26,8 @@ RPC_Request_Callback::RPC_Request_Callback(const char *methodName, const JsonArr
     Callback(callback, RPC_REQUEST_CB_NULL),
     m_methodName(methodName),
     m_parameters(parameteres),
-    m_request_id(0U)
+    m_request_id(0U),
+    m_timeout_handle(-1)
 {
     // Nothing to do
 }
@@ -54,3 +55,11 @@ const JsonArray* RPC_Request_Callback::Get_Parameters() const {
 void RPC_Request_Callback::Set_Parameters(const JsonArray *parameteres) {
     m_parameters = parameteres;
 }
+
+const int& RPC_Request_Callback::Get_Timeout_Handle() const {
+    return m_timeout_handle;
+}
+
+void RPC_Request_Callback::Set_Timeout_Handle(const int &timeout_handle) {
+    m_timeout_handle = timeout_handle;
+}
@@ -58,10 +58,21 @@ class RPC_Request_Callback : public Callback<void, const JsonVariantConst&> {
     /// @param parameteres Pointer to the passed parameters
     void Set_Parameters(const JsonArray *parameteres);
 
+    /// @brief Gets the handle of the Timer_Wheel entry that removes this callback again,
+    /// if no response for the original request arrives in time
+    /// @return Handle of the armed timeout entry, or -1 if no timeout is armed
+    const int& Get_Timeout_Handle() const;
+
+    /// @brief Sets the handle of the Timer_Wheel entry that removes this callback again,
+    /// if no response for the original request arrives in time
+    /// @param timeout_handle Handle of the armed timeout entry
+    void Set_Timeout_Handle(const int &timeout_handle);
+
   private:
-    const char        *m_methodName;  // Method name
-    const JsonArray   *m_parameters;  // Parameter json
-    size_t            m_request_id;   // Id the request was called with
+    const char        *m_methodName;     // Method name
+    const JsonArray   *m_parameters;     // Parameter json
+    size_t            m_request_id;      // Id the request was called with
+    int               m_timeout_handle;  // Timer_Wheel entry that cleans this callback up if no response arrives
 };
 
 #endif // RPC_Request_Callback_h
@@ -13,12 +13,18 @@
 #include "Provision_Callback.h"
 #include "OTA_Handler.h"
 #include "IMQTT_Client.h"
+#include "Timer_Wheel.h"
+#include "Topic_Router.h"
 
 // Library includes.
 #if THINGSBOARD_ENABLE_STREAM_UTILS
 #include <StreamUtils.h>
 #endif // THINGSBOARD_ENABLE_STREAM_UTILS
 
+// Client-side RPC requests are automatically removed again, if the server has not responded within this amount of milliseconds,
+// bounding the size of the request callback vector even if responses are lost
+constexpr uint32_t RPC_REQUEST_TIMEOUT_MS = 30U * 1000U;
+
 
 /// ---------------------------------
 /// Constant strings in flash memory.
@@ -130,6 +136,7 @@ constexpr char COLON PROGMEM = ':';
 constexpr char COMMA PROGMEM = ',';
 constexpr char NO_KEYS_TO_REQUEST[] PROGMEM = "No keys to request were given";
 constexpr char RPC_METHOD_NULL[] PROGMEM = "RPC methodName is NULL";
+constexpr char RPC_REQUEST_TIMED_OUT[] PROGMEM = "Client-side RPC request with id (%u) timed out, removing stale callback";
 constexpr char SUBSCRIBE_TOPIC_FAILED[] PROGMEM = "Subscribing the given topic failed";
 #if THINGSBOARD_ENABLE_DEBUG
 constexpr char NO_RPC_PARAMS_PASSED[] PROGMEM = "No parameters passed with RPC, passing null JSON";
@@ -162,6 +169,7 @@ constexpr char COLON = ':';
 constexpr char COMMA = ',';
 constexpr char NO_KEYS_TO_REQUEST[] = "No keys to request were given";
 constexpr char RPC_METHOD_NULL[] = "RPC methodName is NULL";
+constexpr char RPC_REQUEST_TIMED_OUT[] = "Client-side RPC request with id (%u) timed out, removing stale callback";
 constexpr char SUBSCRIBE_TOPIC_FAILED[] = "Subscribing the given topic failed";
 #if THINGSBOARD_ENABLE_DEBUG
 constexpr char NO_RPC_PARAMS_PASSED[] = "No parameters passed with RPC, passing null JSON";
@@ -341,11 +349,17 @@ class ThingsBoardSized {
       , m_attribute_request_callbacks()
       , m_provision_callback()
       , m_request_id(0U)
+      , m_router()
+      , m_active_filters(0U)
+#if THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
+      , m_attribute_cache()
+      , m_attribute_cache_replace_index(0U)
+#endif // THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
 #if THINGSBOARD_ENABLE_OTA
       , m_fw_callback(nullptr)
       , m_previous_buffer_size(0U)
       , m_change_buffer_size(false)
-      , m_ota(std::bind(&ThingsBoardSized::Publish_Chunk_Request, this, std::placeholders::_1), std::bind(&ThingsBoardSized::Firmware_Send_State, this, std::placeholders::_1, std::placeholders::_2), std::bind(&ThingsBoardSized::Firmware_OTA_Unsubscribe, this))
+      , m_ota(std::bind(&ThingsBoardSized::Publish_Chunk_Request, this, std::placeholders::_1, std::placeholders::_2), std::bind(&ThingsBoardSized::Firmware_Send_State, this, std::placeholders::_1, std::placeholders::_2), std::bind(&ThingsBoardSized::Firmware_OTA_Unsubscribe, this))
 #endif // THINGSBOARD_ENABLE_OTA
     {
       setBufferSize(bufferSize);
@@ -361,6 +375,18 @@ class ThingsBoardSized {
 #if !THINGSBOARD_ENABLE_DYNAMIC
       reserve_callback_size(MaxFieldsAmt);
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
+
+      // Compile the inbound topic routes once; onMQTTMessage then walks
+      // the trie in a single pass over the received topic instead of
+      // comparing it against every candidate prefix in turn
+      m_router.Add(RPC_RESPONSE_TOPIC, ROUTE_RPC_RESPONSE);
+      m_router.Add(RPC_REQUEST_TOPIC, ROUTE_RPC_REQUEST);
+      m_router.Add(ATTRIBUTE_RESPONSE_TOPIC, ROUTE_ATTRIBUTE_RESPONSE);
+      m_router.Add(ATTRIBUTE_TOPIC, ROUTE_ATTRIBUTE_UPDATE);
+      m_router.Add(PROV_RESPONSE_TOPIC, ROUTE_PROVISION_RESPONSE);
+#if THINGSBOARD_ENABLE_OTA
+      m_router.Add(FIRMWARE_RESPONSE_TOPIC, ROUTE_FIRMWARE_RESPONSE);
+#endif // THINGSBOARD_ENABLE_OTA
     }
 
     /// @brief Destructor
@@ -495,10 +521,42 @@ class ThingsBoardSized {
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
       bool result = false;
 
+#if THINGSBOARD_ENABLE_MSGPACK
+      // MsgPack transport: binary serialization of the same document,
+      // typically 40-60% smaller on the wire than the json text form.
+      // Sent through the binary publish path, because the payload is not
+      // a null terminated string
+      {
+        const size_t packSize = measureMsgPack(source);
+        if (getMaximumStackSize() < packSize) {
+          uint8_t* pack = new uint8_t[packSize];
+          if (serializeMsgPack(source, pack, packSize) != packSize) {
+            Logger::log(UNABLE_TO_SERIALIZE_JSON);
+          }
+          else {
+            result = m_client.publish(topic, pack, packSize);
+          }
+          delete[] pack;
+          pack = nullptr;
+        }
+        else {
+          uint8_t pack[packSize];
+          if (serializeMsgPack(source, pack, packSize) != packSize) {
+            Logger::log(UNABLE_TO_SERIALIZE_JSON);
+            return result;
+          }
+          result = m_client.publish(topic, pack, packSize);
+        }
+        return result;
+      }
+#endif // THINGSBOARD_ENABLE_MSGPACK
+
 #if THINGSBOARD_ENABLE_STREAM_UTILS
       // Check if the size of the given message would be too big for the actual client,
-      // if it is utilize the serialize json work around, so that the internal client buffer can be circumvented
-      if (m_client.get_buffer_size() < jsonSize)  {
+      // if it is utilize the serialize json work around, so that the internal client buffer can be circumvented.
+      // With THINGSBOARD_ENABLE_DIRECT_SERIALIZATION every message takes this path, removing the intermediate
+      // char json[] buffer and the additional copy into the client buffer for each and every send
+      if (THINGSBOARD_ENABLE_DIRECT_SERIALIZATION || m_client.get_buffer_size() < jsonSize)  {
 #if THINGSBOARD_ENABLE_DEBUG
         char message[JSON_STRING_SIZE(strlen(SEND_MESSAGE)) + JSON_STRING_SIZE(strlen(topic)) + JSON_STRING_SIZE(strlen(SEND_SERIALIZED))];
         snprintf_P(message, sizeof(message), SEND_MESSAGE, topic, SEND_SERIALIZED);
@@ -679,6 +737,23 @@ class ThingsBoardSized {
       return sendDataArray(data, data_count);
     }
 
+#if THINGSBOARD_ENABLE_STL
+
+    /// @brief Attempts to send aggregated telemetry data from the given iterator range,
+    /// serializing every entry into a single MQTT publish.
+    /// See https://thingsboard.io/docs/user-guide/telemetry/ for more information
+    /// @tparam InputIterator Class that points to the begin and end iterator
+    /// of the given data container, allows for using / passing either std::vector or std::array
+    /// @param first_itr Iterator pointing to the first element in the data container
+    /// @param last_itr Iterator pointing to the end of the data container (last element + 1)
+    /// @return Whether sending the data was successful or not
+    template<class InputIterator>
+    inline bool sendTelemetry(const InputIterator& first_itr, const InputIterator& last_itr) {
+      return sendDataArray(first_itr, last_itr);
+    }
+
+#endif // THINGSBOARD_ENABLE_STL
+
     /// @brief Attempts to send custom json telemetry string.
     /// See https://thingsboard.io/docs/user-guide/telemetry/ for more information
     /// @param json String containing our json key value pairs we want to attempt to send
@@ -721,6 +796,24 @@ class ThingsBoardSized {
       return sendDataArray(data, data_count, false);
     }
 
+#if THINGSBOARD_ENABLE_STL
+
+    /// @brief Attempts to send aggregated attribute data from the given iterator range,
+    /// serializing every entry into a single MQTT publish,
+    /// which allows accumulating attribute changes behind a dirty flag and flushing them as exactly one packet per change burst.
+    /// See https://thingsboard.io/docs/user-guide/attributes/ for more information
+    /// @tparam InputIterator Class that points to the begin and end iterator
+    /// of the given data container, allows for using / passing either std::vector or std::array
+    /// @param first_itr Iterator pointing to the first element in the data container
+    /// @param last_itr Iterator pointing to the end of the data container (last element + 1)
+    /// @return Whether sending the data was successful or not
+    template<class InputIterator>
+    inline bool sendAttributes(const InputIterator& first_itr, const InputIterator& last_itr) {
+      return sendDataArray(first_itr, last_itr, false);
+    }
+
+#endif // THINGSBOARD_ENABLE_STL
+
     /// @brief Attempts to send custom json attribute string.
     /// See https://thingsboard.io/docs/user-guide/attributes/ for more information
     /// @param json String containing our json key value pairs we want to attempt to send
@@ -771,8 +864,7 @@ class ThingsBoardSized {
         return false;
       }
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
-      if (!m_client.subscribe(RPC_SUBSCRIBE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_RPC_REQUEST, RPC_SUBSCRIBE_TOPIC)) {
         return false;
       }
 
@@ -797,8 +889,7 @@ class ThingsBoardSized {
         return false;
       }
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
-      if (!m_client.subscribe(RPC_SUBSCRIBE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_RPC_REQUEST, RPC_SUBSCRIBE_TOPIC)) {
         return false;
       }
 
@@ -822,8 +913,7 @@ class ThingsBoardSized {
         return false;
       }
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
-      if (!m_client.subscribe(RPC_SUBSCRIBE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_RPC_REQUEST, RPC_SUBSCRIBE_TOPIC)) {
         return false;
       }
 
@@ -839,7 +929,7 @@ class ThingsBoardSized {
     inline bool RPC_Unsubscribe() {
       // Empty all callbacks
       m_rpc_callbacks.clear();
-      return m_client.unsubscribe(RPC_SUBSCRIBE_TOPIC);
+      return Unsubscribe_Filter(FILTER_RPC_REQUEST, RPC_SUBSCRIBE_TOPIC);
     }
 
     //----------------------------------------------------------------------------
@@ -898,6 +988,13 @@ class ThingsBoardSized {
       m_request_id++;
       registeredCallback->Set_Request_ID(m_request_id);
 
+      // Arm a cleanup timeout on the shared timer wheel, which removes the callback again if the server never responds,
+      // so stale entries can not accumulate in the subscription vector until MAX_RPC_REQUEST_EXCEEDED
+      const size_t request_id = m_request_id;
+      registeredCallback->Set_Timeout_Handle(Timer_Wheel::Get_Instance().Arm(RPC_REQUEST_TIMEOUT_MS, [this, request_id]() {
+        RPC_Request_Timeout(request_id);
+      }));
+
       char topic[Helper::detectSize(RPC_SEND_REQUEST_TOPIC, m_request_id)];
       snprintf_P(topic, sizeof(topic), RPC_SEND_REQUEST_TOPIC, m_request_id);
 
@@ -1016,8 +1113,7 @@ class ThingsBoardSized {
         return false;
       }
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
-      if (!m_client.subscribe(ATTRIBUTE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_ATTRIBUTE_UPDATE, ATTRIBUTE_TOPIC)) {
         return false;
       }
 
@@ -1042,8 +1138,7 @@ class ThingsBoardSized {
         return false;
       }
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
-      if (!m_client.subscribe(ATTRIBUTE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_ATTRIBUTE_UPDATE, ATTRIBUTE_TOPIC)) {
         return false;
       }
 
@@ -1067,8 +1162,7 @@ class ThingsBoardSized {
         return false;
       }
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
-      if (!m_client.subscribe(ATTRIBUTE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_ATTRIBUTE_UPDATE, ATTRIBUTE_TOPIC)) {
         return false;
       }
 
@@ -1084,7 +1178,7 @@ class ThingsBoardSized {
     inline bool Shared_Attributes_Unsubscribe() {
       // Empty all callbacks
       m_shared_attribute_update_callbacks.clear();
-      return m_client.unsubscribe(ATTRIBUTE_TOPIC);
+      return Unsubscribe_Filter(FILTER_ATTRIBUTE_UPDATE, ATTRIBUTE_TOPIC);
     }
   
   private:
@@ -1120,20 +1214,18 @@ class ThingsBoardSized {
 
     /// @brief Publishes a request via MQTT to request the given firmware chunk
     /// @param request_chunck Chunk index that should be requested from the server
+    /// @param chunk_size Size in bytes the server should slice the requested chunk to,
+    /// passed by the OTA handler because it adapts the size to the observed link quality during the session
     /// @return Whether publishing the message was successful or not
-    inline bool Publish_Chunk_Request(const size_t& request_chunck) {
-      // Calculate the number of chuncks we need to request,
-      // in order to download the complete firmware binary
-      const uint16_t& chunk_size = m_fw_callback->Get_Chunk_Size();
-
+    inline bool Publish_Chunk_Request(const size_t& request_chunck, const size_t& chunk_size) {
       // Convert the interger size into a readable string
       char size[Helper::detectSize(NUMBER_PRINTF, chunk_size)];
       snprintf_P(size, sizeof(size), NUMBER_PRINTF, chunk_size);
       const size_t jsonSize = strlen(size);
 
       // Size adjuts dynamically to the current length of the currChunk number to ensure we don't cut it out of the topic string.
-      char topic[Helper::detectSize(FIRMWARE_REQUEST_TOPIC, request_chunck)];
-      snprintf_P(topic, sizeof(topic), FIRMWARE_REQUEST_TOPIC, request_chunck);
+      char topic[sizeof(FIRMWARE_REQUEST_TOPIC) + Helper::Max_Unsigned_Digits];
+      (void)Helper::assembleIdTopic(topic, FIRMWARE_REQUEST_TOPIC, request_chunck);
 
       return m_client.publish(topic, reinterpret_cast<uint8_t*>(size), jsonSize);
     }
@@ -1234,8 +1326,8 @@ class ThingsBoardSized {
       registeredCallback->Set_Request_ID(m_request_id);
       registeredCallback->Set_Attribute_Key(attributeResponseKey);
 
-      char topic[Helper::detectSize(ATTRIBUTE_REQUEST_TOPIC, m_request_id)];
-      snprintf_P(topic, sizeof(topic), ATTRIBUTE_REQUEST_TOPIC, m_request_id);
+      char topic[sizeof(ATTRIBUTE_REQUEST_TOPIC) + Helper::Max_Unsigned_Digits];
+      (void)Helper::assembleIdTopic(topic, ATTRIBUTE_REQUEST_TOPIC, m_request_id);
 
       const size_t objectSize = Helper::Measure_Json(requestBuffer);
       return Send_Json(topic, requestBuffer, objectSize);
@@ -1246,8 +1338,7 @@ class ThingsBoardSized {
     /// @param callback Callback method that will be called
     /// @return Whether requesting the given callback was successful or not
     inline bool Provision_Subscribe(const Provision_Callback& callback) {
-      if (!m_client.subscribe(PROV_RESPONSE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_PROVISION, PROV_RESPONSE_TOPIC)) {
         return false;
       }
       m_provision_callback = callback;
@@ -1259,7 +1350,7 @@ class ThingsBoardSized {
     /// and from the provision response topic, was successful or not
     inline bool Provision_Unsubscribe() {
       m_provision_callback = Provision_Callback();
-      return m_client.unsubscribe(PROV_RESPONSE_TOPIC);
+      return Unsubscribe_Filter(FILTER_PROVISION, PROV_RESPONSE_TOPIC);
     }
 
 #if THINGSBOARD_ENABLE_OTA
@@ -1288,8 +1379,7 @@ class ThingsBoardSized {
     /// @brief Subscribes to the firmware response topic
     /// @return Whether subscribing to the firmware response topic was successful or not
     inline bool Firmware_OTA_Subscribe() {
-      if (!m_client.subscribe(FIRMWARE_RESPONSE_SUBSCRIBE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_FIRMWARE, FIRMWARE_RESPONSE_SUBSCRIBE_TOPIC)) {
         Firmware_Send_State(FW_STATE_FAILED, SUBSCRIBE_TOPIC_FAILED);
         return false;
       }
@@ -1309,7 +1399,7 @@ class ThingsBoardSized {
       // Reset now not needed private member variables
       m_fw_callback = nullptr;
       // Unsubscribe from the topic
-      return m_client.unsubscribe(FIRMWARE_RESPONSE_SUBSCRIBE_TOPIC);
+      return Unsubscribe_Filter(FILTER_FIRMWARE, FIRMWARE_RESPONSE_SUBSCRIBE_TOPIC);
     }
 
     /// @brief Callback that will be called upon firmware shared attribute arrival
@@ -1425,8 +1515,14 @@ class ThingsBoardSized {
         return connection_result;
       }
 
-      // Only attempt to resubscribe if we connected successfully
-      Resubscribe_Topics();
+      // Only attempt to resubscribe if we connected successfully and the
+      // broker did not already resume a persistent session holding our
+      // subscriptions (clean-session=false), which saves the subscribe
+      // round trips in exactly the window where buffered data should flush
+      if (!m_client.session_present()) {
+        m_active_filters = 0U;
+        Resubscribe_Topics();
+      }
       return connection_result;
     }
 
@@ -1435,11 +1531,44 @@ class ThingsBoardSized {
     /// This is done, because the chance of disconnecting the moment when a request event (provisioning, attribute request, client-side rpc) was sent
     /// and then reconnecting and resubscribing to that topic fast enough to still receive the message is not feasible
     inline void Resubscribe_Topics() {
+      // Collect every needed filter first and drop the ones already
+      // covered by another collected filter (wildcard subsumption), then
+      // establish the minimal covering set with a single SUBSCRIBE
+      // packet — one round trip however many subsystems resubscribe
+      size_t table_size = 0U;
+      const Filter_Entry* table = Filter_Table(table_size);
+      uint8_t wanted = 0U;
       if (!m_rpc_callbacks.empty()) {
-        m_client.subscribe(RPC_SUBSCRIBE_TOPIC);
+        wanted |= FILTER_RPC_REQUEST;
       }
       if (!m_shared_attribute_update_callbacks.empty()) {
-        m_client.subscribe(ATTRIBUTE_TOPIC);
+        wanted |= FILTER_ATTRIBUTE_UPDATE;
+      }
+      const char* topics[6U];
+      size_t count = 0U;
+      uint8_t established = 0U;
+      for (size_t i = 0U; i < table_size; i++) {
+        if (!(wanted & table[i].bit)) {
+          continue;
+        }
+        bool covered = false;
+        for (size_t j = 0U; j < table_size && !covered; j++) {
+          covered = j != i && (wanted & table[j].bit) &&
+                    Topic_Router::Filter_Covers(table[j].topic, table[i].topic);
+        }
+        if (!covered) {
+          topics[count++] = table[i].topic;
+        }
+        established |= table[i].bit;
+      }
+      if (count == 0U) {
+        return;
+      }
+      if (m_client.subscribe_many(topics, count)) {
+        m_active_filters |= established;
+      }
+      else {
+        Logger::log(SUBSCRIBE_TOPIC_FAILED);
       }
     }
 
@@ -1468,8 +1597,7 @@ class ThingsBoardSized {
         return false;
       }
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
-      if (!m_client.subscribe(RPC_RESPONSE_SUBSCRIBE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_RPC_RESPONSE, RPC_RESPONSE_SUBSCRIBE_TOPIC)) {
         return false;
       }
 
@@ -1483,9 +1611,12 @@ class ThingsBoardSized {
     /// @return Whether unsubcribing the previously subscribed callbacks
     /// and from the client-side RPC response topic, was successful or not
     inline bool RPC_Request_Unsubscribe() {
-      // Empty all callbacks
+      // Empty all callbacks, disarming any cleanup timeouts that are still pending for them
+      for (size_t i = 0; i < m_rpc_request_callbacks.size(); i++) {
+        Timer_Wheel::Get_Instance().Disarm(m_rpc_request_callbacks.at(i).Get_Timeout_Handle());
+      }
       m_rpc_request_callbacks.clear();
-      return m_client.unsubscribe(RPC_RESPONSE_SUBSCRIBE_TOPIC);
+      return Unsubscribe_Filter(FILTER_RPC_RESPONSE, RPC_RESPONSE_SUBSCRIBE_TOPIC);
     }
 
     /// @brief Subscribes to attribute response topic
@@ -1499,8 +1630,7 @@ class ThingsBoardSized {
         return false;
       }
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
-      if (!m_client.subscribe(ATTRIBUTE_RESPONSE_SUBSCRIBE_TOPIC)) {
-        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+      if (!Subscribe_Filter(FILTER_ATTRIBUTE_RESPONSE, ATTRIBUTE_RESPONSE_SUBSCRIBE_TOPIC)) {
         return false;
       }
 
@@ -1516,7 +1646,7 @@ class ThingsBoardSized {
     inline bool Attributes_Request_Unsubscribe() {
       // Empty all callbacks
       m_attribute_request_callbacks.clear();
-      return m_client.unsubscribe(ATTRIBUTE_RESPONSE_SUBSCRIBE_TOPIC);
+      return Unsubscribe_Filter(FILTER_ATTRIBUTE_RESPONSE, ATTRIBUTE_RESPONSE_SUBSCRIBE_TOPIC);
     }
 
     /// @brief Attempts to send a single key-value pair with the given key and value of the given type
@@ -1544,6 +1674,30 @@ class ThingsBoardSized {
       return telemetry ? sendTelemetryJson(object, Helper::Measure_Json(object)) : sendAttributeJSON(object, Helper::Measure_Json(object));
     }
 
+    /// @brief Removes a client-side RPC request callback whose response has not arrived within RPC_REQUEST_TIMEOUT_MS,
+    /// called from the shared timer wheel, meaning from the timer task. Keeps the subscription vector bounded,
+    /// because lost responses previously left their entry behind until MAX_RPC_REQUEST_EXCEEDED was hit
+    /// @param request_id Unique identifier of the request that timed out
+    inline void RPC_Request_Timeout(const size_t& request_id) {
+      for (size_t i = 0; i < m_rpc_request_callbacks.size(); i++) {
+        if (m_rpc_request_callbacks.at(i).Get_Request_ID() != request_id) {
+          continue;
+        }
+        char message[Helper::detectSize(RPC_REQUEST_TIMED_OUT, request_id)];
+        snprintf_P(message, sizeof(message), RPC_REQUEST_TIMED_OUT, request_id);
+        Logger::log(message);
+        Helper::remove(m_rpc_request_callbacks, i);
+        break;
+      }
+
+      // Attempt to unsubscribe from the client-side RPC response topic,
+      // if we are not waiting for any further responses from the server.
+      // Will be resubscribed if another request is sent anyway
+      if (m_rpc_request_callbacks.empty()) {
+        RPC_Request_Unsubscribe();
+      }
+    }
+
     /// @brief Process callback that will be called upon client-side RPC response arrival
     /// and is responsible for handling the payload and calling the appropriate previously subscribed callbacks
     /// @param topic Previously subscribed topic, we got the response over
@@ -1571,6 +1725,9 @@ class ThingsBoardSized {
           continue;
         }
 
+        // The response arrived, the cleanup timeout armed for this request is no longer needed
+        Timer_Wheel::Get_Instance().Disarm(rpc_request.Get_Timeout_Handle());
+
 #if THINGSBOARD_ENABLE_DEBUG
         char message[Helper::detectSize(CALLING_REQUEST_CB, response_id)];
         snprintf_P(message, sizeof(message), CALLING_REQUEST_CB, response_id);
@@ -1608,15 +1765,19 @@ class ThingsBoardSized {
  
       RPC_Response response;
 
+      // Hash the incoming method name once, dispatching then only needs a single integer comparison per subscribed callback,
+      // keeping the time spent inside the MQTT receive callback minimal even with many subscribed server-side RPC methods
+      const uint32_t methodNameHash = Helper::fnv1aHash(methodName);
+
       for (const RPC_Callback& rpc : m_rpc_callbacks) {
         const char *subscribedMethodName = rpc.Get_Name();
         if (subscribedMethodName == nullptr) {
           Logger::log(RPC_METHOD_NULL);
           continue;
         }
-        // Strncmp returns the ascii value difference of the ascii characters that are different,
-        // meaning 0 is the same string and less and more than 0 is the difference in ascci values between the 2 chararacters.
-        else if (strncmp(subscribedMethodName, methodName, strlen(subscribedMethodName)) != 0) {
+        // Compare the cached hashes first and only fall back to an actual string comparison once they match,
+        // ensuring possible hash collisions can never call the wrong callback
+        else if (rpc.Get_Name_Hash() != methodNameHash || strcmp(subscribedMethodName, methodName) != 0) {
           continue;
         }
 
@@ -1643,23 +1804,12 @@ class ThingsBoardSized {
         return;
       }
 
-      // Remove the not needed part of the received topic string, which is everything before the request id,
-      // therefore we remove the section before that which is the topic + an additional "/" character, that seperates the topic from the request id.
-      // Meaning the index we want to get the substring from is the length of the topic + 1 for the additonal "/" character
-      const size_t index = strlen(RPC_REQUEST_TOPIC) + 1U;
-#if THINGSBOARD_ENABLE_STL
-      std::string request = topic;
-      request = request.substr(index, request.length() - index);
-#else
-      String request = topic;
-      request = request.substring(index);
-#endif // THINGSBOARD_ENABLE_STL
+      // The request id directly follows the constant topic + an additional "/" character that seperates the topic from the request id,
+      // parsing it in place avoids the previous temporary string copy of the complete topic inside the receive callback
+      const size_t request_id = atoi(topic + strlen(RPC_REQUEST_TOPIC) + 1U);
 
-      // Convert the remaining text after the topic to an integer, because it should now contain only the request id
-      const size_t request_id = atoi(request.c_str());
-
-      char responseTopic[Helper::detectSize(RPC_SEND_RESPONSE_TOPIC, request_id)];
-      snprintf_P(responseTopic, sizeof(responseTopic), RPC_SEND_RESPONSE_TOPIC, request_id);
+      char responseTopic[sizeof(RPC_SEND_RESPONSE_TOPIC) + Helper::Max_Unsigned_Digits];
+      (void)Helper::assembleIdTopic(responseTopic, RPC_SEND_RESPONSE_TOPIC, request_id);
 
       const size_t jsonSize = Helper::Measure_Json(response);
       Send_Json(responseTopic, response, jsonSize);
@@ -1712,6 +1862,33 @@ class ThingsBoardSized {
     /// and is responsible for handling the payload and calling the appropriate previously subscribed callbacks
     /// @param topic Previously subscribed topic, we got the response over
     /// @param data Payload sent by the server over our given topic, that contains our key value pairs
+#if THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
+    /// @brief Checks whether the given attribute value differs from the last one seen for that attribute and updates the cache accordingly.
+    /// If the attribute is not tracked yet it is inserted, replacing the oldest entry once the cache is full,
+    /// a replaced entry can only ever cause an unchanged value to be delivered again, never a changed value to be dropped
+    /// @param key_hash FNV-1a hash of the attribute name
+    /// @param value_hash FNV-1a hash of the serialized attribute value
+    /// @return Whether the value changed since the last received update for that attribute or not
+    inline bool attribute_value_changed(const uint32_t& key_hash, const uint32_t& value_hash) {
+      for (size_t i = 0; i < THINGSBOARD_ATTRIBUTE_CACHE_SIZE; i++) {
+        if (m_attribute_cache[i].key_hash != key_hash) {
+          continue;
+        }
+        if (m_attribute_cache[i].value_hash == value_hash) {
+          return false;
+        }
+        m_attribute_cache[i].value_hash = value_hash;
+        return true;
+      }
+      // Attribute is not tracked yet, insert it into the next free or oldest slot
+      Attribute_Cache_Entry& entry = m_attribute_cache[m_attribute_cache_replace_index];
+      m_attribute_cache_replace_index = (m_attribute_cache_replace_index + 1U) % THINGSBOARD_ATTRIBUTE_CACHE_SIZE;
+      entry.key_hash = key_hash;
+      entry.value_hash = value_hash;
+      return true;
+    }
+#endif // THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
+
     inline void process_shared_attribute_update_message(char *topic, JsonObjectConst& data) {
       if (!data) {
 #if THINGSBOARD_ENABLE_DEBUG
@@ -1724,6 +1901,45 @@ class ThingsBoardSized {
         data = data[SHARED_RESPONSE_KEY];
       }
 
+#if THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
+      // Filter the received attributes against the client-side cache,
+      // so the subscribed callbacks are only invoked with the attributes whose values actually changed
+#if THINGSBOARD_ENABLE_DYNAMIC
+      TBJsonDocument changedBuffer(JSON_OBJECT_SIZE(data.size()) + Default_Payload);
+#else
+      StaticJsonDocument<JSON_OBJECT_SIZE(MaxFieldsAmt) + Default_Payload> changedBuffer;
+#endif // THINGSBOARD_ENABLE_DYNAMIC
+      JsonObject changed = changedBuffer.template to<JsonObject>();
+      bool filtered = true;
+      size_t changed_count = 0U;
+      for (JsonPairConst kv : data) {
+        // The value is compared over the hash of its serialized representation,
+        // which sidesteps having to store and compare the actual values of arbitrary types
+        const size_t value_size = JSON_STRING_SIZE(measureJson(kv.value()));
+        char value_string[value_size];
+        serializeJson(kv.value(), value_string, value_size);
+        if (!attribute_value_changed(Helper::fnv1aHash(kv.key().c_str()), Helper::fnv1aHash(value_string))) {
+          continue;
+        }
+        // Copying can fail if the filtered document runs out of memory,
+        // in that case the complete received set is delivered instead of silently dropping a changed value
+        if (!changed[kv.key()].set(kv.value())) {
+          filtered = false;
+          break;
+        }
+        changed_count++;
+      }
+      if (filtered && changed_count == 0U) {
+#if THINGSBOARD_ENABLE_DEBUG
+        Logger::log(ATT_NO_CHANGE);
+#endif // THINGSBOARD_ENABLE_DEBUG
+        return;
+      }
+      if (filtered) {
+        data = changedBuffer.template as<JsonObjectConst>();
+      }
+#endif // THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
+
       for (const Shared_Attribute_Callback& shared_attribute : m_shared_attribute_update_callbacks) {
 #if THINGSBOARD_ENABLE_STL
         if (shared_attribute.Get_Attributes().empty()) {
@@ -1893,7 +2109,13 @@ class ThingsBoardSized {
       // Data structure size depends on the amount of key value pairs passed.
       // See https://arduinojson.org/v6/assistant/ for more information on the needed size for the JsonDocument
       const size_t dataStructureMemoryUsage = JSON_OBJECT_SIZE(data_count);
+#if THINGSBOARD_ENABLE_TELEMETRY_POOL
+      // Document is constructed over the preallocated slab that is reused across send cycles,
+      // meaning a periodic telemetry cadence causes no steady-state heap allocations at all
+      TBTelemetryDocument jsonBuffer(dataStructureMemoryUsage);
+#else
       TBJsonDocument jsonBuffer(dataStructureMemoryUsage);
+#endif // THINGSBOARD_ENABLE_TELEMETRY_POOL
 #else
       StaticJsonDocument<JSON_OBJECT_SIZE(MaxFieldsAmt)> jsonBuffer;
 #endif // !THINGSBOARD_ENABLE_DYNAMIC
@@ -1910,6 +2132,47 @@ class ThingsBoardSized {
       return telemetry ? sendTelemetryJson(object, Helper::Measure_Json(object)) : sendAttributeJSON(object, Helper::Measure_Json(object));
     }
 
+#if THINGSBOARD_ENABLE_STL
+
+    /// @brief Attempts to send aggregated attribute or telemetry data from the given iterator range
+    /// @tparam InputIterator Class that points to the begin and end iterator
+    /// of the given data container, allows for using / passing either std::vector or std::array
+    /// @param first_itr Iterator pointing to the first element in the data container
+    /// @param last_itr Iterator pointing to the end of the data container (last element + 1)
+    /// @param telemetry Whether the data we want to send should be sent as an attribute or telemetry data value
+    /// @return Whether sending the data was successful or not
+    template<class InputIterator>
+    inline bool sendDataArray(const InputIterator& first_itr, const InputIterator& last_itr, bool telemetry = true) {
+#if THINGSBOARD_ENABLE_DYNAMIC
+      // String are const char* and therefore stored as a pointer --> zero copy, meaning the size for the strings is 0 bytes,
+      // Data structure size depends on the amount of key value pairs passed.
+      // See https://arduinojson.org/v6/assistant/ for more information on the needed size for the JsonDocument
+      const size_t dataStructureMemoryUsage = JSON_OBJECT_SIZE(std::distance(first_itr, last_itr));
+#if THINGSBOARD_ENABLE_TELEMETRY_POOL
+      // Document is constructed over the preallocated slab that is reused across send cycles,
+      // meaning a periodic telemetry cadence causes no steady-state heap allocations at all
+      TBTelemetryDocument jsonBuffer(dataStructureMemoryUsage);
+#else
+      TBJsonDocument jsonBuffer(dataStructureMemoryUsage);
+#endif // THINGSBOARD_ENABLE_TELEMETRY_POOL
+#else
+      StaticJsonDocument<JSON_OBJECT_SIZE(MaxFieldsAmt)> jsonBuffer;
+#endif // !THINGSBOARD_ENABLE_DYNAMIC
+
+      const JsonVariant object = jsonBuffer.template to<JsonVariant>();
+
+      for (auto itr = first_itr; itr != last_itr; ++itr) {
+        if (!itr->SerializeKeyValue(object)) {
+          Logger::log(UNABLE_TO_SERIALIZE);
+          return false;
+        }
+      }
+
+      return telemetry ? sendTelemetryJson(object, Helper::Measure_Json(object)) : sendAttributeJSON(object, Helper::Measure_Json(object));
+    }
+
+#endif // THINGSBOARD_ENABLE_STL
+
     /// @brief Vector signature
 #if THINGSBOARD_ENABLE_STL
     template<typename T>
@@ -1936,6 +2199,102 @@ class ThingsBoardSized {
     Provision_Callback m_provision_callback; // Provision response callback
     size_t m_request_id; // Allows nearly 4.3 million requests before wrapping back to 0
 
+    /// @brief Route ids the topic trie hands back for inbound messages, one per process method.
+    /// The previous strncmp chain needed the more specific attribute response topic compared
+    /// before the attribute update topic; longest-prefix matching in the trie makes order irrelevant
+    enum Message_Route : uint8_t {
+      ROUTE_RPC_RESPONSE = 0U,
+      ROUTE_RPC_REQUEST,
+      ROUTE_ATTRIBUTE_RESPONSE,
+      ROUTE_ATTRIBUTE_UPDATE,
+      ROUTE_PROVISION_RESPONSE,
+#if THINGSBOARD_ENABLE_OTA
+      ROUTE_FIRMWARE_RESPONSE,
+#endif // THINGSBOARD_ENABLE_OTA
+    };
+
+    /// @brief Bitmask of the topic filters currently subscribed at the broker.
+    /// Each subscribe call first consults this set, so registering a second RPC callback
+    /// or reconnecting a resumed session never re-sends a SUBSCRIBE for an already active filter
+    enum Subscription_Filter : uint8_t {
+      FILTER_RPC_REQUEST = 1U << 0U,
+      FILTER_RPC_RESPONSE = 1U << 1U,
+      FILTER_ATTRIBUTE_UPDATE = 1U << 2U,
+      FILTER_ATTRIBUTE_RESPONSE = 1U << 3U,
+      FILTER_PROVISION = 1U << 4U,
+      FILTER_FIRMWARE = 1U << 5U,
+    };
+
+    Topic_Router m_router; // Compiled prefix trie routing inbound messages to their process method
+    uint8_t m_active_filters; // Subscription_Filter bits of the filters active at the broker
+
+    /// @brief Table of every topic filter the client can subscribe, used to check whether
+    /// an already active filter covers a requested one before sending a SUBSCRIBE
+    struct Filter_Entry {
+      uint8_t bit;
+      const char* topic;
+    };
+    inline const Filter_Entry* Filter_Table(size_t& count) const {
+      static const Filter_Entry table[] = {
+        { FILTER_RPC_REQUEST, RPC_SUBSCRIBE_TOPIC },
+        { FILTER_RPC_RESPONSE, RPC_RESPONSE_SUBSCRIBE_TOPIC },
+        { FILTER_ATTRIBUTE_UPDATE, ATTRIBUTE_TOPIC },
+        { FILTER_ATTRIBUTE_RESPONSE, ATTRIBUTE_RESPONSE_SUBSCRIBE_TOPIC },
+        { FILTER_PROVISION, PROV_RESPONSE_TOPIC },
+#if THINGSBOARD_ENABLE_OTA
+        { FILTER_FIRMWARE, FIRMWARE_RESPONSE_SUBSCRIBE_TOPIC },
+#endif // THINGSBOARD_ENABLE_OTA
+      };
+      count = sizeof(table) / sizeof(table[0U]);
+      return table;
+    }
+
+    /// @brief Subscribes the given topic filter at the broker, unless it is already active
+    /// or an already active filter covers it under the MQTT wildcard rules.
+    /// Repeated callback registrations therefore reuse the one broker-side subscription
+    /// instead of re-sending a SUBSCRIBE packet per registration
+    /// @param filter_bit Subscription_Filter bit identifying the filter
+    /// @param topic Topic filter that should be active at the broker
+    /// @return Whether the filter is active at the broker after the call or not
+    inline bool Subscribe_Filter(const uint8_t& filter_bit, const char* topic) {
+      if (m_active_filters & filter_bit) {
+        return true;
+      }
+      size_t count = 0U;
+      const Filter_Entry* table = Filter_Table(count);
+      for (size_t i = 0U; i < count; i++) {
+        if ((m_active_filters & table[i].bit) && Topic_Router::Filter_Covers(table[i].topic, topic)) {
+          m_active_filters |= filter_bit;
+          return true;
+        }
+      }
+      if (!m_client.subscribe(topic)) {
+        Logger::log(SUBSCRIBE_TOPIC_FAILED);
+        return false;
+      }
+      m_active_filters |= filter_bit;
+      return true;
+    }
+
+    /// @brief Unsubscribes the given topic filter and clears its active bit
+    /// @param filter_bit Subscription_Filter bit identifying the filter
+    /// @param topic Topic filter that should no longer be active at the broker
+    /// @return Whether unsubscribing the filter was successful or not
+    inline bool Unsubscribe_Filter(const uint8_t& filter_bit, const char* topic) {
+      m_active_filters &= static_cast<uint8_t>(~filter_bit);
+      return m_client.unsubscribe(topic);
+    }
+
+#if THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
+    // Cached key and value hash of a shared attribute, used to detect whether a received value actually changed
+    struct Attribute_Cache_Entry {
+      uint32_t key_hash = 0U;   // FNV-1a hash of the attribute name, 0 means the slot is unused
+      uint32_t value_hash = 0U; // FNV-1a hash of the serialized attribute value that was last received
+    };
+    Attribute_Cache_Entry m_attribute_cache[THINGSBOARD_ATTRIBUTE_CACHE_SIZE]; // Client-side cache of the last received shared attribute values
+    size_t m_attribute_cache_replace_index; // Slot that is replaced next once the cache is full, advances round robin
+#endif // THINGSBOARD_ENABLE_ATTRIBUTE_DELTA
+
 #if THINGSBOARD_ENABLE_OTA
     const OTA_Update_Callback *m_fw_callback; // Ota update response callback
     uint16_t m_previous_buffer_size; // Previous buffer size of the underlying client, used to revert to the previously configured buffer size if it was temporarily increased by the OTA update
@@ -1954,15 +2313,69 @@ class ThingsBoardSized {
       Logger::log(message);
 #endif // THINGSBOARD_ENABLE_DEBUG
 
+      // One pass over the topic bytes decides the route for the whole callback,
+      // instead of rescanning the topic once per candidate with strncmp.
+      // Longest-prefix matching in the trie also makes the dispatch below
+      // order independent (previously the attribute response topic had to be
+      // compared before the attribute update topic, because the latter is a prefix of the former)
+      const uint8_t route = m_router.Route(topic);
+
 #if THINGSBOARD_ENABLE_OTA
       // When receiving the ota binary payload we do not want to deserialize it into json, because it only contains
       // firmware bytes that should be directly writtin into flash, therefore we can skip that step and directly process those bytes
-      if (strncmp_P(FIRMWARE_RESPONSE_TOPIC, topic, strlen(FIRMWARE_RESPONSE_TOPIC)) == 0) {
+      if (route == ROUTE_FIRMWARE_RESPONSE) {
         process_firmware_response(topic, payload, length);
         return;
       }
 #endif // THINGSBOARD_ENABLE_OTA
 
+      // Shared attribute update payloads are filtered down to the keys the
+      // registered callbacks actually declared: the server may push a large
+      // attribute set, but handlers typically consume one or two values, and
+      // everything the filter rejects is skipped by the parser instead of
+      // being stored in the document. RPC messages are not filtered, their
+      // payload only consists of the method and params entries which are both always needed
+      const bool attribute_update_topic = route == ROUTE_ATTRIBUTE_UPDATE;
+      bool use_update_filter = attribute_update_topic && !m_shared_attribute_update_callbacks.empty();
+#if THINGSBOARD_ENABLE_DYNAMIC
+      size_t subscribed_key_count = 0U;
+#if THINGSBOARD_ENABLE_STL
+      for (const Shared_Attribute_Callback& shared_attribute : m_shared_attribute_update_callbacks) {
+        subscribed_key_count += shared_attribute.Get_Attributes().size();
+      }
+#endif // THINGSBOARD_ENABLE_STL
+      // Every subscribed key appears twice in the filter (flat and wrapped in the shared response key), plus the wrapping object itself
+      TBJsonDocument update_filter(JSON_OBJECT_SIZE((2U * subscribed_key_count) + 1U));
+#else
+      StaticJsonDocument<JSON_OBJECT_SIZE((2U * MaxFieldsAmt) + 1U)> update_filter;
+#endif // THINGSBOARD_ENABLE_DYNAMIC
+      if (use_update_filter) {
+#if THINGSBOARD_ENABLE_STL
+        for (const Shared_Attribute_Callback& shared_attribute : m_shared_attribute_update_callbacks) {
+          if (shared_attribute.Get_Attributes().empty()) {
+            // A callback subscribed to every attribute, nothing may be filtered out
+            use_update_filter = false;
+            break;
+          }
+          for (const char *attribute : shared_attribute.Get_Attributes()) {
+            // Updates arrive either flat or wrapped in the shared response key, allow the subscribed attribute in both shapes.
+            // Should the filter document run out of slots the payload is parsed unfiltered instead, so no subscribed attribute is ever dropped
+            if (!update_filter[attribute].set(true) || !update_filter[SHARED_RESPONSE_KEY][attribute].set(true)) {
+              use_update_filter = false;
+              break;
+            }
+          }
+          if (!use_update_filter) {
+            break;
+          }
+        }
+#else
+        // The non STL callbacks store their keys as one comma seperated string,
+        // tearing that apart per message would cost more than the filtering saves
+        use_update_filter = false;
+#endif // THINGSBOARD_ENABLE_STL
+      }
+
 #if THINGSBOARD_ENABLE_DYNAMIC
       // Buffer that we deserialize is writeable and not read only --> zero copy, meaning the size for the data is 0 bytes,
       // Data structure size depends on the amount of key value pairs received.
@@ -1975,8 +2388,13 @@ class ThingsBoardSized {
 
       // The deserializeJson method we use, can use the zero copy mode because a writeable input was passed,
       // if that were not the case the needed allocated memory would drastically increase, because the keys would need to be copied as well.
+      // Because of that every string in the resulting document points directly into the received MQTT packet buffer,
+      // which is reused for the next incoming packet, meaning the strings are only valid until this callback returns
+      // and the called process methods therefore have to consume the data instead of storing pointers to it.
       // See https://arduinojson.org/v6/doc/deserialization/ for more info on ArduinoJson deserialization
-      const DeserializationError error = deserializeJson(jsonBuffer, payload, length);
+      const DeserializationError error = use_update_filter
+        ? deserializeJson(jsonBuffer, payload, length, DeserializationOption::Filter(update_filter))
+        : deserializeJson(jsonBuffer, payload, length);
       if (error) {
         char message[Helper::detectSize(UNABLE_TO_DE_SERIALIZE_JSON, error.c_str())];
         snprintf_P(message, sizeof(message), UNABLE_TO_DE_SERIALIZE_JSON, error.c_str());
@@ -1988,26 +2406,28 @@ class ThingsBoardSized {
       // and would result in the data simply being "null", instead .as() allows accessing the data over a JsonObjectConst instead.
       JsonObjectConst data = jsonBuffer.template as<JsonObjectConst>();
 
-      // Checks to ensure we forward the already json serialized data to the correct process function,
-      // especially important is the order of ATTRIBUTE_RESPONSE_TOPIC and ATTRIBUTE_TOPIC,
-      // that is the case because the more specific one that is longer but contains the same text has to be checked first,
-      // because if we do not do that then even if we receive a message from the ATTRIBUTE_RESPONSE_TOPIC
-      // we would call the process method for the ATTRIBUTE_TOPIC because we only compare until the end of the ATTRIBUTE_TOPIC string,
-      // therefore the received topic is exactly the same. Therefore the ordering needs to stay the same for thoose two specific checks
-      if (strncmp_P(RPC_RESPONSE_TOPIC, topic, strlen(RPC_RESPONSE_TOPIC)) == 0) {
-        process_rpc_request_message(topic, data);
-      }
-      else if (strncmp_P(RPC_REQUEST_TOPIC, topic, strlen(RPC_REQUEST_TOPIC)) == 0) {
-        process_rpc_message(topic, data);
-      }
-      else if (strncmp_P(ATTRIBUTE_RESPONSE_TOPIC, topic, strlen(ATTRIBUTE_RESPONSE_TOPIC)) == 0) {
-        process_attribute_request_message(topic, data);
-      }
-      else if (strncmp_P(ATTRIBUTE_TOPIC, topic, strlen(ATTRIBUTE_TOPIC)) == 0) {
-        process_shared_attribute_update_message(topic, data);
-      }
-      else if (strncmp_P(PROV_RESPONSE_TOPIC, topic, strlen(PROV_RESPONSE_TOPIC)) == 0) {
-        process_provisioning_response(topic, data);
+      // Forward the already json deserialized data to the correct process function,
+      // the route was decided by the topic trie above with longest-prefix semantics,
+      // so the ATTRIBUTE_RESPONSE_TOPIC / ATTRIBUTE_TOPIC prefix ambiguity is already resolved
+      switch (route) {
+        case ROUTE_RPC_RESPONSE:
+          process_rpc_request_message(topic, data);
+          break;
+        case ROUTE_RPC_REQUEST:
+          process_rpc_message(topic, data);
+          break;
+        case ROUTE_ATTRIBUTE_RESPONSE:
+          process_attribute_request_message(topic, data);
+          break;
+        case ROUTE_ATTRIBUTE_UPDATE:
+          process_shared_attribute_update_message(topic, data);
+          break;
+        case ROUTE_PROVISION_RESPONSE:
+          process_provisioning_response(topic, data);
+          break;
+        default:
+          // Message on a topic we never registered a route for, nothing to process
+          break;
       }
     }
 
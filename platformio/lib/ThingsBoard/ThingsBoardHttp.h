@@ -79,6 +79,9 @@ class ThingsBoardHttpSized {
       : m_client(client)
       , m_max_stack(maxStackSize)
       , m_token(access_token)
+      , m_host(host)
+      , m_port(port)
+      , m_keep_alive(keepAlive)
     {
       m_client.set_keep_alive(keepAlive);
       m_client.connect(host, port);
@@ -273,6 +276,24 @@ class ThingsBoardHttpSized {
       m_client.stop();
     }
 
+    /// @brief Finishes a sent request depending on the connection mode,
+    /// on a keep alive connection the response body is consumed so the next request starts on a clean stream and the TCP connection stays open,
+    /// without keep alive or after a failed request the connection is torn down completly instead
+    /// @param success Whether the previously sent request was successful or not
+    inline void finishRequest(const bool& success) {
+      if (m_keep_alive && success) {
+        (void)m_client.get_response_body();
+        return;
+      }
+      clearConnection();
+    }
+
+    /// @brief Tears down the current stale connection and establishes a new one to the initally configured host and port
+    inline void reconnect() {
+      clearConnection();
+      m_client.connect(m_host, m_port);
+    }
+
     /// @brief Attempts to send a POST request over HTTP or HTTPS
     /// @param path API path we want to send data to (example: /api/v1/$TOKEN/attributes)
     /// @param json String containing our json key value pairs we want to attempt to send
@@ -280,17 +301,23 @@ class ThingsBoardHttpSized {
     inline bool postMessage(const char* path, const char* json) {
       bool result = true;
 
-      const int success = m_client.post(path, HTTP_POST_PATH, json);
+      int error = m_client.post(path, HTTP_POST_PATH, json);
+      // A reused connection can have been closed by the server inbetween two requests,
+      // sending then fails immediately and cheaply, reconnect once and retry before reporting a failure
+      if (error != 0 && m_keep_alive) {
+        reconnect();
+        error = m_client.post(path, HTTP_POST_PATH, json);
+      }
       const int status = m_client.get_response_status_code();
 
-      if (!success || status < HTTP_RESPONSE_SUCCESS_RANGE_START || status > HTTP_RESPONSE_SUCCESS_RANGE_END) {
+      if (error != 0 || status < HTTP_RESPONSE_SUCCESS_RANGE_START || status > HTTP_RESPONSE_SUCCESS_RANGE_END) {
         char message[Helper::detectSize(HTTP_FAILED, POST, status)];
         snprintf_P(message, sizeof(message), HTTP_FAILED, POST, status);
         Logger::log(message);
         result = false;
       }
 
-      clearConnection();
+      finishRequest(result);
       return result;
     }
 
@@ -306,21 +333,30 @@ class ThingsBoardHttpSized {
 #endif // THINGSBOARD_ENABLE_STL
       bool result = true;
 
-      const bool success = m_client.get(path);
+      int error = m_client.get(path);
+      // A reused connection can have been closed by the server inbetween two requests,
+      // sending then fails immediately and cheaply, reconnect once and retry before reporting a failure
+      if (error != 0 && m_keep_alive) {
+        reconnect();
+        error = m_client.get(path);
+      }
       const int status = m_client.get_response_status_code();
 
-      if (!success || status < HTTP_RESPONSE_SUCCESS_RANGE_START || status > HTTP_RESPONSE_SUCCESS_RANGE_END) {
+      if (error != 0 || status < HTTP_RESPONSE_SUCCESS_RANGE_START || status > HTTP_RESPONSE_SUCCESS_RANGE_END) {
         char message[Helper::detectSize(HTTP_FAILED, GET, status)];
         snprintf_P(message, sizeof(message), HTTP_FAILED, GET, status);
         Logger::log(message);
         result = false;
-        goto cleanup;
+      }
+      else {
+        response = m_client.get_response_body();
       }
 
-      response = m_client.get_response_body();
-
-      cleanup:
-      clearConnection();
+      // The response body has already been consumed completly by get_response_body on success,
+      // so on a keep alive connection nothing is left on the stream and the connection can simply stay open
+      if (!m_keep_alive || !result) {
+        clearConnection();
+      }
       return result;
     }
 
@@ -383,6 +419,9 @@ class ThingsBoardHttpSized {
     IHTTP_Client& m_client; // HttpClient instance
     size_t m_max_stack;     // Maximum stack size we allocate at once on the stack.
     const char *m_token;    // Access token used to connect with
+    const char *m_host;     // Host the connection is established to, kept to allow reconnecting a stale keep alive connection
+    uint16_t m_port;        // Port the connection is established over, kept to allow reconnecting a stale keep alive connection
+    bool m_keep_alive;      // Whether the TCP connection is kept open across sequential requests or torn down after every single one
 };
 
 using ThingsBoardHttp = ThingsBoardHttpSized<>;
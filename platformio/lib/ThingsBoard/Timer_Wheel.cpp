@@ -0,0 +1,220 @@
+// Header include.
+#include "Timer_Wheel.h"
+
+// Library includes.
+#if THINGSBOARD_USE_ESP_TIMER
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif // THINGSBOARD_USE_ESP_TIMER
+#if THINGSBOARD_ENABLE_PROGMEM
+#include <pgmspace.h>
+#endif // THINGSBOARD_ENABLE_PROGMEM
+
+#if THINGSBOARD_ENABLE_PROGMEM
+constexpr char TIMER_WHEEL_NAME[] PROGMEM = "timer_wheel";
+#else
+constexpr char TIMER_WHEEL_NAME[] = "timer_wheel";
+#endif // THINGSBOARD_ENABLE_PROGMEM
+
+#if THINGSBOARD_USE_ESP_TIMER
+// Arm() and Disarm() are called from application tasks while tick() runs on the timer task,
+// the entry chains both sides edit are protected by this short critical section.
+// The callbacks themselves always fire outside of it
+static portMUX_TYPE timer_wheel_spinlock = portMUX_INITIALIZER_UNLOCKED;
+#define TIMER_WHEEL_LOCK()   taskENTER_CRITICAL(&timer_wheel_spinlock)
+#define TIMER_WHEEL_UNLOCK() taskEXIT_CRITICAL(&timer_wheel_spinlock)
+#else
+// The Ticker fallback dispatches from the cooperative scheduler, meaning the same context as the application code, therefore no lock is needed
+#define TIMER_WHEEL_LOCK()
+#define TIMER_WHEEL_UNLOCK()
+#endif // THINGSBOARD_USE_ESP_TIMER
+
+Timer_Wheel& Timer_Wheel::Get_Instance() {
+    static Timer_Wheel instance;
+    return instance;
+}
+
+Timer_Wheel::Timer_Wheel() :
+    m_entries(),
+    m_slots(),
+    m_free_list(0),
+    m_current_tick(0U),
+    m_armed_count(0U),
+    m_timer_running(false)
+#if THINGSBOARD_USE_ESP_TIMER
+    , m_periodic_timer(nullptr)
+#else
+    , m_periodic_timer()
+#endif // THINGSBOARD_USE_ESP_TIMER
+{
+    // All entries start out chained into the free list, all slots start out empty
+    for (size_t i = 0; i < WHEEL_ENTRIES; i++) {
+        m_entries[i].m_next = (i + 1U < WHEEL_ENTRIES) ? static_cast<int>(i + 1U) : -1;
+    }
+    for (size_t i = 0; i < WHEEL_SLOTS; i++) {
+        m_slots[i] = -1;
+    }
+}
+
+int Timer_Wheel::Arm(const uint32_t& timeout_milliseconds, std::function<void(void)> callback) {
+    // Round up so a timeout never fires early, with a minimum of one full tick
+    const uint32_t ticks = ((timeout_milliseconds + TICK_MS - 1U) / TICK_MS) + 1U;
+
+    TIMER_WHEEL_LOCK();
+    const int index = m_free_list;
+    if (index < 0) {
+        TIMER_WHEEL_UNLOCK();
+        return -1;
+    }
+    Entry& entry = m_entries[index];
+    m_free_list = entry.m_next;
+
+    entry.m_callback = std::move(callback);
+    entry.m_rounds = (ticks - 1U) / WHEEL_SLOTS;
+    entry.m_generation++;
+    entry.m_armed = true;
+
+    // Link the entry into the slot its deadline tick hashes to
+    const size_t slot = (m_current_tick + ticks) & (WHEEL_SLOTS - 1U);
+    entry.m_next = m_slots[slot];
+    m_slots[slot] = index;
+    m_armed_count++;
+
+    const int handle = static_cast<int>((static_cast<uint32_t>(entry.m_generation) << 8U) | static_cast<uint32_t>(index));
+    TIMER_WHEEL_UNLOCK();
+
+    start_timer();
+    return handle;
+}
+
+void Timer_Wheel::Disarm(const int& handle) {
+    if (handle < 0) {
+        return;
+    }
+    const size_t index = static_cast<size_t>(handle) & 0xFFU;
+    const uint16_t generation = static_cast<uint16_t>(static_cast<uint32_t>(handle) >> 8U);
+    if (index >= WHEEL_ENTRIES) {
+        return;
+    }
+
+    TIMER_WHEEL_LOCK();
+    Entry& entry = m_entries[index];
+    // The generation check makes a stale handle, whose entry already fired and was rearmed by another user, a safe no-op
+    if (entry.m_armed && entry.m_generation == generation) {
+        entry.m_armed = false;
+        m_armed_count--;
+    }
+    TIMER_WHEEL_UNLOCK();
+}
+
+void Timer_Wheel::tick() {
+    std::function<void(void)> due[WHEEL_ENTRIES];
+    size_t due_count = 0U;
+
+    TIMER_WHEEL_LOCK();
+    m_current_tick++;
+    const size_t slot = m_current_tick & (WHEEL_SLOTS - 1U);
+
+    int *link = &m_slots[slot];
+    while (*link >= 0) {
+        Entry& entry = m_entries[*link];
+        if (entry.m_armed && entry.m_rounds > 0U) {
+            // Not due yet, the entry still has full laps around the wheel left
+            entry.m_rounds--;
+            link = &entry.m_next;
+            continue;
+        }
+        // Either due now or disarmed earlier, unlink the entry back onto the free list either way
+        if (entry.m_armed) {
+            due[due_count++] = std::move(entry.m_callback);
+            m_armed_count--;
+        }
+        const int index = *link;
+        entry.m_armed = false;
+        entry.m_callback = nullptr;
+        *link = entry.m_next;
+        entry.m_next = m_free_list;
+        m_free_list = index;
+    }
+
+    const bool idle = (m_armed_count == 0U);
+    if (idle) {
+        // Reclaim entries that were disarmed while chained into other slots,
+        // so the pool is complete again before the timer stops ticking
+        for (size_t i = 0; i < WHEEL_SLOTS; i++) {
+            while (m_slots[i] >= 0) {
+                const int index = m_slots[i];
+                Entry& entry = m_entries[index];
+                m_slots[i] = entry.m_next;
+                entry.m_armed = false;
+                entry.m_callback = nullptr;
+                entry.m_next = m_free_list;
+                m_free_list = index;
+            }
+        }
+    }
+    TIMER_WHEEL_UNLOCK();
+
+    if (idle) {
+        stop_timer();
+    }
+    for (size_t i = 0; i < due_count; i++) {
+        due[i]();
+    }
+}
+
+void Timer_Wheel::start_timer() {
+    if (m_timer_running) {
+        return;
+    }
+#if THINGSBOARD_USE_ESP_TIMER
+    if (m_periodic_timer == nullptr) {
+        const esp_timer_create_args_t periodic_timer_args = {
+            .callback = &periodic_timer_callback,
+            .arg = nullptr,
+            .dispatch_method = esp_timer_dispatch_t::ESP_TIMER_TASK,
+            .name = TIMER_WHEEL_NAME,
+            .skip_unhandled_events = false
+        };
+        // Temporary handle is used, because it allows using a void* as the actual periodic_timer,
+        // allowing us to only include the esp_timer header in the defintion (.cpp) file,
+        // instead of also needing to declare it in the declaration (.h) header file
+        esp_timer_handle_t temp_handle;
+        const esp_err_t error = esp_timer_create(&periodic_timer_args, &temp_handle);
+        if (error != ESP_OK) {
+            return;
+        }
+        m_periodic_timer = temp_handle;
+    }
+    m_timer_running = true;
+    (void)esp_timer_start_periodic(static_cast<esp_timer_handle_t>(m_periodic_timer), TICK_MS * 1000U);
+#else
+    m_timer_running = true;
+    m_periodic_timer.attach_ms(TICK_MS, &Timer_Wheel::periodic_timer_callback);
+#endif // THINGSBOARD_USE_ESP_TIMER
+}
+
+void Timer_Wheel::stop_timer() {
+    if (!m_timer_running) {
+        return;
+    }
+    m_timer_running = false;
+#if THINGSBOARD_USE_ESP_TIMER
+    (void)esp_timer_stop(static_cast<esp_timer_handle_t>(m_periodic_timer));
+#else
+    m_periodic_timer.detach();
+#endif // THINGSBOARD_USE_ESP_TIMER
+    // An Arm() on another task might have raced the stop, ensure nothing armed is left behind without a running timer
+    if (m_armed_count != 0U) {
+        start_timer();
+    }
+}
+
+#if THINGSBOARD_USE_ESP_TIMER
+void Timer_Wheel::periodic_timer_callback(void *arg) {
+#else
+void Timer_Wheel::periodic_timer_callback() {
+#endif // THINGSBOARD_USE_ESP_TIMER
+    Get_Instance().tick();
+}
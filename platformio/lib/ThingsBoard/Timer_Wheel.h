@@ -0,0 +1,89 @@
+#ifndef Timer_Wheel_h
+#define Timer_Wheel_h
+
+// Local include.
+#include "Configuration.h"
+
+// Library includes.
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#if !THINGSBOARD_USE_ESP_TIMER
+#include <Ticker.h>
+#endif // !THINGSBOARD_USE_ESP_TIMER
+
+
+/// @brief Hashed timer wheel that services every timeout in the library (callback watchdogs as well as client-side RPC request timeouts) from one single underlying timer,
+/// instead of every user allocating an individual esp timer or Ticker instance, which each cost an allocation and put additional pressure on the timer task.
+/// The wheel wraps around either the offical ESP Timer implementation from Espressif (https://github.com/espressif/esp-idf/tree/2bc1f2f574/examples/system/esp_timer) or the Arduino Ticker class from Arduino (https://github.com/sstaub/Ticker), the former takes precendence if it exists.
+/// Arming and disarming are both O(1): arming pops an entry from a free list and links it into the hash slot its deadline falls into, disarming only marks the entry as dead,
+/// the actual unlinking happens lazily the next time the tick visits that slot. The single underlying periodic timer only runs while at least one entry is armed, so an idle wheel costs nothing.
+/// Expired entries fire their callback from the timer task, the same context the individual oneshot timers fired from before,
+/// meaning the callback should not block for a longer period of time. Handles contain a per-entry generation counter, so a stale Disarm() of a handle whose entry
+/// has already fired and been reused is a safe no-op instead of cancelling the new owner
+class Timer_Wheel {
+  public:
+    /// @brief Returns the single shared wheel instance that all timeouts in the library are serviced from,
+    /// created on first use so no timer resources are allocated before the main app code has started
+    static Timer_Wheel& Get_Instance();
+
+    /// @brief Arms a one-shot timeout on the wheel
+    /// @param timeout_milliseconds Amount of milliseconds until the given callback is called, rounded up to the wheel resolution (TICK_MS)
+    /// @param callback Callback method that will be called from the timer task once the timeout has passed, if Disarm() has not been called before that
+    /// @return Handle identifying the armed entry, meant to be passed to Disarm(), or -1 if all WHEEL_ENTRIES entries are currently in use
+    int Arm(const uint32_t& timeout_milliseconds, std::function<void(void)> callback);
+
+    /// @brief Disarms a previously armed entry, ensuring its callback is not called.
+    /// Passing -1 or a handle whose entry has already fired is a safe no-op
+    /// @param handle Handle that was previously returned by Arm()
+    void Disarm(const int& handle);
+
+    static constexpr uint32_t TICK_MS = 100U;    // Wheel resolution, tick interval of the single underlying periodic timer
+    static constexpr size_t WHEEL_SLOTS = 16U;   // Amount of hash slots, power of two so the slot index is a simple mask of the deadline tick
+    static constexpr size_t WHEEL_ENTRIES = 16U; // Maximum amount of concurrently armed timeouts
+
+  private:
+    /// @brief Constructor, private because the wheel is only meant to be used through the shared instance returned by Get_Instance()
+    Timer_Wheel();
+
+    /// @brief Single timeout entry, lives in a fixed pool and is chained into either the free list or one of the hash slots
+    struct Entry {
+      std::function<void(void)> m_callback; // Callback called once the entry expires
+      uint32_t m_rounds;                    // Remaining full laps around the wheel before the entry expires in its slot
+      uint16_t m_generation;                // Incremented on every Arm() of this entry, encoded into the handle to detect stale Disarm() calls
+      bool m_armed;                         // Whether the entry is live, cleared by Disarm() and unlinked lazily by tick()
+      int m_next;                           // Index of the next entry in the slot chain or free list, -1 terminates
+    };
+
+    /// @brief Starts the underlying periodic timer, called when the first entry is armed.
+    /// Can not be done in the constructor, because that would possibly be called before we have executed the main app code, meaning the esp timer base is not initalized yet
+    void start_timer();
+
+    /// @brief Stops the underlying periodic timer, called once the last armed entry has fired or been disarmed
+    void stop_timer();
+
+    /// @brief Advances the wheel by one tick and fires every due entry in the visited slot, called from the timer task
+    void tick();
+
+    /// @brief Static callback used to forward the periodic timer tick to the shared instance
+#if THINGSBOARD_USE_ESP_TIMER
+    /// @param arg Possible argument passed to the timer callback is always nullptr, because we simply forward the call to the shared instance instead
+    static void periodic_timer_callback(void *arg);
+#else
+    static void periodic_timer_callback();
+#endif // THINGSBOARD_USE_ESP_TIMER
+
+    Entry m_entries[WHEEL_ENTRIES]; // Fixed entry pool, no allocations after construction
+    int m_slots[WHEEL_SLOTS];       // Head entry index per hash slot, -1 when the slot is empty
+    int m_free_list;                // Head entry index of the free list
+    uint32_t m_current_tick;        // Tick counter the slot index and entry deadlines are derived from
+    size_t m_armed_count;           // Amount of currently armed entries, drives starting and stopping the underlying timer
+    bool m_timer_running;           // Whether the underlying periodic timer is currently running
+#if THINGSBOARD_USE_ESP_TIMER
+    void *m_periodic_timer;         // ESP Timer handle that is used to start and stop the periodic tick timer
+#else
+    Ticker m_periodic_timer;        // Ticker instance that handles the periodic tick under the hood, if possible we directly use esp timer instead because it is more efficient
+#endif // THINGSBOARD_USE_ESP_TIMER
+};
+
+#endif // Timer_Wheel_h
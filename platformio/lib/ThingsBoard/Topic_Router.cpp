@@ -0,0 +1,121 @@
+// Header include.
+#include "Topic_Router.h"
+
+Topic_Router::Topic_Router()
+  : m_nodes()
+  , m_node_count(0U)
+{
+    // Root node
+    (void)Allocate_Node();
+}
+
+uint8_t Topic_Router::Allocate_Node() {
+    if (m_node_count >= MAX_NODES) {
+        return MAX_NODES;
+    }
+    Node& node = m_nodes[m_node_count];
+    node.edge_count = 0U;
+    node.route = NO_ROUTE;
+    return m_node_count++;
+}
+
+bool Topic_Router::Add(const char* prefix, const uint8_t& route) {
+    if (prefix == nullptr || route == NO_ROUTE) {
+        return false;
+    }
+    uint8_t node = 0U;
+    for (const char* byte = prefix; *byte != '\0'; byte++) {
+        uint8_t child = MAX_NODES;
+        for (uint8_t i = 0U; i < m_nodes[node].edge_count; i++) {
+            if (m_nodes[node].edge_byte[i] == *byte) {
+                child = m_nodes[node].edge_child[i];
+                break;
+            }
+        }
+        if (child == MAX_NODES) {
+            if (m_nodes[node].edge_count >= MAX_EDGES) {
+                return false;
+            }
+            child = Allocate_Node();
+            if (child == MAX_NODES) {
+                return false;
+            }
+            Node& parent = m_nodes[node];
+            parent.edge_byte[parent.edge_count] = *byte;
+            parent.edge_child[parent.edge_count] = child;
+            parent.edge_count++;
+        }
+        node = child;
+    }
+    m_nodes[node].route = route;
+    return true;
+}
+
+uint8_t Topic_Router::Route(const char* topic) const {
+    uint8_t node = 0U;
+    uint8_t best = m_nodes[0U].route;
+    for (const char* byte = topic; *byte != '\0'; byte++) {
+        uint8_t child = MAX_NODES;
+        const Node& current = m_nodes[node];
+        for (uint8_t i = 0U; i < current.edge_count; i++) {
+            if (current.edge_byte[i] == *byte) {
+                child = current.edge_child[i];
+                break;
+            }
+        }
+        if (child == MAX_NODES) {
+            // Trie exhausted; the deepest route passed so far is the
+            // longest registered prefix of this topic
+            break;
+        }
+        node = child;
+        if (m_nodes[node].route != NO_ROUTE) {
+            best = m_nodes[node].route;
+        }
+    }
+    return best;
+}
+
+bool Topic_Router::Filter_Covers(const char* covering, const char* covered) {
+    if (covering == nullptr || covered == nullptr) {
+        return false;
+    }
+    while (true) {
+        if (covering[0U] == '#' && covering[1U] == '\0') {
+            // Multi-level wildcard swallows every remaining level
+            return true;
+        }
+        if (covering[0U] == '+' && (covering[1U] == '\0' || covering[1U] == '/')) {
+            // Single-level wildcard covers one literal or '+' level, but never '#'
+            if (covered[0U] == '#') {
+                return false;
+            }
+            while (*covered != '\0' && *covered != '/') {
+                covered++;
+            }
+            covering++;
+        }
+        else {
+            // Literal level has to match byte for byte and end together
+            while (*covering != '\0' && *covering != '/') {
+                if (*covering != *covered) {
+                    return false;
+                }
+                covering++;
+                covered++;
+            }
+            if (*covered != '\0' && *covered != '/') {
+                return false;
+            }
+        }
+        if (*covering == '\0' && *covered == '\0') {
+            return true;
+        }
+        if (*covering == '\0' || *covered == '\0') {
+            return false;
+        }
+        // Both sit on the level separator
+        covering++;
+        covered++;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef Topic_Router_h
+#define Topic_Router_h
+
+// Local includes.
+#include "Configuration.h"
+
+// Library includes.
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief Compiled prefix trie over the MQTT topics a device listens on.
+/// Routes are registered once at startup; routing an inbound message is then a single pass
+/// over the topic bytes with longest-prefix-match semantics, instead of rescanning the topic
+/// once per candidate with a chain of strncmp calls. Longest-prefix matching also removes
+/// the ordering constraint the chain had (the attribute response topic had to be compared
+/// before the attribute update topic, because the latter is a prefix of the former).
+/// Additionally exposes the MQTT wildcard subsumption check used to compute a minimal
+/// covering set of subscription filters, so filters already covered by an active
+/// subscription are never sent to the broker again
+class Topic_Router {
+  public:
+    /// @brief Route id returned when no registered prefix matches the topic
+    static constexpr uint8_t NO_ROUTE = 0xFF;
+
+    /// @brief Constructs an empty router containing only the root node
+    Topic_Router();
+
+    /// @brief Registers a topic prefix with its route id, a topic matches the route
+    /// if it starts with the given prefix (mirroring the previous strncmp semantics)
+    /// @param prefix Topic prefix the route should match, copied byte-wise into the trie
+    /// @param route Route id handed back by Route() for matching topics, must not be NO_ROUTE
+    /// @return Whether the prefix fit into the statically sized trie or not
+    bool Add(const char* prefix, const uint8_t& route);
+
+    /// @brief Routes a received topic to the registered route with the longest matching prefix
+    /// @param topic Topic the message was received over
+    /// @return Route id of the longest matching registered prefix, or NO_ROUTE if none matches
+    uint8_t Route(const char* topic) const;
+
+    /// @brief Whether the covering MQTT topic filter matches every topic the covered filter matches,
+    /// following the MQTT wildcard rules ('#' swallows all remaining levels, '+' exactly one)
+    /// @param covering Topic filter that is already subscribed
+    /// @param covered Topic filter we would like to subscribe
+    /// @return Whether subscribing covered is redundant given covering is active
+    static bool Filter_Covers(const char* covering, const char* covered);
+
+  private:
+    // Sized for a device topic set: the six ThingsBoard prefixes share the
+    // "v1/devices/me/" stem and need well under this many nodes and edges
+    static constexpr size_t MAX_NODES = 96U;
+    static constexpr size_t MAX_EDGES = 4U;
+
+    struct Node {
+      char edge_byte[MAX_EDGES];    // Byte labelling each outgoing edge
+      uint8_t edge_child[MAX_EDGES]; // Node index the edge leads to
+      uint8_t edge_count;            // Amount of used edges
+      uint8_t route;                 // Route ending at this node, NO_ROUTE otherwise
+    };
+
+    /// @brief Allocates and zero-initializes one trie node
+    /// @return Index of the new node, or MAX_NODES if the trie is full
+    uint8_t Allocate_Node();
+
+    Node m_nodes[MAX_NODES]; // Statically allocated trie nodes, index 0 is the root
+    uint8_t m_node_count;    // Amount of used nodes
+};
+
+#endif // Topic_Router_h
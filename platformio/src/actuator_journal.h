@@ -0,0 +1,144 @@
+#ifndef ACTUATOR_JOURNAL_H
+#define ACTUATOR_JOURNAL_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "actuator_queue.h"
+#include "nvs_journal.h"
+
+// NVS journal of the actuator outputs, restored first thing in setup()
+// so a mid-cycle reboot (brownout, watchdog) resumes pumping within
+// milliseconds of power-on instead of killing the irrigation cycle and
+// waiting for cloud reconciliation.
+//
+// Wear-aware by construction: the state bitmask is written only when an
+// output actually flips (a handful of writes per day), and the running
+// pump cycle's elapsed time is checkpointed at most once per
+// PUMP_CHECKPOINT_MS while the pump is on, so NVS wear stays bounded by
+// actual pumping time.
+class ActuatorJournal {
+public:
+  // Wear bound for the pump run-time checkpoint
+  static const uint32_t PUMP_CHECKPOINT_MS = 15000;
+
+  void begin() { _prefs.begin("actjrnl", false); }
+
+  // Route writes through the write-behind journal: output flips and
+  // safety stops still hit flash before the call returns (via the
+  // journal's barrier — durability is the whole point of this class),
+  // but the periodic pump checkpoint is merely staged, so its flash
+  // stall lands on the housekeeping worker instead of the control loop
+  void attachJournal(NvsJournal *journal) { _journal = journal; }
+
+  // Load the journaled state into the accessors below. Returns false on
+  // the first boot ever (no journal yet): the caller applies defaults.
+  bool restore() {
+    if (!_prefs.isKey("state")) {
+      return false;
+    }
+    _state = _prefs.getUChar("state", 0);
+    _autoEnabled = _prefs.getUChar("auto", 1) != 0;
+    _restoredRunMs = _prefs.getUInt("pumpRun", 0);
+    if (pumpOn()) {
+      _pumpOnSinceMs = millis();
+      _lastCheckpointMs = millis();
+    }
+    return true;
+  }
+
+  bool ledOn() const { return (_state & bit(ACT_LED)) != 0; }
+  bool pumpOn() const { return (_state & bit(ACT_PUMP)) != 0; }
+  bool fanOn() const { return (_state & bit(ACT_FAN)) != 0; }
+  bool autoEnabled() const { return _autoEnabled; }
+  // How long the journaled pump cycle had already run before the reboot
+  uint32_t restoredPumpRunMs() const { return _restoredRunMs; }
+
+  // Called by the actuator task after each GPIO write. NVS is only
+  // touched when a bit actually flips.
+  void record(uint8_t target, bool on) {
+    if (target == ACT_ALL_STOP) {
+      // Everything off and the control loop disabled must survive a
+      // reboot too: a safety stop may not resurrect as a running pump
+      if (_state != 0) {
+        _state = 0;
+        writeU8("state", _state);
+      }
+      _pumpOnSinceMs = 0;
+      recordAuto(false);
+      return;
+    }
+    const uint8_t next = on ? (_state | bit(target)) : (_state & (uint8_t)~bit(target));
+    if (next == _state) {
+      return;
+    }
+    if (target == ACT_PUMP) {
+      // A fresh cycle starts its run-time accounting at zero
+      _pumpOnSinceMs = on ? millis() : 0;
+      _lastCheckpointMs = millis();
+      _restoredRunMs = 0;
+      writeU32("pumpRun", 0, true);
+    }
+    _state = next;
+    writeU8("state", _state);
+  }
+
+  void recordAuto(bool enabled) {
+    if (enabled != _autoEnabled) {
+      _autoEnabled = enabled;
+      writeU8("auto", enabled ? 1 : 0);
+    }
+  }
+
+  // Periodic (the control loop's cadence is fine): checkpoint the
+  // running pump cycle's elapsed time, rate limited to the wear bound
+  void checkpointPumpRun() {
+    if (_pumpOnSinceMs == 0) {
+      return;
+    }
+    const uint32_t now = millis();
+    if (now - _lastCheckpointMs < PUMP_CHECKPOINT_MS) {
+      return;
+    }
+    _lastCheckpointMs = now;
+    writeU32("pumpRun", _restoredRunMs + (now - _pumpOnSinceMs), false);
+  }
+
+private:
+  static uint8_t bit(uint8_t target) { return (uint8_t)(1U << target); }
+
+  // Durable write (barrier): an output flip must be on flash before the
+  // actuator task moves on — a brownout right after a GPIO write may
+  // not resurrect with stale state
+  void writeU8(const char *key, uint8_t value) {
+    if (_journal != NULL) {
+      _journal->stageU8(&_prefs, key, value);
+      _journal->barrier();
+    } else {
+      _prefs.putUChar(key, value);
+    }
+  }
+
+  // durable = false leaves the value staged for the timed flush: the
+  // pump checkpoint is a best-effort progress marker, losing the last
+  // seconds of it costs a slightly longer resumed cycle, not safety
+  void writeU32(const char *key, uint32_t value, bool durable) {
+    if (_journal != NULL) {
+      _journal->stageU32(&_prefs, key, value);
+      if (durable) {
+        _journal->barrier();
+      }
+    } else {
+      _prefs.putUInt(key, value);
+    }
+  }
+
+  NvsJournal *_journal = NULL;
+  Preferences _prefs;
+  uint8_t _state = 0;
+  bool _autoEnabled = true;
+  uint32_t _restoredRunMs = 0;
+  uint32_t _pumpOnSinceMs = 0;   // 0 = pump off
+  uint32_t _lastCheckpointMs = 0;
+};
+
+#endif // ACTUATOR_JOURNAL_H
@@ -0,0 +1,147 @@
+#ifndef ACTUATOR_QUEUE_H
+#define ACTUATOR_QUEUE_H
+
+#include <Arduino.h>
+
+// Actuator commands addressed by target; ALL_STOP drops every actuator
+// regardless of the "on" field and is reserved for the safety tier.
+enum ActuatorTarget : uint8_t {
+  ACT_LED = 0,
+  ACT_PUMP,
+  ACT_FAN,
+  ACT_ALL_STOP,
+};
+
+// Strict tiers, lowest value wins. A safety stop is never behind
+// anything; the local control loop outranks remote commands so a cloud
+// burst cannot delay a hysteresis decision; scheduled/blink traffic
+// yields to everything.
+enum ActuatorPriority : uint8_t {
+  ACT_PRIO_SAFETY = 0,
+  ACT_PRIO_LOCAL,
+  ACT_PRIO_REMOTE,
+  ACT_PRIO_SCHEDULED,
+  ACT_PRIO_COUNT,
+};
+
+struct ActuatorCommand {
+  uint8_t target;      // ActuatorTarget
+  uint8_t priority;    // ActuatorPriority, stamped by submit()
+  bool on;
+  uint32_t enqueuedMs; // millis() at submit, starts the latency clock
+};
+
+// Multi-producer prioritized command queue in front of the actuators.
+//
+// Pump/fan/LED commands used to reach digitalWrite through three
+// uncoordinated paths (serial JSON, RPC callback, local control loop)
+// with no ordering between them. All producers now submit here and a
+// single consumer task owns the GPIO writes, so actuation is serialized,
+// its latency is measured (enqueue to apply), and the tiers guarantee
+// an emergency stop is dequeued before any backlog of remote commands.
+//
+// One FreeRTOS queue per tier plus a counting semaphore: producers are
+// MQTT callbacks and tasks on both cores, and FreeRTOS queues are
+// multi-producer safe without extra locking. The safety tier is a
+// depth-1 overwrite queue — a stop command can never be dropped for
+// lack of space, and the latest stop wins. Other tiers drop on
+// overflow and count it; a full queue of stale remote commands is
+// better discarded than applied late.
+class ActuatorQueue {
+public:
+  static const UBaseType_t QUEUE_DEPTH = 8;
+
+  void begin() {
+    _queues[ACT_PRIO_SAFETY] = xQueueCreate(1, sizeof(ActuatorCommand));
+    for (int i = 1; i < ACT_PRIO_COUNT; i++) {
+      _queues[i] = xQueueCreate(QUEUE_DEPTH, sizeof(ActuatorCommand));
+    }
+    _pending = xSemaphoreCreateCounting(1 + (ACT_PRIO_COUNT - 1) * QUEUE_DEPTH, 0);
+  }
+
+  // Any task or MQTT callback context (not ISRs). Returns false when a
+  // non-safety tier overflowed and the command was dropped.
+  bool submit(ActuatorTarget target, bool on, ActuatorPriority priority) {
+    ActuatorCommand cmd;
+    cmd.target = target;
+    cmd.priority = priority;
+    cmd.on = on;
+    cmd.enqueuedMs = millis();
+    bool queued;
+    if (priority == ACT_PRIO_SAFETY) {
+      queued = xQueueOverwrite(_queues[ACT_PRIO_SAFETY], &cmd) == pdPASS;
+    } else {
+      queued = xQueueSend(_queues[priority], &cmd, 0) == pdPASS;
+    }
+    if (!queued) {
+      _dropped++;
+      return false;
+    }
+    xSemaphoreGive(_pending);
+    return true;
+  }
+
+  // Consumer side (the actuator task only). Blocks up to timeoutMs for
+  // a command, then scans the tiers strictly highest-first, so a safety
+  // stop submitted while remote commands queue up is still dequeued
+  // next. An overwrite in the safety tier can leave the semaphore over-
+  // counted; the empty scan below just goes back to waiting.
+  bool receive(ActuatorCommand &cmd, uint32_t timeoutMs) {
+    if (xSemaphoreTake(_pending, timeoutMs / portTICK_PERIOD_MS) != pdTRUE) {
+      return false;
+    }
+    for (int i = 0; i < ACT_PRIO_COUNT; i++) {
+      if (xQueueReceive(_queues[i], &cmd, 0) == pdTRUE) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Called by the consumer after the GPIO write, closing the latency
+  // measurement for this command
+  void recordApplied(const ActuatorCommand &cmd) {
+    const uint32_t latency = millis() - cmd.enqueuedMs;
+    if (latency > _maxLatencyMs) {
+      _maxLatencyMs = latency;
+    }
+    _applied[cmd.priority]++;
+  }
+
+  // One JSON telemetry object, then counters reset so each report
+  // covers its interval:
+  //   {"actApplied":[s,l,r,b],"actMaxMs":m,"actDropped":d}
+  size_t serialize(char *buf, size_t cap) {
+    size_t len = snprintf(buf, cap,
+        "{\"actApplied\":[%lu,%lu,%lu,%lu],\"actMaxMs\":%lu,\"actDropped\":%lu}",
+        (unsigned long)_applied[ACT_PRIO_SAFETY],
+        (unsigned long)_applied[ACT_PRIO_LOCAL],
+        (unsigned long)_applied[ACT_PRIO_REMOTE],
+        (unsigned long)_applied[ACT_PRIO_SCHEDULED],
+        (unsigned long)_maxLatencyMs,
+        (unsigned long)_dropped);
+    for (int i = 0; i < ACT_PRIO_COUNT; i++) {
+      _applied[i] = 0;
+    }
+    _maxLatencyMs = 0;
+    _dropped = 0;
+    return len < cap ? len : cap - 1;
+  }
+
+  uint32_t appliedTotal() const {
+    uint32_t total = 0;
+    for (int i = 0; i < ACT_PRIO_COUNT; i++) {
+      total += _applied[i];
+    }
+    return total;
+  }
+
+private:
+  QueueHandle_t _queues[ACT_PRIO_COUNT] = {NULL};
+  SemaphoreHandle_t _pending = NULL;
+  uint32_t _applied[ACT_PRIO_COUNT] = {0};
+  uint32_t _maxLatencyMs = 0;
+  uint32_t _dropped = 0;
+};
+
+#endif // ACTUATOR_QUEUE_H
@@ -0,0 +1,112 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <Arduino.h>
+#include "esp_adc/adc_continuous.h"
+
+// Continuous (DMA) ADC sampling for the light and moisture channels.
+// The ADC streams conversions into a DMA ring on its own; poll() just
+// drains whatever accumulated and folds it into per-channel averages,
+// so the sample loop spends no CPU waiting on conversions and the
+// reported values are oversampled/denoised instead of single reads.
+class AdcSampler {
+public:
+  static const uint32_t SAMPLE_FREQ_HZ = 4000;  // 2kHz per channel
+  static const size_t FRAME_BYTES = 256;
+
+  // GPIO1 -> ADC1_CH0, GPIO2 -> ADC1_CH1 on the ESP32-S3
+  bool begin(adc_channel_t lightChannel, adc_channel_t moistureChannel) {
+    _lightCh = lightChannel;
+    _moistureCh = moistureChannel;
+
+    adc_continuous_handle_cfg_t handleCfg = {};
+    handleCfg.max_store_buf_size = 4 * FRAME_BYTES;
+    handleCfg.conv_frame_size = FRAME_BYTES;
+    if (adc_continuous_new_handle(&handleCfg, &_handle) != ESP_OK) {
+      return false;
+    }
+
+    adc_digi_pattern_config_t pattern[2] = {};
+    adc_channel_t channels[2] = {lightChannel, moistureChannel};
+    for (int i = 0; i < 2; i++) {
+      pattern[i].atten = ADC_ATTEN_DB_11;
+      pattern[i].channel = channels[i];
+      pattern[i].unit = ADC_UNIT_1;
+      pattern[i].bit_width = ADC_BITWIDTH_12;
+    }
+
+    adc_continuous_config_t digiCfg = {};
+    digiCfg.sample_freq_hz = SAMPLE_FREQ_HZ;
+    digiCfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digiCfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    digiCfg.pattern_num = 2;
+    digiCfg.adc_pattern = pattern;
+    if (adc_continuous_config(_handle, &digiCfg) != ESP_OK) {
+      adc_continuous_deinit(_handle);
+      _handle = nullptr;
+      return false;
+    }
+    return adc_continuous_start(_handle) == ESP_OK;
+  }
+
+  bool ready() const { return _handle != nullptr; }
+
+  // Optional raw-stream tap, installed for the duration of a burst
+  // capture (burst_capture.h): every drained result is also handed to
+  // the tap (channel 0 = light, 1 = moisture) before folding into the
+  // averages. NULL — the default — keeps the steady-state path exactly
+  // as it was.
+  typedef void (*RawTap)(uint8_t channel, uint16_t value);
+  void setTap(RawTap tap) { _tap = tap; }
+
+  // Drain the DMA ring (non-blocking) and update the channel averages.
+  void poll() {
+    if (_handle == nullptr) return;
+    uint8_t frame[FRAME_BYTES];
+    uint32_t got = 0;
+    while (adc_continuous_read(_handle, frame, sizeof(frame), &got, 0) == ESP_OK && got > 0) {
+      for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= got; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        adc_digi_output_data_t *d = (adc_digi_output_data_t *)&frame[i];
+        uint32_t ch = d->type2.channel;
+        uint32_t val = d->type2.data;
+        if (ch == (uint32_t)_lightCh) {
+          if (_tap) _tap(0, (uint16_t)val);
+          accumulate(_lightSum, _lightCount, val);
+        } else if (ch == (uint32_t)_moistureCh) {
+          if (_tap) _tap(1, (uint16_t)val);
+          accumulate(_moistureSum, _moistureCount, val);
+        }
+      }
+    }
+  }
+
+  // Mean of everything accumulated since the previous call, falling back
+  // to the last value when nothing new arrived.
+  float takeLight() { return take(_lightSum, _lightCount, _lastLight); }
+  float takeMoisture() { return take(_moistureSum, _moistureCount, _lastMoisture); }
+
+private:
+  static void accumulate(uint64_t &sum, uint32_t &count, uint32_t val) {
+    sum += val;
+    count++;
+  }
+
+  static float take(uint64_t &sum, uint32_t &count, float &last) {
+    if (count > 0) {
+      last = (float)(sum / count);
+      sum = 0;
+      count = 0;
+    }
+    return last;
+  }
+
+  adc_continuous_handle_t _handle = nullptr;
+  RawTap volatile _tap = nullptr;
+  adc_channel_t _lightCh = ADC_CHANNEL_0;
+  adc_channel_t _moistureCh = ADC_CHANNEL_1;
+  uint64_t _lightSum = 0, _moistureSum = 0;
+  uint32_t _lightCount = 0, _moistureCount = 0;
+  float _lastLight = 0.0f, _lastMoisture = 0.0f;
+};
+
+#endif // ADC_SAMPLER_H
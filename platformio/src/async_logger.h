@@ -0,0 +1,222 @@
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <Arduino.h>
+
+// Lock-free logging ring. Producer tasks format into a claimed slot in
+// microseconds and never touch the UART; a single low-priority drain
+// task owns Serial, so logging can never stall sampling or an MQTT
+// callback on the UART FIFO. Full ring = drop (counted), not block.
+//
+// Two producer paths share the ring:
+//  - logf() formats immediately into the slot (use when an argument
+//    points at stack storage that dies before the drain runs);
+//  - logd() defers: the slot stores the format pointer plus the raw
+//    argument words and the drain task formats at write-out time, so
+//    the hot path pays a few stores instead of a vsnprintf. Format
+//    strings and %s arguments must live in static storage (string
+//    literals, flash tables) for exactly that reason.
+class AsyncLogger {
+public:
+  static const size_t SLOTS = 32;       // power of two
+  static const size_t SLOT_LEN = 96;
+  static const size_t MAX_ARGS = 4;
+
+  // printf-style enqueue, safe from any task
+  void logf(const char *format, ...) {
+    Slot *slot = claimSlot();
+    if (slot == NULL) {
+      return;
+    }
+    va_list args;
+    va_start(args, format);
+    vsnprintf(slot->text, SLOT_LEN, format, args);
+    va_end(args);
+    __atomic_store_n(&slot->ready, READY_TEXT, __ATOMIC_RELEASE);
+  }
+
+  // Deferred enqueue: stores the format pointer and the raw arguments,
+  // formatting happens in the drain task. Arguments beyond MAX_ARGS
+  // are dropped.
+  template <typename... Args>
+  void logd(const char *format, Args... args) {
+    Slot *slot = claimSlot();
+    if (slot == NULL) {
+      return;
+    }
+    slot->def.format = format;
+    const LogArg captured[sizeof...(Args) > 0 ? sizeof...(Args) : 1] = {makeArg(args)...};
+    const size_t count = sizeof...(Args) < MAX_ARGS ? sizeof...(Args) : MAX_ARGS;
+    for (size_t i = 0; i < count; i++) {
+      slot->def.args[i] = captured[i];
+    }
+    slot->def.count = (uint8_t)count;
+    __atomic_store_n(&slot->ready, READY_DEFERRED, __ATOMIC_RELEASE);
+  }
+
+  // Drain task body: write completed slots to the UART in order
+  void drainTask() {
+    while (1) {
+      uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+      uint32_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+      bool wrote = false;
+      while (tail != head) {
+        Slot &slot = _slots[tail % SLOTS];
+        const uint32_t ready = __atomic_load_n(&slot.ready, __ATOMIC_ACQUIRE);
+        if (ready == 0) {
+          break;  // producer claimed but not finished writing yet
+        }
+        if (ready == READY_DEFERRED) {
+          char line[SLOT_LEN];
+          formatDeferred(slot, line, sizeof(line));
+          Serial.println(line);
+        } else {
+          Serial.println(slot.text);
+        }
+        __atomic_store_n(&slot.ready, 0, __ATOMIC_RELEASE);
+        tail++;
+        __atomic_store_n(&_tail, tail, __ATOMIC_RELEASE);
+        wrote = true;
+      }
+      uint32_t dropped = __atomic_exchange_n(&_dropped, 0, __ATOMIC_RELAXED);
+      if (dropped > 0) {
+        Serial.printf("[LOG] %u messages dropped\n", dropped);
+      }
+      vTaskDelay((wrote ? 10 : 50) / portTICK_PERIOD_MS);
+    }
+  }
+
+private:
+  static const uint32_t READY_TEXT = 1;
+  static const uint32_t READY_DEFERRED = 2;
+
+  // Tagged raw argument word of a deferred message
+  struct LogArg {
+    enum Type : uint8_t { T_INT, T_UINT, T_FLOAT, T_STR };
+    uint8_t type;
+    union {
+      int32_t i;
+      uint32_t u;
+      float f;
+      const char *s;
+    };
+  };
+
+  struct Slot {
+    union {
+      char text[SLOT_LEN];
+      struct {
+        const char *format;
+        LogArg args[MAX_ARGS];
+        uint8_t count;
+      } def;
+    };
+    volatile uint32_t ready = 0;  // 0 empty, READY_TEXT, READY_DEFERRED
+  };
+
+  // Claim the next slot or count a drop when the ring is full
+  Slot *claimSlot() {
+    uint32_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= SLOTS) {
+      __atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED);
+      return NULL;
+    }
+    // Claim a slot; on a race the CAS loop retries with the new head
+    while (!__atomic_compare_exchange_n(&_head, &head, head + 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+      tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+      if (head - tail >= SLOTS) {
+        __atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED);
+        return NULL;
+      }
+    }
+    return &_slots[head % SLOTS];
+  }
+
+  static LogArg makeArg(int v) { LogArg a; a.type = LogArg::T_INT; a.i = v; return a; }
+  static LogArg makeArg(long v) { LogArg a; a.type = LogArg::T_INT; a.i = (int32_t)v; return a; }
+  static LogArg makeArg(unsigned int v) { LogArg a; a.type = LogArg::T_UINT; a.u = v; return a; }
+  static LogArg makeArg(unsigned long v) { LogArg a; a.type = LogArg::T_UINT; a.u = (uint32_t)v; return a; }
+  static LogArg makeArg(bool v) { LogArg a; a.type = LogArg::T_UINT; a.u = v ? 1 : 0; return a; }
+  static LogArg makeArg(float v) { LogArg a; a.type = LogArg::T_FLOAT; a.f = v; return a; }
+  static LogArg makeArg(double v) { LogArg a; a.type = LogArg::T_FLOAT; a.f = (float)v; return a; }
+  static LogArg makeArg(const char *v) { LogArg a; a.type = LogArg::T_STR; a.s = v; return a; }
+
+  // Drain-side formatter: walks the stored format string and renders
+  // one conversion per stored argument. Length modifiers (h/l) are
+  // stripped so the 32-bit stored words match what snprintf expects.
+  static void formatDeferred(const Slot &slot, char *out, size_t cap) {
+    const char *fmt = slot.def.format;
+    size_t o = 0;
+    size_t arg = 0;
+    while (*fmt != '\0' && o + 1 < cap) {
+      if (*fmt != '%') {
+        out[o++] = *fmt++;
+        continue;
+      }
+      if (fmt[1] == '%') {
+        out[o++] = '%';
+        fmt += 2;
+        continue;
+      }
+      // Copy the spec, dropping length modifiers, up to the conversion
+      char spec[12];
+      size_t s = 0;
+      spec[s++] = *fmt++;  // '%'
+      char conv = 0;
+      while (*fmt != '\0' && s + 1 < sizeof(spec)) {
+        const char c = *fmt++;
+        if (c == 'l' || c == 'h' || c == 'z') {
+          continue;
+        }
+        spec[s++] = c;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+          conv = c;
+          break;
+        }
+      }
+      spec[s] = '\0';
+      if (conv == 0 || arg >= slot.def.count) {
+        break;  // malformed spec or more conversions than stored args
+      }
+      const LogArg &a = slot.def.args[arg++];
+      int n = 0;
+      switch (conv) {
+        case 'd': case 'i': case 'c':
+          n = snprintf(&out[o], cap - o, spec,
+                       a.type == LogArg::T_UINT ? (int)a.u
+                       : a.type == LogArg::T_FLOAT ? (int)a.f : (int)a.i);
+          break;
+        case 'u': case 'o': case 'x': case 'X':
+          n = snprintf(&out[o], cap - o, spec,
+                       a.type == LogArg::T_INT ? (unsigned)a.i
+                       : a.type == LogArg::T_FLOAT ? (unsigned)a.f : (unsigned)a.u);
+          break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+          n = snprintf(&out[o], cap - o, spec,
+                       a.type == LogArg::T_FLOAT ? (double)a.f
+                       : a.type == LogArg::T_INT ? (double)a.i : (double)a.u);
+          break;
+        case 's':
+          n = snprintf(&out[o], cap - o, spec,
+                       a.type == LogArg::T_STR && a.s != NULL ? a.s : "(?)");
+          break;
+        default:
+          n = snprintf(&out[o], cap - o, "%s", spec);
+          break;
+      }
+      if (n > 0) {
+        o += (size_t)n < cap - o ? (size_t)n : cap - o - 1;
+      }
+    }
+    out[o] = '\0';
+  }
+
+  Slot _slots[SLOTS];
+  volatile uint32_t _head = 0;
+  volatile uint32_t _tail = 0;
+  volatile uint32_t _dropped = 0;
+};
+
+#endif // ASYNC_LOGGER_H
@@ -0,0 +1,96 @@
+#ifndef BACKPRESSURE_H
+#define BACKPRESSURE_H
+
+#include <Arduino.h>
+
+// Producer-visible pressure signal for the publish pipeline. The
+// stages each bound themselves - the telemetry ring drops oldest, the
+// publish budget merges over-quota records, PubSubClient just fails -
+// but nothing told the producer side to slow down, so overload was
+// absorbed as silent data loss at whatever stage hit its limit first.
+//
+// This class fuses the two signals that actually predict overload -
+// how full the store-and-forward ring is, and the recent publish
+// failure fraction - into one level with hysteresis, and the sampling
+// loop stretches its cadence on it exactly like it already does for
+// link quality. The policy split stays at the call sites: bulk
+// telemetry sheds at the source (sample less, ring absorbs the rest),
+// alerts block briefly and retry instead (they are sparse and worth a
+// short wait, see sendAlertTelemetry).
+class Backpressure {
+public:
+  enum Level { BP_OK = 0, BP_ELEVATED = 1, BP_CRITICAL = 2 };
+
+  // Feed the ring fill once per sampling pass; this is also where the
+  // level is re-assessed, so the signal moves at sampling cadence
+  void noteQueueFill(size_t used, size_t capacity) {
+    _queuePct = capacity > 0 ? (uint8_t)((used * 100) / capacity) : 0;
+    assess();
+    if (_level != BP_OK) {
+      _pressuredCycles++;
+    }
+  }
+
+  // Feed every publish outcome; EWMA over ~16 sends so one lost packet
+  // does not spike the signal and a stalled socket shows within a cycle
+  void noteTxResult(bool ok) {
+    const uint16_t sample = ok ? 0 : 100;
+    _txFailPct = (uint8_t)((_txFailPct * 15 + sample) / 16);
+  }
+
+  Level level() const { return _level; }
+
+  // Cadence stretch for the sampling loop: 1x/2x/4x, same shape as
+  // LinkScheduler::intervalMultiplier() - the caller takes the max of
+  // the two rather than multiplying, since a congested link usually
+  // raises both signals at once
+  uint32_t intervalMultiplier() const {
+    return _level == BP_CRITICAL ? 4 : (_level == BP_ELEVATED ? 2 : 1);
+  }
+
+  uint32_t pressuredCycles() const { return _pressuredCycles; }
+
+  // One JSON telemetry object:
+  //   {"bpLevel":l,"bpQueuePct":q,"bpTxFailPct":f,"bpCycles":c}
+  size_t serialize(char *buf, size_t cap) const {
+    size_t len = snprintf(buf, cap,
+        "{\"bpLevel\":%u,\"bpQueuePct\":%u,\"bpTxFailPct\":%u,\"bpCycles\":%lu}",
+        (unsigned)_level, (unsigned)_queuePct, (unsigned)_txFailPct,
+        (unsigned long)_pressuredCycles);
+    return len < cap ? len : cap - 1;
+  }
+
+private:
+  // Enter thresholds sit above the exit thresholds so the level does
+  // not flap when the fill hovers at a boundary
+  void assess() {
+    switch (_level) {
+      case BP_OK:
+        if (_queuePct >= 85 || _txFailPct >= 50) {
+          _level = BP_CRITICAL;
+        } else if (_queuePct >= 50 || _txFailPct >= 25) {
+          _level = BP_ELEVATED;
+        }
+        break;
+      case BP_ELEVATED:
+        if (_queuePct >= 85 || _txFailPct >= 50) {
+          _level = BP_CRITICAL;
+        } else if (_queuePct < 40 && _txFailPct < 15) {
+          _level = BP_OK;
+        }
+        break;
+      case BP_CRITICAL:
+        if (_queuePct < 70 && _txFailPct < 35) {
+          _level = BP_ELEVATED;
+        }
+        break;
+    }
+  }
+
+  Level _level = BP_OK;
+  uint8_t _queuePct = 0;
+  uint8_t _txFailPct = 0;
+  uint32_t _pressuredCycles = 0;
+};
+
+#endif // BACKPRESSURE_H
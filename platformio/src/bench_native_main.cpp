@@ -0,0 +1,153 @@
+/**
+ * Host-native benchmark suite, built by the "native" PlatformIO
+ * environment against the Arduino shims in bench/native_shim.
+ *
+ * Covers the portable hot paths — ArduinoJson serialization and
+ * parsing, the fixed-decimal telemetry formatter, the shared b64
+ * encoder, NDEF message decode and the LZSS payload compressor — so
+ * they can be iterated on at desktop speed and compared between
+ * commits without flashing hardware. The benchmark bodies mirror the
+ * on-device harness (benchmark_main.cpp) where both exist; absolute
+ * numbers differ from the ESP32 but relative regressions show up the
+ * same, and the hardware-bound benchmarks (DHT20, MQTT) exist only
+ * on-device.
+ *
+ *   pio run -e native && .pio/build/native/program
+ */
+
+#ifdef NATIVE_BENCHMARK
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <b64.h>
+#include <NdefMessage.h>
+#include "telemetry_keys.h"
+#include "fixed_decimal.h"
+#include "payload_codec.h"
+#include "microbench.h"
+
+using microbench::BenchState;
+using microbench::DoNotOptimize;
+
+#define BASE64_INPUT_SIZE (32 * 1024)
+
+// The telemetry document exactly as publishBufferedRecord builds it
+static void serialize_telemetry(BenchState& state) {
+    while (state.KeepRunning()) {
+        StaticJsonDocument<JSON_OBJECT_SIZE(5)> doc;
+        doc[TELEMETRY_KEY_TEMPERATURE] = 27.31f;
+        doc[TELEMETRY_KEY_HUMIDITY] = 61.20f;
+        doc[TELEMETRY_KEY_LIGHT] = 512.0f;
+        doc[TELEMETRY_KEY_MOISTURE] = 47.0f;
+        doc[TELEMETRY_KEY_AGE_MS] = 12345UL;
+        char payload[160];
+        size_t written = serializeJson(doc, payload, sizeof(payload));
+        DoNotOptimize(written);
+    }
+}
+BENCHMARK(serialize_telemetry);
+
+// Same document with the float fields routed through the fixed-decimal
+// integer formatter
+static void serialize_telemetry_fixed(BenchState& state) {
+    while (state.KeepRunning()) {
+        StaticJsonDocument<JSON_OBJECT_SIZE(5) + 4 * FixedDecimal::POOL_BYTES> doc;
+        doc[TELEMETRY_KEY_TEMPERATURE] = FixedDecimal(27.31f);
+        doc[TELEMETRY_KEY_HUMIDITY] = FixedDecimal(61.20f);
+        doc[TELEMETRY_KEY_LIGHT] = FixedDecimal(512.0f, 0);
+        doc[TELEMETRY_KEY_MOISTURE] = FixedDecimal(47.0f, 0);
+        doc[TELEMETRY_KEY_AGE_MS] = 12345UL;
+        char payload[160];
+        size_t written = serializeJson(doc, payload, sizeof(payload));
+        DoNotOptimize(written);
+    }
+}
+BENCHMARK(serialize_telemetry_fixed);
+
+// The inbound direction: decoding a telemetry-shaped document, as the
+// RPC/attribute callbacks do
+static void deserialize_telemetry(BenchState& state) {
+    static const char payload[] =
+        "{\"temperature\":27.31,\"humidity\":61.20,\"light\":512,"
+        "\"moisture\":47,\"ageMs\":12345}";
+    while (state.KeepRunning()) {
+        StaticJsonDocument<JSON_OBJECT_SIZE(5) + 64> doc;
+        DeserializationError error = deserializeJson(doc, payload);
+        DoNotOptimize(error);
+    }
+}
+BENCHMARK(deserialize_telemetry);
+
+// Base64 of a camera-frame-sized buffer through the shared b64 encoder
+static void base64_32k_encode(BenchState& state) {
+    static uint8_t input[BASE64_INPUT_SIZE];
+    static unsigned char output[((BASE64_INPUT_SIZE + 2) / 3) * 4 + 1];
+    for (int i = 0; i < BASE64_INPUT_SIZE; i++) {
+        input[i] = (uint8_t)(i * 31);
+    }
+    while (state.KeepRunning()) {
+        int encoded = b64_encode(input, BASE64_INPUT_SIZE, output, sizeof(output));
+        DoNotOptimize(encoded);
+    }
+}
+BENCHMARK(base64_32k_encode);
+
+// NDEF message decode, both the copying and the zero-copy parse mode
+static void ndef_parse(BenchState& state) {
+    NdefMessage source = NdefMessage();
+    source.addTextRecord("greenhouse-4 row-12 sensor badge");
+    source.addUriRecord("https://farm.example/tags/greenhouse-4");
+    int encodedSize = source.getEncodedSize();
+    byte* encoded = (byte*)malloc(encodedSize);
+    source.encode(encoded);
+    while (state.KeepRunning()) {
+        NdefMessage parsed = NdefMessage(encoded, encodedSize);
+        DoNotOptimize(parsed);
+    }
+    free(encoded);
+}
+BENCHMARK(ndef_parse);
+
+static void ndef_parse_zerocopy(BenchState& state) {
+    NdefMessage source = NdefMessage();
+    source.addTextRecord("greenhouse-4 row-12 sensor badge");
+    source.addUriRecord("https://farm.example/tags/greenhouse-4");
+    int encodedSize = source.getEncodedSize();
+    byte* encoded = (byte*)malloc(encodedSize);
+    source.encode(encoded);
+    while (state.KeepRunning()) {
+        NdefMessage parsed = NdefMessage(encoded, encodedSize, true);
+        DoNotOptimize(parsed);
+    }
+    free(encoded);
+}
+BENCHMARK(ndef_parse_zerocopy);
+
+// LZSS compression of a gateway-batch-sized JSON payload: repetitive
+// key names, varying values, the shape flushBatch actually produces
+static void payload_compress_batch(BenchState& state) {
+    static char input[1536];
+    size_t used = 0;
+    used += snprintf(input + used, sizeof(input) - used, "{\"records\":[");
+    for (int i = 0; i < 10 && used < sizeof(input) - 128; i++) {
+        used += snprintf(input + used, sizeof(input) - used,
+                         "%s{\"leafId\":%d,\"temperature\":%d.%02d,"
+                         "\"humidity\":%d.%02d,\"light\":%d,\"ageMs\":%d}",
+                         i ? "," : "", i + 1, 20 + i, (i * 37) % 100,
+                         50 + i, (i * 53) % 100, 400 + i * 13, i * 250);
+    }
+    used += snprintf(input + used, sizeof(input) - used, "]}");
+    static uint8_t output[sizeof(input)];
+    while (state.KeepRunning()) {
+        size_t compressed = payloadCompress((const uint8_t*)input, used,
+                                            output, sizeof(output));
+        DoNotOptimize(compressed);
+    }
+}
+BENCHMARK(payload_compress_batch);
+
+int main() {
+    return microbench::runAllBenchmarks();
+}
+
+#endif // NATIVE_BENCHMARK
@@ -0,0 +1,195 @@
+#ifndef BURST_CAPTURE_H
+#define BURST_CAPTURE_H
+
+#include <Arduino.h>
+
+// RPC-armed high-rate capture window for field diagnostics. Chasing a
+// misbehaving probe or valve needs a few seconds sampled far above the
+// steady-state cadence, which used to mean reflashing with a modified
+// task period (or flashing the dedicated udp_burst role). Instead the
+// "burst" RPC arms this ring: a short-lived pump task drains the
+// continuous-ADC DMA stream on a hard cadence for the requested window,
+// raw samples land in a heap ring allocated for just that window, and a
+// housekeeping job uploads the capture afterwards as compressed MQTT
+// chunks. Idle cost is zero — no task, no ring, no tap installed.
+//
+// The class owns no hardware: the pump and the per-sample tap are
+// function pointers supplied by main.cpp (same pattern as lazy_init.h),
+// so the DMA handle stays with AdcSampler and this header stays
+// testable. While a capture runs the pump task is the sole DMA drainer;
+// the sampling loop checks sampling() and holds its last values for
+// those few seconds.
+//
+// Samples are 12-bit ADC counts with the channel index in bit 15, in
+// stream order. Chunks leave on BURST_TOPIC (or the /lz variant when
+// compression pays) with the header below in front; all fields
+// little-endian, sized to stay under the MQTT buffer floor so a chunk
+// never forces the elastic buffer up.
+
+#define BURST_TOPIC "v1/devices/me/burst"
+
+#define BURST_CHUNK_VERSION 1
+// 200 samples = 414-byte chunk before compression, under the 512-byte
+// MQTT buffer floor with header room to spare
+#define BURST_CHUNK_SAMPLES 200
+
+struct __attribute__((packed)) BurstChunkHeader {
+  uint8_t version;        // BURST_CHUNK_VERSION
+  uint8_t deviceId;
+  uint16_t chunkIndex;
+  uint16_t chunkCount;
+  uint16_t sampleCount;   // uint16_t samples following this header
+  uint32_t firstUptimeMs; // device millis() at the first ring sample
+  uint16_t rateHz;        // combined stream rate; per channel = rateHz/2
+  uint8_t channelMask;    // bit 0 = light, bit 1 = moisture
+  uint8_t truncated;      // 1 = ring filled before the window elapsed
+};
+
+class BurstCapture {
+public:
+  typedef void (*PumpFn)();
+
+  static const uint32_t MAX_SECONDS = 30;
+  // Ring cap: 32KB of heap, ~4s of the full 4kHz stream. A window the
+  // ring cannot hold ends early with the truncated flag set.
+  static const uint32_t MAX_SAMPLES = 16384;
+  static const uint32_t PUMP_INTERVAL_MS = 10;
+
+  // RPC-callback context: validates, allocates the ring and starts the
+  // pump task. Returns false while a capture or its upload is still in
+  // flight, or when the heap cannot spare the ring.
+  bool start(uint32_t seconds, uint32_t rateHz, PumpFn pump,
+             BaseType_t core) {
+    if (_state != IDLE || pump == NULL || seconds == 0) {
+      return false;
+    }
+    if (seconds > MAX_SECONDS) {
+      seconds = MAX_SECONDS;
+    }
+    uint32_t wanted = seconds * rateHz;
+    _capacity = wanted < MAX_SAMPLES ? wanted : MAX_SAMPLES;
+    _samples = (uint16_t *)malloc(_capacity * sizeof(uint16_t));
+    if (_samples == NULL) {
+      return false;
+    }
+    _count = 0;
+    _chunkIndex = 0;
+    _windowMs = seconds * 1000UL;
+    _rateHz = (uint16_t)rateHz;
+    _truncated = 0;
+    _pump = pump;
+    // SAMPLING before the task exists: the sampling loop stops its own
+    // DMA drain the moment the flag is visible, so the pump task is
+    // the only drainer from its first pass
+    _state = SAMPLING;
+    if (xTaskCreatePinnedToCore(pumpTask, "TaskBurstCap", 2048, this, 2,
+                                NULL, core) != pdPASS) {
+      free(_samples);
+      _samples = NULL;
+      _state = IDLE;
+      return false;
+    }
+    return true;
+  }
+
+  // Tap target, called once per raw DMA result from pump context.
+  // channel: 0 = light, 1 = moisture. Drops everything outside an
+  // active window, so a stale tap can never write a freed ring.
+  void capture(uint8_t channel, uint16_t value) {
+    if (_state != SAMPLING || _count >= _capacity) {
+      return;
+    }
+    if (_count == 0) {
+      _firstUptimeMs = millis();
+    }
+    _samples[_count++] = (uint16_t)((value & 0x0FFF) | ((uint16_t)channel << 15));
+  }
+
+  bool sampling() const { return _state == SAMPLING; }
+  bool finished() const { return _state == DONE; }
+
+  // Builds the next upload chunk (header + samples) into out, returning
+  // the wire size. last is set on the final chunk; the caller resets
+  // after that chunk is confirmed sent. Upload context only.
+  size_t nextChunk(uint8_t deviceId, uint8_t *out, size_t outCap,
+                   bool &last) {
+    const uint16_t chunkCount =
+        (uint16_t)((_count + BURST_CHUNK_SAMPLES - 1) / BURST_CHUNK_SAMPLES);
+    const uint32_t offset = (uint32_t)_chunkIndex * BURST_CHUNK_SAMPLES;
+    uint32_t remaining = _count - offset;
+    if (remaining > BURST_CHUNK_SAMPLES) {
+      remaining = BURST_CHUNK_SAMPLES;
+    }
+    const size_t wire =
+        sizeof(BurstChunkHeader) + remaining * sizeof(uint16_t);
+    if (outCap < wire) {
+      last = true;
+      return 0;
+    }
+    BurstChunkHeader header;
+    header.version = BURST_CHUNK_VERSION;
+    header.deviceId = deviceId;
+    header.chunkIndex = _chunkIndex;
+    header.chunkCount = chunkCount;
+    header.sampleCount = (uint16_t)remaining;
+    header.firstUptimeMs = _firstUptimeMs;
+    header.rateHz = _rateHz;
+    header.channelMask = 0x03;  // the DMA pattern carries both channels
+    header.truncated = _truncated;
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), _samples + offset,
+           remaining * sizeof(uint16_t));
+    last = _chunkIndex + 1 >= chunkCount || _count == 0;
+    return wire;
+  }
+
+  void chunkSent() { _chunkIndex++; }
+
+  // Frees the ring; the next RPC can arm a fresh window
+  void reset() {
+    free(_samples);
+    _samples = NULL;
+    _count = 0;
+    _state = IDLE;
+  }
+
+  uint32_t sampleCount() const { return _count; }
+
+private:
+  enum State { IDLE, SAMPLING, DONE };
+
+  static void pumpTask(void *parameter) {
+    ((BurstCapture *)parameter)->runPump();
+    vTaskDelete(NULL);
+  }
+
+  // Hard-cadence drain, same vTaskDelayUntil discipline as the
+  // udp_burst role's sampler: at 4kHz combined a 10ms pass moves ~40
+  // results, far inside the DMA ring's slack
+  void runPump() {
+    const uint32_t endMs = millis() + _windowMs;
+    TickType_t lastWake = xTaskGetTickCount();
+    while ((int32_t)(millis() - endMs) < 0) {
+      _pump();
+      if (_count >= _capacity) {
+        _truncated = 1;
+        break;
+      }
+      vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(PUMP_INTERVAL_MS));
+    }
+    _state = DONE;
+  }
+
+  uint16_t *_samples = NULL;
+  uint32_t _capacity = 0;
+  volatile uint32_t _count = 0;
+  uint32_t _firstUptimeMs = 0;
+  uint32_t _windowMs = 0;
+  uint16_t _rateHz = 0;
+  uint16_t _chunkIndex = 0;
+  uint8_t _truncated = 0;
+  PumpFn _pump = NULL;
+  volatile State _state = IDLE;
+};
+
+#endif // BURST_CAPTURE_H
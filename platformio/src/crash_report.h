@@ -0,0 +1,126 @@
+#ifndef CRASH_REPORT_H
+#define CRASH_REPORT_H
+
+#include <Arduino.h>
+#include <esp_system.h>
+
+// The Arduino core ships with IDF coredump-to-flash enabled (ELF
+// format) and the stock partition table carries the coredump
+// partition, so after a Guru Meditation the crashed state is already
+// sitting in flash - it just never leaves the device without a serial
+// cable. sdkconfig.h arrives through Arduino.h; a build without the
+// component compiles down to the reset-reason-only report.
+#ifdef CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH
+#include <esp_core_dump.h>
+#define CRASH_REPORT_HAS_COREDUMP 1
+#else
+#define CRASH_REPORT_HAS_COREDUMP 0
+#endif
+
+// Turns the previous boot's crash into one telemetry record. begin()
+// runs early in setup(): if the reset reason says the last boot died
+// (panic, a watchdog, brownout) it pulls the coredump summary - the
+// faulting task, PC, exception cause and backtrace - out of flash and
+// holds it. The owner publishes the record on the first connected
+// telemetry cycle (reportBootProfile precedent) and calls
+// markReported(), which erases the dump so each crash is reported
+// exactly once; a crash that precedes connectivity simply waits in
+// flash for a boot that gets online.
+//
+// The full ELF dump stays in the partition until markReported() for
+// the cases where a truck roll does happen - this class only skims the
+// summary, it never uploads the image itself.
+class CrashReport {
+public:
+  void begin() {
+    _reason = esp_reset_reason();
+    _crashed = _reason == ESP_RST_PANIC || _reason == ESP_RST_INT_WDT ||
+               _reason == ESP_RST_TASK_WDT || _reason == ESP_RST_WDT ||
+               _reason == ESP_RST_BROWNOUT;
+    if (!_crashed) {
+      return;
+    }
+#if CRASH_REPORT_HAS_COREDUMP
+    _haveSummary = esp_core_dump_image_check() == ESP_OK &&
+                   esp_core_dump_get_summary(&_summary) == ESP_OK;
+#endif
+  }
+
+  // True until the record has been published and acknowledged
+  bool pending() const { return _crashed && !_reported; }
+
+  // The publish went out: erase the dump so the next boot stays quiet
+  void markReported() {
+    _reported = true;
+#if CRASH_REPORT_HAS_COREDUMP
+    if (_haveSummary) {
+      esp_core_dump_image_erase();
+    }
+#endif
+  }
+
+  static const char *reasonName(esp_reset_reason_t reason) {
+    switch (reason) {
+      case ESP_RST_PANIC:    return "panic";
+      case ESP_RST_INT_WDT:  return "intWdt";
+      case ESP_RST_TASK_WDT: return "taskWdt";
+      case ESP_RST_WDT:      return "wdt";
+      case ESP_RST_BROWNOUT: return "brownout";
+      default:               return "other";
+    }
+  }
+
+  // One flat JSON telemetry object. The caller passes the
+  // RTC-persistent heap numbers (heap_monitor.h) - they rode through
+  // the panic reset, so they describe the heap the crash happened on:
+  //   {"crash":"panic","crashTask":"TaskDHT20","crashPc":"0x...",
+  //    "crashCause":29,"crashVaddr":"0x...","crashBt":"0x..;0x..",
+  //    "heapLargestMin":m,"heapAllocFail":n}
+  // The backtrace is semicolon-joined PC values; addr2line against the
+  // matching .elf turns it into the stack that crashed.
+  size_t serialize(char *buf, size_t cap, uint32_t heapLargestMin,
+                   uint32_t heapAllocFailures) const {
+    size_t len = snprintf(buf, cap, "{\"crash\":\"%s\"", reasonName(_reason));
+#if CRASH_REPORT_HAS_COREDUMP
+    if (_haveSummary && len < cap) {
+      len += snprintf(buf + len, cap - len,
+                      ",\"crashTask\":\"%.16s\",\"crashPc\":\"0x%lx\","
+                      "\"crashCause\":%lu,\"crashVaddr\":\"0x%lx\"",
+                      _summary.exc_task, (unsigned long)_summary.exc_pc,
+                      (unsigned long)_summary.ex_info.exc_cause,
+                      (unsigned long)_summary.ex_info.exc_vaddr);
+      if (len < cap) {
+        len += snprintf(buf + len, cap - len, ",\"crashBt\":\"");
+      }
+      for (uint32_t i = 0; i < _summary.exc_bt_info.depth && len < cap; i++) {
+        len += snprintf(buf + len, cap - len, "%s0x%lx", i ? ";" : "",
+                        (unsigned long)_summary.exc_bt_info.bt[i]);
+      }
+      if (len < cap) {
+        len += snprintf(buf + len, cap - len, "\"%s",
+                        _summary.exc_bt_info.corrupted
+                            ? ",\"crashBtCorrupt\":true"
+                            : "");
+      }
+    }
+#endif
+    if (len < cap) {
+      len += snprintf(buf + len, cap - len,
+                      ",\"heapLargestMin\":%lu,\"heapAllocFail\":%lu}",
+                      (unsigned long)heapLargestMin,
+                      (unsigned long)heapAllocFailures);
+    }
+    return len < cap ? len : cap - 1;
+  }
+
+private:
+  esp_reset_reason_t _reason = ESP_RST_UNKNOWN;
+  bool _crashed = false;
+  bool _reported = false;
+#if CRASH_REPORT_HAS_COREDUMP
+  bool _haveSummary = false;
+  esp_core_dump_summary_t _summary = {};
+#endif
+};
+
+#endif // CRASH_REPORT_H
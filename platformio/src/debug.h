@@ -2,10 +2,43 @@
 #define DEBUG_H
 
 #include <Arduino.h>
+#include "async_logger.h"
 
 // Set this to 1 to enable verbose debug output
 #define DEBUG_MODE 1
 
+// Leveled logging over the async ring. LOG_LEVEL is a compile-time
+// cutoff: calls below it are `if (false)` around a never-instantiated
+// branch, so the format strings and call overhead vanish from the
+// binary (the gnu++11 spelling of an `if constexpr` strip). Retained
+// calls go through logger.logd(), which defers formatting to the drain
+// task — the calling task only stores the format pointer and raw
+// argument words. Arguments to %s must be string literals or static
+// buffers; anything stack-allocated needs logger.logf() instead.
+//
+// Override per build with -D LOG_LEVEL=LOG_LEVEL_WARN in platformio.ini.
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+  #if DEBUG_MODE
+    #define LOG_LEVEL LOG_LEVEL_DEBUG
+  #else
+    #define LOG_LEVEL LOG_LEVEL_INFO
+  #endif
+#endif
+
+// The single ring shared by all tasks, defined in main.cpp
+extern AsyncLogger logger;
+
+#define LOG_ERROR(...) do { if (LOG_LEVEL >= LOG_LEVEL_ERROR) logger.logd(__VA_ARGS__); } while (0)
+#define LOG_WARN(...)  do { if (LOG_LEVEL >= LOG_LEVEL_WARN)  logger.logd(__VA_ARGS__); } while (0)
+#define LOG_INFO(...)  do { if (LOG_LEVEL >= LOG_LEVEL_INFO)  logger.logd(__VA_ARGS__); } while (0)
+#define LOG_DEBUG(...) do { if (LOG_LEVEL >= LOG_LEVEL_DEBUG) logger.logd(__VA_ARGS__); } while (0)
+
 #if DEBUG_MODE
   #define DEBUG_PRINT(x) Serial.print(x)
   #define DEBUG_PRINTLN(x) Serial.println(x)
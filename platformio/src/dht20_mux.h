@@ -0,0 +1,162 @@
+#ifndef DHT20_MUX_H
+#define DHT20_MUX_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "DHT20.h"
+
+// Probe arrays behind a TCA9548A: many DHT20s on one node.
+//
+// The DHT20 has a hard-wired I2C address (0x38), so one bus carries one
+// climate probe and dense benches ended up with a node per probe. A
+// TCA9548A in front of the sensors gives each probe its own bus
+// segment; this manager hides the channel switching behind the same
+// async request/read split the single-probe path uses, and interleaves
+// it: trigger every present probe back to back (a channel select plus
+// a 3-byte write each), let all conversions run concurrently, then
+// read the results back to back. Eight probes complete in barely more
+// than one sensor's ~80ms conversion - the array costs channel-select
+// overhead, not 8x the latency.
+//
+// One shared DHT20 instance serves every channel: the probes are
+// identical and per-probe state (raw bytes, conversion result) is
+// copied out immediately after each read, so nothing leaks between
+// channels. All entry points perform plain Wire transactions and must
+// run on the bus manager's task like every other I2C client; the mux
+// is left with all channels closed after each batch so the root bus
+// never sees a probe's address while other devices talk.
+class Dht20Mux {
+ public:
+  static const int MAX_CHANNELS = 8;
+
+  explicit Dht20Mux(TwoWire *wire = &Wire, uint8_t muxAddress = 0x70)
+      : _wire(wire), _muxAddress(muxAddress), _dht(wire) {}
+
+  // Probe discovery over the given channel mask; call once after
+  // Wire.begin(). Returns the number of probes answering.
+  int begin(uint8_t channelMask) {
+    _present = 0;
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+      if ((channelMask & (1 << ch)) && select(ch) && _dht.isConnected()) {
+        _present |= (1 << ch);
+        _status[ch] = DHT20_OK;
+      }
+    }
+    deselect();
+    return countBits(_present);
+  }
+
+  uint8_t presentMask() const { return _present; }
+  int probeCount() const { return countBits(_present); }
+
+  // Trigger a conversion on every present probe; returns how many
+  // accepted the trigger. The conversions then run concurrently.
+  int requestAll() {
+    _pending = 0;
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+      if (!(_present & (1 << ch))) {
+        continue;
+      }
+      if (select(ch) && _dht.requestData() == 0) {
+        _pending |= (1 << ch);
+      } else {
+        // A probe that stops answering drops out of the means until it
+        // triggers cleanly again
+        _status[ch] = DHT20_ERROR_CONNECT;
+      }
+    }
+    deselect();
+    return countBits(_pending);
+  }
+
+  // True while any triggered probe is still converting
+  bool anyMeasuring() {
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+      if ((_pending & (1 << ch)) && select(ch) && _dht.isMeasuring()) {
+        deselect();
+        return true;
+      }
+    }
+    deselect();
+    return false;
+  }
+
+  // Collect every triggered probe's result; returns how many read
+  // clean. Per-probe values and status are kept until the next pass.
+  int readAll() {
+    int good = 0;
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+      if (!(_pending & (1 << ch))) {
+        continue;
+      }
+      if (select(ch) && _dht.readData() > 0 && _dht.convert() == DHT20_OK) {
+        _temperature[ch] = _dht.getTemperature();
+        _humidity[ch] = _dht.getHumidity();
+        _status[ch] = DHT20_OK;
+        good++;
+      } else {
+        _status[ch] = DHT20_ERROR_LASTREAD;
+      }
+    }
+    _pending = 0;
+    deselect();
+    return good;
+  }
+
+  float temperature(int ch) const { return _temperature[ch]; }
+  float humidity(int ch) const { return _humidity[ch]; }
+  int status(int ch) const { return _status[ch]; }
+
+  // Array means over the probes whose last read was clean - the
+  // single-value consumers (control loop, telemetry record) see the
+  // canopy average instead of one corner of the bench
+  float meanTemperature() const { return meanOf(_temperature); }
+  float meanHumidity() const { return meanOf(_humidity); }
+
+ private:
+  bool select(int ch) {
+    _wire->beginTransmission(_muxAddress);
+    _wire->write((uint8_t)(1 << ch));
+    return _wire->endTransmission() == 0;
+  }
+
+  void deselect() {
+    _wire->beginTransmission(_muxAddress);
+    _wire->write((uint8_t)0);
+    _wire->endTransmission();
+  }
+
+  float meanOf(const float *values) const {
+    float sum = 0.0f;
+    int n = 0;
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+      if ((_present & (1 << ch)) && _status[ch] == DHT20_OK) {
+        sum += values[ch];
+        n++;
+      }
+    }
+    return n > 0 ? sum / n : 0.0f;
+  }
+
+  static int countBits(uint8_t mask) {
+    int n = 0;
+    for (; mask != 0; mask >>= 1) {
+      n += mask & 1;
+    }
+    return n;
+  }
+
+  TwoWire *_wire;
+  uint8_t _muxAddress;
+  DHT20 _dht;
+  uint8_t _present = 0;
+  uint8_t _pending = 0;
+  float _temperature[MAX_CHANNELS] = {};
+  float _humidity[MAX_CHANNELS] = {};
+  int _status[MAX_CHANNELS] = {DHT20_ERROR_CONNECT, DHT20_ERROR_CONNECT,
+                               DHT20_ERROR_CONNECT, DHT20_ERROR_CONNECT,
+                               DHT20_ERROR_CONNECT, DHT20_ERROR_CONNECT,
+                               DHT20_ERROR_CONNECT, DHT20_ERROR_CONNECT};
+};
+
+#endif  // DHT20_MUX_H
@@ -0,0 +1,178 @@
+#ifndef ENERGY_MONITOR_H
+#define ENERGY_MONITOR_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Calibrated per-state current figures in microamps, measured at the
+// battery terminals with a bench supply on the reference node. They are
+// estimates of a state's *additional* draw, so subsystem charges add up
+// instead of double counting:
+//   - BASELINE is the chip powered and scheduling with the radio off,
+//     integrated over the whole window
+//   - CPU_ACTIVE is the extra draw while a task is doing real work,
+//     accounted only inside the marked busy windows
+//   - WIFI_ON is the extra draw while associated (DTIM listen), WIFI_TX
+//     the extra burst on top of that during a socket write
+// Recalibrate per board revision with -D ENERGY_UA_<STATE>=<ua>.
+#ifndef ENERGY_UA_BASELINE
+#define ENERGY_UA_BASELINE 26000
+#endif
+#ifndef ENERGY_UA_CPU_ACTIVE
+#define ENERGY_UA_CPU_ACTIVE 38000
+#endif
+#ifndef ENERGY_UA_WIFI_ON
+#define ENERGY_UA_WIFI_ON 68000
+#endif
+#ifndef ENERGY_UA_WIFI_TX
+#define ENERGY_UA_WIFI_TX 180000
+#endif
+#ifndef ENERGY_UA_DHT20
+#define ENERGY_UA_DHT20 980
+#endif
+#ifndef ENERGY_UA_ADC_DMA
+#define ENERGY_UA_ADC_DMA 1100
+#endif
+
+// Per-subsystem charge ledger. Battery nodes die faster than the models
+// predict and free-heap-style aggregate numbers cannot attribute the
+// drain, so this integrates estimated charge per subsystem from the
+// durations the firmware actually spends in each state: the WiFi event
+// handler reports radio on/off, publish paths mark TX windows, the
+// sensor task marks DHT20 conversion and ADC windows, and the telemetry
+// loop marks its busy window for active-vs-idle CPU accounting. Charge
+// accumulates in picocoulombs (us * uA) so integer math never rounds a
+// short window to zero; a day at full TX draw still fits a uint64 with
+// orders of magnitude to spare.
+//
+// Accounting calls come from several tasks plus the WiFi event handler,
+// so the accumulators are guarded by a spinlock; every critical section
+// is a handful of integer operations.
+class EnergyMonitor {
+public:
+  enum Subsystem {
+    WIFI = 0,   // TX windows + continuous associated time
+    SENSOR,     // DHT20 conversion/readout windows
+    ADC,        // DMA sampling (continuous) or analogRead windows
+    CPU,        // marked busy windows, at the active-minus-idle delta
+    SUBSYSTEM_COUNT
+  };
+
+  void begin() {
+    _windowStartUs = esp_timer_get_time();
+  }
+
+  // Radio association state, driven from the WiFi event handler. The
+  // associated-idle draw integrates over the whole connected time, TX
+  // windows add their burst on top.
+  void setWifiOn(bool on) {
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&_lock);
+    if (on && !_wifiOn) {
+      _wifiOnSinceUs = now;
+    } else if (!on && _wifiOn) {
+      _chargePc[WIFI] += (uint64_t)(now - _wifiOnSinceUs) * ENERGY_UA_WIFI_ON;
+    }
+    _wifiOn = on;
+    portEXIT_CRITICAL(&_lock);
+  }
+
+  // Continuous-conversion DMA sampling runs from setup() onward; the
+  // analogRead fallback accounts discrete windows instead
+  void setAdcContinuous(bool on) {
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&_lock);
+    if (on && !_adcOn) {
+      _adcOnSinceUs = now;
+    } else if (!on && _adcOn) {
+      _chargePc[ADC] += (uint64_t)(now - _adcOnSinceUs) * ENERGY_UA_ADC_DMA;
+    }
+    _adcOn = on;
+    portEXIT_CRITICAL(&_lock);
+  }
+
+  // One open window per subsystem; each subsystem's windows are marked
+  // from a single task (the sensor task), so begin/end never race each
+  // other. Callers on shared paths (publishes can come from several
+  // tasks) time the window locally and use accountUs() instead.
+  void windowBegin(Subsystem s) {
+    _openSinceUs[s] = esp_timer_get_time();
+    _windowOpen[s] = true;
+  }
+
+  void windowEnd(Subsystem s) {
+    if (!_windowOpen[s]) {
+      return;
+    }
+    _windowOpen[s] = false;
+    accountUs(s, (uint32_t)(esp_timer_get_time() - _openSinceUs[s]));
+  }
+
+  void accountUs(Subsystem s, uint32_t durationUs) {
+    portENTER_CRITICAL(&_lock);
+    _chargePc[s] += (uint64_t)durationUs * windowCurrentUa(s);
+    portEXIT_CRITICAL(&_lock);
+  }
+
+  // One JSON telemetry object, millicoulombs per subsystem over the
+  // integration window plus the window length:
+  //   {"energyWifiMc":w,"energySensorMc":s,"energyAdcMc":a,
+  //    "energyCpuMc":c,"energyBaseMc":b,"energyWindowS":t}
+  // Closes the window: continuous states are integrated up to now and
+  // re-anchored, accumulators reset, so each report stands alone.
+  size_t serialize(char *buf, size_t cap) {
+    const int64_t now = esp_timer_get_time();
+    uint64_t chargePc[SUBSYSTEM_COUNT];
+    portENTER_CRITICAL(&_lock);
+    if (_wifiOn) {
+      _chargePc[WIFI] += (uint64_t)(now - _wifiOnSinceUs) * ENERGY_UA_WIFI_ON;
+      _wifiOnSinceUs = now;
+    }
+    if (_adcOn) {
+      _chargePc[ADC] += (uint64_t)(now - _adcOnSinceUs) * ENERGY_UA_ADC_DMA;
+      _adcOnSinceUs = now;
+    }
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+      chargePc[i] = _chargePc[i];
+      _chargePc[i] = 0;
+    }
+    const uint64_t windowUs = (uint64_t)(now - _windowStartUs);
+    _windowStartUs = now;
+    portEXIT_CRITICAL(&_lock);
+
+    const uint64_t basePc = windowUs * ENERGY_UA_BASELINE;
+    size_t len = snprintf(buf, cap,
+        "{\"energyWifiMc\":%lu,\"energySensorMc\":%lu,\"energyAdcMc\":%lu,"
+        "\"energyCpuMc\":%lu,\"energyBaseMc\":%lu,\"energyWindowS\":%lu}",
+        (unsigned long)(chargePc[WIFI] / 1000000000ULL),
+        (unsigned long)(chargePc[SENSOR] / 1000000000ULL),
+        (unsigned long)(chargePc[ADC] / 1000000000ULL),
+        (unsigned long)(chargePc[CPU] / 1000000000ULL),
+        (unsigned long)(basePc / 1000000000ULL),
+        (unsigned long)(windowUs / 1000000ULL));
+    return len < cap ? len : cap - 1;
+  }
+
+private:
+  static uint32_t windowCurrentUa(Subsystem s) {
+    switch (s) {
+      case WIFI:   return ENERGY_UA_WIFI_TX;
+      case SENSOR: return ENERGY_UA_DHT20;
+      case ADC:    return ENERGY_UA_ADC_DMA;
+      case CPU:    return ENERGY_UA_CPU_ACTIVE;
+      default:     return 0;
+    }
+  }
+
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+  uint64_t _chargePc[SUBSYSTEM_COUNT] = {0};
+  int64_t _openSinceUs[SUBSYSTEM_COUNT] = {0};
+  bool _windowOpen[SUBSYSTEM_COUNT] = {false};
+  bool _wifiOn = false;
+  bool _adcOn = false;
+  int64_t _wifiOnSinceUs = 0;
+  int64_t _adcOnSinceUs = 0;
+  int64_t _windowStartUs = 0;
+};
+
+#endif // ENERGY_MONITOR_H
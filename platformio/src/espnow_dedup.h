@@ -0,0 +1,105 @@
+#ifndef ESPNOW_DEDUP_H
+#define ESPNOW_DEDUP_H
+
+#include <Arduino.h>
+
+// Per-leaf duplicate suppression for the ESP-NOW gateway.
+//
+// Leaves retransmit when the link-layer ACK is lost on the ACK rather
+// than the data, so the gateway sees the same frame twice; forwarding
+// both doubles broker traffic for nothing. Each leaf already stamps a
+// uint16 sequence (espnow_telemetry.h), so the gateway keeps a few
+// bytes per peer: the newest accepted sequence plus a bitmap of the
+// WINDOW sequences behind it. A repeat inside the window is dropped, a
+// frame slightly behind the newest (reordered in the air or in the
+// receive queue) is still accepted once, and a jump far backwards is
+// read as the leaf rebooting with a fresh counter and resynchronises
+// the slot.
+//
+// All arithmetic is on the signed 16-bit difference, so the counter
+// wrapping at 65535 behaves like any other forward step.
+class EspNowDedup {
+public:
+  // One slot per leaf the gateway has heard; a sector is ~40 leaves so
+  // the table stays a few hundred bytes.
+  static const uint8_t MAX_PEERS = 48;
+
+  // How far behind the newest sequence a late frame is still accepted.
+  // Leaves send once per minute, so anything older than a handful of
+  // sequences is minutes stale and worthless upstream anyway.
+  static const uint8_t WINDOW = 32;
+
+  // True when the frame is new and should be forwarded; false drops it.
+  bool accept(uint8_t leafId, uint16_t sequence) {
+    Peer *peer = find(leafId);
+    if (peer == NULL) {
+      // Table full: forward rather than drop, duplicates from an
+      // untracked leaf are a cost, lost samples are worse
+      return true;
+    }
+    if (!peer->seen) {
+      peer->seen = true;
+      peer->newest = sequence;
+      peer->window = 1U;
+      return true;
+    }
+    const int16_t delta = (int16_t)(sequence - peer->newest);
+    if (delta > 0) {
+      // Ahead of everything seen: slide the window forward
+      if (delta >= (int16_t)WINDOW) {
+        peer->window = 1U;
+      } else {
+        peer->window = (peer->window << delta) | 1U;
+      }
+      peer->newest = sequence;
+      return true;
+    }
+    if (delta > -(int16_t)WINDOW) {
+      // Behind the newest but inside the window: accept the first
+      // arrival, drop the retransmissions
+      const uint32_t bit = 1UL << (uint8_t)(-delta);
+      if (peer->window & bit) {
+        _duplicates++;
+        return false;
+      }
+      peer->window |= bit;
+      return true;
+    }
+    // Far behind: the leaf lost its RTC state (reflash, brownout) and
+    // restarted the counter, so start over from this frame
+    peer->newest = sequence;
+    peer->window = 1U;
+    return true;
+  }
+
+  uint32_t duplicates() const { return _duplicates; }
+
+private:
+  struct Peer {
+    uint8_t leafId;
+    bool seen;
+    uint16_t newest;    // highest sequence accepted so far
+    uint32_t window;    // bit i set = (newest - i) already accepted
+  };
+
+  Peer *find(uint8_t leafId) {
+    for (uint8_t i = 0; i < _peerCount; i++) {
+      if (_peers[i].leafId == leafId) {
+        return &_peers[i];
+      }
+    }
+    if (_peerCount >= MAX_PEERS) {
+      return NULL;
+    }
+    Peer *peer = &_peers[_peerCount++];
+    peer->leafId = leafId;
+    peer->seen = false;
+    return peer;
+  }
+
+  Peer _peers[MAX_PEERS];
+  uint8_t _peerCount = 0;
+  uint32_t _duplicates = 0;
+};
+
+#endif // ESPNOW_DEDUP_H
@@ -0,0 +1,225 @@
+/**
+ * ESP-NOW gateway firmware (built by the "espnow_gateway" PlatformIO
+ * environment instead of the normal firmware).
+ *
+ * The gateway is the only node in a sector that associates to the AP.
+ * It receives EspNowTelemetryFrame packets from the leaves, batches
+ * them and publishes one consolidated MQTT message per flush interval:
+ *
+ *   {"gw":<id>,"frames":[{"leaf":1,"seq":42,"ageMs":180,
+ *     "temperature":27.3,"humidity":61.2,"light":512,"moisture":47},...]}
+ *
+ * so ~40 leaves cost the AP a single association and the broker one
+ * publish every few seconds instead of 40 MQTT sessions.
+ *
+ * Constraint: ESP-NOW and the STA link share one radio, so the AP must
+ * sit on ESPNOW_CHANNEL (see espnow_telemetry.h) for the leaves to be
+ * heard while the gateway is associated.
+ *
+ *   pio run -e espnow_gateway -t upload
+ */
+
+#ifdef ESPNOW_GATEWAY_FIRMWARE
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <PubSubClient.h>
+#include <ArduinoJson.h>
+#include "espnow_telemetry.h"
+#include "espnow_dedup.h"
+#include "fixed_decimal.h"
+#include "payload_codec.h"
+
+constexpr char WIFI_SSID[] = "P4.11";
+constexpr char WIFI_PASSWORD[] = "123456788";
+
+constexpr char MQTT_BROKER[] = "app.coreiot.io";
+constexpr uint16_t MQTT_PORT = 1883U;
+constexpr char MQTT_USER[] = "iot_farm";
+constexpr char MQTT_PASSWORD[] = "123456789";
+constexpr char MQTT_GATEWAY_TOPIC[] = "coreiot/gateway/telemetry";
+constexpr char MQTT_GATEWAY_TOPIC_LZ[] = "coreiot/gateway/telemetry" PAYLOAD_LZ_TOPIC_SUFFIX;
+
+#ifndef ESPNOW_GATEWAY_ID
+#define ESPNOW_GATEWAY_ID 1
+#endif
+
+// Flush whatever has arrived every interval, or earlier when the batch
+// fills. 16 frames of JSON stay comfortably inside one MQTT packet.
+#define GATEWAY_BATCH_SIZE 16
+#define GATEWAY_FLUSH_MS 5000
+
+// Receive callback runs in the WiFi task: copy the frame into a queue
+// and get out, all parsing and publishing happens in loop()
+static QueueHandle_t frameQueue;
+static volatile uint32_t droppedFrames = 0;
+
+// Frame plus the arrival time, so ageMs stays correct however long the
+// frame waits in the batch
+struct QueuedFrame {
+  EspNowTelemetryFrame frame;
+  uint32_t receivedMs;
+};
+
+WiFiClient wifiClient;
+PubSubClient mqttClient(wifiClient);
+
+// Leaf retransmissions show up as repeated sequences; filter them here
+// in loop() rather than in the receive callback so the callback stays a
+// memcpy
+EspNowDedup dedup;
+
+static void onEspNowReceive(const uint8_t *mac, const uint8_t *data, int len) {
+  if (len != sizeof(EspNowTelemetryFrame)) {
+    return;
+  }
+  QueuedFrame queued;
+  memcpy(&queued.frame, data, sizeof(queued.frame));
+  if (queued.frame.version != ESPNOW_FRAME_VERSION) {
+    return;
+  }
+  queued.receivedMs = millis();
+  if (xQueueSend(frameQueue, &queued, 0) != pdTRUE) {
+    droppedFrames++;
+  }
+}
+
+static void ensureMqtt() {
+  if (WiFi.status() != WL_CONNECTED || mqttClient.connected() ||
+      mqttClient.connecting()) {
+    return;
+  }
+  char clientId[32];
+  snprintf(clientId, sizeof(clientId), "esp32-gateway-%d", ESPNOW_GATEWAY_ID);
+  // Non-blocking: the CONNACK is consumed by mqttClient.loop(), so a
+  // slow broker no longer stalls the dequeue path while ESP-NOW frames
+  // pile into the queue; the batch buffer rides out the handshake
+  mqttClient.connectAsync(clientId, MQTT_USER, MQTT_PASSWORD);
+}
+
+static void flushBatch(QueuedFrame *batch, size_t count) {
+  if (count == 0 || !mqttClient.connected()) {
+    return;
+  }
+  // Frames from one leaf can arrive out of order within the flush
+  // window (queue backlog, air reordering); sorting by leaf then
+  // sequence makes each publish in-order per leaf, with the flush
+  // interval as the reordering bound. Insertion sort: the batch is at
+  // most GATEWAY_BATCH_SIZE and nearly sorted already.
+  for (size_t i = 1; i < count; i++) {
+    QueuedFrame key = batch[i];
+    size_t j = i;
+    while (j > 0 && (batch[j - 1].frame.leafId > key.frame.leafId ||
+                     (batch[j - 1].frame.leafId == key.frame.leafId &&
+                      (int16_t)(key.frame.sequence - batch[j - 1].frame.sequence) < 0))) {
+      batch[j] = batch[j - 1];
+      j--;
+    }
+    batch[j] = key;
+  }
+  // The fixed-decimal fields render into the document string pool, so
+  // the capacity includes POOL_BYTES per wrapped value on top of the
+  // structure nodes
+  StaticJsonDocument<JSON_OBJECT_SIZE(2) + GATEWAY_BATCH_SIZE * JSON_OBJECT_SIZE(7) + JSON_ARRAY_SIZE(GATEWAY_BATCH_SIZE) + GATEWAY_BATCH_SIZE * 4 * FixedDecimal::POOL_BYTES> doc;
+  doc["gw"] = ESPNOW_GATEWAY_ID;
+  JsonArray frames = doc.createNestedArray("frames");
+  for (size_t i = 0; i < count; i++) {
+    JsonObject obj = frames.createNestedObject();
+    obj["leaf"] = batch[i].frame.leafId;
+    obj["seq"] = batch[i].frame.sequence;
+    obj["ageMs"] = millis() - batch[i].receivedMs;
+    // Two fractional digits carry everything the sensors resolve, and
+    // the integer formatter keeps a full batch out of the generic
+    // float serializer
+    obj["temperature"] = FixedDecimal(batch[i].frame.temperature);
+    obj["humidity"] = FixedDecimal(batch[i].frame.humidity);
+    obj["light"] = FixedDecimal(batch[i].frame.light, 0);
+    obj["moisture"] = FixedDecimal(batch[i].frame.moisture);
+  }
+  char payload[1024];
+  const size_t payloadLen = serializeJson(doc, payload, sizeof(payload));
+
+  // A full batch is ~1KB of JSON repeating the same seven keys per
+  // frame; above the threshold LZSS cuts it to roughly a quarter, which
+  // is that much less airtime per flush. Small batches and a compressor
+  // failure fall through to the plain topic unchanged.
+  if (payloadLen >= PAYLOAD_LZ_MIN_BYTES) {
+    static uint8_t compressed[1024];
+    const size_t compressedLen =
+        payloadCompress((const uint8_t *)payload, payloadLen, compressed, sizeof(compressed));
+    if (compressedLen > 0 && compressedLen < payloadLen) {
+      mqttClient.publish(MQTT_GATEWAY_TOPIC_LZ, compressed, compressedLen);
+      return;
+    }
+  }
+  mqttClient.publish(MQTT_GATEWAY_TOPIC, payload);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(100);
+  Serial.println("\n--- ESP-NOW sector gateway ---");
+
+  frameQueue = xQueueCreate(64, sizeof(QueuedFrame));
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  for (int i = 0; i < 20 && WiFi.status() != WL_CONNECTED; i++) {
+    delay(500);
+  }
+  // Leaves need this MAC compiled in as GATEWAY_MAC
+  Serial.print("Gateway STA MAC: ");
+  Serial.println(WiFi.macAddress());
+  Serial.printf("Channel: %d (leaves must match ESPNOW_CHANNEL)\n", WiFi.channel());
+
+  if (esp_now_init() != ESP_OK) {
+    Serial.println("ESP-NOW init failed, rebooting");
+    delay(1000);
+    ESP.restart();
+  }
+  esp_now_register_recv_cb(onEspNowReceive);
+
+  mqttClient.setServer(MQTT_BROKER, MQTT_PORT);
+  mqttClient.setBufferSize(1280);
+  mqttClient.setConnectCallback([](bool ok) {
+    Serial.println(ok ? "MQTT connected" : "MQTT connect failed");
+  });
+  ensureMqtt();
+}
+
+void loop() {
+  static QueuedFrame batch[GATEWAY_BATCH_SIZE];
+  static size_t batchCount = 0;
+  static uint32_t lastFlushMs = 0;
+  static uint32_t lastDropReport = 0;
+
+  ensureMqtt();
+  mqttClient.loop();
+
+  while (batchCount < GATEWAY_BATCH_SIZE &&
+         xQueueReceive(frameQueue, &batch[batchCount], 0) == pdTRUE) {
+    if (!dedup.accept(batch[batchCount].frame.leafId,
+                      batch[batchCount].frame.sequence)) {
+      continue;  // retransmission of a frame already in flight upstream
+    }
+    batchCount++;
+  }
+
+  if (batchCount >= GATEWAY_BATCH_SIZE ||
+      (batchCount > 0 && millis() - lastFlushMs >= GATEWAY_FLUSH_MS)) {
+    flushBatch(batch, batchCount);
+    batchCount = 0;
+    lastFlushMs = millis();
+  }
+
+  if (droppedFrames != lastDropReport) {
+    Serial.printf("[GW] %u frames dropped (queue full), %u duplicates suppressed\n",
+                  droppedFrames - lastDropReport, dedup.duplicates());
+    lastDropReport = droppedFrames;
+  }
+
+  delay(20);
+}
+
+#endif // ESPNOW_GATEWAY_FIRMWARE
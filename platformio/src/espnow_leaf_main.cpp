@@ -0,0 +1,109 @@
+/**
+ * ESP-NOW leaf firmware (built by the "espnow_leaf" PlatformIO
+ * environment instead of the normal firmware).
+ *
+ * A leaf never associates to the AP: it wakes from deep sleep, samples
+ * the sensors, sends one EspNowTelemetryFrame to the sector gateway
+ * (~1ms of radio time instead of seconds of WiFi+MQTT bring-up) and
+ * goes back to sleep. Per-leaf state lives in RTC slow memory.
+ *
+ *   pio run -e espnow_leaf -t upload
+ */
+
+#ifdef ESPNOW_LEAF_FIRMWARE
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include "DHT20.h"
+#include "Wire.h"
+#include "espnow_telemetry.h"
+
+#define SDA_PIN GPIO_NUM_11
+#define SCL_PIN GPIO_NUM_12
+#define LIGHT_SENSOR_PIN GPIO_NUM_1
+#define MOISTURE_PIN GPIO_NUM_2
+
+// Which node this is within the sector; flashed per device
+#ifndef ESPNOW_LEAF_ID
+#define ESPNOW_LEAF_ID 1
+#endif
+
+#define ESPNOW_LEAF_SLEEP_S 60
+
+// MAC of the sector gateway's STA interface (printed by the gateway on
+// boot). Broadcast would also work but unicast gets link-layer ACKs.
+static const uint8_t GATEWAY_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+DHT20 dht20;
+
+// Survives deep sleep: lets the gateway detect dropped frames
+RTC_DATA_ATTR uint16_t leafSequence = 0;
+
+static volatile bool sendDone = false;
+static volatile bool sendOk = false;
+
+static void onEspNowSent(const uint8_t *mac, esp_now_send_status_t status) {
+  sendOk = (status == ESP_NOW_SEND_SUCCESS);
+  sendDone = true;
+}
+
+static void goToSleep() {
+  esp_sleep_enable_timer_wakeup((uint64_t)ESPNOW_LEAF_SLEEP_S * 1000000ULL);
+  esp_deep_sleep_start();
+}
+
+void setup() {
+  // No Serial.begin in the hot path: the whole cycle is radio + sensor
+  // bound and the leaf is usually headless in the field
+  Wire.begin(SDA_PIN, SCL_PIN);
+  dht20.begin();
+  pinMode(LIGHT_SENSOR_PIN, INPUT);
+  pinMode(MOISTURE_PIN, INPUT);
+
+  EspNowTelemetryFrame frame;
+  frame.version = ESPNOW_FRAME_VERSION;
+  frame.leafId = ESPNOW_LEAF_ID;
+  frame.sequence = leafSequence++;
+  frame.temperature = NAN;
+  frame.humidity = NAN;
+  if (dht20.read() == DHT20_OK) {
+    frame.temperature = dht20.getTemperature();
+    frame.humidity = dht20.getHumidity();
+  }
+  frame.light = analogRead(LIGHT_SENSOR_PIN);
+  frame.moisture = analogRead(MOISTURE_PIN);
+  frame.uptimeMs = millis();
+
+  // STA mode but never associated: just enough radio for ESP-NOW
+  WiFi.mode(WIFI_STA);
+  esp_wifi_set_channel(ESPNOW_CHANNEL, WIFI_SECOND_CHAN_NONE);
+  if (esp_now_init() != ESP_OK) {
+    goToSleep();
+  }
+  esp_now_register_send_cb(onEspNowSent);
+
+  esp_now_peer_info_t peer = {};
+  memcpy(peer.peer_addr, GATEWAY_MAC, 6);
+  peer.channel = ESPNOW_CHANNEL;
+  peer.encrypt = false;
+  esp_now_add_peer(&peer);
+
+  esp_now_send(GATEWAY_MAC, (const uint8_t *)&frame, sizeof(frame));
+
+  // The send callback fires within a few ms; cap the wait so a dead
+  // gateway cannot keep the leaf awake
+  uint32_t waitStart = millis();
+  while (!sendDone && millis() - waitStart < 100) {
+    delay(1);
+  }
+
+  goToSleep();
+}
+
+void loop() {
+  // never reached: setup() ends in deep sleep
+}
+
+#endif // ESPNOW_LEAF_FIRMWARE
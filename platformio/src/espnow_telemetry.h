@@ -0,0 +1,35 @@
+#ifndef ESPNOW_TELEMETRY_H
+#define ESPNOW_TELEMETRY_H
+
+#include <Arduino.h>
+
+// Wire format shared between the ESP-NOW leaf and gateway firmware
+// roles. Leaves broadcast one frame per wake cycle without associating
+// to the AP; the gateway batches frames from many leaves into
+// consolidated MQTT publishes, so only one node per sector holds an AP
+// association and the leaves spend ~1ms of radio time per sample.
+//
+// The struct goes over the air verbatim, so it is packed and versioned:
+// bump ESPNOW_FRAME_VERSION on any layout change and the gateway drops
+// frames whose version it does not understand.
+
+#define ESPNOW_FRAME_VERSION 1
+
+// Leaves transmit on a fixed channel; the gateway's AP must live on the
+// same channel (ESP-NOW and the STA share one radio), so pick the
+// channel here to match the farm AP configuration.
+#define ESPNOW_CHANNEL 6
+
+// ESP-NOW payload limit is 250 bytes; this frame is 24.
+struct __attribute__((packed)) EspNowTelemetryFrame {
+  uint8_t version;     // ESPNOW_FRAME_VERSION
+  uint8_t leafId;      // maps to the sector/node tables on the backend
+  uint16_t sequence;   // per-leaf send counter, lets the gateway spot gaps
+  uint32_t uptimeMs;   // leaf millis() at acquisition
+  float temperature;
+  float humidity;
+  float light;
+  float moisture;
+};
+
+#endif // ESPNOW_TELEMETRY_H
@@ -0,0 +1,140 @@
+#ifndef EVENT_SCHEDULER_H
+#define EVENT_SCHEDULER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Timer-driven job table for the periodic housekeeping loops.
+//
+// Each `while (1) { work; vTaskDelay(N); }` task costs a stack, a TCB
+// and a full context switch per period, and the periods drift apart so
+// two 500ms loops wake the core twice per window instead of once. This
+// scheduler replaces a set of such loops with one worker task and one
+// esp_timer: jobs register a period and phase, the worker runs
+// everything due in a pass, then arms a one-shot for the earliest next
+// edge. Phases stay anchored to each job's grid (a late pass skips
+// forward, it does not burst), so jobs whose periods divide each other
+// keep landing on shared wakeups - the 10s job rides every 20th wakeup
+// of the 500ms job instead of adding its own.
+//
+// This is for same-priority maintenance work with soft deadlines. The
+// control loop, the supervisor and the sampling pipeline stay as
+// dedicated tasks: they own a priority level or a hardware state
+// machine, which a shared worker cannot give them (the per-field
+// sampling rates live in sample_scheduler.h for the same reason). A
+// job that overruns delays its co-jobs, nothing else - same as the
+// priority-level scheduling it replaces.
+//
+// The esp_timer callback runs in the timer service task and only
+// notifies the worker; all job code runs in the worker task.
+class EventScheduler {
+ public:
+  static const int MAX_JOBS = 8;
+  typedef void (*JobFn)();
+
+  // Registration, before begin(). Phase offsets spread jobs that
+  // should not share a pass; equal phases (mod period) pool them.
+  int add(const char *name, uint32_t periodMs, uint32_t phaseMs, JobFn fn) {
+    if (_count >= MAX_JOBS) {
+      return -1;
+    }
+    _jobs[_count] = {name, fn, periodMs, (int64_t)phaseMs};
+    return _count++;
+  }
+
+  bool begin(const char *taskName, uint32_t stackBytes, UBaseType_t priority,
+             BaseType_t core) {
+    const esp_timer_create_args_t args = {
+        &EventScheduler::onTimer, this, ESP_TIMER_TASK, "evsched"};
+    if (esp_timer_create(&args, &_timer) != ESP_OK) {
+      return false;
+    }
+    // First due edges anchored to the boot-relative grid
+    const int64_t now = nowMs();
+    for (int i = 0; i < _count; i++) {
+      advance(_jobs[i], now);
+    }
+    return xTaskCreatePinnedToCore(&EventScheduler::workerTrampoline, taskName,
+                                   stackBytes, this, priority, &_worker,
+                                   core) == pdPASS;
+  }
+
+  uint32_t wakeups() const { return _wakeups; }
+  uint32_t sharedWakeups() const { return _sharedWakeups; }
+
+ private:
+  struct Job {
+    const char *name;
+    JobFn fn;
+    uint32_t periodMs;
+    int64_t nextDueMs;
+  };
+
+  static int64_t nowMs() { return esp_timer_get_time() / 1000; }
+
+  // Next grid point strictly in the future; a pass that ran late skips
+  // the missed edges instead of replaying them back to back
+  static void advance(Job &job, int64_t now) {
+    while (job.nextDueMs <= now) {
+      job.nextDueMs += job.periodMs;
+    }
+  }
+
+  static void onTimer(void *arg) {
+    EventScheduler *self = static_cast<EventScheduler *>(arg);
+    xTaskNotifyGive(self->_worker);
+  }
+
+  static void workerTrampoline(void *arg) {
+    static_cast<EventScheduler *>(arg)->workerLoop();
+  }
+
+  // One scheduling pass: run everything due, return the earliest next
+  // due edge (INT64_MAX with an empty table)
+  int64_t runDue() {
+    const int64_t now = nowMs();
+    int ran = 0;
+    int64_t earliest = INT64_MAX;
+    for (int i = 0; i < _count; i++) {
+      if (_jobs[i].nextDueMs <= now) {
+        _jobs[i].fn();
+        // Advance off the post-run clock: a job that overran its own
+        // period resumes on its grid, not in a catch-up burst
+        advance(_jobs[i], nowMs());
+        ran++;
+      }
+      if (_jobs[i].nextDueMs < earliest) {
+        earliest = _jobs[i].nextDueMs;
+      }
+    }
+    if (ran > 0) {
+      _wakeups++;
+      if (ran > 1) {
+        _sharedWakeups++;
+      }
+    }
+    return earliest;
+  }
+
+  void workerLoop() {
+    while (true) {
+      const int64_t earliest = runDue();
+      if (earliest == INT64_MAX) {
+        vTaskDelay(portMAX_DELAY);  // no jobs registered
+        continue;
+      }
+      const int64_t delayUs = (earliest - nowMs()) * 1000;
+      esp_timer_start_once(_timer, delayUs > 1000 ? delayUs : 1000);
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+  }
+
+  Job _jobs[MAX_JOBS];
+  int _count = 0;
+  TaskHandle_t _worker = NULL;
+  esp_timer_handle_t _timer = NULL;
+  uint32_t _wakeups = 0;
+  uint32_t _sharedWakeups = 0;
+};
+
+#endif  // EVENT_SCHEDULER_H
@@ -0,0 +1,66 @@
+// fixed_decimal.h - per-field fixed-precision JSON number formatting
+//
+// ArduinoJson's generic float serializer decomposes the value through
+// pow10 normalization in the widest configured float type, and inbound
+// parsing mirrors that cost. Telemetry values are small decimals where
+// only two or three fractional digits carry information, so this
+// wrapper scales the value with a single hardware-float multiply,
+// rounds to an integer and emits the digits with integer math only.
+// A field opts in through the ArduinoJson converter hook:
+//
+//   doc["temperature"] = FixedDecimal(27.314f);     // -> 27.31
+//   doc["confidence"]  = FixedDecimal(0.9173f, 3);  // -> 0.917
+//
+// The rendered text is copied into the document's string pool, so the
+// document needs a few bytes of extra capacity per wrapped field
+// (FixedDecimal::POOL_BYTES covers the worst case).
+
+#ifndef FIXED_DECIMAL_H
+#define FIXED_DECIMAL_H
+
+#include <ArduinoJson.h>
+#include <math.h>
+#include <stdint.h>
+
+struct FixedDecimal {
+  // Worst-case pool bytes one rendered field occupies ("-83886.08" + NUL)
+  static const size_t POOL_BYTES = 12;
+
+  explicit FixedDecimal(float value, uint8_t digits = 2)
+      : _value(value), _digits(digits < 3 ? digits : 3) {}
+
+  float _value;
+  uint8_t _digits;
+};
+
+inline void convertToJson(const FixedDecimal &src, JsonVariant dst) {
+  static const int32_t SCALE[4] = {1, 10, 100, 1000};
+  // The only floating-point step: one single-precision multiply and
+  // round, which the ESP32 FPU executes in hardware
+  const int32_t scaled = (int32_t)lroundf(src._value * (float)SCALE[src._digits]);
+
+  char buf[16];
+  char *p = buf + sizeof(buf);
+  *--p = '\0';
+  const bool negative = scaled < 0;
+  uint32_t mag = negative ? (uint32_t)(-scaled) : (uint32_t)scaled;
+  for (uint8_t i = 0; i < src._digits; i++) {
+    *--p = (char)('0' + (mag % 10U));
+    mag /= 10U;
+  }
+  if (src._digits) {
+    *--p = '.';
+  }
+  do {
+    *--p = (char)('0' + (mag % 10U));
+    mag /= 10U;
+  } while (mag);
+  if (negative) {
+    *--p = '-';
+  }
+  // serialized() emits the digits verbatim; the non-const char* makes
+  // ArduinoJson copy them into the document pool, buf is stack-local
+  dst.set(serialized(p));
+}
+
+#endif  // FIXED_DECIMAL_H
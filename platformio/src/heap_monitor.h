@@ -0,0 +1,80 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+// Fragmentation counters that must survive reboots and deep sleep. The
+// owner declares one instance with RTC_DATA_ATTR and hands it to
+// HeapMonitor::begin(); a power cycle clears RTC memory, which is fine
+// (a cold start resets the fragmentation history anyway).
+struct HeapPersistentStats {
+  uint32_t allocFailures;     // failed heap_caps allocations since power-up
+  uint32_t minLargestBlock;   // smallest "largest free block" ever seen, 0 = unset
+};
+
+// Tracks heap fragmentation, not just free size. After long uptimes the
+// String-heavy paths fragment the heap so that esp_get_free_heap_size()
+// looks healthy while a single camera-frame or String allocation fails;
+// the number that actually predicts that is the largest contiguous free
+// block, so that is what we sample, low-water-mark and alert on.
+class HeapMonitor {
+public:
+  void begin(HeapPersistentStats *persist) {
+    _persist = persist;
+    instanceRef() = this;
+    heap_caps_register_failed_alloc_callback(&HeapMonitor::onAllocFailed);
+  }
+
+  // Cheap enough to run every few seconds from a low-priority task
+  void sample() {
+    _freeBytes = esp_get_free_heap_size();
+    _largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    if (_persist &&
+        (_persist->minLargestBlock == 0 || _largestBlock < _persist->minLargestBlock)) {
+      _persist->minLargestBlock = _largestBlock;
+    }
+  }
+
+  uint32_t freeBytes() const { return _freeBytes; }
+  uint32_t largestBlock() const { return _largestBlock; }
+  uint32_t minLargestBlock() const { return _persist ? _persist->minLargestBlock : 0; }
+  uint32_t allocFailures() const { return _persist ? _persist->allocFailures : 0; }
+
+  bool belowFloor(uint32_t floorBytes) const { return _largestBlock < floorBytes; }
+
+  // One JSON telemetry object with the last sampled numbers:
+  //   {"heapFree":f,"heapLargest":l,"heapLargestMin":m,"heapAllocFail":n}
+  size_t serialize(char *buf, size_t cap) const {
+    size_t len = snprintf(buf, cap,
+        "{\"heapFree\":%lu,\"heapLargest\":%lu,\"heapLargestMin\":%lu,\"heapAllocFail\":%lu}",
+        (unsigned long)_freeBytes,
+        (unsigned long)_largestBlock,
+        (unsigned long)minLargestBlock(),
+        (unsigned long)allocFailures());
+    return len < cap ? len : cap - 1;
+  }
+
+private:
+  // The ESP-IDF callback has no user argument, so route it through a
+  // function-local static (header-only safe, unlike a static member)
+  static HeapMonitor *&instanceRef() {
+    static HeapMonitor *instance = NULL;
+    return instance;
+  }
+
+  // Runs in the failing task's context with the allocator lock held:
+  // just count, never allocate or log here
+  static void onAllocFailed(size_t size, uint32_t caps, const char *function) {
+    HeapMonitor *monitor = instanceRef();
+    if (monitor && monitor->_persist) {
+      monitor->_persist->allocFailures++;
+    }
+  }
+
+  HeapPersistentStats *_persist = NULL;
+  uint32_t _freeBytes = 0;
+  uint32_t _largestBlock = 0;
+};
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,116 @@
+#ifndef I2C_BUS_MANAGER_H
+#define I2C_BUS_MANAGER_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+// Transaction-queue manager for the shared I2C bus. The DHT20 and (when
+// NFC is enabled) the PN532 sit on the same two wires, and TwoWire has
+// no cross-task story: interleaved begin/endTransmission pairs corrupt
+// both transfers. Instead of spreading a mutex plus guess-the-delay
+// through every caller, tasks submit transfer descriptors to a queue
+// and a single bus task executes them back-to-back — the bus never
+// idles between queued transactions, and no client task ever blocks
+// another except for the microseconds its own transfer takes.
+//
+// Two descriptor flavors:
+//  - Raw transfer: address + optional write buffer + optional read
+//    buffer, executed right here with Wire calls.
+//  - run(arg): a callback executed on the bus task. This is for
+//    transactions owned by a vendored library (DHT20 keeps its raw
+//    bits private; PN532_I2C frames its own packets) — the library
+//    call itself becomes the descriptor, serialized with everything
+//    else on the bus.
+//
+// Completion: the submitter optionally attaches a semaphore, given
+// once the result field is written. Fire-and-forget submissions pass
+// NULL. runOnBus() wraps the common submit-and-wait pattern.
+class I2cBusManager {
+public:
+  static const int RESULT_PENDING = -127;
+  static const int RESULT_TIMEOUT = -128;
+
+  struct Transaction {
+    uint8_t address;           // ignored when run is set
+    const uint8_t *writeData;  // NULL = no write phase
+    uint8_t writeLen;
+    uint8_t *readData;         // NULL = no read phase
+    uint8_t readLen;
+    int (*run)(void *arg);     // library-owned transaction, or NULL
+    void *arg;
+    SemaphoreHandle_t done;    // optional completion signal
+    volatile int result;       // endTransmission code / bytes read / run()
+  };
+
+  void begin(UBaseType_t priority = 3, BaseType_t coreId = tskNO_AFFINITY,
+             size_t queueDepth = 8) {
+    _queue = xQueueCreate(queueDepth, sizeof(Transaction *));
+    xTaskCreatePinnedToCore(&I2cBusManager::busTask, "TaskI2CBus", 2048, this,
+                            priority, NULL, coreId);
+  }
+
+  // Queue a descriptor; the caller keeps it alive until completion.
+  // Returns false when the queue is full (caller retries or drops).
+  bool submit(Transaction *t) {
+    t->result = RESULT_PENDING;
+    return xQueueSend(_queue, &t, 0) == pdTRUE;
+  }
+
+  // Submit a library-owned transaction and block on its semaphore.
+  // done must belong to the calling task (one per client, reused).
+  int runOnBus(int (*fn)(void *), void *arg, SemaphoreHandle_t done,
+               uint32_t timeoutMs) {
+    Transaction t = {0, NULL, 0, NULL, 0, fn, arg, done, RESULT_PENDING};
+    if (!submit(&t)) return RESULT_TIMEOUT;
+    if (xSemaphoreTake(done, timeoutMs / portTICK_PERIOD_MS) != pdTRUE) {
+      // Bus task still owns the descriptor; waiting out the transfer
+      // here would leave a dangling pointer, so this is fatal enough
+      // to surface (the supervisor will catch a wedged bus task)
+      return RESULT_TIMEOUT;
+    }
+    return t.result;
+  }
+
+  uint32_t executed() const { return _executed; }
+
+private:
+  static void busTask(void *self) {
+    static_cast<I2cBusManager *>(self)->busLoop();
+  }
+
+  void busLoop() {
+    Transaction *t;
+    while (xQueueReceive(_queue, &t, portMAX_DELAY) == pdTRUE) {
+      if (t->run) {
+        t->result = t->run(t->arg);
+      } else {
+        int rc = 0;
+        if (t->writeData && t->writeLen) {
+          Wire.beginTransmission(t->address);
+          Wire.write(t->writeData, t->writeLen);
+          // Repeated start when a read follows, stop otherwise
+          rc = Wire.endTransmission(t->readData == NULL);
+        }
+        if (rc == 0 && t->readData && t->readLen) {
+          rc = Wire.requestFrom(t->address, t->readLen);
+          for (int i = 0; i < rc; i++) {
+            t->readData[i] = Wire.read();
+          }
+        }
+        t->result = rc;
+      }
+      _executed++;
+      if (t->done) {
+        xSemaphoreGive(t->done);
+      }
+    }
+  }
+
+  QueueHandle_t _queue = NULL;
+  uint32_t _executed = 0;
+};
+
+#endif // I2C_BUS_MANAGER_H
@@ -0,0 +1,129 @@
+#ifndef JSON_BUILDER_H
+#define JSON_BUILDER_H
+
+#include <Arduino.h>
+
+// Specialized serializer for fixed-shape telemetry documents. The
+// per-cycle publish writes the same keys every time, so building a DOM
+// and walking it through the generic ArduinoJson serializer repeats
+// work whose outcome never changes. Here the constant bytes are
+// precomputed: JSON_KEY_SEG pastes the quoted key and colon into one
+// string literal at compile time, the templated append() memcpys it
+// with a length the compiler knows statically, and only the values are
+// formatted — by a fixed-point integer writer, no printf machinery.
+//
+// A field's leading '{' or ',' is the single runtime branch, which is
+// what lets the delta publish path omit fields from the same shape.
+#define JSON_KEY_SEG(key) "\"" key "\":"
+
+class JsonBuilder {
+public:
+  JsonBuilder(char *out, size_t cap) : _out(out), _cap(cap) {}
+
+  // Fixed-point float field: value rounded to decimals places (0-3)
+  template <size_t N>
+  void field(const char (&seg)[N], float value, uint8_t decimals) {
+    openField(seg, N - 1);
+    appendFloat(value, decimals);
+  }
+
+  template <size_t N>
+  void field(const char (&seg)[N], uint32_t value) {
+    openField(seg, N - 1);
+    appendUint(value);
+  }
+
+  template <size_t N>
+  void field(const char (&seg)[N], int32_t value) {
+    openField(seg, N - 1);
+    if (value < 0) {
+      append('-');
+      appendUint((uint32_t)-value);
+    } else {
+      appendUint((uint32_t)value);
+    }
+  }
+
+  // Close the object and NUL-terminate. Returns the payload length,
+  // 0 when the buffer was too small (payload truncated => unusable).
+  size_t finish() {
+    if (_len == 0) {
+      append('{');  // no fields: still a valid empty object
+    }
+    append('}');
+    if (_overflow || _len >= _cap) {
+      if (_cap > 0) _out[0] = '\0';
+      return 0;
+    }
+    _out[_len] = '\0';
+    return _len;
+  }
+
+private:
+  void openField(const char *seg, size_t segLen) {
+    append(_len == 0 ? '{' : ',');
+    appendBytes(seg, segLen);
+  }
+
+  void append(char c) {
+    if (_len + 1 >= _cap) {
+      _overflow = true;
+      return;
+    }
+    _out[_len++] = c;
+  }
+
+  void appendBytes(const char *s, size_t n) {
+    if (_len + n + 1 >= _cap) {
+      _overflow = true;
+      return;
+    }
+    memcpy(&_out[_len], s, n);
+    _len += n;
+  }
+
+  void appendUint(uint32_t v) {
+    char digits[10];
+    size_t n = 0;
+    do {
+      digits[n++] = (char)('0' + v % 10);
+      v /= 10;
+    } while (v != 0);
+    while (n > 0) {
+      append(digits[--n]);
+    }
+  }
+
+  // Fixed-point: scale, round, emit integer and fraction digits.
+  // NaN/inf (a failed sensor read) serialize as 0 so the payload stays
+  // valid JSON.
+  void appendFloat(float value, uint8_t decimals) {
+    if (!(value == value) || value > 4.0e9f || value < -4.0e9f) {
+      append('0');
+      return;
+    }
+    if (value < 0) {
+      append('-');
+      value = -value;
+    }
+    static const uint32_t pow10[4] = {1, 10, 100, 1000};
+    const uint32_t scale = pow10[decimals > 3 ? 3 : decimals];
+    const uint32_t scaled = (uint32_t)(value * scale + 0.5f);
+    appendUint(scaled / scale);
+    if (scale > 1) {
+      append('.');
+      uint32_t frac = scaled % scale;
+      for (uint32_t d = scale / 10; d > 0; d /= 10) {
+        append((char)('0' + frac / d));
+        frac %= d;
+      }
+    }
+  }
+
+  char *_out;
+  size_t _cap;
+  size_t _len = 0;
+  bool _overflow = false;
+};
+
+#endif // JSON_BUILDER_H
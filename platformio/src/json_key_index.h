@@ -0,0 +1,82 @@
+#ifndef JSON_KEY_INDEX_H
+#define JSON_KEY_INDEX_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <string.h>
+
+// Hash-first key dispatch over a parsed JsonObject. ArduinoJson
+// resolves every containsKey()/operator[] by walking the object's node
+// list with strcmp, so a command parser probing k keys against an
+// n-member object does k*n string compares. This index walks the
+// object once, hashing each member key, and resolves probes by hash
+// compare - the strcmp runs only on a hash hit to confirm it. The
+// caller-side hashes come from the constexpr jsonKeyHash(), so a
+// literal like JSON_KEY("pump") is a compile-time constant and a miss
+// costs an integer compare per member instead of a strcmp.
+//
+// Worth it exactly where the request pattern is many-probes-per-parse
+// (the serial command dispatcher); a single probe is cheaper through
+// plain operator[].
+
+// FNV-1a, 32 bit. Recursive so it is constexpr under C++11.
+constexpr uint32_t jsonKeyHash(const char *key, uint32_t hash = 2166136261UL) {
+  return *key == '\0'
+             ? hash
+             : jsonKeyHash(key + 1,
+                           (hash ^ (uint32_t)(uint8_t)*key) * 16777619UL);
+}
+
+// Expands to the (hash, literal) argument pair the probes take; the
+// hash folds at compile time, the literal stays for the confirm
+#define JSON_KEY(literal) jsonKeyHash(literal), (literal)
+
+class JsonKeyIndex {
+public:
+  // Command and config objects are a handful of keys; an object larger
+  // than this falls back to ArduinoJson's own linear lookup
+  static const size_t MAX_KEYS = 16;
+
+  // One walk of the object, hashing each key. Costs what a single
+  // containsKey() miss costs, and makes every probe after it O(1)-ish.
+  void build(JsonObjectConst object) {
+    _object = object;
+    _count = 0;
+    _overflow = false;
+    for (JsonPairConst kv : object) {
+      if (_count >= MAX_KEYS) {
+        _overflow = true;
+        break;
+      }
+      _hashes[_count] = jsonKeyHash(kv.key().c_str());
+      _keys[_count] = kv.key().c_str();
+      _values[_count] = kv.value();
+      _count++;
+    }
+  }
+
+  // Probe with JSON_KEY("name"): null variant when absent
+  JsonVariantConst get(uint32_t hash, const char *key) const {
+    for (size_t i = 0; i < _count; i++) {
+      if (_hashes[i] == hash && strcmp(_keys[i], key) == 0) {
+        return _values[i];
+      }
+    }
+    // Members past MAX_KEYS were not indexed; let the library walk
+    return _overflow ? _object[key] : JsonVariantConst();
+  }
+
+  bool has(uint32_t hash, const char *key) const {
+    return !get(hash, key).isNull();
+  }
+
+private:
+  JsonObjectConst _object;
+  uint32_t _hashes[MAX_KEYS];
+  const char *_keys[MAX_KEYS];
+  JsonVariantConst _values[MAX_KEYS];
+  size_t _count = 0;
+  bool _overflow = false;
+};
+
+#endif // JSON_KEY_INDEX_H
@@ -0,0 +1,56 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <Arduino.h>
+
+// Log2-bucketed latency histogram for the sensor-read -> broker-ack
+// path. Recording is a clz and two increments, so it can sit directly
+// in the publish path; the whole state is a handful of counters that
+// are exported as periodic telemetry and queryable per device. Counters
+// are cumulative (never reset), so the backend can diff consecutive
+// exports to get per-interval distributions.
+class LatencyHistogram {
+public:
+  // Bucket i counts latencies in [2^i, 2^(i+1)) ms, bucket 0 is <2ms
+  // and the last bucket collects everything >= 32.8s
+  static const size_t BUCKETS = 16;
+
+  void record(uint32_t latencyMs) {
+    size_t bucket = 0;
+    while (bucket < BUCKETS - 1 && latencyMs >= (2UL << bucket)) {
+      bucket++;
+    }
+    _counts[bucket]++;
+    _count++;
+    if (latencyMs > _maxMs) {
+      _maxMs = latencyMs;
+    }
+  }
+
+  uint32_t count() const { return _count; }
+  uint32_t maxMs() const { return _maxMs; }
+
+  // Writes the histogram as one JSON telemetry object:
+  //   {"latCount":n,"latMaxMs":m,"latHist":"c0,c1,...,c15"}
+  // The bucket counts ride in one comma separated string, so the
+  // export costs one key-value pair instead of sixteen.
+  size_t serialize(char *buf, size_t cap) const {
+    size_t len = snprintf(buf, cap, "{\"latCount\":%lu,\"latMaxMs\":%lu,\"latHist\":\"",
+                          (unsigned long)_count, (unsigned long)_maxMs);
+    for (size_t i = 0; i < BUCKETS && len < cap; i++) {
+      len += snprintf(buf + len, cap - len, i == 0 ? "%lu" : ",%lu",
+                      (unsigned long)_counts[i]);
+    }
+    if (len < cap) {
+      len += snprintf(buf + len, cap - len, "\"}");
+    }
+    return len < cap ? len : cap - 1;
+  }
+
+private:
+  uint32_t _counts[BUCKETS] = {0};
+  uint32_t _count = 0;
+  uint32_t _maxMs = 0;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef LAZY_INIT_H
+#define LAZY_INIT_H
+
+#include <Arduino.h>
+
+// Constructor-on-first-use registry for cold subsystems.
+//
+// setup() used to bring up everything before the first sample — OTA
+// machinery, the NFC stack on stations that scan a few times a day —
+// serializing hundreds of milliseconds of cold-path bring-up in front
+// of time-to-first-telemetry. After the nightly AP reboot the whole
+// fleet re-associates at once, so every one of those milliseconds is
+// multiplied by the sector.
+//
+// Cold subsystems register a thunk here instead. The boot path only
+// records the registration (a table write); the first code path that
+// actually needs the subsystem calls ensure(), which runs the thunk
+// exactly once. A background warm job (one warmNext() per housekeeping
+// wakeup) initializes whatever remains shortly after boot, so the
+// first real use almost never pays the bring-up — it just happens
+// after telemetry is already flowing instead of before.
+//
+// ensure() is safe from any task: the slot state machine hands the
+// thunk to exactly one caller, and concurrent callers block (1ms
+// polls) until it finishes. Thunks therefore must not depend on the
+// caller's core or priority.
+class LazyInit {
+ public:
+  static const int MAX_SLOTS = 8;
+  typedef void (*InitFn)();
+
+  // Registration, typically from setup(). Cheap: no thunk runs here.
+  int add(const char *name, InitFn fn) {
+    if (_count >= MAX_SLOTS) {
+      return -1;
+    }
+    _slots[_count].name = name;
+    _slots[_count].fn = fn;
+    _slots[_count].state = PENDING;
+    _slots[_count].tookMs = 0;
+    return _count++;
+  }
+
+  // Run the slot's thunk if it has not run yet; returns once the
+  // subsystem is up regardless of which task won the race to run it.
+  void ensure(int slot) {
+    if (slot < 0 || slot >= _count) {
+      return;
+    }
+    Slot &s = _slots[slot];
+    while (true) {
+      portENTER_CRITICAL(&_mux);
+      if (s.state == DONE) {
+        portEXIT_CRITICAL(&_mux);
+        return;
+      }
+      if (s.state == PENDING) {
+        s.state = RUNNING;
+        portEXIT_CRITICAL(&_mux);
+        const uint32_t startMs = millis();
+        s.fn();
+        s.tookMs = millis() - startMs;
+        portENTER_CRITICAL(&_mux);
+        s.state = DONE;
+        portEXIT_CRITICAL(&_mux);
+        return;
+      }
+      // Another task is mid-thunk; wait it out off the spinlock
+      portEXIT_CRITICAL(&_mux);
+      vTaskDelay(pdMS_TO_TICKS(1));
+    }
+  }
+
+  bool done(int slot) const {
+    return slot >= 0 && slot < _count && _slots[slot].state == DONE;
+  }
+
+  // Background warm-up: bring up the next pending subsystem. One slot
+  // per call keeps each housekeeping pass short. Returns false once
+  // everything is up (the caller's job then costs a table scan).
+  bool warmNext() {
+    for (int i = 0; i < _count; i++) {
+      if (_slots[i].state == PENDING) {
+        ensure(i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // How long the slot's thunk took, for the boot log
+  uint32_t tookMs(int slot) const {
+    return slot >= 0 && slot < _count ? _slots[slot].tookMs : 0;
+  }
+  const char *name(int slot) const {
+    return slot >= 0 && slot < _count ? _slots[slot].name : "";
+  }
+
+ private:
+  enum State { PENDING, RUNNING, DONE };
+
+  struct Slot {
+    const char *name;
+    InitFn fn;
+    volatile State state;
+    uint32_t tookMs;
+  };
+
+  Slot _slots[MAX_SLOTS];
+  int _count = 0;
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#endif // LAZY_INIT_H
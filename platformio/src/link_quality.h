@@ -0,0 +1,152 @@
+#ifndef LINK_QUALITY_H
+#define LINK_QUALITY_H
+
+#include <Arduino.h>
+
+// Publish tiers, ordered from healthy to degraded. The numeric order
+// matters: "worse" comparisons below rely on GOOD < FAIR < POOR.
+enum LinkTier {
+  LINK_GOOD = 0,   // normal cadence, full payloads
+  LINK_FAIR,       // 2x interval, flush every 2nd pass, delta payloads
+  LINK_POOR,       // 4x interval, flush every 4th pass, delta payloads
+};
+
+// Adapts the publish schedule to the WiFi link instead of hammering a
+// weak AP at a fixed cadence. Nodes at the edge of coverage retransmit
+// constantly at the MAC layer; every application publish we add there
+// makes the congestion worse exactly when delivery is least likely.
+// The owner feeds this RSSI samples and per-publish TX outcomes; it
+// answers three questions each cycle: how long to sleep (interval
+// multiplier), whether this pass should transmit at all (flush gate,
+// so degraded links send rarer, back-to-back bursts instead of a
+// steady trickle), and whether payloads should go out in delta form.
+// On a healthy link every answer is the old behavior, so well-placed
+// nodes see no change at all.
+class LinkQualityScheduler {
+public:
+  // Thresholds from ESP32 field behavior: above -70dBm MAC retries are
+  // rare, below -80dBm the radio spends most of its airtime on them.
+  static const int16_t RSSI_FAIR_DBM = -70;
+  static const int16_t RSSI_POOR_DBM = -80;
+  // Consecutive confirming samples before the tier moves. Degrading is
+  // quick (3 cycles); recovering is slow (6) so a single lucky beacon
+  // does not bounce a node back to full cadence mid-outage.
+  static const uint8_t DEGRADE_SAMPLES = 3;
+  static const uint8_t RECOVER_SAMPLES = 6;
+
+  // One RSSI sample per connected pass. Classification uses an EWMA of
+  // the RSSI plus the recent TX failure rate, with the streak counters
+  // above as hysteresis, then moves the tier at most one step.
+  void sample(int rssiDbm) {
+    if (_haveRssi) {
+      _ewmaRssi += ((int16_t)rssiDbm - _ewmaRssi) / 4;
+    } else {
+      _ewmaRssi = (int16_t)rssiDbm;
+      _haveRssi = true;
+    }
+
+    uint8_t instant = LINK_GOOD;
+    const uint16_t attempts = _recentOk + _recentFail;
+    // >= 25% failures is POOR, >= 10% is FAIR (once we have a few
+    // attempts to judge by); RSSI alone can also force either tier
+    const bool lossy = attempts >= 4 && _recentFail * 4 >= attempts;
+    const bool shaky = attempts >= 4 && _recentFail * 10 >= attempts;
+    if (_ewmaRssi <= RSSI_POOR_DBM || lossy) {
+      instant = LINK_POOR;
+    } else if (_ewmaRssi <= RSSI_FAIR_DBM || shaky) {
+      instant = LINK_FAIR;
+    }
+
+    if (instant > _tier) {
+      _betterStreak = 0;
+      if (++_worseStreak >= DEGRADE_SAMPLES) {
+        _tier++;
+        _worseStreak = 0;
+      }
+    } else if (instant < _tier) {
+      _worseStreak = 0;
+      if (++_betterStreak >= RECOVER_SAMPLES) {
+        _tier--;
+        _betterStreak = 0;
+      }
+    } else {
+      _worseStreak = 0;
+      _betterStreak = 0;
+    }
+  }
+
+  // Per-publish outcome, fed from the common telemetry send path
+  void recordTx(bool ok) {
+    if (ok) { _recentOk++; _windowOk++; } else { _recentFail++; _windowFail++; }
+    // Decay so the failure rate reflects the last ~16 publishes, not
+    // a stale burst from an outage hours ago
+    if (_recentOk + _recentFail > 16) {
+      _recentOk /= 2;
+      _recentFail /= 2;
+    }
+  }
+
+  // A delta-mode publish that had nothing to say (all fields inside
+  // their deadbands); counted so the export shows what delta saved
+  void countDeltaSkip() { _deltaSkips++; }
+
+  LinkTier tier() const { return (LinkTier)_tier; }
+
+  // Multiply the configured cadence by this before sleeping
+  uint32_t intervalMultiplier() const {
+    return _tier == LINK_POOR ? 4 : (_tier == LINK_FAIR ? 2 : 1);
+  }
+
+  // Call once per connected pass: true when this pass should transmit.
+  // Degraded tiers gate to every 2nd/4th pass, so backlog and exports
+  // leave in one TCP burst per flush instead of touching the congested
+  // channel every cycle.
+  bool flushCycle() {
+    const uint8_t period = _tier == LINK_POOR ? 4 : (_tier == LINK_FAIR ? 2 : 1);
+    if (++_cycle >= period) {
+      _cycle = 0;
+      return true;
+    }
+    return false;
+  }
+
+  // Delta payloads (changed-fields-only) whenever the link is degraded
+  bool deltaMode() const { return _tier != LINK_GOOD; }
+
+  // Nothing worth reporting: healthy tier, no failures, no delta skips.
+  // Keeps the export parade silent for well-placed nodes.
+  bool quietWindow() const {
+    return _tier == LINK_GOOD && _windowFail == 0 && _deltaSkips == 0;
+  }
+
+  // One JSON telemetry object covering the window since the last call:
+  //   {"linkRssi":r,"linkTier":t,"txOk":o,"txFail":f,"deltaSkip":s}
+  // Resets the window counters so each report stands alone.
+  size_t serialize(char *buf, size_t cap) {
+    size_t len = snprintf(buf, cap,
+        "{\"linkRssi\":%d,\"linkTier\":%u,\"txOk\":%u,\"txFail\":%u,\"deltaSkip\":%u}",
+        (int)_ewmaRssi, (unsigned)_tier,
+        (unsigned)_windowOk, (unsigned)_windowFail, (unsigned)_deltaSkips);
+    _windowOk = 0;
+    _windowFail = 0;
+    _deltaSkips = 0;
+    return len < cap ? len : cap - 1;
+  }
+
+private:
+  int16_t _ewmaRssi = 0;
+  bool _haveRssi = false;
+  uint8_t _tier = LINK_GOOD;
+  uint8_t _worseStreak = 0;
+  uint8_t _betterStreak = 0;
+  uint8_t _cycle = 0;
+  // Decayed counts for classification (last ~16 publishes)
+  uint16_t _recentOk = 0;
+  uint16_t _recentFail = 0;
+  // Window counts for the periodic export
+  uint16_t _windowOk = 0;
+  uint16_t _windowFail = 0;
+  uint16_t _deltaSkips = 0;
+};
+
+#endif // LINK_QUALITY_H
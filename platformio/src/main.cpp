@@ -6,13 +6,142 @@
 #define PUMP_MOTOR 18  // D9 trên board của bạn là GPIO18
 #define FAN_MOTOR 10
 
+// Set to 1 for battery-powered sectors: sample -> publish -> deep sleep
+// instead of the always-on FreeRTOS task set. State lives in RTC slow
+// memory so a wake cycle skips most reinitialization.
+#define LOW_POWER_MODE 0
+#define LOW_POWER_SLEEP_S 60
+
+// Set to 1 to publish telemetry as 20-byte packed binary frames
+// (telemetry_frame.h) instead of JSON. Needs the ingestion side decoding
+// TELEMETRY_FRAME_TOPIC with back/telemetry_frame.py.
+#define TELEMETRY_BINARY_FRAMES 0
+#define TELEMETRY_DEVICE_ID 1
+
+// Set to 1 to seal every JSON telemetry payload with AES-128-CTR on the
+// ESP32 hardware AES engine before it reaches the MQTT client
+// (payload_crypto.h: per-device key in NVS, 8-byte nonce header, sealed
+// bytes published to TELEMETRY_SEALED_TOPIC). Needs the ingestion side
+// holding the device key. A node without a provisioned key keeps
+// publishing plaintext regardless of the flag, so a fleet rolls over
+// node by node as the field tool writes keys.
+#define ENCRYPT_TELEMETRY 0
+#define TELEMETRY_SEALED_TOPIC "v1/devices/me/telemetry/sealed"
+
+// Set to 1 (build env esp_mqtt) to run MQTT on the native esp-mqtt
+// component instead of the polling PubSubClient: receive is dispatched
+// event-driven from its own task, publishes can be enqueued into an
+// internal outbox with retransmission, and the extra Arduino buffer
+// copy disappears.
+#ifndef USE_ESP_MQTT_CLIENT
+#define USE_ESP_MQTT_CLIENT 0
+#endif
+
+// Set to 1 to run a second, minimal MQTT session dedicated to the
+// control plane: the RPC subscription and alert publishes get their
+// own socket with a small fixed buffer, so a retransmitting bulk
+// transfer (telemetry burst, OTA chunk) can never head-of-line block
+// an actuator command inside the shared TCP connection. Costs one
+// extra socket and ~1KB; PubSubClient builds only (esp-mqtt owns its
+// transport and multiplexes internally).
+#ifndef DUAL_SESSION_MQTT
+#define DUAL_SESSION_MQTT 0
+#endif
+
+// Set to 1 on access-control nodes with the PN532 reader attached.
+// The reader runs on its own SPI link (multi-MHz, DMA-capable) instead
+// of sharing the sensor I2C wires: frames move an order of magnitude
+// faster and NFC traffic never queues behind the DHT20 in the bus
+// manager. Adjust the chip select pin to the board wiring.
+#ifndef NFC_READER_SPI
+#define NFC_READER_SPI 0
+#endif
+#ifndef NFC_SPI_SS_PIN
+#define NFC_SPI_SS_PIN 21
+#endif
+
+// Dense-bench nodes: number of DHT20 probes behind a TCA9548A mux
+// (dht20_mux.h). 0 keeps the stock single-probe wiring; with a mux the
+// climate window triggers every probe back to back and reads them all
+// after one shared conversion wait, so the array costs channel-select
+// overhead, not a conversion per probe. The snapshot carries the array
+// mean; per-probe values ride a periodic diagnostic payload.
+#ifndef DHT20_MUX_CHANNELS
+#define DHT20_MUX_CHANNELS 0
+#endif
+#ifndef DHT20_MUX_ADDR
+#define DHT20_MUX_ADDR 0x70
+#endif
+
+// Device profiles: one source file, per-role binaries. The PlatformIO
+// environment picks the role (sensor_node, pump_controller, nfc_station
+// in platformio.ini) and the gates decide at compile time which tasks,
+// pins and libraries end up in the image — a sensor-only node carries no
+// pump/fan control loop, no actuator GPIO setup and no NFC stack in
+// flash or RAM. The Arduino core builds gnu++11, so these are
+// preprocessor gates rather than if constexpr; together with the
+// default --gc-sections link the ungated library code a role never
+// references is dropped from its binary.
+#ifndef PROFILE_HAS_CONTROL
+#define PROFILE_HAS_CONTROL 1
+#endif
+
 #include <WiFi.h>
+#if USE_ESP_MQTT_CLIENT
+#include <Espressif_MQTT_Client.h>
+#else
 #include <Arduino_MQTT_Client.h>
+#endif
 #include <ThingsBoard.h>
 #include "DHT20.h"
 #include "Wire.h"
 #include <ArduinoOTA.h>
 #include <ArduinoJson.h>
+#include "telemetry_buffer.h"
+#include "telemetry_keys.h"
+#include "adc_sampler.h"
+#include "wifi_fast_connect.h"
+#include "wifi_roam.h"
+#include "async_logger.h"
+#include "debug.h"
+#include "latency_histogram.h"
+#include "heap_monitor.h"
+#include "energy_monitor.h"
+#include "runtime_config.h"
+#include "actuator_queue.h"
+#include "actuator_journal.h"
+#include "nvs_journal.h"
+#include "serial_protocol.h"
+#include "link_quality.h"
+#include "publish_budget.h"
+#include "telemetry_frame.h"
+#include "task_supervisor.h"
+#include "warm_boot.h"
+#include "power_manager.h"
+#include "i2c_bus_manager.h"
+#include "sensor_calibration.h"
+#include "sample_scheduler.h"
+#include "json_builder.h"
+#include "payload_crypto.h"
+#include "moisture_model.h"
+#include "threshold_rules.h"
+#include "crash_report.h"
+#include "json_key_index.h"
+#include "backpressure.h"
+#include "window_stats.h"
+#include "sampling_profiler.h"
+#include "burst_capture.h"
+#include "payload_codec.h"
+#if DHT20_MUX_CHANNELS > 0
+#include "dht20_mux.h"
+#endif
+#include "event_scheduler.h"
+#include "lazy_init.h"
+#if NFC_READER_SPI
+#include <SPI.h>
+#include <PN532_SPI.h>
+#include <PN532.h>
+#endif
 
 constexpr char WIFI_SSID[] = "P4.11";
 constexpr char WIFI_PASSWORD[] = "123456788";
@@ -22,9 +151,29 @@ constexpr char WIFI_PASSWORD[] = "123456788";
 // constexpr char THINGSBOARD_SERVER[] = "app.coreiot.io";
 // constexpr uint16_t THINGSBOARD_PORT = 1883U;
 
-constexpr uint32_t MAX_MESSAGE_SIZE = 1024U;
+#if DUAL_SESSION_MQTT
+// The control session authenticates like the bulk one; a distinct
+// client id keeps the broker from kicking one session for the other
+constexpr char CONTROL_TOKEN[] = "ttrv0asoe3tln5zqjswc";
+constexpr char CONTROL_SERVER[] = "app.coreiot.io";
+constexpr uint16_t CONTROL_PORT = 1883U;
+#endif
+
+// Elastic MQTT receive buffer (PubSubClient::setBufferElastic): idles
+// at the floor, which covers every routine inbound message (RPCs,
+// shared attribute dumps), and grows on demand up to the ceiling when
+// a bigger remaining length is announced — sized for a 4KB OTA chunk
+// plus headers. The old fixed 1024U reserved the worst case forever.
+constexpr uint16_t MQTT_BUFFER_FLOOR = 512U;
+constexpr uint16_t MQTT_BUFFER_CEILING = 4608U;
 constexpr uint32_t SERIAL_DEBUG_BAUD = 115200U;
 
+// Core placement: the WiFi/LwIP stack is pinned to core 0 by the IDF,
+// so the network-facing tasks join it there and the sensing/control
+// plane gets core 1 to itself
+constexpr BaseType_t CORE_NET = 0;
+constexpr BaseType_t CORE_SENSE = 1;
+
 constexpr char BLINKING_INTERVAL_ATTR[] = "blinkingInterval";
 constexpr char LED_MODE_ATTR[] = "ledMode";
 constexpr char LED_STATE_ATTR[] = "ledState";
@@ -42,22 +191,299 @@ uint32_t previousStateChange;
 constexpr int16_t telemetrySendInterval = 10000U;
 uint32_t previousDataSend;
 
-constexpr std::array<const char *, 2U> SHARED_ATTRIBUTES_LIST = {
+constexpr std::array<const char *, 13U + (PROFILE_HAS_CONTROL ? 4U : 0U)> SHARED_ATTRIBUTES_LIST = {
   LED_STATE_ATTR,
-  BLINKING_INTERVAL_ATTR
+  BLINKING_INTERVAL_ATTR,
+  // Runtime config keys: updates land in processSharedAttributes and
+  // are validated/persisted/applied by RuntimeConfig
+  "telemetryMs",
+  // Per-sector alert thresholds (threshold_rules.h, same order as its
+  // Rule enum); the server pushes each sector's row from the threshold
+  // table as shared attributes
+  "alertTempLoC",
+  "alertTempHiC",
+  "alertHumLoPct",
+  "alertHumHiPct",
+  "alertLightLoLx",
+  "alertLightHiLx",
+  "alertMoistLoPct",
+  "alertMoistHiPct",
+  // OTA wave campaign (see otaWindowOpen): the backend's otawave tool
+  // broadcasts which cohort may update right now
+  "otaWaveOpen",
+  "otaWaveCount",
+#if PROFILE_HAS_CONTROL
+  "pumpOnPct",
+  "pumpOffPct",
+  "fanOnC",
+  "fanOffC",
+#endif
 };
 
+#if USE_ESP_MQTT_CLIENT
+// esp-mqtt owns its transport internally (no WiFiClient layer) and
+// dispatches receive callbacks from its own event task
+Espressif_MQTT_Client mqttClient;
+#else
 WiFiClient wifiClient;
 Arduino_MQTT_Client mqttClient(wifiClient);
-ThingsBoard tb(mqttClient, MAX_MESSAGE_SIZE);
+#endif
+ThingsBoard tb(mqttClient, MQTT_BUFFER_FLOOR);
+
+#if DUAL_SESSION_MQTT && !USE_ESP_MQTT_CLIENT
+// Control-plane session: own socket, small fixed buffer (RPCs and
+// alert payloads are tiny). The RPC subscription moves here, so an
+// actuator command never waits behind bulk telemetry retransmits in
+// the shared connection (see controlSessionJob).
+WiFiClient controlWifiClient;
+Arduino_MQTT_Client controlMqttClient(controlWifiClient);
+ThingsBoard tbControl(controlMqttClient, 256U);
+#endif
 
 DHT20 dht20;
+#if DHT20_MUX_CHANNELS > 0
+// The probe array behind the TCA9548A; dht20 above stays the begin()
+// and offset-carrying instance for the warm-boot paths
+Dht20Mux dht20Mux(&Wire, DHT20_MUX_ADDR);
+#endif
+
+// All runtime bus traffic goes through the transaction queue; with NFC
+// enabled the PN532 shares the wires, and interleaved Wire calls from
+// two tasks corrupt both transfers
+I2cBusManager i2cBus;
+
+#if NFC_READER_SPI
+// Reader on the dedicated SPI link; the I2C bus manager is not involved
+PN532_SPI pn532spi(SPI, NFC_SPI_SS_PIN);
+PN532 nfc(pn532spi);
+#endif
+
+// Placement policy for the big long-lived buffers: bulk to PSRAM when
+// the board has it, DMA-capable internal RAM left for the peripherals
+MemPools memPools;
+// Buffers telemetry while WiFi is down, drains in batches on reconnect
+TelemetryBuffer telemetryBuffer;
+TelemetryKeyTable telemetryKeyTable;
+// Sensor-read -> broker-ack latency distribution, exported periodically
+LatencyHistogram publishLatency;
+
+// Fragmentation watch: free size alone lies after weeks of uptime, the
+// largest contiguous block is what String/frame allocations actually need.
+// Counters live in RTC memory so a watchdog reboot does not erase them.
+RTC_DATA_ATTR HeapPersistentStats heapPersistentStats = {0, 0};
+HeapMonitor heapMonitor;
+constexpr uint32_t HEAP_LARGEST_BLOCK_FLOOR = 16U * 1024U;
+
+// Per-subsystem charge ledger (radio / DHT20 / ADC / CPU busy time at
+// calibrated per-state currents), exported once a day so battery-life
+// work targets the subsystem that actually drains the pack
+EnergyMonitor energyMonitor;
+
+// Tickless idle + DFS (80-240MHz): the idle task light-sleeps between
+// task deadlines, publish bursts race to idle at full clock and the
+// actuator apply path is exempt from light-sleep wakeup latency
+PowerManager powerManager;
+
+// NVS-backed runtime parameters, updatable live via shared attributes
+// or the serial command channel ({"cfg":{...}}). One image serves all
+// deployments; per-site tuning lives in NVS instead of in variants.
+RuntimeConfig runtimeConfig;
+int cfgTelemetryMs = -1;
+int cfgPublishPerMin = -1;
+// OTA wave campaign state (see otaWindowOpen)
+int cfgOtaWaveOpen = -1;
+int cfgOtaWaveCount = -1;
+// One RuntimeConfig slot per alert rule, indexed by ThresholdRules::Rule
+int cfgAlertSlot[ThresholdRules::RULE_COUNT];
+#if PROFILE_HAS_CONTROL
+int cfgPumpOnPct = -1;
+int cfgPumpOffPct = -1;
+int cfgFanOnC = -1;
+int cfgFanOffC = -1;
+#endif
+// Active WiFi credentials: the NVS override when provisioned, the
+// compiled defaults otherwise
+char wifiSsid[33];
+char wifiPass[65];
+
+// All pump/fan/LED commands funnel through this prioritized queue to
+// one consumer task (taskActuator), which owns the GPIO writes. Serial,
+// RPC and the control loop submit into their tiers; a safety stop is
+// dequeued before anything else, always.
+ActuatorQueue actuatorQueue;
+
+// NVS journal of the actuator outputs: restored first thing in setup()
+// so a brownout mid irrigation cycle resumes pumping at power-on
+ActuatorJournal actuatorJournal;
+
+// Write-behind staging for all grouped NVS writes (nvs_journal.h):
+// writers stage, the nvsFlush housekeeping job commits, and the flash
+// stalls land on the housekeeping worker instead of the control or
+// sampling tasks. Not attached on the low-power path — a duty cycle
+// has no housekeeping worker, so its few writes stay synchronous.
+NvsJournal nvsJournal;
+
+#if PROFILE_HAS_CONTROL
+// A pump cycle resumed with the auto loop disabled may not run
+// unbounded while nobody is watching: the remaining budget (cap minus
+// the journaled run time) is enforced by taskControl. 0 = no cap armed.
+constexpr uint32_t PUMP_RESUME_CAP_MS = 10UL * 60UL * 1000UL;
+volatile uint32_t pumpResumeDeadlineMs = 0;
+#endif
+
+// Adapts publish cadence/batching/payload size to WiFi link quality,
+// so edge-of-coverage nodes stop fighting their own MAC retransmits.
+// Healthy nodes classify GOOD and keep the exact old behavior.
+LinkQualityScheduler linkScheduler;
+
+// Token bucket over the publish path, sized to the CoreIoT per-device
+// message quota. The drain loop spends a token per record and merges
+// what it cannot afford, so a reconnect burst stays inside quota
+// instead of tripping broker-side throttling.
+PublishBudget publishBudget;
+
+// Fuses ring fill and publish failures into the pressure level the
+// sampling loop stretches on (backpressure.h)
+Backpressure backpressure;
+
+// Min/max/mean per field over each publish window, so transients that
+// fit between publishes still reach the backend (window_stats.h)
+WindowStats windowStats;
+
+// On-demand CPU profiler, armed over the "profile" RPC; zero cost while
+// idle (sampling_profiler.h)
+SamplingProfiler samplingProfiler;
+
+// On-demand high-rate ADC capture, armed over the "burst" RPC; the
+// ring exists only for the window and its upload (burst_capture.h)
+BurstCapture burstCapture;
+
+#if ENCRYPT_TELEMETRY
+// Hardware-AES sealing of serialized payloads (see the flag above)
+PayloadCrypto payloadCrypto;
+#endif
+
+// Cold subsystems come up on first use (or via the background warm
+// job) instead of in setup(), so time-to-first-telemetry after the
+// nightly AP reboot does not pay for machinery the node may not touch
+// for hours (lazy_init.h)
+LazyInit lazyInit;
+#if NFC_READER_SPI
+int lazyNfcSlot = -1;
+#endif
+#if ENCRYPT_TELEMETRY
+int lazyCryptoSlot = -1;
+#endif
+
+// Deadline supervisor over the sensing/serial/control tasks; per-task
+// worst-case latencies and stall counts ride out reboots in RTC memory
+RTC_DATA_ATTR TaskHealthPersistentStats taskHealthStats = {};
+TaskSupervisor taskSupervisor;
+constexpr uint32_t TASK_WDT_TIMEOUT_S = 30U;
+int supDht20Slot = -1;
+int supSerialSlot = -1;
+#if PROFILE_HAS_CONTROL
+int supControlSlot = -1;
+#endif
+
+// DMA-driven ADC sampling for light/moisture (oversampled + averaged)
+AdcSampler adcSampler;
+
+// Bench-measured calibration anchors, expanded into fixed-point lookup
+// tables at compile time (see sensor_calibration.h). Moisture outputs
+// centi-percent (capacitive probe reads high when dry), light outputs
+// lux from the LDR divider profile. NVS can override per node.
+constexpr CalPoint MOISTURE_CAL_POINTS[] = {
+  {0, 10000}, {1200, 10000}, {2000, 6000}, {2600, 3000}, {3100, 0}, {4095, 0},
+};
+constexpr CalPoint LIGHT_CAL_POINTS[] = {
+  {0, 0}, {500, 50}, {1500, 400}, {2500, 1500}, {3500, 6000}, {4095, 10000},
+};
+constexpr int32_t MOISTURE_DEFAULT_LUT[SensorCalibration::LUT_SIZE] =
+    CAL_CURVE_17(MOISTURE_CAL_POINTS, 6);
+constexpr int32_t LIGHT_DEFAULT_LUT[SensorCalibration::LUT_SIZE] =
+    CAL_CURVE_17(LIGHT_CAL_POINTS, 6);
+SensorCalibration moistureCal;
+SensorCalibration lightCal;
+
+// Per-field sample rates: light transients are worth catching at 4Hz,
+// the climate pair moves over seconds, soil moisture over minutes.
+// Each channel's EMA and deadband match its own noise floor.
+constexpr uint32_t CLIMATE_SAMPLE_MS = 2000;
+constexpr uint32_t LIGHT_SAMPLE_MS = 250;
+constexpr uint32_t MOISTURE_SAMPLE_MS = 15000;
+SampleScheduler sampleScheduler;
+ChannelFilter tempFilter(0.3f, 0.1f);     // degC
+ChannelFilter humFilter(0.3f, 0.5f);      // %RH
+ChannelFilter lightFilter(0.5f, 5.0f);    // lux, light alpha: keep transients
+ChannelFilter moistureFilter(0.2f, 0.5f); // %
+
+// Hot tasks enqueue here; taskLogDrain owns the UART
+AsyncLogger logger;
+
+// Boot profiler: microsecond timestamps per init stage, reported once on
+// the first telemetry publish so we can see where cold boot time goes.
+struct BootProfiler {
+    static const size_t MAX_STAGES = 8;
+    const char *names[MAX_STAGES];
+    int64_t doneUs[MAX_STAGES];
+    size_t count = 0;
+    bool reported = false;
+
+    void mark(const char *name) {
+        if (count < MAX_STAGES) {
+            names[count] = name;
+            doneUs[count] = esp_timer_get_time();
+            count++;
+        }
+    }
+};
+BootProfiler bootProfiler;
+
+void taskLogDrain(void *parameter) {
+    logger.drainTask();
+}
 
 
 const double long_HCMUT = 106.65789107082472;
 const double lat_HCMUT = 10.772175109674038;
-float temperature = 0.0f, humidity = 0.0f;
-float light = 0.0f, moisture = 0.0f;
+
+// One consistent set of readings. Published by taskDHT20 through a seqlock
+// so readers never see a torn sample set (e.g. new temperature paired with
+// old humidity) without any mutex or priority inversion between tasks.
+struct alignas(32) SensorSnapshot {
+    float temperature;
+    float humidity;
+    float light;
+    float moisture;
+    uint32_t acquiredMs;  // millis() at acquisition, start of the latency clock
+};
+
+static SensorSnapshot sensorSnapshot = {0.0f, 0.0f, 0.0f, 0.0f, 0};
+// Even = stable, odd = writer in progress
+static volatile uint32_t sensorSeq = 0;
+
+// Writer side (single writer: taskDHT20 only)
+void publishSensorSnapshot(const SensorSnapshot &s) {
+    sensorSeq++;                      // odd: readers retry
+    __asm__ __volatile__("" ::: "memory");
+    sensorSnapshot = s;
+    __asm__ __volatile__("" ::: "memory");
+    sensorSeq++;                      // even again: snapshot valid
+}
+
+// Reader side: retries until it observes a stable (even, unchanged) sequence
+SensorSnapshot readSensorSnapshot() {
+    SensorSnapshot s;
+    uint32_t seq;
+    do {
+        seq = sensorSeq;
+        __asm__ __volatile__("" ::: "memory");
+        s = sensorSnapshot;
+        __asm__ __volatile__("" ::: "memory");
+    } while ((seq & 1U) || seq != sensorSeq);
+    return s;
+}
 
 // Forward declaration tasks
 void taskThingsBoard(void *parameter);
@@ -66,32 +492,191 @@ void taskDHT20(void *parameter);
 void taskSerial(void *parameter);
 // void taskPrintVersion(void *parameter);
 void taskSerialCommand(void *parameter);
+#if PROFILE_HAS_CONTROL
+void taskControl(void *parameter);
+#endif
+void taskSupervisorLoop(void *parameter);
+void taskActuator(void *parameter);
+static bool publishBufferedRecord(const TelemetryRecord &rec);
+
+// Net-core housekeeping jobs (event_scheduler.h): the OTA listener
+// poll and the heap watcher used to be delay-loop tasks; as scheduler
+// jobs they share one worker stack and the 10s heap job rides every
+// 20th wakeup of the 500ms OTA poll instead of adding its own.
+EventScheduler netHousekeeping;
+static void otaPollJob();
+static void heapMonitorJob();
+static void profileFlushJob();
+static void burstFlushJob();
+static void lazyWarmJob();
+#if DUAL_SESSION_MQTT && !USE_ESP_MQTT_CLIENT
+static void controlSessionJob();
+#endif
+
+// Recovery hook for a stalled TaskDHT20: by far the most likely wedge is
+// a DHT20 transaction left half-done holding SDA low. The standard bus
+// clear — clock SCL until the slave releases the data line — unsticks it
+// without touching any other peripheral, then the restarted task's
+// requestData() starts from a clean bus. The ESP32 I2C driver times out
+// a wedged transaction on its own, so the bus task is back in its queue
+// loop by the time the stalled client's deadline expires and this runs.
+static void recoverI2cBus() {
+    Wire.end();
+    pinMode(SCL_PIN, OUTPUT_OPEN_DRAIN);
+    pinMode(SDA_PIN, INPUT_PULLUP);
+    for (int i = 0; i < 9 && digitalRead(SDA_PIN) == LOW; i++) {
+        digitalWrite(SCL_PIN, LOW);
+        delayMicroseconds(5);
+        digitalWrite(SCL_PIN, HIGH);
+        delayMicroseconds(5);
+    }
+    Wire.begin(SDA_PIN, SCL_PIN);
+}
+
+#if PROFILE_HAS_CONTROL
+// Local closed-loop control state. The hysteresis thresholds live in
+// RuntimeConfig (pumpOnPct/pumpOffPct/fanOnC/fanOffC) so sites can
+// retune the setpoints without a reflash; actuation still happens
+// on-device in milliseconds instead of waiting on a cloud round trip.
+// Serial/cloud commands can take over by disabling the local loop.
+volatile bool autoControlEnabled = true;
+volatile bool pumpState = false;
+volatile bool fanState = false;
+
+// Distilled irrigation forecast (see moisture_model.h): predicts the
+// next-interval soil moisture on-device, so the pump can start before a
+// drying trend crosses the threshold instead of seconds later via the
+// cloud - and keeps deciding with the uplink down.
+MoistureModel moistureModel;
+#endif // PROFILE_HAS_CONTROL
+
+// Per-sector alert rules (threshold_rules.h), evaluated against every
+// snapshot the sampling task produces so a crossing is detected within
+// one sample period instead of after the server-side table scan
+ThresholdRules thresholdRules;
 
 // Khai báo TaskHandle_t
 TaskHandle_t taskDHT20Handle = NULL;
 TaskHandle_t taskSendTelemetryHandle = NULL;
 TaskHandle_t taskLightHandle = NULL;
 TaskHandle_t taskSerialHandle = NULL;
+TaskHandle_t taskSerialCommandHandle = NULL;
+#if PROFILE_HAS_CONTROL
+TaskHandle_t taskControlHandle = NULL;
+#endif
+
+// Receive-event hook for the command channel. Serial is USB-CDC on this
+// board (ARDUINO_USB_CDC_ON_BOOT=1), so the IDF UART event queue does
+// not apply; the core's onReceive callback fires from the CDC driver
+// when bytes arrive and just pokes the command task awake. The task
+// itself does all reading/parsing, the hook stays minimal.
+static void onSerialCommandData() {
+    if (taskSerialCommandHandle != NULL) {
+        xTaskNotifyGive(taskSerialCommandHandle);
+    }
+}
 
 
 RPC_Response setLedSwitchState(const RPC_Data &data) {
-    Serial.println("Received Switch state");
+    // MQTT callback context: enqueue instead of blocking on the UART,
+    // and actuate through the queue's remote tier instead of touching
+    // the GPIO from a network callback
     bool newState = data;
-    Serial.print("Switch state change: ");
-    Serial.println(newState);
-    digitalWrite(LED_PIN, newState);
-    ledState = newState;
+    LOG_INFO("[TB] Switch state change: %d", (int)newState);
+    actuatorQueue.submit(ACT_LED, newState, ACT_PRIO_REMOTE);
     attributesChanged = true;
     return RPC_Response("setValue", newState);
 }
 
-const std::array<RPC_Callback, 1U> callbacks = {
-  RPC_Callback{ "setValue", setLedSwitchState }
+RPC_Response startProfile(const RPC_Data &data) {
+    // MQTT callback context again: just arm the session, the timer ISR
+    // does the sampling and the housekeeping worker publishes the
+    // report when it elapses (profileFlushJob)
+    uint32_t seconds = data;
+    const bool armed = samplingProfiler.start(seconds);
+    LOG_INFO("[PROF] %s (%lus requested)",
+             armed ? "session armed" : "busy, request ignored",
+             (unsigned long)seconds);
+    return RPC_Response("profile", armed);
+}
+
+// Raw DMA results stream through here for the duration of a capture
+// window; capture() drops everything outside one
+static void burstAdcTap(uint8_t channel, uint16_t value) {
+    burstCapture.capture(channel, value);
+}
+
+// The pump task's drain step: one non-blocking pass over the DMA ring,
+// with the tap above routing the raw results into the burst ring
+static void burstPump() {
+    adcSampler.poll();
+}
+
+RPC_Response startBurst(const RPC_Data &data) {
+    // Same shape as the profile RPC: arm here, sample from the pump
+    // task on the sense core, upload from the housekeeping worker
+    // (burstFlushJob). No DMA means nothing to capture.
+    uint32_t seconds = data;
+    bool armed = false;
+    if (adcSampler.ready()) {
+        adcSampler.setTap(burstAdcTap);
+        armed = burstCapture.start(seconds, AdcSampler::SAMPLE_FREQ_HZ,
+                                   burstPump, CORE_SENSE);
+        if (!armed) {
+            adcSampler.setTap(NULL);
+        }
+    }
+    LOG_INFO("[BURST] %s (%lus requested)",
+             armed ? "capture window armed" : "busy or no DMA, ignored",
+             (unsigned long)seconds);
+    return RPC_Response("burst", armed);
+}
+
+const std::array<RPC_Callback, 3U> callbacks = {
+  RPC_Callback{ "setValue", setLedSwitchState },
+  RPC_Callback{ "profile", startProfile },
+  RPC_Callback{ "burst", startBurst }
 };
 
+#if DUAL_SESSION_MQTT && !USE_ESP_MQTT_CLIENT
+// Keeps the control-plane session alive on the housekeeping grid:
+// async (re)connect, the RPC subscription once per session, and the
+// poll that delivers inbound RPCs. The 500ms grid bounds the added
+// command latency; the point is that nothing here shares a socket
+// with bulk transfers, so that bound holds under any telemetry load.
+static void controlSessionJob() {
+    static bool rpcSubscribed = false;
+    PubSubClient &session = controlMqttClient.get_client();
+    if (WiFi.status() != WL_CONNECTED) {
+        rpcSubscribed = false;
+        return;
+    }
+    if (!session.connected() && !session.connecting()) {
+        rpcSubscribed = false;
+        session.connectAsync("farm-node-ctl", CONTROL_TOKEN, NULL);
+    }
+    // Consumes the CONNACK while connecting, dispatches RPCs once up
+    tbControl.loop();
+    if (session.connected() && !rpcSubscribed) {
+        rpcSubscribed = tbControl.RPC_Subscribe(callbacks.cbegin(), callbacks.cend());
+        if (rpcSubscribed) {
+            LOG_INFO("[TB] control session up, RPC subscription moved to it");
+        }
+    }
+}
+#endif
+
 void processSharedAttributes(const JsonObjectConst &data) {
     Serial.println("[TB] Received shared attributes:");
     for (auto it = data.begin(); it != data.end(); ++it) {
+        // Keys matching a registered runtime parameter are validated,
+        // persisted to NVS and applied live; the rest just get printed
+        if (it->value().is<float>() &&
+            runtimeConfig.set(it->key().c_str(), it->value().as<float>())) {
+            Serial.printf("  Config %s = %.2f (applied)\n",
+                          it->key().c_str(), it->value().as<float>());
+            continue;
+        }
         Serial.printf("  Key: %s, Value: ", it->key().c_str());
         if (it->value().is<const char*>()) Serial.println(it->value().as<const char*>());
         else if (it->value().is<int>()) Serial.println(it->value().as<int>());
@@ -106,131 +691,1631 @@ void processSharedAttributes(const JsonObjectConst &data) {
 const Shared_Attribute_Callback attributes_callback(&processSharedAttributes, SHARED_ATTRIBUTES_LIST.cbegin(), SHARED_ATTRIBUTES_LIST.cend());
 const Attribute_Request_Callback attribute_shared_request_callback(&processSharedAttributes, SHARED_ATTRIBUTES_LIST.cbegin(), SHARED_ATTRIBUTES_LIST.cend());
 
+// Caches BSSID/channel/lease in NVS for sub-second re-association
+WiFiFastConnect wifiFastConnect;
+
+// Hands moving nodes off to the next farm AP before the link drops
+// (background scan while degrading, targeted reassociation)
+WiFiRoam wifiRoam;
+
+// Carried across the OTA partition switch in RTC memory, so the new
+// image boots with the old image's sensor picture and calibration
+// instead of a cold re-initialization (see initOtaUpdate)
+RTC_DATA_ATTR WarmBootState warmBootState = {};
+WarmBoot warmBoot;
+// Previous boot's Guru Meditation, skimmed from the coredump partition
+// and published on the first connected telemetry cycle
+CrashReport crashReport;
+// Set once the GOT_IP event has started the OTA listener
+static volatile bool otaListenerUp = false;
+
+// Registers every runtime parameter with its default and valid range,
+// overlays the NVS persisted values and loads the active credentials.
+// Called from both boot paths (setup and the low-power cycle) before
+// anything reads a knob.
+static void initRuntimeConfig() {
+  cfgTelemetryMs = runtimeConfig.add("telemetryMs", 2000, 500, 60000, &taskSerialHandle);
+  // Broker quota knob: tokens per minute for the telemetry bucket.
+  // Default matches the plan's 60 msg/min device quota; retunable
+  // fleet-wide via the "publishPerMin" shared attribute.
+  cfgPublishPerMin = runtimeConfig.add("publishPerMin", 60.0f, 6.0f, 600.0f);
+  // OTA wave campaign: otaWaveOpen is the cohort currently allowed to
+  // take an update (-1 = no campaign, every node accepts), otaWaveCount
+  // splits the fleet into cohorts by MAC hash. Persisted on purpose: a
+  // node that reboots mid-campaign comes back knowing its window.
+  cfgOtaWaveOpen = runtimeConfig.add("otaWaveOpen", -1.0f, -1.0f, 63.0f);
+  cfgOtaWaveCount = runtimeConfig.add("otaWaveCount", 4.0f, 1.0f, 64.0f);
+  // Alert thresholds ship disabled (defaults at the range edges) until
+  // the server distributes this sector's row as shared attributes
+  for (int r = 0; r < ThresholdRules::RULE_COUNT; r++) {
+    cfgAlertSlot[r] = runtimeConfig.add(ThresholdRules::ruleKey(r),
+                                        ThresholdRules::ruleDefault(r),
+                                        ThresholdRules::ruleMin(r),
+                                        ThresholdRules::ruleMax(r));
+  }
+#if PROFILE_HAS_CONTROL
+  cfgPumpOnPct = runtimeConfig.add("pumpOnPct", 30.0f, 0.0f, 100.0f);
+  cfgPumpOffPct = runtimeConfig.add("pumpOffPct", 45.0f, 0.0f, 100.0f);
+  cfgFanOnC = runtimeConfig.add("fanOnC", 33.0f, -10.0f, 60.0f);
+  cfgFanOffC = runtimeConfig.add("fanOffC", 30.0f, -10.0f, 60.0f);
+#endif
+  runtimeConfig.addString("wifiSsid", WIFI_SSID);
+  runtimeConfig.addString("wifiPass", WIFI_PASSWORD);
+  runtimeConfig.begin();
+  runtimeConfig.getString("wifiSsid", wifiSsid, sizeof(wifiSsid));
+  runtimeConfig.getString("wifiPass", wifiPass, sizeof(wifiPass));
+}
+
+// Reload credentials from NVS and re-associate, so newly provisioned
+// credentials apply without a reboot. The disconnect event handler
+// below re-arms WiFi.begin with the updated buffers.
+static void applyWifiCredentials() {
+  runtimeConfig.getString("wifiSsid", wifiSsid, sizeof(wifiSsid));
+  runtimeConfig.getString("wifiPass", wifiPass, sizeof(wifiPass));
+  WiFi.disconnect();
+  WiFi.begin(wifiSsid, wifiPass);
+}
+
+// Event-driven WiFi: the radio reconnects in the background while the
+// sensing, control and serial tasks keep running at full rate. No task
+// ever blocks in a connect loop.
+void onWiFiEvent(WiFiEvent_t event) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      Serial.print("WiFi connected, IP: ");
+      Serial.println(WiFi.localIP());
+      wifiFastConnect.onConnected();
+      wifiRoam.onConnected();
+      energyMonitor.setWifiOn(true);
+      if (!otaListenerUp) {
+        // Needs an IP to bind its listener; hooks were registered in
+        // setup() before the first event could fire
+        ArduinoOTA.begin();
+        otaListenerUp = true;
+      }
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      energyMonitor.setWifiOn(false);
+      if (wifiRoam.onDisconnected()) {
+        // Deliberate handoff: the targeted begin to the next AP is
+        // already armed, a full-scan begin here would wipe it
+        Serial.println("Handing off to the next AP...");
+        break;
+      }
+      if (wifiFastConnect.onDisconnected()) {
+        // Fast attempt failed: cache dropped, do a full scan
+        Serial.println("Fast WiFi attempt failed, falling back to full scan...");
+      } else {
+        Serial.println("WiFi lost, reconnecting in background...");
+      }
+      WiFi.begin(wifiSsid, wifiPass);
+      break;
+    default:
+      break;
+  }
+}
+
 void InitWiFi() {
-  Serial.println("Connecting to AP ...");
-  // Attempting to establish a connection to the given WiFi network
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  while (WiFi.status() != WL_CONNECTED) {
-    // Delay 500ms until a connection has been successfully established
-    delay(500);
-    Serial.print(".");
+  Serial.println("Connecting to AP (non-blocking) ...");
+  wifiFastConnect.begin();
+  wifiRoam.begin(wifiSsid, wifiPass);
+  WiFi.onEvent(onWiFiEvent);
+  WiFi.setAutoReconnect(true);
+  // Prefer the cached BSSID+channel+lease (no scan, no DHCP); fall back
+  // to a normal full-scan association when there is no cache yet
+  if (wifiFastConnect.tryFastBegin(wifiSsid, wifiPass)) {
+    Serial.println("Using cached BSSID/channel for fast association");
+  } else {
+    WiFi.begin(wifiSsid, wifiPass);
   }
-  Serial.println("Connected to AP");
 }
 
 const bool reconnect() {
-  // Check to ensure we aren't connected yet
-  const wl_status_t status = WiFi.status();
-  if (status == WL_CONNECTED) {
-    return true;
+  // The event handler already re-arms WiFi.begin on disconnect;
+  // just report the current link state without blocking the caller.
+  return WiFi.status() == WL_CONNECTED;
+}
+
+// OTA updates stage into the inactive app partition (the ESP32 Update
+// library is A/B by construction, the bootloader switches on the next
+// reset). The hooks here carry the runtime state across that switch so
+// the new image comes up warm: snapshot and DHT20 calibration through
+// RTC memory, BSSID/channel/lease through the fast-connect NVS cache
+// (already maintained on every connect), telemetry backlog through the
+// flash-backed buffer.
+static void initOtaUpdate() {
+  ArduinoOTA.setRebootOnSuccess(true);
+  ArduinoOTA.onStart([]() {
+    // Checkpoint the backlog first; anything sampled during the
+    // transfer still lands in the buffer and is persisted again below
+    telemetryBuffer.persist();
+    LOG_INFO("[OTA] update started");
+  });
+  ArduinoOTA.onEnd([]() {
+    // Image verified, reboot is imminent: stage the freshest state
+    const SensorSnapshot s = readSensorSnapshot();
+    warmBoot.stage(s.temperature, s.humidity, s.light, s.moisture,
+                   dht20.getTempOffset(), dht20.getHumOffset());
+    telemetryBuffer.persist();
+    LOG_INFO("[OTA] update complete, runtime state staged for warm boot");
+  });
+  ArduinoOTA.onError([](ota_error_t error) {
+    LOG_ERROR("[OTA] update failed (%d)", (int)error);
+  });
+}
+
+#if NFC_READER_SPI
+// Cold-path thunk (lazy_init.h): stations scan a few times a day, so
+// the PN532 probe and SAM handshake have no business ahead of the
+// first telemetry publish
+static void initNfcReader() {
+  nfc.begin();
+  if (nfc.getFirmwareVersion()) {
+    nfc.SAMConfig();
+    Serial.println("PN532 ready on SPI");
+  } else {
+    Serial.println("PN532 not found on SPI");
+  }
+}
+#endif
+
+#if ENCRYPT_TELEMETRY
+// Cold-path thunk: key load plus the one-shot seal benchmark. The
+// publish path ensure()s this before the first seal, so sealing still
+// never ships plaintext from a provisioned node.
+static void initPayloadCrypto() {
+  if (payloadCrypto.begin()) {
+    Serial.printf("Payload sealing active, %lu us per 160B seal\n",
+                  (unsigned long)payloadCrypto.benchmarkUs(160));
+  } else {
+    Serial.println("No crypto key provisioned, publishing plaintext");
+  }
+}
+#endif
+
+// Background warm-up: one pending cold subsystem per pass, starting
+// after the boot path has telemetry flowing. Once the table is drained
+// each pass is a scan of a few flags.
+static void lazyWarmJob() {
+    lazyInit.warmNext();
+}
+
+// Commit everything staged in the NVS journal; the erase-cycle stalls
+// this can hit are exactly why it runs here and not on the writers
+static void nvsFlushJob() {
+    nvsJournal.flush();
+}
+
+// Stable OTA cohort for this node: the MAC hashed into a wave index,
+// so cohort membership needs no provisioning and survives reflashes.
+// Same FNV spreading the ESP32-CAM fleet uses for its capture phase.
+static uint32_t otaCohortHash() {
+    static uint32_t hash = 0;
+    if (hash == 0) {
+        uint8_t mac[6];
+        WiFi.macAddress(mac);
+        hash = 2166136261u;
+        for (int i = 0; i < 6; i++) {
+            hash = (hash ^ mac[i]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+// Whether this node may take an OTA update right now. Updating the
+// whole fleet at once saturates the APs and the broker together (we
+// have blacked out farm telemetry this way), so the backend's otawave
+// tool opens one cohort at a time via the otaWaveOpen/otaWaveCount
+// shared attributes and each node checks itself against the open wave.
+// No campaign (otaWaveOpen = -1) leaves the listener open for one-off
+// developer pushes.
+static bool otaWindowOpen() {
+    const int wave = (int)runtimeConfig.get(cfgOtaWaveOpen);
+    if (wave < 0) {
+        return true;
+    }
+    int count = (int)runtimeConfig.get(cfgOtaWaveCount);
+    if (count < 1) {
+        count = 1;
+    }
+    return (int)(otaCohortHash() % (uint32_t)count) == wave;
+}
+
+// OTA listener poll, unsupervised on purpose: once a transfer starts,
+// handle() runs the whole download and flash write inline (well over
+// any task deadline), which must not look like a stall to the
+// supervisor. Co-jobs on the housekeeping worker wait it out and
+// resume on their grid - the node reboots right after anyway.
+//
+// Outside this node's update window the poll is skipped entirely, so
+// an uploader's invite goes unanswered and times out on the host —
+// that is how a node declines a transfer aimed at the wrong wave.
+static void otaPollJob() {
+    static bool wasOpen = true;
+    if (!otaListenerUp) {
+        return;
+    }
+    const bool open = otaWindowOpen();
+    if (open != wasOpen) {
+        wasOpen = open;
+        LOG_INFO("[OTA] update window %s (cohort %u of %u)", open ? "open" : "closed",
+                 (unsigned)(otaCohortHash() % (uint32_t)runtimeConfig.get(cfgOtaWaveCount)),
+                 (unsigned)runtimeConfig.get(cfgOtaWaveCount));
+    }
+    if (open) {
+        ArduinoOTA.handle();
+    }
+}
+
+#if LOW_POWER_MODE
+// Survives deep sleep in RTC slow memory: boot counter, the last good
+// snapshot and the DHT20 calibration offsets, so a wake cycle does not
+// repeat the slow begin/calibration sequence.
+RTC_DATA_ATTR uint32_t lpBootCount = 0;
+RTC_DATA_ATTR SensorSnapshot lpLastSnapshot = {0.0f, 0.0f, 0.0f, 0.0f, 0};
+RTC_DATA_ATTR float lpTempOffset = 0.0f;
+RTC_DATA_ATTR float lpHumOffset = 0.0f;
+
+// One duty cycle: bring up only what a single sample+publish needs,
+// then deep sleep. Target is well under a second of awake time on a
+// warm boot (WiFi join dominates; see the reconnect cache).
+void lowPowerCycle() {
+  const bool warmBoot = (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER);
+  lpBootCount++;
+
+  Wire.begin(SDA_PIN, SCL_PIN);
+  if (warmBoot) {
+    // Sensor kept power through our sleep: restore offsets, skip the
+    // begin/calibration wait
+    dht20.setTempOffset(lpTempOffset);
+    dht20.setHumOffset(lpHumOffset);
+  } else {
+    dht20.begin();
+    lpTempOffset = dht20.getTempOffset();
+    lpHumOffset = dht20.getHumOffset();
   }
-  // If we aren't establish a new connection to the given WiFi network
+  initRuntimeConfig();
   InitWiFi();
-  return true;
+
+  SensorSnapshot s = lpLastSnapshot;
+  if (dht20.read() == DHT20_OK) {
+    s.temperature = dht20.getTemperature();
+    s.humidity = dht20.getHumidity();
+  }
+  moistureCal.begin("moist", MOISTURE_DEFAULT_LUT);
+  lightCal.begin("light", LIGHT_DEFAULT_LUT);
+  s.light = lightCal.apply(analogRead(LIGHT_SENSOR_PIN));
+  s.moisture = moistureCal.apply(analogRead(MOISTURE_PIN)) * 0.01f;
+  s.acquiredMs = millis();
+  lpLastSnapshot = s;
+
+  // Wait briefly for the association kicked off by InitWiFi; if the AP
+  // is not there, the sample still lands in the flash-backed buffer
+  uint32_t deadline = millis() + 5000;
+  while (WiFi.status() != WL_CONNECTED && millis() < deadline) {
+    delay(20);
+  }
+  TelemetryRecord rec = {s.acquiredMs, s.temperature, s.humidity, s.light, s.moisture};
+  telemetryBuffer.begin(memPools);
+  telemetryBuffer.push(rec);
+  if (WiFi.status() == WL_CONNECTED) {
+    // Budget-bounded drain: a node waking up to a long flash backlog
+    // sends one burst worth of tokens and leaves the rest persisted
+    // for the next wakes, instead of blowing the broker quota in one go
+    publishBudget.refill(runtimeConfig.get(cfgPublishPerMin), millis());
+    TelemetryRecord pending;
+    while (publishBudget.tryTake() && telemetryBuffer.pop(pending)) {
+      publishBufferedRecord(pending);
+    }
+    telemetryBuffer.persist();
+  } else {
+    telemetryBuffer.persist();
+  }
+
+  esp_sleep_enable_timer_wakeup((uint64_t)LOW_POWER_SLEEP_S * 1000000ULL);
+  esp_deep_sleep_start();
 }
+#endif // LOW_POWER_MODE
 
 void setup() {
   Serial.begin(SERIAL_DEBUG_BAUD);
-  delay(500);  // Đợi Serial ổn định
-  
+#if LOW_POWER_MODE
+  lowPowerCycle();  // never returns: ends in esp_deep_sleep_start()
+#endif
+  delay(100);  // Đợi Serial ổn định (USB CDC needs a moment, 500ms was overkill)
+  bootProfiler.mark("serial");
+
+  crashReport.begin();
+  if (crashReport.pending()) {
+    // The record itself waits for MQTT; the serial line gets the
+    // headline now in case this boot never makes it that far
+    Serial.printf("Previous boot crashed (%s), coredump summary queued\n",
+                  CrashReport::reasonName(esp_reset_reason()));
+  }
+
+  warmBoot.begin(&warmBootState);
+  // First boot of a freshly flashed image: the previous image staged
+  // its runtime state right before the partition switch
+  const bool otaWarmBoot = warmBoot.consume();
+  if (otaWarmBoot) {
+    Serial.println("Warm boot: restoring state staged by the previous image");
+  }
+
   Serial.println("\n\n--- ESP32 Sensor System Starting ---");
   Serial.println("Serial command handler enabled. Send {\"switch\":true} or {\"switch\":false} to control LED.");
+#if PROFILE_HAS_CONTROL
   Serial.println("Send {\"pump\":true} or {\"pump\":false} to control PUMP.");
-  
+#endif
+
   pinMode(LED_PIN, OUTPUT);
+#if PROFILE_HAS_CONTROL
   pinMode(PUMP_MOTOR, OUTPUT);  // Thêm pinMode cho bơm
   pinMode(FAN_MOTOR, OUTPUT);  // Thêm pinMode cho quạt
+#endif
+
+  pinMode(LIGHT_SENSOR_PIN, INPUT);
+  pinMode(MOISTURE_PIN, INPUT);
 
-  pinMode(LIGHT_SENSOR_PIN, INPUT);  
-  pinMode(MOISTURE_PIN, INPUT);  
-  
-  // Turn on LED initially
-  digitalWrite(LED_PIN, HIGH);
-  digitalWrite(PUMP_MOTOR, LOW);  // Bắt đầu với bơm TẮT (LOW)
-  digitalWrite(FAN_MOTOR, LOW);  // Bắt đầu với quạt TẮT (LOW)
-
-  ledState = true;
-  Serial.println("LED initialized to ON state");
-  Serial.printf("PUMP initialized to on state on GPIO%d\n", PUMP_MOTOR);
-  
-  delay(1000);
+  // Restore the journaled actuator state before anything network
+  // related runs: a brownout mid irrigation cycle resumes pumping here,
+  // milliseconds after power-on, instead of waiting for cloud
+  // reconciliation. setup() runs single-threaded before the actuator
+  // task exists, so these initial writes stay direct; every write after
+  // this point goes through the actuator queue.
+  actuatorJournal.begin();
+  const bool journalRestored = actuatorJournal.restore();
+  ledState = journalRestored ? actuatorJournal.ledOn() : true;
+  digitalWrite(LED_PIN, ledState ? HIGH : LOW);
+#if PROFILE_HAS_CONTROL
+  pumpState = journalRestored && actuatorJournal.pumpOn();
+  fanState = journalRestored && actuatorJournal.fanOn();
+  digitalWrite(PUMP_MOTOR, pumpState ? HIGH : LOW);
+  digitalWrite(FAN_MOTOR, fanState ? HIGH : LOW);
+  if (journalRestored) {
+    autoControlEnabled = actuatorJournal.autoEnabled();
+    if (pumpState && !autoControlEnabled) {
+      // Manual cycle resumed with nobody watching: arm the remaining
+      // run-time budget, enforced by the control loop
+      const uint32_t ran = actuatorJournal.restoredPumpRunMs();
+      pumpResumeDeadlineMs =
+          millis() + (ran < PUMP_RESUME_CAP_MS ? PUMP_RESUME_CAP_MS - ran : 1);
+      Serial.printf("Resumed pump cycle (ran %lums before reboot)\n",
+                    (unsigned long)ran);
+    }
+  }
+#endif
+  Serial.printf("Actuator state %s\n",
+                journalRestored ? "restored from journal" : "defaulted (first boot)");
+  bootProfiler.mark("gpio");
+
+  // Kick WiFi off first: the association runs in the background (event
+  // driven) while we bring up I2C and the sensors, so the two longest
+  // stages overlap instead of running back to back. The old fixed
+  // delay(1000) "settle" wait is gone — it bought nothing but boot time.
   Serial.println("Initializing WiFi...");
+  initRuntimeConfig();
+  // Route the steady-state NVS writes through the write-behind journal
+  // (flushed by the nvsFlush housekeeping job). Attached here, on the
+  // normal boot path only: a low-power duty cycle has no housekeeping
+  // worker, so its few writes stay synchronous.
+  runtimeConfig.attachJournal(&nvsJournal);
+  actuatorJournal.attachJournal(&nvsJournal);
+  wifiFastConnect.attachJournal(&nvsJournal);
+  // Hooks must exist before the first GOT_IP event can start the listener
+  initOtaUpdate();
   InitWiFi();
+  bootProfiler.mark("wifiStart");
+
+#if USE_ESP_MQTT_CLIENT
+  // Enqueue publishes into the esp-mqtt outbox so sendTelemetry calls
+  // never block the calling task on the socket; the MQTT task drains
+  // the queue (retransmitting QoS1) in the background
+  mqttClient.set_enqueue_messages(true);
+#else
+  // Grow-on-demand receive buffer: idles at the floor, stretches for
+  // an OTA chunk or fat RPC, shrinks back 30s after the last one
+  mqttClient.get_client().setBufferElastic(MQTT_BUFFER_FLOOR, MQTT_BUFFER_CEILING);
+#if DUAL_SESSION_MQTT
+  // The keeper job (controlSessionJob) connects and subscribes once
+  // the link is up; only the endpoint is configured here
+  controlMqttClient.set_server(CONTROL_SERVER, CONTROL_PORT);
+#endif
+#endif
 
   Serial.println("Initializing I2C...");
   Wire.begin(SDA_PIN, SCL_PIN);
-  dht20.begin();
+  if (otaWarmBoot) {
+    // The sensor kept power through the software reset: restore the
+    // calibration offsets instead of repeating begin()'s wait, and seed
+    // the seqlock snapshot with the carried readings so the first
+    // telemetry cycle publishes immediately instead of waiting out the
+    // new image's first conversion
+    dht20.setTempOffset(warmBoot.tempOffset());
+    dht20.setHumOffset(warmBoot.humOffset());
+    SensorSnapshot s = {warmBoot.temperature(), warmBoot.humidity(),
+                        warmBoot.light(), warmBoot.moisture(), millis()};
+    publishSensorSnapshot(s);
+    tempFilter.seed(s.temperature);
+    humFilter.seed(s.humidity);
+    lightFilter.seed(s.light);
+    moistureFilter.seed(s.moisture);
+  } else {
+    dht20.begin();
+  }
+#if DHT20_MUX_CHANNELS > 0
+  Serial.printf("DHT20 mux: %d of %d probes present\n",
+                dht20Mux.begin((1U << DHT20_MUX_CHANNELS) - 1),
+                DHT20_MUX_CHANNELS);
+#endif
+  // From here on the bus task owns the wires; setup() ran single-
+  // threaded so the direct begin() calls above were safe. The bus task
+  // lives on the sensing core with its clients.
+  i2cBus.begin(3, CORE_SENSE);
   Serial.println("DHT20 initialized");
+  bootProfiler.mark("i2cDht20");
+
+#if NFC_READER_SPI
+  // Registration only — the PN532 probe runs from the warm job (or the
+  // first scan path), after telemetry is already flowing
+  lazyNfcSlot = lazyInit.add("nfc", initNfcReader);
+#endif
 
+  // Restore any telemetry backlog persisted during a previous outage
+  telemetryBuffer.begin(memPools);
+  heapMonitor.begin(&heapPersistentStats);
+  // Per-node calibration overrides, when the field tool stored them
+  moistureCal.begin("moist", MOISTURE_DEFAULT_LUT);
+  lightCal.begin("light", LIGHT_DEFAULT_LUT);
+#if ENCRYPT_TELEMETRY
+  // Key load and benchmark deferred to first seal or the warm job
+  lazyCryptoSlot = lazyInit.add("crypto", initPayloadCrypto);
+#endif
+  bootProfiler.mark("nvs");
+
+  // GPIO1/GPIO2 map to ADC1 channels 0/1; falls back to analogRead if
+  // the continuous driver cannot start
+  if (adcSampler.begin(ADC_CHANNEL_0, ADC_CHANNEL_1)) {
+    Serial.println("ADC continuous (DMA) sampling started");
+  } else {
+    Serial.println("ADC continuous mode unavailable, using analogRead");
+  }
+  bootProfiler.mark("adc");
+
+  // Charge integration starts here; the WiFi event handler and the
+  // task-side windows feed it from now on
+  energyMonitor.begin();
+  energyMonitor.setAdcContinuous(adcSampler.ready());
+
+  // Per-field cadence; taskDHT20 executes the schedule
+  sampleScheduler.setPeriod(SampleScheduler::FIELD_CLIMATE, CLIMATE_SAMPLE_MS);
+  sampleScheduler.setPeriod(SampleScheduler::FIELD_LIGHT, LIGHT_SAMPLE_MS);
+  sampleScheduler.setPeriod(SampleScheduler::FIELD_MOISTURE, MOISTURE_SAMPLE_MS);
+
+  // Tickless idle and DFS: every task below is periodic with long idle
+  // gaps, so the idle task light-sleeps between deadlines and the CPU
+  // parks at 80MHz unless a burst lock is held
+  if (powerManager.begin(240, 80)) {
+    Serial.println("Power management: tickless idle + DFS 80-240MHz");
+  } else {
+    Serial.println("Power management unavailable, staying at full clock");
+  }
+
+  // Deadlines are several times the task periods, so transient
+  // scheduling jitter never trips them; the hardware WDT behind the
+  // supervisor stays well above the longest deadline
+  taskSupervisor.begin(&taskHealthStats, TASK_WDT_TIMEOUT_S);
+  supDht20Slot = taskSupervisor.add("TaskDHT20", 5000, &taskDHT20Handle,
+                                    taskDHT20, 4096, 1, CORE_SENSE, recoverI2cBus);
+  supSerialSlot = taskSupervisor.add("TaskSerial", 10000, &taskSerialHandle,
+                                     taskSerial, 4096, 1, CORE_NET);
+#if PROFILE_HAS_CONTROL
+  supControlSlot = taskSupervisor.add("TaskControl", 3000, &taskControlHandle,
+                                      taskControl, 2048, 2, CORE_SENSE);
+#endif
+
+  // Explicit two-plane topology. The WiFi/LwIP stack lives on core 0,
+  // so everything that talks to the network joins it there and the
+  // sensing/control plane owns core 1 outright — a TLS handshake or a
+  // fat JSON parse can never sit between a moisture reading and the
+  // pump relay. Priorities within each core, high to low:
+  //   core 1 (sense):  3 supervisor + I2C bus, 2 control + actuator, 1 DHT20
+  //   core 0 (net):    2 serial command, 1 telemetry + TB + housekeeping, 0 log
   Serial.println("Creating tasks...");
-  xTaskCreate(taskThingsBoard, "TaskThingsBoard", 4096, NULL, 1, NULL);
-  xTaskCreate(taskSerialCommand, "TaskSerialCommand", 4096, NULL, 2, NULL);  // Ưu tiên cao hơn và bộ nhớ nhiều hơn
-  xTaskCreate(taskDHT20, "TaskDHT20", 4096, NULL, 1, &taskDHT20Handle);
-  // xTaskCreate(taskLight, "TaskLight", 4096, NULL, 1, &taskLightHandle);
-  xTaskCreate(taskSerial, "TaskSerial", 4096, NULL, 1, &taskSerialHandle);
-  // xTaskCreate(taskPrintVersion, "TaskPrintVersion", 2048, NULL, 1, NULL);
-  
+  actuatorQueue.begin();
+  xTaskCreatePinnedToCore(taskThingsBoard, "TaskThingsBoard", 4096, NULL, 1, NULL, CORE_NET);
+  xTaskCreatePinnedToCore(taskSerialCommand, "TaskSerialCommand", 4096, NULL, 2, &taskSerialCommandHandle, CORE_NET);  // Ưu tiên cao hơn và bộ nhớ nhiều hơn
+  // Event-driven command channel: the driver wakes the task on received
+  // bytes, no 10ms polling wakeup while the line is idle
+  Serial.onReceive(onSerialCommandData);
+  xTaskCreatePinnedToCore(taskDHT20, "TaskDHT20", 4096, NULL, 1, &taskDHT20Handle, CORE_SENSE);
+  // xTaskCreatePinnedToCore(taskLight, "TaskLight", 4096, NULL, 1, &taskLightHandle, CORE_SENSE);
+  xTaskCreatePinnedToCore(taskSerial, "TaskSerial", 4096, NULL, 1, &taskSerialHandle, CORE_NET);
+#if PROFILE_HAS_CONTROL
+  xTaskCreatePinnedToCore(taskControl, "TaskControl", 2048, NULL, 2, &taskControlHandle, CORE_SENSE);  // Local control loop, higher priority
+#endif
+  xTaskCreatePinnedToCore(taskActuator, "TaskActuator", 2048, NULL, 2, NULL, CORE_SENSE);  // Sole GPIO writer, drains the command queue
+  xTaskCreatePinnedToCore(taskLogDrain, "TaskLogDrain", 2048, NULL, 0, NULL, CORE_NET);  // Lowest priority: owns the UART
+  xTaskCreatePinnedToCore(taskSupervisorLoop, "TaskSupervisor", 2048, NULL, 3, NULL, CORE_SENSE);  // Deadline watcher, feeds the WDT
+  // Periodic housekeeping rides one timer-driven worker instead of a
+  // delay-loop task per job; co-due periods share a single wakeup.
+  // Phases anchor both jobs to the same 500ms grid.
+  netHousekeeping.add("otaPoll", 500, 0, otaPollJob);
+  netHousekeeping.add("heapWatch", 10000, 0, heapMonitorJob);
+  netHousekeeping.add("profFlush", 1000, 0, profileFlushJob);
+  netHousekeeping.add("burstFlush", 500, 100, burstFlushJob);
+  // Brings up one registered cold subsystem per pass; offset off the
+  // full-second jobs so a slow thunk does not delay them
+  netHousekeeping.add("lazyWarm", 1000, 500, lazyWarmJob);
+  // Staged NVS writes, committed off the hot tasks; offset from the
+  // full-second jobs so an erase stall does not delay them
+  netHousekeeping.add("nvsFlush", 1000, 300, nvsFlushJob);
+#if DUAL_SESSION_MQTT && !USE_ESP_MQTT_CLIENT
+  // Offset half a grid step from otaPoll so the two 500ms jobs do not
+  // stack their work into the same wakeup
+  netHousekeeping.add("ctlSession", 500, 250, controlSessionJob);
+#endif
+  netHousekeeping.begin("TaskHousekeep", 4096, 1, CORE_NET);
+
+  bootProfiler.mark("tasks");
   Serial.println("Setup complete! Waiting for serial commands...");
 }
 
+// Every JSON publish leaves through here so the radio TX burst is
+// accounted once, at the socket write. Publishes come from several
+// tasks, so the window is timed locally and handed to the ledger
+// instead of using the single-task windowBegin/windowEnd marks.
+static bool sendTelemetryAccounted(const char *payload) {
+    const int64_t txStartUs = esp_timer_get_time();
+#if ENCRYPT_TELEMETRY
+    // Sealed path: one hardware-CTR pass over the serialized JSON, then
+    // the binary ciphertext leaves on the sealed topic. An unprovisioned
+    // node (no key in NVS) falls through to plaintext.
+    bool ok;
+    // First publish may beat the warm job to the key load
+    lazyInit.ensure(lazyCryptoSlot);
+    if (payloadCrypto.enabled()) {
+        uint8_t sealed[384];
+        const size_t sealedLen = payloadCrypto.seal(
+            (const uint8_t *)payload, strlen(payload), sealed, sizeof(sealed));
+        ok = sealedLen > 0 &&
+             mqttClient.publish(TELEMETRY_SEALED_TOPIC, sealed, sealedLen);
+    } else {
+        ok = tb.sendTelemetryJson(payload);
+    }
+#else
+    const bool ok = tb.sendTelemetryJson(payload);
+#endif
+    energyMonitor.accountUs(EnergyMonitor::WIFI,
+                            (uint32_t)(esp_timer_get_time() - txStartUs));
+    // Every outcome feeds the link scheduler: a run of failures here
+    // degrades the tier even when RSSI still looks acceptable
+    linkScheduler.recordTx(ok);
+    backpressure.noteTxResult(ok);
+    return ok;
+}
+
+// Alert-class publish: block-briefly policy. Alerts are sparse and
+// worth a short wait, so unlike bulk telemetry (which sheds at the
+// source under pressure) a failed alert send retries a couple of times
+// before giving up. Bounded at ~200ms total, so no caller stalls past
+// its deadline.
+static bool sendAlertTelemetry(const char *payload) {
+#if DUAL_SESSION_MQTT && !USE_ESP_MQTT_CLIENT
+    // Alerts prefer the uncongested control socket; if it is down (or
+    // the send fails) they fall back to the bulk session's retry path
+    if (controlMqttClient.get_client().connected()) {
+        const int64_t txStartUs = esp_timer_get_time();
+        const bool ok = tbControl.sendTelemetryJson(payload);
+        energyMonitor.accountUs(EnergyMonitor::WIFI,
+                                (uint32_t)(esp_timer_get_time() - txStartUs));
+        if (ok) {
+            return true;
+        }
+    }
+#endif
+    for (int attempt = 0; attempt < 3; attempt++) {
+        if (sendTelemetryAccounted(payload)) {
+            return true;
+        }
+        if (attempt < 2) {
+            vTaskDelay(100 / portTICK_PERIOD_MS);
+        }
+    }
+    return false;
+}
+
+// Publish the setup() stage breakdown once, piggybacked on the first
+// connected telemetry cycle.
+static void reportBootProfile() {
+    if (bootProfiler.reported) return;
+    bootProfiler.reported = true;
+
+    StaticJsonDocument<JSON_OBJECT_SIZE(BootProfiler::MAX_STAGES + 1)> doc;
+    int64_t prev = 0;
+    for (size_t i = 0; i < bootProfiler.count; i++) {
+        char key[24];
+        snprintf(key, sizeof(key), "bootUs_%s", bootProfiler.names[i]);
+        // Interned keys are linked by the document instead of copied,
+        // so the stage names do not eat into the static pool
+        const char *interned = telemetryKeyTable.intern(key);
+        uint32_t stageUs = (uint32_t)(bootProfiler.doneUs[i] - prev);
+        if (interned) {
+            doc[interned] = stageUs;
+        } else {
+            doc[key] = stageUs;
+        }
+        prev = bootProfiler.doneUs[i];
+    }
+    doc[TELEMETRY_KEY_BOOT_TOTAL] = (uint32_t)bootProfiler.doneUs[bootProfiler.count ? bootProfiler.count - 1 : 0];
+    char payload[256];
+    serializeJson(doc, payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+    // payload is stack-local, so this one stays on the immediate-format path
+    logger.logf("[BOOT] %s", payload);
+}
+
+// Publish the previous boot's crash summary once, piggybacked like the
+// boot profile. The dump is erased only after the publish succeeds, so
+// a crash followed by a flaky first connection is reported by whichever
+// boot finally gets a send through.
+static void reportCrashSummary() {
+    if (!crashReport.pending()) return;
+    char payload[512];
+    crashReport.serialize(payload, sizeof(payload),
+                          heapMonitor.minLargestBlock(),
+                          heapMonitor.allocFailures());
+    if (sendTelemetryAccounted(payload)) {
+        crashReport.markReported();
+        logger.logf("[CRASH] %s", payload);
+    }
+}
+
+
+// Publish one buffered record as a single JSON object, with an "ageMs"
+// field telling the backend how old the sample is.
+static bool publishBufferedRecord(const TelemetryRecord &rec) {
+#if TELEMETRY_BINARY_FRAMES
+    // Binary path: no serialization at all, just a struct copy. The
+    // frame carries the same ageMs information in a fixed field.
+    static uint16_t frameSequence = 0;
+    TelemetryFrame frame;
+    const size_t frameSize = encodeTelemetryFrame(rec, TELEMETRY_DEVICE_ID, frameSequence, frame);
+    if (!mqttClient.publish(TELEMETRY_FRAME_TOPIC, (const uint8_t *)&frame, frameSize)) {
+        return false;
+    }
+    frameSequence++;
+#else
+    // Delta mode on degraded links: only fields that moved beyond their
+    // deadband since the last successful publish go on the wire, and a
+    // record where nothing moved is skipped outright. The backend keeps
+    // the last value per key, so omitted fields simply stay put there.
+    // (The binary-frame path above is fixed-size; delta does not apply.)
+    static TelemetryRecord lastSent;
+    static bool haveLastSent = false;
+    const bool delta = linkScheduler.deltaMode() && haveLastSent;
+    const bool sendTemp = !delta || fabsf(rec.temperature - lastSent.temperature) >= 0.2f;
+    const bool sendHum = !delta || fabsf(rec.humidity - lastSent.humidity) >= 1.0f;
+    const bool sendLight = !delta || fabsf(rec.light - lastSent.light) >= 20.0f;
+    const bool sendMoist = !delta || fabsf(rec.moisture - lastSent.moisture) >= 1.0f;
+    if (delta && !sendTemp && !sendHum && !sendLight && !sendMoist) {
+        linkScheduler.countDeltaSkip();
+        return true;
+    }
+    // The document shape is fixed, so the key and punctuation bytes are
+    // compile-time segments and only the values get formatted; no DOM,
+    // no generic serializer walk
+    char payload[160];
+    JsonBuilder json(payload, sizeof(payload));
+    if (sendTemp) json.field(JSON_KEY_SEG(TELEMETRY_LIT_TEMPERATURE), rec.temperature, 2);
+    if (sendHum) json.field(JSON_KEY_SEG(TELEMETRY_LIT_HUMIDITY), rec.humidity, 2);
+    if (sendLight) json.field(JSON_KEY_SEG(TELEMETRY_LIT_LIGHT), rec.light, 1);
+    if (sendMoist) json.field(JSON_KEY_SEG(TELEMETRY_LIT_MOISTURE), rec.moisture, 2);
+    json.field(JSON_KEY_SEG(TELEMETRY_LIT_AGE_MS), (uint32_t)(millis() - rec.uptimeMs));
+    json.finish();
+    if (!sendTelemetryAccounted(payload)) {
+        return false;
+    }
+    // Update only the fields that went out, so suppressed fields keep
+    // their baseline and cannot drift one deadband per cycle
+    if (sendTemp) lastSent.temperature = rec.temperature;
+    if (sendHum) lastSent.humidity = rec.humidity;
+    if (sendLight) lastSent.light = rec.light;
+    if (sendMoist) lastSent.moisture = rec.moisture;
+    haveLastSent = true;
+#endif
+    // PubSubClient returns after the socket write, so this is the closest
+    // completion point we have until QoS1 gives us a PUBACK to wait on
+    publishLatency.record(millis() - rec.uptimeMs);
+    return true;
+}
+
+// Export the latency histogram as its own telemetry object every
+// LATENCY_EXPORT_CYCLES passes through taskSerial (~2 minutes).
+static void exportLatencyHistogram() {
+    static const uint32_t LATENCY_EXPORT_CYCLES = 60;
+    static uint32_t cycles = 0;
+    if (++cycles < LATENCY_EXPORT_CYCLES || publishLatency.count() == 0) {
+        return;
+    }
+    cycles = 0;
+    char payload[256];
+    publishLatency.serialize(payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+}
+
+// Export the MQTT receive-path profiler every MQTT_RX_EXPORT_CYCLES
+// passes (~1 minute): one compact string, "topic:count:avgUs:maxUs"
+// per tracked topic, then reset so each report covers its interval.
+// A handler that costs 100ms+ inside PubSubClient::loop shows up here
+// long before it costs us a keepalive.
+static void exportMqttRxStats() {
+#if USE_ESP_MQTT_CLIENT
+    // The profiler lives in PubSubClient's loop(); esp-mqtt dispatches
+    // callbacks from its own event task and has no equivalent hook.
+#else
+    static const uint32_t MQTT_RX_EXPORT_CYCLES = 30;
+    static uint32_t cycles = 0;
+    if (++cycles < MQTT_RX_EXPORT_CYCLES) {
+        return;
+    }
+    cycles = 0;
+    PubSubClient &client = mqttClient.get_client();
+    if (client.rxStatsCount() == 0) {
+        return;
+    }
+    char list[192];
+    size_t used = 0;
+    for (uint8_t i = 0; i < client.rxStatsCount() && used < sizeof(list) - 1; i++) {
+        const MqttRxTopicStat &stat = client.rxTopicStat(i);
+        used += snprintf(list + used, sizeof(list) - used, "%s%s:%lu:%lu:%lu",
+                         i == 0 ? "" : ";", stat.topic,
+                         (unsigned long)stat.count,
+                         (unsigned long)(stat.totalUs / stat.count),
+                         (unsigned long)stat.maxUs);
+    }
+    client.clearRxStats();
+    char payload[224];
+    snprintf(payload, sizeof(payload), "{\"mqttRx\":\"%s\"}", list);
+    sendTelemetryAccounted(payload);
+#endif
+}
+
+// Close the publish window: send the per-field min/max/mean object
+// when the window actually moved (significant() applies the same
+// deadbands as the delta filter), then start the next window. A
+// single-sample window carries nothing the live record did not.
+static void exportWindowStats() {
+    if (windowStats.count() >= 2 && windowStats.significant()) {
+        char payload[320];
+        windowStats.serialize(payload, sizeof(payload));
+        sendTelemetryAccounted(payload);
+    }
+    windowStats.reset();
+}
+
+// Export the heap stats every HEAP_EXPORT_CYCLES passes (~1 minute).
+static void exportHeapStats() {
+    static const uint32_t HEAP_EXPORT_CYCLES = 30;
+    static uint32_t cycles = 0;
+    if (++cycles < HEAP_EXPORT_CYCLES) {
+        return;
+    }
+    cycles = 0;
+    char payload[192];
+    heapMonitor.serialize(payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+    // Pool placement and per-pool headroom ride the same cadence
+    memPools.serialize(payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+    // So do the pipeline pressure metrics
+    backpressure.serialize(payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+}
+
+// Export the per-subsystem charge ledger once a day (~43200 passes of
+// the 2s telemetry loop). serialize() closes the integration window and
+// resets the accumulators, so each report covers exactly one day and
+// can be compared against the battery gauge over the same period.
+static void exportEnergyReport() {
+    static const uint32_t ENERGY_EXPORT_CYCLES = 43200;
+    static uint32_t cycles = 0;
+    if (++cycles < ENERGY_EXPORT_CYCLES) {
+        return;
+    }
+    cycles = 0;
+    char payload[224];
+    energyMonitor.serialize(payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+}
+
+// Export actuator queue stats every ~1 minute (30 passes of the 2s
+// telemetry loop), but only when something was applied or dropped in
+// the interval — most minutes on a stable farm have no actuation at all.
+static void exportActuatorStats() {
+    static const uint32_t ACT_EXPORT_CYCLES = 30;
+    static uint32_t cycles = 0;
+    if (++cycles < ACT_EXPORT_CYCLES) {
+        return;
+    }
+    cycles = 0;
+    if (actuatorQueue.appliedTotal() == 0) {
+        return;
+    }
+    char payload[160];
+    actuatorQueue.serialize(payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+}
+
+// Export link scheduler stats every ~1 minute of flush passes, but only
+// when the window had something to say (degraded tier, TX failures or
+// delta suppressions) — healthy nodes stay silent.
+static void exportLinkStats() {
+    static const uint32_t LINK_EXPORT_CYCLES = 30;
+    static uint32_t cycles = 0;
+    if (++cycles < LINK_EXPORT_CYCLES) {
+        return;
+    }
+    cycles = 0;
+    if (linkScheduler.quietWindow()) {
+        return;
+    }
+    char payload[160];
+    linkScheduler.serialize(payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+}
+
+// Export the publish budget counters on the same ~1 minute cadence,
+// only for windows where the bucket actually refused something —
+// nodes running inside quota add no traffic for this.
+static void exportPublishBudget() {
+    static const uint32_t BUDGET_EXPORT_CYCLES = 30;
+    static uint32_t cycles = 0;
+    if (++cycles < BUDGET_EXPORT_CYCLES) {
+        return;
+    }
+    cycles = 0;
+    if (publishBudget.denied() == 0 && !publishBudget.hasMerged()) {
+        return;
+    }
+    char payload[160];
+    publishBudget.serialize(payload, sizeof(payload));
+    sendTelemetryAccounted(payload);
+}
+
+// Fragmentation watcher, every 10s on the housekeeping worker. Raises
+// an MQTT alert (rate limited to one per 5 minutes) when the largest
+// free block falls below the floor, i.e. before the first big
+// allocation fails.
+static void heapMonitorJob() {
+    static uint32_t lastAlertMs = 0;
+    heapMonitor.sample();
+    if (heapMonitor.belowFloor(HEAP_LARGEST_BLOCK_FLOOR) &&
+        WiFi.status() == WL_CONNECTED &&
+        (lastAlertMs == 0 || millis() - lastAlertMs > 300000UL)) {
+        lastAlertMs = millis();
+        char payload[160];
+        snprintf(payload, sizeof(payload),
+            "{\"heapAlert\":true,\"heapLargest\":%lu,\"heapFloor\":%lu,\"heapFree\":%lu}",
+            (unsigned long)heapMonitor.largestBlock(),
+            (unsigned long)HEAP_LARGEST_BLOCK_FLOOR,
+            (unsigned long)heapMonitor.freeBytes());
+        sendAlertTelemetry(payload);
+        LOG_WARN("[HEAP] largest free block %lu < floor %lu",
+                    (unsigned long)heapMonitor.largestBlock(),
+                    (unsigned long)HEAP_LARGEST_BLOCK_FLOOR);
+    }
+}
+
+// Collects a finished profiling session: tears the hardware timer down
+// in task context (finished() does that on its first true return),
+// publishes the per-task CPU shares and re-arms for the next RPC. The
+// 1s poll is free against a session that runs for whole seconds.
+static void profileFlushJob() {
+    if (!samplingProfiler.finished()) {
+        return;
+    }
+    char payload[384];
+    samplingProfiler.serialize(payload, sizeof(payload));
+    if (WiFi.status() == WL_CONNECTED && sendTelemetryAccounted(payload)) {
+        logger.logf("[PROF] %s", payload);
+        samplingProfiler.reset();
+    }
+    // Publish failed or offline: keep the report and retry next second
+}
+
+// Uploads a finished burst capture, one chunk per 500ms pass — the
+// pacing keeps the transfer inside the per-device message quota and
+// the radio bursts small. A chunk that compresses goes out on the /lz
+// topic, the rest plain, same rollout contract as batched telemetry.
+// A failed publish leaves the chunk index alone and retries next pass.
+static void burstFlushJob() {
+    if (!burstCapture.finished()) {
+        return;
+    }
+    // The window is over: the sampling loop owns the DMA drain again
+    adcSampler.setTap(NULL);
+    if (WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+    static uint8_t chunk[sizeof(BurstChunkHeader) +
+                         BURST_CHUNK_SAMPLES * sizeof(uint16_t)];
+    static uint8_t packed[sizeof(chunk) + sizeof(chunk) / 8 + 3];
+    bool last = false;
+    const size_t wire = burstCapture.nextChunk(TELEMETRY_DEVICE_ID, chunk,
+                                               sizeof(chunk), last);
+    bool sent = wire == 0;  // nothing to send counts as done
+    if (wire > 0) {
+        const size_t lz = payloadCompress(chunk, wire, packed, sizeof(packed));
+        if (lz > 0 && lz < wire) {
+            sent = mqttClient.publish(BURST_TOPIC PAYLOAD_LZ_TOPIC_SUFFIX,
+                                      packed, lz);
+        } else {
+            sent = mqttClient.publish(BURST_TOPIC, chunk, wire);
+        }
+    }
+    if (!sent) {
+        return;
+    }
+    burstCapture.chunkSent();
+    if (last) {
+        logger.logf("[BURST] capture uploaded (%lu samples)",
+                    (unsigned long)burstCapture.sampleCount());
+        burstCapture.reset();
+    }
+}
+
+// Highest-priority watcher: checks every monitored task against its
+// deadline once a second and is the only feeder of the hardware task
+// WDT. A first deadline miss gets a targeted recovery (bus clear +
+// task restart) and a stall event on MQTT; a second miss by the same
+// task means recovery failed, so the feeder parks itself and the WDT
+// panic-resets the chip with the RTC stats intact.
+void taskSupervisorLoop(void *parameter) {
+    taskSupervisor.subscribeSupervisorTask();
+    while (1) {
+        int stalledSlot = -1;
+        const bool healthy = taskSupervisor.poll(stalledSlot);
+        if (stalledSlot >= 0) {
+            LOG_WARN("[SUP] %s missed its %lums deadline (max latency %lums, stall #%lu)",
+                        taskSupervisor.slotName(stalledSlot),
+                        (unsigned long)taskSupervisor.slotDeadlineMs(stalledSlot),
+                        (unsigned long)taskSupervisor.maxLatencyMs(stalledSlot),
+                        (unsigned long)taskSupervisor.stalls(stalledSlot));
+            if (WiFi.status() == WL_CONNECTED) {
+                char payload[192];
+                snprintf(payload, sizeof(payload),
+                    "{\"taskStall\":\"%s\",\"deadlineMs\":%lu,\"maxLatencyMs\":%lu,"
+                    "\"stalls\":%lu,\"recovered\":%s}",
+                    taskSupervisor.slotName(stalledSlot),
+                    (unsigned long)taskSupervisor.slotDeadlineMs(stalledSlot),
+                    (unsigned long)taskSupervisor.maxLatencyMs(stalledSlot),
+                    (unsigned long)taskSupervisor.stalls(stalledSlot),
+                    healthy ? "true" : "false");
+                sendAlertTelemetry(payload);
+            }
+        }
+        if (!healthy) {
+            // Stop feeding: the task WDT panics within TASK_WDT_TIMEOUT_S
+            vTaskDelay(portMAX_DELAY);
+        }
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
+    }
+}
 
 void taskSerial(void *parameter){
+    uint32_t offlineSince = 0;
     while(1){
-      Serial.print("Temperature: ");
-      Serial.print(temperature);
-      Serial.print(" °C, Humidity: ");
-      Serial.print(humidity);
-      Serial.print(" %, Light: ");
-      Serial.print(light);  // Print raw analog value
-      Serial.print(" lux, Moisture: ");
-      Serial.print(moisture);  // Print raw analog value
-      Serial.println(" %");  // Removed extra comma
-      vTaskDelay(2000 / portTICK_PERIOD_MS);
+      taskSupervisor.checkIn(supSerialSlot);
+      // Everything between here and the delay is CPU busy time for the
+      // energy ledger; the 2s sleep in between is the idle baseline
+      const int64_t busyStartUs = esp_timer_get_time();
+      const SensorSnapshot s = readSensorSnapshot();
+      // Ring fill feeds the pressure level once per pass, before this
+      // pass adds to it
+      backpressure.noteQueueFill(telemetryBuffer.size(),
+                                 telemetryBuffer.capacity());
+      // Every sample joins the window aggregate, published-or-not; the
+      // stats object goes out once per flush window
+      windowStats.add(s.temperature, s.humidity, s.light, s.moisture);
+
+      if (WiFi.status() != WL_CONNECTED) {
+        // Offline: queue the sample instead of losing it
+        TelemetryRecord rec = {s.acquiredMs, s.temperature, s.humidity, s.light, s.moisture};
+        telemetryBuffer.push(rec);
+        if (offlineSince == 0) {
+            offlineSince = millis();
+        } else if (millis() - offlineSince > 30000UL) {
+            // Outage looks long-lived: checkpoint the backlog to flash
+            telemetryBuffer.persist();
+            offlineSince = millis();
+        }
+      } else {
+        offlineSince = 0;
+        reportBootProfile();
+        reportCrashSummary();
+        linkScheduler.sample(WiFi.RSSI());
+        // Roaming engine shares the RSSI cadence: scans while the
+        // signal degrades, hands off before the link drops
+        wifiRoam.loop(millis());
+        if (linkScheduler.flushCycle()) {
+            // Full clock for the burst: publishes, serialization and any
+            // TLS work race to idle instead of stretching the radio
+            // on-time at the DFS floor
+            powerManager.netBurstBegin();
+            // Back online: the live sample joins the queue tail, then the
+            // drain sends as much as the publish budget allows (bounded
+            // per cycle so we do not hog the MQTT client either)
+            TelemetryRecord rec = {s.acquiredMs, s.temperature, s.humidity, s.light, s.moisture};
+            telemetryBuffer.push(rec);
+            publishBudget.refill(runtimeConfig.get(cfgPublishPerMin), millis());
+            // A merge held over from an earlier dry bucket goes out first
+            if (publishBudget.hasMerged() && publishBudget.tryTake()) {
+                TelemetryRecord merged;
+                publishBudget.takeMerged(merged);
+                publishBufferedRecord(merged);
+            }
+            for (int i = 0; i < 8 && telemetryBuffer.pop(rec); i++) {
+                if (publishBudget.tryTake()) {
+                    publishBufferedRecord(rec);
+                } else {
+                    // Over quota: fold the record into one averaged
+                    // summary record instead of dropping it or handing
+                    // the broker a reason to throttle us
+                    publishBudget.merge(rec);
+                }
+            }
+            exportWindowStats();
+            exportLatencyHistogram();
+            exportHeapStats();
+            exportMqttRxStats();
+            exportEnergyReport();
+            exportActuatorStats();
+            exportLinkStats();
+            exportPublishBudget();
+            powerManager.netBurstEnd();
+        } else {
+            // Degraded link, non-flush pass: buffer the sample instead
+            // of trickling onto the congested channel; the next flush
+            // sends the accumulated records back to back
+            TelemetryRecord rec = {s.acquiredMs, s.temperature, s.humidity, s.light, s.moisture};
+            telemetryBuffer.push(rec);
+        }
+      }
+      // Deferred enqueue: taskLogDrain formats and owns the UART, this
+      // task only stores the format pointer and four floats
+      LOG_DEBUG("Temperature: %.2f C, Humidity: %.2f %%, Light: %.0f lux, Moisture: %.0f %%",
+                s.temperature, s.humidity, s.light, s.moisture);
+      energyMonitor.accountUs(EnergyMonitor::CPU,
+                              (uint32_t)(esp_timer_get_time() - busyStartUs));
+      // Config-driven cadence, stretched by the link scheduler when the
+      // WiFi link is degraded (2x on FAIR, 4x on POOR) and by the
+      // backpressure level when the pipeline is backing up. Max of the
+      // two, not the product - congestion usually raises both signals
+      // at once. A telemetryMs update notifies this task, so the new
+      // interval applies immediately instead of after the remainder of
+      // the old sleep.
+      const uint32_t linkStretch = linkScheduler.intervalMultiplier();
+      const uint32_t pressureStretch = backpressure.intervalMultiplier();
+      ulTaskNotifyTake(pdTRUE,
+                       (uint32_t)runtimeConfig.get(cfgTelemetryMs) *
+                           (linkStretch > pressureStretch ? linkStretch
+                                                          : pressureStretch) /
+                           portTICK_PERIOD_MS);
     }
 }
 
+// Jump table for the binary command set, indexed by command id. The
+// decode cost per command is one COBS pass plus a CRC over two bytes —
+// a handful of microseconds against the hundreds the JSON path costs —
+// which is what lets gateway-attached nodes take hundreds of commands
+// a minute without starving the other net-core tasks.
+static void binaryCmdLed(uint8_t value) {
+    actuatorQueue.submit(ACT_LED, value != 0, ACT_PRIO_LOCAL);
+}
+#if PROFILE_HAS_CONTROL
+static void binaryCmdPump(uint8_t value) {
+    autoControlEnabled = false;  // manual override wins, as on the JSON path
+    actuatorJournal.recordAuto(false);
+    actuatorQueue.submit(ACT_PUMP, value != 0, ACT_PRIO_LOCAL);
+}
+static void binaryCmdFan(uint8_t value) {
+    autoControlEnabled = false;
+    actuatorJournal.recordAuto(false);
+    actuatorQueue.submit(ACT_FAN, value != 0, ACT_PRIO_LOCAL);
+}
+static void binaryCmdAuto(uint8_t value) {
+    autoControlEnabled = value != 0;
+    actuatorJournal.recordAuto(value != 0);
+}
+static void binaryCmdStop(uint8_t value) {
+    actuatorQueue.submit(ACT_ALL_STOP, false, ACT_PRIO_SAFETY);
+}
+#endif
+
+static void (*const binaryCmdHandlers[SerialProtocol::CMD_COUNT])(uint8_t) = {
+    NULL,           // CMD_NONE
+    binaryCmdLed,   // CMD_LED
+#if PROFILE_HAS_CONTROL
+    binaryCmdPump,  // CMD_PUMP
+    binaryCmdFan,   // CMD_FAN
+    binaryCmdAuto,  // CMD_AUTO
+    binaryCmdStop,  // CMD_STOP
+#else
+    NULL, NULL, NULL, NULL,
+#endif
+};
+
 void taskSerialCommand(void *parameter) {
-    StaticJsonDocument<64> doc;
-    String input;
+    // Sized for the config object form ({"cfg":{...}} with credentials);
+    // the switch/pump commands use a fraction of it
+    StaticJsonDocument<192> doc;
+    // Fixed line buffer: no String reallocation per received byte, so the
+    // command path never touches the heap (no fragmentation over long uptimes)
+    static char input[128];
+    size_t inputLen = 0;
+    // The first byte of a buffered command decides the decoder: '{'
+    // starts a JSON line (terminated by '\n', never contains 0x00),
+    // anything else starts a COBS frame (terminated by 0x00, may
+    // contain '\n' in its payload)
+    bool binaryFrame = false;
+    uint32_t binaryBadFrames = 0;
     while (1) {
+        // Block until the receive hook signals data; serial is the
+        // emergency local control path, so commands parse within the
+        // driver's delivery latency instead of a 10ms poll period
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         while (Serial.available()) {
             char c = Serial.read();
+            if (inputLen == 0) {
+                // Stray line endings and idle frame delimiters between
+                // commands stay ignored
+                if (c == '\n' || c == '\r' || (uint8_t)c == 0x00) {
+                    continue;
+                }
+                binaryFrame = (c != '{');
+            }
+            if (binaryFrame) {
+                if ((uint8_t)c == 0x00) {
+                    BinaryCommand cmd;
+                    if (inputLen < sizeof(input) &&
+                        SerialProtocol::decodeFrame((const uint8_t *)input, inputLen, cmd) &&
+                        binaryCmdHandlers[cmd.id] != NULL) {
+                        binaryCmdHandlers[cmd.id](cmd.value);
+                    } else if (++binaryBadFrames % 100 == 1) {
+                        // Noise costs one frame and resyncs at the
+                        // delimiter; only every 100th is worth a line
+                        LOG_WARN("[CMD] %lu bad binary frames",
+                                 (unsigned long)binaryBadFrames);
+                    }
+                    inputLen = 0;
+                } else if (inputLen < sizeof(input)) {
+                    input[inputLen++] = c;
+                } else {
+                    // Overlong garbage: keep discarding until the next
+                    // delimiter closes the frame as bad
+                    inputLen = sizeof(input);
+                }
+                continue;
+            }
             if (c == '\n') {
                 // Đã nhận đủ 1 dòng
-                DeserializationError err = deserializeJson(doc, input);
-                if (!err && doc.containsKey("switch")) {
-                    bool sw = doc["switch"];
-                    digitalWrite(LED_PIN, sw ? HIGH : LOW);
+                input[inputLen] = '\0';
+                DeserializationError err = deserializeJson(doc, input, inputLen);
+                // Hash the member keys once; the probe chain below then
+                // dispatches on compile-time hashes instead of a strcmp
+                // walk per containsKey (see json_key_index.h)
+                JsonKeyIndex cmdKeys;
+                if (!err) {
+                    cmdKeys.build(doc.as<JsonObjectConst>());
+                }
+                if (!err && cmdKeys.has(JSON_KEY("switch"))) {
+                    bool sw = cmdKeys.get(JSON_KEY("switch"));
+                    actuatorQueue.submit(ACT_LED, sw, ACT_PRIO_LOCAL);
                     Serial.printf("Set LED by serial: %s\n", sw ? "ON" : "OFF");
                 }
-                if (!err && doc.containsKey("pump")) {
-                    bool sw = doc["pump"];
-                    digitalWrite(PUMP_MOTOR, sw ? HIGH : LOW);
+#if PROFILE_HAS_CONTROL
+                if (!err && cmdKeys.has(JSON_KEY("stop"))) {
+                    // Safety tier: applied ahead of anything already
+                    // queued, and disables the control loop until an
+                    // operator sends {"auto":true}
+                    actuatorQueue.submit(ACT_ALL_STOP, false, ACT_PRIO_SAFETY);
+                    Serial.println("EMERGENCY STOP queued");
+                }
+                if (!err && cmdKeys.has(JSON_KEY("pump"))) {
+                    bool sw = cmdKeys.get(JSON_KEY("pump"));
+                    autoControlEnabled = false;  // manual override wins
+                    actuatorJournal.recordAuto(false);
+                    actuatorQueue.submit(ACT_PUMP, sw, ACT_PRIO_LOCAL);
                     Serial.printf("Set Pump by serial: %s\n", sw ? "ON" : "OFF");
                 }
-                if (!err && doc.containsKey("fan")) {
-                    bool sw = doc["fan"];
-                    digitalWrite(FAN_MOTOR, sw ? HIGH : LOW);
+                if (!err && cmdKeys.has(JSON_KEY("fan"))) {
+                    bool sw = cmdKeys.get(JSON_KEY("fan"));
+                    autoControlEnabled = false;  // manual override wins
+                    actuatorJournal.recordAuto(false);
+                    actuatorQueue.submit(ACT_FAN, sw, ACT_PRIO_LOCAL);
                     Serial.printf("Set Fan by serial: %s\n", sw ? "ON" : "OFF");
                 }
+                if (!err && cmdKeys.has(JSON_KEY("auto"))) {
+                    autoControlEnabled = cmdKeys.get(JSON_KEY("auto"));
+                    actuatorJournal.recordAuto(autoControlEnabled);
+                    Serial.printf("Auto control: %s\n", autoControlEnabled ? "ON" : "OFF");
+                }
+#endif
+                if (!err && cmdKeys.has(JSON_KEY("cfg"))) {
+                    // Runtime config over the local channel, e.g.
+                    // {"cfg":{"telemetryMs":5000}} or
+                    // {"cfg":{"wifiSsid":"farm2","wifiPass":"..."}}.
+                    // Numeric keys go through the validated float path,
+                    // strings through the credential store.
+                    bool wifiChanged = false;
+                    for (JsonPairConst kv : cmdKeys.get(JSON_KEY("cfg")).as<JsonObjectConst>()) {
+                        if (kv.value().is<const char*>()) {
+                            if (runtimeConfig.setString(kv.key().c_str(), kv.value().as<const char*>())) {
+                                Serial.printf("Config %s stored\n", kv.key().c_str());
+                                if (strncmp(kv.key().c_str(), "wifi", 4) == 0) {
+                                    wifiChanged = true;
+                                }
+                            } else {
+                                Serial.printf("Config %s rejected\n", kv.key().c_str());
+                            }
+                        } else if (runtimeConfig.set(kv.key().c_str(), kv.value().as<float>())) {
+                            Serial.printf("Config %s = %.2f\n", kv.key().c_str(), kv.value().as<float>());
+                        } else {
+                            Serial.printf("Config %s rejected\n", kv.key().c_str());
+                        }
+                    }
+                    if (wifiChanged) {
+                        applyWifiCredentials();
+                    }
+                }
+
+                inputLen = 0;
+            } else if (inputLen < sizeof(input) - 1) {
+                input[inputLen++] = c;
+            }
+            // Bytes beyond the buffer are dropped until the next newline
+        }
+    }
+}
+
+// The DHT20 transactions, as bus-task descriptors. The library keeps
+// its raw bits private, so the library call itself runs on the bus
+// task; getTemperature()/getHumidity() touch no wires and stay in
+// taskDHT20. isMeasuring's status read is a bus transaction too.
+#if DHT20_MUX_CHANNELS > 0
+// Array variants: same contract as the single-probe callbacks below,
+// so taskDHT20's state machine is identical either way. The read
+// succeeds when at least one probe read clean; the snapshot then
+// carries the array mean.
+static int dhtRequestOnBus(void *) { return dht20Mux.requestAll() > 0 ? 0 : -1; }
+static int dhtIsMeasuringOnBus(void *) { return dht20Mux.anyMeasuring() ? 1 : 0; }
+static int dhtReadOnBus(void *) { return dht20Mux.readAll() > 0 ? DHT20_OK : -1; }
+#else
+static int dhtRequestOnBus(void *) { return dht20.requestData(); }
+static int dhtIsMeasuringOnBus(void *) { return dht20.isMeasuring() ? 1 : 0; }
+static int dhtReadOnBus(void *) {
+    if (dht20.readData() > 0 && dht20.convert() == DHT20_OK) {
+        return DHT20_OK;
+    }
+    return -1;
+}
+#endif
+
+// One acquisition pass over the ADC-backed fields due in this merged
+// window. Calibration applies at acquisition, so everything downstream
+// (control loop, telemetry, backlog) sees lux and percent instead of
+// raw counts; the channel filters decide whether the smoothed value
+// moved enough to publish.
+static void sampleAdcDue(uint8_t dueMask, SensorSnapshot &s) {
+    const bool wantLight =
+        (dueMask & SampleScheduler::fieldBit(SampleScheduler::FIELD_LIGHT)) != 0;
+    const bool wantMoisture =
+        (dueMask & SampleScheduler::fieldBit(SampleScheduler::FIELD_MOISTURE)) != 0;
+    if (!wantLight && !wantMoisture) {
+        return;
+    }
+    int32_t rawLight = 0;
+    int32_t rawMoisture = 0;
+    if (adcSampler.ready()) {
+        if (burstCapture.sampling()) {
+            // The burst pump owns the DMA drain for the few seconds a
+            // capture window runs; the filters hold their last values
+            return;
+        }
+        // DMA mode: drain the ring and take the averaged values
+        adcSampler.poll();
+        if (wantLight) rawLight = (int32_t)adcSampler.takeLight();
+        if (wantMoisture) rawMoisture = (int32_t)adcSampler.takeMoisture();
+    } else {
+        energyMonitor.windowBegin(EnergyMonitor::ADC);
+        if (wantLight) rawLight = analogRead(LIGHT_SENSOR_PIN);  // Fallback: single read
+        if (wantMoisture) rawMoisture = analogRead(MOISTURE_PIN);
+        energyMonitor.windowEnd(EnergyMonitor::ADC);
+    }
+    if (wantLight) {
+        lightFilter.apply((float)lightCal.apply(rawLight), s.light);
+    }
+    if (wantMoisture) {
+        // Centi-percent to percent: multiply, not divide
+        moistureFilter.apply(moistureCal.apply(rawMoisture) * 0.01f, s.moisture);
+    }
+}
 
-                input = "";
-            } else {
-                input += c;
+// Run the alert rules over a fresh snapshot: O(rules) integer
+// comparisons on the common pass, so it sits inline in the sampling
+// pipeline and a crossing is announced within one sample period.
+// Thresholds are read from the runtime config each pass - a retuned
+// sector row applies on the very next sample.
+static void evaluateThresholdRules(const SensorSnapshot &s) {
+    const float values[ThresholdRules::FIELD_COUNT] = {
+        s.temperature, s.humidity, s.light, s.moisture};
+    float thresholds[ThresholdRules::RULE_COUNT];
+    for (int r = 0; r < ThresholdRules::RULE_COUNT; r++) {
+        thresholds[r] = runtimeConfig.get(cfgAlertSlot[r]);
+    }
+    ThresholdRules::Event events[ThresholdRules::RULE_COUNT];
+    const int count = thresholdRules.evaluate(values, thresholds, events,
+                                              ThresholdRules::RULE_COUNT);
+    for (int i = 0; i < count; i++) {
+        const ThresholdRules::Event &e = events[i];
+        LOG_WARN("[ALERT] %s %s (value %.1f, threshold %.1f)",
+                 ThresholdRules::ruleKey(e.rule),
+                 e.fired ? "fired" : "cleared", e.value, e.threshold);
+        if (WiFi.status() == WL_CONNECTED) {
+            char payload[128];
+            snprintf(payload, sizeof(payload),
+                "{\"thresholdAlert\":\"%s\",\"fired\":%s,\"value\":%.2f,\"threshold\":%.2f}",
+                ThresholdRules::ruleKey(e.rule), e.fired ? "true" : "false",
+                e.value, e.threshold);
+            sendAlertTelemetry(payload);
+        }
+#if PROFILE_HAS_CONTROL
+        // Actuation backstop: with the auto loop disabled (manual or
+        // cloud control), a fired rule still drives the matching output
+        // locally instead of waiting for an operator. The auto loop owns
+        // the outputs whenever it is enabled - its hysteresis and the
+        // rules' would fight over different setpoints otherwise.
+        if (e.fired && !autoControlEnabled) {
+            if (e.rule == ThresholdRules::RULE_TEMP_HI) {
+                actuatorQueue.submit(ACT_FAN, true, ACT_PRIO_LOCAL);
+            } else if (e.rule == ThresholdRules::RULE_MOIST_LO) {
+                actuatorQueue.submit(ACT_PUMP, true, ACT_PRIO_LOCAL);
             }
         }
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+#endif
     }
 }
 
+#if DHT20_MUX_CHANNELS > 0
+// Per-probe diagnostic export, every Nth climate window: the mean in
+// the regular record shows the canopy, this payload shows the spread
+// (a failing probe, a bench edge running hot). Absent probes publish
+// nothing, probes whose last read failed publish their status code.
+static void exportProbeArray() {
+    static const uint32_t PROBE_EXPORT_CYCLES = 30;
+    static uint32_t cycles = 0;
+    if (++cycles < PROBE_EXPORT_CYCLES || WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+    cycles = 0;
+    char payload[384];
+    size_t used = snprintf(payload, sizeof(payload), "{");
+    for (int ch = 0; ch < DHT20_MUX_CHANNELS; ch++) {
+        if (!(dht20Mux.presentMask() & (1 << ch)) || used >= sizeof(payload)) {
+            continue;
+        }
+        if (dht20Mux.status(ch) == DHT20_OK) {
+            used += snprintf(payload + used, sizeof(payload) - used,
+                "%s\"probeT%d\":%.2f,\"probeH%d\":%.2f", used > 1 ? "," : "",
+                ch, dht20Mux.temperature(ch), ch, dht20Mux.humidity(ch));
+        } else {
+            used += snprintf(payload + used, sizeof(payload) - used,
+                "%s\"probeErr%d\":%d", used > 1 ? "," : "",
+                ch, dht20Mux.status(ch));
+        }
+    }
+    if (used < sizeof(payload) - 1) {
+        snprintf(payload + used, sizeof(payload) - used, "}");
+        sendTelemetryAccounted(payload);
+    }
+}
+#endif  // DHT20_MUX_CHANNELS > 0
+
+// Asynchronous sampling on the per-field schedule: sleep until the
+// earliest due field, collect everything due in the merge window, and
+// publish the window as one snapshot write. A window with the climate
+// pair runs the DHT20 state machine — trigger with requestData(),
+// yield during the sensor's ~80ms conversion, fetch and convert — and
+// the due ADC fields ride along when the readout lands; an ADC-only
+// window is instant. Every I2C transaction goes through the bus queue
+// so NFC traffic can interleave safely between trigger and fetch.
 void taskDHT20(void *parameter) {
+    enum DhtState { DHT_IDLE, DHT_MEASURING };
+    DhtState state = DHT_IDLE;
+    uint8_t dueMask = 0;
+    // Reused completion semaphore for this task's submissions
+    SemaphoreHandle_t busDone = xSemaphoreCreateBinary();
+
     while (true) {
-        dht20.read();
-        temperature = dht20.getTemperature();
-        humidity = dht20.getHumidity();
-        light = analogRead(LIGHT_SENSOR_PIN);  // Read analog value from light sensor
-        moisture = analogRead(MOISTURE_PIN);  // Read analog value from light sensor
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        taskSupervisor.checkIn(supDht20Slot);
+        switch (state) {
+            case DHT_IDLE: {
+                const uint32_t wait = sampleScheduler.nextDelayMs(millis());
+                if (wait > 0) {
+                    // Capped so the supervisor check-in keeps its cadence
+                    vTaskDelay((wait < 500 ? wait : 500) / portTICK_PERIOD_MS);
+                    break;
+                }
+                dueMask = sampleScheduler.collectDue(millis());
+                if (dueMask & SampleScheduler::fieldBit(SampleScheduler::FIELD_CLIMATE)) {
+                    if (i2cBus.runOnBus(dhtRequestOnBus, NULL, busDone, 100) == 0) {
+                        // The sensor draws its measuring current from the
+                        // trigger until the readout below collects the bits
+                        energyMonitor.windowBegin(EnergyMonitor::SENSOR);
+                        state = DHT_MEASURING;
+                    }
+                    // Datasheet: measurement takes max 80ms after trigger
+                    vTaskDelay(80 / portTICK_PERIOD_MS);
+                } else {
+                    SensorSnapshot s = readSensorSnapshot();
+                    sampleAdcDue(dueMask, s);
+                    // Latency measurements count from this moment
+                    s.acquiredMs = millis();
+                    publishSensorSnapshot(s);
+                    evaluateThresholdRules(s);
+                }
+                break;
+            }
+
+            case DHT_MEASURING:
+                if (i2cBus.runOnBus(dhtIsMeasuringOnBus, NULL, busDone, 100) == 1) {
+                    // Sensor not done yet, yield a bit longer
+                    vTaskDelay(10 / portTICK_PERIOD_MS);
+                    break;
+                }
+                {
+                    SensorSnapshot s = readSensorSnapshot();
+                    if (i2cBus.runOnBus(dhtReadOnBus, NULL, busDone, 200) == DHT20_OK) {
+#if DHT20_MUX_CHANNELS > 0
+                        // Single-value consumers get the canopy mean;
+                        // the per-probe picture goes out periodically
+                        tempFilter.apply(dht20Mux.meanTemperature(), s.temperature);
+                        humFilter.apply(dht20Mux.meanHumidity(), s.humidity);
+                        exportProbeArray();
+#else
+                        tempFilter.apply(dht20.getTemperature(), s.temperature);
+                        humFilter.apply(dht20.getHumidity(), s.humidity);
+#endif
+                    }
+                    energyMonitor.windowEnd(EnergyMonitor::SENSOR);
+                    // ADC fields merged into this window share the
+                    // climate pair's snapshot write
+                    sampleAdcDue(dueMask, s);
+                    // Latency measurements count from this moment
+                    s.acquiredMs = millis();
+                    publishSensorSnapshot(s);
+                    evaluateThresholdRules(s);
+                }
+                state = DHT_IDLE;
+                break;
+        }
+    }
+}
+
+#if PROFILE_HAS_CONTROL
+// Closed-loop pump/fan control from the local readings. Runs every 500ms
+// so control latency is bounded by the sample rate, not the network.
+void taskControl(void *parameter) {
+    while (1) {
+        taskSupervisor.checkIn(supControlSlot);
+        // Running pump cycles checkpoint their elapsed time so a reboot
+        // knows how much budget is left (wear-bounded inside the journal)
+        actuatorJournal.checkpointPumpRun();
+        if (pumpResumeDeadlineMs != 0 && pumpState &&
+            (int32_t)(millis() - pumpResumeDeadlineMs) >= 0) {
+            // Resumed manual cycle exhausted its remaining budget
+            actuatorQueue.submit(ACT_PUMP, false, ACT_PRIO_LOCAL);
+            pumpResumeDeadlineMs = 0;
+            LOG_WARN("[CTRL] Resumed pump cycle hit its run-time cap");
+        }
+        if (autoControlEnabled) {
+            const SensorSnapshot s = readSensorSnapshot();
+            // Setpoints come from the runtime config each cycle: a
+            // retuned threshold applies on the next 500ms pass
+            const float pumpOnMoisture = runtimeConfig.get(cfgPumpOnPct);
+            const float pumpOffMoisture = runtimeConfig.get(cfgPumpOffPct);
+            const float fanOnTemperature = runtimeConfig.get(cfgFanOnC);
+            const float fanOffTemperature = runtimeConfig.get(cfgFanOffC);
+
+            // The forecast model samples at its own (training) cadence;
+            // offering every pass is a no-op between intervals
+            moistureModel.push(s.humidity, s.temperature, s.light,
+                               s.moisture, millis());
+            const float moistureAhead =
+                moistureModel.ready() ? moistureModel.predict() : s.moisture;
+
+            // Pump: hysteresis on soil moisture, with the ON edge also
+            // taken pre-emptively when the forecast sees the drying
+            // trend crossing the threshold next interval. OFF stays on
+            // the measured value only - never stop watering on a guess.
+            // The actuator task applies the command and updates
+            // pumpState within milliseconds, long before the next 500ms
+            // pass reads it.
+            if (!pumpState && s.moisture < pumpOnMoisture) {
+                actuatorQueue.submit(ACT_PUMP, true, ACT_PRIO_LOCAL);
+                LOG_INFO("[CTRL] Pump ON (moisture %.1f < %.1f)", s.moisture, pumpOnMoisture);
+            } else if (!pumpState && moistureAhead < pumpOnMoisture) {
+                actuatorQueue.submit(ACT_PUMP, true, ACT_PRIO_LOCAL);
+                LOG_INFO("[CTRL] Pump ON (forecast %.1f < %.1f, now %.1f)",
+                         moistureAhead, pumpOnMoisture, s.moisture);
+            } else if (pumpState && s.moisture > pumpOffMoisture) {
+                actuatorQueue.submit(ACT_PUMP, false, ACT_PRIO_LOCAL);
+                LOG_INFO("[CTRL] Pump OFF (moisture %.1f > %.1f)", s.moisture, pumpOffMoisture);
+            }
+
+            // Fan: hysteresis on temperature
+            if (!fanState && s.temperature > fanOnTemperature) {
+                actuatorQueue.submit(ACT_FAN, true, ACT_PRIO_LOCAL);
+                LOG_INFO("[CTRL] Fan ON (temp %.1f > %.1f)", s.temperature, fanOnTemperature);
+            } else if (fanState && s.temperature < fanOffTemperature) {
+                actuatorQueue.submit(ACT_FAN, false, ACT_PRIO_LOCAL);
+                LOG_INFO("[CTRL] Fan OFF (temp %.1f < %.1f)", s.temperature, fanOffTemperature);
+            }
+        }
+        vTaskDelay(500 / portTICK_PERIOD_MS);
+    }
+}
+#endif  // PROFILE_HAS_CONTROL
+
+// Sole consumer of the actuator command queue and, after setup(), the
+// only writer of the actuator GPIOs and their state flags. Serial, RPC
+// and the control loop only submit intent; ordering between the tiers
+// is enforced here, so a safety stop is applied before any backlog of
+// remote or local commands.
+void taskActuator(void *parameter) {
+    ActuatorCommand cmd;
+    while (1) {
+        if (!actuatorQueue.receive(cmd, 1000)) {
+            continue;
+        }
+        // Latency-exempt section: no light-sleep wakeup ramp between
+        // dequeuing a command and the GPIO write landing
+        powerManager.latencyBegin();
+        switch (cmd.target) {
+            case ACT_LED:
+                digitalWrite(LED_PIN, cmd.on ? HIGH : LOW);
+                ledState = cmd.on;
+                break;
+#if PROFILE_HAS_CONTROL
+            case ACT_PUMP:
+                digitalWrite(PUMP_MOTOR, cmd.on ? HIGH : LOW);
+                pumpState = cmd.on;
+                // Any fresh pump command supersedes a resumed cycle's cap
+                pumpResumeDeadlineMs = 0;
+                break;
+            case ACT_FAN:
+                digitalWrite(FAN_MOTOR, cmd.on ? HIGH : LOW);
+                fanState = cmd.on;
+                break;
+            case ACT_ALL_STOP:
+                // Everything off and the control loop disabled, so it
+                // cannot switch the pump back on a cycle later
+                autoControlEnabled = false;
+                digitalWrite(PUMP_MOTOR, LOW);
+                digitalWrite(FAN_MOTOR, LOW);
+                pumpState = false;
+                fanState = false;
+                LOG_WARN("[ACT] EMERGENCY STOP applied %lums after submit",
+                            (unsigned long)(millis() - cmd.enqueuedMs));
+                break;
+#endif
+            default:
+                break;
+        }
+        actuatorQueue.recordApplied(cmd);
+        // Journal after the write landed; only actual state flips touch NVS
+        actuatorJournal.record(cmd.target, cmd.on);
+        powerManager.latencyEnd();
     }
 }
 
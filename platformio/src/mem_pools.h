@@ -0,0 +1,86 @@
+#ifndef MEM_POOLS_H
+#define MEM_POOLS_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+// Allocation policy for the firmware's big buffers. Plain malloc lands
+// wherever the allocator decides, which on a PSRAM board means bulk
+// data can sit in scarce internal RAM while DMA-capable space - the
+// only kind WiFi descriptors and TLS records can use - fragments
+// underneath it. Routing every large allocation through here makes the
+// placement explicit: bulk goes to PSRAM when the board has it
+// (internal RAM as the fallback), DMA requests go to internal
+// DMA-capable RAM and never to PSRAM, and both pools count what they
+// hand out so the headroom shows up in telemetry instead of in a
+// failed allocation.
+//
+// Allocations here are boot-time and long-lived (rings, backlogs);
+// nothing frees, so there is no free() path to get wrong.
+class MemPools {
+public:
+  bool psramPresent() const {
+    return heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+  }
+
+  // Bulk data: PSRAM first, internal RAM when the board has none.
+  // Large and latency-tolerant - a few hundred extra ns per access in
+  // PSRAM is free against the internal RAM it stops consuming.
+  void *allocBulk(size_t bytes) {
+    void *p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p != NULL) {
+      _bulkPsramBytes += bytes;
+      return p;
+    }
+    p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (p != NULL) {
+      _bulkInternalBytes += bytes;
+      return p;
+    }
+    _failures++;
+    return NULL;
+  }
+
+  // DMA-capable buffers: internal RAM only, PSRAM is not an option for
+  // the peripherals however full internal gets.
+  void *allocDma(size_t bytes) {
+    void *p = heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (p != NULL) {
+      _dmaBytes += bytes;
+      return p;
+    }
+    _failures++;
+    return NULL;
+  }
+
+  uint32_t bulkPsramBytes() const { return _bulkPsramBytes; }
+  uint32_t bulkInternalBytes() const { return _bulkInternalBytes; }
+  uint32_t dmaBytes() const { return _dmaBytes; }
+  uint32_t failures() const { return _failures; }
+
+  // One JSON telemetry object: what each pool has handed out plus the
+  // headroom that matters per pool - free PSRAM for bulk, the largest
+  // DMA-capable block for the peripherals:
+  //   {"memBulkPsram":a,"memBulkInt":b,"memDma":c,"memPoolFail":f,
+  //    "psramFree":p,"dmaLargest":d}
+  size_t serialize(char *buf, size_t cap) const {
+    size_t len = snprintf(buf, cap,
+        "{\"memBulkPsram\":%lu,\"memBulkInt\":%lu,\"memDma\":%lu,"
+        "\"memPoolFail\":%lu,\"psramFree\":%lu,\"dmaLargest\":%lu}",
+        (unsigned long)_bulkPsramBytes,
+        (unsigned long)_bulkInternalBytes,
+        (unsigned long)_dmaBytes,
+        (unsigned long)_failures,
+        (unsigned long)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+        (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_DMA));
+    return len < cap ? len : cap - 1;
+  }
+
+private:
+  uint32_t _bulkPsramBytes = 0;
+  uint32_t _bulkInternalBytes = 0;
+  uint32_t _dmaBytes = 0;
+  uint32_t _failures = 0;
+};
+
+#endif // MEM_POOLS_H
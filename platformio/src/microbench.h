@@ -0,0 +1,135 @@
+/**
+ * Header-only microbenchmark framework for the host-native suite
+ * (src/bench_native_main.cpp, built by env:native).
+ *
+ * Google-Benchmark-style registration and measurement without the
+ * dependency: benchmarks are functions taking a BenchState and looping
+ * on state.KeepRunning(), registered with the BENCHMARK() macro and run
+ * by runAllBenchmarks(). Iteration counts auto-calibrate — batches grow
+ * geometrically until a benchmark has run for at least 300ms of wall
+ * clock — so each row is an average over enough iterations to be stable
+ * without per-benchmark tuning.
+ *
+ * Results print as one aligned row per benchmark (name, ns/iteration,
+ * iterations) plus a machine-readable "BENCH,..." CSV line in the same
+ * shape the on-device harness (benchmark_main.cpp) emits, so the same
+ * CI scraping works for both.
+ *
+ * Host-only: uses std::chrono steady_clock and std::vector, and is not
+ * included by any device build.
+ */
+
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace microbench {
+
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Prevents the compiler from deleting a benchmarked computation whose
+// result is otherwise unused
+template <typename T>
+inline void DoNotOptimize(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class BenchState {
+public:
+    // Drives the measurement loop: returns true while more iterations
+    // are needed. Batches quadruple until the benchmark has accumulated
+    // kMinRunNs of wall time, so the loop condition itself is a memory
+    // read on all but the batch-boundary iterations.
+    bool KeepRunning() {
+        if (remaining_ > 0) {
+            remaining_--;
+            return true;
+        }
+        const int64_t now = nowNs();
+        if (started_) {
+            elapsedNs_ = now - startNs_;
+            if (elapsedNs_ >= kMinRunNs) {
+                return false;
+            }
+            batch_ *= 4;
+        } else {
+            started_ = true;
+            startNs_ = now;
+            batch_ = 1;
+        }
+        iterations_ += batch_;
+        remaining_ = batch_ - 1;
+        return true;
+    }
+
+    int64_t iterations() const { return iterations_; }
+    int64_t elapsedNs() const { return elapsedNs_; }
+    int64_t nsPerIteration() const {
+        return iterations_ > 0 ? elapsedNs_ / iterations_ : 0;
+    }
+
+private:
+    static constexpr int64_t kMinRunNs = 300 * 1000 * 1000LL;
+
+    bool started_ = false;
+    int64_t startNs_ = 0;
+    int64_t elapsedNs_ = 0;
+    int64_t batch_ = 0;
+    int64_t remaining_ = 0;
+    int64_t iterations_ = 0;
+};
+
+typedef void (*BenchFn)(BenchState &);
+
+struct BenchCase {
+    const char *name;
+    BenchFn fn;
+};
+
+inline std::vector<BenchCase> &registry() {
+    static std::vector<BenchCase> cases;
+    return cases;
+}
+
+struct Registrar {
+    Registrar(const char *name, BenchFn fn) { registry().push_back({name, fn}); }
+};
+
+inline int runAllBenchmarks() {
+    std::vector<BenchState> results(registry().size());
+    printf("%-32s %12s %16s\n", "Benchmark", "Time", "Iterations");
+    printf("--------------------------------------------------------------\n");
+    for (size_t i = 0; i < registry().size(); i++) {
+        registry()[i].fn(results[i]);
+        printf("%-32s %9lld ns %16lld\n", registry()[i].name,
+               (long long)results[i].nsPerIteration(),
+               (long long)results[i].iterations());
+        fflush(stdout);
+    }
+    printf("\n");
+    // Same CSV rows the on-device harness prints over serial, minus the
+    // cycle column the host cannot fill in comparably
+    for (size_t i = 0; i < registry().size(); i++) {
+        printf("BENCH,%s,%lld,%lld,%lld,0,OK\n", registry()[i].name,
+               (long long)results[i].iterations(),
+               (long long)(results[i].elapsedNs() / 1000),
+               (long long)results[i].nsPerIteration());
+    }
+    printf("BENCH_END\n");
+    return 0;
+}
+
+}  // namespace microbench
+
+#define BENCHMARK(fn) \
+    static microbench::Registrar benchRegistrar_##fn(#fn, fn)
+
+#endif // MICROBENCH_H
@@ -0,0 +1,176 @@
+#ifndef NVS_JOURNAL_H
+#define NVS_JOURNAL_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// Write-behind journal for NVS state writes.
+//
+// Every persistent feature (actuator journal, runtime config, WiFi
+// fast-connect cache) writes NVS from whichever task the state change
+// happens on, and each put commits through a flash write that can
+// stall the caller for tens of milliseconds when a page erase is due.
+// That stall is harmless on the housekeeping worker but not on the
+// control loop, and a burst of changes (a shared-attribute dump
+// retuning six knobs, a reconnect refreshing the whole WiFi cache)
+// pays it once per key.
+//
+// Writers stage their puts here instead: the new value lands in a
+// small RAM table immediately and flush() — run as a housekeeping job
+// — performs the actual NVS writes back-to-back off the hot tasks.
+// Restaging a key before the flush overwrites the pending slot, so a
+// value changed five times between flushes costs one flash write
+// (checkpoint counters wear the flash by flush cadence, not by update
+// rate). barrier() is the synchronous path for writes that must be
+// durable before the caller proceeds (the actuator journal's safety
+// stops): it flushes everything pending from the calling task, paying
+// the stall knowingly.
+//
+// Keys must be string literals or otherwise outlive the flush (they
+// are in every current writer); bytes beyond INLINE_BYTES are staged
+// by reference and the pointed-at memory must stay valid and current
+// until flushed. A full table degrades to an inline flush rather than
+// dropping a write.
+class NvsJournal {
+public:
+  static const int MAX_PENDING = 16;
+  static const size_t INLINE_BYTES = 8;
+
+  void stageFloat(Preferences *prefs, const char *key, float value) {
+    Pending p = {prefs, key, T_F32, 0, {}, {}};
+    p.value.f = value;
+    stage(p);
+  }
+
+  void stageU8(Preferences *prefs, const char *key, uint8_t value) {
+    Pending p = {prefs, key, T_U8, 0, {}, {}};
+    p.value.u8 = value;
+    stage(p);
+  }
+
+  void stageU32(Preferences *prefs, const char *key, uint32_t value) {
+    Pending p = {prefs, key, T_U32, 0, {}, {}};
+    p.value.u32 = value;
+    stage(p);
+  }
+
+  void stageI32(Preferences *prefs, const char *key, int32_t value) {
+    Pending p = {prefs, key, T_I32, 0, {}, {}};
+    p.value.i32 = value;
+    stage(p);
+  }
+
+  void stageBytes(Preferences *prefs, const char *key, const void *data, size_t len) {
+    Pending p = {prefs, key, T_BYTES, (uint8_t)len, {}, {}};
+    if (len <= INLINE_BYTES) {
+      memcpy(p.inlineBytes, data, len);
+    } else {
+      p.value.ext = data;  // caller-owned, must outlive the flush
+    }
+    stage(p);
+  }
+
+  // Write everything staged to NVS. Called from the housekeeping job;
+  // also the body of barrier(). Returns false when any put failed.
+  bool flush() {
+    Pending batch[MAX_PENDING];
+    int count;
+    portENTER_CRITICAL(&_mux);
+    count = _count;
+    memcpy(batch, _pending, sizeof(Pending) * count);
+    _count = 0;
+    // Counter bumped while the lock is held: an overflow flush on a hot
+    // task can run concurrently with the housekeeping flush
+    _flushedWrites += count;
+    portEXIT_CRITICAL(&_mux);
+
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+      ok = write(batch[i]) && ok;
+    }
+    return ok;
+  }
+
+  // Synchronous durability point: the caller eats the flash stall so
+  // its write is on flash when this returns
+  bool barrier() { return flush(); }
+
+  // Writes collapsed by restaging a pending key — each one is a flash
+  // write (and its wear) that never happened
+  uint32_t coalesced() const { return _coalesced; }
+  uint32_t flushedWrites() const { return _flushedWrites; }
+  // Inline flushes forced by a full table; above zero means MAX_PENDING
+  // is undersized for a real burst
+  uint32_t overflowFlushes() const { return _overflowFlushes; }
+
+private:
+  enum Type : uint8_t { T_F32, T_U8, T_U32, T_I32, T_BYTES };
+
+  struct Pending {
+    Preferences *prefs;
+    const char *key;
+    Type type;
+    uint8_t len;  // T_BYTES only
+    union {
+      float f;
+      uint8_t u8;
+      uint32_t u32;
+      int32_t i32;
+      const void *ext;
+    } value;
+    uint8_t inlineBytes[INLINE_BYTES];
+  };
+
+  void stage(const Pending &p) {
+    portENTER_CRITICAL(&_mux);
+    // Restaging a pending key replaces its value: one flash write per
+    // flush interval however often the state changes
+    for (int i = 0; i < _count; i++) {
+      if (_pending[i].prefs == p.prefs && strcmp(_pending[i].key, p.key) == 0) {
+        _pending[i] = p;
+        _coalesced++;
+        portEXIT_CRITICAL(&_mux);
+        return;
+      }
+    }
+    while (_count >= MAX_PENDING) {
+      // Never drop a state write: degrade to synchronous for this one.
+      // Other tasks can refill the table while the lock is dropped for
+      // the flush — overflow fires exactly during bursts — so re-check
+      // the full condition each time the lock is re-taken.
+      _overflowFlushes++;
+      portEXIT_CRITICAL(&_mux);
+      flush();
+      portENTER_CRITICAL(&_mux);
+    }
+    _pending[_count++] = p;
+    portEXIT_CRITICAL(&_mux);
+  }
+
+  bool write(const Pending &p) {
+    switch (p.type) {
+      case T_F32:
+        return p.prefs->putFloat(p.key, p.value.f) == sizeof(float);
+      case T_U8:
+        return p.prefs->putUChar(p.key, p.value.u8) == sizeof(uint8_t);
+      case T_U32:
+        return p.prefs->putUInt(p.key, p.value.u32) == sizeof(uint32_t);
+      case T_I32:
+        return p.prefs->putInt(p.key, p.value.i32) == sizeof(int32_t);
+      case T_BYTES: {
+        const void *src = p.len <= INLINE_BYTES ? p.inlineBytes : p.value.ext;
+        return p.prefs->putBytes(p.key, src, p.len) == p.len;
+      }
+    }
+    return false;
+  }
+
+  Pending _pending[MAX_PENDING];
+  int _count = 0;
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  uint32_t _coalesced = 0;
+  uint32_t _flushedWrites = 0;
+  uint32_t _overflowFlushes = 0;
+};
+
+#endif // NVS_JOURNAL_H
@@ -0,0 +1,97 @@
+#ifndef PAYLOAD_CODEC_H
+#define PAYLOAD_CODEC_H
+
+#include <Arduino.h>
+
+// Transparent payload compression for large MQTT messages. Batched
+// telemetry and attribute dumps are highly repetitive JSON (the same
+// keys for every frame in a batch), so a byte-oriented LZSS with a 4KB
+// window shrinks them 3-4x with no tables and no heap: the compressor
+// searches back over the source buffer itself, so the only state is a
+// handful of locals.
+//
+// Wire format (backend/common/lzss.h mirrors this and must be kept in
+// sync): a 2-byte little-endian original length, then flag-byte groups.
+// Each flag byte covers the next 8 items LSB-first; a 1 bit is one
+// literal byte, a 0 bit is a 2-byte match token
+//   b0 = distance & 0xFF
+//   b1 = (distance >> 8) & 0x0F | (length - 3) << 4
+// with distance 1..4095 back and length 3..18. Compressed payloads go
+// out on the plain topic plus the PAYLOAD_LZ_TOPIC_SUFFIX, so both
+// encodings coexist during rollout exactly like the /bin frame topic.
+
+#define PAYLOAD_LZ_TOPIC_SUFFIX "/lz"
+
+// Below this size the MQTT/TCP overhead dominates and the flag bytes
+// can even grow the payload; the publish path sends smaller messages
+// uncompressed on the plain topic.
+#define PAYLOAD_LZ_MIN_BYTES 512
+
+#define PAYLOAD_LZ_WINDOW 4095
+#define PAYLOAD_LZ_MIN_MATCH 3
+#define PAYLOAD_LZ_MAX_MATCH 18
+
+// Compresses src into dst (including the length header). Returns the
+// compressed size, or 0 when the input is empty, longer than the 16-bit
+// header can describe, or the result would not fit in dstCap — callers
+// fall back to the uncompressed publish in that case.
+static inline size_t payloadCompress(const uint8_t *src, size_t srcLen,
+                                     uint8_t *dst, size_t dstCap) {
+  if (srcLen == 0 || srcLen > 0xFFFF || dstCap < 3) {
+    return 0;
+  }
+  dst[0] = (uint8_t)(srcLen & 0xFF);
+  dst[1] = (uint8_t)(srcLen >> 8);
+  size_t out = 2;
+
+  size_t pos = 0;
+  size_t flagPos = 0;
+  uint8_t flagBit = 0;
+  while (pos < srcLen) {
+    if (flagBit == 0) {
+      if (out >= dstCap) return 0;
+      flagPos = out;
+      dst[out++] = 0;
+      flagBit = 1;
+    }
+
+    // Greedy longest-match scan over the already-emitted bytes. The
+    // JSON keys repeat every ~60 bytes, so matches are found early;
+    // worst case is window * max_match byte compares per position,
+    // which a 1KB batch clears in well under a millisecond at 240MHz.
+    size_t bestLen = 0;
+    size_t bestDist = 0;
+    const size_t maxDist = pos < PAYLOAD_LZ_WINDOW ? pos : PAYLOAD_LZ_WINDOW;
+    const size_t maxLen = (srcLen - pos) < PAYLOAD_LZ_MAX_MATCH
+                              ? (srcLen - pos)
+                              : PAYLOAD_LZ_MAX_MATCH;
+    for (size_t dist = 1; dist <= maxDist; dist++) {
+      const uint8_t *back = src + pos - dist;
+      size_t len = 0;
+      while (len < maxLen && back[len] == src[pos + len]) {
+        len++;
+      }
+      if (len > bestLen) {
+        bestLen = len;
+        bestDist = dist;
+        if (len == maxLen) break;
+      }
+    }
+
+    if (bestLen >= PAYLOAD_LZ_MIN_MATCH) {
+      if (out + 2 > dstCap) return 0;
+      dst[out++] = (uint8_t)(bestDist & 0xFF);
+      dst[out++] = (uint8_t)(((bestDist >> 8) & 0x0F) |
+                             ((bestLen - PAYLOAD_LZ_MIN_MATCH) << 4));
+      pos += bestLen;
+    } else {
+      if (out >= dstCap) return 0;
+      dst[flagPos] |= flagBit;
+      dst[out++] = src[pos++];
+    }
+    flagBit <<= 1;
+  }
+  return out;
+}
+
+#endif // PAYLOAD_CODEC_H
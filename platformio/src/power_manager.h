@@ -0,0 +1,88 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <esp_pm.h>
+#include <esp_idf_version.h>
+
+// Tickless power management for the steady-state task set. Every task
+// is periodic with long idle gaps, so instead of burning 240MHz through
+// vTaskDelay ticks the idle task drops into automatic light sleep and
+// DFS parks the CPU at the low frequency until someone holds a lock.
+// The arduino-esp32 sdkconfig ships with CONFIG_PM_ENABLE and tickless
+// idle (CONFIG_FREERTOS_USE_TICKLESS_IDLE) enabled; should a build lack
+// them, esp_pm_configure fails and begin() degrades to full speed.
+//
+// Two locks shape the exceptions:
+//  - a CPU_FREQ_MAX lock around network bursts, so the publish drain
+//    and TLS work run at full clock instead of dragging out the radio
+//    on-time at 80MHz (racing to idle is the cheaper shape);
+//  - a NO_LIGHT_SLEEP lock around the actuator apply path, so a relay
+//    command never waits on a light-sleep wakeup ramp.
+#if ESP_IDF_VERSION_MAJOR >= 5
+typedef esp_pm_config_t PmConfig;
+#elif CONFIG_IDF_TARGET_ESP32S3
+typedef esp_pm_config_esp32s3_t PmConfig;
+#elif CONFIG_IDF_TARGET_ESP32C3
+typedef esp_pm_config_esp32c3_t PmConfig;
+#else
+typedef esp_pm_config_esp32_t PmConfig;
+#endif
+
+class PowerManager {
+public:
+  // Configure DFS between minMhz and maxMhz with automatic light sleep.
+  // Returns false when the running sdkconfig has no PM support; the
+  // node then simply stays at the fixed boot frequency.
+  bool begin(int maxMhz, int minMhz) {
+    PmConfig cfg = {};
+    cfg.max_freq_mhz = maxMhz;
+    cfg.min_freq_mhz = minMhz;
+    cfg.light_sleep_enable = true;
+    if (esp_pm_configure(&cfg) != ESP_OK) {
+      return false;
+    }
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "netBurst", &_cpuLock);
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "actuator", &_latencyLock);
+    _enabled = true;
+    return true;
+  }
+
+  bool enabled() const { return _enabled; }
+
+  // Hold the max CPU frequency for the duration of a network burst.
+  // The locks are counting, so nesting balances out.
+  void netBurstBegin() {
+    if (_cpuLock != NULL) {
+      esp_pm_lock_acquire(_cpuLock);
+      _netBursts++;
+    }
+  }
+  void netBurstEnd() {
+    if (_cpuLock != NULL) {
+      esp_pm_lock_release(_cpuLock);
+    }
+  }
+
+  // Keep the chip out of light sleep while an actuator command is applied
+  void latencyBegin() {
+    if (_latencyLock != NULL) {
+      esp_pm_lock_acquire(_latencyLock);
+    }
+  }
+  void latencyEnd() {
+    if (_latencyLock != NULL) {
+      esp_pm_lock_release(_latencyLock);
+    }
+  }
+
+  uint32_t netBursts() const { return _netBursts; }
+
+private:
+  esp_pm_lock_handle_t _cpuLock = NULL;
+  esp_pm_lock_handle_t _latencyLock = NULL;
+  bool _enabled = false;
+  uint32_t _netBursts = 0;
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,114 @@
+#ifndef PUBLISH_BUDGET_H
+#define PUBLISH_BUDGET_H
+
+#include <Arduino.h>
+
+#include "telemetry_buffer.h"
+
+// Client-side token bucket for the telemetry publish path. The CoreIoT
+// plan enforces a per-device message-rate quota; after an outage the
+// backlog flush from a whole fleet trips broker-side throttling and
+// the resulting disconnects turn into a retry storm. This bucket keeps
+// each node inside its quota locally: publishes spend a token, tokens
+// refill at the configured rate, and when the bucket runs dry the
+// drain loop merges the records it cannot send into one averaged
+// record instead of dropping or hammering them. A node with headroom
+// (bucket full, normal cadence below the rate) never notices it.
+//
+// The rate is a runtime parameter ("publishPerMin" shared attribute),
+// so the quota can be retuned fleet-wide from the platform without a
+// reflash.
+class PublishBudget {
+public:
+  // Burst depth in tokens. Matches the backlog drain batch bound in
+  // taskSerial: one full flush cycle can always go out back to back
+  // once the bucket has had time to fill.
+  static const uint8_t BURST_TOKENS = 8;
+
+  // Called once per pass with the live rate knob; also advances the
+  // refill clock, so call it before the first tryTake of the pass.
+  void refill(float perMinute, uint32_t nowMs) {
+    if (perMinute < 1.0f) perMinute = 1.0f;
+    if (_lastRefillMs == 0) {
+      _lastRefillMs = nowMs;
+      _tokens = BURST_TOKENS;  // start full: boot telemetry is a burst
+      return;
+    }
+    _tokens += (float)(nowMs - _lastRefillMs) * perMinute / 60000.0f;
+    if (_tokens > (float)BURST_TOKENS) _tokens = (float)BURST_TOKENS;
+    _lastRefillMs = nowMs;
+  }
+
+  // One token per publish. False means over quota right now.
+  bool tryTake() {
+    if (_tokens < 1.0f) {
+      _denied++;
+      return false;
+    }
+    _tokens -= 1.0f;
+    _granted++;
+    return true;
+  }
+
+  // Fold a record the bucket refused into the running merge. The merge
+  // averages the sensor fields and keeps the newest timestamp, so the
+  // one record that eventually goes out summarizes the span instead of
+  // repeating its oldest point.
+  void merge(const TelemetryRecord &rec) {
+    if (_mergedCount == 0) {
+      _merged = rec;
+    } else {
+      const float n = (float)_mergedCount;
+      _merged.temperature = (_merged.temperature * n + rec.temperature) / (n + 1.0f);
+      _merged.humidity = (_merged.humidity * n + rec.humidity) / (n + 1.0f);
+      _merged.light = (_merged.light * n + rec.light) / (n + 1.0f);
+      _merged.moisture = (_merged.moisture * n + rec.moisture) / (n + 1.0f);
+      if ((int32_t)(rec.uptimeMs - _merged.uptimeMs) > 0) {
+        _merged.uptimeMs = rec.uptimeMs;
+      }
+    }
+    _mergedCount++;
+  }
+
+  // Hand the accumulated merge back (to publish or re-queue) and reset.
+  bool takeMerged(TelemetryRecord &out) {
+    if (_mergedCount == 0) return false;
+    out = _merged;
+    _mergeEvents += _mergedCount > 1 ? 1 : 0;
+    _mergedRecords += _mergedCount;
+    _mergedCount = 0;
+    return true;
+  }
+
+  bool hasMerged() const { return _mergedCount > 0; }
+
+  // Window counters for the periodic stats export; resets on read like
+  // the other exporters' serialize calls.
+  size_t serialize(char *out, size_t outSize) {
+    const size_t n = snprintf(out, outSize,
+        "{\"pubGranted\":%lu,\"pubDenied\":%lu,\"pubMerged\":%lu,"
+        "\"pubMergeEvents\":%lu,\"pubTokens\":%d}",
+        (unsigned long)_granted, (unsigned long)_denied,
+        (unsigned long)_mergedRecords, (unsigned long)_mergeEvents,
+        (int)_tokens);
+    _granted = 0;
+    _denied = 0;
+    _mergedRecords = 0;
+    _mergeEvents = 0;
+    return n;
+  }
+
+  uint32_t denied() const { return _denied; }
+
+private:
+  float _tokens = 0.0f;
+  uint32_t _lastRefillMs = 0;
+  TelemetryRecord _merged = {0, 0.0f, 0.0f, 0.0f, 0.0f};
+  uint16_t _mergedCount = 0;
+  uint32_t _granted = 0;
+  uint32_t _denied = 0;
+  uint32_t _mergedRecords = 0;
+  uint32_t _mergeEvents = 0;
+};
+
+#endif // PUBLISH_BUDGET_H
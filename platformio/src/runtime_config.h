@@ -0,0 +1,153 @@
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "nvs_journal.h"
+
+// Typed runtime parameters with NVS persistence and live application.
+//
+// The tuning knobs (telemetry cadence, control thresholds, WiFi
+// credentials) used to be compile-time constants, so changing a
+// sampling interval fleet-wide meant an OTA cycle per variant. Owners
+// register their parameters with a key, default and valid range; NVS
+// overrides load once at begin(), and set() — fed from shared
+// attributes, the serial command channel or RPC — validates, persists
+// and applies the new value in one step, optionally waking the owning
+// task so a change takes effect within its current sleep instead of on
+// the next natural wakeup. One firmware image then serves every
+// deployment; per-site differences live in NVS.
+//
+// get() is a single aligned 32-bit read (atomic on this core), so hot
+// loops can read their parameters every cycle without locking; set()
+// is rare and does the NVS write inline.
+class RuntimeConfig {
+public:
+  static const int MAX_PARAMS = 20;
+  static const int MAX_STRINGS = 4;
+
+  // Registration, before begin(). Returns the slot for get(), or -1
+  // when the table is full. Keys are NVS keys: 15 chars max.
+  int add(const char *key, float defaultValue, float minValue, float maxValue,
+          TaskHandle_t *ownerTask = NULL) {
+    if (_count >= MAX_PARAMS) {
+      return -1;
+    }
+    _params[_count] = {key, minValue, maxValue, defaultValue, ownerTask};
+    return _count++;
+  }
+
+  int addString(const char *key, const char *defaultValue) {
+    if (_stringCount >= MAX_STRINGS) {
+      return -1;
+    }
+    _strings[_stringCount] = {key, defaultValue};
+    return _stringCount++;
+  }
+
+  // Opens the namespace and overlays persisted values onto the
+  // registered defaults
+  void begin(const char *ns = "cfg") {
+    _ready = _prefs.begin(ns, false);
+    if (!_ready) {
+      return;
+    }
+    for (int i = 0; i < _count; i++) {
+      _params[i].value = _prefs.getFloat(_params[i].key, _params[i].value);
+    }
+  }
+
+  // Defer NVS persistence to the write-behind journal: set() applies
+  // the value to RAM (and wakes the owner) immediately, the flash
+  // write happens on the journal's flush cadence. A shared-attribute
+  // dump retuning six knobs then costs the control and network tasks
+  // nothing; the housekeeping worker absorbs the commits.
+  void attachJournal(NvsJournal *journal) { _journal = journal; }
+
+  float get(int slot) const {
+    return (slot >= 0 && slot < _count) ? _params[slot].value : 0.0f;
+  }
+
+  // Validates against the registered range, persists and applies.
+  // Returns false for unknown keys or out-of-range values, so callers
+  // can report rejected updates instead of silently clamping.
+  bool set(const char *key, float value) {
+    for (int i = 0; i < _count; i++) {
+      if (strcmp(_params[i].key, key) != 0) {
+        continue;
+      }
+      if (value < _params[i].minValue || value > _params[i].maxValue) {
+        return false;
+      }
+      _params[i].value = value;
+      if (_ready) {
+        // Stage under the registered key, not the caller's: callers
+        // pass transient strings (JSON iterators) and the journal
+        // keeps key pointers until the flush
+        if (_journal != NULL) {
+          _journal->stageFloat(&_prefs, _params[i].key, value);
+        } else {
+          _prefs.putFloat(key, value);
+        }
+      }
+      // Wake the owner out of its timed sleep so the new value applies
+      // now, not at the end of the old interval
+      if (_params[i].ownerTask != NULL && *_params[i].ownerTask != NULL) {
+        xTaskNotifyGive(*_params[i].ownerTask);
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // String parameters (credentials, host names): persisted override or
+  // the registered compile-time fallback
+  bool getString(const char *key, char *out, size_t cap) {
+    for (int i = 0; i < _stringCount; i++) {
+      if (strcmp(_strings[i].key, key) != 0) {
+        continue;
+      }
+      if (_ready && _prefs.isKey(key)) {
+        _prefs.getString(key, out, cap);
+      } else {
+        snprintf(out, cap, "%s", _strings[i].fallback);
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool setString(const char *key, const char *value) {
+    for (int i = 0; i < _stringCount; i++) {
+      if (strcmp(_strings[i].key, key) == 0) {
+        return _ready && _prefs.putString(key, value) > 0;
+      }
+    }
+    return false;
+  }
+
+private:
+  struct Param {
+    const char *key;
+    float minValue;
+    float maxValue;
+    volatile float value;
+    TaskHandle_t *ownerTask;
+  };
+  struct StringParam {
+    const char *key;
+    const char *fallback;
+  };
+
+  Param _params[MAX_PARAMS];
+  StringParam _strings[MAX_STRINGS];
+  int _count = 0;
+  int _stringCount = 0;
+  Preferences _prefs;
+  bool _ready = false;
+  // Strings (credentials, rare provisioning writes) stay synchronous;
+  // only the float parameters go through the journal
+  NvsJournal *_journal = NULL;
+};
+
+#endif // RUNTIME_CONFIG_H
@@ -0,0 +1,113 @@
+#ifndef SAMPLE_SCHEDULER_H
+#define SAMPLE_SCHEDULER_H
+
+#include <Arduino.h>
+
+// Per-field sampling schedule for the sensor task. The channels move on
+// very different timescales — light changes in milliseconds, soil
+// moisture over minutes — so one fixed 1s loop oversamples the slow
+// channels and undersamples the fast ones. Each field gets its own
+// period; the sampler sleeps until the earliest due field and pulls in
+// any other field that would come due within MERGE_WINDOW_MS, so
+// near-coincident fields share one acquisition pass and one snapshot
+// publish instead of two back to back.
+class SampleScheduler {
+public:
+  // Acquisition groups: the DHT20 yields temperature and humidity from
+  // one (slow, ~80ms) transaction, the ADC channels are instant
+  enum Field : uint8_t {
+    FIELD_CLIMATE = 0,
+    FIELD_LIGHT,
+    FIELD_MOISTURE,
+    FIELD_COUNT,
+  };
+
+  // Fields due within this of the earliest one are sampled a little
+  // early rather than waking again moments later
+  static const uint32_t MERGE_WINDOW_MS = 100;
+
+  void setPeriod(uint8_t field, uint32_t periodMs) {
+    if (field < FIELD_COUNT) {
+      _periodMs[field] = periodMs;
+    }
+  }
+
+  // Milliseconds until the earliest field is due (0 = due now)
+  uint32_t nextDelayMs(uint32_t now) const {
+    uint32_t shortest = 0xFFFFFFFF;
+    for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+      const int32_t remaining = (int32_t)(_nextDueMs[f] - now);
+      const uint32_t wait = remaining <= 0 ? 0 : (uint32_t)remaining;
+      if (wait < shortest) {
+        shortest = wait;
+      }
+    }
+    return shortest;
+  }
+
+  // Bitmask of fields sampled in this pass: everything due now plus
+  // anything due within the merge window. Their next deadline advances
+  // from now, so a late pass does not burst to catch up.
+  uint8_t collectDue(uint32_t now) {
+    uint8_t mask = 0;
+    for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+      if ((int32_t)(_nextDueMs[f] - now) <= (int32_t)MERGE_WINDOW_MS) {
+        mask |= (uint8_t)(1U << f);
+        _nextDueMs[f] = now + _periodMs[f];
+      }
+    }
+    return mask;
+  }
+
+  static uint8_t fieldBit(uint8_t field) { return (uint8_t)(1U << field); }
+
+private:
+  uint32_t _periodMs[FIELD_COUNT] = {1000, 1000, 1000};
+  uint32_t _nextDueMs[FIELD_COUNT] = {0, 0, 0};
+};
+
+// Per-channel EMA plus deadband, applied at acquisition. The EMA knocks
+// down single-sample noise at the channel's own rate; the deadband
+// decides whether the smoothed value differs enough from the last
+// published one to be worth pushing downstream.
+class ChannelFilter {
+public:
+  ChannelFilter(float alpha, float deadband) : _alpha(alpha), _deadband(deadband) {}
+
+  // Feed one raw sample. Returns true when the published value moved
+  // (beyond the deadband); value always holds the current published value.
+  bool apply(float raw, float &value) {
+    if (!_primed) {
+      _primed = true;
+      _state = raw;
+      _published = raw;
+      value = raw;
+      return true;
+    }
+    _state += _alpha * (raw - _state);
+    const float delta = _state - _published;
+    if (delta >= _deadband || delta <= -_deadband) {
+      _published = _state;
+      value = _state;
+      return true;
+    }
+    value = _published;
+    return false;
+  }
+
+  // Adopt a value restored from elsewhere (warm boot) as the baseline
+  void seed(float value) {
+    _primed = true;
+    _state = value;
+    _published = value;
+  }
+
+private:
+  float _alpha;
+  float _deadband;
+  float _state = 0.0f;
+  float _published = 0.0f;
+  bool _primed = false;
+};
+
+#endif // SAMPLE_SCHEDULER_H
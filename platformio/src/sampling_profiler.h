@@ -0,0 +1,150 @@
+#ifndef SAMPLING_PROFILER_H
+#define SAMPLING_PROFILER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// On-demand sampling profiler, armed over RPC. A hardware timer fires
+// at RATE_HZ for the requested number of seconds; each tick attributes
+// one sample per core to whatever task the interrupt landed on, so at
+// the end the bucket counts are the CPU-share picture of real field
+// load - the thing lab units never reproduce. Idle cost is zero: the
+// timer only exists while a session runs.
+//
+// Granularity is the task, not the function: from an Arduino-level ISR
+// the interrupted exception frame's PC is not portably reachable, and
+// the task set here is fine-grained enough (one task per subsystem)
+// that the task share already answers "where does the CPU go". The
+// session result is one flat telemetry object of per-task sample
+// percentages.
+class SamplingProfiler {
+public:
+  static const uint32_t RATE_HZ = 1000;
+  static const uint32_t MAX_SECONDS = 30;
+  static const int MAX_TASKS = 16;
+
+  // Arm a session; false when one is already running or pending
+  // publish. Clamps to [1, MAX_SECONDS].
+  bool start(uint32_t seconds) {
+    if (_timer != NULL || _finished) {
+      return false;
+    }
+    if (seconds < 1) seconds = 1;
+    if (seconds > MAX_SECONDS) seconds = MAX_SECONDS;
+    for (int i = 0; i < MAX_TASKS; i++) {
+      _handles[i] = NULL;
+      _counts[i] = 0;
+    }
+    _overflow = 0;
+    _totalTicks = 0;
+    _remainingTicks = seconds * RATE_HZ;
+    instanceRef() = this;
+    // Timer 3: 0-2 are free too, but 3 is furthest from anything a
+    // library might grab. 80MHz/80 = 1MHz base, alarm in microseconds.
+    _timer = timerBegin(3, 80, true);
+    timerAttachInterrupt(_timer, &SamplingProfiler::onTick, true);
+    timerAlarmWrite(_timer, 1000000UL / RATE_HZ, true);
+    timerAlarmEnable(_timer);
+    return true;
+  }
+
+  bool running() const { return _timer != NULL && !_finished; }
+
+  // True once the session elapsed and the report awaits publishing.
+  // Tears the timer down on the first call after expiry, in task
+  // context where the timer API belongs.
+  bool finished() {
+    if (_timer != NULL && _remainingTicks == 0) {
+      timerAlarmDisable(_timer);
+      timerDetachInterrupt(_timer);
+      timerEnd(_timer);
+      _timer = NULL;
+      _finished = true;
+    }
+    return _finished;
+  }
+
+  // One flat JSON object, per-task share in percent of all samples:
+  //   {"profMs":10000,"profHz":1000,"prof_TaskDHT20":31,...,"profOther":2}
+  // Task names resolve at publish time; a task deleted mid-session
+  // folds into profOther along with bucket overflow.
+  size_t serialize(char *buf, size_t cap) const {
+    const uint32_t total = _totalTicks > 0 ? _totalTicks : 1;
+    // _totalTicks counts samples (one per core per tick); the wall
+    // duration divides the cores back out
+    size_t len = snprintf(buf, cap, "{\"profMs\":%lu,\"profHz\":%lu",
+                          (unsigned long)(_totalTicks / portNUM_PROCESSORS *
+                                          1000UL / RATE_HZ),
+                          (unsigned long)RATE_HZ);
+    uint32_t other = _overflow;
+    for (int i = 0; i < MAX_TASKS && len < cap; i++) {
+      if (_handles[i] == NULL || _counts[i] == 0) {
+        continue;
+      }
+      const char *name = pcTaskGetName(_handles[i]);
+      if (name == NULL) {
+        other += _counts[i];
+        continue;
+      }
+      len += snprintf(buf + len, cap - len, ",\"prof_%s\":%lu", name,
+                      (unsigned long)(_counts[i] * 100UL / total));
+    }
+    if (len < cap) {
+      len += snprintf(buf + len, cap - len, ",\"profOther\":%lu}",
+                      (unsigned long)(other * 100UL / total));
+    }
+    return len < cap ? len : cap - 1;
+  }
+
+  // Report published: ready for the next session
+  void reset() { _finished = false; }
+
+private:
+  static SamplingProfiler *&instanceRef() {
+    static SamplingProfiler *instance = NULL;
+    return instance;
+  }
+
+  // Timer ISR: one sample per core into a fixed open-addressed bucket
+  // array. Only handle compares and increments - name resolution and
+  // everything else waits for task context.
+  static void IRAM_ATTR onTick() {
+    SamplingProfiler *profiler = instanceRef();
+    if (profiler == NULL || profiler->_remainingTicks == 0) {
+      return;
+    }
+    profiler->_remainingTicks--;
+    profiler->_totalTicks += portNUM_PROCESSORS;
+    for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++) {
+      TaskHandle_t handle = xTaskGetCurrentTaskHandleForCPU(core);
+      bool bucketed = false;
+      for (int i = 0; i < MAX_TASKS; i++) {
+        if (profiler->_handles[i] == handle) {
+          profiler->_counts[i]++;
+          bucketed = true;
+          break;
+        }
+        if (profiler->_handles[i] == NULL) {
+          profiler->_handles[i] = handle;
+          profiler->_counts[i] = 1;
+          bucketed = true;
+          break;
+        }
+      }
+      if (!bucketed) {
+        profiler->_overflow++;
+      }
+    }
+  }
+
+  hw_timer_t *_timer = NULL;
+  volatile bool _finished = false;
+  volatile uint32_t _remainingTicks = 0;
+  volatile uint32_t _totalTicks = 0;
+  TaskHandle_t volatile _handles[MAX_TASKS] = {};
+  volatile uint32_t _counts[MAX_TASKS] = {};
+  volatile uint32_t _overflow = 0;
+};
+
+#endif // SAMPLING_PROFILER_H
@@ -0,0 +1,111 @@
+#ifndef SENSOR_CALIBRATION_H
+#define SENSOR_CALIBRATION_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// On-device sensor calibration for the raw ADC channels. The moisture
+// and light values used to leave the node as raw counts and got
+// corrected later in Python, one pass over every stored row; applying
+// the curve here costs a table lookup and an integer lerp per sample.
+//
+// Representation: a 17-entry lookup table over the 12-bit ADC range,
+// one anchor every 256 counts. Evaluation is fixed point throughout —
+// index = raw >> 8, fraction = raw & 255, output = lut[i] +
+// ((lut[i+1] - lut[i]) * fraction) >> 8. One multiply, one shift, no
+// float, no division.
+//
+// The default tables are generated at compile time: CAL_CURVE_17
+// expands a constexpr piecewise-linear interpolation over a handful of
+// measured calibration points into the 17 anchors, so adjusting a
+// calibration means editing the point list and rebuilding — no
+// generator script, no checked-in magic numbers. (The constexpr
+// helpers are C++11-compatible single-expression recursion because the
+// Arduino core still builds gnu++11.)
+//
+// Per-node override: begin() loads a replacement table from NVS when
+// one has been stored (a field-calibrated node differs from the bench
+// profile); store() persists a new one. Absent NVS data, the
+// compile-time curve applies.
+
+// One measured calibration point: raw ADC count -> output value
+// (centi-percent for moisture, lux for light)
+struct CalPoint {
+  int32_t raw;
+  int32_t value;
+};
+
+// Piecewise-linear interpolation over the point list, recursively
+// scanning for the surrounding segment. Clamps outside the range.
+constexpr int32_t calInterp(const CalPoint *points, size_t count, size_t i,
+                            int32_t raw) {
+  return (i + 1 >= count)
+             ? points[count - 1].value
+             : (raw <= points[0].raw)
+                   ? points[0].value
+                   : (raw <= points[i + 1].raw)
+                         ? points[i].value +
+                               (points[i + 1].value - points[i].value) *
+                                   (raw - points[i].raw) /
+                                   (points[i + 1].raw - points[i].raw)
+                         : calInterp(points, count, i + 1, raw);
+}
+
+#define CAL_ANCHOR(pts, n, i) calInterp(pts, n, 0, (i) * 256)
+// 17 anchors covering raw 0..4096 in steps of 256
+#define CAL_CURVE_17(pts, n)                                                  \
+  {                                                                           \
+    CAL_ANCHOR(pts, n, 0), CAL_ANCHOR(pts, n, 1), CAL_ANCHOR(pts, n, 2),      \
+    CAL_ANCHOR(pts, n, 3), CAL_ANCHOR(pts, n, 4), CAL_ANCHOR(pts, n, 5),      \
+    CAL_ANCHOR(pts, n, 6), CAL_ANCHOR(pts, n, 7), CAL_ANCHOR(pts, n, 8),      \
+    CAL_ANCHOR(pts, n, 9), CAL_ANCHOR(pts, n, 10), CAL_ANCHOR(pts, n, 11),    \
+    CAL_ANCHOR(pts, n, 12), CAL_ANCHOR(pts, n, 13), CAL_ANCHOR(pts, n, 14),   \
+    CAL_ANCHOR(pts, n, 15), CAL_ANCHOR(pts, n, 16)                            \
+  }
+
+class SensorCalibration {
+public:
+  static const size_t LUT_SIZE = 17;
+
+  // nvsKey names this sensor's override slot ("moist", "light")
+  void begin(const char *nvsKey, const int32_t (&defaults)[LUT_SIZE]) {
+    _key = nvsKey;
+    memcpy(_lut, defaults, sizeof(_lut));
+    Preferences prefs;
+    prefs.begin("cal", true);
+    if (prefs.getBytesLength(_key) == sizeof(_lut)) {
+      prefs.getBytes(_key, _lut, sizeof(_lut));
+      _fromNvs = true;
+    }
+    prefs.end();
+  }
+
+  // Persist a field-measured replacement curve for this node
+  bool store(const int32_t (&lut)[LUT_SIZE]) {
+    memcpy(_lut, lut, sizeof(_lut));
+    Preferences prefs;
+    prefs.begin("cal", false);
+    const bool ok = prefs.putBytes(_key, _lut, sizeof(_lut)) == sizeof(_lut);
+    prefs.end();
+    _fromNvs = ok;
+    return ok;
+  }
+
+  // Fixed-point evaluation; raw is clamped to the 12-bit ADC range
+  int32_t apply(int32_t raw) const {
+    if (raw < 0) raw = 0;
+    if (raw > 4095) raw = 4095;
+    const int32_t i = raw >> 8;
+    const int32_t frac = raw & 255;
+    return _lut[i] + (((_lut[i + 1] - _lut[i]) * frac) >> 8);
+  }
+
+  bool fromNvs() const { return _fromNvs; }
+
+private:
+  const char *_key = NULL;
+  int32_t _lut[LUT_SIZE] = {0};
+  bool _fromNvs = false;
+};
+
+#endif // SENSOR_CALIBRATION_H
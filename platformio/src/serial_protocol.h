@@ -0,0 +1,138 @@
+#ifndef SERIAL_PROTOCOL_H
+#define SERIAL_PROTOCOL_H
+
+#include <Arduino.h>
+
+// Compact binary command protocol for gateway-attached nodes, carried
+// next to the human JSON lines on the same serial link. A command is a
+// fixed three-byte struct [id][value][crc8] wrapped in COBS and
+// terminated by 0x00 (five bytes on the wire), so the decoder is one
+// COBS pass plus a CRC over two bytes instead of a JSON parse — and a
+// byte lost to line noise costs exactly one frame: the next 0x00
+// delimiter resynchronizes by construction.
+//
+// The two encodings coexist because JSON lines always start with '{'
+// and never contain 0x00, while COBS frames never start with '{' (id 0
+// is reserved): the receiver decides per buffered line which decoder
+// applies.
+struct BinaryCommand {
+  uint8_t id;     // SerialProtocol command id
+  uint8_t value;  // command argument, 0/1 for the switch commands
+};
+
+class SerialProtocol {
+public:
+  // Command ids, also the index into the receiver's handler table.
+  // 0 is reserved so a frame can never start with '{' (0x7B is simply
+  // not a valid first COBS code byte for our 4-byte frames either).
+  enum CommandId : uint8_t {
+    CMD_NONE = 0,
+    CMD_LED,
+    CMD_PUMP,
+    CMD_FAN,
+    CMD_AUTO,
+    CMD_STOP,
+    CMD_COUNT,
+  };
+
+  // Longest raw frame we accept after COBS removal
+  static const size_t MAX_FRAME = 8;
+
+  // COBS decode (frame without the trailing 0x00 delimiter).
+  // Returns the decoded length, 0 on malformed input.
+  static size_t cobsDecode(const uint8_t *in, size_t len, uint8_t *out, size_t cap) {
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+      const uint8_t code = in[i++];
+      if (code == 0 || i + (size_t)(code - 1) > len) {
+        return 0;
+      }
+      for (uint8_t j = 1; j < code; j++) {
+        if (o >= cap) {
+          return 0;
+        }
+        out[o++] = in[i++];
+      }
+      if (code != 0xFF && i < len) {
+        if (o >= cap) {
+          return 0;
+        }
+        out[o++] = 0;
+      }
+    }
+    return o;
+  }
+
+  // COBS encode plus the 0x00 delimiter, for the gateway side and tests.
+  // Returns the wire length, 0 when out is too small.
+  static size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out, size_t cap) {
+    size_t o = 1;
+    size_t codeIndex = 0;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+      if (o >= cap) {
+        return 0;
+      }
+      if (in[i] == 0) {
+        out[codeIndex] = code;
+        codeIndex = o++;
+        code = 1;
+      } else {
+        out[o++] = in[i];
+        if (++code == 0xFF) {
+          out[codeIndex] = code;
+          codeIndex = o++;
+          code = 1;
+        }
+      }
+    }
+    if (o >= cap) {
+      return 0;
+    }
+    out[codeIndex] = code;
+    out[o++] = 0x00;  // frame delimiter
+    return o;
+  }
+
+  // CRC-8, polynomial 0x07, init 0
+  static uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+      crc ^= data[i];
+      for (int b = 0; b < 8; b++) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+      }
+    }
+    return crc;
+  }
+
+  // Decode one received frame (delimiter already stripped) into cmd.
+  // False on malformed COBS, wrong length, bad CRC or unknown id.
+  static bool decodeFrame(const uint8_t *frame, size_t len, BinaryCommand &cmd) {
+    uint8_t raw[MAX_FRAME];
+    const size_t rawLen = cobsDecode(frame, len, raw, sizeof(raw));
+    if (rawLen != 3) {
+      return false;
+    }
+    if (crc8(raw, 2) != raw[2]) {
+      return false;
+    }
+    if (raw[0] == CMD_NONE || raw[0] >= CMD_COUNT) {
+      return false;
+    }
+    cmd.id = raw[0];
+    cmd.value = raw[1];
+    return true;
+  }
+
+  // Build one wire frame, for the gateway side and tests.
+  // Returns the wire length, 0 when out is too small.
+  static size_t encodeFrame(uint8_t id, uint8_t value, uint8_t *out, size_t cap) {
+    uint8_t raw[3] = {id, value, 0};
+    raw[2] = crc8(raw, 2);
+    return cobsEncode(raw, sizeof(raw), out, cap);
+  }
+};
+
+#endif // SERIAL_PROTOCOL_H
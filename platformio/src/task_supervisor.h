@@ -0,0 +1,150 @@
+#ifndef TASK_SUPERVISOR_H
+#define TASK_SUPERVISOR_H
+
+#include <Arduino.h>
+#include <esp_task_wdt.h>
+
+// Per-task stall history that survives reboots and deep sleep, declared
+// RTC_DATA_ATTR by the owner like HeapPersistentStats. maxLatencyMs is
+// the worst observed gap between check-ins per slot, which is the
+// number to read when a deadline needs retuning.
+struct TaskHealthPersistentStats {
+  uint32_t maxLatencyMs[8];
+  uint32_t stalls[8];       // deadline misses per slot
+  uint32_t recoveries;      // targeted recoveries attempted
+  uint32_t wdtReboots;      // times we stopped feeding and let the WDT fire
+};
+
+// Deadline supervisor on top of the ESP-IDF task watchdog.
+//
+// Each monitored task registers a slot with its expected check-in
+// period and calls checkIn() once per loop iteration. The supervisor
+// task is the only subscriber to the hardware task WDT and keeps
+// feeding it only while every slot is inside its deadline, so the
+// escalation ladder is: task misses its deadline -> targeted recovery
+// (optional per-slot hook, e.g. an I2C bus clear, then restart the
+// task from its stored entry point) -> if the restarted task misses
+// again, stop feeding and let the hardware watchdog reset the chip.
+// A stall therefore costs one task restart in the common case (a wedged
+// sensor transaction) instead of a full reboot, and the reboot still
+// happens when recovery does not take.
+//
+// checkIn() is two stores and a subtraction — cheap enough for every
+// loop of every task. poll() runs only in the supervisor task.
+class TaskSupervisor {
+public:
+  static const size_t MAX_TASKS = 8;
+  // Called before the task is restarted; clear whatever bus or driver
+  // the task may have wedged. Runs in the supervisor task's context.
+  typedef void (*RecoverHook)();
+
+  void begin(TaskHealthPersistentStats *persist, uint32_t wdtTimeoutS) {
+    _persist = persist;
+    esp_task_wdt_init(wdtTimeoutS, true);  // panic reset on starvation
+  }
+
+  // Must be called from the supervisor task itself (esp_task_wdt_add
+  // subscribes the calling task): only that task feeds the WDT, so a
+  // stall in the supervisor also ends in a clean WDT reboot
+  void subscribeSupervisorTask() { esp_task_wdt_add(NULL); }
+
+  // Registers a slot. entry/stackWords/priority mirror the original
+  // xTaskCreate so the supervisor can recreate the task; handle is the
+  // owner's TaskHandle_t and is updated on restart. Returns the slot
+  // id for checkIn(), or -1 when the table is full.
+  int add(const char *name, uint32_t deadlineMs, TaskHandle_t *handle,
+          TaskFunction_t entry, uint32_t stackWords, UBaseType_t priority,
+          BaseType_t coreId, RecoverHook recover = NULL) {
+    if (_count >= MAX_TASKS) return -1;
+    Slot &slot = _slots[_count];
+    slot.name = name;
+    slot.deadlineMs = deadlineMs;
+    slot.handle = handle;
+    slot.entry = entry;
+    slot.stackWords = stackWords;
+    slot.priority = priority;
+    slot.coreId = coreId;
+    slot.recover = recover;
+    slot.lastCheckInMs = millis();
+    slot.restarted = false;
+    return (int)_count++;
+  }
+
+  // Called by the monitored task itself, once per loop iteration
+  void checkIn(int slotId) {
+    if (slotId < 0) return;
+    Slot &slot = _slots[slotId];
+    const uint32_t now = millis();
+    const uint32_t latency = now - slot.lastCheckInMs;
+    if (_persist && latency > _persist->maxLatencyMs[slotId]) {
+      _persist->maxLatencyMs[slotId] = latency;
+    }
+    slot.lastCheckInMs = now;
+    slot.restarted = false;  // a check-in proves the task is alive again
+  }
+
+  // Supervisor task body: true while the system is healthy (the WDT was
+  // fed), false when a restarted task stalled again and the hardware
+  // watchdog has been left to fire. stalledSlot reports the culprit.
+  bool poll(int &stalledSlot) {
+    const uint32_t now = millis();
+    for (size_t i = 0; i < _count; i++) {
+      Slot &slot = _slots[i];
+      if (now - slot.lastCheckInMs <= slot.deadlineMs) continue;
+      stalledSlot = (int)i;
+      if (_persist) _persist->stalls[i]++;
+      if (slot.restarted) {
+        // Second miss after a targeted restart: recovery did not take,
+        // stop feeding and let the task WDT panic-reset the chip
+        if (_persist) _persist->wdtReboots++;
+        return false;
+      }
+      restart(slot);
+      slot.lastCheckInMs = now;  // restart gets a fresh deadline window
+      slot.restarted = true;
+    }
+    esp_task_wdt_reset();
+    return true;
+  }
+
+  const char *slotName(int slotId) const { return _slots[slotId].name; }
+  uint32_t slotDeadlineMs(int slotId) const { return _slots[slotId].deadlineMs; }
+  uint32_t maxLatencyMs(int slotId) const {
+    return _persist ? _persist->maxLatencyMs[slotId] : 0;
+  }
+  uint32_t stalls(int slotId) const {
+    return _persist ? _persist->stalls[slotId] : 0;
+  }
+
+private:
+  struct Slot {
+    const char *name;
+    uint32_t deadlineMs;
+    TaskHandle_t *handle;
+    TaskFunction_t entry;
+    uint32_t stackWords;
+    UBaseType_t priority;
+    BaseType_t coreId;
+    RecoverHook recover;
+    uint32_t lastCheckInMs;
+    bool restarted;  // one targeted restart outstanding
+  };
+
+  void restart(Slot &slot) {
+    if (_persist) _persist->recoveries++;
+    if (slot.recover) slot.recover();
+    if (slot.handle && *slot.handle) {
+      vTaskDelete(*slot.handle);
+      *slot.handle = NULL;
+    }
+    // Recreate on the same core the task was placed on originally
+    xTaskCreatePinnedToCore(slot.entry, slot.name, slot.stackWords, NULL,
+                            slot.priority, slot.handle, slot.coreId);
+  }
+
+  TaskHealthPersistentStats *_persist = NULL;
+  Slot _slots[MAX_TASKS];
+  size_t _count = 0;
+};
+
+#endif // TASK_SUPERVISOR_H
@@ -0,0 +1,111 @@
+#ifndef TELEMETRY_BUFFER_H
+#define TELEMETRY_BUFFER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+#include "mem_pools.h"
+
+// One buffered sensor record. Timestamped with uptime millis at the
+// moment the reading was acquired, so the backend can reconstruct the
+// sampling times relative to the drain moment and the publish path can
+// measure acquisition-to-broker latency.
+struct TelemetryRecord {
+  uint32_t uptimeMs;
+  float temperature;
+  float humidity;
+  float light;
+  float moisture;
+};
+
+// Store-and-forward ring buffer for telemetry. While WiFi is down the
+// firmware keeps pushing records here (drop-oldest when full) and the
+// backlog is persisted to NVS so it also survives a reboot mid-outage.
+// On reconnect the publish task drains it in batches.
+//
+// The ring itself comes from the bulk pool (mem_pools.h): on a PSRAM
+// board the backlog rides out an hour-plus outage without costing a
+// byte of internal RAM, and a board without PSRAM gets the same
+// internal footprint as before.
+class TelemetryBuffer {
+public:
+  // 256 records ~ 5KB, enough for a 4+ minute outage at 1Hz; the
+  // internal-RAM capacity, and what a PSRAM-less board gets
+  static const size_t CAPACITY = 256;
+  // With the ring in PSRAM the constraint is outage length, not RAM:
+  // 4096 records ~ 80KB covers an hour-plus at 1Hz
+  static const size_t PSRAM_CAPACITY = 4096;
+  // NVS blobs are limited (~4000 bytes), persist only the newest records
+  static const size_t PERSIST_MAX = 128;
+
+  void begin(MemPools &pools) {
+    _capacity = pools.psramPresent() ? PSRAM_CAPACITY : CAPACITY;
+    _records = static_cast<TelemetryRecord *>(
+        pools.allocBulk(_capacity * sizeof(TelemetryRecord)));
+    if (_records == NULL) {
+      // Pool exhausted at boot (should not happen): run without a
+      // backlog rather than crash; pushes drop until a reboot
+      _capacity = 0;
+      return;
+    }
+    _prefs.begin("telembuf", false);
+    size_t stored = _prefs.getBytesLength("records");
+    if (stored > 0 && stored % sizeof(TelemetryRecord) == 0 &&
+        stored <= _capacity * sizeof(TelemetryRecord)) {
+      _prefs.getBytes("records", _records, stored);
+      _count = stored / sizeof(TelemetryRecord);
+      _head = _count % _capacity;
+      _tail = 0;
+      _prefs.remove("records");
+    }
+  }
+
+  // Drop-oldest policy: a full buffer overwrites the oldest record so the
+  // most recent history is always kept.
+  void push(const TelemetryRecord &rec) {
+    if (_capacity == 0) return;
+    _records[_head] = rec;
+    _head = (_head + 1) % _capacity;
+    if (_count < _capacity) {
+      _count++;
+    } else {
+      _tail = (_tail + 1) % _capacity;
+    }
+  }
+
+  bool pop(TelemetryRecord &rec) {
+    if (_count == 0) return false;
+    rec = _records[_tail];
+    _tail = (_tail + 1) % _capacity;
+    _count--;
+    return true;
+  }
+
+  size_t size() const { return _count; }
+  size_t capacity() const { return _capacity; }
+  bool empty() const { return _count == 0; }
+
+  // Persist the pending backlog (newest PERSIST_MAX records) to NVS.
+  // Called when the outage looks long-lived, so a brownout does not
+  // wipe the buffered history.
+  void persist() {
+    size_t n = _count < PERSIST_MAX ? _count : PERSIST_MAX;
+    if (n == 0) return;
+    TelemetryRecord out[PERSIST_MAX];
+    size_t start = (_tail + (_count - n)) % _capacity;
+    for (size_t i = 0; i < n; i++) {
+      out[i] = _records[(start + i) % _capacity];
+    }
+    _prefs.putBytes("records", out, n * sizeof(TelemetryRecord));
+  }
+
+private:
+  TelemetryRecord *_records = NULL;
+  size_t _capacity = 0;
+  size_t _head = 0;
+  size_t _tail = 0;
+  size_t _count = 0;
+  Preferences _prefs;
+};
+
+#endif // TELEMETRY_BUFFER_H
@@ -0,0 +1,55 @@
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <Arduino.h>
+#include "telemetry_buffer.h"
+#include "telemetry_schema_gen.h"
+
+// Binary telemetry frame helpers. The packed struct itself (and the
+// matching Python/SQL/JS definitions) is generated from
+// schema/telemetry.json - see telemetry_schema_gen.h - so the firmware,
+// the decoder in back/telemetry_frame.py and the table DDL can no
+// longer drift apart by hand. Replaces the ~120-byte JSON object with
+// a 20-byte packed struct and removes the serialization work from the
+// publish path entirely.
+//
+// The device has no synced wall clock, so instead of epoch-ms the frame
+// carries the acquisition uptime plus the sample age at publish time;
+// the ingestion side reconstructs epoch as receive_time - ageMs.
+
+// MQTT topic for binary frames, separate from the JSON telemetry topic
+// so both encodings can coexist during rollout
+#define TELEMETRY_FRAME_TOPIC "v1/devices/me/telemetry/bin"
+
+// Fixed-point conversion with clamping, so a sensor glitch cannot wrap
+// the narrow fields
+static inline int16_t toCenti(float value) {
+  long centi = lroundf(value * 100.0f);
+  if (centi > 32767L) return 32767;
+  if (centi < -32768L) return -32768;
+  return (int16_t)centi;
+}
+
+static inline uint16_t toU16(float value) {
+  if (value < 0.0f) return 0;
+  if (value > 65535.0f) return 65535;
+  return (uint16_t)lroundf(value);
+}
+
+// Packs one buffered record into a frame. Returns the wire size.
+static inline size_t encodeTelemetryFrame(const TelemetryRecord &rec,
+                                          uint8_t deviceId, uint16_t sequence,
+                                          TelemetryFrame &frame) {
+  frame.version = TELEMETRY_FRAME_VERSION;
+  frame.deviceId = deviceId;
+  frame.sequence = sequence;
+  frame.uptimeMs = rec.uptimeMs;
+  frame.ageMs = millis() - rec.uptimeMs;
+  frame.temperatureCenti = toCenti(rec.temperature);
+  frame.humidityCenti = (uint16_t)toCenti(rec.humidity);
+  frame.light = toU16(rec.light);
+  frame.moisture = toU16(rec.moisture);
+  return sizeof(frame);
+}
+
+#endif // TELEMETRY_FRAME_H
@@ -0,0 +1,60 @@
+#ifndef TELEMETRY_KEYS_H
+#define TELEMETRY_KEYS_H
+
+#include <Arduino.h>
+
+// Interned JSON keys for the telemetry publish paths.
+//
+// ArduinoJson only copies a key into the document's memory pool when it
+// cannot prove the string stays alive: const char* keys are stored as
+// links to the caller's storage, while char* buffers and Strings are
+// copied into every document. Routing all publish sites through these
+// constants (and TelemetryKeyTable for keys composed at runtime)
+// guarantees each field name exists once, in static storage, and every
+// document links it: no key bytes in the document pool and no key copy
+// work per publish cycle.
+
+// The bare TELEMETRY_LIT_* literals come from the generated schema
+// header, so the key arrays below, the precomputed serializer segments
+// (JSON_KEY_SEG in json_builder.h) and the SQL/frontend definitions
+// all paste from schema/telemetry.json
+#include "telemetry_schema_gen.h"
+
+static const char TELEMETRY_KEY_TEMPERATURE[] = TELEMETRY_LIT_TEMPERATURE;
+static const char TELEMETRY_KEY_HUMIDITY[]    = TELEMETRY_LIT_HUMIDITY;
+static const char TELEMETRY_KEY_LIGHT[]       = TELEMETRY_LIT_LIGHT;
+static const char TELEMETRY_KEY_MOISTURE[]    = TELEMETRY_LIT_MOISTURE;
+static const char TELEMETRY_KEY_AGE_MS[]      = TELEMETRY_LIT_AGE_MS;
+static const char TELEMETRY_KEY_BOOT_TOTAL[]  = "bootUsTotal";
+
+// Keys that are composed at runtime (like the per-stage boot counters)
+// get a stable slot here the first time they are seen, and the same
+// pointer afterwards, so documents can link them exactly like the
+// compile-time constants above.
+class TelemetryKeyTable {
+public:
+  static const size_t MAX_KEYS = 12;
+  static const size_t MAX_KEY_LENGTH = 24;
+
+  // Returns the interned copy of key, or NULL when the table is full or
+  // the key is too long; the caller then lets the document copy the key
+  // as it would have without interning
+  const char* intern(const char* key) {
+    for (size_t i = 0; i < _count; i++) {
+      if (strcmp(_keys[i], key) == 0) {
+        return _keys[i];
+      }
+    }
+    if (_count >= MAX_KEYS || strlen(key) >= MAX_KEY_LENGTH) {
+      return NULL;
+    }
+    strcpy(_keys[_count], key);
+    return _keys[_count++];
+  }
+
+private:
+  char _keys[MAX_KEYS][MAX_KEY_LENGTH];
+  size_t _count = 0;
+};
+
+#endif
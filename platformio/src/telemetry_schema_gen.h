@@ -0,0 +1,40 @@
+// GENERATED by schema/gen_telemetry.py from schema/telemetry.json - do not edit.
+#ifndef TELEMETRY_SCHEMA_GEN_H
+#define TELEMETRY_SCHEMA_GEN_H
+
+#include <Arduino.h>
+
+#define TELEMETRY_FRAME_VERSION 1
+
+// JSON key literals: the same bytes the SQL and frontend
+// definitions are generated from
+#define TELEMETRY_LIT_AGE_MS "ageMs"
+#define TELEMETRY_LIT_TEMPERATURE "temperature"
+#define TELEMETRY_LIT_HUMIDITY "humidity"
+#define TELEMETRY_LIT_LIGHT "light"
+#define TELEMETRY_LIT_MOISTURE "moisture"
+
+// Binary telemetry frame, little-endian (native on Xtensa),
+// mirrored by back/telemetry_schema_gen.py. Bump
+// frame_version in the schema on any layout change.
+struct __attribute__((packed)) TelemetryFrame {
+  uint8_t version;          // TELEMETRY_FRAME_VERSION
+  uint8_t deviceId;         // node identity on shared topics
+  uint16_t sequence;        // publish counter, lets the backend spot gaps
+  uint32_t uptimeMs;        // device millis() at acquisition
+  uint32_t ageMs;           // sample age at publish (epoch = recv - ageMs)
+  int16_t temperatureCenti; // degC * 100, -327.68..327.67
+  uint16_t humidityCenti;   // %RH * 100
+  uint16_t light;           // lux from the LDR calibration curve
+  uint16_t moisture;        // soil moisture percent from the probe curve
+};
+
+// X(jsonKeyLiteral, frameMember, scale) over the JSON-visible
+// sensor fields, for serializers that walk the schema
+#define TELEMETRY_SCHEMA_FIELDS(X) \
+  X(TELEMETRY_LIT_TEMPERATURE, temperatureCenti, 100) \
+  X(TELEMETRY_LIT_HUMIDITY, humidityCenti, 100) \
+  X(TELEMETRY_LIT_LIGHT, light, 1) \
+  X(TELEMETRY_LIT_MOISTURE, moisture, 1)
+
+#endif // TELEMETRY_SCHEMA_GEN_H
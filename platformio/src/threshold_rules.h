@@ -0,0 +1,135 @@
+#ifndef THRESHOLD_RULES_H
+#define THRESHOLD_RULES_H
+
+#include <stdint.h>
+
+// On-device alert rules for the per-sector thresholds.
+//
+// The threshold table (back/create_threshold_table.sql) is evaluated
+// server-side, so a crossing is only detected after the sample has
+// ridden MQTT into Postgres - seconds of latency on the path that is
+// supposed to raise alarms. This engine evaluates the same rules
+// against every snapshot the sampling task produces: one low and one
+// high rule per field (temperature, humidity, light, moisture), each
+// with a fixed hysteresis band so a reading hovering on the threshold
+// raises one alert, not one per sample. The server distributes each
+// sector's thresholds as shared attributes (the alert* keys below, one
+// RuntimeConfig parameter per rule), so retuning a sector never
+// touches the firmware.
+//
+// evaluate() converts the four readings and eight thresholds to
+// centi-units once and then runs O(rules) int32 comparisons - cheap
+// enough to sit inline in the sampling task's pipeline. A threshold
+// parked at the edge of its valid range (the registered defaults)
+// can never be crossed, which is how an unused rule stays disabled
+// without a separate enable flag.
+class ThresholdRules {
+ public:
+  enum Field {
+    FIELD_TEMPERATURE = 0,
+    FIELD_HUMIDITY,
+    FIELD_LIGHT,
+    FIELD_MOISTURE,
+    FIELD_COUNT,
+  };
+  enum Rule {
+    RULE_TEMP_LO = 0,
+    RULE_TEMP_HI,
+    RULE_HUM_LO,
+    RULE_HUM_HI,
+    RULE_LIGHT_LO,
+    RULE_LIGHT_HI,
+    RULE_MOIST_LO,
+    RULE_MOIST_HI,
+    RULE_COUNT,
+  };
+
+  // A fired/cleared transition from one evaluate() pass; value and
+  // threshold ride along so the alert payload needs no second lookup
+  struct Event {
+    uint8_t rule;
+    bool fired;
+    float value;
+    float threshold;
+  };
+
+  // Shared-attribute key per rule (also the alert name on the wire);
+  // NVS keys, so 15 chars max
+  static const char *ruleKey(int rule) {
+    static const char *v[RULE_COUNT] = {
+        "alertTempLoC",  "alertTempHiC",  "alertHumLoPct",   "alertHumHiPct",
+        "alertLightLoLx", "alertLightHiLx", "alertMoistLoPct", "alertMoistHiPct",
+    };
+    return v[rule];
+  }
+
+  static int ruleField(int rule) { return rule / 2; }
+  static bool ruleIsHigh(int rule) { return (rule & 1) != 0; }
+
+  // Registration range per rule; the default sits at the edge of the
+  // range, i.e. the rule ships disabled until a sector threshold lands
+  static float ruleMin(int rule) { return limitLo(ruleField(rule)); }
+  static float ruleMax(int rule) { return limitHi(ruleField(rule)); }
+  static float ruleDefault(int rule) {
+    return ruleIsHigh(rule) ? ruleMax(rule) : ruleMin(rule);
+  }
+
+  // Evaluate one snapshot (values indexed by Field, thresholds by Rule)
+  // and append up to cap fired/cleared transitions to events. Returns
+  // the transition count; zero on the overwhelmingly common pass.
+  int evaluate(const float values[FIELD_COUNT],
+               const float thresholds[RULE_COUNT], Event *events, int cap) {
+    int32_t v[FIELD_COUNT];
+    for (int f = 0; f < FIELD_COUNT; f++) {
+      v[f] = toCenti(values[f]);
+    }
+    int count = 0;
+    for (int r = 0; r < RULE_COUNT; r++) {
+      const int32_t t = toCenti(thresholds[r]);
+      const int32_t reading = v[ruleField(r)];
+      bool next = _active[r];
+      if (ruleIsHigh(r)) {
+        // Fire above the threshold, clear a margin below it
+        if (!_active[r] && reading > t) next = true;
+        else if (_active[r] && reading < t - margin(ruleField(r))) next = false;
+      } else {
+        if (!_active[r] && reading < t) next = true;
+        else if (_active[r] && reading > t + margin(ruleField(r))) next = false;
+      }
+      if (next != _active[r]) {
+        _active[r] = next;
+        if (count < cap) {
+          events[count++] = {(uint8_t)r, next, values[ruleField(r)],
+                            thresholds[r]};
+        }
+      }
+    }
+    return count;
+  }
+
+  bool active(int rule) const { return _active[rule]; }
+
+ private:
+  // Sensor full-scale limits per field (degC, %RH, lux, %)
+  static float limitLo(int f) {
+    static const float v[FIELD_COUNT] = {-10.0f, 0.0f, 0.0f, 0.0f};
+    return v[f];
+  }
+  static float limitHi(int f) {
+    static const float v[FIELD_COUNT] = {60.0f, 100.0f, 10000.0f, 100.0f};
+    return v[f];
+  }
+
+  // Hysteresis band per field, centi-units: 0.5 degC, 2 %RH, 50 lux,
+  // 2 % moisture - wider than each channel's filtered noise floor
+  static int32_t margin(int f) {
+    static const int32_t v[FIELD_COUNT] = {50, 200, 5000, 200};
+    return v[f];
+  }
+
+  static int32_t toCenti(float v) { return (int32_t)(v * 100.0f); }
+
+  bool _active[RULE_COUNT] = {};
+};
+
+#endif  // THRESHOLD_RULES_H
@@ -0,0 +1,37 @@
+#ifndef UDP_BURST_FRAME_H
+#define UDP_BURST_FRAME_H
+
+#include <Arduino.h>
+
+// Wire format for the ack-less UDP sampling fast path, shared between
+// the udp_burst firmware role and the receiver in backend/ingestd
+// (udp_burst_receiver.h mirrors this layout and must be kept in sync).
+// Short high-rate studies — 100Hz soil-moisture transients — overrun
+// the TCP/MQTT path, where one retransmission stalls the stream and
+// destroys the sample timing. UDP datagrams are fire-and-forget: a lost
+// packet costs its samples and nothing else, and the sequence number
+// lets the receiver count exactly what was lost.
+//
+// All fields are little-endian (native on the Xtensa core). Bump
+// UDP_BURST_FRAME_VERSION on any layout change; the receiver drops
+// versions it does not know.
+
+#define UDP_BURST_FRAME_VERSION 1
+
+// Port the ingestd receiver listens on
+#define UDP_BURST_PORT 18884
+
+// Samples per datagram: 50 at 100Hz means two packets a second, and
+// the 114-byte datagram stays far below any MTU
+#define UDP_BURST_SAMPLES_PER_PACKET 50
+
+struct __attribute__((packed)) UdpBurstHeader {
+  uint8_t version;        // UDP_BURST_FRAME_VERSION
+  uint8_t deviceId;
+  uint16_t sampleCount;   // uint16_t samples following this header
+  uint32_t sequence;      // datagram counter, receiver spots loss by gaps
+  uint32_t firstUptimeMs; // device millis() at samples[0]
+  uint16_t intervalUs;    // spacing between consecutive samples
+};
+
+#endif // UDP_BURST_FRAME_H
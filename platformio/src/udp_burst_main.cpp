@@ -0,0 +1,140 @@
+/**
+ * Ack-less UDP burst-sampling firmware (built by the "udp_burst"
+ * PlatformIO environment instead of the normal firmware).
+ *
+ * For short high-rate studies (100Hz soil-moisture transients) the
+ * TCP/MQTT path cannot keep up and a single retransmission wrecks the
+ * sample timing. This role samples the moisture ADC on a hard cadence
+ * from a dedicated core-1 task, packs UDP_BURST_SAMPLES_PER_PACKET raw
+ * readings per datagram (udp_burst_frame.h) and fires them at the
+ * ingestd receiver with no acknowledgement — a lost datagram costs its
+ * samples and nothing else, and the sequence number lets the receiver
+ * count the loss. Sampling and sending are split across the two cores
+ * like the normal firmware's sense/net planes, so WiFi contention never
+ * shows up as sampling jitter.
+ *
+ *   pio run -e udp_burst -t upload
+ */
+
+#ifdef UDP_BURST_FIRMWARE
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "udp_burst_frame.h"
+
+#define MOISTURE_PIN GPIO_NUM_2
+
+constexpr char WIFI_SSID[] = "P4.11";
+constexpr char WIFI_PASSWORD[] = "123456788";
+
+// Which device this series belongs to; flashed per board
+#ifndef UDP_BURST_DEVICE_ID
+#define UDP_BURST_DEVICE_ID 1
+#endif
+
+// Sample cadence. Must divide into whole FreeRTOS ticks (1ms), so up
+// to 1kHz in integer steps of the tick period.
+#ifndef UDP_BURST_RATE_HZ
+#define UDP_BURST_RATE_HZ 100
+#endif
+
+// The machine running ingestd; override per site with a build flag
+#ifndef UDP_BURST_HOST
+#define UDP_BURST_HOST "192.168.1.10"
+#endif
+
+struct __attribute__((packed)) BurstPacket {
+  UdpBurstHeader header;
+  uint16_t samples[UDP_BURST_SAMPLES_PER_PACKET];
+};
+
+// Full packets cross from the sampling task to the sender here; a few
+// slots of slack absorb a WiFi hiccup without blocking the sampler
+static QueueHandle_t packetQueue;
+static volatile uint32_t droppedPackets = 0;
+static volatile uint32_t sentPackets = 0;
+
+WiFiUDP udp;
+static IPAddress receiverIp;
+
+// Hard-cadence sampler: vTaskDelayUntil keeps the long-run rate exact
+// (no drift from the sampling work itself). The only thing this task
+// does besides reading the ADC is one queue copy per full packet.
+static void taskBurstSample(void *parameter) {
+  static BurstPacket packet;
+  packet.header.version = UDP_BURST_FRAME_VERSION;
+  packet.header.deviceId = UDP_BURST_DEVICE_ID;
+  packet.header.intervalUs = 1000000UL / UDP_BURST_RATE_HZ;
+
+  uint32_t sequence = 0;
+  uint16_t count = 0;
+  TickType_t lastWake = xTaskGetTickCount();
+  while (1) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(1000 / UDP_BURST_RATE_HZ));
+    if (count == 0) {
+      packet.header.firstUptimeMs = millis();
+    }
+    packet.samples[count++] = (uint16_t)analogRead(MOISTURE_PIN);
+    if (count == UDP_BURST_SAMPLES_PER_PACKET) {
+      packet.header.sequence = sequence++;
+      packet.header.sampleCount = count;
+      if (xQueueSend(packetQueue, &packet, 0) != pdTRUE) {
+        droppedPackets++;
+      }
+      count = 0;
+    }
+  }
+}
+
+// Sender on the WiFi core: blocks on the queue, fires each packet and
+// never waits for anything coming back
+static void taskBurstSend(void *parameter) {
+  static BurstPacket packet;
+  while (1) {
+    if (xQueueReceive(packetQueue, &packet, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    const size_t wireSize =
+        sizeof(packet.header) + packet.header.sampleCount * sizeof(uint16_t);
+    udp.beginPacket(receiverIp, UDP_BURST_PORT);
+    udp.write((const uint8_t *)&packet, wireSize);
+    if (udp.endPacket() == 1) {
+      sentPackets++;
+    }
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(100);
+  Serial.println("\n--- UDP burst sampling ---");
+
+  pinMode(MOISTURE_PIN, INPUT);
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(500);
+  }
+  if (!receiverIp.fromString(UDP_BURST_HOST)) {
+    Serial.println("Bad UDP_BURST_HOST, rebooting");
+    delay(1000);
+    ESP.restart();
+  }
+  Serial.printf("Streaming %dHz moisture to %s:%d as device %d\n",
+                UDP_BURST_RATE_HZ, UDP_BURST_HOST, UDP_BURST_PORT,
+                UDP_BURST_DEVICE_ID);
+
+  packetQueue = xQueueCreate(8, sizeof(BurstPacket));
+  xTaskCreatePinnedToCore(taskBurstSample, "TaskBurstSample", 2048, NULL, 2, NULL, 1);
+  xTaskCreatePinnedToCore(taskBurstSend, "TaskBurstSend", 4096, NULL, 1, NULL, 0);
+}
+
+void loop() {
+  delay(5000);
+  Serial.printf("[BURST] %u packets sent, %u dropped at the queue\n",
+                sentPackets, droppedPackets);
+}
+
+#endif // UDP_BURST_FIRMWARE
@@ -0,0 +1,69 @@
+#ifndef WARM_BOOT_H
+#define WARM_BOOT_H
+
+#include <Arduino.h>
+
+// State staged right before a planned reboot (OTA partition switch) and
+// restored on the first boot of the new image. The owner declares one
+// instance with RTC_DATA_ATTR and hands it to WarmBoot::begin(); RTC
+// slow memory survives a software reset, so the new image starts with
+// the previous image's sensor picture and calibration instead of ten
+// seconds of cold re-initialization. A power cycle clears RTC memory
+// and the magic check turns that into a normal cold boot.
+struct WarmBootState {
+  uint32_t magic;        // WARM_BOOT_MAGIC when the state below is valid
+  uint32_t stagedMs;     // millis() of the old image when it staged
+  float temperature;     // last good snapshot, carried across the switch
+  float humidity;
+  float light;
+  float moisture;
+  float tempOffset;      // DHT20 calibration, skips the begin() wait
+  float humOffset;
+};
+
+class WarmBoot {
+public:
+  void begin(WarmBootState *state) { _state = state; }
+
+  // Stage everything the next image needs, called from the OTA start
+  // hook while the old image is still fully up
+  void stage(float temperature, float humidity, float light, float moisture,
+             float tempOffset, float humOffset) {
+    if (_state == NULL) {
+      return;
+    }
+    _state->stagedMs = millis();
+    _state->temperature = temperature;
+    _state->humidity = humidity;
+    _state->light = light;
+    _state->moisture = moisture;
+    _state->tempOffset = tempOffset;
+    _state->humOffset = humOffset;
+    _state->magic = WARM_BOOT_MAGIC;
+  }
+
+  // Whether valid staged state exists. Clears the magic either way, so
+  // a crash loop in the new image can never keep restoring stale data.
+  bool consume() {
+    if (_state == NULL || _state->magic != WARM_BOOT_MAGIC) {
+      return false;
+    }
+    _state->magic = 0;
+    return true;
+  }
+
+  // Valid only for the boot where consume() returned true
+  float temperature() const { return _state ? _state->temperature : 0.0f; }
+  float humidity() const { return _state ? _state->humidity : 0.0f; }
+  float light() const { return _state ? _state->light : 0.0f; }
+  float moisture() const { return _state ? _state->moisture : 0.0f; }
+  float tempOffset() const { return _state ? _state->tempOffset : 0.0f; }
+  float humOffset() const { return _state ? _state->humOffset : 0.0f; }
+
+private:
+  static const uint32_t WARM_BOOT_MAGIC = 0x57424F54; // "WBOT"
+
+  WarmBootState *_state = NULL;
+};
+
+#endif // WARM_BOOT_H
@@ -0,0 +1,96 @@
+#ifndef WIFI_FAST_CONNECT_H
+#define WIFI_FAST_CONNECT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+#include "nvs_journal.h"
+
+// Caches the AP's BSSID + channel and our DHCP lease in NVS so the next
+// association can skip the full scan and DHCP exchange (3-6s on our APs,
+// target <500ms). On a failed fast attempt the cache is dropped and the
+// normal full-scan path takes over.
+class WiFiFastConnect {
+public:
+  void begin() { _prefs.begin("wificache", false); }
+
+  // The six cache writes per association go through the write-behind
+  // journal: they run from the WiFi event callback, which should stay
+  // short. A reboot before the flush only costs the next boot its fast
+  // path — the cache is an optimization, not state.
+  void attachJournal(NvsJournal *journal) { _journal = journal; }
+
+  // Try to start a fast association from the cache. Returns false when no
+  // cache exists (caller should do a normal WiFi.begin).
+  bool tryFastBegin(const char *ssid, const char *password) {
+    if (_prefs.getBytesLength("bssid") != 6) {
+      return false;
+    }
+    uint8_t bssid[6];
+    _prefs.getBytes("bssid", bssid, 6);
+    int32_t channel = _prefs.getInt("channel", 0);
+    if (channel <= 0) {
+      return false;
+    }
+
+    // Reuse the previous lease so we also skip DHCP
+    uint32_t ip = _prefs.getUInt("ip", 0);
+    if (ip != 0) {
+      WiFi.config(IPAddress(ip),
+                  IPAddress(_prefs.getUInt("gw", 0)),
+                  IPAddress(_prefs.getUInt("mask", 0)),
+                  IPAddress(_prefs.getUInt("dns", 0)));
+    }
+    WiFi.begin(ssid, password, channel, bssid);
+    _fastAttempt = true;
+    return true;
+  }
+
+  // Call from the GOT_IP event: remember what worked for next time
+  void onConnected() {
+    _fastAttempt = false;
+    uint8_t *bssid = WiFi.BSSID();
+    if (_journal != NULL) {
+      if (bssid != nullptr) {
+        _journal->stageBytes(&_prefs, "bssid", bssid, 6);  // copied inline
+      }
+      _journal->stageI32(&_prefs, "channel", WiFi.channel());
+      _journal->stageU32(&_prefs, "ip", (uint32_t)WiFi.localIP());
+      _journal->stageU32(&_prefs, "gw", (uint32_t)WiFi.gatewayIP());
+      _journal->stageU32(&_prefs, "mask", (uint32_t)WiFi.subnetMask());
+      _journal->stageU32(&_prefs, "dns", (uint32_t)WiFi.dnsIP());
+      return;
+    }
+    if (bssid != nullptr) {
+      _prefs.putBytes("bssid", bssid, 6);
+    }
+    _prefs.putInt("channel", WiFi.channel());
+    _prefs.putUInt("ip", (uint32_t)WiFi.localIP());
+    _prefs.putUInt("gw", (uint32_t)WiFi.gatewayIP());
+    _prefs.putUInt("mask", (uint32_t)WiFi.subnetMask());
+    _prefs.putUInt("dns", (uint32_t)WiFi.dnsIP());
+  }
+
+  // Call from the DISCONNECTED event. Returns true when the failure was a
+  // fast attempt: the caller should fall back to a full scan (cache is
+  // invalidated — the AP may have changed channel or rebooted).
+  bool onDisconnected() {
+    if (!_fastAttempt) {
+      return false;
+    }
+    _fastAttempt = false;
+    _prefs.remove("bssid");
+    _prefs.remove("channel");
+    _prefs.remove("ip");
+    // Back to DHCP for the full-scan attempt
+    WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    return true;
+  }
+
+private:
+  Preferences _prefs;
+  bool _fastAttempt = false;
+  NvsJournal *_journal = NULL;
+};
+
+#endif // WIFI_FAST_CONNECT_H
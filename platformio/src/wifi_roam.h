@@ -0,0 +1,193 @@
+#ifndef WIFI_ROAM_H
+#define WIFI_ROAM_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string.h>
+
+// Roaming engine for nodes that move between farm APs (irrigation
+// booms, edge-of-coverage sectors). Left to itself the stack rides the
+// fading AP down to a hard disconnect and then walks the full
+// scan/associate/DHCP path — 5-10s of outage per handoff, many times a
+// day on a moving boom.
+//
+// This engine front-runs the disconnect: when RSSI degrades it starts
+// an async background scan filtered to our SSID and keeps a table of
+// known sibling BSSIDs with their channels; when the link gets bad and
+// a candidate beats us by a hysteresis margin, it pins the current
+// lease (same farm subnet, so DHCP is skipped) and issues a targeted
+// WiFi.begin at the candidate's BSSID+channel — no scan in the gap,
+// association only, well under the 500ms the telemetry buffer absorbs.
+// The disconnect event that fires mid-handoff must not re-arm a
+// full-scan begin on top of the targeted one; the event handler asks
+// onDisconnected() first, same contract as WiFiFastConnect.
+class WiFiRoam {
+public:
+  static const int SCAN_RSSI_DBM = -70;      // Degrading: start looking
+  static const int ROAM_RSSI_DBM = -78;      // Bad: switch if a better AP is known
+  static const int HYSTERESIS_DB = 8;        // Candidate must beat us by this
+  static const uint32_t SCAN_MIN_GAP_MS = 15000;
+  static const uint32_t ROAM_COOLDOWN_MS = 30000;
+  static const uint32_t CANDIDATE_TTL_MS = 120000;
+  static const uint32_t HANDOFF_TIMEOUT_MS = 5000;
+  static const size_t MAX_CANDIDATES = 6;
+
+  void begin(const char *ssid, const char *password) {
+    _ssid = ssid;
+    _password = password;
+  }
+
+  // Call periodically from a network-plane task; cheap while healthy
+  // (one RSSI read), an async scan costs ~100ms of off-channel time
+  // per channel only while the signal is already degrading.
+  void loop(uint32_t nowMs) {
+    if (_ssid == nullptr || WiFi.status() != WL_CONNECTED) {
+      return;
+    }
+    harvestScan(nowMs);
+    const int rssi = WiFi.RSSI();
+    if (rssi >= SCAN_RSSI_DBM) {
+      return;
+    }
+    maybeStartScan(nowMs);
+    if (rssi <= ROAM_RSSI_DBM) {
+      maybeRoam(rssi, nowMs);
+    }
+  }
+
+  // Call from the GOT_IP event: the handoff (or ordinary reconnect)
+  // landed
+  void onConnected() { _inHandoff = false; }
+
+  // Call first from the DISCONNECTED event. True while a deliberate
+  // handoff is in flight: the targeted begin is already armed and the
+  // caller must not override it with a full-scan begin. A handoff that
+  // outlives its timeout falls back to the normal reconnect path.
+  bool onDisconnected() {
+    if (!_inHandoff) {
+      return false;
+    }
+    if (millis() - _handoffStartMs > HANDOFF_TIMEOUT_MS) {
+      _inHandoff = false;
+      return false;
+    }
+    return true;
+  }
+
+  uint32_t roamCount() const { return _roamCount; }
+  size_t candidateCount() const { return _candidateCount; }
+
+private:
+  struct Candidate {
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    uint32_t seenMs;
+  };
+
+  // Fold finished async scan results into the candidate table
+  void harvestScan(uint32_t nowMs) {
+    if (!_scanning) {
+      return;
+    }
+    const int16_t found = WiFi.scanComplete();
+    if (found == WIFI_SCAN_RUNNING) {
+      return;
+    }
+    _scanning = false;
+    for (int16_t i = 0; i < found; i++) {
+      const uint8_t *bssid = WiFi.BSSID(i);
+      const uint8_t *current = WiFi.BSSID();
+      if (bssid == nullptr || WiFi.SSID(i) != _ssid ||
+          (current != nullptr && memcmp(bssid, current, 6) == 0)) {
+        continue;
+      }
+      remember(bssid, (uint8_t)WiFi.channel(i), (int8_t)WiFi.RSSI(i), nowMs);
+    }
+    WiFi.scanDelete();
+  }
+
+  void remember(const uint8_t *bssid, uint8_t channel, int8_t rssi,
+                uint32_t nowMs) {
+    // Update in place, else take a free or the stalest slot
+    size_t slot = _candidateCount;
+    for (size_t i = 0; i < _candidateCount; i++) {
+      if (memcmp(_candidates[i].bssid, bssid, 6) == 0) {
+        slot = i;
+        break;
+      }
+    }
+    if (slot == _candidateCount) {
+      if (_candidateCount < MAX_CANDIDATES) {
+        _candidateCount++;
+      } else {
+        slot = 0;
+        for (size_t i = 1; i < MAX_CANDIDATES; i++) {
+          if (_candidates[i].seenMs < _candidates[slot].seenMs) {
+            slot = i;
+          }
+        }
+      }
+    }
+    memcpy(_candidates[slot].bssid, bssid, 6);
+    _candidates[slot].channel = channel;
+    _candidates[slot].rssi = rssi;
+    _candidates[slot].seenMs = nowMs;
+  }
+
+  void maybeStartScan(uint32_t nowMs) {
+    if (_scanning || nowMs - _lastScanMs < SCAN_MIN_GAP_MS) {
+      return;
+    }
+    // Async, SSID-filtered, short dwell: the radio steps off-channel
+    // briefly per channel while the link still works
+    WiFi.scanNetworks(true /*async*/, false, false, 120, 0, _ssid);
+    _scanning = true;
+    _lastScanMs = nowMs;
+  }
+
+  void maybeRoam(int currentRssi, uint32_t nowMs) {
+    if (_inHandoff || nowMs - _lastRoamMs < ROAM_COOLDOWN_MS) {
+      return;
+    }
+    const Candidate *best = nullptr;
+    for (size_t i = 0; i < _candidateCount; i++) {
+      const Candidate &c = _candidates[i];
+      if (nowMs - c.seenMs > CANDIDATE_TTL_MS) {
+        continue;
+      }
+      if (c.rssi >= currentRssi + HYSTERESIS_DB &&
+          (best == nullptr || c.rssi > best->rssi)) {
+        best = &c;
+      }
+    }
+    if (best == nullptr) {
+      return;
+    }
+    Serial.printf("Roaming: %d dBm here, %d dBm at candidate, handing off\n",
+                  currentRssi, (int)best->rssi);
+    // Pin the working lease before the switch so the new association
+    // skips DHCP — the farm APs bridge one subnet
+    WiFi.config(WiFi.localIP(), WiFi.gatewayIP(), WiFi.subnetMask(),
+                WiFi.dnsIP());
+    _inHandoff = true;
+    _handoffStartMs = millis();
+    _lastRoamMs = nowMs;
+    _roamCount++;
+    // Targeted begin: known BSSID + channel, no scan in the gap
+    WiFi.begin(_ssid, _password, best->channel, best->bssid);
+  }
+
+  const char *_ssid = nullptr;
+  const char *_password = nullptr;
+  Candidate _candidates[MAX_CANDIDATES];
+  size_t _candidateCount = 0;
+  bool _scanning = false;
+  bool _inHandoff = false;
+  uint32_t _lastScanMs = 0;
+  uint32_t _lastRoamMs = 0;
+  uint32_t _handoffStartMs = 0;
+  uint32_t _roamCount = 0;
+};
+
+#endif // WIFI_ROAM_H
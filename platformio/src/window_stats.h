@@ -0,0 +1,133 @@
+#ifndef WINDOW_STATS_H
+#define WINDOW_STATS_H
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Per-field min/max/mean/last over one publish window. Instantaneous
+// records discard everything between publishes - a light dip or a
+// watering spike that fits inside the window never reaches the
+// backend. This accumulator takes every sample as it is read
+// (incremental, fixed point: centi-unit int32 compares, int64 sum, no
+// float math on the add path) and renders one compact stats object per
+// window.
+//
+// It composes with the delta deadbands rather than fighting them: a
+// window where no field's range or mean movement reaches its deadband
+// is flat by the same definition the delta filter uses, and
+// significant() says to skip it entirely.
+class WindowStats {
+public:
+  enum Field { WS_TEMPERATURE, WS_HUMIDITY, WS_LIGHT, WS_MOISTURE, WS_FIELDS };
+
+  void add(float temperature, float humidity, float light, float moisture) {
+    const float values[WS_FIELDS] = {temperature, humidity, light, moisture};
+    for (int f = 0; f < WS_FIELDS; f++) {
+      const int32_t centi = (int32_t)(values[f] * 100.0f);
+      FieldAcc &acc = _fields[f];
+      if (_count == 0 || centi < acc.minC) acc.minC = centi;
+      if (_count == 0 || centi > acc.maxC) acc.maxC = centi;
+      acc.sumC += centi;
+      acc.lastC = centi;
+    }
+    _count++;
+  }
+
+  uint16_t count() const { return _count; }
+
+  void reset() {
+    for (int f = 0; f < WS_FIELDS; f++) {
+      _fields[f].sumC = 0;
+    }
+    _count = 0;
+  }
+
+  // Worth publishing when any field's in-window range reaches its
+  // delta deadband, or its mean moved a deadband since the last window
+  // that went out. Flat windows add nothing the live record did not
+  // already say. Calling this marks the window as the new reference
+  // only when it returns true.
+  bool significant() {
+    if (_count == 0) {
+      return false;
+    }
+    // Same deadbands as the delta publish path (publishBufferedRecord)
+    static const int32_t deadbandC[WS_FIELDS] = {20, 100, 2000, 100};
+    bool worth = false;
+    int32_t meanC[WS_FIELDS];
+    for (int f = 0; f < WS_FIELDS; f++) {
+      const FieldAcc &acc = _fields[f];
+      meanC[f] = (int32_t)(acc.sumC / _count);
+      if (acc.maxC - acc.minC >= deadbandC[f]) {
+        worth = true;
+      }
+      if (_haveReference &&
+          (meanC[f] - _referenceMeanC[f] >= deadbandC[f] ||
+           _referenceMeanC[f] - meanC[f] >= deadbandC[f])) {
+        worth = true;
+      }
+    }
+    if (!_haveReference) {
+      worth = true;  // first window after boot sets the baseline
+    }
+    if (worth) {
+      for (int f = 0; f < WS_FIELDS; f++) {
+        _referenceMeanC[f] = meanC[f];
+      }
+      _haveReference = true;
+    }
+    return worth;
+  }
+
+  // One flat JSON object, two decimals (light zero), plus the sample
+  // count so the backend can weight the means:
+  //   {"tMin":..,"tMax":..,"tAvg":..,"hMin":..,...,"mAvg":..,"wN":n}
+  // last is omitted per field - the live record published alongside
+  // this object is the window's last sample already.
+  size_t serialize(char *buf, size_t cap) const {
+    static const char *prefix[WS_FIELDS] = {"t", "h", "l", "m"};
+    size_t len = (size_t)snprintf(buf, cap, "{");
+    for (int f = 0; f < WS_FIELDS && len < cap; f++) {
+      const FieldAcc &acc = _fields[f];
+      const int32_t meanC = _count > 0 ? (int32_t)(acc.sumC / _count) : 0;
+      if (f == WS_LIGHT) {
+        len += snprintf(buf + len, cap - len,
+                        "\"%sMin\":%ld,\"%sMax\":%ld,\"%sAvg\":%ld,",
+                        prefix[f], (long)(acc.minC / 100),
+                        prefix[f], (long)(acc.maxC / 100),
+                        prefix[f], (long)(meanC / 100));
+      } else {
+        // Sign printed separately: -0.25 truncates to whole part 0,
+        // which would otherwise lose the minus
+        const int32_t centis[3] = {acc.minC, acc.maxC, meanC};
+        static const char *suffix[3] = {"Min", "Max", "Avg"};
+        for (int s = 0; s < 3 && len < cap; s++) {
+          const int32_t c = centis[s];
+          len += snprintf(buf + len, cap - len, "\"%s%s\":%s%ld.%02ld,",
+                          prefix[f], suffix[s], c < 0 ? "-" : "",
+                          (long)(labs(c) / 100), (long)(labs(c) % 100));
+        }
+      }
+    }
+    if (len < cap) {
+      len += snprintf(buf + len, cap - len, "\"wN\":%u}", (unsigned)_count);
+    }
+    return len < cap ? len : cap - 1;
+  }
+
+private:
+  struct FieldAcc {
+    int32_t minC = 0;
+    int32_t maxC = 0;
+    int64_t sumC = 0;
+    int32_t lastC = 0;
+  };
+
+  FieldAcc _fields[WS_FIELDS];
+  int32_t _referenceMeanC[WS_FIELDS] = {0, 0, 0, 0};
+  bool _haveReference = false;
+  uint16_t _count = 0;
+};
+
+#endif // WINDOW_STATS_H
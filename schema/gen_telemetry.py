@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""Telemetry schema codegen.
+
+The schema used to live informally in three places at once - JSON keys
+in the firmware publish calls, the packed struct mirrored by hand in
+back/telemetry_frame.py, and column definitions in back/create_tables.sql
+- and every drift between them cost a parsing shim somewhere on a hot
+path. This script reads schema/telemetry.json (the single source) and
+emits matched definitions for every consumer:
+
+  platformio/src/telemetry_schema_gen.h   packed frame struct, JSON key
+                                          literals, field X-macro
+  back/telemetry_schema_gen.py            struct format string + field
+                                          metadata for the decoder
+  back/telemetry_tables_gen.sql           per-sensor Data_* table DDL
+  WebApp/server/telemetry_schema_gen.js   key/unit list for the web side
+
+Run from anywhere: paths are resolved relative to the repo root. With
+--check the outputs are compared instead of written (non-zero exit on
+drift), so CI can enforce that generated files match the schema.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SCHEMA_PATH = os.path.join(REPO_ROOT, "schema", "telemetry.json")
+
+# C type -> (struct.unpack character, size in bytes)
+CTYPES = {
+    "uint8_t": ("B", 1), "int8_t": ("b", 1),
+    "uint16_t": ("H", 2), "int16_t": ("h", 2),
+    "uint32_t": ("I", 4), "int32_t": ("i", 4),
+}
+
+GENERATED_NOTE = "GENERATED by schema/gen_telemetry.py from schema/telemetry.json - do not edit"
+
+
+def load_schema():
+    with open(SCHEMA_PATH) as f:
+        schema = json.load(f)
+    for field in schema["frame"]:
+        if field["ctype"] not in CTYPES:
+            raise ValueError("unsupported ctype %r for field %s"
+                             % (field["ctype"], field["name"]))
+    return schema
+
+
+def frame_format(schema):
+    return "<" + "".join(CTYPES[f["ctype"]][0] for f in schema["frame"])
+
+
+def gen_header(schema):
+    lines = [
+        "// %s." % GENERATED_NOTE,
+        "#ifndef TELEMETRY_SCHEMA_GEN_H",
+        "#define TELEMETRY_SCHEMA_GEN_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "#define TELEMETRY_FRAME_VERSION %d" % schema["frame_version"],
+        "",
+        "// JSON key literals: the same bytes the SQL and frontend",
+        "// definitions are generated from",
+    ]
+    json_fields = [f for f in schema["frame"] if "json" in f]
+    for f in json_fields:
+        lines.append("#define TELEMETRY_LIT_%s %s"
+                     % (lit_suffix(f["json"]), json.dumps(f["json"])))
+    lines += [
+        "",
+        "// Binary telemetry frame, little-endian (native on Xtensa),",
+        "// mirrored by back/telemetry_schema_gen.py. Bump",
+        "// frame_version in the schema on any layout change.",
+        "struct __attribute__((packed)) TelemetryFrame {",
+    ]
+    width = max(len(f["ctype"]) + 1 + len(f["name"]) + 1 for f in schema["frame"])
+    for f in schema["frame"]:
+        decl = "%s %s;" % (f["ctype"], f["name"])
+        lines.append("  %-*s // %s" % (width, decl, f["comment"]))
+    lines += [
+        "};",
+        "",
+        "// X(jsonKeyLiteral, frameMember, scale) over the JSON-visible",
+        "// sensor fields, for serializers that walk the schema",
+        "#define TELEMETRY_SCHEMA_FIELDS(X) \\",
+    ]
+    scaled = [f for f in json_fields if "scale" in f]
+    for i, f in enumerate(scaled):
+        cont = " \\" if i + 1 < len(scaled) else ""
+        lines.append("  X(TELEMETRY_LIT_%s, %s, %d)%s"
+                     % (lit_suffix(f["json"]), f["name"], f["scale"], cont))
+    lines += ["", "#endif // TELEMETRY_SCHEMA_GEN_H", ""]
+    return "\n".join(lines)
+
+
+def lit_suffix(json_key):
+    # ageMs -> AGE_MS, temperature -> TEMPERATURE
+    out = []
+    for ch in json_key:
+        if ch.isupper():
+            out.append("_")
+        out.append(ch.upper())
+    return "".join(out)
+
+
+def gen_python(schema):
+    fmt = frame_format(schema)
+    lines = [
+        '"""%s."""' % GENERATED_NOTE,
+        "",
+        "TELEMETRY_FRAME_VERSION = %d" % schema["frame_version"],
+        "",
+        "# struct.unpack format for the packed frame in",
+        "# platformio/src/telemetry_schema_gen.h",
+        'FRAME_FORMAT = "%s"' % fmt,
+        "",
+        "FRAME_FIELDS = (",
+    ]
+    for f in schema["frame"]:
+        lines.append('    "%s",' % f["name"])
+    lines += [
+        ")",
+        "",
+        "# JSON-visible sensor values: json key -> (frame field, scale)",
+        "JSON_FIELDS = {",
+    ]
+    for f in schema["frame"]:
+        if "json" in f and "scale" in f:
+            lines.append('    "%s": ("%s", %d),' % (f["json"], f["name"], f["scale"]))
+    lines += ["}", ""]
+    return "\n".join(lines)
+
+
+def gen_sql(schema):
+    lines = ["-- %s." % GENERATED_NOTE, ""]
+    for f in schema["frame"]:
+        if "sql_table" not in f:
+            continue
+        lines += [
+            "-- %s telemetry (JSON key \"%s\", unit %s)"
+            % (f["json"], f["json"], f["unit"]),
+            "CREATE TABLE IF NOT EXISTS %s (" % f["sql_table"],
+            "    DataID INTEGER PRIMARY KEY,",
+            "    DID INTEGER REFERENCES Device(DID),",
+            "    Value DECIMAL,",
+            "    Unit VARCHAR(10),",
+            "    Status VARCHAR(20),",
+            "    Timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP",
+            ");",
+            "",
+        ]
+    return "\n".join(lines)
+
+
+def gen_js(schema):
+    lines = [
+        "// %s." % GENERATED_NOTE,
+        "",
+        "const FRAME_VERSION = %d;" % schema["frame_version"],
+        "const FRAME_SIZE = %d;" % struct.calcsize(frame_format(schema)),
+        "",
+        "// Telemetry keys as published by the firmware, with units",
+        "const TELEMETRY_FIELDS = [",
+    ]
+    for f in schema["frame"]:
+        if "json" in f and "scale" in f:
+            lines.append("    { key: '%s', unit: '%s' }," % (f["json"], f["unit"]))
+    lines += [
+        "];",
+        "",
+        "module.exports = { FRAME_VERSION, FRAME_SIZE, TELEMETRY_FIELDS };",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+OUTPUTS = {
+    "platformio/src/telemetry_schema_gen.h": gen_header,
+    "back/telemetry_schema_gen.py": gen_python,
+    "back/telemetry_tables_gen.sql": gen_sql,
+    "WebApp/server/telemetry_schema_gen.js": gen_js,
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true",
+                        help="verify outputs match the schema instead of writing")
+    args = parser.parse_args()
+
+    schema = load_schema()
+    drift = []
+    for rel_path, generator in OUTPUTS.items():
+        content = generator(schema)
+        path = os.path.join(REPO_ROOT, rel_path)
+        if args.check:
+            try:
+                with open(path) as f:
+                    on_disk = f.read()
+            except FileNotFoundError:
+                on_disk = None
+            if on_disk != content:
+                drift.append(rel_path)
+        else:
+            with open(path, "w") as f:
+                f.write(content)
+            print("wrote %s" % rel_path)
+
+    if drift:
+        for rel_path in drift:
+            print("drift: %s (re-run schema/gen_telemetry.py)" % rel_path,
+                  file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())